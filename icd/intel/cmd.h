@@ -149,6 +149,39 @@ struct intel_cmd_dset_data {
     uint32_t dynamic_offset_count;
 };
 
+#define INTEL_CMD_SHADOW_PACKET_COUNT 512
+#define INTEL_CMD_SHADOW_BLOCK_COUNT 256
+
+/*
+ * What the draw path has written, so that identical states can be skipped
+ * instead of being written again.
+ */
+struct intel_cmd_shadow {
+    /*
+     * The last copy of each 3DSTATE_* in the batch, indexed by its opcode
+     * and sub-opcode.  len is zero when there is none.
+     */
+    struct {
+        uint32_t pos;
+        uint32_t len;
+    } packets[INTEL_CMD_SHADOW_PACKET_COUNT];
+
+    /*
+     * Recently written SURFACE_STATEs, BINDING_TABLE_STATEs and dynamic
+     * states, indexed by hash.  size is zero when unused.
+     */
+    struct {
+        uint32_t hash;
+        uint32_t item;
+        uint32_t offset;
+        uint32_t size;
+
+        intptr_t reloc_target;
+        uint32_t reloc_offset;
+        uint32_t reloc_flags;
+    } blocks[INTEL_CMD_SHADOW_BLOCK_COUNT];
+};
+
 /*
  * States bounded to the command buffer.  We want to write states directly to
  * the command buffer when possible, and reduce this struct.
@@ -158,6 +191,8 @@ struct intel_cmd_bind {
 
     struct intel_cmd_shader_cache shader_cache;
 
+    struct intel_cmd_shadow shadow;
+
     struct {
         const struct intel_pipeline *graphics;
         const struct intel_pipeline *compute;
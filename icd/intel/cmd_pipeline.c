@@ -1087,6 +1087,214 @@ static void gen7_3dstate_pointer(struct intel_cmd *cmd,
     dw[1] = offset;
 }
 
+static uint32_t cmd_shadow_hash(const uint32_t *dw, uint32_t len,
+                                uint32_t hash)
+{
+    uint32_t i;
+
+    /* FNV-1a */
+    for (i = 0; i < len; i++)
+        hash = (hash ^ dw[i]) * 16777619u;
+
+    return hash;
+}
+
+/**
+ * Look for a copy of the block just written at \p offset, with the same
+ * relocation if \p reloc_target is not zero.  When there is one, the new
+ * block is dropped and the offset of the copy is returned.  Otherwise the
+ * block is remembered and \p offset is returned.
+ */
+static uint32_t cmd_writer_shadow(struct intel_cmd *cmd,
+                                  enum intel_cmd_writer_type which,
+                                  enum intel_cmd_item_type item,
+                                  uint32_t offset, uint32_t size,
+                                  intptr_t reloc_target,
+                                  uint32_t reloc_offset,
+                                  uint32_t reloc_flags)
+{
+    struct intel_cmd_writer *writer = &cmd->writers[which];
+    const char *ptr = (const char *) writer->ptr;
+    uint32_t hash;
+    struct intel_cmd_shadow *shadow = &cmd->bind.shadow;
+    uint32_t slot;
+
+    if ((intel_debug & INTEL_DEBUG_NOSHADOW) || !size)
+        return offset;
+
+    assert(offset + size == writer->used);
+
+    hash = cmd_shadow_hash((const uint32_t *) (ptr + offset), size >> 2,
+            2166136261u ^ item);
+    hash = cmd_shadow_hash(&reloc_offset, 1, hash ^ (uint32_t) reloc_target);
+    slot = hash % INTEL_CMD_SHADOW_BLOCK_COUNT;
+
+    if (shadow->blocks[slot].hash == hash &&
+        shadow->blocks[slot].item == item &&
+        shadow->blocks[slot].size == size &&
+        shadow->blocks[slot].reloc_target == reloc_target &&
+        shadow->blocks[slot].reloc_offset == reloc_offset &&
+        shadow->blocks[slot].reloc_flags == reloc_flags &&
+        shadow->blocks[slot].offset >= writer->sba_offset &&
+        shadow->blocks[slot].offset + size <= offset &&
+        !memcmp(ptr + shadow->blocks[slot].offset, ptr + offset, size)) {
+        /* drop the new block and its decoding item */
+        writer->used = offset;
+        if (writer->item_used &&
+            writer->items[writer->item_used - 1].offset == offset)
+            writer->item_used--;
+
+        return shadow->blocks[slot].offset;
+    }
+
+    shadow->blocks[slot].hash = hash;
+    shadow->blocks[slot].item = item;
+    shadow->blocks[slot].offset = offset;
+    shadow->blocks[slot].size = size;
+    shadow->blocks[slot].reloc_target = reloc_target;
+    shadow->blocks[slot].reloc_offset = reloc_offset;
+    shadow->blocks[slot].reloc_flags = reloc_flags;
+
+    return offset;
+}
+
+/**
+ * Write a dynamic state to the state buffer, or reuse an identical one.
+ */
+static uint32_t cmd_state_write_shadowed(struct intel_cmd *cmd,
+                                         enum intel_cmd_item_type item,
+                                         size_t alignment, uint32_t len,
+                                         const uint32_t *dw)
+{
+    const uint32_t offset = cmd_state_write(cmd, item, alignment, len, dw);
+
+    return cmd_writer_shadow(cmd, INTEL_CMD_WRITER_STATE, item,
+            offset, len << 2, 0, 0, 0);
+}
+
+/**
+ * Write a surface state to the surface buffer and add the relocation for its
+ * DWord 1, or reuse an identical one.  \p bo may be NULL for states without
+ * a relocation.
+ */
+static uint32_t cmd_surface_write_shadowed(struct intel_cmd *cmd,
+                                           enum intel_cmd_item_type item,
+                                           size_t alignment, uint32_t len,
+                                           const uint32_t *dw,
+                                           struct intel_bo *bo,
+                                           uint32_t bo_offset,
+                                           uint32_t reloc_flags)
+{
+    uint32_t offset, shadow_offset;
+
+    offset = cmd_surface_write(cmd, item, alignment, len, dw);
+    shadow_offset = cmd_writer_shadow(cmd, INTEL_CMD_WRITER_SURFACE, item,
+            offset, len << 2, (intptr_t) bo, bo_offset, reloc_flags);
+
+    if (shadow_offset == offset && bo) {
+        cmd_reserve_reloc(cmd, 1);
+        cmd_surface_reloc(cmd, offset, 1, bo, bo_offset, reloc_flags);
+    }
+
+    return shadow_offset;
+}
+
+/**
+ * Forget the 3DSTATE_* packets in the batch.  They have to be emitted again
+ * after STATE_BASE_ADDRESS or after something else has changed them.
+ */
+static void cmd_batch_shadow_invalidate(struct intel_cmd *cmd)
+{
+    memset(cmd->bind.shadow.packets, 0, sizeof(cmd->bind.shadow.packets));
+}
+
+/**
+ * Remove from the batch, starting at \p begin, the 3DSTATE_* packets that are
+ * identical to the last copies of the same packets.  Packets with relocations
+ * are always kept.  \p reloc_begin is the value of cmd->reloc_used at
+ * \p begin.
+ *
+ * Every packet is compared on its own.  That is fine for the 3DSTATE_CONSTANT_*
+ * packets, which on Haswell only take effect with the matching
+ * 3DSTATE_BINDING_TABLE_POINTERS_*, because they never change between two
+ * invalidations.
+ */
+static void cmd_batch_shadow(struct intel_cmd *cmd, uint32_t begin,
+                             uint32_t reloc_begin)
+{
+    const uint32_t state_mask = GEN6_RENDER_TYPE__MASK |
+                                GEN6_RENDER_SUBTYPE__MASK;
+    const uint32_t state_type = GEN6_RENDER_TYPE_RENDER |
+                                GEN6_RENDER_SUBTYPE_3D;
+    struct intel_cmd_writer *writer = &cmd->writers[INTEL_CMD_WRITER_BATCH];
+    struct intel_cmd_shadow *shadow = &cmd->bind.shadow;
+    uint32_t *batch = (uint32_t *) writer->ptr;
+    const uint32_t end = writer->used >> 2;
+    uint32_t src = begin, dst = begin, r = reloc_begin;
+
+    if (intel_debug & INTEL_DEBUG_NOSHADOW)
+        return;
+
+    while (src < end) {
+        const uint32_t dw0 = batch[src];
+        const uint32_t key = (dw0 & GEN6_RENDER_OPCODE__MASK) >>
+                             GEN6_RENDER_OPCODE__SHIFT;
+        const bool is_state = ((dw0 & state_mask) == state_type &&
+                               key < INTEL_CMD_SHADOW_PACKET_COUNT);
+        uint32_t len;
+        bool has_reloc = false;
+
+        if ((dw0 & GEN6_RENDER_TYPE__MASK) != GEN6_RENDER_TYPE_RENDER) {
+            /* not expected here; keep the rest as is */
+            len = end - src;
+        } else if ((dw0 & GEN6_RENDER_SUBTYPE__MASK) ==
+                   GEN6_RENDER_SUBTYPE_SINGLE_DW) {
+            len = 1;
+        } else {
+            len = ((dw0 & GEN6_RENDER_LENGTH__MASK) >>
+                    GEN6_RENDER_LENGTH__SHIFT) + 2;
+        }
+
+        assert(src + len <= end);
+
+        /* move the relocations along with the packet */
+        while (r < cmd->reloc_used) {
+            struct intel_cmd_reloc *reloc = &cmd->relocs[r];
+
+            if (reloc->which == INTEL_CMD_WRITER_BATCH) {
+                if (reloc->offset >= (src + len) << 2)
+                    break;
+
+                reloc->offset -= (src - dst) << 2;
+                has_reloc = true;
+            }
+            r++;
+        }
+
+        if (is_state && !has_reloc &&
+            shadow->packets[key].len == len &&
+            shadow->packets[key].pos + len <= dst &&
+            !memcmp(&batch[shadow->packets[key].pos], &batch[src],
+                    len << 2)) {
+            src += len;
+            continue;
+        }
+
+        if (dst != src)
+            memmove(&batch[dst], &batch[src], len << 2);
+
+        if (is_state) {
+            shadow->packets[key].pos = dst;
+            shadow->packets[key].len = (has_reloc) ? 0 : len;
+        }
+
+        src += len;
+        dst += len;
+    }
+
+    writer->used = dst << 2;
+}
+
 static uint32_t gen6_BLEND_STATE(struct intel_cmd *cmd)
 {
     const uint8_t cmd_align = GEN6_ALIGNMENT_BLEND_STATE;
@@ -1096,7 +1304,7 @@ static uint32_t gen6_BLEND_STATE(struct intel_cmd *cmd)
     CMD_ASSERT(cmd, 6, 7.5);
     STATIC_ASSERT(ARRAY_SIZE(pipeline->cmd_cb) >= INTEL_MAX_RENDER_TARGETS);
 
-    return cmd_state_write(cmd, INTEL_CMD_ITEM_BLEND, cmd_align, cmd_len, pipeline->cmd_cb);
+    return cmd_state_write_shadowed(cmd, INTEL_CMD_ITEM_BLEND, cmd_align, cmd_len, pipeline->cmd_cb);
 }
 
 static uint32_t gen6_DEPTH_STENCIL_STATE(struct intel_cmd *cmd,
@@ -1122,7 +1330,7 @@ static uint32_t gen6_DEPTH_STENCIL_STATE(struct intel_cmd *cmd,
     if (stencil_state->front.stencil_write_mask && pipeline->stencilTestEnable)
        dw[0] |= 1 << 18;
 
-    return cmd_state_write(cmd, INTEL_CMD_ITEM_DEPTH_STENCIL,
+    return cmd_state_write_shadowed(cmd, INTEL_CMD_ITEM_DEPTH_STENCIL,
             cmd_align, cmd_len, dw);
 }
 
@@ -1132,12 +1340,10 @@ static uint32_t gen6_COLOR_CALC_STATE(struct intel_cmd *cmd,
 {
     const uint8_t cmd_align = GEN6_ALIGNMENT_COLOR_CALC_STATE;
     const uint8_t cmd_len = 6;
-    uint32_t offset, *dw;
+    uint32_t dw[6];
 
     CMD_ASSERT(cmd, 6, 7.5);
 
-    offset = cmd_state_pointer(cmd, INTEL_CMD_ITEM_COLOR_CALC,
-            cmd_align, cmd_len, &dw);
     dw[0] = stencil_ref;
     dw[1] = 0;
     dw[2] = blend_color[0];
@@ -1145,7 +1351,8 @@ static uint32_t gen6_COLOR_CALC_STATE(struct intel_cmd *cmd,
     dw[4] = blend_color[2];
     dw[5] = blend_color[3];
 
-    return offset;
+    return cmd_state_write_shadowed(cmd, INTEL_CMD_ITEM_COLOR_CALC,
+            cmd_align, cmd_len, dw);
 }
 
 static void cmd_wa_gen6_pre_depth_stall_write(struct intel_cmd *cmd)
@@ -1331,6 +1538,7 @@ void cmd_batch_state_base_address(struct intel_cmd *cmd)
             cmd->writers[INTEL_CMD_WRITER_STATE].sba_offset + 1);
     cmd_batch_reloc_writer(cmd, pos + 5, INTEL_CMD_WRITER_INSTRUCTION,
             cmd->writers[INTEL_CMD_WRITER_INSTRUCTION].sba_offset + 1);
+    cmd_batch_shadow_invalidate(cmd);
 }
 
 void cmd_batch_push_const_alloc(struct intel_cmd *cmd)
@@ -1509,19 +1717,19 @@ static void gen6_viewport_states(struct intel_cmd *cmd)
     assert(viewport->cmd_len == (8 + 4 + 2) *
             /* viewports */ viewport->viewport_count + (/* scissor */ viewport->viewport_count * 2));
 
-    sf_offset = cmd_state_write(cmd, INTEL_CMD_ITEM_SF_VIEWPORT,
+    sf_offset = cmd_state_write_shadowed(cmd, INTEL_CMD_ITEM_SF_VIEWPORT,
             GEN6_ALIGNMENT_SF_VIEWPORT, 8 * viewport->viewport_count,
             viewport->cmd);
 
-    clip_offset = cmd_state_write(cmd, INTEL_CMD_ITEM_CLIP_VIEWPORT,
+    clip_offset = cmd_state_write_shadowed(cmd, INTEL_CMD_ITEM_CLIP_VIEWPORT,
             GEN6_ALIGNMENT_CLIP_VIEWPORT, 4 * viewport->viewport_count,
             &viewport->cmd[viewport->cmd_clip_pos]);
 
-    cc_offset = cmd_state_write(cmd, INTEL_CMD_ITEM_CC_VIEWPORT,
+    cc_offset = cmd_state_write_shadowed(cmd, INTEL_CMD_ITEM_CC_VIEWPORT,
             GEN6_ALIGNMENT_SF_VIEWPORT, 2 * viewport->viewport_count,
             &viewport->cmd[viewport->cmd_cc_pos]);
 
-    scissor_offset = cmd_state_write(cmd, INTEL_CMD_ITEM_SCISSOR_RECT,
+    scissor_offset = cmd_state_write_shadowed(cmd, INTEL_CMD_ITEM_SCISSOR_RECT,
             GEN6_ALIGNMENT_SCISSOR_RECT, 2 * viewport->viewport_count,
             &viewport->cmd[viewport->cmd_scissor_rect_pos]);
 
@@ -1582,21 +1790,21 @@ static void gen7_viewport_states(struct intel_cmd *cmd)
 
     assert(viewport->cmd_len == (16 + 2 + 2) * viewport->viewport_count);
 
-    offset = cmd_state_write(cmd, INTEL_CMD_ITEM_SF_VIEWPORT,
+    offset = cmd_state_write_shadowed(cmd, INTEL_CMD_ITEM_SF_VIEWPORT,
             GEN7_ALIGNMENT_SF_CLIP_VIEWPORT, 16 * viewport->viewport_count,
             viewport->cmd);
     gen7_3dstate_pointer(cmd,
             GEN7_RENDER_OPCODE_3DSTATE_VIEWPORT_STATE_POINTERS_SF_CLIP,
             offset);
 
-    offset = cmd_state_write(cmd, INTEL_CMD_ITEM_CC_VIEWPORT,
+    offset = cmd_state_write_shadowed(cmd, INTEL_CMD_ITEM_CC_VIEWPORT,
             GEN6_ALIGNMENT_CC_VIEWPORT, 2 * viewport->viewport_count,
             &viewport->cmd[viewport->cmd_cc_pos]);
     gen7_3dstate_pointer(cmd,
             GEN7_RENDER_OPCODE_3DSTATE_VIEWPORT_STATE_POINTERS_CC,
             offset);
 
-    offset = cmd_state_write(cmd, INTEL_CMD_ITEM_SCISSOR_RECT,
+    offset = cmd_state_write_shadowed(cmd, INTEL_CMD_ITEM_SCISSOR_RECT,
                              GEN6_ALIGNMENT_SCISSOR_RECT, 2 * viewport->viewport_count,
                              &viewport->cmd[viewport->cmd_scissor_rect_pos]);
     gen7_3dstate_pointer(cmd,
@@ -1640,11 +1848,35 @@ static void gen7_pcb(struct intel_cmd *cmd, int subop,
     dw[6] = 0;
 }
 
-static uint32_t emit_samplers(struct intel_cmd *cmd,
-                              const struct intel_pipeline_rmap *rmap)
+static const struct intel_sampler *emit_samplers_get(struct intel_cmd *cmd,
+                                                    const struct intel_pipeline_rmap_slot *slot)
 {
     const struct intel_desc_region *region = cmd->dev->desc_region;
     const struct intel_cmd_dset_data *data = &cmd->bind.dset.graphics_data;
+    struct intel_desc_offset desc_offset;
+    const struct intel_sampler *sampler;
+
+    switch (slot->type) {
+    case INTEL_PIPELINE_RMAP_SAMPLER:
+        intel_desc_offset_add(&desc_offset, &slot->u.sampler,
+                &data->set_offsets[slot->index]);
+        intel_desc_region_read_sampler(region, &desc_offset, &sampler);
+        break;
+    case INTEL_PIPELINE_RMAP_UNUSED:
+        sampler = NULL;
+        break;
+    default:
+        assert(!"unexpected rmap type");
+        sampler = NULL;
+        break;
+    }
+
+    return sampler;
+}
+
+static uint32_t emit_samplers(struct intel_cmd *cmd,
+                              const struct intel_pipeline_rmap *rmap)
+{
     const uint32_t border_len = (cmd_gen(cmd) >= INTEL_GEN(7)) ? 4 : 12;
     const uint32_t border_stride =
         u_align(border_len, GEN6_ALIGNMENT_SAMPLER_BORDER_COLOR_STATE / 4);
@@ -1660,44 +1892,36 @@ static uint32_t emit_samplers(struct intel_cmd *cmd,
     surface_count = rmap->rt_count + rmap->texture_resource_count + rmap->resource_count + rmap->uav_count;
 
     /*
-     * note that we cannot call cmd_state_pointer() here as the following
-     * cmd_state_pointer() would invalidate the pointer
+     * Fill in the border colors first.  They are written and shadowed before
+     * SAMPLER_STATEs, which point to them, are reserved.
      */
-    border_offset = cmd_state_reserve(cmd, INTEL_CMD_ITEM_BLOB,
+    border_offset = cmd_state_pointer(cmd, INTEL_CMD_ITEM_BLOB,
             GEN6_ALIGNMENT_SAMPLER_BORDER_COLOR_STATE,
-            border_stride * rmap->sampler_count);
+            border_stride * rmap->sampler_count, &border_dw);
+    memset(border_dw, 0, sizeof(uint32_t) * border_stride * rmap->sampler_count);
+
+    for (i = 0; i < rmap->sampler_count; i++) {
+        const struct intel_sampler *sampler =
+            emit_samplers_get(cmd, &rmap->slots[surface_count + i]);
+
+        if (sampler)
+            memcpy(border_dw, &sampler->cmd[3], border_len * 4);
+        border_dw += border_stride;
+    }
+
+    border_offset = cmd_writer_shadow(cmd, INTEL_CMD_WRITER_STATE,
+            INTEL_CMD_ITEM_BLOB, border_offset,
+            sizeof(uint32_t) * border_stride * rmap->sampler_count, 0, 0, 0);
 
     sampler_offset = cmd_state_pointer(cmd, INTEL_CMD_ITEM_SAMPLER,
             GEN6_ALIGNMENT_SAMPLER_STATE,
             4 * rmap->sampler_count, &sampler_dw);
 
-    cmd_state_update(cmd, border_offset,
-            border_stride * rmap->sampler_count, &border_dw);
-
     for (i = 0; i < rmap->sampler_count; i++) {
-        const struct intel_pipeline_rmap_slot *slot =
-            &rmap->slots[surface_count + i];
-        struct intel_desc_offset desc_offset;
-        const struct intel_sampler *sampler;
-
-        switch (slot->type) {
-        case INTEL_PIPELINE_RMAP_SAMPLER:
-            intel_desc_offset_add(&desc_offset, &slot->u.sampler,
-                    &data->set_offsets[slot->index]);
-            intel_desc_region_read_sampler(region, &desc_offset, &sampler);
-            break;
-        case INTEL_PIPELINE_RMAP_UNUSED:
-            sampler = NULL;
-            break;
-        default:
-            assert(!"unexpected rmap type");
-            sampler = NULL;
-            break;
-        }
+        const struct intel_sampler *sampler =
+            emit_samplers_get(cmd, &rmap->slots[surface_count + i]);
 
         if (sampler) {
-            memcpy(border_dw, &sampler->cmd[3], border_len * 4);
-
             sampler_dw[0] = sampler->cmd[0];
             sampler_dw[1] = sampler->cmd[1];
             sampler_dw[2] = border_offset;
@@ -1710,10 +1934,13 @@ static uint32_t emit_samplers(struct intel_cmd *cmd,
         }
 
         border_offset += border_stride * 4;
-        border_dw += border_stride;
         sampler_dw += 4;
     }
 
+    sampler_offset = cmd_writer_shadow(cmd, INTEL_CMD_WRITER_STATE,
+            INTEL_CMD_ITEM_SAMPLER, sampler_offset,
+            sizeof(uint32_t) * 4 * rmap->sampler_count, 0, 0, 0);
+
     return sampler_offset;
 }
 
@@ -1754,12 +1981,11 @@ static uint32_t emit_binding_table(struct intel_cmd *cmd,
                     fb->views[subpass->color_indices[slot->index]] : NULL;
 
                 if (view) {
-                    offset = cmd_surface_write(cmd, INTEL_CMD_ITEM_SURFACE,
+                    offset = cmd_surface_write_shadowed(cmd,
+                            INTEL_CMD_ITEM_SURFACE,
                             GEN6_ALIGNMENT_SURFACE_STATE,
-                            view->cmd_len, view->att_cmd);
-
-                    cmd_reserve_reloc(cmd, 1);
-                    cmd_surface_reloc(cmd, offset, 1, view->img->obj.mem->bo,
+                            view->cmd_len, view->att_cmd,
+                            view->img->obj.mem->bo,
                             view->att_cmd[1], INTEL_RELOC_WRITE);
                 } else {
                     need_null_view = true;
@@ -1791,12 +2017,10 @@ static uint32_t emit_binding_table(struct intel_cmd *cmd,
                     const uint32_t reloc_flags =
                         (read_only) ? 0 : INTEL_RELOC_WRITE;
 
-                    offset = cmd_surface_write(cmd, INTEL_CMD_ITEM_SURFACE,
+                    offset = cmd_surface_write_shadowed(cmd,
+                            INTEL_CMD_ITEM_SURFACE,
                             GEN6_ALIGNMENT_SURFACE_STATE,
-                            cmd_len, cmd_data);
-
-                    cmd_reserve_reloc(cmd, 1);
-                    cmd_surface_reloc(cmd, offset, 1, mem->bo,
+                            cmd_len, cmd_data, mem->bo,
                             cmd_data[1] + dynamic_offset, reloc_flags);
                 } else {
                     need_null_view = true;
@@ -1814,17 +2038,17 @@ static uint32_t emit_binding_table(struct intel_cmd *cmd,
 
         if (need_null_view) {
             intel_null_view_init(&null_view, cmd->dev);
-            offset = cmd_surface_write(cmd, INTEL_CMD_ITEM_SURFACE,
+            offset = cmd_surface_write_shadowed(cmd, INTEL_CMD_ITEM_SURFACE,
                     GEN6_ALIGNMENT_SURFACE_STATE,
-                    null_view.cmd_len, null_view.cmd);
+                    null_view.cmd_len, null_view.cmd, NULL, 0, 0);
         }
 
         binding_table[i] = offset - sba_offset;
     }
 
-    offset = cmd_surface_write(cmd, INTEL_CMD_ITEM_BINDING_TABLE,
+    offset = cmd_surface_write_shadowed(cmd, INTEL_CMD_ITEM_BINDING_TABLE,
             GEN6_ALIGNMENT_BINDING_TABLE_STATE,
-            surface_count, binding_table) - sba_offset;
+            surface_count, binding_table, NULL, 0, 0) - sba_offset;
 
     /* there is a 64KB limit on BINIDNG_TABLE_STATEs */
     assert(offset + sizeof(uint32_t) * surface_count <= 64 * 1024);
@@ -2332,15 +2556,27 @@ set_viewport_state(
 
 static void emit_bounded_states(struct intel_cmd *cmd)
 {
+    uint32_t begin, reloc_begin;
+
     set_viewport_state(cmd);
 
     emit_msaa(cmd);
 
+    begin = cmd->writers[INTEL_CMD_WRITER_BATCH].used >> 2;
+    reloc_begin = cmd->reloc_used;
     emit_graphics_pipeline(cmd);
+    cmd_batch_shadow(cmd, begin, reloc_begin);
 
+    /*
+     * Depth buffer states must be emitted together, and are only emitted when
+     * the render pass changes anyway.
+     */
     emit_rt(cmd);
     emit_ds(cmd);
 
+    begin = cmd->writers[INTEL_CMD_WRITER_BATCH].used >> 2;
+    reloc_begin = cmd->reloc_used;
+
     if (cmd_gen(cmd) >= INTEL_GEN(7)) {
         gen7_cc_states(cmd);
         gen7_viewport_states(cmd);
@@ -2380,6 +2616,8 @@ static void emit_bounded_states(struct intel_cmd *cmd)
 
     gen6_3DSTATE_VERTEX_BUFFERS(cmd);
     gen6_3DSTATE_VS(cmd);
+
+    cmd_batch_shadow(cmd, begin, reloc_begin);
 }
 
 static uint32_t gen6_meta_DEPTH_STENCIL_STATE(struct intel_cmd *cmd,
@@ -3612,6 +3850,7 @@ void cmd_draw_meta(struct intel_cmd *cmd, const struct intel_cmd_meta *meta)
 
     /* make the normal path believe the render pass has changed */
     cmd->bind.render_pass_changed = true;
+    cmd_batch_shadow_invalidate(cmd);
 
     if (intel_debug & INTEL_DEBUG_NOCACHE)
         cmd_batch_flush_all(cmd);
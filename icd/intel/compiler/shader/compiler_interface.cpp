@@ -36,6 +36,7 @@
 #include "compiler/mesa-utils/src/mesa/main/context.h"
 #include "compiler/mesa-utils/src/mesa/main/config.h"
 #include "compiler/shader/standalone_scaffolding.h"
+#include "compiler/shader/shader_diskcache.h"
 #include "compiler/pipeline/brw_wm.h"
 #include "compiler/pipeline/brw_shader.h"
 #include "SPIRV/spirv.hpp"
@@ -283,6 +284,22 @@ initialize_mesa_constants(struct gl_context *ctx)
    ctx->Const.GlassMode = 0;
 }
 
+#define GET_STRING_STR(x) #x
+#define GET_STRING_XSTR(x) GET_STRING_STR(x)
+
+// The shader cache tags its entries with these, so the renderer names the driver version
+static const GLubyte *get_string(struct gl_context *ctx, GLenum name)
+{
+    switch (name) {
+    case GL_VENDOR:
+        return (const GLubyte *) "Intel";
+    case GL_RENDERER:
+        return (const GLubyte *) "Intel Sample Driver " GET_STRING_XSTR(INTEL_DRIVER_VERSION);
+    default:
+        return NULL;
+    }
+}
+
 void initialize_mesa_context_to_defaults(struct gl_context *ctx)
 {
    memset(ctx, 0, sizeof(*ctx));
@@ -337,29 +354,28 @@ void initialize_mesa_context_to_defaults(struct gl_context *ctx)
 
    ctx->Driver.NewShader = _mesa_new_shader;
    ctx->Driver.DeleteShader = _mesa_delete_shader;
+   ctx->Driver.GetString = get_string;
 }
 
 
-extern "C" {
+// The front end keeps the builtin functions and the glsl_type tables around
+// for the life of the process, as Mesa does, so that shaders can be
+// translated on several threads at once.  Releasing them after each shader
+// would pull them out from under the other threads.
+static once_flag compiler_init_once = ONCE_FLAG_INIT;
 
-// invoke front end compiler to generate an independently linked
-// program object that contains Mesa HIR
-struct intel_ir *shader_create_ir(const struct intel_gpu *gpu,
-                                  const void *code, size_t size,
-                                  VkShaderStageFlagBits stage)
+static void shader_compiler_init(void)
 {
-    struct icd_spv_header header;
-    struct gl_context local_ctx;
-    struct gl_context *ctx = &local_ctx;
-
-    memcpy(&header, code, sizeof(header));
-    if (header.magic != ICD_SPV_MAGIC) {
-        return NULL;
-    }
-
     _mesa_create_shader_compiler();
-    initialize_mesa_context_to_defaults(ctx);
+    atexit(_mesa_destroy_shader_compiler);
+}
 
+// create a program holding one shader for the code, ready to be compiled
+static struct gl_shader_program *shader_program_create(struct gl_context *ctx,
+                                                       const struct icd_spv_header *header,
+                                                       const void *code, size_t size,
+                                                       VkShaderStageFlagBits stage)
+{
     struct gl_shader_program *shader_program = brw_new_shader_program(ctx, 0);
     assert(shader_program != NULL);
 
@@ -374,11 +390,11 @@ struct intel_ir *shader_create_ir(const struct intel_gpu *gpu,
     shader_program->Shaders[shader_program->NumShaders] = shader;
     shader_program->NumShaders++;
 
-    if (header.version == 0) {
+    if (header->version == 0) {
         // version 0 means we really have GLSL Source
-        shader->Source = (const char *) code + sizeof(header);
+        shader->Source = (const char *) code + sizeof(*header);
 
-        switch(header.gen_magic) {
+        switch(header->gen_magic) {
         case VK_SHADER_STAGE_VERTEX_BIT:
             shader->Type = GL_VERTEX_SHADER;
             break;
@@ -417,6 +433,46 @@ struct intel_ir *shader_create_ir(const struct intel_gpu *gpu,
 
     shader_program->Type = shader->Stage;
 
+    return shader_program;
+}
+
+extern "C" {
+
+// invoke front end compiler to generate an independently linked
+// program object that contains Mesa HIR
+struct intel_ir *shader_create_ir(const struct intel_gpu *gpu,
+                                  const void *code, size_t size,
+                                  VkShaderStageFlagBits stage)
+{
+    struct icd_spv_header header;
+    struct gl_context local_ctx;
+    struct gl_context *ctx = &local_ctx;
+
+    memcpy(&header, code, sizeof(header));
+    if (header.magic != ICD_SPV_MAGIC) {
+        return NULL;
+    }
+
+    call_once(&compiler_init_once, shader_compiler_init);
+    initialize_mesa_context_to_defaults(ctx);
+
+    struct gl_shader_program *shader_program =
+        shader_program_create(ctx, &header, code, size, stage);
+    struct gl_shader *shader = shader_program->Shaders[0];
+
+    // a module seen before, by this or an earlier process, is read back
+    // instead of being translated again
+    int cached = shader_diskcache_load_program(ctx, shader_program, code, size);
+    if (cached > 0)
+        return (struct intel_ir *) shader_program;
+
+    if (cached < 0) {
+        // an entry from another build, or a damaged one; start over
+        shader_destroy_ir((struct intel_ir *) shader_program);
+        shader_program = shader_program_create(ctx, &header, code, size, stage);
+        shader = shader_program->Shaders[0];
+    }
+
     bool dump_ast = false;
     bool dump_SPV = false;
     bool dump_hir = false;
@@ -432,7 +488,7 @@ struct intel_ir *shader_create_ir(const struct intel_gpu *gpu,
     }
 
     if (!shader->CompileStatus) {
-        _mesa_destroy_shader_compiler();
+        shader_destroy_ir((struct intel_ir *) shader_program);
         return NULL;
     }
 
@@ -450,11 +506,12 @@ struct intel_ir *shader_create_ir(const struct intel_gpu *gpu,
     }
 
     if (!shader_program->LinkStatus) {
-        _mesa_destroy_shader_compiler();
+        shader_destroy_ir((struct intel_ir *) shader_program);
         return NULL;
     }
 
-    _mesa_destroy_shader_compiler();
+    // the backend modifies the IR in place, so store it before it gets there
+    shader_diskcache_store_program(ctx, shader_program, code, size);
 
     return (struct intel_ir *) shader_program;
 }
@@ -464,14 +521,30 @@ void shader_create_ir_with_lock(const struct intel_gpu *gpu,
                                 VkShaderStageFlagBits stage,
                                 struct intel_ir **ir)
 {
-    // Wrap this path in a mutex until we can clean up initialization
+    // Only publishing the result is serialized.  Two threads asking for the
+    // same module and stage may both translate it; the loser frees its copy.
     static mtx_t mutex = _MTX_INITIALIZER_NP;
+    struct intel_ir *new_ir;
+
     mtx_lock(&mutex);
+    new_ir = *ir;
+    mtx_unlock(&mutex);
+    if (new_ir)
+        return;
 
-    if (!*ir)
-        *ir = shader_create_ir(gpu, code, size, stage);
+    new_ir = shader_create_ir(gpu, code, size, stage);
+    if (!new_ir)
+        return;
 
+    mtx_lock(&mutex);
+    if (!*ir) {
+        *ir = new_ir;
+        new_ir = NULL;
+    }
     mtx_unlock(&mutex);
+
+    if (new_ir)
+        shader_destroy_ir(new_ir);
 }
 
 void shader_destroy_ir(struct intel_ir *ir)
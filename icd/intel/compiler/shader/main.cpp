@@ -26,6 +26,9 @@
 #include <assert.h>
 #include <string.h>
 #include <inttypes.h>
+#include <dirent.h>
+#include <time.h>
+#include <unistd.h>
 
 /** @file main.cpp
  *
@@ -132,10 +135,149 @@ bool checkFileExt(char* fileName, const char* ext)
     return true;
 }
 
+static void* load_shader_file(char *fileName, size_t *psize, VkShaderStageFlagBits *pstage)
+{
+    void *shaderCode = 0;
+
+    if (checkFileExt(fileName, "vert.spv")) {
+        shaderCode = load_spv_file(fileName, psize);
+        *pstage = VK_SHADER_STAGE_VERTEX_BIT;
+    } else if (checkFileExt(fileName, "frag.spv")) {
+        shaderCode = load_spv_file(fileName, psize);
+        *pstage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    } else if (checkFileExt(fileName, "geom.spv")) {
+        shaderCode = load_spv_file(fileName, psize);
+        *pstage = VK_SHADER_STAGE_GEOMETRY_BIT;
+    } else if (checkFileExt(fileName, ".spv")) {
+        shaderCode = load_spv_file(fileName, psize);
+    } else if (checkFileExt(fileName, ".vert")) {
+        *pstage = VK_SHADER_STAGE_VERTEX_BIT;
+    } else if (checkFileExt(fileName, ".geom")) {
+        *pstage = VK_SHADER_STAGE_GEOMETRY_BIT;
+    } else if (checkFileExt(fileName, ".frag")) {
+        *pstage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    } else {
+        return NULL;
+    }
+
+    if (!shaderCode)
+        shaderCode = load_glsl_file(fileName, psize, *pstage);
+
+    return shaderCode;
+}
+
+
+static uint64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_nsec + ts.tv_sec*INT64_C(1000000000);
+}
+
+
+// Times the front end over a set of shaders three times: with the IR cache
+// off, filling an empty cache, and reading back from it.  The shaders read
+// back from the cache are also run through the backend, to check that what
+// the cache returns can be compiled.
+//
+// The tests write their shaders out with "--save-SPV", so
+//   cd <build>/tests && ./vk_layer_validation_tests --save-SPV
+//   standalone_compiler --benchmark <build>/tests/*.spv
+// times the tests' shader corpus.
+static int benchmark(int fileCount, char **fileNames)
+{
+    static const char *passNames[3] = { "no cache", "cold cache", "warm cache" };
+    void **shaderCode = (void **) calloc(fileCount, sizeof(void *));
+    size_t *size = (size_t *) calloc(fileCount, sizeof(size_t));
+    VkShaderStageFlagBits *stage = (VkShaderStageFlagBits *) calloc(fileCount, sizeof(VkShaderStageFlagBits));
+    uint64_t total[3] = { 0, 0, 0 };
+    int status = EXIT_SUCCESS;
+
+    for (int i = 0; i < fileCount; i++) {
+        stage[i] = VK_SHADER_STAGE_VERTEX_BIT;
+        shaderCode[i] = load_shader_file(fileNames[i], &size[i], &stage[i]);
+        if (!shaderCode[i]) {
+            printf("cannot load %s\n", fileNames[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    char cacheDir[] = "/tmp/intel_icd_ir.XXXXXX";
+    if (!mkdtemp(cacheDir)) {
+        printf("cannot create a cache directory\n");
+        return EXIT_FAILURE;
+    }
+
+    // Set up only the fields needed for backend compile
+    struct intel_gpu gpu = { 0 };
+    gpu.gen_opaque = INTEL_GEN(7.5);
+    gpu.gt = 3;
+
+    for (int pass = 0; pass < 3; pass++) {
+        setenv("VK_INTEL_IR_CACHE", pass == 0 ? "0" : cacheDir, 1);
+
+        for (int i = 0; i < fileCount; i++) {
+            uint64_t before = now_ns();
+            struct intel_ir *shader_program = shader_create_ir(NULL, shaderCode[i], size[i], stage[i]);
+            uint64_t elapsed = now_ns() - before;
+
+            if (!shader_program) {
+                printf("file: %s, front end compile failed\n", fileNames[i]);
+                status = EXIT_FAILURE;
+                continue;
+            }
+
+            total[pass] += elapsed;
+            printf("file: %s, %s = %.3f milliseconds\n", fileNames[i], passNames[pass], elapsed / 1000000.0);
+
+            if (pass == 2) {
+                struct intel_pipeline_shader pipe_shader;
+                if (intel_pipeline_shader_compile(&pipe_shader, &gpu, NULL, NULL, shader_program) == VK_SUCCESS) {
+                    intel_pipeline_shader_cleanup(&pipe_shader, &gpu);
+                } else {
+                    printf("file: %s, backend compile of cached IR failed\n", fileNames[i]);
+                    status = EXIT_FAILURE;
+                }
+            }
+
+            shader_destroy_ir(shader_program);
+        }
+    }
+
+    for (int pass = 0; pass < 3; pass++)
+        printf("%d shaders, %s = %.3f milliseconds\n", fileCount, passNames[pass], total[pass] / 1000000.0);
+    fflush(stdout);
+
+    DIR *dir = opendir(cacheDir);
+    if (dir) {
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (entry->d_name[0] == '.')
+                continue;
+            char path[sizeof(cacheDir) + 256];
+            snprintf(path, sizeof(path), "%s/%s", cacheDir, entry->d_name);
+            unlink(path);
+        }
+        closedir(dir);
+    }
+    rmdir(cacheDir);
+
+    for (int i = 0; i < fileCount; i++)
+        free(shaderCode[i]);
+    free(shaderCode);
+    free(size);
+    free(stage);
+
+    return status;
+}
+
 int main(int argc, char **argv)
 {
    int status = EXIT_SUCCESS;
 
+   if (argc > 2 && strcmp(argv[1], "--benchmark") == 0)
+       return benchmark(argc - 2, &argv[2]);
+
    switch (argc) {
    case 2:
        {
@@ -144,35 +286,11 @@ int main(int argc, char **argv)
            printf("Frontend compile %s\n", argv[1]);
            fflush(stdout);
 
-           void *shaderCode = 0;
            size_t size = 0;
            VkShaderStageFlagBits stage = VK_SHADER_STAGE_VERTEX_BIT;
-
-           if (checkFileExt(argv[1], "vert.spv")) {
-               shaderCode = load_spv_file(argv[1], &size);
-               stage = VK_SHADER_STAGE_VERTEX_BIT;
-           } else if (checkFileExt(argv[1], "frag.spv")) {
-               shaderCode = load_spv_file(argv[1], &size);
-               stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-           } else if (checkFileExt(argv[1], "geom.spv")) {
-               shaderCode = load_spv_file(argv[1], &size);
-               stage = VK_SHADER_STAGE_GEOMETRY_BIT;
-           } else if (checkFileExt(argv[1], ".spv")) {
-               shaderCode = load_spv_file(argv[1], &size);
-           } else if (checkFileExt(argv[1], ".vert")) {
-               stage = VK_SHADER_STAGE_VERTEX_BIT;
-           } else if (checkFileExt(argv[1], ".geom")) {
-               stage = VK_SHADER_STAGE_GEOMETRY_BIT;
-           } else if (checkFileExt(argv[1], ".frag")) {
-               stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-           } else {
-               return EXIT_FAILURE;
-           }
-
+           void *shaderCode = load_shader_file(argv[1], &size, &stage);
            if (!shaderCode)
-               shaderCode = load_glsl_file(argv[1], &size, stage);
-
-           assert(shaderCode);
+               return EXIT_FAILURE;
 
            struct intel_ir *shader_program = shader_create_ir(NULL, shaderCode, size, stage);
            assert(shader_program);
@@ -245,7 +363,8 @@ int main(int argc, char **argv)
    case 0:
    case 1:
    default:
-       printf("Please provide one .spv, .vert or .frag file as input\n");
+       printf("Please provide one .spv, .vert or .frag file as input,\n"
+              "or --benchmark followed by any number of them\n");
        break;
    }
 
@@ -25,7 +25,6 @@
 #include "shader_cache.h"
 #include "ir_deserializer.h"
 #include "main/context.h"
-#include "main/shaderapi.h"
 
 #if 0
 static struct gl_program_parameter_list*
@@ -125,6 +124,46 @@ read_uniform_storage(void *mem_ctx, gl_uniform_storage *uni, memory_map &map)
 }
 
 
+static bool
+read_uniform_blocks(void *mem_ctx, struct gl_shader *shader, memory_map &map)
+{
+   if (shader->NumUniformBlocks == 0)
+      return true;
+
+   shader->UniformBlocks = rzalloc_array(mem_ctx, struct gl_uniform_block,
+                                         shader->NumUniformBlocks);
+
+   for (unsigned i = 0; i < shader->NumUniformBlocks; i++) {
+      struct gl_uniform_block *block = &shader->UniformBlocks[i];
+
+      block->Name = ralloc_strdup(mem_ctx, map.read_string());
+      block->NumUniforms = map.read_uint32_t();
+      block->Binding = map.read_uint32_t();
+      block->UniformBufferSize = map.read_uint32_t();
+      block->_Packing = (enum gl_uniform_block_packing) map.read_uint32_t();
+
+      if (map.errors() || !block->Name ||
+          block->NumUniforms > (unsigned) map.size())
+         return false;
+
+      block->Uniforms = rzalloc_array(mem_ctx, struct gl_uniform_buffer_variable,
+                                      block->NumUniforms);
+
+      for (unsigned j = 0; j < block->NumUniforms; j++) {
+         struct gl_uniform_buffer_variable *var = &block->Uniforms[j];
+
+         var->Name = ralloc_strdup(mem_ctx, map.read_string());
+         var->IndexName = ralloc_strdup(mem_ctx, map.read_string());
+         var->Type = NULL;
+         var->Offset = map.read_uint32_t();
+         var->RowMajor = map.read_uint8_t();
+      }
+   }
+
+   return !map.errors();
+}
+
+
 static ir_variable *
 search_var(struct exec_list *list, const char *name)
 {
@@ -226,7 +265,6 @@ read_shader_in_place(struct gl_context *ctx, void *mem_ctx, memory_map &map, ir_
    uint32_t type = map.read_uint32_t();
 
    GLuint name;
-   GLint refcount;
    const char* source;
 
    bool shader_cleanup = false;
@@ -255,18 +293,11 @@ read_shader_in_place(struct gl_context *ctx, void *mem_ctx, memory_map &map, ir_
 
    /* Set the fields we already know */
    name = shader->Name;
-   refcount = shader->RefCount;
    source = shader->Source;
 
-   /* If anything has been added to gl_shader_program, we need to grok it for
-    * deserialization.  i.e. does it make sense to cache a mutex id?  No.
-    * Below is size for mesa-10.2.5 with deferred compilation.
+   /* LunarG: The size of gl_shader is part of cache_validation_data, so a
+    * cache written with a different layout is rejected before we get here.
     */
-   #if defined(i386) || defined(__i386__)
-      STATIC_ASSERT(sizeof(gl_shader) == 400);
-   #else
-      STATIC_ASSERT(sizeof(gl_shader) == 464);
-   #endif
 
    /* Reading individual fields and structs would slow us down here. This is
     * slightly dangerous though and we need to take care to initialize any
@@ -283,7 +314,6 @@ read_shader_in_place(struct gl_context *ctx, void *mem_ctx, memory_map &map, ir_
 
    /* Set correct name and refcount. */
    shader->Name = name;
-   shader->RefCount = refcount;
    shader->Source = source;
 
    /* clear all pointer fields, only data preserved */
@@ -294,18 +324,24 @@ read_shader_in_place(struct gl_context *ctx, void *mem_ctx, memory_map &map, ir_
    shader->ir = NULL;
    shader->symbols = NULL;
 
+   if (!read_uniform_blocks(mem_ctx, shader, map))
+      goto error_deserialize;
+
    stage = _mesa_shader_enum_to_shader_stage(shader->Type);
 
-   prog =
-      ctx->Driver.NewProgram(ctx, _mesa_shader_stage_to_program(stage),
-                             shader->Name);
+   /* LunarG: The backend creates the gl_program in brw_link_shader() */
+   if (ctx->Driver.NewProgram) {
+      prog =
+         ctx->Driver.NewProgram(ctx, _mesa_shader_stage_to_program(stage),
+                                shader->Name);
 
-   if (!prog)
-      goto error_deserialize;
-   else
-      program_cleanup = true;
+      if (!prog)
+         goto error_deserialize;
+      else
+         program_cleanup = true;
 
-   _mesa_reference_program(ctx, &shader->Program, prog);
+      _mesa_reference_program(ctx, &shader->Program, prog);
+   }
 
    /* IR tree */
    if (!s.deserialize(ctx, mem_ctx, shader, &map))
@@ -371,15 +407,7 @@ deserialize_program(struct gl_context *ctx, struct gl_shader_program *prog, memo
 
    struct gl_shader_program tmp_prog;
 
-   /* If anything has been added to gl_shader_program, we need to grok it for
-    * deserialization.  i.e. does it make sense to cache a mutex id?  No.
-    * Below is size for mesa-10.2.5 with deferred compilation.
-    */
-   #if defined(i386) || defined(__i386__)
-      STATIC_ASSERT(sizeof(gl_shader_program) == 268);
-   #else
-      STATIC_ASSERT(sizeof(gl_shader_program) == 408);
-   #endif
+   /* LunarG: The size of gl_shader_program is part of cache_validation_data */
 
    /* Read up to (but exclude) gl_shader_program::Mutex to avoid races */
    map.read(&tmp_prog, offsetof(gl_shader_program, Mutex));
@@ -392,6 +420,7 @@ deserialize_program(struct gl_context *ctx, struct gl_shader_program *prog, memo
       return MESA_SHADER_DESERIALIZE_READ_ERROR;
 
    prog->Type = tmp_prog.Type;
+   prog->SeparateShader = tmp_prog.SeparateShader;
    prog->Version = tmp_prog.Version;
    prog->IsES = tmp_prog.IsES;
    prog->NumUserUniformStorage = tmp_prog.NumUserUniformStorage;
@@ -452,6 +481,9 @@ deserialize_program(struct gl_context *ctx, struct gl_shader_program *prog, memo
    for (unsigned i = 0; i < shader_amount; i++) {
       uint32_t index = map.read_uint32_t();
 
+      if (index >= MESA_SHADER_STAGES)
+         return MESA_SHADER_DESERIALIZE_READ_ERROR;
+
       struct gl_shader *sha = read_shader(ctx, prog, map, s);
 
       if (!sha)
@@ -461,14 +493,7 @@ deserialize_program(struct gl_context *ctx, struct gl_shader_program *prog, memo
 
       _mesa_reference_shader(ctx, &prog->_LinkedShaders[index], sha);
 
-      struct gl_program *linked_prog = ctx->Driver.GetProgram(ctx, prog, sha);
-      if (linked_prog) {
-         _mesa_copy_linked_program_data((gl_shader_stage) index,
-                                        prog, linked_prog);
-         _mesa_reference_program(ctx, &sha->Program, linked_prog);
-         _mesa_reference_program(ctx, &linked_prog, NULL);
-      }
-
+      /* LunarG: brw_link_shader() copies the linked program data itself */
    }
 
    /* set default values for uniforms that have initializer */
@@ -0,0 +1,436 @@
+/*
+ *
+ * Copyright (C) 2016 LunarG, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <vector>
+#include <dirent.h>
+#include <dlfcn.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include "intel.h"
+#include "shader_diskcache.h"
+#include "shader_cache.h"
+
+#define SHADER_DISKCACHE_MAGIC   0x52494349  /* "ICIR" */
+#define SHADER_DISKCACHE_VERSION 2
+
+/* default for VK_INTEL_IR_CACHE_SIZE, in MB */
+#define SHADER_DISKCACHE_DEFAULT_SIZE_MB 128
+
+/*
+ * An entry is this header, a copy of the shader code, then the data.  The
+ * code is compared on load, so a hash collision is a miss and not a wrong
+ * shader.  Entries written by another driver version or another build of
+ * the compiler hash to other names and are rejected if they are found.
+ */
+struct shader_diskcache_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t stage;
+    uint32_t driver_version;
+    uint64_t build_id;
+    uint64_t code_size;
+    uint64_t data_size;
+};
+
+/*
+ * Identifies the build of the compiler, which the serialized IR depends
+ * on: the modification time of the library or executable it is linked
+ * into, as Mesa's cache does.
+ */
+static uint64_t shader_diskcache_build_id(void)
+{
+    static uint64_t build_id;
+    Dl_info info;
+    struct stat st;
+
+    if (build_id)
+        return build_id;
+
+    if (dladdr((void *) shader_diskcache_build_id, &info) &&
+        info.dli_fname && stat(info.dli_fname, &st) == 0)
+        build_id = (uint64_t) st.st_mtime;
+    else
+        build_id = 1;
+
+    return build_id;
+}
+
+static void shader_diskcache_hash(const void *code, size_t code_size,
+                                  uint32_t stage, uint64_t key[2])
+{
+    const uint8_t *bytes = (const uint8_t *) code;
+    uint64_t h0 = (0xcbf29ce484222325ull ^ stage) + shader_diskcache_build_id();
+    uint64_t h1 = (0x84222325cbf29ce4ull ^ code_size) + INTEL_DRIVER_VERSION;
+    size_t i;
+
+    for (i = 0; i < code_size; i++) {
+        h0 = (h0 ^ bytes[i]) * 0x100000001b3ull;
+        h1 = (h1 + bytes[i]) * 0xff51afd7ed558ccdull;
+        h1 ^= h1 >> 29;
+    }
+
+    key[0] = h0;
+    key[1] = h1;
+}
+
+/* returns a malloc()ed directory name, or NULL when the cache is off */
+static char *shader_diskcache_dir(void)
+{
+    const char *env = getenv("VK_INTEL_IR_CACHE");
+    const char *root;
+    char *dir;
+
+    if (env && env[0]) {
+        if (strcmp(env, "0") == 0)
+            return NULL;
+        return strdup(env);
+    }
+
+    root = getenv("XDG_CACHE_HOME");
+    if (root && root[0]) {
+        if (asprintf(&dir, "%s/intel_icd_ir", root) < 0)
+            return NULL;
+        return dir;
+    }
+
+    root = getenv("HOME");
+    if (!root || !root[0])
+        return NULL;
+
+    if (asprintf(&dir, "%s/.cache/intel_icd_ir", root) < 0)
+        return NULL;
+    return dir;
+}
+
+static char *shader_diskcache_path(const char *dir, const void *code,
+                                   size_t code_size, uint32_t stage)
+{
+    uint64_t key[2];
+    char *path;
+
+    shader_diskcache_hash(code, code_size, stage, key);
+
+    if (asprintf(&path, "%s/%016llx%016llx.%x", dir,
+                 (unsigned long long) key[0], (unsigned long long) key[1],
+                 stage) < 0)
+        return NULL;
+
+    return path;
+}
+
+/* like "mkdir -p" */
+static bool shader_diskcache_mkdir(char *dir)
+{
+    char *p;
+
+    for (p = dir + 1; *p; p++) {
+        if (*p != '/')
+            continue;
+
+        *p = '\0';
+        if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+            *p = '/';
+            return false;
+        }
+        *p = '/';
+    }
+
+    return mkdir(dir, 0755) == 0 || errno == EEXIST;
+}
+
+/* returns a malloc()ed copy of the cached data, or NULL on a miss */
+static void *shader_diskcache_load(const void *code, size_t code_size,
+                                   uint32_t stage, size_t *size)
+{
+    struct shader_diskcache_header header;
+    char *dir, *path;
+    void *cached_code = NULL, *data = NULL;
+    FILE *fp;
+
+    dir = shader_diskcache_dir();
+    if (!dir)
+        return NULL;
+
+    path = shader_diskcache_path(dir, code, code_size, stage);
+    free(dir);
+    if (!path)
+        return NULL;
+
+    fp = fopen(path, "rb");
+    if (!fp) {
+        free(path);
+        return NULL;
+    }
+
+    if (fread(&header, sizeof(header), 1, fp) != 1 ||
+        header.magic != SHADER_DISKCACHE_MAGIC ||
+        header.version != SHADER_DISKCACHE_VERSION ||
+        header.driver_version != INTEL_DRIVER_VERSION ||
+        header.build_id != shader_diskcache_build_id() ||
+        header.stage != stage ||
+        header.code_size != code_size ||
+        header.data_size == 0 || header.data_size > SIZE_MAX)
+        goto fail;
+
+    cached_code = malloc(code_size);
+    data = malloc((size_t) header.data_size);
+    if (!cached_code || !data)
+        goto fail;
+
+    if (fread(cached_code, code_size, 1, fp) != 1 ||
+        memcmp(cached_code, code, code_size) != 0 ||
+        fread(data, (size_t) header.data_size, 1, fp) != 1)
+        goto fail;
+
+    free(cached_code);
+    fclose(fp);
+
+    /* eviction goes by modification time, so mark the entry as used */
+    utimes(path, NULL);
+    free(path);
+
+    *size = (size_t) header.data_size;
+    return data;
+
+fail:
+    free(cached_code);
+    free(data);
+    fclose(fp);
+    free(path);
+    return NULL;
+}
+
+static uint64_t shader_diskcache_max_size(void)
+{
+    const char *env = getenv("VK_INTEL_IR_CACHE_SIZE");
+    uint64_t mb = SHADER_DISKCACHE_DEFAULT_SIZE_MB;
+
+    if (env && env[0])
+        mb = strtoull(env, NULL, 10);
+
+    return mb * 1024 * 1024;
+}
+
+struct shader_diskcache_file {
+    char *path;
+    time_t mtime;
+    uint64_t size;
+};
+
+static bool shader_diskcache_older(const shader_diskcache_file &a,
+                                   const shader_diskcache_file &b)
+{
+    return a.mtime < b.mtime;
+}
+
+/*
+ * Removes the least recently used entries once the cache holds more than
+ * VK_INTEL_IR_CACHE_SIZE MB, down to 3/4 of that so that the next few
+ * stores do not have to scan the directory again.
+ */
+static void shader_diskcache_evict(const char *dir)
+{
+    std::vector<shader_diskcache_file> files;
+    uint64_t max_size = shader_diskcache_max_size();
+    uint64_t total = 0;
+    struct dirent *ent;
+    size_t i;
+    DIR *d;
+
+    d = opendir(dir);
+    if (!d)
+        return;
+
+    while ((ent = readdir(d)) != NULL) {
+        shader_diskcache_file file;
+        struct stat st;
+        const char *dot = strchr(ent->d_name, '.');
+
+        /* only entries, "<32 hex digits>.<stage>", not temporary files */
+        if (!dot || dot - ent->d_name != 32 || strchr(dot + 1, '.'))
+            continue;
+
+        if (asprintf(&file.path, "%s/%s", dir, ent->d_name) < 0)
+            continue;
+
+        if (stat(file.path, &st) != 0 || !S_ISREG(st.st_mode)) {
+            free(file.path);
+            continue;
+        }
+
+        file.mtime = st.st_mtime;
+        file.size = (uint64_t) st.st_size;
+        total += file.size;
+        files.push_back(file);
+    }
+    closedir(d);
+
+    if (total > max_size) {
+        std::sort(files.begin(), files.end(), shader_diskcache_older);
+        for (i = 0; i < files.size() && total > max_size / 4 * 3; i++) {
+            if (unlink(files[i].path) == 0)
+                total -= files[i].size;
+        }
+    }
+
+    for (i = 0; i < files.size(); i++)
+        free(files[i].path);
+}
+
+static void shader_diskcache_store(const void *code, size_t code_size,
+                                   uint32_t stage, const void *data,
+                                   size_t size)
+{
+    static uint32_t tmp_serial;
+    struct shader_diskcache_header header;
+    char *dir, *path = NULL, *tmp_path = NULL;
+    bool ok;
+    FILE *fp;
+
+    dir = shader_diskcache_dir();
+    if (!dir)
+        return;
+
+    if (!shader_diskcache_mkdir(dir))
+        goto out;
+
+    path = shader_diskcache_path(dir, code, code_size, stage);
+    if (!path)
+        goto out;
+
+    /*
+     * Write to a file of our own and rename it into place, so that readers
+     * in this or another process never see a partial entry.
+     */
+    if (asprintf(&tmp_path, "%s.%d.%u", path, (int) getpid(),
+                 __sync_fetch_and_add(&tmp_serial, 1)) < 0) {
+        tmp_path = NULL;
+        goto out;
+    }
+
+    fp = fopen(tmp_path, "wb");
+    if (!fp)
+        goto out;
+
+    memset(&header, 0, sizeof(header));
+    header.magic = SHADER_DISKCACHE_MAGIC;
+    header.version = SHADER_DISKCACHE_VERSION;
+    header.stage = stage;
+    header.driver_version = INTEL_DRIVER_VERSION;
+    header.build_id = shader_diskcache_build_id();
+    header.code_size = code_size;
+    header.data_size = size;
+
+    ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+         fwrite(code, code_size, 1, fp) == 1 &&
+         fwrite(data, size, 1, fp) == 1;
+    ok = (fclose(fp) == 0) && ok;
+
+    if (!ok || rename(tmp_path, path) != 0)
+        unlink(tmp_path);
+    else
+        shader_diskcache_evict(dir);
+
+out:
+    free(tmp_path);
+    free(path);
+    free(dir);
+}
+
+extern "C" int shader_diskcache_load_program(struct gl_context *ctx,
+                                             struct gl_shader_program *prog,
+                                             const void *code,
+                                             size_t code_size)
+{
+    uint32_t stage = prog->Shaders[0]->Stage;
+    size_t size;
+    void *data;
+    int err;
+
+    data = shader_diskcache_load(code, code_size, stage, &size);
+    if (!data)
+        return 0;
+
+    err = mesa_program_deserialize(ctx, prog, data, size);
+    free(data);
+
+    return err ? -1 : 1;
+}
+
+extern "C" void shader_diskcache_store_program(struct gl_context *ctx,
+                                               struct gl_shader_program *prog,
+                                               const void *code,
+                                               size_t code_size)
+{
+    uint32_t stage = prog->Shaders[0]->Stage;
+    size_t size;
+    char *data;
+
+    data = mesa_program_serialize(ctx, prog, &size);
+    if (!data)
+        return;
+
+    shader_diskcache_store(code, code_size, stage, data, size);
+    free(data);
+}
+
+/*
+ * Features not supported by the serializer.  These live with
+ * prog_diskcache.c in Mesa, which is not built here.
+ */
+extern "C" bool
+supported_by_program_cache(struct gl_shader_program *prog, bool is_write)
+{
+    /* No geometry shader support. */
+    if (prog->_LinkedShaders[MESA_SHADER_GEOMETRY])
+        return false;
+
+    /* No transform feedback support. */
+    if (prog->TransformFeedback.NumVarying > 0)
+        return false;
+
+    if (is_write && prog->UniformStorage) {
+        /* Uniform structs are not working */
+        for (unsigned i = 0; i < prog->NumUserUniformStorage; i++) {
+            if (strchr(prog->UniformStorage[i].name, '.'))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+extern "C" bool
+supported_by_shader_cache(struct gl_shader *shader, bool is_write)
+{
+    /* No geometry shader support. */
+    return shader->Stage != MESA_SHADER_GEOMETRY;
+}
@@ -0,0 +1,67 @@
+/*
+ *
+ * Copyright (C) 2016 LunarG, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef SHADER_DISKCACHE_H
+#define SHADER_DISKCACHE_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct gl_context;
+struct gl_shader_program;
+
+/*
+ * On-disk cache of linked front end output, keyed by the shader code and
+ * stage.
+ *
+ * Entries live in $VK_INTEL_IR_CACHE, or in intel_icd_ir under
+ * $XDG_CACHE_HOME (~/.cache when unset).  VK_INTEL_IR_CACHE=0 turns the
+ * cache off.  Entries are only used by the driver version and build of the
+ * compiler that wrote them.  Once the cache holds more than
+ * $VK_INTEL_IR_CACHE_SIZE MB (128 when unset), the least recently used
+ * entries are removed.
+ */
+
+/*
+ * Fills in prog, which holds the unlinked shader for code, from the cache.
+ * Returns 1 on a hit and 0 when there is no entry.  -1 means an entry could
+ * not be read and prog has been partly filled in.
+ */
+int shader_diskcache_load_program(struct gl_context *ctx,
+                                  struct gl_shader_program *prog,
+                                  const void *code, size_t code_size);
+
+/* stores a linked prog, before the backend has touched its IR */
+void shader_diskcache_store_program(struct gl_context *ctx,
+                                    struct gl_shader_program *prog,
+                                    const void *code, size_t code_size);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* SHADER_DISKCACHE_H */
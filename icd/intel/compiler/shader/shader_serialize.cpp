@@ -33,6 +33,34 @@ mesa_get_shader_cache_magic()
    return MESA_SHADER_CACHE_MAGIC;
 }
 
+/**
+ * Serializes the parts of a linked shader's uniform blocks that the backend
+ * uses in lower_ubo_reference() and for the binding table.  The types of the
+ * block members are not written, nothing reads them after linking.
+ */
+static void
+serialize_uniform_blocks(struct gl_shader *shader, memory_writer &blob)
+{
+   for (unsigned i = 0; i < shader->NumUniformBlocks; i++) {
+      struct gl_uniform_block *block = &shader->UniformBlocks[i];
+
+      blob.write_string(block->Name);
+      blob.write_uint32_t(block->NumUniforms);
+      blob.write_uint32_t(block->Binding);
+      blob.write_uint32_t(block->UniformBufferSize);
+      blob.write_uint32_t(block->_Packing);
+
+      for (unsigned j = 0; j < block->NumUniforms; j++) {
+         struct gl_uniform_buffer_variable *var = &block->Uniforms[j];
+
+         blob.write_string(var->Name);
+         blob.write_string(var->IndexName);
+         blob.write_uint32_t(var->Offset);
+         blob.write_uint8_t(var->RowMajor);
+      }
+   }
+}
+
 /**
  * Serializes gl_shader structure, writes shader header
  * information and exec_list of instructions
@@ -72,6 +100,8 @@ mesa_shader_serialize(struct gl_context *ctx, struct gl_shader *shader, size_t *
 
    blob.write(shader, sizeof(struct gl_shader));
 
+   serialize_uniform_blocks(shader, blob);
+
    /* dump all shader instructions */
    serialize_list(shader->ir, blob);
 
@@ -264,6 +264,22 @@ void intel_gpu_get_limits(VkPhysicalDeviceLimits *pLimits)
     pLimits->discreteQueuePriorities = 2;
 }
 
+/*
+ * Pipeline cache data holds ISA and compiler output, so it is only good for
+ * the same chip and driver version.
+ */
+void intel_gpu_get_pipeline_cache_uuid(const struct intel_gpu *gpu,
+                                       uint8_t uuid[VK_UUID_SIZE])
+{
+    const uint32_t driver_version = INTEL_DRIVER_VERSION;
+    const uint32_t devid = gpu->devid;
+
+    memset(uuid, 0, VK_UUID_SIZE);
+    memcpy(uuid, "i965", 4);
+    memcpy(uuid + 4, &driver_version, sizeof(driver_version));
+    memcpy(uuid + 8, &devid, sizeof(devid));
+}
+
 void intel_gpu_get_props(const struct intel_gpu *gpu,
                          VkPhysicalDeviceProperties *props)
 {
@@ -278,6 +294,8 @@ void intel_gpu_get_props(const struct intel_gpu *gpu,
 
     props->deviceType = VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU;
 
+    intel_gpu_get_pipeline_cache_uuid(gpu, props->pipelineCacheUUID);
+
     /* copy GPU name */
     name = gpu_get_name(gpu);
     name_len = strlen(name);
@@ -401,15 +419,19 @@ int intel_gpu_get_primary_fd(struct intel_gpu *gpu)
 
 VkResult intel_gpu_init_winsys(struct intel_gpu *gpu)
 {
-    int fd;
-
     assert(!gpu->winsys);
 
-    fd = gpu_open_render_node(gpu);
+#ifdef INTEL_FAKE_WINSYS
+    /* there is no node to open */
+    gpu->winsys = intel_winsys_create_fake(gpu->handle.instance->icd,
+            gpu->devid);
+#else
+    int fd = gpu_open_render_node(gpu);
     if (fd < 0)
         return VK_ERROR_INITIALIZATION_FAILED;
 
     gpu->winsys = intel_winsys_create_for_fd(gpu->handle.instance->icd, fd);
+#endif
     if (!gpu->winsys) {
         intel_log(gpu, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
                 VK_NULL_HANDLE, 0, 0, "failed to create GPU winsys");
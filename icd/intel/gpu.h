@@ -96,6 +96,9 @@ void intel_gpu_destroy(struct intel_gpu *gpu);
 void intel_gpu_get_props(const struct intel_gpu *gpu,
                          VkPhysicalDeviceProperties *props);
 
+void intel_gpu_get_pipeline_cache_uuid(const struct intel_gpu *gpu,
+                                       uint8_t uuid[VK_UUID_SIZE]);
+
 void intel_gpu_get_sparse_properties(VkPhysicalDeviceSparseProperties *pProps);
 
 void intel_gpu_get_limits(VkPhysicalDeviceLimits *pLimits);
@@ -94,6 +94,10 @@ static void intel_debug_init(void)
                 intel_debug |= INTEL_DEBUG_NOHIZ;
             } else if (strncmp(env, "hang", len) == 0) {
                 intel_debug |= INTEL_DEBUG_HANG;
+            } else if (strncmp(env, "nothreads", len) == 0) {
+                intel_debug |= INTEL_DEBUG_NOTHREADS;
+            } else if (strncmp(env, "noshadow", len) == 0) {
+                intel_debug |= INTEL_DEBUG_NOSHADOW;
             } else if (strncmp(env, "0x", 2) == 0) {
                 intel_debug |= INTEL_DEBUG_NOHW;
                 intel_devid_override = strtol(env, NULL, 16);
@@ -107,6 +111,28 @@ static void intel_debug_init(void)
     }
 }
 
+#ifdef INTEL_FAKE_WINSYS
+/*
+ * The fake winsys has no device to probe.  VK_INTEL_FAKE_GEN picks a GT2
+ * part of Gen 6, 7 or 7.5 (the default), unless a device id is forced with
+ * VK_INTEL_DEBUG.
+ */
+static int intel_fake_devid(void)
+{
+    const char *env = getenv("VK_INTEL_FAKE_GEN");
+
+    if (intel_devid_override)
+        return intel_devid_override;
+
+    if (env && strcmp(env, "6") == 0)
+        return 0x0126;
+    else if (env && strcmp(env, "7") == 0)
+        return 0x0162;
+    else
+        return 0x0412;
+}
+#endif
+
 static void intel_instance_add_gpu(struct intel_instance *instance,
                                    struct intel_gpu *gpu)
 {
@@ -268,7 +294,9 @@ VKAPI_ATTR VkResult VKAPI_CALL vkEnumeratePhysicalDevices(
     VkPhysicalDevice*                         pPhysicalDevices)
 {
     struct intel_instance *instance = intel_instance(instance_);
+#ifndef INTEL_FAKE_WINSYS
     struct icd_drm_device *devices, *dev;
+#endif
     VkResult ret;
     uint32_t count;
 
@@ -286,6 +314,21 @@ VKAPI_ATTR VkResult VKAPI_CALL vkEnumeratePhysicalDevices(
 
     intel_instance_remove_gpus(instance);
 
+#ifdef INTEL_FAKE_WINSYS
+    count = 0;
+    if (*pPhysicalDeviceCount) {
+        struct intel_gpu *gpu;
+
+        ret = intel_gpu_create(instance, intel_fake_devid(),
+                "fake", NULL, &gpu);
+        if (ret == VK_SUCCESS) {
+            intel_instance_add_gpu(instance, gpu);
+
+            pPhysicalDevices[count++] = (VkPhysicalDevice) gpu;
+            physicalGPU = (VkPhysicalDevice) gpu;
+        }
+    }
+#else
     devices = icd_drm_enumerate(instance->icd, 0x8086);
 
     count = 0;
@@ -317,6 +360,7 @@ VKAPI_ATTR VkResult VKAPI_CALL vkEnumeratePhysicalDevices(
     }
 
     icd_drm_release(instance->icd, devices);
+#endif
 
     *pPhysicalDeviceCount = count;
 
@@ -65,6 +65,8 @@ enum intel_debug_flags {
     INTEL_DEBUG_NOCACHE     = 1 << 21,
     INTEL_DEBUG_NOHIZ       = 1 << 22,
     INTEL_DEBUG_HANG        = 1 << 23,
+    INTEL_DEBUG_NOTHREADS   = 1 << 24,
+    INTEL_DEBUG_NOSHADOW    = 1 << 25,
 };
 
 struct intel_instance;
@@ -97,6 +97,16 @@ struct intel_winsys_handle {
 struct intel_winsys *
 intel_winsys_create_for_fd(const struct icd_instance *instance, int fd);
 
+/**
+ * Create a winsys that keeps bos in host memory and does not need a GPU.
+ * Only available when the fake winsys is built (INTEL_FAKE_WINSYS), where
+ * intel_winsys_create_for_fd() always fails.
+ *
+ * \param devid  PCI device id reported in intel_winsys_info.
+ */
+struct intel_winsys *
+intel_winsys_create_fake(const struct icd_instance *instance, int devid);
+
 void
 intel_winsys_destroy(struct intel_winsys *winsys);
 
@@ -192,6 +202,31 @@ void
 intel_winsys_decode_bo(struct intel_winsys *winsys,
                        struct intel_bo *bo, int used);
 
+/**
+ * Return the number of intel_winsys_submit_bo() calls made so far.  Fake
+ * winsys only.
+ */
+int
+intel_winsys_get_submit_count(struct intel_winsys *winsys);
+
+/**
+ * Get a copy of a recorded submission.  The fake winsys keeps the last
+ * VK_INTEL_FAKE_RECORD (16 by default) submissions; \p index 0 is the oldest
+ * of them.  \p batch stays valid until the record is replaced.  Fake winsys
+ * only.
+ */
+int
+intel_winsys_get_submission(struct intel_winsys *winsys, int index,
+                            enum intel_ring_type *ring,
+                            const void **batch, int *used);
+
+/**
+ * Decode a recorded submission, like intel_winsys_decode_bo().  Fake winsys
+ * only.
+ */
+void
+intel_winsys_decode_submission(struct intel_winsys *winsys, int index);
+
 /**
  * Increase the reference count of \p bo.  No-op when \p bo is NULL.
  */
@@ -0,0 +1,592 @@
+/*
+ * Mesa 3-D graphics library
+ *
+ * Copyright (C) 2016 LunarG, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * A winsys that keeps bos in host memory and never talks to the kernel.
+ * Submitted batches are copied and kept for inspection, and are otherwise
+ * considered executed right away.  This lets the CPU side of the driver run,
+ * and be profiled, on machines without an i915 GPU.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include <intel_bufmgr.h>
+#include <intel_chipset.h>
+
+#include "icd-instance.h"
+#include "icd-utils.h"
+#include "winsys.h"
+
+/* number of submissions kept when VK_INTEL_FAKE_RECORD is unset */
+#define FAKE_DEFAULT_RECORD_COUNT 16
+
+/* fake GTT addresses start here, so that decoded addresses are not zero */
+#define FAKE_GTT_BASE 0x100000
+
+struct fake_reloc {
+   uint32_t offset;
+   struct intel_bo *target;
+   uint32_t target_offset;
+   uint32_t flags;
+};
+
+struct intel_bo {
+   struct intel_winsys *winsys;
+   int refcount;
+
+   unsigned long size;
+   uint64_t offset64;
+   void *ptr;
+
+   enum intel_tiling_mode tiling;
+   unsigned long pitch;
+
+   struct fake_reloc *relocs;
+   int reloc_count;
+   int reloc_max;
+};
+
+struct fake_submission {
+   enum intel_ring_type ring;
+   unsigned long flags;
+   uint64_t offset64;
+   void *batch;
+   int used;
+};
+
+struct intel_winsys {
+   const struct icd_instance *instance;
+   struct intel_winsys_info info;
+
+   pthread_mutex_t mutex;
+   uint64_t next_offset;
+
+   /* the last record_max submissions, oldest first from record_head */
+   struct fake_submission *records;
+   int record_max;
+   int record_head;
+   int record_count;
+   int submit_count;
+};
+
+static void
+init_info(struct intel_winsys_info *info, int devid)
+{
+   memset(info, 0, sizeof(*info));
+
+   info->devid = devid;
+   info->aperture_total = (size_t) 2048 * 1024 * 1024;
+   info->aperture_mappable = (size_t) 256 * 1024 * 1024;
+
+   /* Sandy Bridge and later Core parts all have LLC */
+   info->has_llc = true;
+   info->has_address_swizzling = false;
+   info->has_logical_context = true;
+   info->has_ppgtt = true;
+   info->has_timestamp = true;
+
+   info->has_gen7_sol_reset = IS_GEN7(devid);
+}
+
+static int
+get_record_max(void)
+{
+   const char *env = getenv("VK_INTEL_FAKE_RECORD");
+   int val;
+
+   if (!env)
+      return FAKE_DEFAULT_RECORD_COUNT;
+
+   val = atoi(env);
+
+   return (val > 0) ? val : 0;
+}
+
+struct intel_winsys *
+intel_winsys_create_fake(const struct icd_instance *instance, int devid)
+{
+   struct intel_winsys *winsys;
+
+   winsys = icd_instance_alloc(instance, sizeof(*winsys), sizeof(int),
+           VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
+   if (!winsys)
+      return NULL;
+
+   memset(winsys, 0, sizeof(*winsys));
+
+   winsys->instance = instance;
+   init_info(&winsys->info, devid);
+   pthread_mutex_init(&winsys->mutex, NULL);
+   winsys->next_offset = FAKE_GTT_BASE;
+
+   winsys->record_max = get_record_max();
+   if (winsys->record_max) {
+      winsys->records = icd_instance_alloc(instance,
+            sizeof(winsys->records[0]) * winsys->record_max, sizeof(int),
+            VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
+      if (!winsys->records) {
+         pthread_mutex_destroy(&winsys->mutex);
+         icd_instance_free(instance, winsys);
+         return NULL;
+      }
+
+      memset(winsys->records, 0,
+            sizeof(winsys->records[0]) * winsys->record_max);
+   }
+
+   return winsys;
+}
+
+struct intel_winsys *
+intel_winsys_create_for_fd(const struct icd_instance *instance, int fd)
+{
+   /* there is no device behind fd to ask for its id */
+   return NULL;
+}
+
+void
+intel_winsys_destroy(struct intel_winsys *winsys)
+{
+   int i;
+
+   for (i = 0; i < winsys->record_count; i++)
+      free(winsys->records[i].batch);
+
+   if (winsys->records)
+      icd_instance_free(winsys->instance, winsys->records);
+
+   pthread_mutex_destroy(&winsys->mutex);
+   icd_instance_free(winsys->instance, winsys);
+}
+
+const struct intel_winsys_info *
+intel_winsys_get_info(const struct intel_winsys *winsys)
+{
+   return &winsys->info;
+}
+
+int
+intel_winsys_read_reg(struct intel_winsys *winsys,
+                      uint32_t reg, uint64_t *val)
+{
+   struct timespec ts;
+
+   /* TIMESTAMP, which ticks every 80ns */
+   if (reg != 0x2358)
+      return -EINVAL;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   *val = ((uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec) / 80;
+
+   return 0;
+}
+
+int
+intel_winsys_get_reset_stats(struct intel_winsys *winsys,
+                             uint32_t *active_lost,
+                             uint32_t *pending_lost)
+{
+   *active_lost = 0;
+   *pending_lost = 0;
+
+   return 0;
+}
+
+struct intel_bo *
+intel_winsys_alloc_bo(struct intel_winsys *winsys,
+                      const char *name,
+                      unsigned long size,
+                      bool cpu_init)
+{
+   const unsigned long alignment = 4096; /* always page-aligned */
+   struct intel_bo *bo;
+
+   bo = calloc(1, sizeof(*bo));
+   if (!bo)
+      return NULL;
+
+   if (posix_memalign(&bo->ptr, alignment, size ? size : 1)) {
+      free(bo);
+      return NULL;
+   }
+
+   bo->winsys = winsys;
+   bo->refcount = 1;
+   bo->size = size;
+
+   /* addresses are never reused, and are only there to be decoded */
+   pthread_mutex_lock(&winsys->mutex);
+   bo->offset64 = winsys->next_offset;
+   winsys->next_offset += (size + alignment - 1) & ~(alignment - 1);
+   pthread_mutex_unlock(&winsys->mutex);
+
+   return bo;
+}
+
+struct intel_bo *
+intel_winsys_import_handle(struct intel_winsys *winsys,
+                           const char *name,
+                           const struct intel_winsys_handle *handle,
+                           unsigned long height,
+                           enum intel_tiling_mode *tiling,
+                           unsigned long *pitch)
+{
+   /* there is no one to share bos with */
+   return NULL;
+}
+
+int
+intel_winsys_export_handle(struct intel_winsys *winsys,
+                           struct intel_bo *bo,
+                           enum intel_tiling_mode tiling,
+                           unsigned long pitch,
+                           unsigned long height,
+                           struct intel_winsys_handle *handle)
+{
+   return -EINVAL;
+}
+
+bool
+intel_winsys_can_submit_bo(struct intel_winsys *winsys,
+                           struct intel_bo **bo_array,
+                           int count)
+{
+   return true;
+}
+
+int
+intel_winsys_submit_bo(struct intel_winsys *winsys,
+                       enum intel_ring_type ring,
+                       struct intel_bo *bo, int used,
+                       unsigned long flags)
+{
+   struct fake_submission *rec;
+   void *batch = NULL;
+
+   if (used < 0 || used > bo->size)
+      return -EINVAL;
+
+   /*
+    * The presumed offsets were written by the caller and bos never move, so
+    * the batch is recorded as it is.
+    */
+   if (winsys->record_max) {
+      batch = malloc(used ? used : 1);
+      if (!batch)
+         return -ENOMEM;
+      memcpy(batch, bo->ptr, used);
+   }
+
+   pthread_mutex_lock(&winsys->mutex);
+
+   winsys->submit_count++;
+
+   if (batch) {
+      if (winsys->record_count < winsys->record_max) {
+         rec = &winsys->records[winsys->record_count++];
+      } else {
+         rec = &winsys->records[winsys->record_head];
+         free(rec->batch);
+         winsys->record_head = (winsys->record_head + 1) % winsys->record_max;
+      }
+
+      rec->ring = ring;
+      rec->flags = flags;
+      rec->offset64 = bo->offset64;
+      rec->batch = batch;
+      rec->used = used;
+   }
+
+   pthread_mutex_unlock(&winsys->mutex);
+
+   return 0;
+}
+
+static void
+decode_batch(const struct intel_winsys *winsys, void *ptr,
+             uint64_t offset64, int used)
+{
+   struct drm_intel_decode *decode;
+
+   decode = drm_intel_decode_context_alloc(winsys->info.devid);
+   if (!decode)
+      return;
+
+   drm_intel_decode_set_output_file(decode, stderr);
+
+   /* in dwords */
+   used /= 4;
+
+   drm_intel_decode_set_batch_pointer(decode, ptr, offset64, used);
+
+   drm_intel_decode(decode);
+   free(decode);
+}
+
+void
+intel_winsys_decode_bo(struct intel_winsys *winsys,
+                       struct intel_bo *bo, int used)
+{
+   decode_batch(winsys, bo->ptr, bo->offset64, used);
+}
+
+int
+intel_winsys_get_submit_count(struct intel_winsys *winsys)
+{
+   int count;
+
+   pthread_mutex_lock(&winsys->mutex);
+   count = winsys->submit_count;
+   pthread_mutex_unlock(&winsys->mutex);
+
+   return count;
+}
+
+int
+intel_winsys_get_submission(struct intel_winsys *winsys, int index,
+                            enum intel_ring_type *ring,
+                            const void **batch, int *used)
+{
+   const struct fake_submission *rec;
+   int err = 0;
+
+   pthread_mutex_lock(&winsys->mutex);
+
+   if (index < 0 || index >= winsys->record_count) {
+      err = -EINVAL;
+   } else {
+      rec = &winsys->records[(winsys->record_head + index) %
+         winsys->record_max];
+
+      *ring = rec->ring;
+      *batch = rec->batch;
+      *used = rec->used;
+   }
+
+   pthread_mutex_unlock(&winsys->mutex);
+
+   return err;
+}
+
+void
+intel_winsys_decode_submission(struct intel_winsys *winsys, int index)
+{
+   const struct fake_submission *rec;
+
+   pthread_mutex_lock(&winsys->mutex);
+
+   if (index >= 0 && index < winsys->record_count) {
+      rec = &winsys->records[(winsys->record_head + index) %
+         winsys->record_max];
+
+      fprintf(stderr, "decoding submission %d: ring %d, %d bytes\n",
+            index, rec->ring, rec->used);
+      decode_batch(winsys, rec->batch, rec->offset64, rec->used);
+   }
+
+   pthread_mutex_unlock(&winsys->mutex);
+}
+
+struct intel_bo *
+intel_bo_ref(struct intel_bo *bo)
+{
+   if (bo)
+      __sync_fetch_and_add(&bo->refcount, 1);
+
+   return bo;
+}
+
+void
+intel_bo_unref(struct intel_bo *bo)
+{
+   int i;
+
+   if (!bo || __sync_sub_and_fetch(&bo->refcount, 1))
+      return;
+
+   for (i = 0; i < bo->reloc_count; i++)
+      intel_bo_unref(bo->relocs[i].target);
+
+   free(bo->relocs);
+   free(bo->ptr);
+   free(bo);
+}
+
+int
+intel_bo_set_tiling(struct intel_bo *bo,
+                    enum intel_tiling_mode tiling,
+                    unsigned long pitch)
+{
+   switch (tiling) {
+   case INTEL_TILING_X:
+      if (pitch % 512)
+         return -1;
+      break;
+   case INTEL_TILING_Y:
+      if (pitch % 128)
+         return -1;
+      break;
+   default:
+      break;
+   }
+
+   bo->tiling = tiling;
+   bo->pitch = pitch;
+
+   return 0;
+}
+
+/* bos are never busy and tiling is not applied, so all maps are the same */
+void *
+intel_bo_map(struct intel_bo *bo, bool write_enable)
+{
+   return bo->ptr;
+}
+
+void *
+intel_bo_map_async(struct intel_bo *bo)
+{
+   return bo->ptr;
+}
+
+void *
+intel_bo_map_gtt(struct intel_bo *bo)
+{
+   return bo->ptr;
+}
+
+void *
+intel_bo_map_gtt_async(struct intel_bo *bo)
+{
+   return bo->ptr;
+}
+
+void
+intel_bo_unmap(struct intel_bo *bo)
+{
+}
+
+int
+intel_bo_pwrite(struct intel_bo *bo, unsigned long offset,
+                unsigned long size, const void *data)
+{
+   if (offset > bo->size || size > bo->size - offset)
+      return -EINVAL;
+
+   memcpy((char *) bo->ptr + offset, data, size);
+
+   return 0;
+}
+
+int
+intel_bo_pread(struct intel_bo *bo, unsigned long offset,
+               unsigned long size, void *data)
+{
+   if (offset > bo->size || size > bo->size - offset)
+      return -EINVAL;
+
+   memcpy(data, (const char *) bo->ptr + offset, size);
+
+   return 0;
+}
+
+int
+intel_bo_add_reloc(struct intel_bo *bo, uint32_t offset,
+                   struct intel_bo *target_bo, uint32_t target_offset,
+                   uint32_t flags, uint64_t *presumed_offset)
+{
+   struct fake_reloc *reloc;
+
+   if (bo->reloc_count >= bo->reloc_max) {
+      const int max = (bo->reloc_max) ? bo->reloc_max * 2 : 64;
+      struct fake_reloc *relocs;
+
+      relocs = realloc(bo->relocs, sizeof(relocs[0]) * max);
+      if (!relocs)
+         return -ENOMEM;
+
+      bo->relocs = relocs;
+      bo->reloc_max = max;
+   }
+
+   reloc = &bo->relocs[bo->reloc_count++];
+   reloc->offset = offset;
+   reloc->target = intel_bo_ref(target_bo);
+   reloc->target_offset = target_offset;
+   reloc->flags = flags;
+
+   *presumed_offset = target_bo->offset64 + target_offset;
+
+   return 0;
+}
+
+int
+intel_bo_get_reloc_count(struct intel_bo *bo)
+{
+   return bo->reloc_count;
+}
+
+void
+intel_bo_truncate_relocs(struct intel_bo *bo, int start)
+{
+   int i;
+
+   for (i = start; i < bo->reloc_count; i++)
+      intel_bo_unref(bo->relocs[i].target);
+
+   if (start < bo->reloc_count)
+      bo->reloc_count = start;
+}
+
+bool
+intel_bo_has_reloc(struct intel_bo *bo, struct intel_bo *target_bo)
+{
+   int i;
+
+   for (i = 0; i < bo->reloc_count; i++) {
+      if (bo->relocs[i].target == target_bo)
+         return true;
+   }
+
+   for (i = 0; i < bo->reloc_count; i++) {
+      if (bo->relocs[i].target != bo &&
+          intel_bo_has_reloc(bo->relocs[i].target, target_bo))
+         return true;
+   }
+
+   return false;
+}
+
+int
+intel_bo_wait(struct intel_bo *bo, int64_t timeout)
+{
+   /* submissions complete as soon as they are recorded */
+   return 0;
+}
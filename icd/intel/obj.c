@@ -103,6 +103,10 @@ static bool base_dbg_copy_create_info(const struct intel_handle *handle,
     case VK_DEBUG_REPORT_OBJECT_TYPE_PIPELINE_EXT:
         assert(info.header->struct_type == VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO);
         break;
+    case VK_DEBUG_REPORT_OBJECT_TYPE_PIPELINE_CACHE_EXT:
+        assert(info.header->struct_type == VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO);
+        shallow_copy = sizeof(VkPipelineCacheCreateInfo);
+        break;
     case VK_DEBUG_REPORT_OBJECT_TYPE_FRAMEBUFFER_EXT:
         assert(info.header->struct_type ==  VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO);
         shallow_copy = sizeof(VkFramebufferCreateInfo);
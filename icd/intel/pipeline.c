@@ -23,6 +23,7 @@
  *
  */
 
+#include <unistd.h>
 #include "genhw/genhw.h"
 #include "compiler/pipeline/pipeline_compiler_interface.h"
 #include "cmd.h"
@@ -142,6 +143,11 @@ struct intel_pipeline_create_info {
     VkPipelineShaderStageCreateInfo        tes;
     VkPipelineShaderStageCreateInfo        gs;
     VkPipelineShaderStageCreateInfo        fs;
+
+    struct intel_pipeline_cache           *cache;
+
+    /* false when the pipeline itself is built on a worker thread */
+    bool                                   parallel_shaders;
 };
 
 /* in S1.3 */
@@ -254,25 +260,562 @@ void intel_pipeline_shader_destroy(struct intel_dev *dev,
     intel_free(dev, sh);
 }
 
-static VkResult pipeline_build_shader(struct intel_pipeline *pipeline,
+/*
+ * Pipeline cache data is the VkPipelineCacheHeaderVersionOne header, our own
+ * header, then for each entry a pipeline_cache_record followed by the entry
+ * data.  The entry data is what pipeline_cache_entry_create() lays out: a
+ * pipeline_cache_shader_info, the intel_pipeline_shader, its rmap and rmap
+ * slots when there is an rmap, and the ISA.
+ */
+#define INTEL_PIPELINE_CACHE_FORMAT_VERSION 1
+
+struct pipeline_cache_header {
+    uint32_t header_size;
+    uint32_t header_version;
+    uint32_t vendor_id;
+    uint32_t device_id;
+    uint8_t uuid[VK_UUID_SIZE];
+
+    uint32_t format_version;
+    uint32_t shader_size;
+    uint32_t entry_count;
+};
+
+struct pipeline_cache_record {
+    uint64_t key[2];
+    uint32_t data_size;
+};
+
+struct pipeline_cache_shader_info {
+    uint32_t has_rmap;
+    uint32_t slot_count;
+    uint32_t code_size;
+};
+
+struct intel_pipeline_cache_entry {
+    struct intel_pipeline_cache_entry *next;
+
+    uint64_t key[2];
+    uint32_t data_size;
+    /* data_size bytes of entry data follow */
+};
+
+static void pipeline_cache_hash(uint64_t key[2], const void *data, size_t size)
+{
+    const uint8_t *bytes = (const uint8_t *) data;
+    size_t i;
+
+    /* FNV-1a and a multiplicative hash, so that 128 bits have to collide */
+    for (i = 0; i < size; i++) {
+        key[0] = (key[0] ^ bytes[i]) * 0x100000001b3ull;
+        key[1] = (key[1] + bytes[i] + 1) * 0x9e3779b97f4a7c15ull;
+        key[1] ^= key[1] >> 29;
+    }
+}
+
+/*
+ * Hash everything intel_pipeline_shader_compile() depends on: the SPIR-V and
+ * how the stage is picked from it, the descriptor layout the resource map is
+ * built from, and the chip.
+ */
+static void pipeline_cache_key(const struct intel_pipeline *pipeline,
+                               const VkPipelineShaderStageCreateInfo *sh_info,
+                               uint64_t key[2])
+{
+    const struct intel_gpu *gpu = pipeline->dev->gpu;
+    const struct intel_shader_module *mod = intel_shader_module(sh_info->module);
+    const struct intel_pipeline_layout *layout = pipeline->pipeline_layout;
+    const int gen = intel_gpu_gen(gpu);
+    uint32_t i, j;
+
+    key[0] = 0xcbf29ce484222325ull;
+    key[1] = 0;
+
+    pipeline_cache_hash(key, &gpu->devid, sizeof(gpu->devid));
+    pipeline_cache_hash(key, &gen, sizeof(gen));
+    pipeline_cache_hash(key, &sh_info->stage, sizeof(sh_info->stage));
+    if (sh_info->pName)
+        pipeline_cache_hash(key, sh_info->pName, strlen(sh_info->pName) + 1);
+
+    if (sh_info->pSpecializationInfo) {
+        const VkSpecializationInfo *spec = sh_info->pSpecializationInfo;
+
+        pipeline_cache_hash(key, &spec->mapEntryCount, sizeof(spec->mapEntryCount));
+        pipeline_cache_hash(key, spec->pMapEntries,
+                sizeof(spec->pMapEntries[0]) * spec->mapEntryCount);
+        pipeline_cache_hash(key, &spec->dataSize, sizeof(spec->dataSize));
+        pipeline_cache_hash(key, spec->pData, spec->dataSize);
+    }
+
+    pipeline_cache_hash(key, &mod->code_size, sizeof(mod->code_size));
+    pipeline_cache_hash(key, mod->code, mod->code_size);
+
+    if (!layout)
+        return;
+
+    pipeline_cache_hash(key, &layout->layout_count, sizeof(layout->layout_count));
+    for (i = 0; i < layout->layout_count; i++) {
+        const struct intel_desc_layout *desc_layout = layout->layouts[i];
+
+        pipeline_cache_hash(key, &desc_layout->binding_count,
+                sizeof(desc_layout->binding_count));
+        for (j = 0; j < desc_layout->binding_count; j++) {
+            const struct intel_desc_layout_binding *binding = &desc_layout->bindings[j];
+
+            pipeline_cache_hash(key, &binding->binding, sizeof(binding->binding));
+            pipeline_cache_hash(key, &binding->type, sizeof(binding->type));
+            pipeline_cache_hash(key, &binding->array_size, sizeof(binding->array_size));
+            pipeline_cache_hash(key, &binding->offset, sizeof(binding->offset));
+            pipeline_cache_hash(key, &binding->increment, sizeof(binding->increment));
+        }
+    }
+}
+
+static struct intel_pipeline_cache_entry **pipeline_cache_bucket(struct intel_pipeline_cache *cache,
+                                                                 const uint64_t key[2])
+{
+    return &cache->buckets[key[0] % INTEL_PIPELINE_CACHE_BUCKET_COUNT];
+}
+
+/* caller must hold the cache mutex */
+static struct intel_pipeline_cache_entry *pipeline_cache_find(struct intel_pipeline_cache *cache,
+                                                              const uint64_t key[2])
+{
+    struct intel_pipeline_cache_entry *entry;
+
+    for (entry = *pipeline_cache_bucket(cache, key); entry; entry = entry->next) {
+        if (entry->key[0] == key[0] && entry->key[1] == key[1])
+            return entry;
+    }
+
+    return NULL;
+}
+
+static struct intel_pipeline_cache_entry *pipeline_cache_entry_alloc(struct intel_pipeline_cache *cache,
+                                                                     const uint64_t key[2],
+                                                                     uint32_t data_size)
+{
+    struct intel_pipeline_cache_entry *entry;
+
+    entry = intel_alloc(cache, sizeof(*entry) + data_size, sizeof(uint64_t),
+            VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+    if (!entry)
+        return NULL;
+
+    entry->next = NULL;
+    entry->key[0] = key[0];
+    entry->key[1] = key[1];
+    entry->data_size = data_size;
+
+    return entry;
+}
+
+/*
+ * Add an entry unless there already is one with the same key, in which case
+ * the new entry is freed.
+ */
+static void pipeline_cache_insert(struct intel_pipeline_cache *cache,
+                                  struct intel_pipeline_cache_entry *entry)
+{
+    struct intel_pipeline_cache_entry **bucket;
+
+    pthread_mutex_lock(&cache->mutex);
+
+    if (pipeline_cache_find(cache, entry->key)) {
+        pthread_mutex_unlock(&cache->mutex);
+        intel_free(cache, entry);
+        return;
+    }
+
+    bucket = pipeline_cache_bucket(cache, entry->key);
+    entry->next = *bucket;
+    *bucket = entry;
+
+    cache->entry_count++;
+    cache->data_size += sizeof(struct pipeline_cache_record) + entry->data_size;
+
+    pthread_mutex_unlock(&cache->mutex);
+}
+
+static struct intel_pipeline_cache_entry *pipeline_cache_entry_create(struct intel_pipeline_cache *cache,
+                                                                      const uint64_t key[2],
+                                                                      const struct intel_pipeline_shader *sh)
+{
+    struct intel_pipeline_cache_entry *entry;
+    struct pipeline_cache_shader_info info;
+    struct intel_pipeline_shader sh_copy;
+    uint32_t data_size;
+    uint8_t *data;
+
+    info.has_rmap = (sh->rmap != NULL);
+    info.slot_count = (sh->rmap) ? sh->rmap->slot_count : 0;
+    info.code_size = sh->codeSize;
+
+    data_size = sizeof(info) + sizeof(*sh) + info.code_size;
+    if (info.has_rmap) {
+        data_size += sizeof(*sh->rmap) +
+            sizeof(sh->rmap->slots[0]) * info.slot_count;
+    }
+
+    entry = pipeline_cache_entry_alloc(cache, key, data_size);
+    if (!entry)
+        return NULL;
+
+    /* pointers are restored by pipeline_cache_entry_load() */
+    sh_copy = *sh;
+    sh_copy.pCode = NULL;
+    sh_copy.rmap = NULL;
+
+    data = (uint8_t *) (entry + 1);
+    memcpy(data, &info, sizeof(info));
+    data += sizeof(info);
+    memcpy(data, &sh_copy, sizeof(sh_copy));
+    data += sizeof(sh_copy);
+    if (info.has_rmap) {
+        struct intel_pipeline_rmap rmap_copy = *sh->rmap;
+
+        rmap_copy.slots = NULL;
+        memcpy(data, &rmap_copy, sizeof(rmap_copy));
+        data += sizeof(rmap_copy);
+        memcpy(data, sh->rmap->slots, sizeof(sh->rmap->slots[0]) * info.slot_count);
+        data += sizeof(sh->rmap->slots[0]) * info.slot_count;
+    }
+    memcpy(data, sh->pCode, info.code_size);
+
+    return entry;
+}
+
+/*
+ * Check that loaded data is an entry pipeline_cache_entry_create() could have
+ * made.
+ */
+static bool pipeline_cache_entry_data_valid(const void *data, uint32_t data_size)
+{
+    struct pipeline_cache_shader_info info;
+    uint64_t expected_size;
+
+    if (data_size < sizeof(info))
+        return false;
+
+    memcpy(&info, data, sizeof(info));
+
+    expected_size = sizeof(info) + sizeof(struct intel_pipeline_shader) +
+        (uint64_t) info.code_size;
+    if (info.has_rmap) {
+        expected_size += sizeof(struct intel_pipeline_rmap) +
+            sizeof(struct intel_pipeline_rmap_slot) * (uint64_t) info.slot_count;
+    }
+
+    return (expected_size == data_size);
+}
+
+/* fill in a shader the way intel_pipeline_shader_compile() would have */
+static VkResult pipeline_cache_entry_load(const struct intel_pipeline_cache_entry *entry,
+                                          const struct intel_gpu *gpu,
+                                          struct intel_pipeline_shader *sh)
+{
+    const uint8_t *data = (const uint8_t *) (entry + 1);
+    struct pipeline_cache_shader_info info;
+
+    memcpy(&info, data, sizeof(info));
+    data += sizeof(info);
+    memcpy(sh, data, sizeof(*sh));
+    data += sizeof(*sh);
+
+    sh->pCode = NULL;
+    sh->rmap = NULL;
+
+    if (info.has_rmap) {
+        const size_t slots_size = sizeof(sh->rmap->slots[0]) * info.slot_count;
+
+        sh->rmap = intel_alloc(gpu, sizeof(*sh->rmap), sizeof(int),
+                VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+        if (!sh->rmap) {
+            intel_pipeline_shader_cleanup(sh, gpu);
+            return VK_ERROR_OUT_OF_HOST_MEMORY;
+        }
+        memcpy(sh->rmap, data, sizeof(*sh->rmap));
+        data += sizeof(*sh->rmap);
+
+        sh->rmap->slots = intel_alloc(gpu, slots_size, sizeof(int),
+                VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+        if (!sh->rmap->slots) {
+            intel_free(gpu, sh->rmap);
+            sh->rmap = NULL;
+            intel_pipeline_shader_cleanup(sh, gpu);
+            return VK_ERROR_OUT_OF_HOST_MEMORY;
+        }
+        memcpy(sh->rmap->slots, data, slots_size);
+        data += slots_size;
+    }
+
+    sh->pCode = intel_alloc(gpu, info.code_size, sizeof(int),
+            VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+    if (!sh->pCode) {
+        intel_pipeline_shader_cleanup(sh, gpu);
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    memcpy(sh->pCode, data, info.code_size);
+
+    return VK_SUCCESS;
+}
+
+/* return true and fill in the shader when the cache has it */
+static bool pipeline_cache_lookup(struct intel_pipeline_cache *cache,
+                                  const uint64_t key[2],
+                                  const struct intel_gpu *gpu,
+                                  struct intel_pipeline_shader *sh)
+{
+    const struct intel_pipeline_cache_entry *entry;
+    VkResult ret = VK_ERROR_INITIALIZATION_FAILED;
+
+    /* entries are only freed with the cache */
+    pthread_mutex_lock(&cache->mutex);
+    entry = pipeline_cache_find(cache, key);
+    pthread_mutex_unlock(&cache->mutex);
+
+    if (entry)
+        ret = pipeline_cache_entry_load(entry, gpu, sh);
+
+    return (ret == VK_SUCCESS);
+}
+
+static void pipeline_cache_get_header(const struct intel_pipeline_cache *cache,
+                                      struct pipeline_cache_header *header)
+{
+    memset(header, 0, sizeof(*header));
+    header->header_size = offsetof(struct pipeline_cache_header, format_version);
+    header->header_version = VK_PIPELINE_CACHE_HEADER_VERSION_ONE;
+    header->vendor_id = 0x8086;
+    header->device_id = cache->dev->gpu->devid;
+    intel_gpu_get_pipeline_cache_uuid(cache->dev->gpu, header->uuid);
+    header->format_version = INTEL_PIPELINE_CACHE_FORMAT_VERSION;
+    header->shader_size = sizeof(struct intel_pipeline_shader);
+}
+
+/*
+ * Add the entries of data written by vkGetPipelineCacheData().  Data from
+ * another chip or driver, or that is damaged, is ignored from the first bad
+ * entry on, as the spec asks.
+ */
+static VkResult pipeline_cache_load(struct intel_pipeline_cache *cache,
+                                    const void *data, size_t size)
+{
+    const uint8_t *cur = (const uint8_t *) data;
+    const uint8_t *end = cur + size;
+    struct pipeline_cache_header expected, header;
+    uint32_t i;
+
+    if (size < sizeof(header))
+        return VK_SUCCESS;
+
+    pipeline_cache_get_header(cache, &expected);
+    memcpy(&header, cur, sizeof(header));
+    cur += sizeof(header);
+
+    if (header.header_size != expected.header_size ||
+        header.header_version != expected.header_version ||
+        header.vendor_id != expected.vendor_id ||
+        header.device_id != expected.device_id ||
+        memcmp(header.uuid, expected.uuid, VK_UUID_SIZE) ||
+        header.format_version != expected.format_version ||
+        header.shader_size != expected.shader_size)
+        return VK_SUCCESS;
+
+    for (i = 0; i < header.entry_count; i++) {
+        struct intel_pipeline_cache_entry *entry;
+        struct pipeline_cache_record record;
+
+        if ((size_t) (end - cur) < sizeof(record))
+            break;
+        memcpy(&record, cur, sizeof(record));
+        cur += sizeof(record);
+
+        if ((size_t) (end - cur) < record.data_size ||
+            !pipeline_cache_entry_data_valid(cur, record.data_size))
+            break;
+
+        entry = pipeline_cache_entry_alloc(cache, record.key, record.data_size);
+        if (!entry)
+            return VK_ERROR_OUT_OF_HOST_MEMORY;
+        memcpy(entry + 1, cur, record.data_size);
+        cur += record.data_size;
+
+        pipeline_cache_insert(cache, entry);
+    }
+
+    return VK_SUCCESS;
+}
+
+static void pipeline_cache_destroy(struct intel_obj *obj)
+{
+    struct intel_pipeline_cache *cache = intel_pipeline_cache_from_obj(obj);
+    uint32_t i;
+
+    for (i = 0; i < INTEL_PIPELINE_CACHE_BUCKET_COUNT; i++) {
+        struct intel_pipeline_cache_entry *entry = cache->buckets[i];
+
+        while (entry) {
+            struct intel_pipeline_cache_entry *next = entry->next;
+
+            intel_free(cache, entry);
+            entry = next;
+        }
+    }
+
+    pthread_mutex_destroy(&cache->mutex);
+
+    intel_base_destroy(&cache->obj.base);
+}
+
+static VkResult pipeline_cache_create(struct intel_dev *dev,
+                                      const VkPipelineCacheCreateInfo *info,
+                                      struct intel_pipeline_cache **cache_ret)
+{
+    struct intel_pipeline_cache *cache;
+    VkResult ret;
+
+    cache = (struct intel_pipeline_cache *) intel_base_create(&dev->base.handle,
+            sizeof(*cache), dev->base.dbg, VK_DEBUG_REPORT_OBJECT_TYPE_PIPELINE_CACHE_EXT, info, 0);
+    if (!cache)
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+
+    cache->dev = dev;
+    pthread_mutex_init(&cache->mutex, NULL);
+    memset(cache->buckets, 0, sizeof(cache->buckets));
+    cache->entry_count = 0;
+    cache->data_size = 0;
+
+    cache->obj.destroy = pipeline_cache_destroy;
+
+    if (info->initialDataSize) {
+        ret = pipeline_cache_load(cache, info->pInitialData, info->initialDataSize);
+        if (ret != VK_SUCCESS) {
+            pipeline_cache_destroy(&cache->obj);
+            return ret;
+        }
+    }
+
+    *cache_ret = cache;
+    return VK_SUCCESS;
+}
+
+/*
+ * Shader compiles dominate pipeline creation and do not depend on each
+ * other, so they are spread over a few short-lived threads.  The calling
+ * thread takes part as well, and does all the work itself when no thread
+ * can be started.
+ */
+#define INTEL_PIPELINE_MAX_THREADS 8
+
+struct pipeline_jobs {
+    void (*run)(void *data, uint32_t index);
+    void *data;
+    uint32_t count;
+    uint32_t next;
+};
+
+static void *pipeline_jobs_worker(void *arg)
+{
+    struct pipeline_jobs *jobs = (struct pipeline_jobs *) arg;
+    uint32_t index;
+
+    while ((index = __sync_fetch_and_add(&jobs->next, 1)) < jobs->count)
+        jobs->run(jobs->data, index);
+
+    return NULL;
+}
+
+static uint32_t pipeline_jobs_thread_count(uint32_t count)
+{
+    long cpus;
+
+    if (count <= 1 || (intel_debug & INTEL_DEBUG_NOTHREADS))
+        return 1;
+
+    cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1)
+        cpus = 1;
+    if (cpus > INTEL_PIPELINE_MAX_THREADS)
+        cpus = INTEL_PIPELINE_MAX_THREADS;
+
+    return (count < (uint32_t) cpus) ? count : (uint32_t) cpus;
+}
+
+/* calls run(data, i) for i in [0, count) and returns when all have returned */
+static void pipeline_run_jobs(void (*run)(void *data, uint32_t index),
+                              void *data, uint32_t count)
+{
+    pthread_t threads[INTEL_PIPELINE_MAX_THREADS - 1];
+    const uint32_t thread_count = pipeline_jobs_thread_count(count);
+    struct pipeline_jobs jobs;
+    uint32_t started = 0, i;
+
+    jobs.run = run;
+    jobs.data = data;
+    jobs.count = count;
+    jobs.next = 0;
+
+    while (started + 1 < thread_count &&
+           pthread_create(&threads[started], NULL,
+                          pipeline_jobs_worker, &jobs) == 0)
+        started++;
+
+    pipeline_jobs_worker(&jobs);
+
+    for (i = 0; i < started; i++)
+        pthread_join(threads[i], NULL);
+}
+
+static VkResult pipeline_compile_shader(struct intel_pipeline *pipeline,
+                                        struct intel_pipeline_cache *cache,
                                         const VkPipelineShaderStageCreateInfo *sh_info,
                                         struct intel_pipeline_shader *sh)
 {
     struct intel_shader_module *mod =
         intel_shader_module(sh_info->module);
-    const struct intel_ir *ir =
-        intel_shader_module_get_ir(mod, sh_info->stage);
+    uint64_t key[2];
     VkResult ret;
 
-    if (!ir)
-        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    if (cache)
+        pipeline_cache_key(pipeline, sh_info, key);
 
-    ret = intel_pipeline_shader_compile(sh,
-            pipeline->dev->gpu, pipeline->pipeline_layout, sh_info, ir);
+    /* a cache hit skips both the SPIR-V translation and the backend compile */
+    if (!cache || !pipeline_cache_lookup(cache, key, pipeline->dev->gpu, sh)) {
+        const struct intel_ir *ir;
 
-    if (ret != VK_SUCCESS)
-        return ret;
+        pthread_mutex_lock(&mod->mutex);
+
+        ir = intel_shader_module_get_ir(mod, sh_info->stage);
+        if (ir) {
+            ret = intel_pipeline_shader_compile(sh, pipeline->dev->gpu,
+                    pipeline->pipeline_layout, sh_info, ir);
+        } else {
+            ret = VK_ERROR_OUT_OF_HOST_MEMORY;
+        }
 
+        pthread_mutex_unlock(&mod->mutex);
+
+        if (ret != VK_SUCCESS)
+            return ret;
+
+        if (cache) {
+            struct intel_pipeline_cache_entry *entry =
+                pipeline_cache_entry_create(cache, key, sh);
+
+            /* not being able to cache the shader is not an error */
+            if (entry)
+                pipeline_cache_insert(cache, entry);
+        }
+    }
+
+    return VK_SUCCESS;
+}
+
+static void pipeline_add_shader(struct intel_pipeline *pipeline,
+                                const VkPipelineShaderStageCreateInfo *sh_info,
+                                struct intel_pipeline_shader *sh)
+{
     sh->max_threads =
         intel_gpu_get_max_threads(pipeline->dev->gpu, sh_info->stage);
 
@@ -282,33 +825,79 @@ static VkResult pipeline_build_shader(struct intel_pipeline *pipeline,
         sh->per_thread_scratch_size * sh->max_threads;
 
     pipeline->active_shaders |= sh_info->stage;
+}
 
-    return VK_SUCCESS;
+struct pipeline_shader_job {
+    const VkPipelineShaderStageCreateInfo *sh_info;
+    struct intel_pipeline_shader *sh;
+    VkResult ret;
+};
+
+struct pipeline_shader_jobs {
+    struct intel_pipeline *pipeline;
+    struct intel_pipeline_cache *cache;
+    struct pipeline_shader_job jobs[6];
+};
+
+static void pipeline_shader_job_run(void *data, uint32_t index)
+{
+    struct pipeline_shader_jobs *jobs = (struct pipeline_shader_jobs *) data;
+    struct pipeline_shader_job *job = &jobs->jobs[index];
+
+    job->ret = pipeline_compile_shader(jobs->pipeline, jobs->cache,
+            job->sh_info, job->sh);
 }
 
 static VkResult pipeline_build_shaders(struct intel_pipeline *pipeline,
                                          const struct intel_pipeline_create_info *info)
 {
+    const VkPipelineShaderStageCreateInfo *stages[6] = {
+        &info->vs, &info->tcs, &info->tes, &info->gs, &info->fs,
+        &info->compute.stage,
+    };
+    struct intel_pipeline_shader *shaders[6] = {
+        &pipeline->vs, &pipeline->tcs, &pipeline->tes, &pipeline->gs,
+        &pipeline->fs, &pipeline->cs,
+    };
+    struct pipeline_shader_jobs jobs;
+    uint32_t count = 0, i;
     VkResult ret = VK_SUCCESS;
 
-    if (ret == VK_SUCCESS && info->vs.module)
-        ret = pipeline_build_shader(pipeline, &info->vs, &pipeline->vs);
-    if (ret == VK_SUCCESS && info->tcs.module)
-        ret = pipeline_build_shader(pipeline, &info->tcs,&pipeline->tcs);
-    if (ret == VK_SUCCESS && info->tes.module)
-        ret = pipeline_build_shader(pipeline, &info->tes,&pipeline->tes);
-    if (ret == VK_SUCCESS && info->gs.module)
-        ret = pipeline_build_shader(pipeline, &info->gs, &pipeline->gs);
-    if (ret == VK_SUCCESS && info->fs.module)
-        ret = pipeline_build_shader(pipeline, &info->fs, &pipeline->fs);
+    jobs.pipeline = pipeline;
+    jobs.cache = info->cache;
+
+    for (i = 0; i < ARRAY_SIZE(stages); i++) {
+        if (!stages[i]->module)
+            continue;
 
-    if (ret == VK_SUCCESS && info->compute.stage.module) {
-        ret = pipeline_build_shader(pipeline,
-                &info->compute.stage, &pipeline->cs);
+        jobs.jobs[count].sh_info = stages[i];
+        jobs.jobs[count].sh = shaders[i];
+        jobs.jobs[count].ret = VK_SUCCESS;
+        count++;
+    }
+
+    if (info->parallel_shaders) {
+        pipeline_run_jobs(pipeline_shader_job_run, &jobs, count);
+    } else {
+        for (i = 0; i < count; i++)
+            pipeline_shader_job_run(&jobs, i);
+    }
+
+    /*
+     * Scratch space is laid out in stage order once everything is compiled.
+     * Shaders that compiled are added even when another stage failed, so
+     * that pipeline_destroy() frees them.
+     */
+    for (i = 0; i < count; i++) {
+        if (jobs.jobs[i].ret == VK_SUCCESS)
+            pipeline_add_shader(pipeline, jobs.jobs[i].sh_info, jobs.jobs[i].sh);
+        else if (ret == VK_SUCCESS)
+            ret = jobs.jobs[i].ret;
     }
 
     return ret;
 }
+
 static uint32_t *pipeline_cmd_ptr(struct intel_pipeline *pipeline, int cmd_len)
 {
     uint32_t *ptr;
@@ -1326,6 +1915,8 @@ static VkResult pipeline_create_info_init(struct intel_pipeline_create_info  *in
 }
 
 static VkResult graphics_pipeline_create(struct intel_dev *dev,
+                                         struct intel_pipeline_cache *cache,
+                                         bool parallel_shaders,
                                          const VkGraphicsPipelineCreateInfo *info_,
                                          struct intel_pipeline **pipeline_ret)
 {
@@ -1338,6 +1929,9 @@ static VkResult graphics_pipeline_create(struct intel_dev *dev,
     if (ret != VK_SUCCESS)
         return ret;
 
+    info.cache = cache;
+    info.parallel_shaders = parallel_shaders;
+
     pipeline = (struct intel_pipeline *) intel_base_create(&dev->base.handle,
                         sizeof (*pipeline), dev->base.dbg,
                         VK_DEBUG_REPORT_OBJECT_TYPE_PIPELINE_EXT, info_, 0);
@@ -1372,10 +1966,10 @@ VKAPI_ATTR VkResult VKAPI_CALL vkCreatePipelineCache(
     const VkAllocationCallbacks*                     pAllocator,
     VkPipelineCache*                            pPipelineCache)
 {
+    struct intel_dev *dev = intel_dev(device);
 
-    // non-dispatchable objects only need to be 64 bits currently
-    *((uint64_t *)pPipelineCache) = 1;
-    return VK_SUCCESS;
+    return pipeline_cache_create(dev, pCreateInfo,
+            (struct intel_pipeline_cache **) pPipelineCache);
 }
 
 VKAPI_ATTR void VKAPI_CALL vkDestroyPipelineCache(
@@ -1383,6 +1977,10 @@ VKAPI_ATTR void VKAPI_CALL vkDestroyPipelineCache(
     VkPipelineCache                             pipelineCache,
     const VkAllocationCallbacks*                     pAllocator)
 {
+    struct intel_obj *obj = intel_obj(pipelineCache);
+
+    if (obj)
+        obj->destroy(obj);
 }
 
 VKAPI_ATTR VkResult VKAPI_CALL vkGetPipelineCacheData(
@@ -1391,7 +1989,58 @@ VKAPI_ATTR VkResult VKAPI_CALL vkGetPipelineCacheData(
     size_t*                                     pDataSize,
     void*                                       pData)
 {
-    return VK_ERROR_VALIDATION_FAILED_EXT;
+    struct intel_pipeline_cache *cache = intel_pipeline_cache(pipelineCache);
+    struct pipeline_cache_header header;
+    VkResult ret = VK_SUCCESS;
+    uint8_t *dst = (uint8_t *) pData;
+    size_t written;
+    uint32_t i;
+
+    pthread_mutex_lock(&cache->mutex);
+
+    if (!pData) {
+        *pDataSize = sizeof(header) + cache->data_size;
+        pthread_mutex_unlock(&cache->mutex);
+        return VK_SUCCESS;
+    }
+
+    if (*pDataSize < sizeof(header)) {
+        *pDataSize = 0;
+        pthread_mutex_unlock(&cache->mutex);
+        return VK_INCOMPLETE;
+    }
+
+    /* write whole entries only, so that what is written can be loaded */
+    pipeline_cache_get_header(cache, &header);
+    written = sizeof(header);
+    for (i = 0; i < INTEL_PIPELINE_CACHE_BUCKET_COUNT && ret == VK_SUCCESS; i++) {
+        const struct intel_pipeline_cache_entry *entry;
+
+        for (entry = cache->buckets[i]; entry; entry = entry->next) {
+            struct pipeline_cache_record record;
+
+            if (*pDataSize - written < sizeof(record) + entry->data_size) {
+                ret = VK_INCOMPLETE;
+                break;
+            }
+
+            record.key[0] = entry->key[0];
+            record.key[1] = entry->key[1];
+            record.data_size = entry->data_size;
+            memcpy(dst + written, &record, sizeof(record));
+            written += sizeof(record);
+            memcpy(dst + written, entry + 1, entry->data_size);
+            written += entry->data_size;
+
+            header.entry_count++;
+        }
+    }
+    memcpy(dst, &header, sizeof(header));
+    *pDataSize = written;
+
+    pthread_mutex_unlock(&cache->mutex);
+
+    return ret;
 }
 
 VKAPI_ATTR VkResult VKAPI_CALL vkMergePipelineCaches(
@@ -1400,7 +2049,51 @@ VKAPI_ATTR VkResult VKAPI_CALL vkMergePipelineCaches(
     uint32_t                                    srcCacheCount,
     const VkPipelineCache*                      pSrcCaches)
 {
-    return VK_ERROR_VALIDATION_FAILED_EXT;
+    struct intel_pipeline_cache *dst = intel_pipeline_cache(dstCache);
+    uint32_t i, j;
+
+    for (i = 0; i < srcCacheCount; i++) {
+        struct intel_pipeline_cache *src = intel_pipeline_cache(pSrcCaches[i]);
+
+        pthread_mutex_lock(&src->mutex);
+        for (j = 0; j < INTEL_PIPELINE_CACHE_BUCKET_COUNT; j++) {
+            const struct intel_pipeline_cache_entry *entry;
+
+            for (entry = src->buckets[j]; entry; entry = entry->next) {
+                struct intel_pipeline_cache_entry *copy;
+
+                copy = pipeline_cache_entry_alloc(dst, entry->key, entry->data_size);
+                if (!copy) {
+                    pthread_mutex_unlock(&src->mutex);
+                    return VK_ERROR_OUT_OF_HOST_MEMORY;
+                }
+                memcpy(copy + 1, entry + 1, entry->data_size);
+
+                pipeline_cache_insert(dst, copy);
+            }
+        }
+        pthread_mutex_unlock(&src->mutex);
+    }
+
+    return VK_SUCCESS;
+}
+
+struct graphics_pipeline_jobs {
+    struct intel_dev *dev;
+    struct intel_pipeline_cache *cache;
+    const VkGraphicsPipelineCreateInfo *infos;
+    VkPipeline *pipelines;
+    VkResult *results;
+};
+
+static void graphics_pipeline_job_run(void *data, uint32_t index)
+{
+    struct graphics_pipeline_jobs *jobs = (struct graphics_pipeline_jobs *) data;
+
+    /* the pipelines already keep the workers busy */
+    jobs->results[index] = graphics_pipeline_create(jobs->dev, jobs->cache,
+            false, &jobs->infos[index],
+            (struct intel_pipeline **) &jobs->pipelines[index]);
 }
 
 VKAPI_ATTR VkResult VKAPI_CALL vkCreateGraphicsPipelines(
@@ -1412,19 +2105,46 @@ VKAPI_ATTR VkResult VKAPI_CALL vkCreateGraphicsPipelines(
     VkPipeline*                               pPipelines)
 {
     struct intel_dev *dev = intel_dev(device);
+    struct intel_pipeline_cache *cache = intel_pipeline_cache(pipelineCache);
+    struct graphics_pipeline_jobs jobs;
     uint32_t i;
     VkResult res = VK_SUCCESS;
     bool one_succeeded = false;
 
+    /* a single pipeline compiles its stages in parallel instead */
+    if (createInfoCount <= 1) {
+        if (createInfoCount == 0)
+            return VK_SUCCESS;
+
+        res = graphics_pipeline_create(dev, cache, true, pCreateInfos,
+                (struct intel_pipeline **) pPipelines);
+        if (res != VK_SUCCESS)
+            pPipelines[0] = VK_NULL_HANDLE;
+        return res;
+    }
+
+    jobs.dev = dev;
+    jobs.cache = cache;
+    jobs.infos = pCreateInfos;
+    jobs.pipelines = pPipelines;
+    jobs.results = intel_alloc(dev, sizeof(jobs.results[0]) * createInfoCount,
+            sizeof(int), VK_SYSTEM_ALLOCATION_SCOPE_COMMAND);
+    if (!jobs.results)
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+
+    pipeline_run_jobs(graphics_pipeline_job_run, &jobs, createInfoCount);
+
     for (i = 0; i < createInfoCount; i++) {
-        res =  graphics_pipeline_create(dev, &(pCreateInfos[i]),
-            (struct intel_pipeline **) &(pPipelines[i]));
+        res = jobs.results[i];
         //return NULL handle for unsuccessful creates
         if (res != VK_SUCCESS)
             pPipelines[i] = VK_NULL_HANDLE;
         else
             one_succeeded = true;
     }
+
+    intel_free(dev, jobs.results);
+
     //return VK_SUCCESS if any of count creates succeeded
     if (one_succeeded)
         return VK_SUCCESS;
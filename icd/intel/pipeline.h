@@ -24,6 +24,7 @@
 #ifndef PIPELINE_H
 #define PIPELINE_H
 
+#include <pthread.h>
 #include "intel.h"
 #include "obj.h"
 #include "desc.h"
@@ -254,6 +255,37 @@ struct intel_pipeline {
     uint32_t cmd_3dstate_sbe[14];
 };
 
+#define INTEL_PIPELINE_CACHE_BUCKET_COUNT 64
+
+struct intel_pipeline_cache_entry;
+
+/**
+ * Compiled shaders, keyed by a hash of everything the compiler looks at.
+ */
+struct intel_pipeline_cache {
+    struct intel_obj obj;
+
+    struct intel_dev *dev;
+
+    /* pipelines may be created from several threads with the same cache */
+    pthread_mutex_t mutex;
+
+    struct intel_pipeline_cache_entry *buckets[INTEL_PIPELINE_CACHE_BUCKET_COUNT];
+    uint32_t entry_count;
+    /* size of the entries in vkGetPipelineCacheData() */
+    size_t data_size;
+};
+
+static inline struct intel_pipeline_cache *intel_pipeline_cache(VkPipelineCache cache)
+{
+    return *(struct intel_pipeline_cache **) &cache;
+}
+
+static inline struct intel_pipeline_cache *intel_pipeline_cache_from_obj(struct intel_obj *obj)
+{
+    return (struct intel_pipeline_cache *) obj;
+}
+
 static inline struct intel_pipeline *intel_pipeline(VkPipeline pipeline)
 {
     return *(struct intel_pipeline **) &pipeline;
@@ -45,6 +45,8 @@ static void shader_module_destroy(struct intel_obj *obj)
     free(sm->code);
     sm->code = 0;
 
+    pthread_mutex_destroy(&sm->mutex);
+
     intel_base_destroy(&sm->obj.base);
 }
 
@@ -94,6 +96,8 @@ static VkResult shader_module_create(struct intel_dev *dev,
     if (!sm)
         return VK_ERROR_OUT_OF_HOST_MEMORY;
 
+    pthread_mutex_init(&sm->mutex, NULL);
+
     sm->gpu = dev->gpu;
     sm->code_size = info->codeSize;
     sm->code = malloc(info->codeSize);
@@ -23,6 +23,7 @@
 #ifndef SHADER_H
 #define SHADER_H
 
+#include <pthread.h>
 #include "intel.h"
 #include "obj.h"
 
@@ -36,6 +37,12 @@ struct intel_shader_module {
     uint32_t code_size;
     void *code;
 
+    /*
+     * The backend lowers the IR in place, so pipelines built on different
+     * threads hold this while getting and compiling the module's IR.
+     */
+    pthread_mutex_t mutex;
+
     /* simple cache */
     struct intel_ir *vs;
     struct intel_ir *tcs;
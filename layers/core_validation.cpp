@@ -43,6 +43,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <string>
+#include <thread>
 #include <tuple>
 
 #include "vk_loader_platform.h"
@@ -141,10 +142,12 @@ struct layer_data {
     unordered_map<VkSemaphore, SEMAPHORE_NODE> semaphoreMap;
     unordered_map<VkCommandBuffer, GLOBAL_CB_NODE *> commandBufferMap;
     unordered_map<VkFramebuffer, unique_ptr<FRAMEBUFFER_NODE>> frameBufferMap;
-    unordered_map<VkImage, vector<ImageSubresourcePair>> imageSubresourceMap;
-    unordered_map<ImageSubresourcePair, IMAGE_LAYOUT_NODE> imageLayoutMap;
+    unordered_map<VkImage, IMAGE_LAYOUT_RANGE_MAP<VkImageLayout>> imageLayoutMap;
     unordered_map<VkRenderPass, RENDER_PASS_NODE *> renderPassMap;
     unordered_map<VkShaderModule, unique_ptr<shader_module>> shaderModuleMap;
+    // Bumped when a buffer, buffer view, memory object or pipeline is destroyed, as that can turn descriptor state that
+    //  passed draw-time validation into state that fails it
+    uint64_t resource_generation;
     VkDevice device;
 
     // Device specific data
@@ -155,8 +158,8 @@ struct layer_data {
 
     layer_data()
         : instance_state(nullptr), report_data(nullptr), device_dispatch_table(nullptr), instance_dispatch_table(nullptr),
-          device_extensions(), device(VK_NULL_HANDLE), phys_dev_properties{}, phys_dev_mem_props{}, physical_device_features{},
-          physical_device_state(nullptr){};
+          device_extensions(), resource_generation(0), device(VK_NULL_HANDLE), phys_dev_properties{}, phys_dev_mem_props{},
+          physical_device_features{}, physical_device_state(nullptr){};
 };
 
 // TODO : Do we need to guard access to layer_data_map w/ lock?
@@ -259,8 +262,59 @@ struct shader_module {
     }
 };
 
-// TODO : This can be much smarter, using separate locks for separate global data
-static std::mutex global_lock;
+// Reader/writer lock over all device-level state, split into shards so that readers on different threads
+//  don't contend on a single mutex. Readers take only the shard for their thread, writers take every shard.
+// on_lock, if given, runs each time the mutex has been locked exclusively.
+class sharded_mutex {
+  public:
+    explicit sharded_mutex(void (*on_lock)() = nullptr) : on_lock_(on_lock) {}
+    void lock() {
+        for (uint32_t i = 0; i < SHARD_COUNT; ++i)
+            shards_[i].mutex.lock();
+        if (on_lock_)
+            on_lock_();
+    }
+    void unlock() {
+        for (uint32_t i = SHARD_COUNT; i > 0; --i)
+            shards_[i - 1].mutex.unlock();
+    }
+    void lock_shared() { shards_[shard_index()].mutex.lock(); }
+    void unlock_shared() { shards_[shard_index()].mutex.unlock(); }
+
+  private:
+    static const uint32_t SHARD_COUNT = 16;
+    // Pad each shard out to its own cache line so readers on different shards don't false-share
+    struct shard {
+        std::mutex mutex;
+        char padding[64];
+    };
+    // Thread ids are often aligned addresses, so scramble them before picking a shard
+    static uint32_t shard_index() {
+        uint64_t id_hash = std::hash<std::thread::id>()(std::this_thread::get_id());
+        return static_cast<uint32_t>((id_hash * 0x9E3779B97F4A7C15ull) >> 32) % SHARD_COUNT;
+    }
+
+    shard shards_[SHARD_COUNT];
+    void (*on_lock_)();
+};
+
+// With lunarg_core_validation.deferred_validation = TRUE, the draw-time commands (pipeline, descriptor set, vertex and
+//  index buffer binds, dynamic state, draws and dispatches) only append a DEFERRED_CMD to their command buffer's log and
+//  call down the chain. Logs are validated in recording order before device state is next locked exclusively, and a
+//  command buffer's log is validated before any other command is recorded into it, so each deferred command still sees
+//  the state it would have seen inline. Errors in deferred commands are reported but can't skip the call down.
+static bool deferred_validation = false;
+// Guards deferred_cbs, the command buffers whose logs hold commands that haven't been validated yet
+static std::mutex deferred_lock;
+static std::vector<std::pair<layer_data *, GLOBAL_CB_NODE *>> deferred_cbs;
+static void validateDeferredCmds(layer_data *dev_data, GLOBAL_CB_NODE *pCB);
+static void validateAllDeferredCmds();
+
+// Entrypoints that create, destroy, update or submit objects hold global_lock exclusively. Command recording
+//  entrypoints that only read device-level state hold it shared (see cb_record_lock below), and serialize their
+//  few updates to state shared between command buffers (cb_bindings and friends) through binding_lock.
+static sharded_mutex global_lock(validateAllDeferredCmds);
+static std::mutex binding_lock;
 
 // Return ImageViewCreateInfo ptr for specified imageView or else NULL
 VkImageViewCreateInfo *getImageViewData(const layer_data *dev_data, VkImageView image_view) {
@@ -390,6 +444,40 @@ static VkDeviceMemory *get_object_mem_binding(layer_data *my_data, uint64_t hand
 // prototype
 static GLOBAL_CB_NODE *getCBNode(layer_data const *, const VkCommandBuffer);
 
+// Lock held while recording into a single command buffer: global_lock is held shared, plus the lock of the
+//  GLOBAL_CB_NODE being recorded, so threads recording into different command buffers proceed in parallel.
+//  Unless the command being recorded can itself be deferred, any deferred commands already in the command buffer are
+//  validated first so that validation stays in recording order.
+class cb_record_lock {
+  public:
+    cb_record_lock(layer_data *dev_data, VkCommandBuffer cb, bool deferrable = false) : cb_node_(nullptr), owns_lock_(true) {
+        global_lock.lock_shared();
+        cb_node_ = getCBNode(dev_data, cb);
+        if (cb_node_) {
+            cb_node_->record_lock.lock();
+            if (!deferrable && !cb_node_->deferred_log.cmds.empty())
+                validateDeferredCmds(dev_data, cb_node_);
+        }
+    }
+    ~cb_record_lock() {
+        if (owns_lock_)
+            unlock();
+    }
+    void unlock() {
+        if (cb_node_)
+            cb_node_->record_lock.unlock();
+        global_lock.unlock_shared();
+        owns_lock_ = false;
+    }
+
+  private:
+    cb_record_lock(const cb_record_lock &);
+    cb_record_lock &operator=(const cb_record_lock &);
+
+    GLOBAL_CB_NODE *cb_node_;
+    bool owns_lock_;
+};
+
 // Helper function to validate correct usage bits set for buffers or images
 //  Verify that (actual & desired) flags != 0 or,
 //   if strict is true, verify that (actual & desired) flags == desired
@@ -485,6 +573,63 @@ static void set_memory_valid(layer_data *dev_data, VkDeviceMemory mem, bool vali
     }
 }
 
+// Record a check, when cb_node is submitted, that mem (or image, if it's a swapchain image) has valid contents
+static void addValidateMemoryOp(GLOBAL_CB_NODE *cb_node, VkDeviceMemory mem, const char *func_name,
+                                VkImage image = VK_NULL_HANDLE) {
+    CB_SUBMIT_OP op = {};
+    op.type = CB_SUBMIT_OP_VALIDATE_MEMORY;
+    op.memory.mem = mem;
+    op.memory.image = image;
+    op.memory.func_name = func_name;
+    cb_node->submit_ops.push_back(op);
+}
+
+// Record that mem (or image, if it's a swapchain image) has valid or undefined contents once cb_node is submitted
+static void addSetMemoryValidOp(GLOBAL_CB_NODE *cb_node, VkDeviceMemory mem, bool valid, VkImage image = VK_NULL_HANDLE) {
+    CB_SUBMIT_OP op = {};
+    op.type = CB_SUBMIT_OP_SET_MEMORY_VALID;
+    op.memory.mem = mem;
+    op.memory.image = image;
+    op.memory.valid = valid;
+    cb_node->submit_ops.push_back(op);
+}
+
+static void addSetEventStageMaskOp(GLOBAL_CB_NODE *cb_node, VkEvent event, VkPipelineStageFlags stage_mask) {
+    CB_SUBMIT_OP op = {};
+    op.type = CB_SUBMIT_OP_SET_EVENT_STAGE_MASK;
+    op.event.event = event;
+    op.event.stage_mask = stage_mask;
+    cb_node->submit_ops.push_back(op);
+}
+
+static void addValidateEventStageMaskOp(GLOBAL_CB_NODE *cb_node, uint32_t event_count, size_t first_event_index,
+                                        VkPipelineStageFlags src_stage_mask) {
+    CB_SUBMIT_OP op = {};
+    op.type = CB_SUBMIT_OP_VALIDATE_EVENT_STAGE_MASK;
+    op.wait.first_event_index = first_event_index;
+    op.wait.event_count = event_count;
+    op.wait.src_stage_mask = src_stage_mask;
+    cb_node->submit_ops.push_back(op);
+}
+
+static void addSetQueryStateOp(GLOBAL_CB_NODE *cb_node, QueryObject query, bool available) {
+    CB_SUBMIT_OP op = {};
+    op.type = CB_SUBMIT_OP_SET_QUERY_STATE;
+    op.query.pool = query.pool;
+    op.query.index = query.index;
+    op.query.available = available;
+    cb_node->submit_ops.push_back(op);
+}
+
+static void addValidateQueryOp(GLOBAL_CB_NODE *cb_node, VkQueryPool pool, uint32_t first_query, uint32_t query_count) {
+    CB_SUBMIT_OP op = {};
+    op.type = CB_SUBMIT_OP_VALIDATE_QUERY;
+    op.query.pool = pool;
+    op.query.index = first_query;
+    op.query.count = query_count;
+    cb_node->submit_ops.push_back(op);
+}
+
 // Find CB Info and add mem reference to list container
 // Find Mem Obj Info and add CB reference to list container
 static bool update_cmd_buf_and_mem_references(layer_data *dev_data, const VkCommandBuffer cb, const VkDeviceMemory mem,
@@ -497,6 +642,7 @@ static bool update_cmd_buf_and_mem_references(layer_data *dev_data, const VkComm
         // First update CB binding in MemObj mini CB list
         DEVICE_MEM_INFO *pMemInfo = getMemObjInfo(dev_data, mem);
         if (pMemInfo) {
+            std::lock_guard<std::mutex> bind_lock(binding_lock);
             pMemInfo->commandBufferBindings.insert(cb);
             // Now update CBInfo's Mem reference list
             GLOBAL_CB_NODE *pCBNode = getCBNode(dev_data, cb);
@@ -512,6 +658,7 @@ static bool update_cmd_buf_and_mem_references(layer_data *dev_data, const VkComm
 // Create binding link between given iamge node and command buffer node
 static bool addCommandBufferBindingImage(layer_data *dev_data, GLOBAL_CB_NODE *cb_node, IMAGE_NODE *img_node, const char *apiName) {
     bool skip_call = false;
+    std::lock_guard<std::mutex> bind_lock(binding_lock);
     // Skip validation if this image was created through WSI
     if (img_node->mem != MEMTRACKER_SWAP_CHAIN_IMAGE_KEY) {
         // First update CB binding in MemObj mini CB list
@@ -532,6 +679,7 @@ static bool addCommandBufferBindingImage(layer_data *dev_data, GLOBAL_CB_NODE *c
 static bool addCommandBufferBindingBuffer(layer_data *dev_data, GLOBAL_CB_NODE *cb_node, BUFFER_NODE *buff_node,
                                           const char *apiName) {
     bool skip_call = false;
+    std::lock_guard<std::mutex> bind_lock(binding_lock);
 
     // First update CB binding in MemObj mini CB list
     DEVICE_MEM_INFO *pMemInfo = getMemObjInfo(dev_data, buff_node->mem);
@@ -559,7 +707,10 @@ static void clear_cmd_buf_and_mem_references(layer_data *dev_data, GLOBAL_CB_NOD
             }
             pCBNode->memObjs.clear();
         }
-        pCBNode->validate_functions.clear();
+        // Memory ops refer to the memory just unbound from the CB, but event and query ops still apply
+        pCBNode->submit_ops.erase(std::remove_if(pCBNode->submit_ops.begin(), pCBNode->submit_ops.end(),
+                                                 [](const CB_SUBMIT_OP &op) { return op.type <= CB_SUBMIT_OP_SET_MEMORY_VALID; }),
+                                  pCBNode->submit_ops.end());
     }
 }
 // Overloaded call to above function when GLOBAL_CB_NODE has not already been looked-up
@@ -2106,7 +2257,7 @@ static VkDescriptorSetLayoutBinding const * get_descriptor_binding(PIPELINE_LAYO
 
 // Block of code at start here for managing/tracking Pipeline state that this layer cares about
 
-static uint64_t g_drawCount[NUM_DRAW_TYPES] = {0, 0, 0, 0};
+static std::atomic<uint64_t> g_drawCount[NUM_DRAW_TYPES];
 
 // TODO : Should be tracking lastBound per commandBuffer and when draws occur, report based on that cmd buffer lastBound
 //   Then need to synchronize the accesses based on cmd buffer so that if I'm reading state on one cmd buffer, updates
@@ -2788,24 +2939,51 @@ cvdescriptorset::DescriptorSet *getSetNode(const layer_data *my_data, VkDescript
 //     descriptor update must not overflow the size of its buffer being updated
 //  2. Grow updateImages for given pCB to include any bound STORAGE_IMAGE descriptor images
 //  3. Grow updateBuffers for pCB to include buffers from STORAGE*_BUFFER descriptor buffers
+//  All of this is skipped for a set that pCB already validated without error for the same bindings and dynamic offsets, if
+//  neither the set nor any resource it could reference has changed since.
 static bool validate_and_update_drawtime_descriptor_state(
     layer_data *dev_data, GLOBAL_CB_NODE *pCB,
-    const vector<std::tuple<cvdescriptorset::DescriptorSet *, unordered_set<uint32_t>,
+    const vector<std::tuple<cvdescriptorset::DescriptorSet *, unordered_set<uint32_t> const *,
                             std::vector<uint32_t> const *>> &activeSetBindingsPairs) {
     bool result = false;
     for (auto set_bindings_pair : activeSetBindingsPairs) {
         cvdescriptorset::DescriptorSet *set_node = std::get<0>(set_bindings_pair);
+        auto bindings = std::get<1>(set_bindings_pair);
+        auto dynamic_offsets = std::get<2>(set_bindings_pair);
+        auto &validated_states = pCB->validated_sets[set_node];
+        VALIDATED_SET_STATE *validated_state = nullptr;
+        for (auto &state : validated_states) {
+            if (state.bindings == bindings) {
+                validated_state = &state;
+                break;
+            }
+        }
+        if (validated_state && validated_state->set_generation == set_node->GetGeneration() &&
+            validated_state->resource_generation == dev_data->resource_generation &&
+            validated_state->dynamic_offsets == *dynamic_offsets) {
+            continue;
+        }
         std::string err_str;
-        if (!set_node->ValidateDrawState(std::get<1>(set_bindings_pair), *std::get<2>(set_bindings_pair),
-                                         &err_str)) {
+        if (!set_node->ValidateDrawState(*bindings, *dynamic_offsets, &err_str)) {
             // Report error here
             auto set = set_node->GetSet();
             result |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT,
                               reinterpret_cast<const uint64_t &>(set), __LINE__, DRAWSTATE_DESCRIPTOR_SET_NOT_UPDATED, "DS",
                               "DS 0x%" PRIxLEAST64 " encountered the following validation error at draw time: %s",
                               reinterpret_cast<const uint64_t &>(set), err_str.c_str());
+        } else {
+            // Remember the state this set passed in, so that errors keep being reported on every draw but clean state
+            //  is only validated once
+            if (!validated_state) {
+                validated_states.push_back(VALIDATED_SET_STATE());
+                validated_state = &validated_states.back();
+                validated_state->bindings = bindings;
+            }
+            validated_state->set_generation = set_node->GetGeneration();
+            validated_state->resource_generation = dev_data->resource_generation;
+            validated_state->dynamic_offsets = *dynamic_offsets;
         }
-        set_node->GetStorageUpdates(std::get<1>(set_bindings_pair), &pCB->updateBuffers, &pCB->updateImages);
+        set_node->GetStorageUpdates(*bindings, &pCB->updateBuffers, &pCB->updateImages);
     }
     return result;
 }
@@ -2973,7 +3151,8 @@ static bool validate_and_update_draw_state(layer_data *my_data, GLOBAL_CB_NODE *
         auto pipeline_layout = pPipe->pipeline_layout;
 
         // Need a vector (vs. std::set) of active Sets for dynamicOffset validation in case same set bound w/ different offsets
-        vector<std::tuple<cvdescriptorset::DescriptorSet *, unordered_set<uint32_t>, std::vector<uint32_t> const *>> activeSetBindingsPairs;
+        vector<std::tuple<cvdescriptorset::DescriptorSet *, unordered_set<uint32_t> const *, std::vector<uint32_t> const *>>
+            activeSetBindingsPairs;
         for (auto & setBindingPair : pPipe->active_slots) {
             uint32_t setIndex = setBindingPair.first;
             // If valid set is not bound throw an error
@@ -2997,7 +3176,7 @@ static bool validate_and_update_draw_state(layer_data *my_data, GLOBAL_CB_NODE *
                 // Pull the set node
                 cvdescriptorset::DescriptorSet *pSet = state.boundDescriptorSets[setIndex];
                 // Save vector of all active sets to verify dynamicOffsets below
-                activeSetBindingsPairs.push_back(std::make_tuple(pSet, setBindingPair.second,
+                activeSetBindingsPairs.push_back(std::make_tuple(pSet, &setBindingPair.second,
                                                                  &state.dynamicOffsets[setIndex]));
                 // Make sure set has been updated if it has no immutable samplers
                 //  If it has immutable samplers, we'll flag error later as needed depending on binding
@@ -3354,193 +3533,170 @@ static bool validateUpdateConsistency(layer_data *my_data, const VkDevice device
     }
     return skip_call;
 }
-//TODO: Consolidate functions
-bool FindLayout(const GLOBAL_CB_NODE *pCB, ImageSubresourcePair imgpair, IMAGE_CMD_BUF_LAYOUT_NODE &node, const VkImageAspectFlags aspectMask) {
-    layer_data *my_data = get_my_data_ptr(get_dispatch_key(pCB->commandBuffer), layer_data_map);
-    if (!(imgpair.subresource.aspectMask & aspectMask)) {
-        return false;
-    }
-    VkImageAspectFlags oldAspectMask = imgpair.subresource.aspectMask;
-    imgpair.subresource.aspectMask = aspectMask;
-    auto imgsubIt = pCB->imageLayoutMap.find(imgpair);
-    if (imgsubIt == pCB->imageLayoutMap.end()) {
-        return false;
-    }
-    if (node.layout != VK_IMAGE_LAYOUT_MAX_ENUM && node.layout != imgsubIt->second.layout) {
-        log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT,
-                reinterpret_cast<uint64_t&>(imgpair.image), __LINE__, DRAWSTATE_INVALID_LAYOUT, "DS",
-                "Cannot query for VkImage 0x%" PRIx64 " layout when combined aspect mask %d has multiple layout types: %s and %s",
-                reinterpret_cast<uint64_t&>(imgpair.image), oldAspectMask, string_VkImageLayout(node.layout), string_VkImageLayout(imgsubIt->second.layout));
-    }
-    if (node.initialLayout != VK_IMAGE_LAYOUT_MAX_ENUM && node.initialLayout != imgsubIt->second.initialLayout) {
-        log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT,
-                reinterpret_cast<uint64_t&>(imgpair.image), __LINE__, DRAWSTATE_INVALID_LAYOUT, "DS",
-                "Cannot query for VkImage 0x%" PRIx64 " layout when combined aspect mask %d has multiple initial layout types: %s and %s",
-                reinterpret_cast<uint64_t&>(imgpair.image), oldAspectMask, string_VkImageLayout(node.initialLayout), string_VkImageLayout(imgsubIt->second.initialLayout));
-    }
-    node = imgsubIt->second;
-    return true;
-}
+typedef IMAGE_LAYOUT_RANGE_MAP<VkImageLayout> LAYOUT_KEYS;
 
-bool FindLayout(const layer_data *my_data, ImageSubresourcePair imgpair, VkImageLayout &layout, const VkImageAspectFlags aspectMask) {
-    if (!(imgpair.subresource.aspectMask & aspectMask)) {
-        return false;
-    }
-    VkImageAspectFlags oldAspectMask = imgpair.subresource.aspectMask;
-    imgpair.subresource.aspectMask = aspectMask;
-    auto imgsubIt = my_data->imageLayoutMap.find(imgpair);
-    if (imgsubIt == my_data->imageLayoutMap.end()) {
-        return false;
-    }
-    if (layout != VK_IMAGE_LAYOUT_MAX_ENUM && layout != imgsubIt->second.layout) {
-        log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT,
-                reinterpret_cast<uint64_t&>(imgpair.image), __LINE__, DRAWSTATE_INVALID_LAYOUT, "DS",
-                "Cannot query for VkImage 0x%" PRIx64 " layout when combined aspect mask %d has multiple layout types: %s and %s",
-                reinterpret_cast<uint64_t&>(imgpair.image), oldAspectMask, string_VkImageLayout(layout), string_VkImageLayout(imgsubIt->second.layout));
-    }
-    layout = imgsubIt->second.layout;
-    return true;
-}
+// Call fn(begin, end) for the spans of layout map keys that hold the subresources in range, in key order
+//  The range is clipped to the image's mip levels and array layers. A range that covers every layer of its levels is a
+//  single span per aspect.
+template <typename Fn>
+static void ForEachLayoutKeyRange(const layer_data *dev_data, VkImage image, const VkImageSubresourceRange &range, Fn fn) {
+    auto image_node = getImageNode(dev_data, image);
+    if (!image_node)
+        return;
+    const uint32_t mip_levels = image_node->createInfo.mipLevels;
+    const uint32_t array_layers = image_node->createInfo.arrayLayers;
+    if ((range.baseMipLevel >= mip_levels) || (range.baseArrayLayer >= array_layers))
+        return;
+    uint32_t level_count = range.levelCount;
+    if ((level_count == VK_REMAINING_MIP_LEVELS) || (level_count > mip_levels - range.baseMipLevel))
+        level_count = mip_levels - range.baseMipLevel;
+    uint32_t layer_count = range.layerCount;
+    if ((layer_count == VK_REMAINING_ARRAY_LAYERS) || (layer_count > array_layers - range.baseArrayLayer))
+        layer_count = array_layers - range.baseArrayLayer;
+    if (!level_count || !layer_count)
+        return;
 
-// find layout(s) on the cmd buf level
-bool FindLayout(const GLOBAL_CB_NODE *pCB, VkImage image, VkImageSubresource range, IMAGE_CMD_BUF_LAYOUT_NODE &node) {
-    ImageSubresourcePair imgpair = {image, true, range};
-    node = IMAGE_CMD_BUF_LAYOUT_NODE(VK_IMAGE_LAYOUT_MAX_ENUM, VK_IMAGE_LAYOUT_MAX_ENUM);
-    FindLayout(pCB, imgpair, node, VK_IMAGE_ASPECT_COLOR_BIT);
-    FindLayout(pCB, imgpair, node, VK_IMAGE_ASPECT_DEPTH_BIT);
-    FindLayout(pCB, imgpair, node, VK_IMAGE_ASPECT_STENCIL_BIT);
-    FindLayout(pCB, imgpair, node, VK_IMAGE_ASPECT_METADATA_BIT);
-    if (node.layout == VK_IMAGE_LAYOUT_MAX_ENUM) {
-        imgpair = {image, false, VkImageSubresource()};
-        auto imgsubIt = pCB->imageLayoutMap.find(imgpair);
-        if (imgsubIt == pCB->imageLayoutMap.end())
-            return false;
-        node = imgsubIt->second;
+    const bool all_layers = (range.baseArrayLayer == 0) && (layer_count == array_layers);
+    const uint32_t last_level = range.baseMipLevel + level_count - 1;
+    const uint32_t last_layer = range.baseArrayLayer + layer_count - 1;
+    // Aspect bits COLOR, DEPTH, STENCIL and METADATA are keyed by their bit index
+    for (uint32_t aspect_index = 0; aspect_index < 4; ++aspect_index) {
+        if (!(range.aspectMask & (1u << aspect_index)))
+            continue;
+        if (all_layers) {
+            fn(LAYOUT_KEYS::key(aspect_index, range.baseMipLevel, 0, array_layers),
+               LAYOUT_KEYS::key(aspect_index, last_level, last_layer, array_layers));
+        } else {
+            for (uint32_t level = range.baseMipLevel; level <= last_level; ++level) {
+                fn(LAYOUT_KEYS::key(aspect_index, level, range.baseArrayLayer, array_layers),
+                   LAYOUT_KEYS::key(aspect_index, level, last_layer, array_layers));
+            }
+        }
     }
-    return true;
 }
 
-// find layout(s) on the global level
-bool FindLayout(const layer_data *my_data, ImageSubresourcePair imgpair, VkImageLayout &layout) {
-    layout = VK_IMAGE_LAYOUT_MAX_ENUM;
-    FindLayout(my_data, imgpair, layout, VK_IMAGE_ASPECT_COLOR_BIT);
-    FindLayout(my_data, imgpair, layout, VK_IMAGE_ASPECT_DEPTH_BIT);
-    FindLayout(my_data, imgpair, layout, VK_IMAGE_ASPECT_STENCIL_BIT);
-    FindLayout(my_data, imgpair, layout, VK_IMAGE_ASPECT_METADATA_BIT);
-    if (layout == VK_IMAGE_LAYOUT_MAX_ENUM) {
-        imgpair = {imgpair.image, false, VkImageSubresource()};
-        auto imgsubIt = my_data->imageLayoutMap.find(imgpair);
-        if (imgsubIt == my_data->imageLayoutMap.end())
-            return false;
-        layout = imgsubIt->second.layout;
+struct CB_LAYOUT_PIECE {
+    uint64_t begin;
+    uint64_t end;
+    const IMAGE_CMD_BUF_LAYOUT_NODE *node;
+};
+
+// Report subresources whose aspects in pieces (in key order, one aspect after the other) are in different layouts
+//  This is what a query for the layout of a combined aspect mask such as depth and stencil would have to choose between.
+static void ValidateCombinedAspectLayouts(const layer_data *dev_data, VkImage image, VkImageAspectFlags aspect_mask,
+                                          const std::vector<CB_LAYOUT_PIECE> &pieces) {
+    // Index of the first piece of each aspect, and the end of the last one
+    std::vector<size_t> aspect_starts;
+    for (size_t i = 0; i < pieces.size(); ++i) {
+        if (!i || (LAYOUT_KEYS::keyAspectIndex(pieces[i].begin) != LAYOUT_KEYS::keyAspectIndex(pieces[i - 1].begin)))
+            aspect_starts.push_back(i);
+    }
+    aspect_starts.push_back(pieces.size());
+
+    bool layout_reported = false;
+    bool initial_layout_reported = false;
+    // Walk each other aspect's pieces alongside the first aspect's, comparing where they cover the same subresources
+    for (size_t aspect = 1; aspect + 1 < aspect_starts.size(); ++aspect) {
+        size_t i = aspect_starts[0];
+        size_t j = aspect_starts[aspect];
+        while ((i < aspect_starts[1]) && (j < aspect_starts[aspect + 1])) {
+            const CB_LAYOUT_PIECE &a = pieces[i];
+            const CB_LAYOUT_PIECE &b = pieces[j];
+            const uint64_t a_end = a.end & LAYOUT_KEYS::SUBRESOURCE_MASK;
+            const uint64_t b_end = b.end & LAYOUT_KEYS::SUBRESOURCE_MASK;
+            const bool overlap = std::max(a.begin & LAYOUT_KEYS::SUBRESOURCE_MASK, b.begin & LAYOUT_KEYS::SUBRESOURCE_MASK) <=
+                                 std::min(a_end, b_end);
+            if (overlap && a.node && b.node) {
+                if (!layout_reported && (a.node->layout != b.node->layout)) {
+                    log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT,
+                            reinterpret_cast<uint64_t &>(image), __LINE__, DRAWSTATE_INVALID_LAYOUT, "DS",
+                            "Cannot query for VkImage 0x%" PRIx64 " layout when combined aspect mask %d has multiple layout types: %s and %s",
+                            reinterpret_cast<uint64_t &>(image), aspect_mask, string_VkImageLayout(a.node->layout),
+                            string_VkImageLayout(b.node->layout));
+                    layout_reported = true;
+                }
+                if (!initial_layout_reported && (a.node->initialLayout != b.node->initialLayout)) {
+                    log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT,
+                            reinterpret_cast<uint64_t &>(image), __LINE__, DRAWSTATE_INVALID_LAYOUT, "DS",
+                            "Cannot query for VkImage 0x%" PRIx64 " layout when combined aspect mask %d has multiple initial layout types: %s and %s",
+                            reinterpret_cast<uint64_t &>(image), aspect_mask, string_VkImageLayout(a.node->initialLayout),
+                            string_VkImageLayout(b.node->initialLayout));
+                    initial_layout_reported = true;
+                }
+            }
+            if (a_end <= b_end)
+                ++i;
+            if (b_end <= a_end)
+                ++j;
+        }
     }
-    return true;
 }
 
-bool FindLayout(const layer_data *my_data, VkImage image, VkImageSubresource range, VkImageLayout &layout) {
-    ImageSubresourcePair imgpair = {image, true, range};
-    return FindLayout(my_data, imgpair, layout);
+// Update the layouts pCB leaves the subresources in range in
+//  fn is called for each piece of the range with the command buffer's state for it, or nullptr where the command buffer
+//  has not used the subresources yet, and returns the state to store for the piece.
+template <typename Fn>
+static void UpdateCBLayouts(const layer_data *dev_data, GLOBAL_CB_NODE *pCB, VkImage image, const VkImageSubresourceRange &range,
+                            Fn fn) {
+    auto &layouts = pCB->imageLayoutMap[image];
+    std::vector<CB_LAYOUT_PIECE> pieces;
+    ForEachLayoutKeyRange(dev_data, image, range, [&](uint64_t begin, uint64_t end) {
+        layouts.forEach(begin, end, [&](uint64_t piece_begin, uint64_t piece_end, const IMAGE_CMD_BUF_LAYOUT_NODE *node) {
+            pieces.push_back({piece_begin, piece_end, node});
+        });
+    });
+    if (range.aspectMask & (range.aspectMask - 1))
+        ValidateCombinedAspectLayouts(dev_data, image, range.aspectMask, pieces);
+    // Work out every new state before setting any, as setting can drop the runs the pieces point into
+    std::vector<IMAGE_CMD_BUF_LAYOUT_NODE> new_nodes;
+    new_nodes.reserve(pieces.size());
+    for (auto &piece : pieces) {
+        new_nodes.push_back(fn(piece.node));
+    }
+    for (size_t i = 0; i < pieces.size(); ++i) {
+        layouts.set(pieces[i].begin, pieces[i].end, new_nodes[i]);
+    }
 }
 
+// Collect the distinct layouts of the subresources of image on the global level
 bool FindLayouts(const layer_data *my_data, VkImage image, std::vector<VkImageLayout> &layouts) {
-    auto sub_data = my_data->imageSubresourceMap.find(image);
-    if (sub_data == my_data->imageSubresourceMap.end())
+    auto image_layouts = my_data->imageLayoutMap.find(image);
+    if (image_layouts == my_data->imageLayoutMap.end())
         return false;
     auto img_node = getImageNode(my_data, image);
     if (!img_node)
         return false;
-    bool ignoreGlobal = false;
-    // TODO: Make this robust for >1 aspect mask. Now it will just say ignore
-    // potential errors in this case.
-    if (sub_data->second.size() >= (img_node->createInfo.arrayLayers * img_node->createInfo.mipLevels + 1)) {
-        ignoreGlobal = true;
-    }
-    for (auto imgsubpair : sub_data->second) {
-        if (ignoreGlobal && !imgsubpair.hasSubresource)
+    // Only visit keys of real subresources, skipping aspects the format doesn't have
+    VkImageAspectFlags aspect_mask = VK_IMAGE_ASPECT_COLOR_BIT;
+    if (vk_format_is_depth_or_stencil(img_node->createInfo.format)) {
+        aspect_mask = 0;
+        if (!vk_format_is_stencil_only(img_node->createInfo.format))
+            aspect_mask |= VK_IMAGE_ASPECT_DEPTH_BIT;
+        if (!vk_format_is_depth_only(img_node->createInfo.format))
+            aspect_mask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+    }
+    const uint32_t array_layers = img_node->createInfo.arrayLayers;
+    for (uint32_t aspect_index = 0; aspect_index < 4; ++aspect_index) {
+        if (!(aspect_mask & (1u << aspect_index)))
             continue;
-        auto img_data = my_data->imageLayoutMap.find(imgsubpair);
-        if (img_data != my_data->imageLayoutMap.end()) {
-            layouts.push_back(img_data->second.layout);
-        }
+        image_layouts->second.forEach(LAYOUT_KEYS::key(aspect_index, 0, 0, array_layers),
+                                      LAYOUT_KEYS::key(aspect_index, img_node->createInfo.mipLevels - 1, array_layers - 1, array_layers),
+                                      [&](uint64_t, uint64_t, const VkImageLayout *layout) {
+                                          if (layout && std::find(layouts.begin(), layouts.end(), *layout) == layouts.end())
+                                              layouts.push_back(*layout);
+                                      });
     }
     return true;
 }
 
-// Set the layout on the global level
-void SetLayout(layer_data *my_data, ImageSubresourcePair imgpair, const VkImageLayout &layout) {
-    VkImage &image = imgpair.image;
-    // TODO (mlentine): Maybe set format if new? Not used atm.
-    my_data->imageLayoutMap[imgpair].layout = layout;
-    // TODO (mlentine): Maybe make vector a set?
-    auto subresource = std::find(my_data->imageSubresourceMap[image].begin(), my_data->imageSubresourceMap[image].end(), imgpair);
-    if (subresource == my_data->imageSubresourceMap[image].end()) {
-        my_data->imageSubresourceMap[image].push_back(imgpair);
-    }
-}
-
-// Set the layout on the cmdbuf level
-void SetLayout(GLOBAL_CB_NODE *pCB, ImageSubresourcePair imgpair, const IMAGE_CMD_BUF_LAYOUT_NODE &node) {
-    pCB->imageLayoutMap[imgpair] = node;
-    // TODO (mlentine): Maybe make vector a set?
-    auto subresource =
-        std::find(pCB->imageSubresourceMap[imgpair.image].begin(), pCB->imageSubresourceMap[imgpair.image].end(), imgpair);
-    if (subresource == pCB->imageSubresourceMap[imgpair.image].end()) {
-        pCB->imageSubresourceMap[imgpair.image].push_back(imgpair);
-    }
-}
-
-void SetLayout(GLOBAL_CB_NODE *pCB, ImageSubresourcePair imgpair, const VkImageLayout &layout) {
-    // TODO (mlentine): Maybe make vector a set?
-    if (std::find(pCB->imageSubresourceMap[imgpair.image].begin(), pCB->imageSubresourceMap[imgpair.image].end(), imgpair) !=
-        pCB->imageSubresourceMap[imgpair.image].end()) {
-        pCB->imageLayoutMap[imgpair].layout = layout;
-    } else {
-        // TODO (mlentine): Could be expensive and might need to be removed.
-        assert(imgpair.hasSubresource);
-        IMAGE_CMD_BUF_LAYOUT_NODE node;
-        if (!FindLayout(pCB, imgpair.image, imgpair.subresource, node)) {
-            node.initialLayout = layout;
-        }
-        SetLayout(pCB, imgpair, {node.initialLayout, layout});
-    }
-}
-
-template <class OBJECT, class LAYOUT>
-void SetLayout(OBJECT *pObject, ImageSubresourcePair imgpair, const LAYOUT &layout, VkImageAspectFlags aspectMask) {
-    if (imgpair.subresource.aspectMask & aspectMask) {
-        imgpair.subresource.aspectMask = aspectMask;
-        SetLayout(pObject, imgpair, layout);
-    }
-}
-
-template <class OBJECT, class LAYOUT>
-void SetLayout(OBJECT *pObject, VkImage image, VkImageSubresource range, const LAYOUT &layout) {
-    ImageSubresourcePair imgpair = {image, true, range};
-    SetLayout(pObject, imgpair, layout, VK_IMAGE_ASPECT_COLOR_BIT);
-    SetLayout(pObject, imgpair, layout, VK_IMAGE_ASPECT_DEPTH_BIT);
-    SetLayout(pObject, imgpair, layout, VK_IMAGE_ASPECT_STENCIL_BIT);
-    SetLayout(pObject, imgpair, layout, VK_IMAGE_ASPECT_METADATA_BIT);
-}
-
-template <class OBJECT, class LAYOUT> void SetLayout(OBJECT *pObject, VkImage image, const LAYOUT &layout) {
-    ImageSubresourcePair imgpair = {image, false, VkImageSubresource()};
-    SetLayout(pObject, image, imgpair, layout);
-}
-
+// Set the layout on the cmdbuf level for the subresources of imageView
 void SetLayout(const layer_data *dev_data, GLOBAL_CB_NODE *pCB, VkImageView imageView, const VkImageLayout &layout) {
     auto iv_data = getImageViewData(dev_data, imageView);
     assert(iv_data);
-    const VkImage &image = iv_data->image;
-    const VkImageSubresourceRange &subRange = iv_data->subresourceRange;
-    // TODO: Do not iterate over every possibility - consolidate where possible
-    for (uint32_t j = 0; j < subRange.levelCount; j++) {
-        uint32_t level = subRange.baseMipLevel + j;
-        for (uint32_t k = 0; k < subRange.layerCount; k++) {
-            uint32_t layer = subRange.baseArrayLayer + k;
-            VkImageSubresource sub = {subRange.aspectMask, level, layer};
-            SetLayout(pCB, image, sub, layout);
-        }
-    }
+    UpdateCBLayouts(dev_data, pCB, iv_data->image, iv_data->subresourceRange,
+                    [&](const IMAGE_CMD_BUF_LAYOUT_NODE *node) -> IMAGE_CMD_BUF_LAYOUT_NODE {
+                        return IMAGE_CMD_BUF_LAYOUT_NODE(node ? node->initialLayout : layout, layout);
+                    });
 }
 
 // Validate that given set is valid and that it's not being used by an in-flight CmdBuffer
@@ -3582,6 +3738,8 @@ static void deletePools(layer_data *my_data) {
             freeDescriptorSet(my_data, ds);
         }
         (*ii).second->sets.clear();
+        delete (*ii).second->descriptor_arena;
+        (*ii).second->descriptor_arena = nullptr;
     }
     my_data->descriptorPoolMap.clear();
 }
@@ -3600,6 +3758,7 @@ static void clearDescriptorPool(layer_data *my_data, const VkDevice device, cons
             freeDescriptorSet(my_data, ds);
         }
         pPool->sets.clear();
+        pPool->descriptor_arena->Reset();
         // Reset available count for each type and available sets for this pool
         for (uint32_t i = 0; i < pPool->availableDescriptorTypeCount.size(); ++i) {
             pPool->availableDescriptorTypeCount[i] = pPool->maxDescriptorTypeCount[i];
@@ -3759,6 +3918,7 @@ static bool addCmd(layer_data *my_data, GLOBAL_CB_NODE *pCB, const CMD_TYPE cmd,
 //  Add object_binding to cmd buffer
 //  Add cb_binding to object
 static void addCommandBufferBinding(std::unordered_set<GLOBAL_CB_NODE *> *cb_bindings, VK_OBJECT obj, GLOBAL_CB_NODE *cb_node) {
+    std::lock_guard<std::mutex> bind_lock(binding_lock);
     cb_bindings->insert(cb_node);
     cb_node->object_bindings.insert(obj);
 }
@@ -3838,7 +3998,6 @@ static void resetCB(layer_data *dev_data, const VkCommandBuffer cb) {
         pCB->queryToStateMap.clear();
         pCB->activeQueries.clear();
         pCB->startedQueries.clear();
-        pCB->imageSubresourceMap.clear();
         pCB->imageLayoutMap.clear();
         pCB->eventToStageMap.clear();
         pCB->drawData.clear();
@@ -3851,9 +4010,9 @@ static void resetCB(layer_data *dev_data, const VkCommandBuffer cb) {
         pCB->secondaryCommandBuffers.clear();
         pCB->updateImages.clear();
         pCB->updateBuffers.clear();
+        pCB->validated_sets.clear();
         clear_cmd_buf_and_mem_references(dev_data, pCB);
-        pCB->eventUpdates.clear();
-        pCB->queryUpdates.clear();
+        pCB->submit_ops.clear();
 
         // Remove object bindings
         for (auto obj : pCB->object_bindings) {
@@ -3867,6 +4026,7 @@ static void resetCB(layer_data *dev_data, const VkCommandBuffer cb) {
         }
         pCB->framebuffers.clear();
         pCB->activeFramebuffer = VK_NULL_HANDLE;
+        pCB->deferred_log.clear();
     }
 }
 
@@ -3994,6 +4154,10 @@ static void init_core_validation(layer_data *instance_data, const VkAllocationCa
 
     layer_debug_actions(instance_data->report_data, instance_data->logging_callback, pAllocator, "lunarg_core_validation");
 
+    const char *deferred_option = getLayerOption("lunarg_core_validation.deferred_validation");
+    if (deferred_option) {
+        deferred_validation = (strcmp(deferred_option, "TRUE") == 0);
+    }
 }
 
 VKAPI_ATTR VkResult VKAPI_CALL
@@ -4039,7 +4203,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyInstance(VkInstance instance, const VkAllocati
     VkLayerInstanceDispatchTable *pTable = my_data->instance_dispatch_table;
     pTable->DestroyInstance(instance, pAllocator);
 
-    std::lock_guard<std::mutex> lock(global_lock);
+    std::lock_guard<sharded_mutex> lock(global_lock);
     // Clean up logging callback, if any
     while (my_data->logging_callback.size() > 0) {
         VkDebugReportCallbackEXT callback = my_data->logging_callback.back();
@@ -4173,7 +4337,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateDevice(VkPhysicalDevice gpu, const VkDevice
         return result;
     }
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     layer_data *my_device_data = get_my_data_ptr(get_dispatch_key(*pDevice), layer_data_map);
 
     // Setup device dispatch table
@@ -4212,7 +4376,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyDevice(VkDevice device, const VkAllocationCall
     dispatch_key key = get_dispatch_key(device);
     layer_data *dev_data = get_my_data_ptr(key, layer_data_map);
     // Free all the memory
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     deletePipelines(dev_data);
     deleteRenderPasses(dev_data);
     deleteCommandBuffers(dev_data);
@@ -4226,7 +4390,6 @@ VKAPI_ATTR void VKAPI_CALL DestroyDevice(VkDevice device, const VkAllocationCall
     dev_data->descriptorSetLayoutMap.clear();
     dev_data->imageViewMap.clear();
     dev_data->imageMap.clear();
-    dev_data->imageSubresourceMap.clear();
     dev_data->imageLayoutMap.clear();
     dev_data->bufferViewMap.clear();
     dev_data->bufferMap.clear();
@@ -4282,39 +4445,42 @@ static const VkExtensionProperties instance_extensions[] = {{VK_EXT_DEBUG_REPORT
 // as the global IMAGE layout
 static bool ValidateCmdBufImageLayouts(layer_data *dev_data, GLOBAL_CB_NODE *pCB) {
     bool skip_call = false;
-    for (auto cb_image_data : pCB->imageLayoutMap) {
-        VkImageLayout imageLayout;
-        if (!FindLayout(dev_data, cb_image_data.first, imageLayout)) {
+    for (auto &cb_image_data : pCB->imageLayoutMap) {
+        const VkImage image = cb_image_data.first;
+        auto image_layouts = dev_data->imageLayoutMap.find(image);
+        if (image_layouts == dev_data->imageLayoutMap.end()) {
             skip_call |=
                 log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, 0,
                         __LINE__, DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS", "Cannot submit cmd buffer using deleted image 0x%" PRIx64 ".",
-                        reinterpret_cast<const uint64_t &>(cb_image_data.first));
-        } else {
-            if (cb_image_data.second.initialLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
+                        reinterpret_cast<const uint64_t &>(image));
+            continue;
+        }
+        // Compare each run of the command buffer's state with the global layouts it covers, then apply it
+        auto &global_layouts = image_layouts->second;
+        auto image_node = getImageNode(dev_data, image);
+        const uint32_t array_layers = image_node ? image_node->createInfo.arrayLayers : 1;
+        cb_image_data.second.forEach(0, ~uint64_t(0), [&](uint64_t begin, uint64_t end, const IMAGE_CMD_BUF_LAYOUT_NODE *node) {
+            if (!node)
+                return;
+            if (node->initialLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
                 // TODO: Set memory invalid which is in mem_tracker currently
-            } else if (imageLayout != cb_image_data.second.initialLayout) {
-                if (cb_image_data.first.hasSubresource) {
+            } else {
+                global_layouts.forEach(begin, end, [&](uint64_t piece_begin, uint64_t, const VkImageLayout *layout) {
+                    if (!layout || *layout == node->initialLayout)
+                        return;
                     skip_call |= log_msg(
                         dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
                         reinterpret_cast<uint64_t &>(pCB->commandBuffer), __LINE__, DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS",
                         "Cannot submit cmd buffer using image (0x%" PRIx64 ") [sub-resource: aspectMask 0x%X array layer %u, mip level %u], "
                         "with layout %s when first use is %s.",
-                        reinterpret_cast<const uint64_t &>(cb_image_data.first.image), cb_image_data.first.subresource.aspectMask,
-                                cb_image_data.first.subresource.arrayLayer,
-                                cb_image_data.first.subresource.mipLevel, string_VkImageLayout(imageLayout),
-                        string_VkImageLayout(cb_image_data.second.initialLayout));
-                } else {
-                    skip_call |= log_msg(
-                        dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                        reinterpret_cast<uint64_t &>(pCB->commandBuffer), __LINE__, DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS",
-                        "Cannot submit cmd buffer using image (0x%" PRIx64 ") with layout %s when "
-                        "first use is %s.",
-                        reinterpret_cast<const uint64_t &>(cb_image_data.first.image), string_VkImageLayout(imageLayout),
-                        string_VkImageLayout(cb_image_data.second.initialLayout));
-                }
+                        reinterpret_cast<const uint64_t &>(image), 1u << LAYOUT_KEYS::keyAspectIndex(piece_begin),
+                        LAYOUT_KEYS::keyLayer(piece_begin, array_layers), LAYOUT_KEYS::keyLevel(piece_begin, array_layers),
+                        string_VkImageLayout(*layout),
+                        string_VkImageLayout(node->initialLayout));
+                });
             }
-            SetLayout(dev_data, cb_image_data.first, cb_image_data.second.layout);
-        }
+            global_layouts.set(begin, end, node->layout);
+        });
     }
     return skip_call;
 }
@@ -4686,12 +4852,46 @@ ValidateFenceForSubmit(layer_data *dev_data, FENCE_NODE *pFence)
 }
 
 
+// prototypes
+bool setEventStageMask(VkQueue, VkCommandBuffer, VkEvent, VkPipelineStageFlags);
+bool validateEventStageMask(VkQueue, GLOBAL_CB_NODE *, uint32_t, size_t, VkPipelineStageFlags);
+bool setQueryState(VkQueue, VkCommandBuffer, QueryObject, bool);
+bool validateQuery(VkQueue, GLOBAL_CB_NODE *, VkQueryPool, uint32_t, uint32_t);
+
+// Validate and update state for pCB's submission to queue, in the order its commands were recorded
+static bool runSubmitOps(layer_data *dev_data, VkQueue queue, GLOBAL_CB_NODE *pCB) {
+    bool skip_call = false;
+    for (auto &op : pCB->submit_ops) {
+        switch (op.type) {
+        case CB_SUBMIT_OP_VALIDATE_MEMORY:
+            skip_call |= validate_memory_is_valid(dev_data, op.memory.mem, op.memory.func_name, op.memory.image);
+            break;
+        case CB_SUBMIT_OP_SET_MEMORY_VALID:
+            set_memory_valid(dev_data, op.memory.mem, op.memory.valid, op.memory.image);
+            break;
+        case CB_SUBMIT_OP_SET_EVENT_STAGE_MASK:
+            skip_call |= setEventStageMask(queue, pCB->commandBuffer, op.event.event, op.event.stage_mask);
+            break;
+        case CB_SUBMIT_OP_VALIDATE_EVENT_STAGE_MASK:
+            skip_call |= validateEventStageMask(queue, pCB, op.wait.event_count, op.wait.first_event_index, op.wait.src_stage_mask);
+            break;
+        case CB_SUBMIT_OP_SET_QUERY_STATE:
+            skip_call |= setQueryState(queue, pCB->commandBuffer, {op.query.pool, op.query.index}, op.query.available);
+            break;
+        case CB_SUBMIT_OP_VALIDATE_QUERY:
+            skip_call |= validateQuery(queue, pCB, op.query.pool, op.query.count, op.query.index);
+            break;
+        }
+    }
+    return skip_call;
+}
+
 VKAPI_ATTR VkResult VKAPI_CALL
 QueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo *pSubmits, VkFence fence) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(queue), layer_data_map);
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
 
     auto pQueue = getQueueNode(dev_data, queue);
     auto pFence = getFenceNode(dev_data, fence);
@@ -4777,16 +4977,8 @@ QueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo *pSubmits, V
 
                 pCBNode->submitCount++; // increment submit count
                 skip_call |= validatePrimaryCommandBufferState(dev_data, pCBNode);
-                // Call submit-time functions to validate/update state
-                for (auto &function : pCBNode->validate_functions) {
-                    skip_call |= function();
-                }
-                for (auto &function : pCBNode->eventUpdates) {
-                    skip_call |= function(queue);
-                }
-                for (auto &function : pCBNode->queryUpdates) {
-                    skip_call |= function(queue);
-                }
+                // Run submit-time ops to validate/update state
+                skip_call |= runSubmitOps(dev_data, queue, pCBNode);
             }
         }
 
@@ -4804,7 +4996,7 @@ VKAPI_ATTR VkResult VKAPI_CALL AllocateMemory(VkDevice device, const VkMemoryAll
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = my_data->device_dispatch_table->AllocateMemory(device, pAllocateInfo, pAllocator, pMemory);
     // TODO : Track allocations and overall size here
-    std::lock_guard<std::mutex> lock(global_lock);
+    std::lock_guard<sharded_mutex> lock(global_lock);
     add_mem_obj_info(my_data, device, *pMemory, pAllocateInfo);
     print_mem_list(my_data);
     return result;
@@ -4821,8 +5013,9 @@ FreeMemory(VkDevice device, VkDeviceMemory mem, const VkAllocationCallbacks *pAl
     // buffers (on host or device) for anything other than destroying those objects will result in
     // undefined behavior.
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     bool skip_call = freeMemObjInfo(my_data, device, mem, false);
+    my_data->resource_generation++;
     print_mem_list(my_data);
     printCBList(my_data);
     lock.unlock();
@@ -4943,7 +5136,7 @@ WaitForFences(VkDevice device, uint32_t fenceCount, const VkFence *pFences, VkBo
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skip_call = false;
     // Verify fence status of submitted fences
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     for (uint32_t i = 0; i < fenceCount; i++) {
         skip_call |= verifyWaitFenceState(dev_data, pFences[i], "vkWaitForFences");
     }
@@ -4972,7 +5165,7 @@ WaitForFences(VkDevice device, uint32_t fenceCount, const VkFence *pFences, VkBo
 VKAPI_ATTR VkResult VKAPI_CALL GetFenceStatus(VkDevice device, VkFence fence) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skip_call = false;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     skip_call = verifyWaitFenceState(dev_data, fence, "vkGetFenceStatus");
     lock.unlock();
 
@@ -4994,7 +5187,7 @@ VKAPI_ATTR void VKAPI_CALL GetDeviceQueue(VkDevice device, uint32_t queueFamilyI
                                                             VkQueue *pQueue) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     dev_data->device_dispatch_table->GetDeviceQueue(device, queueFamilyIndex, queueIndex, pQueue);
-    std::lock_guard<std::mutex> lock(global_lock);
+    std::lock_guard<sharded_mutex> lock(global_lock);
 
     // Add queue to tracking set only if it is new
     auto result = dev_data->queues.emplace(*pQueue);
@@ -5018,7 +5211,7 @@ VKAPI_ATTR VkResult VKAPI_CALL QueueWaitIdle(VkQueue queue) {
 VKAPI_ATTR VkResult VKAPI_CALL DeviceWaitIdle(VkDevice device) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     for (auto queue : dev_data->queues) {
         skip_call |= decrementResources(dev_data, queue);
     }
@@ -5033,7 +5226,7 @@ VKAPI_ATTR VkResult VKAPI_CALL DeviceWaitIdle(VkDevice device) {
 VKAPI_ATTR void VKAPI_CALL DestroyFence(VkDevice device, VkFence fence, const VkAllocationCallbacks *pAllocator) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skip_call = false;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     auto fence_pair = dev_data->fenceMap.find(fence);
     if (fence_pair != dev_data->fenceMap.end()) {
         if (fence_pair->second.state == FENCE_INFLIGHT) {
@@ -5053,7 +5246,7 @@ VKAPI_ATTR void VKAPI_CALL
 DestroySemaphore(VkDevice device, VkSemaphore semaphore, const VkAllocationCallbacks *pAllocator) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     auto item = dev_data->semaphoreMap.find(semaphore);
     if (item != dev_data->semaphoreMap.end()) {
         if (item->second.in_use.load()) {
@@ -5070,7 +5263,7 @@ DestroySemaphore(VkDevice device, VkSemaphore semaphore, const VkAllocationCallb
 VKAPI_ATTR void VKAPI_CALL DestroyEvent(VkDevice device, VkEvent event, const VkAllocationCallbacks *pAllocator) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skip_call = false;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     auto event_node = getEventNode(dev_data, event);
     if (event_node) {
         if (event_node->in_use.load()) {
@@ -5093,7 +5286,7 @@ VKAPI_ATTR void VKAPI_CALL
 DestroyQueryPool(VkDevice device, VkQueryPool queryPool, const VkAllocationCallbacks *pAllocator) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     // TODO : Add detection for an in-flight queryPool
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     auto qp_node = getQueryPoolNode(dev_data, queryPool);
     if (qp_node) {
         // Any bound cmd buffers are now invalid
@@ -5110,7 +5303,7 @@ VKAPI_ATTR VkResult VKAPI_CALL GetQueryPoolResults(VkDevice device, VkQueryPool
                                                    VkQueryResultFlags flags) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     unordered_map<QueryObject, vector<VkCommandBuffer>> queriesInFlight;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     for (auto cmdBuffer : dev_data->globalInFlightCmdBuffers) {
         auto pCB = getCBNode(dev_data, cmdBuffer);
         for (auto queryStatePair : pCB->queryToStateMap) {
@@ -5208,46 +5401,37 @@ static bool print_memory_range_error(layer_data *dev_data, const uint64_t object
     }
 }
 
-static bool validate_memory_range(layer_data *dev_data, const vector<MEMORY_RANGE> &ranges, const MEMORY_RANGE &new_range,
+static bool validate_memory_range(layer_data *dev_data, const MEMORY_RANGE_MAP &ranges, const MEMORY_RANGE &new_range,
                                   VkDebugReportObjectTypeEXT object_type) {
     bool skip_call = false;
 
-    for (auto range : ranges) {
-        if ((range.end & ~(dev_data->phys_dev_properties.properties.limits.bufferImageGranularity - 1)) <
-            (new_range.start & ~(dev_data->phys_dev_properties.properties.limits.bufferImageGranularity - 1)))
-            continue;
-        if ((range.start & ~(dev_data->phys_dev_properties.properties.limits.bufferImageGranularity - 1)) >
-            (new_range.end & ~(dev_data->phys_dev_properties.properties.limits.bufferImageGranularity - 1)))
-            continue;
+    // Buffers and images alias if they share any bufferImageGranularity-sized page, so extend new_range to whole pages
+    VkDeviceSize granularity = dev_data->phys_dev_properties.properties.limits.bufferImageGranularity;
+    VkDeviceSize start = new_range.start & ~(granularity - 1);
+    VkDeviceSize end = new_range.end | (granularity - 1);
+    ranges.forEachOverlap(start, end, [&](const MEMORY_RANGE &range) {
         skip_call |= print_memory_range_error(dev_data, new_range.handle, range.handle, object_type);
-    }
+    });
     return skip_call;
 }
 
 static MEMORY_RANGE insert_memory_ranges(uint64_t handle, VkDeviceMemory mem, VkDeviceSize memoryOffset,
-                                         VkMemoryRequirements memRequirements, vector<MEMORY_RANGE> &ranges) {
+                                         VkMemoryRequirements memRequirements, MEMORY_RANGE_MAP &ranges) {
     MEMORY_RANGE range;
     range.handle = handle;
     range.memory = mem;
     range.start = memoryOffset;
     range.end = memoryOffset + memRequirements.size - 1;
-    ranges.push_back(range);
+    ranges.insert(range);
     return range;
 }
 
-static void remove_memory_ranges(uint64_t handle, VkDeviceMemory mem, vector<MEMORY_RANGE> &ranges) {
-    for (uint32_t item = 0; item < ranges.size(); item++) {
-        if ((ranges[item].handle == handle) && (ranges[item].memory == mem)) {
-            ranges.erase(ranges.begin() + item);
-            break;
-        }
-    }
-}
+static void remove_memory_ranges(uint64_t handle, MEMORY_RANGE_MAP &ranges) { ranges.erase(handle); }
 
 VKAPI_ATTR void VKAPI_CALL DestroyBuffer(VkDevice device, VkBuffer buffer,
                                          const VkAllocationCallbacks *pAllocator) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     if (!validateIdleBuffer(dev_data, buffer)) {
         // Clean up memory binding and range information for buffer
         auto buff_node = getBufferNode(dev_data, buffer);
@@ -5257,10 +5441,11 @@ VKAPI_ATTR void VKAPI_CALL DestroyBuffer(VkDevice device, VkBuffer buffer,
                                      {reinterpret_cast<uint64_t &>(buff_node->buffer), VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT});
             auto mem_info = getMemObjInfo(dev_data, buff_node->mem);
             if (mem_info) {
-                remove_memory_ranges(reinterpret_cast<uint64_t &>(buffer), buff_node->mem, mem_info->bufferRanges);
+                remove_memory_ranges(reinterpret_cast<uint64_t &>(buffer), mem_info->bufferRanges);
             }
             clear_object_binding(dev_data, reinterpret_cast<uint64_t &>(buffer), VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT);
             dev_data->bufferMap.erase(buff_node->buffer);
+            dev_data->resource_generation++;
         }
         lock.unlock();
         dev_data->device_dispatch_table->DestroyBuffer(device, buffer, pAllocator);
@@ -5271,10 +5456,11 @@ VKAPI_ATTR void VKAPI_CALL
 DestroyBufferView(VkDevice device, VkBufferView bufferView, const VkAllocationCallbacks *pAllocator) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     auto item = dev_data->bufferViewMap.find(bufferView);
     if (item != dev_data->bufferViewMap.end()) {
         dev_data->bufferViewMap.erase(item);
+        dev_data->resource_generation++;
     }
     lock.unlock();
     dev_data->device_dispatch_table->DestroyBufferView(device, bufferView, pAllocator);
@@ -5283,7 +5469,7 @@ DestroyBufferView(VkDevice device, VkBufferView bufferView, const VkAllocationCa
 VKAPI_ATTR void VKAPI_CALL DestroyImage(VkDevice device, VkImage image, const VkAllocationCallbacks *pAllocator) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     auto img_node = getImageNode(dev_data, image);
     if (img_node) {
         // Any bound cmd buffers are now invalid
@@ -5292,20 +5478,14 @@ VKAPI_ATTR void VKAPI_CALL DestroyImage(VkDevice device, VkImage image, const Vk
         // Clean up memory mapping, bindings and range references for image
         auto mem_info = getMemObjInfo(dev_data, img_node->mem);
         if (mem_info) {
-            remove_memory_ranges(reinterpret_cast<uint64_t &>(image), img_node->mem, mem_info->imageRanges);
+            remove_memory_ranges(reinterpret_cast<uint64_t &>(image), mem_info->imageRanges);
             clear_object_binding(dev_data, reinterpret_cast<uint64_t &>(image), VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT);
             mem_info->image = VK_NULL_HANDLE;
         }
         // Remove image from imageMap
         dev_data->imageMap.erase(img_node->image);
     }
-    const auto& subEntry = dev_data->imageSubresourceMap.find(image);
-    if (subEntry != dev_data->imageSubresourceMap.end()) {
-        for (const auto& pair : subEntry->second) {
-            dev_data->imageLayoutMap.erase(pair);
-        }
-        dev_data->imageSubresourceMap.erase(subEntry);
-    }
+    dev_data->imageLayoutMap.erase(image);
     lock.unlock();
     dev_data->device_dispatch_table->DestroyImage(device, image, pAllocator);
 }
@@ -5328,7 +5508,7 @@ VKAPI_ATTR VkResult VKAPI_CALL
 BindBufferMemory(VkDevice device, VkBuffer buffer, VkDeviceMemory mem, VkDeviceSize memoryOffset) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     // Track objects tied to memory
     uint64_t buffer_handle = (uint64_t)(buffer);
     bool skip_call = set_mem_binding(dev_data, mem, buffer_handle, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, "vkBindBufferMemory");
@@ -5430,7 +5610,7 @@ VKAPI_ATTR void VKAPI_CALL
 DestroyShaderModule(VkDevice device, VkShaderModule shaderModule, const VkAllocationCallbacks *pAllocator) {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     my_data->shaderModuleMap.erase(shaderModule);
     lock.unlock();
 
@@ -5441,13 +5621,14 @@ VKAPI_ATTR void VKAPI_CALL
 DestroyPipeline(VkDevice device, VkPipeline pipeline, const VkAllocationCallbacks *pAllocator) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     // TODO : Add detection for in-flight pipeline
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     auto pipe_node = getPipeline(dev_data, pipeline);
     if (pipe_node) {
         // Any bound cmd buffers are now invalid
         invalidateCommandBuffers(pipe_node->cb_bindings,
                                  {reinterpret_cast<uint64_t &>(pipeline), VK_DEBUG_REPORT_OBJECT_TYPE_PIPELINE_EXT});
         dev_data->pipelineMap.erase(pipeline);
+        dev_data->resource_generation++;
     }
     lock.unlock();
     dev_data->device_dispatch_table->DestroyPipeline(device, pipeline, pAllocator);
@@ -5456,7 +5637,7 @@ DestroyPipeline(VkDevice device, VkPipeline pipeline, const VkAllocationCallback
 VKAPI_ATTR void VKAPI_CALL
 DestroyPipelineLayout(VkDevice device, VkPipelineLayout pipelineLayout, const VkAllocationCallbacks *pAllocator) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     dev_data->pipelineLayoutMap.erase(pipelineLayout);
     lock.unlock();
 
@@ -5523,7 +5704,7 @@ VKAPI_ATTR void VKAPI_CALL
 FreeCommandBuffers(VkDevice device, VkCommandPool commandPool, uint32_t commandBufferCount, const VkCommandBuffer *pCommandBuffers) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skip_call = false;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
 
     for (uint32_t i = 0; i < commandBufferCount; i++) {
         auto cb_node = getCBNode(dev_data, pCommandBuffers[i]);
@@ -5565,7 +5746,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateCommandPool(VkDevice device, const VkComman
     VkResult result = dev_data->device_dispatch_table->CreateCommandPool(device, pCreateInfo, pAllocator, pCommandPool);
 
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<sharded_mutex> lock(global_lock);
         dev_data->commandPoolMap[*pCommandPool].createFlags = pCreateInfo->flags;
         dev_data->commandPoolMap[*pCommandPool].queueFamilyIndex = pCreateInfo->queueFamilyIndex;
     }
@@ -5578,7 +5759,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateQueryPool(VkDevice device, const VkQueryPoo
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->CreateQueryPool(device, pCreateInfo, pAllocator, pQueryPool);
     if (result == VK_SUCCESS) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<sharded_mutex> lock(global_lock);
         dev_data->queryPoolMap[*pQueryPool].createInfo = *pCreateInfo;
     }
     return result;
@@ -5589,7 +5770,7 @@ VKAPI_ATTR void VKAPI_CALL
 DestroyCommandPool(VkDevice device, VkCommandPool commandPool, const VkAllocationCallbacks *pAllocator) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skip_call = false;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     // Verify that command buffers in pool are complete (not in-flight)
     auto pPool = getCommandPoolNode(dev_data, commandPool);
     skip_call |= checkCommandBuffersInFlight(dev_data, pPool, "destroy command pool with");
@@ -5618,7 +5799,7 @@ ResetCommandPool(VkDevice device, VkCommandPool commandPool, VkCommandPoolResetF
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skip_call = false;
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     auto pPool = getCommandPoolNode(dev_data, commandPool);
     skip_call |= checkCommandBuffersInFlight(dev_data, pPool, "reset command pool with");
     lock.unlock();
@@ -5643,7 +5824,7 @@ ResetCommandPool(VkDevice device, VkCommandPool commandPool, VkCommandPoolResetF
 VKAPI_ATTR VkResult VKAPI_CALL ResetFences(VkDevice device, uint32_t fenceCount, const VkFence *pFences) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skip_call = false;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     for (uint32_t i = 0; i < fenceCount; ++i) {
         auto pFence = getFenceNode(dev_data, pFences[i]);
         if (pFence && pFence->state == FENCE_INFLIGHT) {
@@ -5688,7 +5869,7 @@ void invalidateCommandBuffers(std::unordered_set<GLOBAL_CB_NODE *> cb_nodes, VK_
 VKAPI_ATTR void VKAPI_CALL
 DestroyFramebuffer(VkDevice device, VkFramebuffer framebuffer, const VkAllocationCallbacks *pAllocator) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     auto fb_node = getFramebuffer(dev_data, framebuffer);
     if (fb_node) {
         invalidateCommandBuffers(fb_node->cb_bindings,
@@ -5702,7 +5883,7 @@ DestroyFramebuffer(VkDevice device, VkFramebuffer framebuffer, const VkAllocatio
 VKAPI_ATTR void VKAPI_CALL
 DestroyRenderPass(VkDevice device, VkRenderPass renderPass, const VkAllocationCallbacks *pAllocator) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     dev_data->renderPassMap.erase(renderPass);
     // TODO: leaking all the guts of the renderpass node here!
     lock.unlock();
@@ -5716,7 +5897,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateBuffer(VkDevice device, const VkBufferCreat
     VkResult result = dev_data->device_dispatch_table->CreateBuffer(device, pCreateInfo, pAllocator, pBuffer);
 
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<sharded_mutex> lock(global_lock);
         // TODO : This doesn't create deep copy of pQueueFamilyIndices so need to fix that if/when we want that data to be valid
         dev_data->bufferMap.insert(std::make_pair(*pBuffer, unique_ptr<BUFFER_NODE>(new BUFFER_NODE(*pBuffer, pCreateInfo))));
     }
@@ -5741,7 +5922,7 @@ static bool PreCallValidateCreateBufferView(layer_data *dev_data, const VkBuffer
 VKAPI_ATTR VkResult VKAPI_CALL CreateBufferView(VkDevice device, const VkBufferViewCreateInfo *pCreateInfo,
                                                 const VkAllocationCallbacks *pAllocator, VkBufferView *pView) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     bool skip_call = PreCallValidateCreateBufferView(dev_data, pCreateInfo);
     lock.unlock();
     if (skip_call)
@@ -5762,14 +5943,10 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateImage(VkDevice device, const VkImageCreateI
     VkResult result = dev_data->device_dispatch_table->CreateImage(device, pCreateInfo, pAllocator, pImage);
 
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
-        IMAGE_LAYOUT_NODE image_node;
-        image_node.layout = pCreateInfo->initialLayout;
-        image_node.format = pCreateInfo->format;
+        std::lock_guard<sharded_mutex> lock(global_lock);
         dev_data->imageMap.insert(std::make_pair(*pImage, unique_ptr<IMAGE_NODE>(new IMAGE_NODE(*pImage, pCreateInfo))));
-        ImageSubresourcePair subpair = {*pImage, false, VkImageSubresource()};
-        dev_data->imageSubresourceMap[*pImage].push_back(subpair);
-        dev_data->imageLayoutMap[subpair] = image_node;
+        // Every subresource starts out in the initial layout
+        dev_data->imageLayoutMap[*pImage].set(0, ~uint64_t(0), pCreateInfo->initialLayout);
     }
     return result;
 }
@@ -5793,25 +5970,6 @@ static void ResolveRemainingLevelsLayers(layer_data *dev_data, VkImageSubresourc
     }
 }
 
-// Return the correct layer/level counts if the caller used the special
-// values VK_REMAINING_MIP_LEVELS or VK_REMAINING_ARRAY_LAYERS.
-static void ResolveRemainingLevelsLayers(layer_data *dev_data, uint32_t *levels, uint32_t *layers, VkImageSubresourceRange range,
-                                         VkImage image) {
-    /* expects global_lock to be held by caller */
-
-    *levels = range.levelCount;
-    *layers = range.layerCount;
-    auto image_node = getImageNode(dev_data, image);
-    if (image_node) {
-        if (range.levelCount == VK_REMAINING_MIP_LEVELS) {
-            *levels = image_node->createInfo.mipLevels - range.baseMipLevel;
-        }
-        if (range.layerCount == VK_REMAINING_ARRAY_LAYERS) {
-            *layers = image_node->createInfo.arrayLayers - range.baseArrayLayer;
-        }
-    }
-}
-
 static bool PreCallValidateCreateImageView(layer_data *dev_data, const VkImageViewCreateInfo *pCreateInfo) {
     bool skip_call = false;
     IMAGE_NODE *image_node = getImageNode(dev_data, pCreateInfo->image);
@@ -5834,7 +5992,7 @@ static inline void PostCallRecordCreateImageView(layer_data *dev_data, const VkI
 VKAPI_ATTR VkResult VKAPI_CALL CreateImageView(VkDevice device, const VkImageViewCreateInfo *pCreateInfo,
                                                const VkAllocationCallbacks *pAllocator, VkImageView *pView) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     bool skip_call = PreCallValidateCreateImageView(dev_data, pCreateInfo);
     lock.unlock();
     if (skip_call)
@@ -5854,7 +6012,7 @@ CreateFence(VkDevice device, const VkFenceCreateInfo *pCreateInfo, const VkAlloc
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->CreateFence(device, pCreateInfo, pAllocator, pFence);
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<sharded_mutex> lock(global_lock);
         auto &fence_node = dev_data->fenceMap[*pFence];
         fence_node.fence = *pFence;
         fence_node.createInfo = *pCreateInfo;
@@ -5928,7 +6086,7 @@ CreateGraphicsPipelines(VkDevice device, VkPipelineCache pipelineCache, uint32_t
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
     uint32_t i = 0;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
 
     for (i = 0; i < count; i++) {
         pPipeNode[i] = new PIPELINE_NODE;
@@ -5971,7 +6129,7 @@ CreateComputePipelines(VkDevice device, VkPipelineCache pipelineCache, uint32_t
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
     uint32_t i = 0;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     for (i = 0; i < count; i++) {
         // TODO: Verify compute stage bits
 
@@ -6013,7 +6171,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateSampler(VkDevice device, const VkSamplerCre
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->CreateSampler(device, pCreateInfo, pAllocator, pSampler);
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<sharded_mutex> lock(global_lock);
         dev_data->samplerMap[*pSampler] = unique_ptr<SAMPLER_NODE>(new SAMPLER_NODE(pSampler, pCreateInfo));
     }
     return result;
@@ -6026,7 +6184,7 @@ CreateDescriptorSetLayout(VkDevice device, const VkDescriptorSetLayoutCreateInfo
     VkResult result = dev_data->device_dispatch_table->CreateDescriptorSetLayout(device, pCreateInfo, pAllocator, pSetLayout);
     if (VK_SUCCESS == result) {
         // TODOSC : Capture layout bindings set
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<sharded_mutex> lock(global_lock);
         dev_data->descriptorSetLayoutMap[*pSetLayout] =
             new cvdescriptorset::DescriptorSetLayout(dev_data->report_data, pCreateInfo, *pSetLayout);
     }
@@ -6137,7 +6295,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreatePipelineLayout(VkDevice device, const VkPip
 
     VkResult result = dev_data->device_dispatch_table->CreatePipelineLayout(device, pCreateInfo, pAllocator, pPipelineLayout);
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<sharded_mutex> lock(global_lock);
         PIPELINE_LAYOUT_NODE &plNode = dev_data->pipelineLayoutMap[*pPipelineLayout];
         plNode.layout = *pPipelineLayout;
         plNode.set_layouts.resize(pCreateInfo->setLayoutCount);
@@ -6170,7 +6328,11 @@ CreateDescriptorPool(VkDevice device, const VkDescriptorPoolCreateInfo *pCreateI
                         "Out of memory while attempting to allocate DESCRIPTOR_POOL_NODE in vkCreateDescriptorPool()"))
                 return VK_ERROR_VALIDATION_FAILED_EXT;
         } else {
-            std::lock_guard<std::mutex> lock(global_lock);
+            uint32_t descriptor_count = 0;
+            for (auto count : pNewNode->maxDescriptorTypeCount)
+                descriptor_count += count;
+            pNewNode->descriptor_arena = new cvdescriptorset::DescriptorArena(descriptor_count);
+            std::lock_guard<sharded_mutex> lock(global_lock);
             dev_data->descriptorPoolMap[*pDescriptorPool] = pNewNode;
         }
     } else {
@@ -6184,7 +6346,7 @@ ResetDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool, VkDescript
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->ResetDescriptorPool(device, descriptorPool, flags);
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<sharded_mutex> lock(global_lock);
         clearDescriptorPool(dev_data, device, descriptorPool, flags);
     }
     return result;
@@ -6209,7 +6371,7 @@ static void PostCallRecordAllocateDescriptorSets(layer_data *dev_data, const VkD
 VKAPI_ATTR VkResult VKAPI_CALL
 AllocateDescriptorSets(VkDevice device, const VkDescriptorSetAllocateInfo *pAllocateInfo, VkDescriptorSet *pDescriptorSets) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     cvdescriptorset::AllocateDescriptorSetsData common_data(pAllocateInfo->descriptorSetCount);
     bool skip_call = PreCallValidateAllocateDescriptorSets(dev_data, pAllocateInfo, &common_data);
     lock.unlock();
@@ -6269,7 +6431,7 @@ VKAPI_ATTR VkResult VKAPI_CALL
 FreeDescriptorSets(VkDevice device, VkDescriptorPool descriptorPool, uint32_t count, const VkDescriptorSet *pDescriptorSets) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     // Make sure that no sets being destroyed are in-flight
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     bool skip_call = PreCallValidateFreeDescriptorSets(dev_data, descriptorPool, count, pDescriptorSets);
     lock.unlock();
 
@@ -6313,7 +6475,7 @@ UpdateDescriptorSets(VkDevice device, uint32_t descriptorWriteCount, const VkWri
                      uint32_t descriptorCopyCount, const VkCopyDescriptorSet *pDescriptorCopies) {
     // Only map look-up at top level is for device-level layer_data
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     bool skip_call = PreCallValidateUpdateDescriptorSets(dev_data, descriptorWriteCount, pDescriptorWrites, descriptorCopyCount,
                                                          pDescriptorCopies);
     lock.unlock();
@@ -6332,7 +6494,7 @@ AllocateCommandBuffers(VkDevice device, const VkCommandBufferAllocateInfo *pCrea
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->AllocateCommandBuffers(device, pCreateInfo, pCommandBuffer);
     if (VK_SUCCESS == result) {
-        std::unique_lock<std::mutex> lock(global_lock);
+        std::unique_lock<sharded_mutex> lock(global_lock);
         auto pPool = getCommandPoolNode(dev_data, pCreateInfo->commandPool);
 
         if (pPool) {
@@ -6357,7 +6519,7 @@ VKAPI_ATTR VkResult VKAPI_CALL
 BeginCommandBuffer(VkCommandBuffer commandBuffer, const VkCommandBufferBeginInfo *pBeginInfo) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     // Validate command buffer level
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
@@ -6500,7 +6662,7 @@ VKAPI_ATTR VkResult VKAPI_CALL EndCommandBuffer(VkCommandBuffer commandBuffer) {
     bool skip_call = false;
     VkResult result = VK_SUCCESS;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         if ((VK_COMMAND_BUFFER_LEVEL_PRIMARY == pCB->createInfo.level) || !(pCB->beginInfo.flags & VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT)) {
@@ -6537,7 +6699,7 @@ VKAPI_ATTR VkResult VKAPI_CALL
 ResetCommandBuffer(VkCommandBuffer commandBuffer, VkCommandBufferResetFlags flags) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     VkCommandPool cmdPool = pCB->createInfo.commandPool;
     auto pPool = getCommandPoolNode(dev_data, cmdPool);
@@ -6562,91 +6724,158 @@ ResetCommandBuffer(VkCommandBuffer commandBuffer, VkCommandBufferResetFlags flag
     return result;
 }
 
+// Appends a command to the command buffer's log of deferred commands. Caller holds a cb_record_lock on the command buffer.
+static DEFERRED_CMD &deferCmd(layer_data *dev_data, GLOBAL_CB_NODE *pCB, CMD_TYPE type) {
+    DEFERRED_CMD_LOG &log = pCB->deferred_log;
+    if (!log.queued) {
+        std::lock_guard<std::mutex> lock(deferred_lock);
+        deferred_cbs.emplace_back(dev_data, pCB);
+        log.queued = true;
+    }
+    log.cmds.push_back(DEFERRED_CMD());
+    log.cmds.back().type = type;
+    return log.cmds.back();
+}
+
+static bool validateAndRecordCmdBindPipeline(layer_data *dev_data, GLOBAL_CB_NODE *pCB, VkPipelineBindPoint pipelineBindPoint,
+                                             VkPipeline pipeline) {
+    bool skip_call = false;
+    skip_call |= addCmd(dev_data, pCB, CMD_BINDPIPELINE, "vkCmdBindPipeline()");
+    if ((VK_PIPELINE_BIND_POINT_COMPUTE == pipelineBindPoint) && (pCB->activeRenderPass)) {
+        skip_call |=
+            log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_PIPELINE_EXT,
+                    (uint64_t)pipeline, __LINE__, DRAWSTATE_INVALID_RENDERPASS_CMD, "DS",
+                    "Incorrectly binding compute pipeline (0x%" PRIxLEAST64 ") during active RenderPass (0x%" PRIxLEAST64 ")",
+                    (uint64_t)pipeline, (uint64_t)pCB->activeRenderPass->renderPass);
+    }
+
+    PIPELINE_NODE *pPN = getPipeline(dev_data, pipeline);
+    if (pPN) {
+        pCB->lastBound[pipelineBindPoint].pipeline = pipeline;
+        set_cb_pso_status(pCB, pPN);
+        std::lock_guard<std::mutex> bind_lock(binding_lock);
+        set_pipeline_state(pPN);
+    } else {
+        skip_call |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_PIPELINE_EXT,
+                             (uint64_t)pipeline, __LINE__, DRAWSTATE_INVALID_PIPELINE, "DS",
+                             "Attempt to bind Pipeline 0x%" PRIxLEAST64 " that doesn't exist!", (uint64_t)(pipeline));
+    }
+    addCommandBufferBinding(&getPipeline(dev_data, pipeline)->cb_bindings,
+                            {reinterpret_cast<uint64_t &>(pipeline), VK_DEBUG_REPORT_OBJECT_TYPE_PIPELINE_EXT}, pCB);
+    return skip_call;
+}
+
 VKAPI_ATTR void VKAPI_CALL
 CmdBindPipeline(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipeline pipeline) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    cb_record_lock lock(dev_data, commandBuffer, true);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
-        skip_call |= addCmd(dev_data, pCB, CMD_BINDPIPELINE, "vkCmdBindPipeline()");
-        if ((VK_PIPELINE_BIND_POINT_COMPUTE == pipelineBindPoint) && (pCB->activeRenderPass)) {
-            skip_call |=
-                log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_PIPELINE_EXT,
-                        (uint64_t)pipeline, __LINE__, DRAWSTATE_INVALID_RENDERPASS_CMD, "DS",
-                        "Incorrectly binding compute pipeline (0x%" PRIxLEAST64 ") during active RenderPass (0x%" PRIxLEAST64 ")",
-                        (uint64_t)pipeline, (uint64_t)pCB->activeRenderPass->renderPass);
-        }
-
-        PIPELINE_NODE *pPN = getPipeline(dev_data, pipeline);
-        if (pPN) {
-            pCB->lastBound[pipelineBindPoint].pipeline = pipeline;
-            set_cb_pso_status(pCB, pPN);
-            set_pipeline_state(pPN);
+        if (deferred_validation) {
+            DEFERRED_CMD &cmd = deferCmd(dev_data, pCB, CMD_BINDPIPELINE);
+            cmd.bind_point = pipelineBindPoint;
+            cmd.handle = reinterpret_cast<uint64_t &>(pipeline);
         } else {
-            skip_call |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_PIPELINE_EXT,
-                                 (uint64_t)pipeline, __LINE__, DRAWSTATE_INVALID_PIPELINE, "DS",
-                                 "Attempt to bind Pipeline 0x%" PRIxLEAST64 " that doesn't exist!", (uint64_t)(pipeline));
+            skip_call |= validateAndRecordCmdBindPipeline(dev_data, pCB, pipelineBindPoint, pipeline);
         }
-        addCommandBufferBinding(&getPipeline(dev_data, pipeline)->cb_bindings,
-                                {reinterpret_cast<uint64_t &>(pipeline), VK_DEBUG_REPORT_OBJECT_TYPE_PIPELINE_EXT}, pCB);
     }
     lock.unlock();
     if (!skip_call)
         dev_data->device_dispatch_table->CmdBindPipeline(commandBuffer, pipelineBindPoint, pipeline);
 }
 
+static bool validateAndRecordCmdSetViewport(layer_data *dev_data, GLOBAL_CB_NODE *pCB, uint32_t viewportCount,
+                                            const VkViewport *pViewports) {
+    bool skip_call = false;
+    skip_call |= addCmd(dev_data, pCB, CMD_SETVIEWPORTSTATE, "vkCmdSetViewport()");
+    pCB->status |= CBSTATUS_VIEWPORT_SET;
+    pCB->viewports.resize(viewportCount);
+    memcpy(pCB->viewports.data(), pViewports, viewportCount * sizeof(VkViewport));
+    return skip_call;
+}
+
 VKAPI_ATTR void VKAPI_CALL
 CmdSetViewport(VkCommandBuffer commandBuffer, uint32_t firstViewport, uint32_t viewportCount, const VkViewport *pViewports) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    cb_record_lock lock(dev_data, commandBuffer, true);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
-        skip_call |= addCmd(dev_data, pCB, CMD_SETVIEWPORTSTATE, "vkCmdSetViewport()");
-        pCB->status |= CBSTATUS_VIEWPORT_SET;
-        pCB->viewports.resize(viewportCount);
-        memcpy(pCB->viewports.data(), pViewports, viewportCount * sizeof(VkViewport));
+        if (deferred_validation) {
+            DEFERRED_CMD &cmd = deferCmd(dev_data, pCB, CMD_SETVIEWPORTSTATE);
+            cmd.count = viewportCount;
+            cmd.first_data = static_cast<uint32_t>(pCB->deferred_log.viewports.size());
+            pCB->deferred_log.viewports.insert(pCB->deferred_log.viewports.end(), pViewports, pViewports + viewportCount);
+        } else {
+            skip_call |= validateAndRecordCmdSetViewport(dev_data, pCB, viewportCount, pViewports);
+        }
     }
     lock.unlock();
     if (!skip_call)
         dev_data->device_dispatch_table->CmdSetViewport(commandBuffer, firstViewport, viewportCount, pViewports);
 }
 
+static bool validateAndRecordCmdSetScissor(layer_data *dev_data, GLOBAL_CB_NODE *pCB, uint32_t scissorCount,
+                                           const VkRect2D *pScissors) {
+    bool skip_call = false;
+    skip_call |= addCmd(dev_data, pCB, CMD_SETSCISSORSTATE, "vkCmdSetScissor()");
+    pCB->status |= CBSTATUS_SCISSOR_SET;
+    pCB->scissors.resize(scissorCount);
+    memcpy(pCB->scissors.data(), pScissors, scissorCount * sizeof(VkRect2D));
+    return skip_call;
+}
+
 VKAPI_ATTR void VKAPI_CALL
 CmdSetScissor(VkCommandBuffer commandBuffer, uint32_t firstScissor, uint32_t scissorCount, const VkRect2D *pScissors) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    cb_record_lock lock(dev_data, commandBuffer, true);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
-        skip_call |= addCmd(dev_data, pCB, CMD_SETSCISSORSTATE, "vkCmdSetScissor()");
-        pCB->status |= CBSTATUS_SCISSOR_SET;
-        pCB->scissors.resize(scissorCount);
-        memcpy(pCB->scissors.data(), pScissors, scissorCount * sizeof(VkRect2D));
+        if (deferred_validation) {
+            DEFERRED_CMD &cmd = deferCmd(dev_data, pCB, CMD_SETSCISSORSTATE);
+            cmd.count = scissorCount;
+            cmd.first_data = static_cast<uint32_t>(pCB->deferred_log.scissors.size());
+            pCB->deferred_log.scissors.insert(pCB->deferred_log.scissors.end(), pScissors, pScissors + scissorCount);
+        } else {
+            skip_call |= validateAndRecordCmdSetScissor(dev_data, pCB, scissorCount, pScissors);
+        }
     }
     lock.unlock();
     if (!skip_call)
         dev_data->device_dispatch_table->CmdSetScissor(commandBuffer, firstScissor, scissorCount, pScissors);
 }
 
+static bool validateAndRecordCmdSetLineWidth(layer_data *dev_data, GLOBAL_CB_NODE *pCB, float lineWidth) {
+    bool skip_call = false;
+    skip_call |= addCmd(dev_data, pCB, CMD_SETLINEWIDTHSTATE, "vkCmdSetLineWidth()");
+    pCB->status |= CBSTATUS_LINE_WIDTH_SET;
+
+    PIPELINE_NODE *pPipeTrav = getPipeline(dev_data, pCB->lastBound[VK_PIPELINE_BIND_POINT_GRAPHICS].pipeline);
+    if (pPipeTrav != NULL && !isDynamic(pPipeTrav, VK_DYNAMIC_STATE_LINE_WIDTH)) {
+        skip_call |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_WARNING_BIT_EXT, (VkDebugReportObjectTypeEXT)0,
+                             reinterpret_cast<uint64_t &>(pCB->commandBuffer), __LINE__, DRAWSTATE_INVALID_SET, "DS",
+                             "vkCmdSetLineWidth called but pipeline was created without VK_DYNAMIC_STATE_LINE_WIDTH "
+                             "flag.  This is undefined behavior and could be ignored.");
+    } else {
+        skip_call |=
+            verifyLineWidth(dev_data, DRAWSTATE_INVALID_SET, reinterpret_cast<uint64_t &>(pCB->commandBuffer), lineWidth);
+    }
+    return skip_call;
+}
+
 VKAPI_ATTR void VKAPI_CALL CmdSetLineWidth(VkCommandBuffer commandBuffer, float lineWidth) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    cb_record_lock lock(dev_data, commandBuffer, true);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
-        skip_call |= addCmd(dev_data, pCB, CMD_SETLINEWIDTHSTATE, "vkCmdSetLineWidth()");
-        pCB->status |= CBSTATUS_LINE_WIDTH_SET;
-
-        PIPELINE_NODE *pPipeTrav = getPipeline(dev_data, pCB->lastBound[VK_PIPELINE_BIND_POINT_GRAPHICS].pipeline);
-        if (pPipeTrav != NULL && !isDynamic(pPipeTrav, VK_DYNAMIC_STATE_LINE_WIDTH)) {
-            skip_call |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_WARNING_BIT_EXT, (VkDebugReportObjectTypeEXT)0,
-                                 reinterpret_cast<uint64_t &>(commandBuffer), __LINE__, DRAWSTATE_INVALID_SET, "DS",
-                                 "vkCmdSetLineWidth called but pipeline was created without VK_DYNAMIC_STATE_LINE_WIDTH "
-                                 "flag.  This is undefined behavior and could be ignored.");
+        if (deferred_validation) {
+            DEFERRED_CMD &cmd = deferCmd(dev_data, pCB, CMD_SETLINEWIDTHSTATE);
+            cmd.line_width = lineWidth;
         } else {
-            skip_call |= verifyLineWidth(dev_data, DRAWSTATE_INVALID_SET, reinterpret_cast<uint64_t &>(commandBuffer), lineWidth);
+            skip_call |= validateAndRecordCmdSetLineWidth(dev_data, pCB, lineWidth);
         }
     }
     lock.unlock();
@@ -6654,15 +6883,25 @@ VKAPI_ATTR void VKAPI_CALL CmdSetLineWidth(VkCommandBuffer commandBuffer, float
         dev_data->device_dispatch_table->CmdSetLineWidth(commandBuffer, lineWidth);
 }
 
+static bool validateAndRecordCmdSetDepthBias(layer_data *dev_data, GLOBAL_CB_NODE *pCB) {
+    bool skip_call = false;
+    skip_call |= addCmd(dev_data, pCB, CMD_SETDEPTHBIASSTATE, "vkCmdSetDepthBias()");
+    pCB->status |= CBSTATUS_DEPTH_BIAS_SET;
+    return skip_call;
+}
+
 VKAPI_ATTR void VKAPI_CALL
 CmdSetDepthBias(VkCommandBuffer commandBuffer, float depthBiasConstantFactor, float depthBiasClamp, float depthBiasSlopeFactor) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    cb_record_lock lock(dev_data, commandBuffer, true);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
-        skip_call |= addCmd(dev_data, pCB, CMD_SETDEPTHBIASSTATE, "vkCmdSetDepthBias()");
-        pCB->status |= CBSTATUS_DEPTH_BIAS_SET;
+        if (deferred_validation) {
+            deferCmd(dev_data, pCB, CMD_SETDEPTHBIASSTATE);
+        } else {
+            skip_call |= validateAndRecordCmdSetDepthBias(dev_data, pCB);
+        }
     }
     lock.unlock();
     if (!skip_call)
@@ -6670,242 +6909,320 @@ CmdSetDepthBias(VkCommandBuffer commandBuffer, float depthBiasConstantFactor, fl
                                                          depthBiasSlopeFactor);
 }
 
+static bool validateAndRecordCmdSetBlendConstants(layer_data *dev_data, GLOBAL_CB_NODE *pCB) {
+    bool skip_call = false;
+    skip_call |= addCmd(dev_data, pCB, CMD_SETBLENDSTATE, "vkCmdSetBlendConstants()");
+    pCB->status |= CBSTATUS_BLEND_CONSTANTS_SET;
+    return skip_call;
+}
+
 VKAPI_ATTR void VKAPI_CALL CmdSetBlendConstants(VkCommandBuffer commandBuffer, const float blendConstants[4]) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    cb_record_lock lock(dev_data, commandBuffer, true);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
-        skip_call |= addCmd(dev_data, pCB, CMD_SETBLENDSTATE, "vkCmdSetBlendConstants()");
-        pCB->status |= CBSTATUS_BLEND_CONSTANTS_SET;
+        if (deferred_validation) {
+            deferCmd(dev_data, pCB, CMD_SETBLENDSTATE);
+        } else {
+            skip_call |= validateAndRecordCmdSetBlendConstants(dev_data, pCB);
+        }
     }
     lock.unlock();
     if (!skip_call)
         dev_data->device_dispatch_table->CmdSetBlendConstants(commandBuffer, blendConstants);
 }
 
+static bool validateAndRecordCmdSetDepthBounds(layer_data *dev_data, GLOBAL_CB_NODE *pCB) {
+    bool skip_call = false;
+    skip_call |= addCmd(dev_data, pCB, CMD_SETDEPTHBOUNDSSTATE, "vkCmdSetDepthBounds()");
+    pCB->status |= CBSTATUS_DEPTH_BOUNDS_SET;
+    return skip_call;
+}
+
 VKAPI_ATTR void VKAPI_CALL
 CmdSetDepthBounds(VkCommandBuffer commandBuffer, float minDepthBounds, float maxDepthBounds) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    cb_record_lock lock(dev_data, commandBuffer, true);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
-        skip_call |= addCmd(dev_data, pCB, CMD_SETDEPTHBOUNDSSTATE, "vkCmdSetDepthBounds()");
-        pCB->status |= CBSTATUS_DEPTH_BOUNDS_SET;
+        if (deferred_validation) {
+            deferCmd(dev_data, pCB, CMD_SETDEPTHBOUNDSSTATE);
+        } else {
+            skip_call |= validateAndRecordCmdSetDepthBounds(dev_data, pCB);
+        }
     }
     lock.unlock();
     if (!skip_call)
         dev_data->device_dispatch_table->CmdSetDepthBounds(commandBuffer, minDepthBounds, maxDepthBounds);
 }
 
+static bool validateAndRecordCmdSetStencilCompareMask(layer_data *dev_data, GLOBAL_CB_NODE *pCB) {
+    bool skip_call = false;
+    skip_call |= addCmd(dev_data, pCB, CMD_SETSTENCILREADMASKSTATE, "vkCmdSetStencilCompareMask()");
+    pCB->status |= CBSTATUS_STENCIL_READ_MASK_SET;
+    return skip_call;
+}
+
 VKAPI_ATTR void VKAPI_CALL
 CmdSetStencilCompareMask(VkCommandBuffer commandBuffer, VkStencilFaceFlags faceMask, uint32_t compareMask) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    cb_record_lock lock(dev_data, commandBuffer, true);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
-        skip_call |= addCmd(dev_data, pCB, CMD_SETSTENCILREADMASKSTATE, "vkCmdSetStencilCompareMask()");
-        pCB->status |= CBSTATUS_STENCIL_READ_MASK_SET;
+        if (deferred_validation) {
+            deferCmd(dev_data, pCB, CMD_SETSTENCILREADMASKSTATE);
+        } else {
+            skip_call |= validateAndRecordCmdSetStencilCompareMask(dev_data, pCB);
+        }
     }
     lock.unlock();
     if (!skip_call)
         dev_data->device_dispatch_table->CmdSetStencilCompareMask(commandBuffer, faceMask, compareMask);
 }
 
+static bool validateAndRecordCmdSetStencilWriteMask(layer_data *dev_data, GLOBAL_CB_NODE *pCB) {
+    bool skip_call = false;
+    skip_call |= addCmd(dev_data, pCB, CMD_SETSTENCILWRITEMASKSTATE, "vkCmdSetStencilWriteMask()");
+    pCB->status |= CBSTATUS_STENCIL_WRITE_MASK_SET;
+    return skip_call;
+}
+
 VKAPI_ATTR void VKAPI_CALL
 CmdSetStencilWriteMask(VkCommandBuffer commandBuffer, VkStencilFaceFlags faceMask, uint32_t writeMask) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    cb_record_lock lock(dev_data, commandBuffer, true);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
-        skip_call |= addCmd(dev_data, pCB, CMD_SETSTENCILWRITEMASKSTATE, "vkCmdSetStencilWriteMask()");
-        pCB->status |= CBSTATUS_STENCIL_WRITE_MASK_SET;
+        if (deferred_validation) {
+            deferCmd(dev_data, pCB, CMD_SETSTENCILWRITEMASKSTATE);
+        } else {
+            skip_call |= validateAndRecordCmdSetStencilWriteMask(dev_data, pCB);
+        }
     }
     lock.unlock();
     if (!skip_call)
         dev_data->device_dispatch_table->CmdSetStencilWriteMask(commandBuffer, faceMask, writeMask);
 }
 
+static bool validateAndRecordCmdSetStencilReference(layer_data *dev_data, GLOBAL_CB_NODE *pCB) {
+    bool skip_call = false;
+    skip_call |= addCmd(dev_data, pCB, CMD_SETSTENCILREFERENCESTATE, "vkCmdSetStencilReference()");
+    pCB->status |= CBSTATUS_STENCIL_REFERENCE_SET;
+    return skip_call;
+}
+
 VKAPI_ATTR void VKAPI_CALL
 CmdSetStencilReference(VkCommandBuffer commandBuffer, VkStencilFaceFlags faceMask, uint32_t reference) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    cb_record_lock lock(dev_data, commandBuffer, true);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
-        skip_call |= addCmd(dev_data, pCB, CMD_SETSTENCILREFERENCESTATE, "vkCmdSetStencilReference()");
-        pCB->status |= CBSTATUS_STENCIL_REFERENCE_SET;
+        if (deferred_validation) {
+            deferCmd(dev_data, pCB, CMD_SETSTENCILREFERENCESTATE);
+        } else {
+            skip_call |= validateAndRecordCmdSetStencilReference(dev_data, pCB);
+        }
     }
     lock.unlock();
     if (!skip_call)
         dev_data->device_dispatch_table->CmdSetStencilReference(commandBuffer, faceMask, reference);
 }
 
-VKAPI_ATTR void VKAPI_CALL
-CmdBindDescriptorSets(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout,
-                      uint32_t firstSet, uint32_t setCount, const VkDescriptorSet *pDescriptorSets, uint32_t dynamicOffsetCount,
-                      const uint32_t *pDynamicOffsets) {
-    bool skip_call = false;
-    layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
-    GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
-    if (pCB) {
-        if (pCB->state == CB_RECORDING) {
-            // Track total count of dynamic descriptor types to make sure we have an offset for each one
-            uint32_t totalDynamicDescriptors = 0;
-            string errorString = "";
-            uint32_t lastSetIndex = firstSet + setCount - 1;
-            if (lastSetIndex >= pCB->lastBound[pipelineBindPoint].boundDescriptorSets.size()) {
-                pCB->lastBound[pipelineBindPoint].boundDescriptorSets.resize(lastSetIndex + 1);
-                pCB->lastBound[pipelineBindPoint].dynamicOffsets.resize(lastSetIndex + 1);
-            }
-            auto oldFinalBoundSet = pCB->lastBound[pipelineBindPoint].boundDescriptorSets[lastSetIndex];
-            auto pipeline_layout = getPipelineLayout(dev_data, layout);
-            for (uint32_t i = 0; i < setCount; i++) {
-                cvdescriptorset::DescriptorSet *pSet = getSetNode(dev_data, pDescriptorSets[i]);
-                if (pSet) {
-                    pCB->lastBound[pipelineBindPoint].uniqueBoundSets.insert(pSet);
+static bool validateAndRecordCmdBindDescriptorSets(layer_data *dev_data, GLOBAL_CB_NODE *pCB,
+                                                   VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout,
+                                                   uint32_t firstSet, uint32_t setCount, const VkDescriptorSet *pDescriptorSets,
+                                                   uint32_t dynamicOffsetCount, const uint32_t *pDynamicOffsets) {
+    bool skip_call = false;
+    if (pCB->state == CB_RECORDING) {
+        // Track total count of dynamic descriptor types to make sure we have an offset for each one
+        uint32_t totalDynamicDescriptors = 0;
+        string errorString = "";
+        uint32_t lastSetIndex = firstSet + setCount - 1;
+        if (lastSetIndex >= pCB->lastBound[pipelineBindPoint].boundDescriptorSets.size()) {
+            pCB->lastBound[pipelineBindPoint].boundDescriptorSets.resize(lastSetIndex + 1);
+            pCB->lastBound[pipelineBindPoint].dynamicOffsets.resize(lastSetIndex + 1);
+        }
+        auto oldFinalBoundSet = pCB->lastBound[pipelineBindPoint].boundDescriptorSets[lastSetIndex];
+        auto pipeline_layout = getPipelineLayout(dev_data, layout);
+        for (uint32_t i = 0; i < setCount; i++) {
+            cvdescriptorset::DescriptorSet *pSet = getSetNode(dev_data, pDescriptorSets[i]);
+            if (pSet) {
+                pCB->lastBound[pipelineBindPoint].uniqueBoundSets.insert(pSet);
+                {
+                    std::lock_guard<std::mutex> bind_lock(binding_lock);
                     pSet->BindCommandBuffer(pCB);
-                    pCB->lastBound[pipelineBindPoint].pipeline_layout = *pipeline_layout;
-                    pCB->lastBound[pipelineBindPoint].boundDescriptorSets[i + firstSet] = pSet;
-                    skip_call |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT,
+                }
+                pCB->lastBound[pipelineBindPoint].pipeline_layout = *pipeline_layout;
+                pCB->lastBound[pipelineBindPoint].boundDescriptorSets[i + firstSet] = pSet;
+                skip_call |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT,
+                                     VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT, (uint64_t)pDescriptorSets[i], __LINE__,
+                                     DRAWSTATE_NONE, "DS", "DS 0x%" PRIxLEAST64 " bound on pipeline %s",
+                                     (uint64_t)pDescriptorSets[i], string_VkPipelineBindPoint(pipelineBindPoint));
+                if (!pSet->IsUpdated() && (pSet->GetTotalDescriptorCount() != 0)) {
+                    skip_call |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_WARNING_BIT_EXT,
                                          VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT, (uint64_t)pDescriptorSets[i], __LINE__,
-                                         DRAWSTATE_NONE, "DS", "DS 0x%" PRIxLEAST64 " bound on pipeline %s",
-                                         (uint64_t)pDescriptorSets[i], string_VkPipelineBindPoint(pipelineBindPoint));
-                    if (!pSet->IsUpdated() && (pSet->GetTotalDescriptorCount() != 0)) {
-                        skip_call |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_WARNING_BIT_EXT,
-                                             VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT, (uint64_t)pDescriptorSets[i], __LINE__,
-                                             DRAWSTATE_DESCRIPTOR_SET_NOT_UPDATED, "DS",
-                                             "DS 0x%" PRIxLEAST64
-                                             " bound but it was never updated. You may want to either update it or not bind it.",
-                                             (uint64_t)pDescriptorSets[i]);
-                    }
-                    // Verify that set being bound is compatible with overlapping setLayout of pipelineLayout
-                    if (!verify_set_layout_compatibility(dev_data, pSet, pipeline_layout, i + firstSet, errorString)) {
-                        skip_call |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
-                                             VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT, (uint64_t)pDescriptorSets[i], __LINE__,
-                                             DRAWSTATE_PIPELINE_LAYOUTS_INCOMPATIBLE, "DS",
-                                             "descriptorSet #%u being bound is not compatible with overlapping descriptorSetLayout "
-                                             "at index %u of pipelineLayout 0x%" PRIxLEAST64 " due to: %s",
-                                             i, i + firstSet, reinterpret_cast<uint64_t &>(layout), errorString.c_str());
-                    }
+                                         DRAWSTATE_DESCRIPTOR_SET_NOT_UPDATED, "DS",
+                                         "DS 0x%" PRIxLEAST64
+                                         " bound but it was never updated. You may want to either update it or not bind it.",
+                                         (uint64_t)pDescriptorSets[i]);
+                }
+                // Verify that set being bound is compatible with overlapping setLayout of pipelineLayout
+                if (!verify_set_layout_compatibility(dev_data, pSet, pipeline_layout, i + firstSet, errorString)) {
+                    skip_call |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                         VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT, (uint64_t)pDescriptorSets[i], __LINE__,
+                                         DRAWSTATE_PIPELINE_LAYOUTS_INCOMPATIBLE, "DS",
+                                         "descriptorSet #%u being bound is not compatible with overlapping descriptorSetLayout "
+                                         "at index %u of pipelineLayout 0x%" PRIxLEAST64 " due to: %s",
+                                         i, i + firstSet, reinterpret_cast<uint64_t &>(layout), errorString.c_str());
+                }
+
+                auto setDynamicDescriptorCount = pSet->GetDynamicDescriptorCount();
 
-                    auto setDynamicDescriptorCount = pSet->GetDynamicDescriptorCount();
-
-                    pCB->lastBound[pipelineBindPoint].dynamicOffsets[firstSet + i].clear();
-
-                    if (setDynamicDescriptorCount) {
-                        // First make sure we won't overstep bounds of pDynamicOffsets array
-                        if ((totalDynamicDescriptors + setDynamicDescriptorCount) > dynamicOffsetCount) {
-                            skip_call |=
-                                log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
-                                        VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT, (uint64_t)pDescriptorSets[i], __LINE__,
-                                        DRAWSTATE_INVALID_DYNAMIC_OFFSET_COUNT, "DS",
-                                        "descriptorSet #%u (0x%" PRIxLEAST64
-                                        ") requires %u dynamicOffsets, but only %u dynamicOffsets are left in pDynamicOffsets "
-                                        "array. There must be one dynamic offset for each dynamic descriptor being bound.",
-                                        i, (uint64_t)pDescriptorSets[i], pSet->GetDynamicDescriptorCount(),
-                                        (dynamicOffsetCount - totalDynamicDescriptors));
-                        } else { // Validate and store dynamic offsets with the set
-                            // Validate Dynamic Offset Minimums
-                            uint32_t cur_dyn_offset = totalDynamicDescriptors;
-                            for (uint32_t d = 0; d < pSet->GetTotalDescriptorCount(); d++) {
-                                if (pSet->GetTypeFromGlobalIndex(d) == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC) {
-                                    if (vk_safe_modulo(
-                                            pDynamicOffsets[cur_dyn_offset],
-                                            dev_data->phys_dev_properties.properties.limits.minUniformBufferOffsetAlignment) != 0) {
-                                        skip_call |= log_msg(
-                                            dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
-                                            VK_DEBUG_REPORT_OBJECT_TYPE_PHYSICAL_DEVICE_EXT, 0, __LINE__,
-                                            DRAWSTATE_INVALID_UNIFORM_BUFFER_OFFSET, "DS",
-                                            "vkCmdBindDescriptorSets(): pDynamicOffsets[%d] is %d but must be a multiple of "
-                                            "device limit minUniformBufferOffsetAlignment 0x%" PRIxLEAST64,
-                                            cur_dyn_offset, pDynamicOffsets[cur_dyn_offset],
-                                            dev_data->phys_dev_properties.properties.limits.minUniformBufferOffsetAlignment);
-                                    }
-                                    cur_dyn_offset++;
-                                } else if (pSet->GetTypeFromGlobalIndex(d) == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC) {
-                                    if (vk_safe_modulo(
-                                            pDynamicOffsets[cur_dyn_offset],
-                                            dev_data->phys_dev_properties.properties.limits.minStorageBufferOffsetAlignment) != 0) {
-                                        skip_call |= log_msg(
-                                            dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
-                                            VK_DEBUG_REPORT_OBJECT_TYPE_PHYSICAL_DEVICE_EXT, 0, __LINE__,
-                                            DRAWSTATE_INVALID_STORAGE_BUFFER_OFFSET, "DS",
-                                            "vkCmdBindDescriptorSets(): pDynamicOffsets[%d] is %d but must be a multiple of "
-                                            "device limit minStorageBufferOffsetAlignment 0x%" PRIxLEAST64,
-                                            cur_dyn_offset, pDynamicOffsets[cur_dyn_offset],
-                                            dev_data->phys_dev_properties.properties.limits.minStorageBufferOffsetAlignment);
-                                    }
-                                    cur_dyn_offset++;
+                pCB->lastBound[pipelineBindPoint].dynamicOffsets[firstSet + i].clear();
+
+                if (setDynamicDescriptorCount) {
+                    // First make sure we won't overstep bounds of pDynamicOffsets array
+                    if ((totalDynamicDescriptors + setDynamicDescriptorCount) > dynamicOffsetCount) {
+                        skip_call |=
+                            log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                    VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT, (uint64_t)pDescriptorSets[i], __LINE__,
+                                    DRAWSTATE_INVALID_DYNAMIC_OFFSET_COUNT, "DS",
+                                    "descriptorSet #%u (0x%" PRIxLEAST64
+                                    ") requires %u dynamicOffsets, but only %u dynamicOffsets are left in pDynamicOffsets "
+                                    "array. There must be one dynamic offset for each dynamic descriptor being bound.",
+                                    i, (uint64_t)pDescriptorSets[i], pSet->GetDynamicDescriptorCount(),
+                                    (dynamicOffsetCount - totalDynamicDescriptors));
+                    } else { // Validate and store dynamic offsets with the set
+                        // Validate Dynamic Offset Minimums
+                        uint32_t cur_dyn_offset = totalDynamicDescriptors;
+                        for (uint32_t d = 0; d < pSet->GetTotalDescriptorCount(); d++) {
+                            if (pSet->GetTypeFromGlobalIndex(d) == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC) {
+                                if (vk_safe_modulo(
+                                        pDynamicOffsets[cur_dyn_offset],
+                                        dev_data->phys_dev_properties.properties.limits.minUniformBufferOffsetAlignment) != 0) {
+                                    skip_call |= log_msg(
+                                        dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                        VK_DEBUG_REPORT_OBJECT_TYPE_PHYSICAL_DEVICE_EXT, 0, __LINE__,
+                                        DRAWSTATE_INVALID_UNIFORM_BUFFER_OFFSET, "DS",
+                                        "vkCmdBindDescriptorSets(): pDynamicOffsets[%d] is %d but must be a multiple of "
+                                        "device limit minUniformBufferOffsetAlignment 0x%" PRIxLEAST64,
+                                        cur_dyn_offset, pDynamicOffsets[cur_dyn_offset],
+                                        dev_data->phys_dev_properties.properties.limits.minUniformBufferOffsetAlignment);
                                 }
+                                cur_dyn_offset++;
+                            } else if (pSet->GetTypeFromGlobalIndex(d) == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC) {
+                                if (vk_safe_modulo(
+                                        pDynamicOffsets[cur_dyn_offset],
+                                        dev_data->phys_dev_properties.properties.limits.minStorageBufferOffsetAlignment) != 0) {
+                                    skip_call |= log_msg(
+                                        dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                        VK_DEBUG_REPORT_OBJECT_TYPE_PHYSICAL_DEVICE_EXT, 0, __LINE__,
+                                        DRAWSTATE_INVALID_STORAGE_BUFFER_OFFSET, "DS",
+                                        "vkCmdBindDescriptorSets(): pDynamicOffsets[%d] is %d but must be a multiple of "
+                                        "device limit minStorageBufferOffsetAlignment 0x%" PRIxLEAST64,
+                                        cur_dyn_offset, pDynamicOffsets[cur_dyn_offset],
+                                        dev_data->phys_dev_properties.properties.limits.minStorageBufferOffsetAlignment);
+                                }
+                                cur_dyn_offset++;
                             }
+                        }
 
-                            pCB->lastBound[pipelineBindPoint].dynamicOffsets[firstSet + i] =
-                                std::vector<uint32_t>(pDynamicOffsets + totalDynamicDescriptors,
-                                                      pDynamicOffsets + totalDynamicDescriptors + setDynamicDescriptorCount);
-                            // Keep running total of dynamic descriptor count to verify at the end
-                            totalDynamicDescriptors += setDynamicDescriptorCount;
+                        pCB->lastBound[pipelineBindPoint].dynamicOffsets[firstSet + i] =
+                            std::vector<uint32_t>(pDynamicOffsets + totalDynamicDescriptors,
+                                                  pDynamicOffsets + totalDynamicDescriptors + setDynamicDescriptorCount);
+                        // Keep running total of dynamic descriptor count to verify at the end
+                        totalDynamicDescriptors += setDynamicDescriptorCount;
 
-                        }
-                    }
-                } else {
-                    skip_call |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
-                                         VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT, (uint64_t)pDescriptorSets[i], __LINE__,
-                                         DRAWSTATE_INVALID_SET, "DS", "Attempt to bind DS 0x%" PRIxLEAST64 " that doesn't exist!",
-                                         (uint64_t)pDescriptorSets[i]);
-                }
-                skip_call |= addCmd(dev_data, pCB, CMD_BINDDESCRIPTORSETS, "vkCmdBindDescriptorSets()");
-                // For any previously bound sets, need to set them to "invalid" if they were disturbed by this update
-                if (firstSet > 0) { // Check set #s below the first bound set
-                    for (uint32_t i = 0; i < firstSet; ++i) {
-                        if (pCB->lastBound[pipelineBindPoint].boundDescriptorSets[i] &&
-                            !verify_set_layout_compatibility(dev_data, pCB->lastBound[pipelineBindPoint].boundDescriptorSets[i],
-                                                             pipeline_layout, i, errorString)) {
-                            skip_call |= log_msg(
-                                dev_data->report_data, VK_DEBUG_REPORT_PERFORMANCE_WARNING_BIT_EXT,
-                                VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT,
-                                (uint64_t)pCB->lastBound[pipelineBindPoint].boundDescriptorSets[i], __LINE__, DRAWSTATE_NONE, "DS",
-                                "DescriptorSetDS 0x%" PRIxLEAST64
-                                " previously bound as set #%u was disturbed by newly bound pipelineLayout (0x%" PRIxLEAST64 ")",
-                                (uint64_t)pCB->lastBound[pipelineBindPoint].boundDescriptorSets[i], i, (uint64_t)layout);
-                            pCB->lastBound[pipelineBindPoint].boundDescriptorSets[i] = VK_NULL_HANDLE;
-                        }
                     }
                 }
-                // Check if newly last bound set invalidates any remaining bound sets
-                if ((pCB->lastBound[pipelineBindPoint].boundDescriptorSets.size() - 1) > (lastSetIndex)) {
-                    if (oldFinalBoundSet &&
-                        !verify_set_layout_compatibility(dev_data, oldFinalBoundSet, pipeline_layout, lastSetIndex, errorString)) {
-                        auto old_set = oldFinalBoundSet->GetSet();
-                        skip_call |=
-                            log_msg(dev_data->report_data, VK_DEBUG_REPORT_PERFORMANCE_WARNING_BIT_EXT,
-                                    VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT, reinterpret_cast<uint64_t &>(old_set), __LINE__,
-                                    DRAWSTATE_NONE, "DS", "DescriptorSetDS 0x%" PRIxLEAST64
-                                                          " previously bound as set #%u is incompatible with set 0x%" PRIxLEAST64
-                                                          " newly bound as set #%u so set #%u and any subsequent sets were "
-                                                          "disturbed by newly bound pipelineLayout (0x%" PRIxLEAST64 ")",
-                                    reinterpret_cast<uint64_t &>(old_set), lastSetIndex,
-                                    (uint64_t)pCB->lastBound[pipelineBindPoint].boundDescriptorSets[lastSetIndex], lastSetIndex,
-                                    lastSetIndex + 1, (uint64_t)layout);
-                        pCB->lastBound[pipelineBindPoint].boundDescriptorSets.resize(lastSetIndex + 1);
+            } else {
+                skip_call |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                     VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT, (uint64_t)pDescriptorSets[i], __LINE__,
+                                     DRAWSTATE_INVALID_SET, "DS", "Attempt to bind DS 0x%" PRIxLEAST64 " that doesn't exist!",
+                                     (uint64_t)pDescriptorSets[i]);
+            }
+            skip_call |= addCmd(dev_data, pCB, CMD_BINDDESCRIPTORSETS, "vkCmdBindDescriptorSets()");
+            // For any previously bound sets, need to set them to "invalid" if they were disturbed by this update
+            if (firstSet > 0) { // Check set #s below the first bound set
+                for (uint32_t i = 0; i < firstSet; ++i) {
+                    if (pCB->lastBound[pipelineBindPoint].boundDescriptorSets[i] &&
+                        !verify_set_layout_compatibility(dev_data, pCB->lastBound[pipelineBindPoint].boundDescriptorSets[i],
+                                                         pipeline_layout, i, errorString)) {
+                        skip_call |= log_msg(
+                            dev_data->report_data, VK_DEBUG_REPORT_PERFORMANCE_WARNING_BIT_EXT,
+                            VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT,
+                            (uint64_t)pCB->lastBound[pipelineBindPoint].boundDescriptorSets[i], __LINE__, DRAWSTATE_NONE, "DS",
+                            "DescriptorSetDS 0x%" PRIxLEAST64
+                            " previously bound as set #%u was disturbed by newly bound pipelineLayout (0x%" PRIxLEAST64 ")",
+                            (uint64_t)pCB->lastBound[pipelineBindPoint].boundDescriptorSets[i], i, (uint64_t)layout);
+                        pCB->lastBound[pipelineBindPoint].boundDescriptorSets[i] = VK_NULL_HANDLE;
                     }
                 }
             }
-            //  dynamicOffsetCount must equal the total number of dynamic descriptors in the sets being bound
-            if (totalDynamicDescriptors != dynamicOffsetCount) {
-                skip_call |=
-                    log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                            (uint64_t)commandBuffer, __LINE__, DRAWSTATE_INVALID_DYNAMIC_OFFSET_COUNT, "DS",
-                            "Attempting to bind %u descriptorSets with %u dynamic descriptors, but dynamicOffsetCount "
-                            "is %u. It should exactly match the number of dynamic descriptors.",
-                            setCount, totalDynamicDescriptors, dynamicOffsetCount);
+            // Check if newly last bound set invalidates any remaining bound sets
+            if ((pCB->lastBound[pipelineBindPoint].boundDescriptorSets.size() - 1) > (lastSetIndex)) {
+                if (oldFinalBoundSet &&
+                    !verify_set_layout_compatibility(dev_data, oldFinalBoundSet, pipeline_layout, lastSetIndex, errorString)) {
+                    auto old_set = oldFinalBoundSet->GetSet();
+                    skip_call |=
+                        log_msg(dev_data->report_data, VK_DEBUG_REPORT_PERFORMANCE_WARNING_BIT_EXT,
+                                VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT, reinterpret_cast<uint64_t &>(old_set), __LINE__,
+                                DRAWSTATE_NONE, "DS", "DescriptorSetDS 0x%" PRIxLEAST64
+                                                      " previously bound as set #%u is incompatible with set 0x%" PRIxLEAST64
+                                                      " newly bound as set #%u so set #%u and any subsequent sets were "
+                                                      "disturbed by newly bound pipelineLayout (0x%" PRIxLEAST64 ")",
+                                reinterpret_cast<uint64_t &>(old_set), lastSetIndex,
+                                (uint64_t)pCB->lastBound[pipelineBindPoint].boundDescriptorSets[lastSetIndex], lastSetIndex,
+                                lastSetIndex + 1, (uint64_t)layout);
+                    pCB->lastBound[pipelineBindPoint].boundDescriptorSets.resize(lastSetIndex + 1);
+                }
             }
+        }
+        //  dynamicOffsetCount must equal the total number of dynamic descriptors in the sets being bound
+        if (totalDynamicDescriptors != dynamicOffsetCount) {
+            skip_call |=
+                log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                        (uint64_t)pCB->commandBuffer, __LINE__, DRAWSTATE_INVALID_DYNAMIC_OFFSET_COUNT, "DS",
+                        "Attempting to bind %u descriptorSets with %u dynamic descriptors, but dynamicOffsetCount "
+                        "is %u. It should exactly match the number of dynamic descriptors.",
+                        setCount, totalDynamicDescriptors, dynamicOffsetCount);
+        }
+    } else {
+        skip_call |= report_error_no_cb_begin(dev_data, pCB->commandBuffer, "vkCmdBindDescriptorSets()");
+    }
+    return skip_call;
+}
+
+VKAPI_ATTR void VKAPI_CALL
+CmdBindDescriptorSets(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout,
+                      uint32_t firstSet, uint32_t setCount, const VkDescriptorSet *pDescriptorSets, uint32_t dynamicOffsetCount,
+                      const uint32_t *pDynamicOffsets) {
+    bool skip_call = false;
+    layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
+    cb_record_lock lock(dev_data, commandBuffer, true);
+    GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
+    if (pCB) {
+        if (deferred_validation) {
+            DEFERRED_CMD &cmd = deferCmd(dev_data, pCB, CMD_BINDDESCRIPTORSETS);
+            cmd.bind_point = pipelineBindPoint;
+            cmd.handle = reinterpret_cast<uint64_t &>(layout);
+            cmd.first = firstSet;
+            cmd.count = setCount;
+            cmd.first_data = static_cast<uint32_t>(pCB->deferred_log.descriptor_sets.size());
+            pCB->deferred_log.descriptor_sets.insert(pCB->deferred_log.descriptor_sets.end(), pDescriptorSets,
+                                                     pDescriptorSets + setCount);
+            cmd.dynamic_offset_count = dynamicOffsetCount;
+            cmd.first_dynamic_offset = static_cast<uint32_t>(pCB->deferred_log.dynamic_offsets.size());
+            pCB->deferred_log.dynamic_offsets.insert(pCB->deferred_log.dynamic_offsets.end(), pDynamicOffsets,
+                                                     pDynamicOffsets + dynamicOffsetCount);
         } else {
-            skip_call |= report_error_no_cb_begin(dev_data, commandBuffer, "vkCmdBindDescriptorSets()");
+            skip_call |= validateAndRecordCmdBindDescriptorSets(dev_data, pCB, pipelineBindPoint, layout, firstSet, setCount,
+                                                                pDescriptorSets, dynamicOffsetCount, pDynamicOffsets);
         }
     }
     lock.unlock();
@@ -6914,21 +7231,13 @@ CmdBindDescriptorSets(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelin
                                                                pDescriptorSets, dynamicOffsetCount, pDynamicOffsets);
 }
 
-VKAPI_ATTR void VKAPI_CALL
-CmdBindIndexBuffer(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType) {
+static bool validateAndRecordCmdBindIndexBuffer(layer_data *dev_data, GLOBAL_CB_NODE *cb_node, VkBuffer buffer, VkDeviceSize offset,
+                                                VkIndexType indexType) {
     bool skip_call = false;
-    layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    // TODO : Somewhere need to verify that IBs have correct usage state flagged
-    std::unique_lock<std::mutex> lock(global_lock);
-
     auto buff_node = getBufferNode(dev_data, buffer);
-    auto cb_node = getCBNode(dev_data, commandBuffer);
-    if (cb_node && buff_node) {
+    if (buff_node) {
         skip_call |= ValidateMemoryIsBoundToBuffer(dev_data, buff_node, "vkCmdBindIndexBuffer()");
-        std::function<bool()> function = [=]() {
-            return validate_memory_is_valid(dev_data, buff_node->mem, "vkCmdBindIndexBuffer()");
-        };
-        cb_node->validate_functions.push_back(function);
+        addValidateMemoryOp(cb_node, buff_node->mem, "vkCmdBindIndexBuffer()");
         skip_call |= addCmd(dev_data, cb_node, CMD_BINDINDEXBUFFER, "vkCmdBindIndexBuffer()");
         VkDeviceSize offset_align = 0;
         switch (indexType) {
@@ -6952,6 +7261,29 @@ CmdBindIndexBuffer(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize
     } else {
         assert(0);
     }
+    return skip_call;
+}
+
+VKAPI_ATTR void VKAPI_CALL
+CmdBindIndexBuffer(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType) {
+    bool skip_call = false;
+    layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
+    // TODO : Somewhere need to verify that IBs have correct usage state flagged
+    cb_record_lock lock(dev_data, commandBuffer, true);
+
+    auto cb_node = getCBNode(dev_data, commandBuffer);
+    if (cb_node) {
+        if (deferred_validation) {
+            DEFERRED_CMD &cmd = deferCmd(dev_data, cb_node, CMD_BINDINDEXBUFFER);
+            cmd.handle = reinterpret_cast<uint64_t &>(buffer);
+            cmd.offset = offset;
+            cmd.index_type = indexType;
+        } else {
+            skip_call |= validateAndRecordCmdBindIndexBuffer(dev_data, cb_node, buffer, offset, indexType);
+        }
+    } else {
+        assert(0);
+    }
     lock.unlock();
     if (!skip_call)
         dev_data->device_dispatch_table->CmdBindIndexBuffer(commandBuffer, buffer, offset, indexType);
@@ -6969,27 +7301,39 @@ void updateResourceTracking(GLOBAL_CB_NODE *pCB, uint32_t firstBinding, uint32_t
 
 static inline void updateResourceTrackingOnDraw(GLOBAL_CB_NODE *pCB) { pCB->drawData.push_back(pCB->currentDrawData); }
 
+static bool validateAndRecordCmdBindVertexBuffers(layer_data *dev_data, GLOBAL_CB_NODE *cb_node, uint32_t firstBinding,
+                                                  uint32_t bindingCount, const VkBuffer *pBuffers) {
+    bool skip_call = false;
+    for (uint32_t i = 0; i < bindingCount; ++i) {
+        auto buff_node = getBufferNode(dev_data, pBuffers[i]);
+        assert(buff_node);
+        skip_call |= ValidateMemoryIsBoundToBuffer(dev_data, buff_node, "vkCmdBindVertexBuffers()");
+        addValidateMemoryOp(cb_node, buff_node->mem, "vkCmdBindVertexBuffers()");
+    }
+    addCmd(dev_data, cb_node, CMD_BINDVERTEXBUFFER, "vkCmdBindVertexBuffer()");
+    updateResourceTracking(cb_node, firstBinding, bindingCount, pBuffers);
+    return skip_call;
+}
+
 VKAPI_ATTR void VKAPI_CALL CmdBindVertexBuffers(VkCommandBuffer commandBuffer, uint32_t firstBinding,
                                                 uint32_t bindingCount, const VkBuffer *pBuffers,
                                                 const VkDeviceSize *pOffsets) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
     // TODO : Somewhere need to verify that VBs have correct usage state flagged
-    std::unique_lock<std::mutex> lock(global_lock);
+    cb_record_lock lock(dev_data, commandBuffer, true);
 
     auto cb_node = getCBNode(dev_data, commandBuffer);
     if (cb_node) {
-        for (uint32_t i = 0; i < bindingCount; ++i) {
-            auto buff_node = getBufferNode(dev_data, pBuffers[i]);
-            assert(buff_node);
-            skip_call |= ValidateMemoryIsBoundToBuffer(dev_data, buff_node, "vkCmdBindVertexBuffers()");
-            std::function<bool()> function = [=]() {
-                return validate_memory_is_valid(dev_data, buff_node->mem, "vkCmdBindVertexBuffers()");
-            };
-            cb_node->validate_functions.push_back(function);
-        }
-        addCmd(dev_data, cb_node, CMD_BINDVERTEXBUFFER, "vkCmdBindVertexBuffer()");
-        updateResourceTracking(cb_node, firstBinding, bindingCount, pBuffers);
+        if (deferred_validation) {
+            DEFERRED_CMD &cmd = deferCmd(dev_data, cb_node, CMD_BINDVERTEXBUFFER);
+            cmd.first = firstBinding;
+            cmd.count = bindingCount;
+            cmd.first_data = static_cast<uint32_t>(cb_node->deferred_log.buffers.size());
+            cb_node->deferred_log.buffers.insert(cb_node->deferred_log.buffers.end(), pBuffers, pBuffers + bindingCount);
+        } else {
+            skip_call |= validateAndRecordCmdBindVertexBuffers(dev_data, cb_node, firstBinding, bindingCount, pBuffers);
+        }
     } else {
         skip_call |= report_error_no_cb_begin(dev_data, commandBuffer, "vkCmdBindVertexBuffer()");
     }
@@ -7009,21 +7353,31 @@ static bool markStoreImagesAndBuffersAsWritten(layer_data *dev_data, GLOBAL_CB_N
 
         auto img_node = getImageNode(dev_data, iv_data->image);
         assert(img_node);
-        std::function<bool()> function = [=]() {
-            set_memory_valid(dev_data, img_node->mem, true, iv_data->image);
-            return false;
-        };
-        pCB->validate_functions.push_back(function);
+        addSetMemoryValidOp(pCB, img_node->mem, true, iv_data->image);
     }
     for (auto buffer : pCB->updateBuffers) {
         auto buff_node = getBufferNode(dev_data, buffer);
         assert(buff_node);
-        std::function<bool()> function = [=]() {
-            set_memory_valid(dev_data, buff_node->mem, true);
-            return false;
-        };
-        pCB->validate_functions.push_back(function);
+        addSetMemoryValidOp(pCB, buff_node->mem, true);
+    }
+    return skip_call;
+}
+
+static bool validateAndRecordCmdDraw(layer_data *dev_data, GLOBAL_CB_NODE *pCB) {
+    bool skip_call = false;
+    skip_call |= addCmd(dev_data, pCB, CMD_DRAW, "vkCmdDraw()");
+    pCB->drawCount[DRAW]++;
+    skip_call |= validate_and_update_draw_state(dev_data, pCB, false, VK_PIPELINE_BIND_POINT_GRAPHICS);
+    skip_call |= markStoreImagesAndBuffersAsWritten(dev_data, pCB);
+    // TODO : Need to pass pCB->commandBuffer as srcObj here
+    skip_call |=
+        log_msg(dev_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, 0,
+                __LINE__, DRAWSTATE_NONE, "DS", "vkCmdDraw() call 0x%" PRIx64 ", reporting DS state:", g_drawCount[DRAW]++);
+    skip_call |= synchAndPrintDSConfig(dev_data, pCB->commandBuffer);
+    if (!skip_call) {
+        updateResourceTrackingOnDraw(pCB);
     }
+    skip_call |= outsideRenderPass(dev_data, pCB, "vkCmdDraw");
     return skip_call;
 }
 
@@ -7031,49 +7385,51 @@ VKAPI_ATTR void VKAPI_CALL CmdDraw(VkCommandBuffer commandBuffer, uint32_t verte
                                    uint32_t firstVertex, uint32_t firstInstance) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    cb_record_lock lock(dev_data, commandBuffer, true);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
-        skip_call |= addCmd(dev_data, pCB, CMD_DRAW, "vkCmdDraw()");
-        pCB->drawCount[DRAW]++;
-        skip_call |= validate_and_update_draw_state(dev_data, pCB, false, VK_PIPELINE_BIND_POINT_GRAPHICS);
-        skip_call |= markStoreImagesAndBuffersAsWritten(dev_data, pCB);
-        // TODO : Need to pass commandBuffer as srcObj here
-        skip_call |=
-            log_msg(dev_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, 0,
-                    __LINE__, DRAWSTATE_NONE, "DS", "vkCmdDraw() call 0x%" PRIx64 ", reporting DS state:", g_drawCount[DRAW]++);
-        skip_call |= synchAndPrintDSConfig(dev_data, commandBuffer);
-        if (!skip_call) {
-            updateResourceTrackingOnDraw(pCB);
+        if (deferred_validation) {
+            deferCmd(dev_data, pCB, CMD_DRAW);
+        } else {
+            skip_call |= validateAndRecordCmdDraw(dev_data, pCB);
         }
-        skip_call |= outsideRenderPass(dev_data, pCB, "vkCmdDraw");
     }
     lock.unlock();
     if (!skip_call)
         dev_data->device_dispatch_table->CmdDraw(commandBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
 }
 
+static bool validateAndRecordCmdDrawIndexed(layer_data *dev_data, GLOBAL_CB_NODE *pCB) {
+    bool skip_call = false;
+    skip_call |= addCmd(dev_data, pCB, CMD_DRAWINDEXED, "vkCmdDrawIndexed()");
+    pCB->drawCount[DRAW_INDEXED]++;
+    skip_call |= validate_and_update_draw_state(dev_data, pCB, true, VK_PIPELINE_BIND_POINT_GRAPHICS);
+    skip_call |= markStoreImagesAndBuffersAsWritten(dev_data, pCB);
+    // TODO : Need to pass pCB->commandBuffer as srcObj here
+    skip_call |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT,
+                         VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, 0, __LINE__, DRAWSTATE_NONE, "DS",
+                         "vkCmdDrawIndexed() call 0x%" PRIx64 ", reporting DS state:", g_drawCount[DRAW_INDEXED]++);
+    skip_call |= synchAndPrintDSConfig(dev_data, pCB->commandBuffer);
+    if (!skip_call) {
+        updateResourceTrackingOnDraw(pCB);
+    }
+    skip_call |= outsideRenderPass(dev_data, pCB, "vkCmdDrawIndexed");
+    return skip_call;
+}
+
 VKAPI_ATTR void VKAPI_CALL CmdDrawIndexed(VkCommandBuffer commandBuffer, uint32_t indexCount,
                                           uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset,
                                                             uint32_t firstInstance) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
     bool skip_call = false;
-    std::unique_lock<std::mutex> lock(global_lock);
+    cb_record_lock lock(dev_data, commandBuffer, true);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
-        skip_call |= addCmd(dev_data, pCB, CMD_DRAWINDEXED, "vkCmdDrawIndexed()");
-        pCB->drawCount[DRAW_INDEXED]++;
-        skip_call |= validate_and_update_draw_state(dev_data, pCB, true, VK_PIPELINE_BIND_POINT_GRAPHICS);
-        skip_call |= markStoreImagesAndBuffersAsWritten(dev_data, pCB);
-        // TODO : Need to pass commandBuffer as srcObj here
-        skip_call |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT,
-                             VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, 0, __LINE__, DRAWSTATE_NONE, "DS",
-                             "vkCmdDrawIndexed() call 0x%" PRIx64 ", reporting DS state:", g_drawCount[DRAW_INDEXED]++);
-        skip_call |= synchAndPrintDSConfig(dev_data, commandBuffer);
-        if (!skip_call) {
-            updateResourceTrackingOnDraw(pCB);
+        if (deferred_validation) {
+            deferCmd(dev_data, pCB, CMD_DRAWINDEXED);
+        } else {
+            skip_call |= validateAndRecordCmdDrawIndexed(dev_data, pCB);
         }
-        skip_call |= outsideRenderPass(dev_data, pCB, "vkCmdDrawIndexed");
     }
     lock.unlock();
     if (!skip_call)
@@ -7081,26 +7437,21 @@ VKAPI_ATTR void VKAPI_CALL CmdDrawIndexed(VkCommandBuffer commandBuffer, uint32_
                                                         firstInstance);
 }
 
-VKAPI_ATTR void VKAPI_CALL
-CmdDrawIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t count, uint32_t stride) {
-    layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
+static bool validateAndRecordCmdDrawIndirect(layer_data *dev_data, GLOBAL_CB_NODE *cb_node, VkBuffer buffer) {
     bool skip_call = false;
-    std::unique_lock<std::mutex> lock(global_lock);
-
-    auto cb_node = getCBNode(dev_data, commandBuffer);
     auto buff_node = getBufferNode(dev_data, buffer);
-    if (cb_node && buff_node) {
+    if (buff_node) {
         skip_call |= ValidateMemoryIsBoundToBuffer(dev_data, buff_node, "vkCmdDrawIndirect()");
         skip_call |= addCommandBufferBindingBuffer(dev_data, cb_node, buff_node, "vkCmdDrawIndirect()");
         skip_call |= addCmd(dev_data, cb_node, CMD_DRAWINDIRECT, "vkCmdDrawIndirect()");
         cb_node->drawCount[DRAW_INDIRECT]++;
         skip_call |= validate_and_update_draw_state(dev_data, cb_node, false, VK_PIPELINE_BIND_POINT_GRAPHICS);
         skip_call |= markStoreImagesAndBuffersAsWritten(dev_data, cb_node);
-        // TODO : Need to pass commandBuffer as srcObj here
+        // TODO : Need to pass cb_node->commandBuffer as srcObj here
         skip_call |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT,
                              VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, 0, __LINE__, DRAWSTATE_NONE, "DS",
                              "vkCmdDrawIndirect() call 0x%" PRIx64 ", reporting DS state:", g_drawCount[DRAW_INDIRECT]++);
-        skip_call |= synchAndPrintDSConfig(dev_data, commandBuffer);
+        skip_call |= synchAndPrintDSConfig(dev_data, cb_node->commandBuffer);
         if (!skip_call) {
             updateResourceTrackingOnDraw(cb_node);
         }
@@ -7108,32 +7459,47 @@ CmdDrawIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize off
     } else {
         assert(0);
     }
-    lock.unlock();
-    if (!skip_call)
-        dev_data->device_dispatch_table->CmdDrawIndirect(commandBuffer, buffer, offset, count, stride);
+    return skip_call;
 }
 
 VKAPI_ATTR void VKAPI_CALL
-CmdDrawIndexedIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t count, uint32_t stride) {
-    bool skip_call = false;
+CmdDrawIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t count, uint32_t stride) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    bool skip_call = false;
+    cb_record_lock lock(dev_data, commandBuffer, true);
 
     auto cb_node = getCBNode(dev_data, commandBuffer);
+    if (cb_node) {
+        if (deferred_validation) {
+            DEFERRED_CMD &cmd = deferCmd(dev_data, cb_node, CMD_DRAWINDIRECT);
+            cmd.handle = reinterpret_cast<uint64_t &>(buffer);
+        } else {
+            skip_call |= validateAndRecordCmdDrawIndirect(dev_data, cb_node, buffer);
+        }
+    } else {
+        assert(0);
+    }
+    lock.unlock();
+    if (!skip_call)
+        dev_data->device_dispatch_table->CmdDrawIndirect(commandBuffer, buffer, offset, count, stride);
+}
+
+static bool validateAndRecordCmdDrawIndexedIndirect(layer_data *dev_data, GLOBAL_CB_NODE *cb_node, VkBuffer buffer) {
+    bool skip_call = false;
     auto buff_node = getBufferNode(dev_data, buffer);
-    if (cb_node && buff_node) {
+    if (buff_node) {
         skip_call |= ValidateMemoryIsBoundToBuffer(dev_data, buff_node, "vkCmdDrawIndexedIndirect()");
         skip_call |= addCommandBufferBindingBuffer(dev_data, cb_node, buff_node, "vkCmdDrawIndexedIndirect()");
         skip_call |= addCmd(dev_data, cb_node, CMD_DRAWINDEXEDINDIRECT, "vkCmdDrawIndexedIndirect()");
         cb_node->drawCount[DRAW_INDEXED_INDIRECT]++;
         skip_call |= validate_and_update_draw_state(dev_data, cb_node, true, VK_PIPELINE_BIND_POINT_GRAPHICS);
         skip_call |= markStoreImagesAndBuffersAsWritten(dev_data, cb_node);
-        // TODO : Need to pass commandBuffer as srcObj here
+        // TODO : Need to pass cb_node->commandBuffer as srcObj here
         skip_call |=
             log_msg(dev_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, 0,
                     __LINE__, DRAWSTATE_NONE, "DS", "vkCmdDrawIndexedIndirect() call 0x%" PRIx64 ", reporting DS state:",
                     g_drawCount[DRAW_INDEXED_INDIRECT]++);
-        skip_call |= synchAndPrintDSConfig(dev_data, commandBuffer);
+        skip_call |= synchAndPrintDSConfig(dev_data, cb_node->commandBuffer);
         if (!skip_call) {
             updateResourceTrackingOnDraw(cb_node);
         }
@@ -7141,36 +7507,61 @@ CmdDrawIndexedIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceS
     } else {
         assert(0);
     }
+    return skip_call;
+}
+
+VKAPI_ATTR void VKAPI_CALL
+CmdDrawIndexedIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t count, uint32_t stride) {
+    bool skip_call = false;
+    layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
+    cb_record_lock lock(dev_data, commandBuffer, true);
+
+    auto cb_node = getCBNode(dev_data, commandBuffer);
+    if (cb_node) {
+        if (deferred_validation) {
+            DEFERRED_CMD &cmd = deferCmd(dev_data, cb_node, CMD_DRAWINDEXEDINDIRECT);
+            cmd.handle = reinterpret_cast<uint64_t &>(buffer);
+        } else {
+            skip_call |= validateAndRecordCmdDrawIndexedIndirect(dev_data, cb_node, buffer);
+        }
+    } else {
+        assert(0);
+    }
     lock.unlock();
     if (!skip_call)
         dev_data->device_dispatch_table->CmdDrawIndexedIndirect(commandBuffer, buffer, offset, count, stride);
 }
 
+static bool validateAndRecordCmdDispatch(layer_data *dev_data, GLOBAL_CB_NODE *pCB) {
+    bool skip_call = false;
+    skip_call |= validate_and_update_draw_state(dev_data, pCB, false, VK_PIPELINE_BIND_POINT_COMPUTE);
+    skip_call |= markStoreImagesAndBuffersAsWritten(dev_data, pCB);
+    skip_call |= addCmd(dev_data, pCB, CMD_DISPATCH, "vkCmdDispatch()");
+    skip_call |= insideRenderPass(dev_data, pCB, "vkCmdDispatch");
+    return skip_call;
+}
+
 VKAPI_ATTR void VKAPI_CALL CmdDispatch(VkCommandBuffer commandBuffer, uint32_t x, uint32_t y, uint32_t z) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    cb_record_lock lock(dev_data, commandBuffer, true);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
-        skip_call |= validate_and_update_draw_state(dev_data, pCB, false, VK_PIPELINE_BIND_POINT_COMPUTE);
-        skip_call |= markStoreImagesAndBuffersAsWritten(dev_data, pCB);
-        skip_call |= addCmd(dev_data, pCB, CMD_DISPATCH, "vkCmdDispatch()");
-        skip_call |= insideRenderPass(dev_data, pCB, "vkCmdDispatch");
+        if (deferred_validation) {
+            deferCmd(dev_data, pCB, CMD_DISPATCH);
+        } else {
+            skip_call |= validateAndRecordCmdDispatch(dev_data, pCB);
+        }
     }
     lock.unlock();
     if (!skip_call)
         dev_data->device_dispatch_table->CmdDispatch(commandBuffer, x, y, z);
 }
 
-VKAPI_ATTR void VKAPI_CALL
-CmdDispatchIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset) {
+static bool validateAndRecordCmdDispatchIndirect(layer_data *dev_data, GLOBAL_CB_NODE *cb_node, VkBuffer buffer) {
     bool skip_call = false;
-    layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
-
-    auto cb_node = getCBNode(dev_data, commandBuffer);
     auto buff_node = getBufferNode(dev_data, buffer);
-    if (cb_node && buff_node) {
+    if (buff_node) {
         skip_call |= ValidateMemoryIsBoundToBuffer(dev_data, buff_node, "vkCmdDispatchIndirect()");
         skip_call |= addCommandBufferBindingBuffer(dev_data, cb_node, buff_node, "vkCmdDispatchIndirect()");
         skip_call |= validate_and_update_draw_state(dev_data, cb_node, false, VK_PIPELINE_BIND_POINT_COMPUTE);
@@ -7178,16 +7569,121 @@ CmdDispatchIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize
         skip_call |= addCmd(dev_data, cb_node, CMD_DISPATCHINDIRECT, "vkCmdDispatchIndirect()");
         skip_call |= insideRenderPass(dev_data, cb_node, "vkCmdDispatchIndirect()");
     }
+    return skip_call;
+}
+
+VKAPI_ATTR void VKAPI_CALL
+CmdDispatchIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset) {
+    bool skip_call = false;
+    layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
+    cb_record_lock lock(dev_data, commandBuffer, true);
+
+    auto cb_node = getCBNode(dev_data, commandBuffer);
+    if (cb_node) {
+        if (deferred_validation) {
+            DEFERRED_CMD &cmd = deferCmd(dev_data, cb_node, CMD_DISPATCHINDIRECT);
+            cmd.handle = reinterpret_cast<uint64_t &>(buffer);
+        } else {
+            skip_call |= validateAndRecordCmdDispatchIndirect(dev_data, cb_node, buffer);
+        }
+    }
     lock.unlock();
     if (!skip_call)
         dev_data->device_dispatch_table->CmdDispatchIndirect(commandBuffer, buffer, offset);
 }
 
+// Validates the commands in the command buffer's log in the order they were recorded, and empties the log. Caller holds
+//  either a cb_record_lock on the command buffer or global_lock exclusively.
+static void validateDeferredCmds(layer_data *dev_data, GLOBAL_CB_NODE *pCB) {
+    DEFERRED_CMD_LOG &log = pCB->deferred_log;
+    for (const auto &cmd : log.cmds) {
+        switch (cmd.type) {
+        case CMD_BINDPIPELINE:
+            validateAndRecordCmdBindPipeline(dev_data, pCB, cmd.bind_point, reinterpret_cast<const VkPipeline &>(cmd.handle));
+            break;
+        case CMD_SETVIEWPORTSTATE:
+            validateAndRecordCmdSetViewport(dev_data, pCB, cmd.count, log.viewports.data() + cmd.first_data);
+            break;
+        case CMD_SETSCISSORSTATE:
+            validateAndRecordCmdSetScissor(dev_data, pCB, cmd.count, log.scissors.data() + cmd.first_data);
+            break;
+        case CMD_SETLINEWIDTHSTATE:
+            validateAndRecordCmdSetLineWidth(dev_data, pCB, cmd.line_width);
+            break;
+        case CMD_SETDEPTHBIASSTATE:
+            validateAndRecordCmdSetDepthBias(dev_data, pCB);
+            break;
+        case CMD_SETBLENDSTATE:
+            validateAndRecordCmdSetBlendConstants(dev_data, pCB);
+            break;
+        case CMD_SETDEPTHBOUNDSSTATE:
+            validateAndRecordCmdSetDepthBounds(dev_data, pCB);
+            break;
+        case CMD_SETSTENCILREADMASKSTATE:
+            validateAndRecordCmdSetStencilCompareMask(dev_data, pCB);
+            break;
+        case CMD_SETSTENCILWRITEMASKSTATE:
+            validateAndRecordCmdSetStencilWriteMask(dev_data, pCB);
+            break;
+        case CMD_SETSTENCILREFERENCESTATE:
+            validateAndRecordCmdSetStencilReference(dev_data, pCB);
+            break;
+        case CMD_BINDDESCRIPTORSETS:
+            validateAndRecordCmdBindDescriptorSets(
+                dev_data, pCB, cmd.bind_point, reinterpret_cast<const VkPipelineLayout &>(cmd.handle), cmd.first, cmd.count,
+                log.descriptor_sets.data() + cmd.first_data, cmd.dynamic_offset_count,
+                log.dynamic_offsets.data() + cmd.first_dynamic_offset);
+            break;
+        case CMD_BINDINDEXBUFFER:
+            validateAndRecordCmdBindIndexBuffer(dev_data, pCB, reinterpret_cast<const VkBuffer &>(cmd.handle), cmd.offset,
+                                                cmd.index_type);
+            break;
+        case CMD_BINDVERTEXBUFFER:
+            validateAndRecordCmdBindVertexBuffers(dev_data, pCB, cmd.first, cmd.count, log.buffers.data() + cmd.first_data);
+            break;
+        case CMD_DRAW:
+            validateAndRecordCmdDraw(dev_data, pCB);
+            break;
+        case CMD_DRAWINDEXED:
+            validateAndRecordCmdDrawIndexed(dev_data, pCB);
+            break;
+        case CMD_DRAWINDIRECT:
+            validateAndRecordCmdDrawIndirect(dev_data, pCB, reinterpret_cast<const VkBuffer &>(cmd.handle));
+            break;
+        case CMD_DRAWINDEXEDINDIRECT:
+            validateAndRecordCmdDrawIndexedIndirect(dev_data, pCB, reinterpret_cast<const VkBuffer &>(cmd.handle));
+            break;
+        case CMD_DISPATCH:
+            validateAndRecordCmdDispatch(dev_data, pCB);
+            break;
+        case CMD_DISPATCHINDIRECT:
+            validateAndRecordCmdDispatchIndirect(dev_data, pCB, reinterpret_cast<const VkBuffer &>(cmd.handle));
+            break;
+        default:
+            assert(0);
+            break;
+        }
+    }
+    log.clear();
+}
+
+// Runs each time global_lock is locked exclusively
+static void validateAllDeferredCmds() {
+    if (!deferred_validation)
+        return;
+    std::lock_guard<std::mutex> lock(deferred_lock);
+    for (auto &deferred_cb : deferred_cbs) {
+        validateDeferredCmds(deferred_cb.first, deferred_cb.second);
+        deferred_cb.second->deferred_log.queued = false;
+    }
+    deferred_cbs.clear();
+}
+
 VKAPI_ATTR void VKAPI_CALL CmdCopyBuffer(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkBuffer dstBuffer,
                                          uint32_t regionCount, const VkBufferCopy *pRegions) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    cb_record_lock lock(dev_data, commandBuffer);
 
     auto cb_node = getCBNode(dev_data, commandBuffer);
     auto src_buff_node = getBufferNode(dev_data, srcBuffer);
@@ -7204,15 +7700,8 @@ VKAPI_ATTR void VKAPI_CALL CmdCopyBuffer(VkCommandBuffer commandBuffer, VkBuffer
         skip_call |= validateBufferUsageFlags(dev_data, dst_buff_node, VK_BUFFER_USAGE_TRANSFER_DST_BIT, true, "vkCmdCopyBuffer()",
                                               "VK_BUFFER_USAGE_TRANSFER_DST_BIT");
 
-        std::function<bool()> function = [=]() {
-            return validate_memory_is_valid(dev_data, src_buff_node->mem, "vkCmdCopyBuffer()");
-        };
-        cb_node->validate_functions.push_back(function);
-        function = [=]() {
-            set_memory_valid(dev_data, dst_buff_node->mem, true);
-            return false;
-        };
-        cb_node->validate_functions.push_back(function);
+        addValidateMemoryOp(cb_node, src_buff_node->mem, "vkCmdCopyBuffer()");
+        addSetMemoryValidOp(cb_node, dst_buff_node->mem, true);
 
         skip_call |= addCmd(dev_data, cb_node, CMD_COPYBUFFER, "vkCmdCopyBuffer()");
         skip_call |= insideRenderPass(dev_data, cb_node, "vkCmdCopyBuffer()");
@@ -7229,23 +7718,20 @@ static bool VerifySourceImageLayout(layer_data *dev_data, GLOBAL_CB_NODE *cb_nod
                                     VkImageSubresourceLayers subLayers, VkImageLayout srcImageLayout) {
     bool skip_call = false;
 
-    for (uint32_t i = 0; i < subLayers.layerCount; ++i) {
-        uint32_t layer = i + subLayers.baseArrayLayer;
-        VkImageSubresource sub = {subLayers.aspectMask, subLayers.mipLevel, layer};
-        IMAGE_CMD_BUF_LAYOUT_NODE node;
-        if (!FindLayout(cb_node, srcImage, sub, node)) {
-            SetLayout(cb_node, srcImage, sub, IMAGE_CMD_BUF_LAYOUT_NODE(srcImageLayout, srcImageLayout));
-            continue;
-        }
-        if (node.layout != srcImageLayout) {
+    VkImageSubresourceRange range = {subLayers.aspectMask, subLayers.mipLevel, 1, subLayers.baseArrayLayer, subLayers.layerCount};
+    UpdateCBLayouts(dev_data, cb_node, srcImage, range, [&](const IMAGE_CMD_BUF_LAYOUT_NODE *node) -> IMAGE_CMD_BUF_LAYOUT_NODE {
+        if (!node)
+            return IMAGE_CMD_BUF_LAYOUT_NODE(srcImageLayout, srcImageLayout);
+        if (node->layout != srcImageLayout) {
             // TODO: Improve log message in the next pass
             skip_call |=
                 log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, 0,
                         __LINE__, DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS", "Cannot copy from an image whose source layout is %s "
                                                                         "and doesn't match the current layout %s.",
-                        string_VkImageLayout(srcImageLayout), string_VkImageLayout(node.layout));
+                        string_VkImageLayout(srcImageLayout), string_VkImageLayout(node->layout));
         }
-    }
+        return *node;
+    });
     if (srcImageLayout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) {
         if (srcImageLayout == VK_IMAGE_LAYOUT_GENERAL) {
             // TODO : Can we deal with image node from the top of call tree and avoid map look-up here?
@@ -7270,22 +7756,19 @@ static bool VerifyDestImageLayout(layer_data *dev_data, GLOBAL_CB_NODE *cb_node,
                                   VkImageSubresourceLayers subLayers, VkImageLayout destImageLayout) {
     bool skip_call = false;
 
-    for (uint32_t i = 0; i < subLayers.layerCount; ++i) {
-        uint32_t layer = i + subLayers.baseArrayLayer;
-        VkImageSubresource sub = {subLayers.aspectMask, subLayers.mipLevel, layer};
-        IMAGE_CMD_BUF_LAYOUT_NODE node;
-        if (!FindLayout(cb_node, destImage, sub, node)) {
-            SetLayout(cb_node, destImage, sub, IMAGE_CMD_BUF_LAYOUT_NODE(destImageLayout, destImageLayout));
-            continue;
-        }
-        if (node.layout != destImageLayout) {
+    VkImageSubresourceRange range = {subLayers.aspectMask, subLayers.mipLevel, 1, subLayers.baseArrayLayer, subLayers.layerCount};
+    UpdateCBLayouts(dev_data, cb_node, destImage, range, [&](const IMAGE_CMD_BUF_LAYOUT_NODE *node) -> IMAGE_CMD_BUF_LAYOUT_NODE {
+        if (!node)
+            return IMAGE_CMD_BUF_LAYOUT_NODE(destImageLayout, destImageLayout);
+        if (node->layout != destImageLayout) {
             skip_call |=
                 log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, 0,
                         __LINE__, DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS", "Cannot copy from an image whose dest layout is %s and "
                                                                         "doesn't match the current layout %s.",
-                        string_VkImageLayout(destImageLayout), string_VkImageLayout(node.layout));
+                        string_VkImageLayout(destImageLayout), string_VkImageLayout(node->layout));
         }
-    }
+        return *node;
+    });
     if (destImageLayout != VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
         if (destImageLayout == VK_IMAGE_LAYOUT_GENERAL) {
             auto image_node = getImageNode(dev_data, destImage);
@@ -7310,7 +7793,7 @@ CmdCopyImage(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout srcI
              VkImageLayout dstImageLayout, uint32_t regionCount, const VkImageCopy *pRegions) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
 
     auto cb_node = getCBNode(dev_data, commandBuffer);
     auto src_img_node = getImageNode(dev_data, srcImage);
@@ -7326,15 +7809,8 @@ CmdCopyImage(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout srcI
                                              "VK_BUFFER_USAGE_TRANSFER_SRC_BIT");
         skip_call |= validateImageUsageFlags(dev_data, dst_img_node, VK_BUFFER_USAGE_TRANSFER_DST_BIT, true, "vkCmdCopyImage()",
                                              "VK_BUFFER_USAGE_TRANSFER_DST_BIT");
-        std::function<bool()> function = [=]() {
-            return validate_memory_is_valid(dev_data, src_img_node->mem, "vkCmdCopyImage()", srcImage);
-        };
-        cb_node->validate_functions.push_back(function);
-        function = [=]() {
-            set_memory_valid(dev_data, dst_img_node->mem, true, dstImage);
-            return false;
-        };
-        cb_node->validate_functions.push_back(function);
+        addValidateMemoryOp(cb_node, src_img_node->mem, "vkCmdCopyImage()", srcImage);
+        addSetMemoryValidOp(cb_node, dst_img_node->mem, true, dstImage);
 
         skip_call |= addCmd(dev_data, cb_node, CMD_COPYIMAGE, "vkCmdCopyImage()");
         skip_call |= insideRenderPass(dev_data, cb_node, "vkCmdCopyImage()");
@@ -7356,7 +7832,7 @@ CmdBlitImage(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout srcI
              VkImageLayout dstImageLayout, uint32_t regionCount, const VkImageBlit *pRegions, VkFilter filter) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
 
     auto cb_node = getCBNode(dev_data, commandBuffer);
     auto src_img_node = getImageNode(dev_data, srcImage);
@@ -7372,15 +7848,8 @@ CmdBlitImage(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout srcI
                                              "VK_BUFFER_USAGE_TRANSFER_SRC_BIT");
         skip_call |= validateImageUsageFlags(dev_data, dst_img_node, VK_BUFFER_USAGE_TRANSFER_DST_BIT, true, "vkCmdBlitImage()",
                                              "VK_BUFFER_USAGE_TRANSFER_DST_BIT");
-        std::function<bool()> function = [=]() {
-            return validate_memory_is_valid(dev_data, src_img_node->mem, "vkCmdBlitImage()", srcImage);
-        };
-        cb_node->validate_functions.push_back(function);
-        function = [=]() {
-            set_memory_valid(dev_data, dst_img_node->mem, true, dstImage);
-            return false;
-        };
-        cb_node->validate_functions.push_back(function);
+        addValidateMemoryOp(cb_node, src_img_node->mem, "vkCmdBlitImage()", srcImage);
+        addSetMemoryValidOp(cb_node, dst_img_node->mem, true, dstImage);
 
         skip_call |= addCmd(dev_data, cb_node, CMD_BLITIMAGE, "vkCmdBlitImage()");
         skip_call |= insideRenderPass(dev_data, cb_node, "vkCmdBlitImage()");
@@ -7398,7 +7867,7 @@ VKAPI_ATTR void VKAPI_CALL CmdCopyBufferToImage(VkCommandBuffer commandBuffer, V
                                                 uint32_t regionCount, const VkBufferImageCopy *pRegions) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
 
     auto cb_node = getCBNode(dev_data, commandBuffer);
     auto src_buff_node = getBufferNode(dev_data, srcBuffer);
@@ -7412,13 +7881,8 @@ VKAPI_ATTR void VKAPI_CALL CmdCopyBufferToImage(VkCommandBuffer commandBuffer, V
                                               "vkCmdCopyBufferToImage()", "VK_BUFFER_USAGE_TRANSFER_SRC_BIT");
         skip_call |= validateImageUsageFlags(dev_data, dst_img_node, VK_BUFFER_USAGE_TRANSFER_DST_BIT, true,
                                              "vkCmdCopyBufferToImage()", "VK_BUFFER_USAGE_TRANSFER_DST_BIT");
-        std::function<bool()> function = [=]() {
-            set_memory_valid(dev_data, dst_img_node->mem, true, dstImage);
-            return false;
-        };
-        cb_node->validate_functions.push_back(function);
-        function = [=]() { return validate_memory_is_valid(dev_data, src_buff_node->mem, "vkCmdCopyBufferToImage()"); };
-        cb_node->validate_functions.push_back(function);
+        addSetMemoryValidOp(cb_node, dst_img_node->mem, true, dstImage);
+        addValidateMemoryOp(cb_node, src_buff_node->mem, "vkCmdCopyBufferToImage()");
 
         skip_call |= addCmd(dev_data, cb_node, CMD_COPYBUFFERTOIMAGE, "vkCmdCopyBufferToImage()");
         skip_call |= insideRenderPass(dev_data, cb_node, "vkCmdCopyBufferToImage()");
@@ -7439,7 +7903,7 @@ VKAPI_ATTR void VKAPI_CALL CmdCopyImageToBuffer(VkCommandBuffer commandBuffer, V
                                                 uint32_t regionCount, const VkBufferImageCopy *pRegions) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
 
     auto cb_node = getCBNode(dev_data, commandBuffer);
     auto src_img_node = getImageNode(dev_data, srcImage);
@@ -7455,15 +7919,8 @@ VKAPI_ATTR void VKAPI_CALL CmdCopyImageToBuffer(VkCommandBuffer commandBuffer, V
                                              "vkCmdCopyImageToBuffer()", "VK_BUFFER_USAGE_TRANSFER_SRC_BIT");
         skip_call |= validateBufferUsageFlags(dev_data, dst_buff_node, VK_BUFFER_USAGE_TRANSFER_DST_BIT, true,
                                               "vkCmdCopyImageToBuffer()", "VK_BUFFER_USAGE_TRANSFER_DST_BIT");
-        std::function<bool()> function = [=]() {
-            return validate_memory_is_valid(dev_data, src_img_node->mem, "vkCmdCopyImageToBuffer()", srcImage);
-        };
-        cb_node->validate_functions.push_back(function);
-        function = [=]() {
-            set_memory_valid(dev_data, dst_buff_node->mem, true);
-            return false;
-        };
-        cb_node->validate_functions.push_back(function);
+        addValidateMemoryOp(cb_node, src_img_node->mem, "vkCmdCopyImageToBuffer()", srcImage);
+        addSetMemoryValidOp(cb_node, dst_buff_node->mem, true);
 
         skip_call |= addCmd(dev_data, cb_node, CMD_COPYIMAGETOBUFFER, "vkCmdCopyImageToBuffer()");
         skip_call |= insideRenderPass(dev_data, cb_node, "vkCmdCopyImageToBuffer()");
@@ -7483,7 +7940,7 @@ VKAPI_ATTR void VKAPI_CALL CmdUpdateBuffer(VkCommandBuffer commandBuffer, VkBuff
                                            VkDeviceSize dstOffset, VkDeviceSize dataSize, const uint32_t *pData) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    cb_record_lock lock(dev_data, commandBuffer);
 
     auto cb_node = getCBNode(dev_data, commandBuffer);
     auto dst_buff_node = getBufferNode(dev_data, dstBuffer);
@@ -7494,11 +7951,7 @@ VKAPI_ATTR void VKAPI_CALL CmdUpdateBuffer(VkCommandBuffer commandBuffer, VkBuff
         // Validate that DST buffer has correct usage flags set
         skip_call |= validateBufferUsageFlags(dev_data, dst_buff_node, VK_BUFFER_USAGE_TRANSFER_DST_BIT, true,
                                               "vkCmdUpdateBuffer()", "VK_BUFFER_USAGE_TRANSFER_DST_BIT");
-        std::function<bool()> function = [=]() {
-            set_memory_valid(dev_data, dst_buff_node->mem, true);
-            return false;
-        };
-        cb_node->validate_functions.push_back(function);
+        addSetMemoryValidOp(cb_node, dst_buff_node->mem, true);
 
         skip_call |= addCmd(dev_data, cb_node, CMD_UPDATEBUFFER, "vkCmdUpdateBuffer()");
         skip_call |= insideRenderPass(dev_data, cb_node, "vkCmdCopyUpdateBuffer()");
@@ -7514,7 +7967,7 @@ VKAPI_ATTR void VKAPI_CALL
 CmdFillBuffer(VkCommandBuffer commandBuffer, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize size, uint32_t data) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    cb_record_lock lock(dev_data, commandBuffer);
 
     auto cb_node = getCBNode(dev_data, commandBuffer);
     auto dst_buff_node = getBufferNode(dev_data, dstBuffer);
@@ -7525,11 +7978,7 @@ CmdFillBuffer(VkCommandBuffer commandBuffer, VkBuffer dstBuffer, VkDeviceSize ds
         // Validate that DST buffer has correct usage flags set
         skip_call |= validateBufferUsageFlags(dev_data, dst_buff_node, VK_BUFFER_USAGE_TRANSFER_DST_BIT, true, "vkCmdFillBuffer()",
                                               "VK_BUFFER_USAGE_TRANSFER_DST_BIT");
-        std::function<bool()> function = [=]() {
-            set_memory_valid(dev_data, dst_buff_node->mem, true);
-            return false;
-        };
-        cb_node->validate_functions.push_back(function);
+        addSetMemoryValidOp(cb_node, dst_buff_node->mem, true);
 
         skip_call |= addCmd(dev_data, cb_node, CMD_FILLBUFFER, "vkCmdFillBuffer()");
         skip_call |= insideRenderPass(dev_data, cb_node, "vkCmdCopyFillBuffer()");
@@ -7546,7 +7995,7 @@ VKAPI_ATTR void VKAPI_CALL CmdClearAttachments(VkCommandBuffer commandBuffer, ui
                                                const VkClearRect *pRects) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         skip_call |= addCmd(dev_data, pCB, CMD_CLEARATTACHMENTS, "vkCmdClearAttachments()");
@@ -7616,7 +8065,7 @@ VKAPI_ATTR void VKAPI_CALL CmdClearColorImage(VkCommandBuffer commandBuffer, VkI
                                               uint32_t rangeCount, const VkImageSubresourceRange *pRanges) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     // TODO : Verify memory is in VK_IMAGE_STATE_CLEAR state
 
     auto cb_node = getCBNode(dev_data, commandBuffer);
@@ -7624,11 +8073,7 @@ VKAPI_ATTR void VKAPI_CALL CmdClearColorImage(VkCommandBuffer commandBuffer, VkI
     if (cb_node && img_node) {
         skip_call |= ValidateMemoryIsBoundToImage(dev_data, img_node, "vkCmdClearColorImage()");
         skip_call |= addCommandBufferBindingImage(dev_data, cb_node, img_node, "vkCmdClearColorImage()");
-        std::function<bool()> function = [=]() {
-            set_memory_valid(dev_data, img_node->mem, true, image);
-            return false;
-        };
-        cb_node->validate_functions.push_back(function);
+        addSetMemoryValidOp(cb_node, img_node->mem, true, image);
 
         skip_call |= addCmd(dev_data, cb_node, CMD_CLEARCOLORIMAGE, "vkCmdClearColorImage()");
         skip_call |= insideRenderPass(dev_data, cb_node, "vkCmdClearColorImage()");
@@ -7646,7 +8091,7 @@ CmdClearDepthStencilImage(VkCommandBuffer commandBuffer, VkImage image, VkImageL
                           const VkImageSubresourceRange *pRanges) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     // TODO : Verify memory is in VK_IMAGE_STATE_CLEAR state
 
     auto cb_node = getCBNode(dev_data, commandBuffer);
@@ -7654,11 +8099,7 @@ CmdClearDepthStencilImage(VkCommandBuffer commandBuffer, VkImage image, VkImageL
     if (cb_node && img_node) {
         skip_call |= ValidateMemoryIsBoundToImage(dev_data, img_node, "vkCmdClearDepthStencilImage()");
         skip_call |= addCommandBufferBindingImage(dev_data, cb_node, img_node, "vkCmdClearDepthStencilImage()");
-        std::function<bool()> function = [=]() {
-            set_memory_valid(dev_data, img_node->mem, true, image);
-            return false;
-        };
-        cb_node->validate_functions.push_back(function);
+        addSetMemoryValidOp(cb_node, img_node->mem, true, image);
 
         skip_call |= addCmd(dev_data, cb_node, CMD_CLEARDEPTHSTENCILIMAGE, "vkCmdClearDepthStencilImage()");
         skip_call |= insideRenderPass(dev_data, cb_node, "vkCmdClearDepthStencilImage()");
@@ -7676,7 +8117,7 @@ CmdResolveImage(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout s
                 VkImageLayout dstImageLayout, uint32_t regionCount, const VkImageResolve *pRegions) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
 
     auto cb_node = getCBNode(dev_data, commandBuffer);
     auto src_img_node = getImageNode(dev_data, srcImage);
@@ -7687,15 +8128,8 @@ CmdResolveImage(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout s
         // Update bindings between images and cmd buffer
         skip_call |= addCommandBufferBindingImage(dev_data, cb_node, src_img_node, "vkCmdCopyImage()");
         skip_call |= addCommandBufferBindingImage(dev_data, cb_node, dst_img_node, "vkCmdCopyImage()");
-        std::function<bool()> function = [=]() {
-            return validate_memory_is_valid(dev_data, src_img_node->mem, "vkCmdResolveImage()", srcImage);
-        };
-        cb_node->validate_functions.push_back(function);
-        function = [=]() {
-            set_memory_valid(dev_data, dst_img_node->mem, true, dstImage);
-            return false;
-        };
-        cb_node->validate_functions.push_back(function);
+        addValidateMemoryOp(cb_node, src_img_node->mem, "vkCmdResolveImage()", srcImage);
+        addSetMemoryValidOp(cb_node, dst_img_node->mem, true, dstImage);
 
         skip_call |= addCmd(dev_data, cb_node, CMD_RESOLVEIMAGE, "vkCmdResolveImage()");
         skip_call |= insideRenderPass(dev_data, cb_node, "vkCmdResolveImage()");
@@ -7725,7 +8159,7 @@ VKAPI_ATTR void VKAPI_CALL
 CmdSetEvent(VkCommandBuffer commandBuffer, VkEvent event, VkPipelineStageFlags stageMask) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         skip_call |= addCmd(dev_data, pCB, CMD_SETEVENT, "vkCmdSetEvent()");
@@ -7740,9 +8174,7 @@ CmdSetEvent(VkCommandBuffer commandBuffer, VkEvent event, VkPipelineStageFlags s
         if (!pCB->waitedEvents.count(event)) {
             pCB->writeEventsBeforeWait.push_back(event);
         }
-        std::function<bool(VkQueue)> eventUpdate =
-            std::bind(setEventStageMask, std::placeholders::_1, commandBuffer, event, stageMask);
-        pCB->eventUpdates.push_back(eventUpdate);
+        addSetEventStageMaskOp(pCB, event, stageMask);
     }
     lock.unlock();
     if (!skip_call)
@@ -7753,7 +8185,7 @@ VKAPI_ATTR void VKAPI_CALL
 CmdResetEvent(VkCommandBuffer commandBuffer, VkEvent event, VkPipelineStageFlags stageMask) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         skip_call |= addCmd(dev_data, pCB, CMD_RESETEVENT, "vkCmdResetEvent()");
@@ -7768,9 +8200,7 @@ CmdResetEvent(VkCommandBuffer commandBuffer, VkEvent event, VkPipelineStageFlags
         if (!pCB->waitedEvents.count(event)) {
             pCB->writeEventsBeforeWait.push_back(event);
         }
-        std::function<bool(VkQueue)> eventUpdate =
-            std::bind(setEventStageMask, std::placeholders::_1, commandBuffer, event, VkPipelineStageFlags(0));
-        pCB->eventUpdates.push_back(eventUpdate);
+        addSetEventStageMaskOp(pCB, event, VkPipelineStageFlags(0));
     }
     lock.unlock();
     if (!skip_call)
@@ -7782,39 +8212,25 @@ static bool TransitionImageLayouts(VkCommandBuffer cmdBuffer, uint32_t memBarrie
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(cmdBuffer), layer_data_map);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, cmdBuffer);
     bool skip = false;
-    uint32_t levelCount = 0;
-    uint32_t layerCount = 0;
 
     for (uint32_t i = 0; i < memBarrierCount; ++i) {
         auto mem_barrier = &pImgMemBarriers[i];
         if (!mem_barrier)
             continue;
-        // TODO: Do not iterate over every possibility - consolidate where
-        // possible
-        ResolveRemainingLevelsLayers(dev_data, &levelCount, &layerCount, mem_barrier->subresourceRange, mem_barrier->image);
-
-        for (uint32_t j = 0; j < levelCount; j++) {
-            uint32_t level = mem_barrier->subresourceRange.baseMipLevel + j;
-            for (uint32_t k = 0; k < layerCount; k++) {
-                uint32_t layer = mem_barrier->subresourceRange.baseArrayLayer + k;
-                VkImageSubresource sub = {mem_barrier->subresourceRange.aspectMask, level, layer};
-                IMAGE_CMD_BUF_LAYOUT_NODE node;
-                if (!FindLayout(pCB, mem_barrier->image, sub, node)) {
-                    SetLayout(pCB, mem_barrier->image, sub,
-                              IMAGE_CMD_BUF_LAYOUT_NODE(mem_barrier->oldLayout, mem_barrier->newLayout));
-                    continue;
-                }
-                if (mem_barrier->oldLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
-                    // TODO: Set memory invalid which is in mem_tracker currently
-                } else if (node.layout != mem_barrier->oldLayout) {
-                    skip |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT)0, 0,
-                                    __LINE__, DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS", "You cannot transition the layout from %s "
-                                                                                    "when current layout is %s.",
-                                    string_VkImageLayout(mem_barrier->oldLayout), string_VkImageLayout(node.layout));
-                }
-                SetLayout(pCB, mem_barrier->image, sub, mem_barrier->newLayout);
+        UpdateCBLayouts(dev_data, pCB, mem_barrier->image, mem_barrier->subresourceRange,
+                        [&](const IMAGE_CMD_BUF_LAYOUT_NODE *node) -> IMAGE_CMD_BUF_LAYOUT_NODE {
+            if (!node)
+                return IMAGE_CMD_BUF_LAYOUT_NODE(mem_barrier->oldLayout, mem_barrier->newLayout);
+            if (mem_barrier->oldLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
+                // TODO: Set memory invalid which is in mem_tracker currently
+            } else if (node->layout != mem_barrier->oldLayout) {
+                skip |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT)0, 0,
+                                __LINE__, DRAWSTATE_INVALID_IMAGE_LAYOUT, "DS", "You cannot transition the layout from %s "
+                                                                                "when current layout is %s.",
+                                string_VkImageLayout(mem_barrier->oldLayout), string_VkImageLayout(node->layout));
             }
-        }
+            return IMAGE_CMD_BUF_LAYOUT_NODE(node->initialLayout, mem_barrier->newLayout);
+        });
     }
     return skip;
 }
@@ -8152,7 +8568,7 @@ CmdWaitEvents(VkCommandBuffer commandBuffer, uint32_t eventCount, const VkEvent
               uint32_t imageMemoryBarrierCount, const VkImageMemoryBarrier *pImageMemoryBarriers) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         auto firstEventIndex = pCB->events.size();
@@ -8167,9 +8583,7 @@ CmdWaitEvents(VkCommandBuffer commandBuffer, uint32_t eventCount, const VkEvent
             pCB->waitedEvents.insert(pEvents[i]);
             pCB->events.push_back(pEvents[i]);
         }
-        std::function<bool(VkQueue)> eventUpdate =
-            std::bind(validateEventStageMask, std::placeholders::_1, pCB, eventCount, firstEventIndex, sourceStageMask);
-        pCB->eventUpdates.push_back(eventUpdate);
+        addValidateEventStageMaskOp(pCB, eventCount, firstEventIndex, sourceStageMask);
         if (pCB->state == CB_RECORDING) {
             skip_call |= addCmd(dev_data, pCB, CMD_WAITEVENTS, "vkCmdWaitEvents()");
         } else {
@@ -8194,7 +8608,7 @@ CmdPipelineBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStageM
                    uint32_t imageMemoryBarrierCount, const VkImageMemoryBarrier *pImageMemoryBarriers) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         skip_call |= addCmd(dev_data, pCB, CMD_PIPELINEBARRIER, "vkCmdPipelineBarrier()");
@@ -8227,7 +8641,7 @@ VKAPI_ATTR void VKAPI_CALL
 CmdBeginQuery(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t slot, VkFlags flags) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         QueryObject query = {queryPool, slot};
@@ -8247,7 +8661,7 @@ CmdBeginQuery(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t slo
 VKAPI_ATTR void VKAPI_CALL CmdEndQuery(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t slot) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         QueryObject query = {queryPool, slot};
@@ -8259,8 +8673,7 @@ VKAPI_ATTR void VKAPI_CALL CmdEndQuery(VkCommandBuffer commandBuffer, VkQueryPoo
         } else {
             pCB->activeQueries.erase(query);
         }
-        std::function<bool(VkQueue)> queryUpdate = std::bind(setQueryState, std::placeholders::_1, commandBuffer, query, true);
-        pCB->queryUpdates.push_back(queryUpdate);
+        addSetQueryStateOp(pCB, query, true);
         if (pCB->state == CB_RECORDING) {
             skip_call |= addCmd(dev_data, pCB, CMD_ENDQUERY, "VkCmdEndQuery()");
         } else {
@@ -8278,14 +8691,13 @@ VKAPI_ATTR void VKAPI_CALL
 CmdResetQueryPool(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         for (uint32_t i = 0; i < queryCount; i++) {
             QueryObject query = {queryPool, firstQuery + i};
             pCB->waitedEventsBeforeQueryReset[query] = pCB->waitedEvents;
-            std::function<bool(VkQueue)> queryUpdate = std::bind(setQueryState, std::placeholders::_1, commandBuffer, query, false);
-            pCB->queryUpdates.push_back(queryUpdate);
+            addSetQueryStateOp(pCB, query, false);
         }
         if (pCB->state == CB_RECORDING) {
             skip_call |= addCmd(dev_data, pCB, CMD_RESETQUERYPOOL, "VkCmdResetQueryPool()");
@@ -8340,7 +8752,7 @@ CmdCopyQueryPoolResults(VkCommandBuffer commandBuffer, VkQueryPool queryPool, ui
                         VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize stride, VkQueryResultFlags flags) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
 
     auto cb_node = getCBNode(dev_data, commandBuffer);
     auto dst_buff_node = getBufferNode(dev_data, dstBuffer);
@@ -8351,14 +8763,8 @@ CmdCopyQueryPoolResults(VkCommandBuffer commandBuffer, VkQueryPool queryPool, ui
         // Validate that DST buffer has correct usage flags set
         skip_call |= validateBufferUsageFlags(dev_data, dst_buff_node, VK_BUFFER_USAGE_TRANSFER_DST_BIT, true,
                                               "vkCmdCopyQueryPoolResults()", "VK_BUFFER_USAGE_TRANSFER_DST_BIT");
-        std::function<bool()> function = [=]() {
-            set_memory_valid(dev_data, dst_buff_node->mem, true);
-            return false;
-        };
-        cb_node->validate_functions.push_back(function);
-        std::function<bool(VkQueue)> queryUpdate =
-            std::bind(validateQuery, std::placeholders::_1, cb_node, queryPool, queryCount, firstQuery);
-        cb_node->queryUpdates.push_back(queryUpdate);
+        addSetMemoryValidOp(cb_node, dst_buff_node->mem, true);
+        addValidateQueryOp(cb_node, queryPool, firstQuery, queryCount);
         if (cb_node->state == CB_RECORDING) {
             skip_call |= addCmd(dev_data, cb_node, CMD_COPYQUERYPOOLRESULTS, "vkCmdCopyQueryPoolResults()");
         } else {
@@ -8381,7 +8787,7 @@ VKAPI_ATTR void VKAPI_CALL CmdPushConstants(VkCommandBuffer commandBuffer, VkPip
                                             const void *pValues) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    cb_record_lock lock(dev_data, commandBuffer);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         if (pCB->state == CB_RECORDING) {
@@ -8477,12 +8883,11 @@ VKAPI_ATTR void VKAPI_CALL
 CmdWriteTimestamp(VkCommandBuffer commandBuffer, VkPipelineStageFlagBits pipelineStage, VkQueryPool queryPool, uint32_t slot) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         QueryObject query = {queryPool, slot};
-        std::function<bool(VkQueue)> queryUpdate = std::bind(setQueryState, std::placeholders::_1, commandBuffer, query, true);
-        pCB->queryUpdates.push_back(queryUpdate);
+        addSetQueryStateOp(pCB, query, true);
         if (pCB->state == CB_RECORDING) {
             skip_call |= addCmd(dev_data, pCB, CMD_WRITETIMESTAMP, "vkCmdWriteTimestamp()");
         } else {
@@ -8687,7 +9092,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateFramebuffer(VkDevice device, const VkFrameb
                                                  const VkAllocationCallbacks *pAllocator,
                                                  VkFramebuffer *pFramebuffer) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     bool skip_call = PreCallValidateCreateFramebuffer(dev_data, pCreateInfo);
     lock.unlock();
 
@@ -9084,7 +9489,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateShaderModule(VkDevice device, const VkShade
     VkResult res = my_data->device_dispatch_table->CreateShaderModule(device, pCreateInfo, pAllocator, pShaderModule);
 
     if (res == VK_SUCCESS) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<sharded_mutex> lock(global_lock);
         my_data->shaderModuleMap[*pShaderModule] = unique_ptr<shader_module>(new shader_module(pCreateInfo));
     }
     return res;
@@ -9194,7 +9599,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateRenderPass(VkDevice device, const VkRenderP
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
 
     skip_call |= ValidateLayouts(dev_data, device, pCreateInfo);
     // TODO: As part of wrapping up the mem_tracker/core_validation merge the following routine should be consolidated with
@@ -9353,35 +9758,25 @@ static bool VerifyFramebufferAndRenderPassLayouts(layer_data *dev_data, GLOBAL_C
         const VkImageView &image_view = framebufferInfo.pAttachments[i];
         auto image_data = getImageViewData(dev_data, image_view);
         assert(image_data);
-        const VkImage &image = image_data->image;
-        const VkImageSubresourceRange &subRange = image_data->subresourceRange;
         IMAGE_CMD_BUF_LAYOUT_NODE newNode = {pRenderPassInfo->pAttachments[i].initialLayout,
                                              pRenderPassInfo->pAttachments[i].initialLayout};
-        // TODO: Do not iterate over every possibility - consolidate where possible
-        for (uint32_t j = 0; j < subRange.levelCount; j++) {
-            uint32_t level = subRange.baseMipLevel + j;
-            for (uint32_t k = 0; k < subRange.layerCount; k++) {
-                uint32_t layer = subRange.baseArrayLayer + k;
-                VkImageSubresource sub = {subRange.aspectMask, level, layer};
-                IMAGE_CMD_BUF_LAYOUT_NODE node;
-                if (!FindLayout(pCB, image, sub, node)) {
-                    SetLayout(pCB, image, sub, newNode);
-                    continue;
-                }
-                if (newNode.layout != VK_IMAGE_LAYOUT_UNDEFINED &&
-                    newNode.layout != node.layout) {
-                    skip_call |=
-                        log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT)0, 0, __LINE__,
-                                DRAWSTATE_INVALID_RENDERPASS, "DS",
-                                "You cannot start a render pass using attachment %u "
-                                "where the render pass initial layout is %s and the previous "
-                                "known layout of the attachment is %s. The layouts must match, or "
-                                "the render pass initial layout for the attachment must be "
-                                "VK_IMAGE_LAYOUT_UNDEFINED",
-                                i, string_VkImageLayout(newNode.layout), string_VkImageLayout(node.layout));
-                }
+        UpdateCBLayouts(dev_data, pCB, image_data->image, image_data->subresourceRange,
+                        [&](const IMAGE_CMD_BUF_LAYOUT_NODE *node) -> IMAGE_CMD_BUF_LAYOUT_NODE {
+            if (!node)
+                return newNode;
+            if (newNode.layout != VK_IMAGE_LAYOUT_UNDEFINED && newNode.layout != node->layout) {
+                skip_call |=
+                    log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, (VkDebugReportObjectTypeEXT)0, 0, __LINE__,
+                            DRAWSTATE_INVALID_RENDERPASS, "DS",
+                            "You cannot start a render pass using attachment %u "
+                            "where the render pass initial layout is %s and the previous "
+                            "known layout of the attachment is %s. The layouts must match, or "
+                            "the render pass initial layout for the attachment must be "
+                            "VK_IMAGE_LAYOUT_UNDEFINED",
+                            i, string_VkImageLayout(newNode.layout), string_VkImageLayout(node->layout));
             }
-        }
+            return *node;
+        });
     }
     return skip_call;
 }
@@ -9481,7 +9876,7 @@ VKAPI_ATTR void VKAPI_CALL
 CmdBeginRenderPass(VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo *pRenderPassBegin, VkSubpassContents contents) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     auto renderPass = pRenderPassBegin ? getRenderPass(dev_data, pRenderPassBegin->renderPass) : nullptr;
     auto framebuffer = pRenderPassBegin ? getFramebuffer(dev_data, pRenderPassBegin->framebuffer) : nullptr;
@@ -9496,32 +9891,18 @@ CmdBeginRenderPass(VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo *p
                                                          renderPass->attachments[i].stencil_load_op,
                                                          VK_ATTACHMENT_LOAD_OP_CLEAR)) {
                     clear_op_size = i + 1;
-                    std::function<bool()> function = [=]() {
-                        set_memory_valid(dev_data, fb_info.mem, true, fb_info.image);
-                        return false;
-                    };
-                    pCB->validate_functions.push_back(function);
+                    addSetMemoryValidOp(pCB, fb_info.mem, true, fb_info.image);
                 } else if (FormatSpecificLoadAndStoreOpSettings(format, renderPass->attachments[i].load_op,
                                                                 renderPass->attachments[i].stencil_load_op,
                                                                 VK_ATTACHMENT_LOAD_OP_DONT_CARE)) {
-                    std::function<bool()> function = [=]() {
-                        set_memory_valid(dev_data, fb_info.mem, false, fb_info.image);
-                        return false;
-                    };
-                    pCB->validate_functions.push_back(function);
+                    addSetMemoryValidOp(pCB, fb_info.mem, false, fb_info.image);
                 } else if (FormatSpecificLoadAndStoreOpSettings(format, renderPass->attachments[i].load_op,
                                                                 renderPass->attachments[i].stencil_load_op,
                                                                 VK_ATTACHMENT_LOAD_OP_LOAD)) {
-                    std::function<bool()> function = [=]() {
-                        return validate_memory_is_valid(dev_data, fb_info.mem, "vkCmdBeginRenderPass()", fb_info.image);
-                    };
-                    pCB->validate_functions.push_back(function);
+                    addValidateMemoryOp(pCB, fb_info.mem, "vkCmdBeginRenderPass()", fb_info.image);
                 }
                 if (renderPass->attachment_first_read[renderPass->attachments[i].attachment]) {
-                    std::function<bool()> function = [=]() {
-                        return validate_memory_is_valid(dev_data, fb_info.mem, "vkCmdBeginRenderPass()", fb_info.image);
-                    };
-                    pCB->validate_functions.push_back(function);
+                    addValidateMemoryOp(pCB, fb_info.mem, "vkCmdBeginRenderPass()", fb_info.image);
                 }
             }
             if (clear_op_size > pRenderPassBegin->clearValueCount) {
@@ -9569,7 +9950,7 @@ CmdBeginRenderPass(VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo *p
 VKAPI_ATTR void VKAPI_CALL CmdNextSubpass(VkCommandBuffer commandBuffer, VkSubpassContents contents) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         skip_call |= validatePrimaryCommandBuffer(dev_data, pCB, "vkCmdNextSubpass");
@@ -9587,7 +9968,7 @@ VKAPI_ATTR void VKAPI_CALL CmdNextSubpass(VkCommandBuffer commandBuffer, VkSubpa
 VKAPI_ATTR void VKAPI_CALL CmdEndRenderPass(VkCommandBuffer commandBuffer) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     auto pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         RENDER_PASS_NODE* pRPNode = pCB->activeRenderPass;
@@ -9598,19 +9979,11 @@ VKAPI_ATTR void VKAPI_CALL CmdEndRenderPass(VkCommandBuffer commandBuffer) {
                 VkFormat format = pRPNode->pCreateInfo->pAttachments[pRPNode->attachments[i].attachment].format;
                 if (FormatSpecificLoadAndStoreOpSettings(format, pRPNode->attachments[i].store_op,
                                                          pRPNode->attachments[i].stencil_store_op, VK_ATTACHMENT_STORE_OP_STORE)) {
-                    std::function<bool()> function = [=]() {
-                        set_memory_valid(dev_data, fb_info.mem, true, fb_info.image);
-                        return false;
-                    };
-                    pCB->validate_functions.push_back(function);
+                    addSetMemoryValidOp(pCB, fb_info.mem, true, fb_info.image);
                 } else if (FormatSpecificLoadAndStoreOpSettings(format, pRPNode->attachments[i].store_op,
                                                                 pRPNode->attachments[i].stencil_store_op,
                                                                 VK_ATTACHMENT_STORE_OP_DONT_CARE)) {
-                    std::function<bool()> function = [=]() {
-                        set_memory_valid(dev_data, fb_info.mem, false, fb_info.image);
-                        return false;
-                    };
-                    pCB->validate_functions.push_back(function);
+                    addSetMemoryValidOp(pCB, fb_info.mem, false, fb_info.image);
                 }
             }
         }
@@ -9828,7 +10201,7 @@ VKAPI_ATTR void VKAPI_CALL
 CmdExecuteCommands(VkCommandBuffer commandBuffer, uint32_t commandBuffersCount, const VkCommandBuffer *pCommandBuffers) {
     bool skip_call = false;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, commandBuffer);
     if (pCB) {
         GLOBAL_CB_NODE *pSubCB = NULL;
@@ -9964,7 +10337,7 @@ MapMemory(VkDevice device, VkDeviceMemory mem, VkDeviceSize offset, VkDeviceSize
 
     bool skip_call = false;
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
 #if MTMERGESOURCE
     DEVICE_MEM_INFO *pMemObj = getMemObjInfo(dev_data, mem);
     if (pMemObj) {
@@ -10000,7 +10373,7 @@ VKAPI_ATTR void VKAPI_CALL UnmapMemory(VkDevice device, VkDeviceMemory mem) {
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skip_call = false;
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     skip_call |= deleteMemRanges(my_data, mem);
     lock.unlock();
     if (!skip_call) {
@@ -10078,7 +10451,7 @@ FlushMappedMemoryRanges(VkDevice device, uint32_t memRangeCount, const VkMappedM
     bool skip_call = false;
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     skip_call |= validateAndCopyNoncoherentMemoryToDriver(my_data, memRangeCount, pMemRanges);
     skip_call |= validateMemoryIsMapped(my_data, "vkFlushMappedMemoryRanges", memRangeCount, pMemRanges);
     lock.unlock();
@@ -10094,7 +10467,7 @@ InvalidateMappedMemoryRanges(VkDevice device, uint32_t memRangeCount, const VkMa
     bool skip_call = false;
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     skip_call |= validateMemoryIsMapped(my_data, "vkInvalidateMappedMemoryRanges", memRangeCount, pMemRanges);
     lock.unlock();
     if (!skip_call) {
@@ -10107,7 +10480,7 @@ VKAPI_ATTR VkResult VKAPI_CALL BindImageMemory(VkDevice device, VkImage image, V
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
     bool skip_call = false;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     auto image_node = getImageNode(dev_data, image);
     if (image_node) {
         // Track objects tied to memory
@@ -10151,7 +10524,7 @@ VKAPI_ATTR VkResult VKAPI_CALL SetEvent(VkDevice device, VkEvent event) {
     bool skip_call = false;
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     auto event_node = getEventNode(dev_data, event);
     if (event_node) {
         event_node->needsSignaled = false;
@@ -10183,7 +10556,7 @@ QueueBindSparse(VkQueue queue, uint32_t bindInfoCount, const VkBindSparseInfo *p
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(queue), layer_data_map);
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
     bool skip_call = false;
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     auto pFence = getFenceNode(dev_data, fence);
     auto pQueue = getQueueNode(dev_data, queue);
 
@@ -10267,7 +10640,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateSemaphore(VkDevice device, const VkSemaphor
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->CreateSemaphore(device, pCreateInfo, pAllocator, pSemaphore);
     if (result == VK_SUCCESS) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<sharded_mutex> lock(global_lock);
         SEMAPHORE_NODE* sNode = &dev_data->semaphoreMap[*pSemaphore];
         sNode->signaled = false;
         sNode->queue = VK_NULL_HANDLE;
@@ -10281,7 +10654,7 @@ CreateEvent(VkDevice device, const VkEventCreateInfo *pCreateInfo, const VkAlloc
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     VkResult result = dev_data->device_dispatch_table->CreateEvent(device, pCreateInfo, pAllocator, pEvent);
     if (result == VK_SUCCESS) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<sharded_mutex> lock(global_lock);
         dev_data->eventMap[*pEvent].needsSignaled = false;
         dev_data->eventMap[*pEvent].in_use.store(0);
         dev_data->eventMap[*pEvent].write_in_use = 0;
@@ -10297,7 +10670,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateSwapchainKHR(VkDevice device, const VkSwapc
     VkResult result = dev_data->device_dispatch_table->CreateSwapchainKHR(device, pCreateInfo, pAllocator, pSwapchain);
 
     if (VK_SUCCESS == result) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<sharded_mutex> lock(global_lock);
         dev_data->device_extensions.swapchainMap[*pSwapchain] = unique_ptr<SWAPCHAIN_NODE>(new SWAPCHAIN_NODE(pCreateInfo));
     }
 
@@ -10309,21 +10682,12 @@ DestroySwapchainKHR(VkDevice device, VkSwapchainKHR swapchain, const VkAllocatio
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skip_call = false;
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     auto swapchain_data = getSwapchainNode(dev_data, swapchain);
     if (swapchain_data) {
         if (swapchain_data->images.size() > 0) {
             for (auto swapchain_image : swapchain_data->images) {
-                auto image_sub = dev_data->imageSubresourceMap.find(swapchain_image);
-                if (image_sub != dev_data->imageSubresourceMap.end()) {
-                    for (auto imgsubpair : image_sub->second) {
-                        auto image_item = dev_data->imageLayoutMap.find(imgsubpair);
-                        if (image_item != dev_data->imageLayoutMap.end()) {
-                            dev_data->imageLayoutMap.erase(image_item);
-                        }
-                    }
-                    dev_data->imageSubresourceMap.erase(image_sub);
-                }
+                dev_data->imageLayoutMap.erase(swapchain_image);
                 skip_call =
                     clear_object_binding(dev_data, (uint64_t)swapchain_image, VK_DEBUG_REPORT_OBJECT_TYPE_SWAPCHAIN_KHR_EXT);
                 dev_data->imageMap.erase(swapchain_image);
@@ -10345,7 +10709,7 @@ GetSwapchainImagesKHR(VkDevice device, VkSwapchainKHR swapchain, uint32_t *pCoun
         // This should never happen and is checked by param checker.
         if (!pCount)
             return result;
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<sharded_mutex> lock(global_lock);
         const size_t count = *pCount;
         auto swapchain_node = getSwapchainNode(dev_data, swapchain);
         if (swapchain_node && !swapchain_node->images.empty()) {
@@ -10362,9 +10726,6 @@ GetSwapchainImagesKHR(VkDevice device, VkSwapchainKHR swapchain, uint32_t *pCoun
             }
         }
         for (uint32_t i = 0; i < *pCount; ++i) {
-            IMAGE_LAYOUT_NODE image_layout_node;
-            image_layout_node.layout = VK_IMAGE_LAYOUT_UNDEFINED;
-            image_layout_node.format = swapchain_node->createInfo.imageFormat;
             // Add imageMap entries for each swapchain image
             VkImageCreateInfo image_ci = {};
             image_ci.mipLevels = 1;
@@ -10380,9 +10741,7 @@ GetSwapchainImagesKHR(VkDevice device, VkSwapchainKHR swapchain, uint32_t *pCoun
             image_node->valid = false;
             image_node->mem = MEMTRACKER_SWAP_CHAIN_IMAGE_KEY;
             swapchain_node->images.push_back(pSwapchainImages[i]);
-            ImageSubresourcePair subpair = {pSwapchainImages[i], false, VkImageSubresource()};
-            dev_data->imageSubresourceMap[pSwapchainImages[i]].push_back(subpair);
-            dev_data->imageLayoutMap[subpair] = image_layout_node;
+            dev_data->imageLayoutMap[pSwapchainImages[i]].set(0, ~uint64_t(0), VK_IMAGE_LAYOUT_UNDEFINED);
             dev_data->device_extensions.imageToSwapchainMap[pSwapchainImages[i]] = swapchain;
         }
     }
@@ -10393,7 +10752,7 @@ VKAPI_ATTR VkResult VKAPI_CALL QueuePresentKHR(VkQueue queue, const VkPresentInf
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(queue), layer_data_map);
     bool skip_call = false;
 
-    std::lock_guard<std::mutex> lock(global_lock);
+    std::lock_guard<sharded_mutex> lock(global_lock);
     for (uint32_t i = 0; i < pPresentInfo->waitSemaphoreCount; ++i) {
         auto pSemaphore = getSemaphoreNode(dev_data, pPresentInfo->pWaitSemaphores[i]);
         if (pSemaphore && !pSemaphore->signaled) {
@@ -10451,7 +10810,7 @@ VKAPI_ATTR VkResult VKAPI_CALL AcquireNextImageKHR(VkDevice device, VkSwapchainK
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skip_call = false;
 
-    std::unique_lock<std::mutex> lock(global_lock);
+    std::unique_lock<sharded_mutex> lock(global_lock);
     auto pSemaphore = getSemaphoreNode(dev_data, semaphore);
     if (pSemaphore && pSemaphore->signaled) {
         skip_call |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_SEMAPHORE_EXT,
@@ -10602,7 +10961,7 @@ CreateDebugReportCallbackEXT(VkInstance instance, const VkDebugReportCallbackCre
     VkLayerInstanceDispatchTable *pTable = my_data->instance_dispatch_table;
     VkResult res = pTable->CreateDebugReportCallbackEXT(instance, pCreateInfo, pAllocator, pMsgCallback);
     if (VK_SUCCESS == res) {
-        std::lock_guard<std::mutex> lock(global_lock);
+        std::lock_guard<sharded_mutex> lock(global_lock);
         res = layer_create_msg_callback(my_data->report_data, false, pCreateInfo, pAllocator, pMsgCallback);
     }
     return res;
@@ -10614,7 +10973,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyDebugReportCallbackEXT(VkInstance instance,
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(instance), layer_data_map);
     VkLayerInstanceDispatchTable *pTable = my_data->instance_dispatch_table;
     pTable->DestroyDebugReportCallbackEXT(instance, msgCallback, pAllocator);
-    std::lock_guard<std::mutex> lock(global_lock);
+    std::lock_guard<sharded_mutex> lock(global_lock);
     layer_destroy_msg_callback(my_data->report_data, msgCallback, pAllocator);
 }
 
@@ -10740,134 +11099,131 @@ intercept_core_instance_command(const char *name) {
 
 static PFN_vkVoidFunction
 intercept_core_device_command(const char *name) {
+    // sorted by name for layer_find_sorted_command
     static const struct {
         const char *name;
         PFN_vkVoidFunction proc;
     } core_device_commands[] = {
-        {"vkGetDeviceProcAddr", reinterpret_cast<PFN_vkVoidFunction>(GetDeviceProcAddr)},
-        {"vkQueueSubmit", reinterpret_cast<PFN_vkVoidFunction>(QueueSubmit)},
-        {"vkWaitForFences", reinterpret_cast<PFN_vkVoidFunction>(WaitForFences)},
-        {"vkGetFenceStatus", reinterpret_cast<PFN_vkVoidFunction>(GetFenceStatus)},
-        {"vkQueueWaitIdle", reinterpret_cast<PFN_vkVoidFunction>(QueueWaitIdle)},
-        {"vkDeviceWaitIdle", reinterpret_cast<PFN_vkVoidFunction>(DeviceWaitIdle)},
-        {"vkGetDeviceQueue", reinterpret_cast<PFN_vkVoidFunction>(GetDeviceQueue)},
-        {"vkDestroyInstance", reinterpret_cast<PFN_vkVoidFunction>(DestroyInstance)},
-        {"vkDestroyDevice", reinterpret_cast<PFN_vkVoidFunction>(DestroyDevice)},
-        {"vkDestroyFence", reinterpret_cast<PFN_vkVoidFunction>(DestroyFence)},
-        {"vkResetFences", reinterpret_cast<PFN_vkVoidFunction>(ResetFences)},
-        {"vkDestroySemaphore", reinterpret_cast<PFN_vkVoidFunction>(DestroySemaphore)},
-        {"vkDestroyEvent", reinterpret_cast<PFN_vkVoidFunction>(DestroyEvent)},
-        {"vkDestroyQueryPool", reinterpret_cast<PFN_vkVoidFunction>(DestroyQueryPool)},
-        {"vkDestroyBuffer", reinterpret_cast<PFN_vkVoidFunction>(DestroyBuffer)},
-        {"vkDestroyBufferView", reinterpret_cast<PFN_vkVoidFunction>(DestroyBufferView)},
-        {"vkDestroyImage", reinterpret_cast<PFN_vkVoidFunction>(DestroyImage)},
-        {"vkDestroyImageView", reinterpret_cast<PFN_vkVoidFunction>(DestroyImageView)},
-        {"vkDestroyShaderModule", reinterpret_cast<PFN_vkVoidFunction>(DestroyShaderModule)},
-        {"vkDestroyPipeline", reinterpret_cast<PFN_vkVoidFunction>(DestroyPipeline)},
-        {"vkDestroyPipelineLayout", reinterpret_cast<PFN_vkVoidFunction>(DestroyPipelineLayout)},
-        {"vkDestroySampler", reinterpret_cast<PFN_vkVoidFunction>(DestroySampler)},
-        {"vkDestroyDescriptorSetLayout", reinterpret_cast<PFN_vkVoidFunction>(DestroyDescriptorSetLayout)},
-        {"vkDestroyDescriptorPool", reinterpret_cast<PFN_vkVoidFunction>(DestroyDescriptorPool)},
-        {"vkDestroyFramebuffer", reinterpret_cast<PFN_vkVoidFunction>(DestroyFramebuffer)},
-        {"vkDestroyRenderPass", reinterpret_cast<PFN_vkVoidFunction>(DestroyRenderPass)},
-        {"vkCreateBuffer", reinterpret_cast<PFN_vkVoidFunction>(CreateBuffer)},
-        {"vkCreateBufferView", reinterpret_cast<PFN_vkVoidFunction>(CreateBufferView)},
-        {"vkCreateImage", reinterpret_cast<PFN_vkVoidFunction>(CreateImage)},
-        {"vkCreateImageView", reinterpret_cast<PFN_vkVoidFunction>(CreateImageView)},
-        {"vkCreateFence", reinterpret_cast<PFN_vkVoidFunction>(CreateFence)},
-        {"vkCreatePipelineCache", reinterpret_cast<PFN_vkVoidFunction>(CreatePipelineCache)},
-        {"vkDestroyPipelineCache", reinterpret_cast<PFN_vkVoidFunction>(DestroyPipelineCache)},
-        {"vkGetPipelineCacheData", reinterpret_cast<PFN_vkVoidFunction>(GetPipelineCacheData)},
-        {"vkMergePipelineCaches", reinterpret_cast<PFN_vkVoidFunction>(MergePipelineCaches)},
-        {"vkCreateGraphicsPipelines", reinterpret_cast<PFN_vkVoidFunction>(CreateGraphicsPipelines)},
-        {"vkCreateComputePipelines", reinterpret_cast<PFN_vkVoidFunction>(CreateComputePipelines)},
-        {"vkCreateSampler", reinterpret_cast<PFN_vkVoidFunction>(CreateSampler)},
-        {"vkCreateDescriptorSetLayout", reinterpret_cast<PFN_vkVoidFunction>(CreateDescriptorSetLayout)},
-        {"vkCreatePipelineLayout", reinterpret_cast<PFN_vkVoidFunction>(CreatePipelineLayout)},
-        {"vkCreateDescriptorPool", reinterpret_cast<PFN_vkVoidFunction>(CreateDescriptorPool)},
-        {"vkResetDescriptorPool", reinterpret_cast<PFN_vkVoidFunction>(ResetDescriptorPool)},
-        {"vkAllocateDescriptorSets", reinterpret_cast<PFN_vkVoidFunction>(AllocateDescriptorSets)},
-        {"vkFreeDescriptorSets", reinterpret_cast<PFN_vkVoidFunction>(FreeDescriptorSets)},
-        {"vkUpdateDescriptorSets", reinterpret_cast<PFN_vkVoidFunction>(UpdateDescriptorSets)},
-        {"vkCreateCommandPool", reinterpret_cast<PFN_vkVoidFunction>(CreateCommandPool)},
-        {"vkDestroyCommandPool", reinterpret_cast<PFN_vkVoidFunction>(DestroyCommandPool)},
-        {"vkResetCommandPool", reinterpret_cast<PFN_vkVoidFunction>(ResetCommandPool)},
-        {"vkCreateQueryPool", reinterpret_cast<PFN_vkVoidFunction>(CreateQueryPool)},
         {"vkAllocateCommandBuffers", reinterpret_cast<PFN_vkVoidFunction>(AllocateCommandBuffers)},
-        {"vkFreeCommandBuffers", reinterpret_cast<PFN_vkVoidFunction>(FreeCommandBuffers)},
+        {"vkAllocateDescriptorSets", reinterpret_cast<PFN_vkVoidFunction>(AllocateDescriptorSets)},
+        {"vkAllocateMemory", reinterpret_cast<PFN_vkVoidFunction>(AllocateMemory)},
         {"vkBeginCommandBuffer", reinterpret_cast<PFN_vkVoidFunction>(BeginCommandBuffer)},
-        {"vkEndCommandBuffer", reinterpret_cast<PFN_vkVoidFunction>(EndCommandBuffer)},
-        {"vkResetCommandBuffer", reinterpret_cast<PFN_vkVoidFunction>(ResetCommandBuffer)},
-        {"vkCmdBindPipeline", reinterpret_cast<PFN_vkVoidFunction>(CmdBindPipeline)},
-        {"vkCmdSetViewport", reinterpret_cast<PFN_vkVoidFunction>(CmdSetViewport)},
-        {"vkCmdSetScissor", reinterpret_cast<PFN_vkVoidFunction>(CmdSetScissor)},
-        {"vkCmdSetLineWidth", reinterpret_cast<PFN_vkVoidFunction>(CmdSetLineWidth)},
-        {"vkCmdSetDepthBias", reinterpret_cast<PFN_vkVoidFunction>(CmdSetDepthBias)},
-        {"vkCmdSetBlendConstants", reinterpret_cast<PFN_vkVoidFunction>(CmdSetBlendConstants)},
-        {"vkCmdSetDepthBounds", reinterpret_cast<PFN_vkVoidFunction>(CmdSetDepthBounds)},
-        {"vkCmdSetStencilCompareMask", reinterpret_cast<PFN_vkVoidFunction>(CmdSetStencilCompareMask)},
-        {"vkCmdSetStencilWriteMask", reinterpret_cast<PFN_vkVoidFunction>(CmdSetStencilWriteMask)},
-        {"vkCmdSetStencilReference", reinterpret_cast<PFN_vkVoidFunction>(CmdSetStencilReference)},
+        {"vkBindBufferMemory", reinterpret_cast<PFN_vkVoidFunction>(BindBufferMemory)},
+        {"vkBindImageMemory", reinterpret_cast<PFN_vkVoidFunction>(BindImageMemory)},
+        {"vkCmdBeginQuery", reinterpret_cast<PFN_vkVoidFunction>(CmdBeginQuery)},
+        {"vkCmdBeginRenderPass", reinterpret_cast<PFN_vkVoidFunction>(CmdBeginRenderPass)},
         {"vkCmdBindDescriptorSets", reinterpret_cast<PFN_vkVoidFunction>(CmdBindDescriptorSets)},
-        {"vkCmdBindVertexBuffers", reinterpret_cast<PFN_vkVoidFunction>(CmdBindVertexBuffers)},
         {"vkCmdBindIndexBuffer", reinterpret_cast<PFN_vkVoidFunction>(CmdBindIndexBuffer)},
-        {"vkCmdDraw", reinterpret_cast<PFN_vkVoidFunction>(CmdDraw)},
-        {"vkCmdDrawIndexed", reinterpret_cast<PFN_vkVoidFunction>(CmdDrawIndexed)},
-        {"vkCmdDrawIndirect", reinterpret_cast<PFN_vkVoidFunction>(CmdDrawIndirect)},
-        {"vkCmdDrawIndexedIndirect", reinterpret_cast<PFN_vkVoidFunction>(CmdDrawIndexedIndirect)},
-        {"vkCmdDispatch", reinterpret_cast<PFN_vkVoidFunction>(CmdDispatch)},
-        {"vkCmdDispatchIndirect", reinterpret_cast<PFN_vkVoidFunction>(CmdDispatchIndirect)},
-        {"vkCmdCopyBuffer", reinterpret_cast<PFN_vkVoidFunction>(CmdCopyBuffer)},
-        {"vkCmdCopyImage", reinterpret_cast<PFN_vkVoidFunction>(CmdCopyImage)},
+        {"vkCmdBindPipeline", reinterpret_cast<PFN_vkVoidFunction>(CmdBindPipeline)},
+        {"vkCmdBindVertexBuffers", reinterpret_cast<PFN_vkVoidFunction>(CmdBindVertexBuffers)},
         {"vkCmdBlitImage", reinterpret_cast<PFN_vkVoidFunction>(CmdBlitImage)},
+        {"vkCmdClearAttachments", reinterpret_cast<PFN_vkVoidFunction>(CmdClearAttachments)},
+        {"vkCmdClearColorImage", reinterpret_cast<PFN_vkVoidFunction>(CmdClearColorImage)},
+        {"vkCmdClearDepthStencilImage", reinterpret_cast<PFN_vkVoidFunction>(CmdClearDepthStencilImage)},
+        {"vkCmdCopyBuffer", reinterpret_cast<PFN_vkVoidFunction>(CmdCopyBuffer)},
         {"vkCmdCopyBufferToImage", reinterpret_cast<PFN_vkVoidFunction>(CmdCopyBufferToImage)},
+        {"vkCmdCopyImage", reinterpret_cast<PFN_vkVoidFunction>(CmdCopyImage)},
         {"vkCmdCopyImageToBuffer", reinterpret_cast<PFN_vkVoidFunction>(CmdCopyImageToBuffer)},
-        {"vkCmdUpdateBuffer", reinterpret_cast<PFN_vkVoidFunction>(CmdUpdateBuffer)},
+        {"vkCmdCopyQueryPoolResults", reinterpret_cast<PFN_vkVoidFunction>(CmdCopyQueryPoolResults)},
+        {"vkCmdDispatch", reinterpret_cast<PFN_vkVoidFunction>(CmdDispatch)},
+        {"vkCmdDispatchIndirect", reinterpret_cast<PFN_vkVoidFunction>(CmdDispatchIndirect)},
+        {"vkCmdDraw", reinterpret_cast<PFN_vkVoidFunction>(CmdDraw)},
+        {"vkCmdDrawIndexed", reinterpret_cast<PFN_vkVoidFunction>(CmdDrawIndexed)},
+        {"vkCmdDrawIndexedIndirect", reinterpret_cast<PFN_vkVoidFunction>(CmdDrawIndexedIndirect)},
+        {"vkCmdDrawIndirect", reinterpret_cast<PFN_vkVoidFunction>(CmdDrawIndirect)},
+        {"vkCmdEndQuery", reinterpret_cast<PFN_vkVoidFunction>(CmdEndQuery)},
+        {"vkCmdEndRenderPass", reinterpret_cast<PFN_vkVoidFunction>(CmdEndRenderPass)},
+        {"vkCmdExecuteCommands", reinterpret_cast<PFN_vkVoidFunction>(CmdExecuteCommands)},
         {"vkCmdFillBuffer", reinterpret_cast<PFN_vkVoidFunction>(CmdFillBuffer)},
-        {"vkCmdClearColorImage", reinterpret_cast<PFN_vkVoidFunction>(CmdClearColorImage)},
-        {"vkCmdClearDepthStencilImage", reinterpret_cast<PFN_vkVoidFunction>(CmdClearDepthStencilImage)},
-        {"vkCmdClearAttachments", reinterpret_cast<PFN_vkVoidFunction>(CmdClearAttachments)},
+        {"vkCmdNextSubpass", reinterpret_cast<PFN_vkVoidFunction>(CmdNextSubpass)},
+        {"vkCmdPipelineBarrier", reinterpret_cast<PFN_vkVoidFunction>(CmdPipelineBarrier)},
+        {"vkCmdPushConstants", reinterpret_cast<PFN_vkVoidFunction>(CmdPushConstants)},
+        {"vkCmdResetEvent", reinterpret_cast<PFN_vkVoidFunction>(CmdResetEvent)},
+        {"vkCmdResetQueryPool", reinterpret_cast<PFN_vkVoidFunction>(CmdResetQueryPool)},
         {"vkCmdResolveImage", reinterpret_cast<PFN_vkVoidFunction>(CmdResolveImage)},
+        {"vkCmdSetBlendConstants", reinterpret_cast<PFN_vkVoidFunction>(CmdSetBlendConstants)},
+        {"vkCmdSetDepthBias", reinterpret_cast<PFN_vkVoidFunction>(CmdSetDepthBias)},
+        {"vkCmdSetDepthBounds", reinterpret_cast<PFN_vkVoidFunction>(CmdSetDepthBounds)},
         {"vkCmdSetEvent", reinterpret_cast<PFN_vkVoidFunction>(CmdSetEvent)},
-        {"vkCmdResetEvent", reinterpret_cast<PFN_vkVoidFunction>(CmdResetEvent)},
+        {"vkCmdSetLineWidth", reinterpret_cast<PFN_vkVoidFunction>(CmdSetLineWidth)},
+        {"vkCmdSetScissor", reinterpret_cast<PFN_vkVoidFunction>(CmdSetScissor)},
+        {"vkCmdSetStencilCompareMask", reinterpret_cast<PFN_vkVoidFunction>(CmdSetStencilCompareMask)},
+        {"vkCmdSetStencilReference", reinterpret_cast<PFN_vkVoidFunction>(CmdSetStencilReference)},
+        {"vkCmdSetStencilWriteMask", reinterpret_cast<PFN_vkVoidFunction>(CmdSetStencilWriteMask)},
+        {"vkCmdSetViewport", reinterpret_cast<PFN_vkVoidFunction>(CmdSetViewport)},
+        {"vkCmdUpdateBuffer", reinterpret_cast<PFN_vkVoidFunction>(CmdUpdateBuffer)},
         {"vkCmdWaitEvents", reinterpret_cast<PFN_vkVoidFunction>(CmdWaitEvents)},
-        {"vkCmdPipelineBarrier", reinterpret_cast<PFN_vkVoidFunction>(CmdPipelineBarrier)},
-        {"vkCmdBeginQuery", reinterpret_cast<PFN_vkVoidFunction>(CmdBeginQuery)},
-        {"vkCmdEndQuery", reinterpret_cast<PFN_vkVoidFunction>(CmdEndQuery)},
-        {"vkCmdResetQueryPool", reinterpret_cast<PFN_vkVoidFunction>(CmdResetQueryPool)},
-        {"vkCmdCopyQueryPoolResults", reinterpret_cast<PFN_vkVoidFunction>(CmdCopyQueryPoolResults)},
-        {"vkCmdPushConstants", reinterpret_cast<PFN_vkVoidFunction>(CmdPushConstants)},
         {"vkCmdWriteTimestamp", reinterpret_cast<PFN_vkVoidFunction>(CmdWriteTimestamp)},
+        {"vkCreateBuffer", reinterpret_cast<PFN_vkVoidFunction>(CreateBuffer)},
+        {"vkCreateBufferView", reinterpret_cast<PFN_vkVoidFunction>(CreateBufferView)},
+        {"vkCreateCommandPool", reinterpret_cast<PFN_vkVoidFunction>(CreateCommandPool)},
+        {"vkCreateComputePipelines", reinterpret_cast<PFN_vkVoidFunction>(CreateComputePipelines)},
+        {"vkCreateDescriptorPool", reinterpret_cast<PFN_vkVoidFunction>(CreateDescriptorPool)},
+        {"vkCreateDescriptorSetLayout", reinterpret_cast<PFN_vkVoidFunction>(CreateDescriptorSetLayout)},
+        {"vkCreateEvent", reinterpret_cast<PFN_vkVoidFunction>(CreateEvent)},
+        {"vkCreateFence", reinterpret_cast<PFN_vkVoidFunction>(CreateFence)},
         {"vkCreateFramebuffer", reinterpret_cast<PFN_vkVoidFunction>(CreateFramebuffer)},
-        {"vkCreateShaderModule", reinterpret_cast<PFN_vkVoidFunction>(CreateShaderModule)},
+        {"vkCreateGraphicsPipelines", reinterpret_cast<PFN_vkVoidFunction>(CreateGraphicsPipelines)},
+        {"vkCreateImage", reinterpret_cast<PFN_vkVoidFunction>(CreateImage)},
+        {"vkCreateImageView", reinterpret_cast<PFN_vkVoidFunction>(CreateImageView)},
+        {"vkCreatePipelineCache", reinterpret_cast<PFN_vkVoidFunction>(CreatePipelineCache)},
+        {"vkCreatePipelineLayout", reinterpret_cast<PFN_vkVoidFunction>(CreatePipelineLayout)},
+        {"vkCreateQueryPool", reinterpret_cast<PFN_vkVoidFunction>(CreateQueryPool)},
         {"vkCreateRenderPass", reinterpret_cast<PFN_vkVoidFunction>(CreateRenderPass)},
-        {"vkCmdBeginRenderPass", reinterpret_cast<PFN_vkVoidFunction>(CmdBeginRenderPass)},
-        {"vkCmdNextSubpass", reinterpret_cast<PFN_vkVoidFunction>(CmdNextSubpass)},
-        {"vkCmdEndRenderPass", reinterpret_cast<PFN_vkVoidFunction>(CmdEndRenderPass)},
-        {"vkCmdExecuteCommands", reinterpret_cast<PFN_vkVoidFunction>(CmdExecuteCommands)},
-        {"vkSetEvent", reinterpret_cast<PFN_vkVoidFunction>(SetEvent)},
-        {"vkMapMemory", reinterpret_cast<PFN_vkVoidFunction>(MapMemory)},
-        {"vkUnmapMemory", reinterpret_cast<PFN_vkVoidFunction>(UnmapMemory)},
+        {"vkCreateSampler", reinterpret_cast<PFN_vkVoidFunction>(CreateSampler)},
+        {"vkCreateSemaphore", reinterpret_cast<PFN_vkVoidFunction>(CreateSemaphore)},
+        {"vkCreateShaderModule", reinterpret_cast<PFN_vkVoidFunction>(CreateShaderModule)},
+        {"vkDestroyBuffer", reinterpret_cast<PFN_vkVoidFunction>(DestroyBuffer)},
+        {"vkDestroyBufferView", reinterpret_cast<PFN_vkVoidFunction>(DestroyBufferView)},
+        {"vkDestroyCommandPool", reinterpret_cast<PFN_vkVoidFunction>(DestroyCommandPool)},
+        {"vkDestroyDescriptorPool", reinterpret_cast<PFN_vkVoidFunction>(DestroyDescriptorPool)},
+        {"vkDestroyDescriptorSetLayout", reinterpret_cast<PFN_vkVoidFunction>(DestroyDescriptorSetLayout)},
+        {"vkDestroyDevice", reinterpret_cast<PFN_vkVoidFunction>(DestroyDevice)},
+        {"vkDestroyEvent", reinterpret_cast<PFN_vkVoidFunction>(DestroyEvent)},
+        {"vkDestroyFence", reinterpret_cast<PFN_vkVoidFunction>(DestroyFence)},
+        {"vkDestroyFramebuffer", reinterpret_cast<PFN_vkVoidFunction>(DestroyFramebuffer)},
+        {"vkDestroyImage", reinterpret_cast<PFN_vkVoidFunction>(DestroyImage)},
+        {"vkDestroyImageView", reinterpret_cast<PFN_vkVoidFunction>(DestroyImageView)},
+        {"vkDestroyInstance", reinterpret_cast<PFN_vkVoidFunction>(DestroyInstance)},
+        {"vkDestroyPipeline", reinterpret_cast<PFN_vkVoidFunction>(DestroyPipeline)},
+        {"vkDestroyPipelineCache", reinterpret_cast<PFN_vkVoidFunction>(DestroyPipelineCache)},
+        {"vkDestroyPipelineLayout", reinterpret_cast<PFN_vkVoidFunction>(DestroyPipelineLayout)},
+        {"vkDestroyQueryPool", reinterpret_cast<PFN_vkVoidFunction>(DestroyQueryPool)},
+        {"vkDestroyRenderPass", reinterpret_cast<PFN_vkVoidFunction>(DestroyRenderPass)},
+        {"vkDestroySampler", reinterpret_cast<PFN_vkVoidFunction>(DestroySampler)},
+        {"vkDestroySemaphore", reinterpret_cast<PFN_vkVoidFunction>(DestroySemaphore)},
+        {"vkDestroyShaderModule", reinterpret_cast<PFN_vkVoidFunction>(DestroyShaderModule)},
+        {"vkDeviceWaitIdle", reinterpret_cast<PFN_vkVoidFunction>(DeviceWaitIdle)},
+        {"vkEndCommandBuffer", reinterpret_cast<PFN_vkVoidFunction>(EndCommandBuffer)},
         {"vkFlushMappedMemoryRanges", reinterpret_cast<PFN_vkVoidFunction>(FlushMappedMemoryRanges)},
-        {"vkInvalidateMappedMemoryRanges", reinterpret_cast<PFN_vkVoidFunction>(InvalidateMappedMemoryRanges)},
-        {"vkAllocateMemory", reinterpret_cast<PFN_vkVoidFunction>(AllocateMemory)},
+        {"vkFreeCommandBuffers", reinterpret_cast<PFN_vkVoidFunction>(FreeCommandBuffers)},
+        {"vkFreeDescriptorSets", reinterpret_cast<PFN_vkVoidFunction>(FreeDescriptorSets)},
         {"vkFreeMemory", reinterpret_cast<PFN_vkVoidFunction>(FreeMemory)},
-        {"vkBindBufferMemory", reinterpret_cast<PFN_vkVoidFunction>(BindBufferMemory)},
         {"vkGetBufferMemoryRequirements", reinterpret_cast<PFN_vkVoidFunction>(GetBufferMemoryRequirements)},
+        {"vkGetDeviceProcAddr", reinterpret_cast<PFN_vkVoidFunction>(GetDeviceProcAddr)},
+        {"vkGetDeviceQueue", reinterpret_cast<PFN_vkVoidFunction>(GetDeviceQueue)},
+        {"vkGetFenceStatus", reinterpret_cast<PFN_vkVoidFunction>(GetFenceStatus)},
         {"vkGetImageMemoryRequirements", reinterpret_cast<PFN_vkVoidFunction>(GetImageMemoryRequirements)},
+        {"vkGetPipelineCacheData", reinterpret_cast<PFN_vkVoidFunction>(GetPipelineCacheData)},
         {"vkGetQueryPoolResults", reinterpret_cast<PFN_vkVoidFunction>(GetQueryPoolResults)},
-        {"vkBindImageMemory", reinterpret_cast<PFN_vkVoidFunction>(BindImageMemory)},
+        {"vkInvalidateMappedMemoryRanges", reinterpret_cast<PFN_vkVoidFunction>(InvalidateMappedMemoryRanges)},
+        {"vkMapMemory", reinterpret_cast<PFN_vkVoidFunction>(MapMemory)},
+        {"vkMergePipelineCaches", reinterpret_cast<PFN_vkVoidFunction>(MergePipelineCaches)},
         {"vkQueueBindSparse", reinterpret_cast<PFN_vkVoidFunction>(QueueBindSparse)},
-        {"vkCreateSemaphore", reinterpret_cast<PFN_vkVoidFunction>(CreateSemaphore)},
-        {"vkCreateEvent", reinterpret_cast<PFN_vkVoidFunction>(CreateEvent)},
+        {"vkQueueSubmit", reinterpret_cast<PFN_vkVoidFunction>(QueueSubmit)},
+        {"vkQueueWaitIdle", reinterpret_cast<PFN_vkVoidFunction>(QueueWaitIdle)},
+        {"vkResetCommandBuffer", reinterpret_cast<PFN_vkVoidFunction>(ResetCommandBuffer)},
+        {"vkResetCommandPool", reinterpret_cast<PFN_vkVoidFunction>(ResetCommandPool)},
+        {"vkResetDescriptorPool", reinterpret_cast<PFN_vkVoidFunction>(ResetDescriptorPool)},
+        {"vkResetFences", reinterpret_cast<PFN_vkVoidFunction>(ResetFences)},
+        {"vkSetEvent", reinterpret_cast<PFN_vkVoidFunction>(SetEvent)},
+        {"vkUnmapMemory", reinterpret_cast<PFN_vkVoidFunction>(UnmapMemory)},
+        {"vkUpdateDescriptorSets", reinterpret_cast<PFN_vkVoidFunction>(UpdateDescriptorSets)},
+        {"vkWaitForFences", reinterpret_cast<PFN_vkVoidFunction>(WaitForFences)},
     };
 
-    for (size_t i = 0; i < ARRAY_SIZE(core_device_commands); i++) {
-        if (!strcmp(core_device_commands[i].name, name))
-            return core_device_commands[i].proc;
-    }
-
-    return nullptr;
+    auto command = layer_find_sorted_command(core_device_commands, name);
+    return command ? command->proc : nullptr;
 }
 
 static PFN_vkVoidFunction
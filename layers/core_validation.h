@@ -120,11 +120,6 @@ struct GENERIC_HEADER {
     const void *pNext;
 };
 
-struct IMAGE_LAYOUT_NODE {
-    VkImageLayout layout;
-    VkFormat format;
-};
-
 class PIPELINE_NODE : public BASE_NODE {
   public:
     VkPipeline pipeline;
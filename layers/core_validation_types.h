@@ -45,7 +45,10 @@
 #endif
 
 #include "vulkan/vulkan.h"
+#include <algorithm>
 #include <atomic>
+#include <map>
+#include <mutex>
 #include <string.h>
 #include <unordered_set>
 #include <unordered_map>
@@ -56,6 +59,7 @@
 namespace cvdescriptorset {
 class DescriptorSetLayout;
 class DescriptorSet;
+class DescriptorArena;
 };
 
 struct GLOBAL_CB_NODE;
@@ -94,10 +98,13 @@ struct DESCRIPTOR_POOL_NODE {
     std::unordered_set<cvdescriptorset::DescriptorSet *> sets; // Collection of all sets in this pool
     std::vector<uint32_t> maxDescriptorTypeCount;              // Max # of descriptors of each type in this pool
     std::vector<uint32_t> availableDescriptorTypeCount;        // Available # of descriptors of each type in this pool
+    // Storage for the descriptors of the sets in this pool, created and freed along with the sets in core_validation.cpp
+    cvdescriptorset::DescriptorArena *descriptor_arena;
 
     DESCRIPTOR_POOL_NODE(const VkDescriptorPool pool, const VkDescriptorPoolCreateInfo *pCreateInfo)
         : pool(pool), maxSets(pCreateInfo->maxSets), availableSets(pCreateInfo->maxSets), createInfo(*pCreateInfo),
-          maxDescriptorTypeCount(VK_DESCRIPTOR_TYPE_RANGE_SIZE, 0), availableDescriptorTypeCount(VK_DESCRIPTOR_TYPE_RANGE_SIZE, 0) {
+          maxDescriptorTypeCount(VK_DESCRIPTOR_TYPE_RANGE_SIZE, 0), availableDescriptorTypeCount(VK_DESCRIPTOR_TYPE_RANGE_SIZE, 0),
+          descriptor_arena(nullptr) {
         if (createInfo.poolSizeCount) { // Shadow type struct from ptr into local struct
             size_t poolSizeCountSize = createInfo.poolSizeCount * sizeof(VkDescriptorPoolSize);
             createInfo.pPoolSizes = new VkDescriptorPoolSize[poolSizeCountSize];
@@ -196,6 +203,52 @@ struct MEMORY_RANGE {
     VkDeviceSize end;
 };
 
+// Ranges of a memory object bound to buffers or to images, indexed for overlap queries
+//  Ranges are bucketed by the highest set bit of (end - start), so a range in bucket b covers no address more than
+//  2^(b+1) - 1 bytes past its start. A query only visits the ranges of each bucket that start within that distance
+//  before it, which for sub-allocated resources is the ranges it overlaps plus a few neighbours, rather than every
+//  range bound to the memory object.
+class MEMORY_RANGE_MAP {
+  public:
+    void insert(const MEMORY_RANGE &range) {
+        auto bucket = getBucket(range);
+        auto it = buckets_[bucket].emplace(range.start, range);
+        handle_map_.emplace(range.handle, std::make_pair(bucket, it));
+    }
+    // Remove a range bound to given handle, if there is one
+    void erase(uint64_t handle) {
+        auto it = handle_map_.find(handle);
+        if (it != handle_map_.end()) {
+            buckets_[it->second.first].erase(it->second.second);
+            handle_map_.erase(it);
+        }
+    }
+    size_t size() const { return handle_map_.size(); }
+    // Call fn for each range sharing at least one byte with [start, end]
+    template <typename Fn> void forEachOverlap(VkDeviceSize start, VkDeviceSize end, Fn fn) const {
+        for (auto &bucket : buckets_) {
+            // Longest distance from start to end of any range in this bucket
+            VkDeviceSize reach = (bucket.first == 63) ? ~VkDeviceSize(0) : (VkDeviceSize(2) << bucket.first) - 1;
+            auto it = bucket.second.lower_bound(start > reach ? start - reach : 0);
+            for (; (it != bucket.second.end()) && (it->first <= end); ++it) {
+                if (it->second.end >= start)
+                    fn(it->second);
+            }
+        }
+    }
+
+  private:
+    typedef std::multimap<VkDeviceSize, MEMORY_RANGE> RangesByStart;
+    static uint32_t getBucket(const MEMORY_RANGE &range) {
+        uint32_t bucket = 0;
+        for (VkDeviceSize span = range.end - range.start; span > 1; span >>= 1)
+            bucket++;
+        return bucket;
+    }
+    std::map<uint32_t, RangesByStart> buckets_;
+    std::unordered_multimap<uint64_t, std::pair<uint32_t, RangesByStart::iterator>> handle_map_;
+};
+
 // Data struct for tracking memory object
 struct DEVICE_MEM_INFO {
     void *object; // Dispatchable object used to create this memory (device of swapchain)
@@ -206,8 +259,8 @@ struct DEVICE_MEM_INFO {
     VkMemoryAllocateInfo allocInfo;
     std::unordered_set<MT_OBJ_HANDLE_TYPE> objBindings;        // objects bound to this memory
     std::unordered_set<VkCommandBuffer> commandBufferBindings; // cmd buffers referencing this memory
-    std::vector<MEMORY_RANGE> bufferRanges;
-    std::vector<MEMORY_RANGE> imageRanges;
+    MEMORY_RANGE_MAP bufferRanges;
+    MEMORY_RANGE_MAP imageRanges;
     VkImage image; // If memory is bound to image, this will have VkImage handle, else VK_NULL_HANDLE
     MemRange memRange;
     void *pData, *pDriverData;
@@ -247,10 +300,101 @@ class IMAGE_CMD_BUF_LAYOUT_NODE {
     IMAGE_CMD_BUF_LAYOUT_NODE(VkImageLayout initialLayoutInput, VkImageLayout layoutInput)
         : initialLayout(initialLayoutInput), layout(layoutInput) {}
 
+    bool operator==(const IMAGE_CMD_BUF_LAYOUT_NODE &rh) const { return initialLayout == rh.initialLayout && layout == rh.layout; }
+
     VkImageLayout initialLayout;
     VkImageLayout layout;
 };
 
+// Per-subresource state of one image, stored as runs of equal value
+//  Subresources are keyed by aspect, then mip level, then array layer (see key()). Within an aspect the keys of an image's
+//  subresources are dense, so a range that covers every layer of consecutive levels is one span of keys, a whole image
+//  is one run per aspect, and a value set over adjacent keys is kept as a single run. Keys past the image's last
+//  subresource are never part of a range, so their value does not matter.
+template <typename T> class IMAGE_LAYOUT_RANGE_MAP {
+  public:
+    static const uint64_t SUBRESOURCE_MASK = (uint64_t(1) << 56) - 1;
+    static uint64_t key(uint32_t aspect_index, uint32_t level, uint32_t layer, uint32_t array_layers) {
+        return (uint64_t(aspect_index) << 56) | (uint64_t(level) * array_layers + layer);
+    }
+    static uint32_t keyAspectIndex(uint64_t key) { return uint32_t(key >> 56); }
+    static uint32_t keyLevel(uint64_t key, uint32_t array_layers) { return uint32_t((key & SUBRESOURCE_MASK) / array_layers); }
+    static uint32_t keyLayer(uint64_t key, uint32_t array_layers) { return uint32_t((key & SUBRESOURCE_MASK) % array_layers); }
+
+    bool empty() const { return runs_.empty(); }
+    size_t size() const { return runs_.size(); }
+    // Value at key, or nullptr if it has never been set
+    const T *find(uint64_t key) const {
+        auto it = runs_.upper_bound(key);
+        if (it == runs_.begin())
+            return nullptr;
+        --it;
+        return (key <= it->second.end) ? &it->second.value : nullptr;
+    }
+    // Call fn(begin, end, value) for each piece of [begin, end] in key order, with a null value for keys never set
+    template <typename Fn> void forEach(uint64_t begin, uint64_t end, Fn fn) const {
+        auto it = runs_.upper_bound(begin);
+        if (it != runs_.begin() && std::prev(it)->second.end >= begin)
+            --it;
+        uint64_t pos = begin;
+        for (; (it != runs_.end()) && (it->first <= end); ++it) {
+            if (it->first > pos) {
+                fn(pos, it->first - 1, static_cast<const T *>(nullptr));
+                pos = it->first;
+            }
+            uint64_t piece_end = std::min(it->second.end, end);
+            fn(pos, piece_end, &it->second.value);
+            if (piece_end == end)
+                return;
+            pos = piece_end + 1;
+        }
+        fn(pos, end, static_cast<const T *>(nullptr));
+    }
+    // Set every key in [begin, end] to value
+    void set(uint64_t begin, uint64_t end, const T &value) {
+        // Trim a run that starts before begin, keeping any part of it past end
+        auto it = runs_.lower_bound(begin);
+        if (it != runs_.begin()) {
+            auto prev = std::prev(it);
+            if (prev->second.end >= begin) {
+                RUN tail = prev->second;
+                prev->second.end = begin - 1;
+                if (tail.end > end)
+                    it = runs_.emplace_hint(it, end + 1, tail);
+            }
+        }
+        // Drop the runs that start inside the range, keeping any part past end
+        while ((it != runs_.end()) && (it->first <= end)) {
+            RUN tail = it->second;
+            it = runs_.erase(it);
+            if (tail.end > end) {
+                it = runs_.emplace_hint(it, end + 1, tail);
+                break;
+            }
+        }
+        // Insert, merging with equal neighbours
+        if ((it != runs_.end()) && (end != ~uint64_t(0)) && (it->first == end + 1) && (it->second.value == value)) {
+            end = it->second.end;
+            it = runs_.erase(it);
+        }
+        if (it != runs_.begin()) {
+            auto prev = std::prev(it);
+            if ((prev->second.end + 1 == begin) && (prev->second.value == value)) {
+                prev->second.end = end;
+                return;
+            }
+        }
+        runs_.emplace_hint(it, begin, RUN{end, value});
+    }
+
+  private:
+    struct RUN {
+        uint64_t end;
+        T value;
+    };
+    std::map<uint64_t, RUN> runs_;
+};
+
 struct MT_PASS_ATTACHMENT_INFO {
     uint32_t attachment;
     VkAttachmentLoadOp load_op;
@@ -406,35 +550,6 @@ template <> struct hash<QueryObject> {
 }
 struct DRAW_DATA { std::vector<VkBuffer> buffers; };
 
-struct ImageSubresourcePair {
-    VkImage image;
-    bool hasSubresource;
-    VkImageSubresource subresource;
-};
-
-inline bool operator==(const ImageSubresourcePair &img1, const ImageSubresourcePair &img2) {
-    if (img1.image != img2.image || img1.hasSubresource != img2.hasSubresource)
-        return false;
-    return !img1.hasSubresource ||
-           (img1.subresource.aspectMask == img2.subresource.aspectMask && img1.subresource.mipLevel == img2.subresource.mipLevel &&
-            img1.subresource.arrayLayer == img2.subresource.arrayLayer);
-}
-
-namespace std {
-template <> struct hash<ImageSubresourcePair> {
-    size_t operator()(ImageSubresourcePair img) const throw() {
-        size_t hashVal = hash<uint64_t>()(reinterpret_cast<uint64_t &>(img.image));
-        hashVal ^= hash<bool>()(img.hasSubresource);
-        if (img.hasSubresource) {
-            hashVal ^= hash<uint32_t>()(reinterpret_cast<uint32_t &>(img.subresource.aspectMask));
-            hashVal ^= hash<uint32_t>()(img.subresource.mipLevel);
-            hashVal ^= hash<uint32_t>()(img.subresource.arrayLayer);
-        }
-        return hashVal;
-    }
-};
-}
-
 // Store layouts and pushconstants for PipelineLayout
 struct PIPELINE_LAYOUT_NODE {
     VkPipelineLayout layout;
@@ -470,6 +585,91 @@ struct LAST_BOUND_STATE {
         dynamicOffsets.clear();
     }
 };
+// Draw-time state in which a descriptor set was validated without error. Draws that find the same state skip revalidating it.
+struct VALIDATED_SET_STATE {
+    std::unordered_set<uint32_t> const *bindings; // active bindings of the pipeline the set was validated for
+    uint64_t set_generation;                      // DescriptorSet::GetGeneration() at validation
+    uint64_t resource_generation;                 // device's resource_generation at validation
+    std::vector<uint32_t> dynamic_offsets;
+};
+// A command recorded while the deferred_validation setting is on, validated later by the thread that next takes
+//  exclusive access to device state. Array arguments are stored in the DEFERRED_CMD_LOG array the command uses.
+struct DEFERRED_CMD {
+    CMD_TYPE type;
+    VkPipelineBindPoint bind_point;
+    uint64_t handle; // pipeline, pipeline layout or buffer
+    VkDeviceSize offset;
+    VkIndexType index_type;
+    float line_width;
+    uint32_t first;      // firstSet, firstBinding, firstViewport or firstScissor
+    uint32_t count;      // setCount, bindingCount, viewportCount or scissorCount
+    uint32_t first_data; // index of the command's first array element
+    uint32_t dynamic_offset_count;
+    uint32_t first_dynamic_offset;
+};
+
+// Work that a command recorded into a command buffer does each time the command buffer is submitted. Ops are
+//  stored by value in the command buffer's submit_ops, whose storage is kept across resets and reused.
+enum CB_SUBMIT_OP_TYPE {
+    // Memory ops come first, so that they can be told apart with a single compare
+    CB_SUBMIT_OP_VALIDATE_MEMORY,  // report a read of memory (or swapchain image) without valid contents
+    CB_SUBMIT_OP_SET_MEMORY_VALID, // mark memory (or swapchain image) contents valid or undefined
+    CB_SUBMIT_OP_SET_EVENT_STAGE_MASK,
+    CB_SUBMIT_OP_VALIDATE_EVENT_STAGE_MASK,
+    CB_SUBMIT_OP_SET_QUERY_STATE,
+    CB_SUBMIT_OP_VALIDATE_QUERY,
+};
+
+struct CB_SUBMIT_OP {
+    CB_SUBMIT_OP_TYPE type;
+    union {
+        // VALIDATE_MEMORY and SET_MEMORY_VALID
+        struct {
+            VkDeviceMemory mem;
+            VkImage image;
+            const char *func_name; // VALIDATE_MEMORY
+            bool valid;            // SET_MEMORY_VALID
+        } memory;
+        // SET_EVENT_STAGE_MASK
+        struct {
+            VkEvent event;
+            VkPipelineStageFlags stage_mask;
+        } event;
+        // VALIDATE_EVENT_STAGE_MASK, for event_count of the command buffer's events starting at first_event_index
+        struct {
+            size_t first_event_index;
+            uint32_t event_count;
+            VkPipelineStageFlags src_stage_mask;
+        } wait;
+        // SET_QUERY_STATE, and VALIDATE_QUERY for count queries starting at index
+        struct {
+            VkQueryPool pool;
+            uint32_t index;
+            uint32_t count;
+            bool available;
+        } query;
+    };
+};
+
+struct DEFERRED_CMD_LOG {
+    std::vector<DEFERRED_CMD> cmds;
+    std::vector<VkDescriptorSet> descriptor_sets;
+    std::vector<uint32_t> dynamic_offsets;
+    std::vector<VkBuffer> buffers;
+    std::vector<VkViewport> viewports;
+    std::vector<VkRect2D> scissors;
+    bool queued = false; // on the list of logs waiting to be validated
+
+    void clear() {
+        cmds.clear();
+        descriptor_sets.clear();
+        dynamic_offsets.clear();
+        buffers.clear();
+        viewports.clear();
+        scissors.clear();
+    }
+};
+
 // Cmd Buffer Wrapper Struct - TODO : This desperately needs its own class
 struct GLOBAL_CB_NODE : public BASE_NODE {
     VkCommandBuffer commandBuffer;
@@ -509,8 +709,7 @@ struct GLOBAL_CB_NODE : public BASE_NODE {
     std::unordered_map<QueryObject, bool> queryToStateMap; // 0 is unavailable, 1 is available
     std::unordered_set<QueryObject> activeQueries;
     std::unordered_set<QueryObject> startedQueries;
-    std::unordered_map<ImageSubresourcePair, IMAGE_CMD_BUF_LAYOUT_NODE> imageLayoutMap;
-    std::unordered_map<VkImage, std::vector<ImageSubresourcePair>> imageSubresourceMap;
+    std::unordered_map<VkImage, IMAGE_LAYOUT_RANGE_MAP<IMAGE_CMD_BUF_LAYOUT_NODE>> imageLayoutMap;
     std::unordered_map<VkEvent, VkPipelineStageFlags> eventToStageMap;
     std::vector<DRAW_DATA> drawData;
     DRAW_DATA currentDrawData;
@@ -518,14 +717,17 @@ struct GLOBAL_CB_NODE : public BASE_NODE {
     // Track images and buffers that are updated by this CB at the point of a draw
     std::unordered_set<VkImageView> updateImages;
     std::unordered_set<VkBuffer> updateBuffers;
+    // States each bound descriptor set has been validated in at draw time
+    std::unordered_map<cvdescriptorset::DescriptorSet *, std::vector<VALIDATED_SET_STATE>> validated_sets;
     // If cmd buffer is primary, track secondary command buffers pending
     // execution
     std::unordered_set<VkCommandBuffer> secondaryCommandBuffers;
     // MTMTODO : Scrub these data fields and merge active sets w/ lastBound as appropriate
-    std::vector<std::function<bool()>> validate_functions;
+    std::vector<CB_SUBMIT_OP> submit_ops;
     std::unordered_set<VkDeviceMemory> memObjs;
-    std::vector<std::function<bool(VkQueue)>> eventUpdates;
-    std::vector<std::function<bool(VkQueue)>> queryUpdates;
+    DEFERRED_CMD_LOG deferred_log;
+    // Held while recording into this CB so that recording on separate CBs doesn't need exclusive access to device state
+    std::mutex record_lock;
 
     ~GLOBAL_CB_NODE();
 };
@@ -21,6 +21,7 @@
 #include "descriptor_sets.h"
 #include "vk_enum_string_helper.h"
 #include "vk_safe_struct.h"
+#include <algorithm>
 #include <sstream>
 
 // Construct DescriptorSetLayout instance from given create info
@@ -28,19 +29,15 @@ cvdescriptorset::DescriptorSetLayout::DescriptorSetLayout(debug_report_data *rep
                                                           const VkDescriptorSetLayoutCreateInfo *p_create_info,
                                                           const VkDescriptorSetLayout layout)
     : layout_(layout), binding_count_(p_create_info->bindingCount), descriptor_count_(0), dynamic_descriptor_count_(0) {
-    uint32_t global_index = 0;
+    binding_infos_.reserve(binding_count_);
+    global_start_indices_.reserve(binding_count_);
+    bindings_.reserve(binding_count_);
     for (uint32_t i = 0; i < binding_count_; ++i) {
-        descriptor_count_ += p_create_info->pBindings[i].descriptorCount;
-        if (!binding_to_index_map_.emplace(p_create_info->pBindings[i].binding, i).second) {
-            log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT_EXT,
-                    reinterpret_cast<uint64_t &>(layout_), __LINE__, DRAWSTATE_INVALID_LAYOUT, "DS",
-                    "duplicated binding number in "
-                    "VkDescriptorSetLayoutBinding");
-        }
-        binding_to_global_start_index_map_[p_create_info->pBindings[i].binding] = global_index;
-        global_index += p_create_info->pBindings[i].descriptorCount ? p_create_info->pBindings[i].descriptorCount - 1 : 0;
-        binding_to_global_end_index_map_[p_create_info->pBindings[i].binding] = global_index;
-        global_index++;
+        auto count = p_create_info->pBindings[i].descriptorCount;
+        binding_infos_.push_back({p_create_info->pBindings[i].binding, i, descriptor_count_,
+                                  count ? descriptor_count_ + count - 1 : descriptor_count_});
+        global_start_indices_.push_back(descriptor_count_);
+        descriptor_count_ += count;
         bindings_.push_back(safe_VkDescriptorSetLayoutBinding(&p_create_info->pBindings[i]));
         // In cases where we should ignore pImmutableSamplers make sure it's NULL
         if ((p_create_info->pBindings[i].pImmutableSamplers) &&
@@ -53,18 +50,39 @@ cvdescriptorset::DescriptorSetLayout::DescriptorSetLayout(debug_report_data *rep
             dynamic_descriptor_count_ += p_create_info->pBindings[i].descriptorCount;
         }
     }
+    // Sort by binding#, keeping the first of any duplicated binding#s
+    std::stable_sort(binding_infos_.begin(), binding_infos_.end(),
+                     [](const BindingInfo &a, const BindingInfo &b) { return a.binding < b.binding; });
+    auto last = std::unique(binding_infos_.begin(), binding_infos_.end(),
+                            [](const BindingInfo &a, const BindingInfo &b) { return a.binding == b.binding; });
+    if (last != binding_infos_.end()) {
+        log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT_EXT,
+                reinterpret_cast<uint64_t &>(layout_), __LINE__, DRAWSTATE_INVALID_LAYOUT, "DS",
+                "duplicated binding number in "
+                "VkDescriptorSetLayoutBinding");
+        binding_infos_.erase(last, binding_infos_.end());
+    }
+}
+// Return lookup data for given binding, or nullptr if this layout does not have it
+cvdescriptorset::DescriptorSetLayout::BindingInfo const *
+cvdescriptorset::DescriptorSetLayout::FindBinding(const uint32_t binding) const {
+    auto it = std::lower_bound(binding_infos_.begin(), binding_infos_.end(), binding,
+                               [](const BindingInfo &info, uint32_t b) { return info.binding < b; });
+    if (it != binding_infos_.end() && it->binding == binding)
+        return &*it;
+    return nullptr;
 }
 // put all bindings into the given set
 void cvdescriptorset::DescriptorSetLayout::FillBindingSet(std::unordered_set<uint32_t> *binding_set) const {
-    for (auto binding_index_pair : binding_to_index_map_)
-        binding_set->insert(binding_index_pair.first);
+    for (const auto &info : binding_infos_)
+        binding_set->insert(info.binding);
 }
 
 VkDescriptorSetLayoutBinding const *
 cvdescriptorset::DescriptorSetLayout::GetDescriptorSetLayoutBindingPtrFromBinding(const uint32_t binding) const {
-    const auto &bi_itr = binding_to_index_map_.find(binding);
-    if (bi_itr != binding_to_index_map_.end()) {
-        return bindings_[bi_itr->second].ptr();
+    auto info = FindBinding(binding);
+    if (info) {
+        return bindings_[info->index].ptr();
     }
     return nullptr;
 }
@@ -76,9 +94,9 @@ cvdescriptorset::DescriptorSetLayout::GetDescriptorSetLayoutBindingPtrFromIndex(
 }
 // Return descriptorCount for given binding, 0 if index is unavailable
 uint32_t cvdescriptorset::DescriptorSetLayout::GetDescriptorCountFromBinding(const uint32_t binding) const {
-    const auto &bi_itr = binding_to_index_map_.find(binding);
-    if (bi_itr != binding_to_index_map_.end()) {
-        return bindings_[bi_itr->second].descriptorCount;
+    auto info = FindBinding(binding);
+    if (info) {
+        return bindings_[info->index].descriptorCount;
     }
     return 0;
 }
@@ -90,10 +108,10 @@ uint32_t cvdescriptorset::DescriptorSetLayout::GetDescriptorCountFromIndex(const
 }
 // For the given binding, return descriptorType
 VkDescriptorType cvdescriptorset::DescriptorSetLayout::GetTypeFromBinding(const uint32_t binding) const {
-    assert(binding_to_index_map_.count(binding));
-    const auto &bi_itr = binding_to_index_map_.find(binding);
-    if (bi_itr != binding_to_index_map_.end()) {
-        return bindings_[bi_itr->second].descriptorType;
+    auto info = FindBinding(binding);
+    assert(info);
+    if (info) {
+        return bindings_[info->index].descriptorType;
     }
     return VK_DESCRIPTOR_TYPE_MAX_ENUM;
 }
@@ -103,54 +121,51 @@ VkDescriptorType cvdescriptorset::DescriptorSetLayout::GetTypeFromIndex(const ui
     return bindings_[index].descriptorType;
 }
 // For the given global index, return descriptorType
-//  Currently just counting up through bindings_, may improve this in future
 VkDescriptorType cvdescriptorset::DescriptorSetLayout::GetTypeFromGlobalIndex(const uint32_t index) const {
-    uint32_t global_offset = 0;
-    for (auto binding : bindings_) {
-        global_offset += binding.descriptorCount;
-        if (index < global_offset)
-            return binding.descriptorType;
+    if (index < descriptor_count_) {
+        // Last index whose first descriptor is at or before the global index. Bindings with no descriptors share their
+        //  start with the next binding, so this always lands on the binding that holds the descriptor.
+        auto it = std::upper_bound(global_start_indices_.begin(), global_start_indices_.end(), index);
+        return bindings_[(it - global_start_indices_.begin()) - 1].descriptorType;
     }
     assert(0); // requested global index is out of bounds
     return VK_DESCRIPTOR_TYPE_MAX_ENUM;
 }
 // For the given binding, return stageFlags
 VkShaderStageFlags cvdescriptorset::DescriptorSetLayout::GetStageFlagsFromBinding(const uint32_t binding) const {
-    assert(binding_to_index_map_.count(binding));
-    const auto &bi_itr = binding_to_index_map_.find(binding);
-    if (bi_itr != binding_to_index_map_.end()) {
-        return bindings_[bi_itr->second].stageFlags;
+    auto info = FindBinding(binding);
+    assert(info);
+    if (info) {
+        return bindings_[info->index].stageFlags;
     }
     return VkShaderStageFlags(0);
 }
 // For the given binding, return start index
 uint32_t cvdescriptorset::DescriptorSetLayout::GetGlobalStartIndexFromBinding(const uint32_t binding) const {
-    assert(binding_to_global_start_index_map_.count(binding));
-    const auto &btgsi_itr = binding_to_global_start_index_map_.find(binding);
-    if (btgsi_itr != binding_to_global_start_index_map_.end()) {
-        return btgsi_itr->second;
+    auto info = FindBinding(binding);
+    assert(info);
+    if (info) {
+        return info->global_start;
     }
     // In error case max uint32_t so index is out of bounds to break ASAP
-    assert(0);
     return 0xFFFFFFFF;
 }
 // For the given binding, return end index
 uint32_t cvdescriptorset::DescriptorSetLayout::GetGlobalEndIndexFromBinding(const uint32_t binding) const {
-    assert(binding_to_global_end_index_map_.count(binding));
-    const auto &btgei_itr = binding_to_global_end_index_map_.find(binding);
-    if (btgei_itr != binding_to_global_end_index_map_.end()) {
-        return btgei_itr->second;
+    auto info = FindBinding(binding);
+    assert(info);
+    if (info) {
+        return info->global_end;
     }
     // In error case max uint32_t so index is out of bounds to break ASAP
-    assert(0);
     return 0xFFFFFFFF;
 }
 // For given binding, return ptr to ImmutableSampler array
 VkSampler const *cvdescriptorset::DescriptorSetLayout::GetImmutableSamplerPtrFromBinding(const uint32_t binding) const {
-    assert(binding_to_index_map_.count(binding));
-    const auto &bi_itr = binding_to_index_map_.find(binding);
-    if (bi_itr != binding_to_index_map_.end()) {
-        return bindings_[bi_itr->second].pImmutableSamplers;
+    auto info = FindBinding(binding);
+    assert(info);
+    if (info) {
+        return bindings_[info->index].pImmutableSamplers;
     }
     return nullptr;
 }
@@ -207,24 +222,18 @@ bool cvdescriptorset::DescriptorSetLayout::IsCompatible(const DescriptorSetLayou
 }
 
 bool cvdescriptorset::DescriptorSetLayout::IsNextBindingConsistent(const uint32_t binding) const {
-    if (!binding_to_index_map_.count(binding + 1))
+    auto info = FindBinding(binding);
+    // Bindings are sorted, so binding + 1 can only be the next entry
+    if (!info || info + 1 == binding_infos_.data() + binding_infos_.size() || info[1].binding != binding + 1)
+        return false;
+    const auto &cur = bindings_[info[0].index];
+    const auto &next = bindings_[info[1].index];
+    auto immut_samp = cur.pImmutableSamplers ? true : false;
+    if ((cur.descriptorType != next.descriptorType) || (cur.stageFlags != next.stageFlags) ||
+        (immut_samp != (next.pImmutableSamplers ? true : false))) {
         return false;
-    auto const &bi_itr = binding_to_index_map_.find(binding);
-    if (bi_itr != binding_to_index_map_.end()) {
-        const auto &next_bi_itr = binding_to_index_map_.find(binding + 1);
-        if (next_bi_itr != binding_to_index_map_.end()) {
-            auto type = bindings_[bi_itr->second].descriptorType;
-            auto stage_flags = bindings_[bi_itr->second].stageFlags;
-            auto immut_samp = bindings_[bi_itr->second].pImmutableSamplers ? true : false;
-            if ((type != bindings_[next_bi_itr->second].descriptorType) ||
-                (stage_flags != bindings_[next_bi_itr->second].stageFlags) ||
-                (immut_samp != (bindings_[next_bi_itr->second].pImmutableSamplers ? true : false))) {
-                return false;
-            }
-            return true;
-        }
     }
-    return false;
+    return true;
 }
 // Starting at offset descriptor of given binding, parse over update_count
 //  descriptor updates and verify that for any binding boundaries that are crossed, the next binding(s) are all consistent
@@ -265,60 +274,27 @@ bool cvdescriptorset::DescriptorSetLayout::VerifyUpdateConsistency(uint32_t curr
 cvdescriptorset::AllocateDescriptorSetsData::AllocateDescriptorSetsData(uint32_t count)
     : required_descriptors_by_type{}, layout_nodes(count, nullptr) {}
 
+// Source of DescriptorSet generations, shared by all sets
+static std::atomic<uint64_t> next_set_generation(1);
+
 cvdescriptorset::DescriptorSet::DescriptorSet(const VkDescriptorSet set, const DescriptorSetLayout *layout,
-                                              const core_validation::layer_data *dev_data)
-    : some_update_(false), set_(set), p_layout_(layout), device_data_(dev_data) {
-    // Foreach binding, create default descriptors of given type
+                                              const core_validation::layer_data *dev_data, DescriptorArena *arena)
+    : some_update_(false), generation_(next_set_generation++), set_(set), p_layout_(layout), descriptors_(nullptr), arena_(arena),
+      device_data_(dev_data) {
+    descriptors_ = arena_->Allocate(p_layout_->GetTotalDescriptorCount());
+    // Foreach binding, initialize default descriptors of given type
+    auto descriptor = descriptors_;
     for (uint32_t i = 0; i < p_layout_->GetBindingCount(); ++i) {
         auto type = p_layout_->GetTypeFromIndex(i);
-        switch (type) {
-        case VK_DESCRIPTOR_TYPE_SAMPLER: {
-            auto immut_sampler = p_layout_->GetImmutableSamplerPtrFromIndex(i);
-            for (uint32_t di = 0; di < p_layout_->GetDescriptorCountFromIndex(i); ++di) {
-                if (immut_sampler)
-                    descriptors_.emplace_back(new SamplerDescriptor(immut_sampler + di));
-                else
-                    descriptors_.emplace_back(new SamplerDescriptor());
-            }
-            break;
-        }
-        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER: {
-            auto immut = p_layout_->GetImmutableSamplerPtrFromIndex(i);
-            for (uint32_t di = 0; di < p_layout_->GetDescriptorCountFromIndex(i); ++di) {
-                if (immut)
-                    descriptors_.emplace_back(new ImageSamplerDescriptor(immut + di));
-                else
-                    descriptors_.emplace_back(new ImageSamplerDescriptor());
-            }
-            break;
-        }
-        // ImageDescriptors
-        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
-        case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
-        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
-            for (uint32_t di = 0; di < p_layout_->GetDescriptorCountFromIndex(i); ++di)
-                descriptors_.emplace_back(new ImageDescriptor(type));
-            break;
-        case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
-        case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
-            for (uint32_t di = 0; di < p_layout_->GetDescriptorCountFromIndex(i); ++di)
-                descriptors_.emplace_back(new TexelDescriptor(type));
-            break;
-        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
-        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
-        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
-        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
-            for (uint32_t di = 0; di < p_layout_->GetDescriptorCountFromIndex(i); ++di)
-                descriptors_.emplace_back(new BufferDescriptor(type));
-            break;
-        default:
-            assert(0); // Bad descriptor type specified
-            break;
+        auto immut_sampler = p_layout_->GetImmutableSamplerPtrFromIndex(i);
+        for (uint32_t di = 0; di < p_layout_->GetDescriptorCountFromIndex(i); ++di) {
+            descriptor++->Init(type, immut_sampler ? immut_sampler + di : nullptr);
         }
     }
 }
 
 cvdescriptorset::DescriptorSet::~DescriptorSet() {
+    arena_->Free(descriptors_, GetTotalDescriptorCount());
     InvalidateBoundCmdBuffers();
     // Remove link to any cmd buffers
     for (auto cb : cb_bindings) {
@@ -346,22 +322,26 @@ bool cvdescriptorset::DescriptorSet::ValidateDrawState(const std::unordered_set<
             *error = error_str.str();
             return false;
         }
+        if (!p_layout_->GetDescriptorCountFromBinding(binding)) {
+            // Nothing to do for a binding without descriptors
+            continue;
+        }
         auto start_idx = p_layout_->GetGlobalStartIndexFromBinding(binding);
-        if (descriptors_[start_idx]->IsImmutableSampler()) {
+        if (descriptors_[start_idx].IsImmutableSampler()) {
             // Nothing to do for strictly immutable sampler
         } else {
             auto end_idx = p_layout_->GetGlobalEndIndexFromBinding(binding);
             for (uint32_t i = start_idx; i <= end_idx; ++i) {
-                if (!descriptors_[i]->updated) {
+                if (!descriptors_[i].updated) {
                     std::stringstream error_str;
                     error_str << "Descriptor in binding #" << binding << " at global descriptor index " << i
                               << " is being used in draw but has not been updated.";
                     *error = error_str.str();
                     return false;
                 } else {
-                    if (GeneralBuffer == descriptors_[i]->GetClass()) {
+                    if (GeneralBuffer == descriptors_[i].GetClass()) {
                         // Verify that buffers are valid
-                        auto buffer = static_cast<BufferDescriptor *>(descriptors_[i].get())->GetBuffer();
+                        auto buffer = descriptors_[i].GetBuffer();
                         auto buffer_node = getBufferNode(device_data_, buffer);
                         if (!buffer_node) {
                             std::stringstream error_str;
@@ -380,11 +360,11 @@ bool cvdescriptorset::DescriptorSet::ValidateDrawState(const std::unordered_set<
                                 return false;
                             }
                         }
-                        if (descriptors_[i]->IsDynamic()) {
+                        if (descriptors_[i].IsDynamic()) {
                             // Validate that dynamic offsets are within the buffer
                             auto buffer_size = buffer_node->createInfo.size;
-                            auto range = static_cast<BufferDescriptor *>(descriptors_[i].get())->GetRange();
-                            auto desc_offset = static_cast<BufferDescriptor *>(descriptors_[i].get())->GetOffset();
+                            auto range = descriptors_[i].GetRange();
+                            auto desc_offset = descriptors_[i].GetOffset();
                             auto dyn_offset = dynamic_offsets[dyn_offset_index++];
                             if (VK_WHOLE_SIZE == range) {
                                 if ((dyn_offset + desc_offset) > buffer_size) {
@@ -422,23 +402,23 @@ uint32_t cvdescriptorset::DescriptorSet::GetStorageUpdates(const std::unordered_
                                                            std::unordered_set<VkImageView> *image_set) const {
     auto num_updates = 0;
     for (auto binding : bindings) {
-        // If a binding doesn't exist, skip it
-        if (!p_layout_->HasBinding(binding)) {
+        // If a binding doesn't exist or has no descriptors, skip it
+        if (!p_layout_->GetDescriptorCountFromBinding(binding)) {
             continue;
         }
         auto start_idx = p_layout_->GetGlobalStartIndexFromBinding(binding);
-        if (descriptors_[start_idx]->IsStorage()) {
-            if (Image == descriptors_[start_idx]->descriptor_class) {
+        if (descriptors_[start_idx].IsStorage()) {
+            if (Image == descriptors_[start_idx].descriptor_class) {
                 for (uint32_t i = 0; i < p_layout_->GetDescriptorCountFromBinding(binding); ++i) {
-                    if (descriptors_[start_idx + i]->updated) {
-                        image_set->insert(static_cast<ImageDescriptor *>(descriptors_[start_idx + i].get())->GetImageView());
+                    if (descriptors_[start_idx + i].updated) {
+                        image_set->insert(descriptors_[start_idx + i].GetImageView());
                         num_updates++;
                     }
                 }
-            } else if (TexelBuffer == descriptors_[start_idx]->descriptor_class) {
+            } else if (TexelBuffer == descriptors_[start_idx].descriptor_class) {
                 for (uint32_t i = 0; i < p_layout_->GetDescriptorCountFromBinding(binding); ++i) {
-                    if (descriptors_[start_idx + i]->updated) {
-                        auto bufferview = static_cast<TexelDescriptor *>(descriptors_[start_idx + i].get())->GetBufferView();
+                    if (descriptors_[start_idx + i].updated) {
+                        auto bufferview = descriptors_[start_idx + i].GetBufferView();
                         auto bv_info = getBufferViewInfo(device_data_, bufferview);
                         if (bv_info) {
                             buffer_set->insert(bv_info->buffer);
@@ -446,10 +426,10 @@ uint32_t cvdescriptorset::DescriptorSet::GetStorageUpdates(const std::unordered_
                         }
                     }
                 }
-            } else if (GeneralBuffer == descriptors_[start_idx]->descriptor_class) {
+            } else if (GeneralBuffer == descriptors_[start_idx].descriptor_class) {
                 for (uint32_t i = 0; i < p_layout_->GetDescriptorCountFromBinding(binding); ++i) {
-                    if (descriptors_[start_idx + i]->updated) {
-                        buffer_set->insert(static_cast<BufferDescriptor *>(descriptors_[start_idx + i].get())->GetBuffer());
+                    if (descriptors_[start_idx + i].updated) {
+                        buffer_set->insert(descriptors_[start_idx + i].GetBuffer());
                         num_updates++;
                     }
                 }
@@ -468,8 +448,9 @@ void cvdescriptorset::DescriptorSet::PerformWriteUpdate(const VkWriteDescriptorS
     auto start_idx = p_layout_->GetGlobalStartIndexFromBinding(update->dstBinding) + update->dstArrayElement;
     // perform update
     for (uint32_t di = 0; di < update->descriptorCount; ++di) {
-        descriptors_[start_idx + di]->WriteUpdate(update, di);
+        descriptors_[start_idx + di].WriteUpdate(update, di);
     }
+    generation_ = next_set_generation++;
     if (update->descriptorCount)
         some_update_ = true;
 
@@ -540,17 +521,7 @@ bool cvdescriptorset::DescriptorSet::ValidateCopyUpdate(const debug_report_data
                                              set_, error))) {
         return false;
     }
-    // First make sure source descriptors are updated
-    for (uint32_t i = 0; i < update->descriptorCount; ++i) {
-        if (!src_set->descriptors_[src_start_idx + i]) {
-            std::stringstream error_str;
-            error_str << "Attempting copy update from descriptorSet " << src_set << " binding #" << update->srcBinding << " but descriptor at array offset "
-                      << update->srcArrayElement + i << " has not been updated.";
-            *error = error_str.str();
-            return false;
-        }
-    }
-    // Update parameters all look good and descriptor updated so verify update contents
+    // Update parameters all look good so verify update contents
     if (!VerifyCopyUpdateContents(update, src_set, src_type, src_start_idx, error))
         return false;
 
@@ -563,28 +534,15 @@ void cvdescriptorset::DescriptorSet::PerformCopyUpdate(const VkCopyDescriptorSet
     auto dst_start_idx = p_layout_->GetGlobalStartIndexFromBinding(update->dstBinding) + update->dstArrayElement;
     // Update parameters all look good so perform update
     for (uint32_t di = 0; di < update->descriptorCount; ++di) {
-        descriptors_[dst_start_idx + di]->CopyUpdate(src_set->descriptors_[src_start_idx + di].get());
+        descriptors_[dst_start_idx + di].CopyUpdate(&src_set->descriptors_[src_start_idx + di]);
     }
+    generation_ = next_set_generation++;
     if (update->descriptorCount)
         some_update_ = true;
 
     InvalidateBoundCmdBuffers();
 }
 
-cvdescriptorset::SamplerDescriptor::SamplerDescriptor() : sampler_(VK_NULL_HANDLE), immutable_(false) {
-    updated = false;
-    descriptor_class = PlainSampler;
-};
-
-cvdescriptorset::SamplerDescriptor::SamplerDescriptor(const VkSampler *immut) : sampler_(VK_NULL_HANDLE), immutable_(false) {
-    updated = false;
-    descriptor_class = PlainSampler;
-    if (immut) {
-        sampler_ = *immut;
-        immutable_ = true;
-        updated = true;
-    }
-}
 // Validate given sampler. Currently this only checks to make sure it exists in the samplerMap
 bool cvdescriptorset::ValidateSampler(const VkSampler sampler, const core_validation::layer_data *dev_data) {
     return (getSamplerNode(dev_data, sampler) != nullptr);
@@ -732,123 +690,162 @@ bool cvdescriptorset::ValidateImageUpdate(VkImageView image_view, VkImageLayout
     return true;
 }
 
-void cvdescriptorset::SamplerDescriptor::WriteUpdate(const VkWriteDescriptorSet *update, const uint32_t index) {
-    sampler_ = update->pImageInfo[index].sampler;
-    updated = true;
-}
-
-void cvdescriptorset::SamplerDescriptor::CopyUpdate(const Descriptor *src) {
-    if (!immutable_) {
-        auto update_sampler = static_cast<const SamplerDescriptor *>(src)->sampler_;
-        sampler_ = update_sampler;
-    }
-    updated = true;
-}
-
-cvdescriptorset::ImageSamplerDescriptor::ImageSamplerDescriptor()
-    : sampler_(VK_NULL_HANDLE), immutable_(false), image_view_(VK_NULL_HANDLE), image_layout_(VK_IMAGE_LAYOUT_UNDEFINED) {
-    updated = false;
-    descriptor_class = ImageSampler;
-}
-
-cvdescriptorset::ImageSamplerDescriptor::ImageSamplerDescriptor(const VkSampler *immut)
-    : sampler_(VK_NULL_HANDLE), immutable_(true), image_view_(VK_NULL_HANDLE), image_layout_(VK_IMAGE_LAYOUT_UNDEFINED) {
-    updated = false;
-    descriptor_class = ImageSampler;
-    if (immut) {
-        sampler_ = *immut;
-        immutable_ = true;
-        updated = true;
-    }
-}
-
-void cvdescriptorset::ImageSamplerDescriptor::WriteUpdate(const VkWriteDescriptorSet *update, const uint32_t index) {
-    updated = true;
-    const auto &image_info = update->pImageInfo[index];
-    sampler_ = image_info.sampler;
-    image_view_ = image_info.imageView;
-    image_layout_ = image_info.imageLayout;
-}
-
-void cvdescriptorset::ImageSamplerDescriptor::CopyUpdate(const Descriptor *src) {
-    if (!immutable_) {
-        auto update_sampler = static_cast<const ImageSamplerDescriptor *>(src)->sampler_;
-        sampler_ = update_sampler;
-    }
-    auto image_view = static_cast<const ImageSamplerDescriptor *>(src)->image_view_;
-    auto image_layout = static_cast<const ImageSamplerDescriptor *>(src)->image_layout_;
-    updated = true;
-    image_view_ = image_view;
-    image_layout_ = image_layout;
-}
-
-cvdescriptorset::ImageDescriptor::ImageDescriptor(const VkDescriptorType type)
-    : storage_(false), image_view_(VK_NULL_HANDLE), image_layout_(VK_IMAGE_LAYOUT_UNDEFINED) {
+void cvdescriptorset::Descriptor::Init(const VkDescriptorType type, const VkSampler *immut) {
     updated = false;
-    descriptor_class = Image;
-    if (VK_DESCRIPTOR_TYPE_STORAGE_IMAGE == type)
+    immutable_ = false;
+    storage_ = false;
+    dynamic_ = false;
+    switch (type) {
+    case VK_DESCRIPTOR_TYPE_SAMPLER:
+        descriptor_class = PlainSampler;
+        break;
+    case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+        descriptor_class = ImageSampler;
+        break;
+    case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+    case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+        descriptor_class = Image;
+        break;
+    case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+        descriptor_class = Image;
         storage_ = true;
-};
-
-void cvdescriptorset::ImageDescriptor::WriteUpdate(const VkWriteDescriptorSet *update, const uint32_t index) {
-    updated = true;
-    const auto &image_info = update->pImageInfo[index];
-    image_view_ = image_info.imageView;
-    image_layout_ = image_info.imageLayout;
-}
-
-void cvdescriptorset::ImageDescriptor::CopyUpdate(const Descriptor *src) {
-    auto image_view = static_cast<const ImageDescriptor *>(src)->image_view_;
-    auto image_layout = static_cast<const ImageDescriptor *>(src)->image_layout_;
-    updated = true;
-    image_view_ = image_view;
-    image_layout_ = image_layout;
-}
-
-cvdescriptorset::BufferDescriptor::BufferDescriptor(const VkDescriptorType type)
-    : storage_(false), dynamic_(false), buffer_(VK_NULL_HANDLE), offset_(0), range_(0) {
-    updated = false;
-    descriptor_class = GeneralBuffer;
-    if (VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC == type) {
+        break;
+    case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+        descriptor_class = TexelBuffer;
+        break;
+    case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+        descriptor_class = TexelBuffer;
+        storage_ = true;
+        break;
+    case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+        descriptor_class = GeneralBuffer;
+        break;
+    case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+        descriptor_class = GeneralBuffer;
         dynamic_ = true;
-    } else if (VK_DESCRIPTOR_TYPE_STORAGE_BUFFER == type) {
+        break;
+    case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+        descriptor_class = GeneralBuffer;
         storage_ = true;
-    } else if (VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC == type) {
+        break;
+    case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+        descriptor_class = GeneralBuffer;
         dynamic_ = true;
         storage_ = true;
+        break;
+    default:
+        assert(0); // Bad descriptor type specified
+        descriptor_class = PlainSampler;
+        break;
+    }
+    switch (descriptor_class) {
+    case TexelBuffer:
+        buffer_view_ = VK_NULL_HANDLE;
+        break;
+    case GeneralBuffer:
+        buffer_.buffer = VK_NULL_HANDLE;
+        buffer_.offset = 0;
+        buffer_.range = 0;
+        break;
+    default:
+        image_.sampler = VK_NULL_HANDLE;
+        image_.image_view = VK_NULL_HANDLE;
+        image_.image_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        // Immutable samplers count as updated for the sampler part of the descriptor
+        if (immut && (descriptor_class == PlainSampler || descriptor_class == ImageSampler)) {
+            image_.sampler = *immut;
+            immutable_ = true;
+            updated = true;
+        }
+        break;
     }
 }
-void cvdescriptorset::BufferDescriptor::WriteUpdate(const VkWriteDescriptorSet *update, const uint32_t index) {
+
+void cvdescriptorset::Descriptor::WriteUpdate(const VkWriteDescriptorSet *update, const uint32_t index) {
     updated = true;
-    const auto &buffer_info = update->pBufferInfo[index];
-    buffer_ = buffer_info.buffer;
-    offset_ = buffer_info.offset;
-    range_ = buffer_info.range;
+    switch (descriptor_class) {
+    case PlainSampler:
+        image_.sampler = update->pImageInfo[index].sampler;
+        break;
+    case ImageSampler:
+        image_.sampler = update->pImageInfo[index].sampler;
+    // Intentional fall-through to update image
+    case Image:
+        image_.image_view = update->pImageInfo[index].imageView;
+        image_.image_layout = update->pImageInfo[index].imageLayout;
+        break;
+    case TexelBuffer:
+        buffer_view_ = update->pTexelBufferView[index];
+        break;
+    case GeneralBuffer:
+        buffer_.buffer = update->pBufferInfo[index].buffer;
+        buffer_.offset = update->pBufferInfo[index].offset;
+        buffer_.range = update->pBufferInfo[index].range;
+        break;
+    }
 }
 
-void cvdescriptorset::BufferDescriptor::CopyUpdate(const Descriptor *src) {
-    auto buff_desc = static_cast<const BufferDescriptor *>(src);
+void cvdescriptorset::Descriptor::CopyUpdate(const Descriptor *src) {
     updated = true;
-    buffer_ = buff_desc->buffer_;
-    offset_ = buff_desc->offset_;
-    range_ = buff_desc->range_;
+    switch (descriptor_class) {
+    case PlainSampler:
+        if (!immutable_)
+            image_.sampler = src->image_.sampler;
+        break;
+    case ImageSampler:
+        if (!immutable_)
+            image_.sampler = src->image_.sampler;
+    // Intentional fall-through to copy image
+    case Image:
+        image_.image_view = src->image_.image_view;
+        image_.image_layout = src->image_.image_layout;
+        break;
+    case TexelBuffer:
+        buffer_view_ = src->buffer_view_;
+        break;
+    case GeneralBuffer:
+        buffer_ = src->buffer_;
+        break;
+    }
 }
 
-cvdescriptorset::TexelDescriptor::TexelDescriptor(const VkDescriptorType type) : buffer_view_(VK_NULL_HANDLE), storage_(false) {
-    updated = false;
-    descriptor_class = TexelBuffer;
-    if (VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER == type)
-        storage_ = true;
-};
+cvdescriptorset::DescriptorArena::DescriptorArena(uint32_t descriptor_count)
+    : block_size_(std::min(std::max(descriptor_count, 256u), 64u * 1024u)), current_block_(0), current_used_(0) {}
 
-void cvdescriptorset::TexelDescriptor::WriteUpdate(const VkWriteDescriptorSet *update, const uint32_t index) {
-    updated = true;
-    buffer_view_ = update->pTexelBufferView[index];
+cvdescriptorset::Descriptor *cvdescriptorset::DescriptorArena::Allocate(uint32_t count) {
+    if (!count)
+        return nullptr;
+    // Sets of a layout that was freed before take their array back
+    auto free_it = free_arrays_.find(count);
+    if (free_it != free_arrays_.end() && !free_it->second.empty()) {
+        auto descriptors = free_it->second.back();
+        free_it->second.pop_back();
+        return descriptors;
+    }
+    // Otherwise carve from the first block with room, the rest of a block that cannot fit the array is skipped
+    while (current_block_ < blocks_.size() && blocks_[current_block_].size - current_used_ < count) {
+        current_block_++;
+        current_used_ = 0;
+    }
+    if (current_block_ == blocks_.size()) {
+        auto size = std::max(block_size_, count);
+        blocks_.push_back({std::unique_ptr<Descriptor[]>(new Descriptor[size]), size});
+        current_used_ = 0;
+    }
+    auto descriptors = blocks_[current_block_].descriptors.get() + current_used_;
+    current_used_ += count;
+    return descriptors;
 }
 
-void cvdescriptorset::TexelDescriptor::CopyUpdate(const Descriptor *src) {
-    updated = true;
-    buffer_view_ = static_cast<const TexelDescriptor *>(src)->buffer_view_;
+void cvdescriptorset::DescriptorArena::Free(Descriptor *descriptors, uint32_t count) {
+    if (count)
+        free_arrays_[count].push_back(descriptors);
+}
+
+void cvdescriptorset::DescriptorArena::Reset() {
+    free_arrays_.clear();
+    current_block_ = 0;
+    current_used_ = 0;
 }
 // This is a helper function that iterates over a set of Write and Copy updates, pulls the DescriptorSet* for updated
 //  sets, and then calls their respective Validate[Write|Copy]Update functions.
@@ -1108,7 +1105,7 @@ bool cvdescriptorset::DescriptorSet::VerifyWriteUpdateContents(const VkWriteDesc
     }
     case VK_DESCRIPTOR_TYPE_SAMPLER: {
         for (uint32_t di = 0; di < update->descriptorCount; ++di) {
-            if (!descriptors_[index + di].get()->IsImmutableSampler()) {
+            if (!descriptors_[index + di].IsImmutableSampler()) {
                 if (!ValidateSampler(update->pImageInfo[di].sampler, device_data_)) {
                     std::stringstream error_str;
                     error_str << "Attempted write update to sampler descriptor with invalid sampler: "
@@ -1182,11 +1179,11 @@ bool cvdescriptorset::DescriptorSet::VerifyWriteUpdateContents(const VkWriteDesc
 // Verify that the contents of the update are ok, but don't perform actual update
 bool cvdescriptorset::DescriptorSet::VerifyCopyUpdateContents(const VkCopyDescriptorSet *update, const DescriptorSet *src_set,
                                                               VkDescriptorType type, uint32_t index, std::string *error) const {
-    switch (src_set->descriptors_[index]->descriptor_class) {
+    switch (src_set->descriptors_[index].descriptor_class) {
     case PlainSampler: {
         for (uint32_t di = 0; di < update->descriptorCount; ++di) {
-            if (!src_set->descriptors_[index + di]->IsImmutableSampler()) {
-                auto update_sampler = static_cast<SamplerDescriptor *>(src_set->descriptors_[index + di].get())->GetSampler();
+            if (!src_set->descriptors_[index + di].IsImmutableSampler()) {
+                auto update_sampler = src_set->descriptors_[index + di].GetSampler();
                 if (!ValidateSampler(update_sampler, device_data_)) {
                     std::stringstream error_str;
                     error_str << "Attempted copy update to sampler descriptor with invalid sampler: " << update_sampler << ".";
@@ -1201,7 +1198,7 @@ bool cvdescriptorset::DescriptorSet::VerifyCopyUpdateContents(const VkCopyDescri
     }
     case ImageSampler: {
         for (uint32_t di = 0; di < update->descriptorCount; ++di) {
-            auto img_samp_desc = static_cast<const ImageSamplerDescriptor *>(src_set->descriptors_[index + di].get());
+            auto img_samp_desc = &src_set->descriptors_[index + di];
             // First validate sampler
             if (!img_samp_desc->IsImmutableSampler()) {
                 auto update_sampler = img_samp_desc->GetSampler();
@@ -1227,7 +1224,7 @@ bool cvdescriptorset::DescriptorSet::VerifyCopyUpdateContents(const VkCopyDescri
     }
     case Image: {
         for (uint32_t di = 0; di < update->descriptorCount; ++di) {
-            auto img_desc = static_cast<const ImageDescriptor *>(src_set->descriptors_[index + di].get());
+            auto img_desc = &src_set->descriptors_[index + di];
             auto image_view = img_desc->GetImageView();
             auto image_layout = img_desc->GetImageLayout();
             if (!ValidateImageUpdate(image_view, image_layout, type, device_data_, error)) {
@@ -1241,7 +1238,7 @@ bool cvdescriptorset::DescriptorSet::VerifyCopyUpdateContents(const VkCopyDescri
     }
     case TexelBuffer: {
         for (uint32_t di = 0; di < update->descriptorCount; ++di) {
-            auto buffer_view = static_cast<TexelDescriptor *>(src_set->descriptors_[index + di].get())->GetBufferView();
+            auto buffer_view = src_set->descriptors_[index + di].GetBufferView();
             auto bv_info = getBufferViewInfo(device_data_, buffer_view);
             if (!bv_info) {
                 std::stringstream error_str;
@@ -1261,7 +1258,7 @@ bool cvdescriptorset::DescriptorSet::VerifyCopyUpdateContents(const VkCopyDescri
     }
     case GeneralBuffer: {
         for (uint32_t di = 0; di < update->descriptorCount; ++di) {
-            auto buffer = static_cast<BufferDescriptor *>(src_set->descriptors_[index + di].get())->GetBuffer();
+            auto buffer = src_set->descriptors_[index + di].GetBuffer();
             if (!ValidateBufferUsage(getBufferNode(device_data_, buffer), type, error)) {
                 std::stringstream error_str;
                 error_str << "Attempted copy update to buffer descriptor failed due to: " << error->c_str();
@@ -1351,7 +1348,8 @@ void cvdescriptorset::PerformAllocateDescriptorSets(const VkDescriptorSetAllocat
      * global map and the pool's set.
      */
     for (uint32_t i = 0; i < p_alloc_info->descriptorSetCount; i++) {
-        auto new_ds = new cvdescriptorset::DescriptorSet(descriptor_sets[i], ds_data->layout_nodes[i], dev_data);
+        auto new_ds =
+            new cvdescriptorset::DescriptorSet(descriptor_sets[i], ds_data->layout_nodes[i], dev_data, pool_state->descriptor_arena);
 
         pool_state->sets.insert(new_ds);
         new_ds->in_use.store(0);
@@ -95,7 +95,7 @@ class DescriptorSetLayout {
     // Fill passed-in set with bindings
     void FillBindingSet(std::unordered_set<uint32_t> *) const;
     // Return true if given binding is present in this layout
-    bool HasBinding(const uint32_t binding) const { return binding_to_index_map_.count(binding) > 0; };
+    bool HasBinding(const uint32_t binding) const { return FindBinding(binding) != nullptr; };
     // Return true if this layout is compatible with passed in layout,
     //   else return false and update error_msg with description of incompatibility
     bool IsCompatible(const DescriptorSetLayout *, std::string *) const;
@@ -123,10 +123,18 @@ class DescriptorSetLayout {
     bool VerifyUpdateConsistency(uint32_t, uint32_t, uint32_t, const char *, const VkDescriptorSet, std::string *) const;
 
   private:
+    // Per-binding lookup data, kept sorted by binding# so that lookups are a binary search over a small dense array
+    struct BindingInfo {
+        uint32_t binding;
+        uint32_t index;        // into bindings_
+        uint32_t global_start; // global index of the first descriptor
+        uint32_t global_end;   // global index of the last descriptor
+    };
+    BindingInfo const *FindBinding(const uint32_t) const;
     VkDescriptorSetLayout layout_;
-    std::unordered_map<uint32_t, uint32_t> binding_to_index_map_;
-    std::unordered_map<uint32_t, uint32_t> binding_to_global_start_index_map_;
-    std::unordered_map<uint32_t, uint32_t> binding_to_global_end_index_map_;
+    std::vector<BindingInfo> binding_infos_;
+    // global index of the first descriptor for each index, in index order
+    std::vector<uint32_t> global_start_indices_;
     // VkDescriptorSetLayoutCreateFlags flags_;
     uint32_t binding_count_; // # of bindings in this layout
     std::vector<safe_VkDescriptorSetLayoutBinding> bindings_;
@@ -135,113 +143,90 @@ class DescriptorSetLayout {
 };
 
 /*
- * Descriptor classes
- *  Descriptor is an abstract base class from which 5 separate descriptor types are derived.
- *   This allows the WriteUpdate() and CopyUpdate() operations to be specialized per
- *   descriptor type, but all descriptors in a set can be accessed via the common Descriptor*.
+ * Descriptor class
+ *  A Descriptor is a small value type tagged with the DescriptorClass of its descriptor type, which says which
+ *   part of its storage is in use. All descriptors of a set live in one flat array that the set takes from its
+ *   pool's DescriptorArena, so allocating a set does not allocate per descriptor.
  */
 
-// Slightly broader than type, each c++ "class" will has a corresponding "DescriptorClass"
+// Slightly broader than type, descriptor types with the same kind of contents share a "DescriptorClass"
 enum DescriptorClass { PlainSampler, ImageSampler, Image, TexelBuffer, GeneralBuffer };
 
 class Descriptor {
   public:
-    virtual ~Descriptor(){};
-    virtual void WriteUpdate(const VkWriteDescriptorSet *, const uint32_t) = 0;
-    virtual void CopyUpdate(const Descriptor *) = 0;
-    virtual DescriptorClass GetClass() const { return descriptor_class; };
-    // Special fast-path check for SamplerDescriptors that are immutable
-    virtual bool IsImmutableSampler() const { return false; };
+    // Reset to a descriptor of the given type that has not been updated, or that holds the given immutable sampler
+    void Init(const VkDescriptorType, const VkSampler *);
+    void WriteUpdate(const VkWriteDescriptorSet *, const uint32_t);
+    void CopyUpdate(const Descriptor *);
+    DescriptorClass GetClass() const { return descriptor_class; };
+    // Special fast-path check for sampler descriptors that are immutable
+    bool IsImmutableSampler() const { return immutable_; };
     // Check for dynamic descriptor type
-    virtual bool IsDynamic() const { return false; };
+    bool IsDynamic() const { return dynamic_; };
     // Check for storage descriptor type
-    virtual bool IsStorage() const { return false; };
+    bool IsStorage() const { return storage_; };
+    // PlainSampler and ImageSampler
+    VkSampler GetSampler() const { return image_.sampler; }
+    // ImageSampler and Image
+    VkImageView GetImageView() const { return image_.image_view; }
+    VkImageLayout GetImageLayout() const { return image_.image_layout; }
+    // TexelBuffer
+    VkBufferView GetBufferView() const { return buffer_view_; }
+    // GeneralBuffer
+    VkBuffer GetBuffer() const { return buffer_.buffer; }
+    VkDeviceSize GetOffset() const { return buffer_.offset; }
+    VkDeviceSize GetRange() const { return buffer_.range; }
     bool updated; // Has descriptor been updated?
     DescriptorClass descriptor_class;
-};
-// Shared helper functions - These are useful because the shared sampler image descriptor type
-//  performs common functions with both sampler and image descriptors so they can share their common functions
-bool ValidateSampler(const VkSampler, const core_validation::layer_data *);
-bool ValidateImageUpdate(VkImageView, VkImageLayout, VkDescriptorType, const core_validation::layer_data *, std::string *);
-
-class SamplerDescriptor : public Descriptor {
-  public:
-    SamplerDescriptor();
-    SamplerDescriptor(const VkSampler *);
-    void WriteUpdate(const VkWriteDescriptorSet *, const uint32_t) override;
-    void CopyUpdate(const Descriptor *) override;
-    virtual bool IsImmutableSampler() const override { return immutable_; };
-    VkSampler GetSampler() const { return sampler_; }
 
   private:
-    // bool ValidateSampler(const VkSampler) const;
-    VkSampler sampler_;
     bool immutable_;
-};
-
-class ImageSamplerDescriptor : public Descriptor {
-  public:
-    ImageSamplerDescriptor();
-    ImageSamplerDescriptor(const VkSampler *);
-    void WriteUpdate(const VkWriteDescriptorSet *, const uint32_t) override;
-    void CopyUpdate(const Descriptor *) override;
-    virtual bool IsImmutableSampler() const override { return immutable_; };
-    VkSampler GetSampler() const { return sampler_; }
-    VkImageView GetImageView() const { return image_view_; }
-    VkImageLayout GetImageLayout() const { return image_layout_; }
-
-  private:
-    VkSampler sampler_;
-    bool immutable_;
-    VkImageView image_view_;
-    VkImageLayout image_layout_;
-};
-
-class ImageDescriptor : public Descriptor {
-  public:
-    ImageDescriptor(const VkDescriptorType);
-    void WriteUpdate(const VkWriteDescriptorSet *, const uint32_t) override;
-    void CopyUpdate(const Descriptor *) override;
-    virtual bool IsStorage() const override { return storage_; }
-    VkImageView GetImageView() const { return image_view_; }
-    VkImageLayout GetImageLayout() const { return image_layout_; }
-
-  private:
-    bool storage_;
-    VkImageView image_view_;
-    VkImageLayout image_layout_;
-};
-
-class TexelDescriptor : public Descriptor {
-  public:
-    TexelDescriptor(const VkDescriptorType);
-    void WriteUpdate(const VkWriteDescriptorSet *, const uint32_t) override;
-    void CopyUpdate(const Descriptor *) override;
-    virtual bool IsStorage() const override { return storage_; }
-    VkBufferView GetBufferView() const { return buffer_view_; }
-
-  private:
-    VkBufferView buffer_view_;
     bool storage_;
+    bool dynamic_;
+    union {
+        struct {
+            VkSampler sampler;
+            VkImageView image_view;
+            VkImageLayout image_layout;
+        } image_;
+        struct {
+            VkBuffer buffer;
+            VkDeviceSize offset;
+            VkDeviceSize range;
+        } buffer_;
+        VkBufferView buffer_view_;
+    };
 };
+// Shared helper functions - These are useful because the shared sampler image descriptor type
+//  performs common functions with both sampler and image descriptors so they can share their common functions
+bool ValidateSampler(const VkSampler, const core_validation::layer_data *);
+bool ValidateImageUpdate(VkImageView, VkImageLayout, VkDescriptorType, const core_validation::layer_data *, std::string *);
 
-class BufferDescriptor : public Descriptor {
+/*
+ * DescriptorArena class
+ *  Each descriptor pool owns an arena that hands out the descriptor arrays of its sets. Arrays are carved out of
+ *   large blocks. Arrays given back by vkFreeDescriptorSets() are kept on free lists by length, so that sets with
+ *   the same layout reuse them, and Reset() makes all blocks available again for vkResetDescriptorPool().
+ */
+class DescriptorArena {
   public:
-    BufferDescriptor(const VkDescriptorType);
-    void WriteUpdate(const VkWriteDescriptorSet *, const uint32_t) override;
-    void CopyUpdate(const Descriptor *) override;
-    virtual bool IsDynamic() const override { return dynamic_; }
-    virtual bool IsStorage() const override { return storage_; }
-    VkBuffer GetBuffer() const { return buffer_; }
-    VkDeviceSize GetOffset() const { return offset_; }
-    VkDeviceSize GetRange() const { return range_; }
+    // descriptor_count is the total number of descriptors the pool was created with, used to size blocks
+    DescriptorArena(uint32_t descriptor_count);
+    // Returns an array of count uninitialized descriptors, or nullptr if count is 0
+    Descriptor *Allocate(uint32_t count);
+    void Free(Descriptor *, uint32_t count);
+    void Reset();
 
   private:
-    bool storage_;
-    bool dynamic_;
-    VkBuffer buffer_;
-    VkDeviceSize offset_;
-    VkDeviceSize range_;
+    struct Block {
+        std::unique_ptr<Descriptor[]> descriptors;
+        uint32_t size;
+    };
+    std::vector<Block> blocks_;
+    uint32_t block_size_;
+    size_t current_block_; // blocks before this one are full
+    uint32_t current_used_;
+    std::unordered_map<uint32_t, std::vector<Descriptor *>> free_arrays_;
 };
 // Structs to contain common elements that need to be shared between Validate* and Perform* calls below
 struct AllocateDescriptorSetsData {
@@ -275,8 +260,8 @@ void PerformAllocateDescriptorSets(const VkDescriptorSetAllocateInfo *, const Vk
  *   Please refer to the DescriptorSetLayout comment above for a description of
  *   index, binding, and global index.
  *
- * At construction a vector of Descriptor* is created with types corresponding to the
- *   layout. The primary operation performed on the descriptors is to update them
+ * At construction an array of Descriptors is taken from the pool's DescriptorArena and initialized with types
+ *   corresponding to the layout. The primary operation performed on the descriptors is to update them
  *   via write or copy updates, and validate that the update contents are correct.
  *   In order to validate update contents, the DescriptorSet stores a bunch of ptrs
  *   to data maps where various Vulkan objects can be looked up. The management of
@@ -287,7 +272,7 @@ class DescriptorSet : public BASE_NODE {
   public:
     using BASE_NODE::in_use;
     using BASE_NODE::cb_bindings;
-    DescriptorSet(const VkDescriptorSet, const DescriptorSetLayout *, const core_validation::layer_data *);
+    DescriptorSet(const VkDescriptorSet, const DescriptorSetLayout *, const core_validation::layer_data *, DescriptorArena *);
     ~DescriptorSet();
     // A number of common Get* functions that return data based on layout from which this set was created
     uint32_t GetTotalDescriptorCount() const { return p_layout_ ? p_layout_->GetTotalDescriptorCount() : 0; };
@@ -349,6 +334,9 @@ class DescriptorSet : public BASE_NODE {
     };
     // Return true if any part of set has ever been updated
     bool IsUpdated() const { return some_update_; };
+    // Return a value that changes whenever the contents of this set change. Values are never reused, even by other sets,
+    //  so draw-time state cached against a generation can't be mistaken for that of a set later allocated at this address
+    uint64_t GetGeneration() const { return generation_; };
 
   private:
     bool VerifyWriteUpdateContents(const VkWriteDescriptorSet *, const uint32_t, std::string *) const;
@@ -359,9 +347,12 @@ class DescriptorSet : public BASE_NODE {
     // Private helper to set all bound cmd buffers to INVALID state
     void InvalidateBoundCmdBuffers();
     bool some_update_; // has any part of the set ever been updated?
+    uint64_t generation_;
     VkDescriptorSet set_;
     const DescriptorSetLayout *p_layout_;
-    std::vector<std::unique_ptr<Descriptor>> descriptors_;
+    // GetTotalDescriptorCount() descriptors, owned by arena_
+    Descriptor *descriptors_;
+    DescriptorArena *arena_;
     // Ptr to device data used for various data look-ups
     const core_validation::layer_data *device_data_;
 };
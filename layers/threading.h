@@ -20,8 +20,11 @@
 
 #ifndef THREADING_H
 #define THREADING_H
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 #include "vk_layer_config.h"
 #include "vk_layer_logging.h"
@@ -68,6 +71,16 @@ inline bool startMultiThread() {
 inline void finishMultiThread() { vulkan_in_use = false; }
 } // namespace threading
 
+// Uses of an object are tracked in one of two places. If the object's home
+// slot in a small fixed table is free, the use is recorded there with atomic
+// operations only, which is all the uncontended case needs. Objects whose
+// home slot is held by another object, and uses that collide with another
+// thread, go through the uses map under counter_lock, which is also where
+// threads wait for an object to become free.
+//
+// An object is never in its slot and the uses map at the same time. A slot's
+// overflow count is the number of objects with that home slot in the uses map;
+// the lock-free path only claims a free slot when it is zero.
 template <typename T> class counter {
   public:
     const char *typeName;
@@ -75,135 +88,250 @@ template <typename T> class counter {
     std::unordered_map<T, object_use_data> uses;
     std::mutex counter_lock;
     std::condition_variable counter_condition;
-    void startWrite(debug_report_data *report_data, T object) {
+
+  private:
+    // Slot state: reader count, writer count, flags and a generation that
+    // changes every time the slot is claimed. The key and thread of a slot
+    // belong to the object using it only while the state has a non-zero count
+    // and the generation they were written with.
+    static const uint64_t READER_ONE = 1ull;
+    static const uint64_t READER_MASK = 0xffffffull;
+    static const uint64_t WRITER_ONE = 1ull << 24;
+    static const uint64_t WRITER_MASK = 0xffffull << 24;
+    static const uint64_t COUNT_MASK = READER_MASK | WRITER_MASK;
+    static const uint64_t RESERVED = 1ull << 40; // being claimed
+    static const uint64_t WAITERS = 1ull << 41;  // notify counter_condition when released
+    static const uint64_t GEN_ONE = 1ull << 42;
+    static const uint64_t GEN_MASK = ~0ull << 42;
+    static const unsigned SLOT_BITS = 8;
+
+    struct use_slot {
+        std::atomic<uint64_t> key;
+        std::atomic<uint64_t> state;
+        std::atomic<loader_platform_thread_id> thread;
+        std::atomic<uint32_t> overflow;
+    };
+    use_slot slots[1 << SLOT_BITS];
+
+    use_slot &homeSlot(T object) { return slots[((uint64_t)(object)*0x9e3779b97f4a7c15ull) >> (64 - SLOT_BITS)]; }
+
+    // Tries to record a use of object in its home slot. Returns false if the
+    // use has to be recorded by startUseLocked instead.
+    bool tryStartUse(T object, loader_platform_thread_id tid, bool write) {
+        use_slot &slot = homeSlot(object);
+        uint64_t state = slot.state.load();
+        if (state & (RESERVED | WAITERS)) {
+            return false;
+        }
+        if ((state & COUNT_MASK) == 0) {
+            // There is no current use of the slot.  Claim it for object.
+            uint64_t reserved = ((state + GEN_ONE) & GEN_MASK) | RESERVED;
+            if (!slot.state.compare_exchange_strong(state, reserved)) {
+                return false;
+            }
+            if (slot.overflow.load() != 0) {
+                // object may be in use in the uses map
+                slot.state.store(reserved & GEN_MASK);
+                return false;
+            }
+            slot.key.store((uint64_t)(object));
+            slot.thread.store(tid);
+            slot.state.store((reserved & GEN_MASK) | (write ? WRITER_ONE : READER_ONE));
+            return true;
+        }
+        if (slot.key.load() != (uint64_t)(object)) {
+            return false;
+        }
+        // Readers may share the object with readers in other threads.  Anything
+        // else only shares it with the thread that is already using it.
+        if ((write || (state & WRITER_MASK)) && slot.thread.load() != tid) {
+            return false;
+        }
+        return slot.state.compare_exchange_strong(state, state + (write ? WRITER_ONE : READER_ONE));
+    }
+
+    // Tries to remove a use of object from its home slot. Returns false if
+    // object is not using the slot.
+    bool tryFinishUse(T object, bool write) {
+        use_slot &slot = homeSlot(object);
+        uint64_t state = slot.state.load();
+        uint64_t released;
+        do {
+            if ((state & RESERVED) || (state & (write ? WRITER_MASK : READER_MASK)) == 0 ||
+                slot.key.load() != (uint64_t)(object)) {
+                return false;
+            }
+            released = state - (write ? WRITER_ONE : READER_ONE);
+            if ((released & COUNT_MASK) == 0) {
+                released &= ~WAITERS;
+            }
+        } while (!slot.state.compare_exchange_weak(state, released));
+        if (state & WAITERS) {
+            // Notify any waiting threads that this object may be safe to use
+            std::unique_lock<std::mutex> lock(counter_lock);
+            lock.unlock();
+            counter_condition.notify_all();
+        }
+        return true;
+    }
+
+    // Records a use of object that tryStartUse could not, reporting and
+    // optionally waiting out a use by another thread.
+    void startUseLocked(debug_report_data *report_data, T object, loader_platform_thread_id tid, bool write) {
+        bool reported = false;
         bool skipCall = false;
-        loader_platform_thread_id tid = loader_platform_get_thread_id();
+        use_slot &slot = homeSlot(object);
         std::unique_lock<std::mutex> lock(counter_lock);
-        if (uses.find(object) == uses.end()) {
-            // There is no current use of the object.  Record writer thread.
-            struct object_use_data *use_data = &uses[object];
-            use_data->reader_count = 0;
-            use_data->writer_count = 1;
-            use_data->thread = tid;
-        } else {
-            struct object_use_data *use_data = &uses[object];
-            if (use_data->reader_count == 0) {
-                // There are no readers.  Two writers just collided.
-                if (use_data->thread != tid) {
-                    skipCall |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, objectType, (uint64_t)(object),
-                                        /*location*/ 0, THREADING_CHECKER_MULTIPLE_THREADS, "THREADING",
-                                        "THREADING ERROR : object of type %s is simultaneously used in thread %ld and thread %ld",
-                                        typeName, use_data->thread, tid);
-                    if (skipCall) {
-                        // Wait for thread-safe access to object instead of skipping call.
-                        while (uses.find(object) != uses.end()) {
-                            counter_condition.wait(lock);
-                        }
-                        // There is now no current use of the object.  Record writer thread.
-                        struct object_use_data *use_data = &uses[object];
-                        use_data->thread = tid;
-                        use_data->reader_count = 0;
-                        use_data->writer_count = 1;
-                    } else {
-                        // Continue with an unsafe use of the object.
-                        use_data->thread = tid;
-                        use_data->writer_count += 1;
-                    }
-                } else {
-                    // This is either safe multiple use in one call, or recursive use.
-                    // There is no way to make recursion safe.  Just forge ahead.
-                    use_data->writer_count += 1;
+        while (true) {
+            auto use = uses.find(object);
+            uint64_t state = slot.state.load();
+            bool in_slot = false;
+            int writer_count;
+            loader_platform_thread_id thread;
+
+            if (use != uses.end()) {
+                writer_count = use->second.writer_count;
+                thread = use->second.thread;
+            } else if (state & RESERVED) {
+                // Another thread is claiming the slot, maybe for object
+                lock.unlock();
+                std::this_thread::yield();
+                lock.lock();
+                continue;
+            } else if ((state & COUNT_MASK) != 0 && slot.key.load() == (uint64_t)(object)) {
+                in_slot = true;
+                writer_count = (int)((state & WRITER_MASK) / WRITER_ONE);
+                thread = slot.thread.load();
+            } else if ((state & COUNT_MASK) == 0) {
+                // There is no current use of the object or the slot.  Claim the
+                // slot; object is not in the uses map, so the overflow count
+                // does not matter here.
+                uint64_t claimed = (state + GEN_ONE) & GEN_MASK;
+                if (!slot.state.compare_exchange_strong(state, claimed | RESERVED)) {
+                    continue;
                 }
+                slot.key.store((uint64_t)(object));
+                slot.thread.store(tid);
+                slot.state.store(claimed | (write ? WRITER_ONE : READER_ONE));
+                return;
             } else {
-                // There are readers.  This writer collided with them.
-                if (use_data->thread != tid) {
-                    skipCall |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, objectType, (uint64_t)(object),
-                                        /*location*/ 0, THREADING_CHECKER_MULTIPLE_THREADS, "THREADING",
-                                        "THREADING ERROR : object of type %s is simultaneously used in thread %ld and thread %ld",
-                                        typeName, use_data->thread, tid);
-                    if (skipCall) {
-                        // Wait for thread-safe access to object instead of skipping call.
-                        while (uses.find(object) != uses.end()) {
-                            counter_condition.wait(lock);
-                        }
-                        // There is now no current use of the object.  Record writer thread.
-                        struct object_use_data *use_data = &uses[object];
-                        use_data->thread = tid;
-                        use_data->reader_count = 0;
-                        use_data->writer_count = 1;
-                    } else {
-                        // Continue with an unsafe use of the object.
-                        use_data->thread = tid;
-                        use_data->writer_count += 1;
-                    }
-                } else {
-                    // This is either safe multiple use in one call, or recursive use.
-                    // There is no way to make recursion safe.  Just forge ahead.
-                    use_data->writer_count += 1;
+                // There is no current use of the object, but the slot is used by
+                // another object.  Record the use in the uses map, unless
+                // tryStartUse claimed the slot for object in the meantime.
+                slot.overflow.fetch_add(1);
+                while ((state = slot.state.load()) & RESERVED) {
+                    std::this_thread::yield();
+                }
+                if ((state & COUNT_MASK) != 0 && slot.key.load() == (uint64_t)(object)) {
+                    slot.overflow.fetch_sub(1);
+                    continue;
+                }
+                struct object_use_data *use_data = &uses[object];
+                use_data->reader_count = write ? 0 : 1;
+                use_data->writer_count = write ? 1 : 0;
+                use_data->thread = tid;
+                return;
+            }
+
+            // Readers may share the object with readers in other threads.  Anything
+            // else only shares it with the thread that is already using it.  There
+            // is no way to make recursion safe, so that just forges ahead.
+            bool collision = (write || writer_count > 0) && thread != tid;
+            if (collision && !reported) {
+                skipCall |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, objectType, (uint64_t)(object),
+                                    /*location*/ 0, THREADING_CHECKER_MULTIPLE_THREADS, "THREADING",
+                                    "THREADING ERROR : object of type %s is simultaneously used in thread %ld and thread %ld",
+                                    typeName, thread, tid);
+                reported = true;
+            }
+            if (collision && skipCall) {
+                // Wait for thread-safe access to object instead of skipping call.
+                if (in_slot && !(state & WAITERS) && !slot.state.compare_exchange_strong(state, state | WAITERS)) {
+                    continue;
+                }
+                counter_condition.wait(lock);
+                continue;
+            }
+
+            // Continue with the use of the object, which is unsafe on a collision.
+            if (in_slot) {
+                if (!slot.state.compare_exchange_strong(state, state + (write ? WRITER_ONE : READER_ONE))) {
+                    continue;
+                }
+                if (collision && write) {
+                    slot.thread.store(tid);
                 }
+            } else if (write) {
+                use->second.writer_count += 1;
+                if (collision) {
+                    use->second.thread = tid;
+                }
+            } else {
+                use->second.reader_count += 1;
             }
+            return;
         }
     }
 
-    void finishWrite(T object) {
-        // Object is no longer in use
+    // Removes a use of object that tryFinishUse could not.
+    void finishUseLocked(T object, bool write) {
         std::unique_lock<std::mutex> lock(counter_lock);
-        uses[object].writer_count -= 1;
-        if ((uses[object].reader_count == 0) && (uses[object].writer_count == 0)) {
-            uses.erase(object);
+        auto use = uses.find(object);
+        if (use == uses.end()) {
+            // Object is not in use
+            return;
+        }
+        if (write) {
+            use->second.writer_count -= 1;
+        } else {
+            use->second.reader_count -= 1;
+        }
+        if ((use->second.reader_count == 0) && (use->second.writer_count == 0)) {
+            uses.erase(use);
+            homeSlot(object).overflow.fetch_sub(1);
         }
         // Notify any waiting threads that this object may be safe to use
         lock.unlock();
         counter_condition.notify_all();
     }
 
+  public:
+    void startWrite(debug_report_data *report_data, T object) {
+        loader_platform_thread_id tid = loader_platform_get_thread_id();
+        if (!tryStartUse(object, tid, true)) {
+            startUseLocked(report_data, object, tid, true);
+        }
+    }
+
+    void finishWrite(T object) {
+        // Object is no longer in use
+        if (!tryFinishUse(object, true)) {
+            finishUseLocked(object, true);
+        }
+    }
+
     void startRead(debug_report_data *report_data, T object) {
-        bool skipCall = false;
         loader_platform_thread_id tid = loader_platform_get_thread_id();
-        std::unique_lock<std::mutex> lock(counter_lock);
-        if (uses.find(object) == uses.end()) {
-            // There is no current use of the object.  Record reader count
-            struct object_use_data *use_data = &uses[object];
-            use_data->reader_count = 1;
-            use_data->writer_count = 0;
-            use_data->thread = tid;
-        } else if (uses[object].writer_count > 0 && uses[object].thread != tid) {
-            // There is a writer of the object.
-            skipCall |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, objectType, (uint64_t)(object),
-                                /*location*/ 0, THREADING_CHECKER_MULTIPLE_THREADS, "THREADING",
-                                "THREADING ERROR : object of type %s is simultaneously used in thread %ld and thread %ld", typeName,
-                                uses[object].thread, tid);
-            if (skipCall) {
-                // Wait for thread-safe access to object instead of skipping call.
-                while (uses.find(object) != uses.end()) {
-                    counter_condition.wait(lock);
-                }
-                // There is no current use of the object.  Record reader count
-                struct object_use_data *use_data = &uses[object];
-                use_data->reader_count = 1;
-                use_data->writer_count = 0;
-                use_data->thread = tid;
-            } else {
-                uses[object].reader_count += 1;
-            }
-        } else {
-            // There are other readers of the object.  Increase reader count
-            uses[object].reader_count += 1;
+        if (!tryStartUse(object, tid, false)) {
+            startUseLocked(report_data, object, tid, false);
         }
     }
+
     void finishRead(T object) {
-        std::unique_lock<std::mutex> lock(counter_lock);
-        uses[object].reader_count -= 1;
-        if ((uses[object].reader_count == 0) && (uses[object].writer_count == 0)) {
-            uses.erase(object);
+        if (!tryFinishUse(object, false)) {
+            finishUseLocked(object, false);
         }
-        // Notify any waiting threads that this object may be safe to use
-        lock.unlock();
-        counter_condition.notify_all();
     }
+
     counter(const char *name = "", VkDebugReportObjectTypeEXT type = VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT) {
         typeName = name;
         objectType = type;
+        for (auto &slot : slots) {
+            slot.key.store(0);
+            slot.state.store(0);
+            slot.thread.store(0);
+            slot.overflow.store(0);
+        }
     }
 };
 
@@ -27,7 +27,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <map>
+#include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <mutex>
 
@@ -42,14 +45,32 @@
 
 namespace unique_objects {
 
-// All increments must be guarded by global_lock
-static uint64_t global_unique_id = 1;
+// Handles given to the app are the addresses of these records, so unwrapping a handle is a single load that needs no lock.
+// Only wrapping a new handle and destroying one touch layer_data::unique_handles.
+struct unique_handle {
+    uint64_t actual_object;
+};
+
+// The bindings of a descriptor set layout that has immutable samplers: binding -> (descriptorCount, has immutable samplers).
+// All bindings are kept so that writes running over into the next binding can be followed.
+struct immutable_sampler_layout {
+    std::map<uint32_t, std::pair<uint32_t, bool>> bindings;
+};
+
+struct immutable_sampler_set {
+    uint64_t pool; // handle given to the app
+    std::shared_ptr<const immutable_sampler_layout> layout;
+};
 
 struct layer_data {
     VkInstance instance;
 
     bool wsi_enabled;
-    std::unordered_map<uint64_t, uint64_t> unique_id_mapping; // Map uniqueID to actual object handle
+    std::unordered_set<unique_handle *> unique_handles;           // Records of the handles wrapped for this instance or device
+    std::unordered_map<uint64_t, VkDisplayKHR> display_handles; // Map actual display handle to the one given to the app
+    // Set layouts with immutable samplers, and the sets allocated from them, keyed by the handles given to the app
+    std::unordered_map<uint64_t, std::shared_ptr<const immutable_sampler_layout>> immutable_sampler_layouts;
+    std::unordered_map<uint64_t, immutable_sampler_set> immutable_sampler_sets;
     VkPhysicalDevice gpu;
 
     layer_data() : wsi_enabled(false), gpu(VK_NULL_HANDLE){};
@@ -70,7 +91,77 @@ static std::unordered_map<void *, struct instance_extension_enables> instanceExt
 static std::unordered_map<void *, layer_data *> layer_data_map;
 static device_table_map unique_objects_device_table_map;
 static instance_table_map unique_objects_instance_table_map;
-static std::mutex global_lock; // Protect map accesses and unique_id increments
+static std::mutex global_lock; // Protect map accesses and unique_handles updates
+
+// Returns the actual object handle behind a handle this layer gave to the app
+template <typename HandleType> HandleType Unwrap(HandleType wrapped_handle) {
+    if (wrapped_handle == VK_NULL_HANDLE) {
+        return VK_NULL_HANDLE;
+    }
+    uint64_t actual_object =
+        reinterpret_cast<const unique_handle *>(static_cast<uintptr_t>(reinterpret_cast<uint64_t &>(wrapped_handle)))->actual_object;
+    return reinterpret_cast<HandleType &>(actual_object);
+}
+
+// Like Unwrap, for fields the API may ignore depending on state this layer doesn't track, where the app may
+// leave a stale or uninitialized value. Handles this layer didn't give out unwrap to VK_NULL_HANDLE instead
+// of being dereferenced. Must be called with global_lock held.
+template <typename HandleType> HandleType UnwrapIfValid(layer_data *my_data, HandleType wrapped_handle) {
+    unique_handle *record = reinterpret_cast<unique_handle *>(static_cast<uintptr_t>(reinterpret_cast<uint64_t &>(wrapped_handle)));
+    if (my_data->unique_handles.count(record) == 0) {
+        return VK_NULL_HANDLE;
+    }
+    return reinterpret_cast<HandleType &>(record->actual_object);
+}
+
+// Wraps a handle the driver just created. Must be called with global_lock held.
+template <typename HandleType> HandleType WrapNew(layer_data *my_data, HandleType actual_handle) {
+    unique_handle *record = new unique_handle;
+    record->actual_object = reinterpret_cast<uint64_t &>(actual_handle);
+    my_data->unique_handles.insert(record);
+    uint64_t wrapped_handle = reinterpret_cast<uintptr_t>(record);
+    return reinterpret_cast<HandleType &>(wrapped_handle);
+}
+
+// Unwraps a handle that is being destroyed and frees its record. Handles this layer does not know about,
+// including VK_NULL_HANDLE, unwrap to VK_NULL_HANDLE. Must be called with global_lock held.
+template <typename HandleType> HandleType UnwrapAndRelease(layer_data *my_data, HandleType wrapped_handle) {
+    unique_handle *record = reinterpret_cast<unique_handle *>(static_cast<uintptr_t>(reinterpret_cast<uint64_t &>(wrapped_handle)));
+    if (my_data->unique_handles.erase(record) == 0) {
+        return VK_NULL_HANDLE;
+    }
+    uint64_t actual_object = record->actual_object;
+    delete record;
+    return reinterpret_cast<HandleType &>(actual_object);
+}
+
+// Frees the records of handles the app never destroyed. Must be called with global_lock held.
+static void ReleaseAllWrapped(layer_data *my_data) {
+    for (auto record : my_data->unique_handles) {
+        delete record;
+    }
+    my_data->unique_handles.clear();
+    my_data->display_handles.clear();
+    my_data->immutable_sampler_layouts.clear();
+    my_data->immutable_sampler_sets.clear();
+}
+
+#ifndef __ANDROID__
+// Displays are not created by the app, so the same display is given the same handle every time it is returned.
+// Must be called with global_lock held.
+static VkDisplayKHR WrapDisplay(layer_data *my_data, VkDisplayKHR actual_display) {
+    if (actual_display == VK_NULL_HANDLE) {
+        return VK_NULL_HANDLE;
+    }
+    auto it = my_data->display_handles.find(reinterpret_cast<uint64_t &>(actual_display));
+    if (it != my_data->display_handles.end()) {
+        return it->second;
+    }
+    VkDisplayKHR wrapped_display = WrapNew(my_data, actual_display);
+    my_data->display_handles[reinterpret_cast<uint64_t &>(actual_display)] = wrapped_display;
+    return wrapped_display;
+}
+#endif
 
 struct GenericHeader {
     VkStructureType sType;
@@ -217,6 +308,10 @@ void explicit_DestroyInstance(VkInstance instance, const VkAllocationCallbacks *
     VkLayerInstanceDispatchTable *pDisp = get_dispatch_table(unique_objects_instance_table_map, instance);
     instanceExtMap.erase(pDisp);
     pDisp->DestroyInstance(instance, pAllocator);
+    {
+        std::lock_guard<std::mutex> lock(global_lock);
+        ReleaseAllWrapped(get_my_data_ptr(key, layer_data_map));
+    }
     layer_data_map.erase(key);
 }
 
@@ -272,6 +367,10 @@ VkResult explicit_CreateDevice(VkPhysicalDevice gpu, const VkDeviceCreateInfo *p
 void explicit_DestroyDevice(VkDevice device, const VkAllocationCallbacks *pAllocator) {
     dispatch_key key = get_dispatch_key(device);
     get_dispatch_table(unique_objects_device_table_map, device)->DestroyDevice(device, pAllocator);
+    {
+        std::lock_guard<std::mutex> lock(global_lock);
+        ReleaseAllWrapped(get_my_data_ptr(key, layer_data_map));
+    }
     layer_data_map.erase(key);
 }
 
@@ -299,20 +398,8 @@ VkResult explicit_AllocateMemory(VkDevice device, const VkMemoryAllocateInfo *pA
                 safe_dedicated_allocate_info->initialize(
                     reinterpret_cast<const VkDedicatedAllocationMemoryAllocateInfoNV *>(orig_pnext));
 
-                std::unique_lock<std::mutex> lock(global_lock);
-
-                if (safe_dedicated_allocate_info->buffer != VK_NULL_HANDLE) {
-                    uint64_t local_buffer = reinterpret_cast<uint64_t &>(safe_dedicated_allocate_info->buffer);
-                    safe_dedicated_allocate_info->buffer =
-                        reinterpret_cast<VkBuffer &>(my_map_data->unique_id_mapping[local_buffer]);
-                }
-
-                if (safe_dedicated_allocate_info->image != VK_NULL_HANDLE) {
-                    uint64_t local_image = reinterpret_cast<uint64_t &>(safe_dedicated_allocate_info->image);
-                    safe_dedicated_allocate_info->image = reinterpret_cast<VkImage &>(my_map_data->unique_id_mapping[local_image]);
-                }
-
-                lock.unlock();
+                safe_dedicated_allocate_info->buffer = Unwrap(safe_dedicated_allocate_info->buffer);
+                safe_dedicated_allocate_info->image = Unwrap(safe_dedicated_allocate_info->image);
 
                 input_pnext->pNext = reinterpret_cast<GenericHeader *>(safe_dedicated_allocate_info.get());
                 input_pnext = reinterpret_cast<GenericHeader *>(input_pnext->pNext);
@@ -329,9 +416,7 @@ VkResult explicit_AllocateMemory(VkDevice device, const VkMemoryAllocateInfo *pA
 
     if (VK_SUCCESS == result) {
         std::lock_guard<std::mutex> lock(global_lock);
-        uint64_t unique_id = global_unique_id++;
-        my_map_data->unique_id_mapping[unique_id] = reinterpret_cast<uint64_t &>(*pMemory);
-        *pMemory = reinterpret_cast<VkDeviceMemory &>(unique_id);
+        *pMemory = WrapNew(my_map_data, *pMemory);
     }
 
     return result;
@@ -346,43 +431,27 @@ VkResult explicit_CreateComputePipelines(VkDevice device, VkPipelineCache pipeli
     layer_data *my_device_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     safe_VkComputePipelineCreateInfo *local_pCreateInfos = NULL;
     if (pCreateInfos) {
-        std::lock_guard<std::mutex> lock(global_lock);
         local_pCreateInfos = new safe_VkComputePipelineCreateInfo[createInfoCount];
         for (uint32_t idx0 = 0; idx0 < createInfoCount; ++idx0) {
             local_pCreateInfos[idx0].initialize(&pCreateInfos[idx0]);
-            if (pCreateInfos[idx0].basePipelineHandle) {
-                local_pCreateInfos[idx0].basePipelineHandle =
-                    (VkPipeline)my_device_data
-                        ->unique_id_mapping[reinterpret_cast<const uint64_t &>(pCreateInfos[idx0].basePipelineHandle)];
-            }
-            if (pCreateInfos[idx0].layout) {
-                local_pCreateInfos[idx0].layout =
-                    (VkPipelineLayout)
-                        my_device_data->unique_id_mapping[reinterpret_cast<const uint64_t &>(pCreateInfos[idx0].layout)];
-            }
-            if (pCreateInfos[idx0].stage.module) {
-                local_pCreateInfos[idx0].stage.module =
-                    (VkShaderModule)
-                        my_device_data->unique_id_mapping[reinterpret_cast<const uint64_t &>(pCreateInfos[idx0].stage.module)];
+            // basePipelineHandle is ignored, and may hold anything, unless the pipeline is a derivative
+            if (pCreateInfos[idx0].flags & VK_PIPELINE_CREATE_DERIVATIVE_BIT) {
+                local_pCreateInfos[idx0].basePipelineHandle = Unwrap(pCreateInfos[idx0].basePipelineHandle);
             }
+            local_pCreateInfos[idx0].layout = Unwrap(pCreateInfos[idx0].layout);
+            local_pCreateInfos[idx0].stage.module = Unwrap(pCreateInfos[idx0].stage.module);
         }
     }
-    if (pipelineCache) {
-        std::lock_guard<std::mutex> lock(global_lock);
-        pipelineCache = (VkPipelineCache)my_device_data->unique_id_mapping[reinterpret_cast<uint64_t &>(pipelineCache)];
-    }
+    pipelineCache = Unwrap(pipelineCache);
 
     VkResult result = get_dispatch_table(unique_objects_device_table_map, device)
                           ->CreateComputePipelines(device, pipelineCache, createInfoCount,
                                                    (const VkComputePipelineCreateInfo *)local_pCreateInfos, pAllocator, pPipelines);
     delete[] local_pCreateInfos;
     if (VK_SUCCESS == result) {
-        uint64_t unique_id = 0;
         std::lock_guard<std::mutex> lock(global_lock);
         for (uint32_t i = 0; i < createInfoCount; ++i) {
-            unique_id = global_unique_id++;
-            my_device_data->unique_id_mapping[unique_id] = reinterpret_cast<uint64_t &>(pPipelines[i]);
-            pPipelines[i] = reinterpret_cast<VkPipeline &>(unique_id);
+            pPipelines[i] = WrapNew(my_device_data, pPipelines[i]);
         }
     }
     return result;
@@ -398,39 +467,22 @@ VkResult explicit_CreateGraphicsPipelines(VkDevice device, VkPipelineCache pipel
     safe_VkGraphicsPipelineCreateInfo *local_pCreateInfos = NULL;
     if (pCreateInfos) {
         local_pCreateInfos = new safe_VkGraphicsPipelineCreateInfo[createInfoCount];
-        std::lock_guard<std::mutex> lock(global_lock);
         for (uint32_t idx0 = 0; idx0 < createInfoCount; ++idx0) {
             local_pCreateInfos[idx0].initialize(&pCreateInfos[idx0]);
-            if (pCreateInfos[idx0].basePipelineHandle) {
-                local_pCreateInfos[idx0].basePipelineHandle =
-                    (VkPipeline)my_device_data
-                        ->unique_id_mapping[reinterpret_cast<const uint64_t &>(pCreateInfos[idx0].basePipelineHandle)];
-            }
-            if (pCreateInfos[idx0].layout) {
-                local_pCreateInfos[idx0].layout =
-                    (VkPipelineLayout)
-                        my_device_data->unique_id_mapping[reinterpret_cast<const uint64_t &>(pCreateInfos[idx0].layout)];
+            // basePipelineHandle is ignored, and may hold anything, unless the pipeline is a derivative
+            if (pCreateInfos[idx0].flags & VK_PIPELINE_CREATE_DERIVATIVE_BIT) {
+                local_pCreateInfos[idx0].basePipelineHandle = Unwrap(pCreateInfos[idx0].basePipelineHandle);
             }
+            local_pCreateInfos[idx0].layout = Unwrap(pCreateInfos[idx0].layout);
             if (pCreateInfos[idx0].pStages) {
                 for (uint32_t idx1 = 0; idx1 < pCreateInfos[idx0].stageCount; ++idx1) {
-                    if (pCreateInfos[idx0].pStages[idx1].module) {
-                        local_pCreateInfos[idx0].pStages[idx1].module =
-                            (VkShaderModule)my_device_data
-                                ->unique_id_mapping[reinterpret_cast<const uint64_t &>(pCreateInfos[idx0].pStages[idx1].module)];
-                    }
+                    local_pCreateInfos[idx0].pStages[idx1].module = Unwrap(pCreateInfos[idx0].pStages[idx1].module);
                 }
             }
-            if (pCreateInfos[idx0].renderPass) {
-                local_pCreateInfos[idx0].renderPass =
-                    (VkRenderPass)
-                        my_device_data->unique_id_mapping[reinterpret_cast<const uint64_t &>(pCreateInfos[idx0].renderPass)];
-            }
+            local_pCreateInfos[idx0].renderPass = Unwrap(pCreateInfos[idx0].renderPass);
         }
     }
-    if (pipelineCache) {
-        std::lock_guard<std::mutex> lock(global_lock);
-        pipelineCache = (VkPipelineCache)my_device_data->unique_id_mapping[reinterpret_cast<uint64_t &>(pipelineCache)];
-    }
+    pipelineCache = Unwrap(pipelineCache);
 
     VkResult result =
         get_dispatch_table(unique_objects_device_table_map, device)
@@ -438,31 +490,277 @@ VkResult explicit_CreateGraphicsPipelines(VkDevice device, VkPipelineCache pipel
                                       (const VkGraphicsPipelineCreateInfo *)local_pCreateInfos, pAllocator, pPipelines);
     delete[] local_pCreateInfos;
     if (VK_SUCCESS == result) {
-        uint64_t unique_id = 0;
         std::lock_guard<std::mutex> lock(global_lock);
         for (uint32_t i = 0; i < createInfoCount; ++i) {
-            unique_id = global_unique_id++;
-            my_device_data->unique_id_mapping[unique_id] = reinterpret_cast<uint64_t &>(pPipelines[i]);
-            pPipelines[i] = reinterpret_cast<VkPipeline &>(unique_id);
+            pPipelines[i] = WrapNew(my_device_data, pPipelines[i]);
         }
     }
     return result;
 }
 
+// Whether the descriptor written idx descriptors into write is in a binding with immutable samplers. Writes may run
+// over into the following bindings.
+static bool UsesImmutableSampler(const immutable_sampler_layout &layout, const VkWriteDescriptorSet &write, uint32_t idx) {
+    auto binding = layout.bindings.find(write.dstBinding);
+    uint32_t element = write.dstArrayElement + idx;
+    while (binding != layout.bindings.end() && element >= binding->second.first) {
+        element -= binding->second.first;
+        ++binding;
+    }
+    return binding != layout.bindings.end() && binding->second.second;
+}
+
+void explicit_UpdateDescriptorSets(VkDevice device, uint32_t descriptorWriteCount, const VkWriteDescriptorSet *pDescriptorWrites,
+                                   uint32_t descriptorCopyCount, const VkCopyDescriptorSet *pDescriptorCopies) {
+    // Only the handles the descriptor type uses are unwrapped, as the others are ignored and may hold anything.
+    // The sampler is also ignored, and passed down as VK_NULL_HANDLE, for bindings with immutable samplers.
+    layer_data *my_device_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
+    safe_VkWriteDescriptorSet *local_pDescriptorWrites = NULL;
+    safe_VkCopyDescriptorSet *local_pDescriptorCopies = NULL;
+    if (pDescriptorWrites) {
+        std::unique_lock<std::mutex> lock(global_lock, std::defer_lock);
+        local_pDescriptorWrites = new safe_VkWriteDescriptorSet[descriptorWriteCount];
+        for (uint32_t idx0 = 0; idx0 < descriptorWriteCount; ++idx0) {
+            safe_VkWriteDescriptorSet &write = local_pDescriptorWrites[idx0];
+            write.initialize(&pDescriptorWrites[idx0]);
+            write.dstSet = Unwrap(write.dstSet);
+            if (write.pImageInfo) {
+                bool uses_sampler = (write.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER ||
+                                     write.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+                bool uses_image_view = (write.descriptorType != VK_DESCRIPTOR_TYPE_SAMPLER);
+                const immutable_sampler_layout *layout = NULL;
+                if (uses_sampler) {
+                    if (!lock.owns_lock()) {
+                        lock.lock();
+                    }
+                    auto set = my_device_data->immutable_sampler_sets.find(reinterpret_cast<const uint64_t &>(pDescriptorWrites[idx0].dstSet));
+                    if (set != my_device_data->immutable_sampler_sets.end()) {
+                        layout = set->second.layout.get();
+                    }
+                }
+                for (uint32_t idx1 = 0; idx1 < write.descriptorCount; ++idx1) {
+                    if (uses_sampler) {
+                        if (layout && UsesImmutableSampler(*layout, pDescriptorWrites[idx0], idx1)) {
+                            write.pImageInfo[idx1].sampler = VK_NULL_HANDLE;
+                        } else {
+                            write.pImageInfo[idx1].sampler = Unwrap(write.pImageInfo[idx1].sampler);
+                        }
+                    }
+                    if (uses_image_view) {
+                        write.pImageInfo[idx1].imageView = Unwrap(write.pImageInfo[idx1].imageView);
+                    }
+                }
+            }
+            if (write.pBufferInfo) {
+                for (uint32_t idx1 = 0; idx1 < write.descriptorCount; ++idx1) {
+                    write.pBufferInfo[idx1].buffer = Unwrap(write.pBufferInfo[idx1].buffer);
+                }
+            }
+            if (write.pTexelBufferView) {
+                for (uint32_t idx1 = 0; idx1 < write.descriptorCount; ++idx1) {
+                    write.pTexelBufferView[idx1] = Unwrap(write.pTexelBufferView[idx1]);
+                }
+            }
+        }
+    }
+    if (pDescriptorCopies) {
+        local_pDescriptorCopies = new safe_VkCopyDescriptorSet[descriptorCopyCount];
+        for (uint32_t idx0 = 0; idx0 < descriptorCopyCount; ++idx0) {
+            local_pDescriptorCopies[idx0].initialize(&pDescriptorCopies[idx0]);
+            local_pDescriptorCopies[idx0].srcSet = Unwrap(pDescriptorCopies[idx0].srcSet);
+            local_pDescriptorCopies[idx0].dstSet = Unwrap(pDescriptorCopies[idx0].dstSet);
+        }
+    }
+
+    get_dispatch_table(unique_objects_device_table_map, device)
+        ->UpdateDescriptorSets(device, descriptorWriteCount, (const VkWriteDescriptorSet *)local_pDescriptorWrites,
+                               descriptorCopyCount, (const VkCopyDescriptorSet *)local_pDescriptorCopies);
+    delete[] local_pDescriptorWrites;
+    delete[] local_pDescriptorCopies;
+}
+
+VkResult explicit_CreateDescriptorSetLayout(VkDevice device, const VkDescriptorSetLayoutCreateInfo *pCreateInfo,
+                                           const VkAllocationCallbacks *pAllocator, VkDescriptorSetLayout *pSetLayout) {
+    layer_data *my_device_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
+    safe_VkDescriptorSetLayoutCreateInfo *local_pCreateInfo = NULL;
+    std::shared_ptr<immutable_sampler_layout> sampler_layout;
+    if (pCreateInfo) {
+        local_pCreateInfo = new safe_VkDescriptorSetLayoutCreateInfo(pCreateInfo);
+        for (uint32_t idx0 = 0; idx0 < local_pCreateInfo->bindingCount; ++idx0) {
+            // pImmutableSamplers is ignored, and may hold anything, unless the binding holds samplers
+            safe_VkDescriptorSetLayoutBinding &binding = local_pCreateInfo->pBindings[idx0];
+            if (binding.pImmutableSamplers && (binding.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER ||
+                                               binding.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)) {
+                for (uint32_t idx1 = 0; idx1 < binding.descriptorCount; ++idx1) {
+                    binding.pImmutableSamplers[idx1] = Unwrap(pCreateInfo->pBindings[idx0].pImmutableSamplers[idx1]);
+                }
+                if (!sampler_layout) {
+                    sampler_layout = std::make_shared<immutable_sampler_layout>();
+                }
+            }
+        }
+        if (sampler_layout) {
+            for (uint32_t idx0 = 0; idx0 < pCreateInfo->bindingCount; ++idx0) {
+                const VkDescriptorSetLayoutBinding &binding = pCreateInfo->pBindings[idx0];
+                bool immutable = binding.pImmutableSamplers && (binding.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER ||
+                                                                binding.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+                if (binding.descriptorCount) {
+                    sampler_layout->bindings[binding.binding] = std::make_pair(binding.descriptorCount, immutable);
+                }
+            }
+        }
+    }
+
+    VkResult result = get_dispatch_table(unique_objects_device_table_map, device)
+                          ->CreateDescriptorSetLayout(device, (const VkDescriptorSetLayoutCreateInfo *)local_pCreateInfo,
+                                                      pAllocator, pSetLayout);
+    delete local_pCreateInfo;
+    if (VK_SUCCESS == result) {
+        std::lock_guard<std::mutex> lock(global_lock);
+        *pSetLayout = WrapNew(my_device_data, *pSetLayout);
+        if (sampler_layout) {
+            my_device_data->immutable_sampler_layouts[reinterpret_cast<uint64_t &>(*pSetLayout)] = sampler_layout;
+        }
+    }
+    return result;
+}
+
+void explicit_DestroyDescriptorSetLayout(VkDevice device, VkDescriptorSetLayout descriptorSetLayout,
+                                         const VkAllocationCallbacks *pAllocator) {
+    layer_data *my_device_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
+    std::unique_lock<std::mutex> lock(global_lock);
+    // Sets allocated from the layout keep their own reference to its bindings
+    my_device_data->immutable_sampler_layouts.erase(reinterpret_cast<uint64_t &>(descriptorSetLayout));
+    descriptorSetLayout = UnwrapAndRelease(my_device_data, descriptorSetLayout);
+    lock.unlock();
+    get_dispatch_table(unique_objects_device_table_map, device)->DestroyDescriptorSetLayout(device, descriptorSetLayout, pAllocator);
+}
+
+VkResult explicit_AllocateDescriptorSets(VkDevice device, const VkDescriptorSetAllocateInfo *pAllocateInfo,
+                                         VkDescriptorSet *pDescriptorSets) {
+    layer_data *my_device_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
+    safe_VkDescriptorSetAllocateInfo *local_pAllocateInfo = NULL;
+    if (pAllocateInfo) {
+        local_pAllocateInfo = new safe_VkDescriptorSetAllocateInfo(pAllocateInfo);
+        local_pAllocateInfo->descriptorPool = Unwrap(pAllocateInfo->descriptorPool);
+        if (local_pAllocateInfo->pSetLayouts) {
+            for (uint32_t idx0 = 0; idx0 < pAllocateInfo->descriptorSetCount; ++idx0) {
+                local_pAllocateInfo->pSetLayouts[idx0] = Unwrap(pAllocateInfo->pSetLayouts[idx0]);
+            }
+        }
+    }
+    VkResult result = get_dispatch_table(unique_objects_device_table_map, device)
+                          ->AllocateDescriptorSets(device, (const VkDescriptorSetAllocateInfo *)local_pAllocateInfo, pDescriptorSets);
+    delete local_pAllocateInfo;
+    if (VK_SUCCESS == result) {
+        std::lock_guard<std::mutex> lock(global_lock);
+        for (uint32_t i = 0; i < pAllocateInfo->descriptorSetCount; ++i) {
+            pDescriptorSets[i] = WrapNew(my_device_data, pDescriptorSets[i]);
+            auto layout = my_device_data->immutable_sampler_layouts.find(reinterpret_cast<const uint64_t &>(pAllocateInfo->pSetLayouts[i]));
+            if (layout != my_device_data->immutable_sampler_layouts.end()) {
+                immutable_sampler_set &set = my_device_data->immutable_sampler_sets[reinterpret_cast<uint64_t &>(pDescriptorSets[i])];
+                set.pool = reinterpret_cast<const uint64_t &>(pAllocateInfo->descriptorPool);
+                set.layout = layout->second;
+            }
+        }
+    }
+    return result;
+}
+
+// Forgets the sets of pool, or only the ones in pDescriptorSets. Must be called with global_lock held.
+static void ForgetImmutableSamplerSets(layer_data *my_data, VkDescriptorPool pool, uint32_t descriptorSetCount,
+                                       const VkDescriptorSet *pDescriptorSets) {
+    if (my_data->immutable_sampler_sets.empty()) {
+        return;
+    }
+    if (pDescriptorSets) {
+        for (uint32_t i = 0; i < descriptorSetCount; ++i) {
+            my_data->immutable_sampler_sets.erase(reinterpret_cast<const uint64_t &>(pDescriptorSets[i]));
+        }
+        return;
+    }
+    for (auto it = my_data->immutable_sampler_sets.begin(); it != my_data->immutable_sampler_sets.end();) {
+        if (it->second.pool == reinterpret_cast<uint64_t &>(pool)) {
+            it = my_data->immutable_sampler_sets.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+VkResult explicit_FreeDescriptorSets(VkDevice device, VkDescriptorPool descriptorPool, uint32_t descriptorSetCount,
+                                     const VkDescriptorSet *pDescriptorSets) {
+    layer_data *my_device_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
+    VkDescriptorSet *local_pDescriptorSets = NULL;
+    if (pDescriptorSets) {
+        std::lock_guard<std::mutex> lock(global_lock);
+        ForgetImmutableSamplerSets(my_device_data, descriptorPool, descriptorSetCount, pDescriptorSets);
+        local_pDescriptorSets = new VkDescriptorSet[descriptorSetCount];
+        for (uint32_t idx0 = 0; idx0 < descriptorSetCount; ++idx0) {
+            local_pDescriptorSets[idx0] = Unwrap(pDescriptorSets[idx0]);
+        }
+    }
+    VkResult result = get_dispatch_table(unique_objects_device_table_map, device)
+                          ->FreeDescriptorSets(device, Unwrap(descriptorPool), descriptorSetCount, local_pDescriptorSets);
+    delete[] local_pDescriptorSets;
+    return result;
+}
+
+VkResult explicit_ResetDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool, VkDescriptorPoolResetFlags flags) {
+    layer_data *my_device_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
+    {
+        std::lock_guard<std::mutex> lock(global_lock);
+        ForgetImmutableSamplerSets(my_device_data, descriptorPool, 0, NULL);
+    }
+    return get_dispatch_table(unique_objects_device_table_map, device)->ResetDescriptorPool(device, Unwrap(descriptorPool), flags);
+}
+
+void explicit_DestroyDescriptorPool(VkDevice device, VkDescriptorPool descriptorPool, const VkAllocationCallbacks *pAllocator) {
+    layer_data *my_device_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
+    std::unique_lock<std::mutex> lock(global_lock);
+    ForgetImmutableSamplerSets(my_device_data, descriptorPool, 0, NULL);
+    descriptorPool = UnwrapAndRelease(my_device_data, descriptorPool);
+    lock.unlock();
+    get_dispatch_table(unique_objects_device_table_map, device)->DestroyDescriptorPool(device, descriptorPool, pAllocator);
+}
+
+VkResult explicit_BeginCommandBuffer(VkCommandBuffer commandBuffer, const VkCommandBufferBeginInfo *pBeginInfo) {
+    // The inheritance info is only read for secondary command buffers, and its render pass and framebuffer only
+    // with RENDER_PASS_CONTINUE. This layer doesn't know the level of commandBuffer, so they are looked up rather
+    // than dereferenced.
+    layer_data *my_device_data = get_my_data_ptr(get_dispatch_key(commandBuffer), layer_data_map);
+    safe_VkCommandBufferBeginInfo *local_pBeginInfo = NULL;
+    if (pBeginInfo) {
+        local_pBeginInfo = new safe_VkCommandBufferBeginInfo(pBeginInfo);
+        if (local_pBeginInfo->pInheritanceInfo) {
+            if (pBeginInfo->flags & VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT) {
+                std::lock_guard<std::mutex> lock(global_lock);
+                local_pBeginInfo->pInheritanceInfo->renderPass =
+                    UnwrapIfValid(my_device_data, pBeginInfo->pInheritanceInfo->renderPass);
+                local_pBeginInfo->pInheritanceInfo->framebuffer =
+                    UnwrapIfValid(my_device_data, pBeginInfo->pInheritanceInfo->framebuffer);
+            } else {
+                local_pBeginInfo->pInheritanceInfo->renderPass = VK_NULL_HANDLE;
+                local_pBeginInfo->pInheritanceInfo->framebuffer = VK_NULL_HANDLE;
+            }
+        }
+    }
+
+    VkResult result = get_dispatch_table(unique_objects_device_table_map, commandBuffer)
+                          ->BeginCommandBuffer(commandBuffer, (const VkCommandBufferBeginInfo *)local_pBeginInfo);
+    delete local_pBeginInfo;
+    return result;
+}
+
 VkResult explicit_CreateSwapchainKHR(VkDevice device, const VkSwapchainCreateInfoKHR *pCreateInfo,
                                      const VkAllocationCallbacks *pAllocator, VkSwapchainKHR *pSwapchain) {
     layer_data *my_map_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
 
     safe_VkSwapchainCreateInfoKHR *local_pCreateInfo = NULL;
     if (pCreateInfo) {
-        std::lock_guard<std::mutex> lock(global_lock);
         local_pCreateInfo = new safe_VkSwapchainCreateInfoKHR(pCreateInfo);
-        local_pCreateInfo->oldSwapchain =
-            (VkSwapchainKHR)my_map_data->unique_id_mapping[reinterpret_cast<const uint64_t &>(pCreateInfo->oldSwapchain)];
-        // Need to pull surface mapping from the instance-level map
-        layer_data *instance_data = get_my_data_ptr(get_dispatch_key(my_map_data->gpu), layer_data_map);
-        local_pCreateInfo->surface =
-            (VkSurfaceKHR)instance_data->unique_id_mapping[reinterpret_cast<const uint64_t &>(pCreateInfo->surface)];
+        local_pCreateInfo->oldSwapchain = Unwrap(pCreateInfo->oldSwapchain);
+        local_pCreateInfo->surface = Unwrap(pCreateInfo->surface);
     }
 
     VkResult result = get_dispatch_table(unique_objects_device_table_map, device)
@@ -471,9 +769,7 @@ VkResult explicit_CreateSwapchainKHR(VkDevice device, const VkSwapchainCreateInf
         delete local_pCreateInfo;
     if (VK_SUCCESS == result) {
         std::lock_guard<std::mutex> lock(global_lock);
-        uint64_t unique_id =global_unique_id++;
-        my_map_data->unique_id_mapping[unique_id] = reinterpret_cast<uint64_t &>(*pSwapchain);
-        *pSwapchain = reinterpret_cast<VkSwapchainKHR &>(unique_id);
+        *pSwapchain = WrapNew(my_map_data, *pSwapchain);
     }
     return result;
 }
@@ -483,21 +779,15 @@ VkResult explicit_GetSwapchainImagesKHR(VkDevice device, VkSwapchainKHR swapchai
     // UNWRAP USES:
     //  0 : swapchain,VkSwapchainKHR, pSwapchainImages,VkImage
     layer_data *my_device_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
-    if (VK_NULL_HANDLE != swapchain) {
-        std::lock_guard<std::mutex> lock(global_lock);
-        swapchain = (VkSwapchainKHR)my_device_data->unique_id_mapping[reinterpret_cast<uint64_t &>(swapchain)];
-    }
+    swapchain = Unwrap(swapchain);
     VkResult result = get_dispatch_table(unique_objects_device_table_map, device)
                           ->GetSwapchainImagesKHR(device, swapchain, pSwapchainImageCount, pSwapchainImages);
     // TODO : Need to add corresponding code to delete these images
     if (VK_SUCCESS == result) {
         if ((*pSwapchainImageCount > 0) && pSwapchainImages) {
-            uint64_t unique_id = 0;
             std::lock_guard<std::mutex> lock(global_lock);
             for (uint32_t i = 0; i < *pSwapchainImageCount; ++i) {
-                unique_id = global_unique_id++;
-                my_device_data->unique_id_mapping[unique_id] = reinterpret_cast<uint64_t &>(pSwapchainImages[i]);
-                pSwapchainImages[i] = reinterpret_cast<VkImage &>(unique_id);
+                pSwapchainImages[i] = WrapNew(my_device_data, pSwapchainImages[i]);
             }
         }
     }
@@ -509,28 +799,16 @@ VkResult explicit_GetPhysicalDeviceDisplayPropertiesKHR(VkPhysicalDevice physica
 {
     layer_data *my_map_data = get_my_data_ptr(get_dispatch_key(physicalDevice), layer_data_map);
     safe_VkDisplayPropertiesKHR* local_pProperties = NULL;
-    {
-        std::lock_guard<std::mutex> lock(global_lock);
-        if (pProperties) {
-            local_pProperties = new safe_VkDisplayPropertiesKHR[*pPropertyCount];
-            for (uint32_t idx0=0; idx0<*pPropertyCount; ++idx0) {
-                local_pProperties[idx0].initialize(&pProperties[idx0]);
-                if (pProperties[idx0].display) {
-                    local_pProperties[idx0].display = (VkDisplayKHR)my_map_data->unique_id_mapping[reinterpret_cast<const uint64_t &>(pProperties[idx0].display)];
-                }
-            }
-        }
+    if (pProperties) {
+        local_pProperties = new safe_VkDisplayPropertiesKHR[*pPropertyCount];
     }
 
     VkResult result = get_dispatch_table(unique_objects_instance_table_map, physicalDevice)->GetPhysicalDeviceDisplayPropertiesKHR(physicalDevice, pPropertyCount, ( VkDisplayPropertiesKHR*)local_pProperties);
     if (result == VK_SUCCESS && pProperties)
     {
+        std::lock_guard<std::mutex> lock(global_lock);
         for (uint32_t idx0=0; idx0<*pPropertyCount; ++idx0) {
-            std::lock_guard<std::mutex> lock(global_lock);
-
-            uint64_t unique_id = global_unique_id++;
-            my_map_data->unique_id_mapping[unique_id] = reinterpret_cast<uint64_t &>(local_pProperties[idx0].display);
-            pProperties[idx0].display = reinterpret_cast<VkDisplayKHR&>(unique_id);
+            pProperties[idx0].display = WrapDisplay(my_map_data, local_pProperties[idx0].display);
             pProperties[idx0].displayName = local_pProperties[idx0].displayName;
             pProperties[idx0].physicalDimensions = local_pProperties[idx0].physicalDimensions;
             pProperties[idx0].physicalResolution = local_pProperties[idx0].physicalResolution;
@@ -552,9 +830,7 @@ VkResult explicit_GetDisplayPlaneSupportedDisplaysKHR(VkPhysicalDevice physicalD
         if ((*pDisplayCount > 0) && pDisplays) {
             std::lock_guard<std::mutex> lock(global_lock);
             for (uint32_t i = 0; i < *pDisplayCount; i++) {
-		    auto it = my_map_data->unique_id_mapping.find(reinterpret_cast<const uint64_t &> (pDisplays[i]));
-                assert (it !=  my_map_data->unique_id_mapping.end());
-                pDisplays[i] = reinterpret_cast<VkDisplayKHR&> (it->second);
+                pDisplays[i] = WrapDisplay(my_map_data, pDisplays[i]);
             }
         }
     }
@@ -566,26 +842,17 @@ VkResult explicit_GetDisplayModePropertiesKHR(VkPhysicalDevice physicalDevice, V
 {
     layer_data *my_map_data = get_my_data_ptr(get_dispatch_key(physicalDevice), layer_data_map);
     safe_VkDisplayModePropertiesKHR* local_pProperties = NULL;
-    {
-        std::lock_guard<std::mutex> lock(global_lock);
-        display = (VkDisplayKHR)my_map_data->unique_id_mapping[reinterpret_cast<uint64_t &>(display)];
-        if (pProperties) {
-            local_pProperties = new safe_VkDisplayModePropertiesKHR[*pPropertyCount];
-            for (uint32_t idx0=0; idx0<*pPropertyCount; ++idx0) {
-                local_pProperties[idx0].initialize(&pProperties[idx0]);
-            }
-        }
+    display = Unwrap(display);
+    if (pProperties) {
+        local_pProperties = new safe_VkDisplayModePropertiesKHR[*pPropertyCount];
     }
 
     VkResult result = get_dispatch_table(unique_objects_instance_table_map, physicalDevice)->GetDisplayModePropertiesKHR(physicalDevice, display, pPropertyCount, ( VkDisplayModePropertiesKHR*)local_pProperties);
     if (result == VK_SUCCESS && pProperties)
     {
+        std::lock_guard<std::mutex> lock(global_lock);
         for (uint32_t idx0=0; idx0<*pPropertyCount; ++idx0) {
-            std::lock_guard<std::mutex> lock(global_lock);
-
-            uint64_t unique_id = global_unique_id++;
-            my_map_data->unique_id_mapping[unique_id] = reinterpret_cast<uint64_t &>(local_pProperties[idx0].displayMode);
-            pProperties[idx0].displayMode = reinterpret_cast<VkDisplayModeKHR&>(unique_id);
+            pProperties[idx0].displayMode = WrapNew(my_map_data, local_pProperties[idx0].displayMode);
             pProperties[idx0].parameters.visibleRegion.width = local_pProperties[idx0].parameters.visibleRegion.width;
             pProperties[idx0].parameters.visibleRegion.height = local_pProperties[idx0].parameters.visibleRegion.height;
             pProperties[idx0].parameters.refreshRate = local_pProperties[idx0].parameters.refreshRate;
@@ -595,5 +862,19 @@ VkResult explicit_GetDisplayModePropertiesKHR(VkPhysicalDevice physicalDevice, V
         delete[] local_pProperties;
     return result;
 }
+
+VkResult explicit_GetPhysicalDeviceDisplayPlanePropertiesKHR(VkPhysicalDevice physicalDevice, uint32_t* pPropertyCount, VkDisplayPlanePropertiesKHR* pProperties)
+{
+    layer_data *my_map_data = get_my_data_ptr(get_dispatch_key(physicalDevice), layer_data_map);
+    VkResult result = get_dispatch_table(unique_objects_instance_table_map, physicalDevice)->GetPhysicalDeviceDisplayPlanePropertiesKHR(physicalDevice, pPropertyCount, pProperties);
+    if ((result == VK_SUCCESS || result == VK_INCOMPLETE) && pProperties)
+    {
+        std::lock_guard<std::mutex> lock(global_lock);
+        for (uint32_t idx0=0; idx0<*pPropertyCount; ++idx0) {
+            pProperties[idx0].currentDisplay = WrapDisplay(my_map_data, pProperties[idx0].currentDisplay);
+        }
+    }
+    return result;
+}
 #endif
 } // namespace unique_objects
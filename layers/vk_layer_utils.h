@@ -20,6 +20,7 @@
 
 #pragma once
 #include <stdbool.h>
+#include <string.h>
 #include <vector>
 #include "vk_layer_logging.h"
 
@@ -132,3 +133,23 @@ static inline int u_ffs(int val) {
 #ifdef __cplusplus
 }
 #endif
+
+#ifdef __cplusplus
+// Finds name in a table of { name, proc } entries sorted by name in strcmp
+// order, such as the intercept tables behind GetDeviceProcAddr.
+template <typename Entry, size_t N> const Entry *layer_find_sorted_command(const Entry (&table)[N], const char *name) {
+    size_t low = 0;
+    size_t high = N;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        int order = strcmp(name, table[middle].name);
+        if (order == 0)
+            return &table[middle];
+        if (order < 0)
+            high = middle;
+        else
+            low = middle + 1;
+    }
+    return nullptr;
+}
+#endif
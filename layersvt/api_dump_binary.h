@@ -0,0 +1,394 @@
+/*
+ *
+ * Copyright (C) 2016 Valve Corporation
+ * Copyright (C) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "vk_loader_platform.h"
+
+/*
+ * Binary output for the api_dump layer, and the file format that api_dump_format reads.
+ *
+ * In binary mode each app thread copies the raw arguments of a call into a ring of its own, without
+ * taking a lock, and a background thread writes the rings to the file.  No formatting happens while
+ * the app runs; api_dump_format renders the file as text or JSON afterwards.
+ *
+ * A file starts with an ApiDumpBinaryFileHeader, followed by the function table and then the enum
+ * table, so that api_dump_format needs no knowledge of the Vulkan API version that was dumped:
+ *
+ *   function: name, return kind, return enum index, param count, then per param:
+ *             name, type, kind, enum index
+ *   enum:     name, value count, then per value: int64_t value, name
+ *
+ * Strings are a uint32_t length followed by that many bytes, and all other fields are uint32_t
+ * unless noted.  The rest of the file is records: an ApiDumpBinaryRecord followed by argCount
+ * uint64_t arguments.  Records from different threads are interleaved in the order the rings were
+ * written, so readers put them back in call order using the sequence number.
+ */
+
+#define API_DUMP_BINARY_MAGIC 0x42444156 // "VADB"
+#define API_DUMP_BINARY_VERSION 1
+#define API_DUMP_BINARY_RING_SIZE (1 << 20)
+
+// How api_dump_format renders an argument or return value
+enum ApiDumpArgKind {
+    API_DUMP_ARG_NONE,     // void return
+    API_DUMP_ARG_UNSIGNED, // decimal
+    API_DUMP_ARG_SIGNED,   // decimal, sign extended to 64 bits
+    API_DUMP_ARG_FLOAT,    // bits of a float in the low 32 bits
+    API_DUMP_ARG_HEX,      // handles, pointers and flags
+    API_DUMP_ARG_ENUM,     // name from the enum table, sign extended to 64 bits
+};
+
+struct ApiDumpBinaryFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t funcCount;
+    uint32_t enumCount;
+};
+
+struct ApiDumpBinaryRecord {
+    uint32_t size; // of the record, including the arguments
+    uint32_t funcIndex;
+    uint64_t sequence;
+    uint64_t frame;
+    uint64_t result;
+    uint32_t thread;
+    uint32_t argCount;
+};
+
+struct ApiDumpParamDesc {
+    const char *name;
+    const char *type;
+    uint32_t kind;
+    int32_t enumIndex;
+};
+
+struct ApiDumpFuncDesc {
+    const char *name;
+    uint32_t returnKind;
+    int32_t returnEnumIndex;
+    uint32_t paramCount;
+    const ApiDumpParamDesc *params;
+};
+
+struct ApiDumpEnumValueDesc {
+    int64_t value;
+    const char *name;
+};
+
+struct ApiDumpEnumDesc {
+    const char *name;
+    uint32_t valueCount;
+    const ApiDumpEnumValueDesc *values;
+};
+
+// Argument capture used by the generated layer.  Arrays decay to pointers and are recorded as addresses.
+template <typename T> static inline uint64_t apiDumpArg(T *value) { return (uint64_t)(uintptr_t)value; }
+template <typename T> static inline uint64_t apiDumpArg(T value) { return (uint64_t)value; }
+static inline uint64_t apiDumpArg(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// Single producer (the app thread that owns it), single consumer (whoever holds drainLock)
+struct ApiDumpBinaryRing {
+    uint8_t data[API_DUMP_BINARY_RING_SIZE];
+    std::atomic<uint64_t> head;
+    std::atomic<uint64_t> tail;
+};
+
+class ApiDumpBinaryWriter;
+
+// The ring a thread records into.  Its destructor is the thread-exit hook that hands the ring back to the writer.
+struct ApiDumpBinaryThreadSlot {
+    ApiDumpBinaryWriter *writer = NULL;
+    ApiDumpBinaryRing *ring = NULL;
+    uint64_t generation = 0;
+    uint32_t thread = 0;
+
+    inline ~ApiDumpBinaryThreadSlot();
+};
+
+// Rings of exited threads kept for reuse; any beyond this are freed when their thread exits
+#define API_DUMP_BINARY_FREE_RINGS 4
+
+class ApiDumpBinaryWriter {
+  public:
+    ApiDumpBinaryWriter() : file(NULL), instanceCount(0), stop(false), generation(1), nextThread(0), nextSequence(0) {}
+
+    // Only reached if the app exits without destroying its instances.  App threads may still be recording then, so
+    // the rings they own are left to the process exit instead of being freed under them.
+    ~ApiDumpBinaryWriter() {
+        if (!file) {
+            return;
+        }
+        stopWriter();
+        flush();
+        std::lock_guard<std::mutex> lock(ringsLock);
+        fclose(file);
+        file = NULL;
+        generation++;
+    }
+
+    bool open(const char *fileName, const ApiDumpFuncDesc *funcs, uint32_t funcCount, const ApiDumpEnumDesc *enums,
+              uint32_t enumCount) {
+        file = fopen(fileName, "wb");
+        if (!file) {
+            return false;
+        }
+
+        ApiDumpBinaryFileHeader header = {API_DUMP_BINARY_MAGIC, API_DUMP_BINARY_VERSION, funcCount, enumCount};
+        fwrite(&header, sizeof(header), 1, file);
+        for (uint32_t i = 0; i < funcCount; i++) {
+            writeString(funcs[i].name);
+            writeU32(funcs[i].returnKind);
+            writeU32((uint32_t)funcs[i].returnEnumIndex);
+            writeU32(funcs[i].paramCount);
+            for (uint32_t j = 0; j < funcs[i].paramCount; j++) {
+                writeString(funcs[i].params[j].name);
+                writeString(funcs[i].params[j].type);
+                writeU32(funcs[i].params[j].kind);
+                writeU32((uint32_t)funcs[i].params[j].enumIndex);
+            }
+        }
+        for (uint32_t i = 0; i < enumCount; i++) {
+            writeString(enums[i].name);
+            writeU32(enums[i].valueCount);
+            for (uint32_t j = 0; j < enums[i].valueCount; j++) {
+                fwrite(&enums[i].values[j].value, sizeof(int64_t), 1, file);
+                writeString(enums[i].values[j].name);
+            }
+        }
+        return true;
+    }
+
+    // The writer thread runs while the app has an instance.  Called after vkCreateInstance succeeds.
+    void beginInstance() {
+        std::lock_guard<std::mutex> lock(instanceLock);
+        if (instanceCount++ == 0) {
+            writerThread = std::thread(&ApiDumpBinaryWriter::writerMain, this);
+        }
+    }
+
+    // Called from vkDestroyInstance.  Destroying the last instance stops the writer thread, writes everything
+    // recorded so far and frees the rings no thread owns, so nothing is left for exit-time destructors to do.
+    void endInstance() {
+        std::lock_guard<std::mutex> lock(instanceLock);
+        if (instanceCount == 0 || --instanceCount > 0) {
+            return;
+        }
+        stopWriter();
+        flush();
+        std::lock_guard<std::mutex> ringsGuard(ringsLock);
+        for (auto ring : freeRings) {
+            rings.erase(std::find(rings.begin(), rings.end(), ring));
+            delete ring;
+        }
+        freeRings.clear();
+    }
+
+    // Called by app threads.  Only blocks when this thread's ring is full.
+    void record(uint32_t funcIndex, uint64_t result, uint64_t frame, const uint64_t *args, uint32_t argCount) {
+        ApiDumpBinaryThreadSlot &slot = threadSlot();
+        if (!slot.ring) {
+            return;
+        }
+        ApiDumpBinaryRing *ring = slot.ring;
+        ApiDumpBinaryRecord header;
+        header.size = (uint32_t)(sizeof(header) + argCount * sizeof(uint64_t));
+        header.funcIndex = funcIndex;
+        header.sequence = nextSequence.fetch_add(1, std::memory_order_relaxed);
+        header.frame = frame;
+        header.result = result;
+        header.thread = slot.thread;
+        header.argCount = argCount;
+
+        uint64_t head = ring->head.load(std::memory_order_relaxed);
+        while (head + header.size - ring->tail.load(std::memory_order_acquire) > API_DUMP_BINARY_RING_SIZE) {
+            // There is no writer thread between instances, so drain here if nobody else is
+            if (drainLock.try_lock()) {
+                drain();
+                drainLock.unlock();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        head = copyIn(ring, head, &header, sizeof(header));
+        head = copyIn(ring, head, args, argCount * sizeof(uint64_t));
+        ring->head.store(head, std::memory_order_release);
+    }
+
+    // Writes everything recorded so far.  Safe to call from any thread.
+    void flush() {
+        std::lock_guard<std::mutex> lock(drainLock);
+        drain();
+        fflush(file);
+    }
+
+  private:
+    friend struct ApiDumpBinaryThreadSlot;
+
+    void writeU32(uint32_t value) { fwrite(&value, sizeof(value), 1, file); }
+
+    void writeString(const char *str) {
+        uint32_t length = (uint32_t)strlen(str);
+        writeU32(length);
+        fwrite(str, 1, length, file);
+    }
+
+    // The slot of the calling thread, with a ring from the free list or a new one on its first record.  The
+    // generation catches a slot left over from a writer that has since been destroyed.
+    ApiDumpBinaryThreadSlot &threadSlot() {
+        static thread_local ApiDumpBinaryThreadSlot slot;
+        if (slot.writer == this && slot.generation == generation.load(std::memory_order_acquire)) {
+            return slot;
+        }
+        std::lock_guard<std::mutex> lock(ringsLock);
+        if (!file) {
+            slot.ring = NULL;
+            return slot;
+        }
+        if (!freeRings.empty()) {
+            slot.ring = freeRings.back();
+            freeRings.pop_back();
+        } else {
+            slot.ring = new ApiDumpBinaryRing;
+            slot.ring->head.store(0);
+            slot.ring->tail.store(0);
+            rings.push_back(slot.ring);
+        }
+        slot.writer = this;
+        slot.generation = generation.load(std::memory_order_relaxed);
+        slot.thread = nextThread++;
+        return slot;
+    }
+
+    // Thread-exit hook.  A ring can go back on the free list with records still in it, since its next owner
+    // appends after them; one that is freed instead is written out first.
+    void releaseRing(ApiDumpBinaryThreadSlot &slot) {
+        std::lock_guard<std::mutex> drainGuard(drainLock);
+        std::lock_guard<std::mutex> lock(ringsLock);
+        if (slot.generation != generation.load(std::memory_order_relaxed)) {
+            return;
+        }
+        if (freeRings.size() < API_DUMP_BINARY_FREE_RINGS) {
+            freeRings.push_back(slot.ring);
+        } else {
+            drainRing(slot.ring);
+            rings.erase(std::find(rings.begin(), rings.end(), slot.ring));
+            delete slot.ring;
+        }
+        slot.ring = NULL;
+    }
+
+    static uint64_t copyIn(ApiDumpBinaryRing *ring, uint64_t head, const void *src, size_t size) {
+        size_t offset = (size_t)(head % API_DUMP_BINARY_RING_SIZE);
+        size_t first = API_DUMP_BINARY_RING_SIZE - offset;
+        if (first > size) {
+            first = size;
+        }
+        memcpy(ring->data + offset, src, first);
+        memcpy(ring->data, (const uint8_t *)src + first, size - first);
+        return head + size;
+    }
+
+    // Must be called with drainLock held
+    void drainRing(ApiDumpBinaryRing *ring) {
+        uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        if (head == tail) {
+            return;
+        }
+        size_t size = (size_t)(head - tail);
+        size_t offset = (size_t)(tail % API_DUMP_BINARY_RING_SIZE);
+        size_t first = API_DUMP_BINARY_RING_SIZE - offset;
+        if (first > size) {
+            first = size;
+        }
+        fwrite(ring->data + offset, 1, first, file);
+        fwrite(ring->data, 1, size - first, file);
+        ring->tail.store(head, std::memory_order_release);
+    }
+
+    // Must be called with drainLock held
+    void drain() {
+        std::vector<ApiDumpBinaryRing *> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(ringsLock);
+            snapshot = rings;
+        }
+        for (auto ring : snapshot) {
+            drainRing(ring);
+        }
+    }
+
+    void writerMain() {
+        std::unique_lock<std::mutex> lock(wakeLock);
+        while (!stop) {
+            wake.wait_for(lock, std::chrono::milliseconds(1));
+            std::lock_guard<std::mutex> drainGuard(drainLock);
+            drain();
+        }
+    }
+
+    void stopWriter() {
+        if (!writerThread.joinable()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(wakeLock);
+            stop = true;
+        }
+        wake.notify_one();
+        writerThread.join();
+        stop = false;
+    }
+
+    FILE *file;
+    std::mutex instanceLock;
+    uint32_t instanceCount;
+    std::thread writerThread;
+    std::mutex wakeLock;
+    std::condition_variable wake;
+    bool stop;
+    std::mutex drainLock;
+    std::mutex ringsLock;
+    std::vector<ApiDumpBinaryRing *> rings;     // every ring, owned or free
+    std::vector<ApiDumpBinaryRing *> freeRings; // rings of exited threads
+    std::atomic<uint64_t> generation;
+    uint32_t nextThread;
+    std::atomic<uint64_t> nextSequence;
+};
+
+inline ApiDumpBinaryThreadSlot::~ApiDumpBinaryThreadSlot() {
+    if (writer && ring) {
+        writer->releaseRing(*this);
+    }
+}
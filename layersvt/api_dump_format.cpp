@@ -0,0 +1,267 @@
+/*
+ *
+ * Copyright (C) 2016 Valve Corporation
+ * Copyright (C) 2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// Renders a binary dump written by the api_dump layer (lunarg_api_dump.binary = TRUE) as text or JSON.
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "api_dump_binary.h"
+
+struct FormatParam {
+    std::string name;
+    std::string type;
+    uint32_t kind;
+    int32_t enumIndex;
+};
+
+struct FormatFunc {
+    std::string name;
+    uint32_t returnKind;
+    int32_t returnEnumIndex;
+    std::vector<FormatParam> params;
+};
+
+struct FormatEnum {
+    std::string name;
+    std::vector<std::pair<int64_t, std::string>> values;
+};
+
+struct FormatCall {
+    ApiDumpBinaryRecord header;
+    std::vector<uint64_t> args;
+};
+
+struct LaterSequence {
+    bool operator()(const FormatCall &a, const FormatCall &b) const { return a.header.sequence > b.header.sequence; }
+};
+
+static std::vector<FormatFunc> funcs;
+static std::vector<FormatEnum> enums;
+
+static bool readU32(FILE *file, uint32_t *value) { return fread(value, sizeof(*value), 1, file) == 1; }
+
+static bool readString(FILE *file, std::string *str) {
+    uint32_t length;
+    if (!readU32(file, &length)) {
+        return false;
+    }
+    str->resize(length);
+    return length == 0 || fread(&(*str)[0], 1, length, file) == length;
+}
+
+static bool readTables(FILE *file) {
+    ApiDumpBinaryFileHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != API_DUMP_BINARY_MAGIC) {
+        fprintf(stderr, "api_dump_format: not an api_dump binary file\n");
+        return false;
+    }
+    if (header.version != API_DUMP_BINARY_VERSION) {
+        fprintf(stderr, "api_dump_format: unsupported file version %u\n", header.version);
+        return false;
+    }
+
+    funcs.resize(header.funcCount);
+    for (auto &func : funcs) {
+        uint32_t returnEnumIndex, paramCount;
+        if (!readString(file, &func.name) || !readU32(file, &func.returnKind) || !readU32(file, &returnEnumIndex) ||
+            !readU32(file, &paramCount)) {
+            return false;
+        }
+        func.returnEnumIndex = (int32_t)returnEnumIndex;
+        func.params.resize(paramCount);
+        for (auto &param : func.params) {
+            uint32_t enumIndex;
+            if (!readString(file, &param.name) || !readString(file, &param.type) || !readU32(file, &param.kind) ||
+                !readU32(file, &enumIndex)) {
+                return false;
+            }
+            param.enumIndex = (int32_t)enumIndex;
+        }
+    }
+
+    enums.resize(header.enumCount);
+    for (auto &enumDesc : enums) {
+        uint32_t valueCount;
+        if (!readString(file, &enumDesc.name) || !readU32(file, &valueCount)) {
+            return false;
+        }
+        enumDesc.values.resize(valueCount);
+        for (auto &value : enumDesc.values) {
+            if (fread(&value.first, sizeof(int64_t), 1, file) != 1 || !readString(file, &value.second)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Returns false at the end of the file, including when the last record was cut short
+static bool readCall(FILE *file, FormatCall *call) {
+    if (fread(&call->header, sizeof(call->header), 1, file) != 1) {
+        return false;
+    }
+    call->args.resize(call->header.argCount);
+    return call->header.argCount == 0 || fread(&call->args[0], sizeof(uint64_t), call->header.argCount, file) == call->header.argCount;
+}
+
+// Renders value as text.  quoted is set when the value is not a JSON number.
+static std::string formatValue(uint64_t value, uint32_t kind, int32_t enumIndex, bool *quoted) {
+    char buf[64];
+    *quoted = false;
+    switch (kind) {
+    case API_DUMP_ARG_SIGNED:
+        snprintf(buf, sizeof(buf), "%" PRId64, (int64_t)value);
+        break;
+    case API_DUMP_ARG_FLOAT: {
+        uint32_t bits = (uint32_t)value;
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        snprintf(buf, sizeof(buf), "%g", f);
+        break;
+    }
+    case API_DUMP_ARG_HEX:
+        snprintf(buf, sizeof(buf), "0x%" PRIx64, value);
+        *quoted = true;
+        break;
+    case API_DUMP_ARG_ENUM:
+        if (enumIndex >= 0 && (size_t)enumIndex < enums.size()) {
+            for (auto &enumValue : enums[enumIndex].values) {
+                if (enumValue.first == (int64_t)value) {
+                    *quoted = true;
+                    return enumValue.second;
+                }
+            }
+        }
+        snprintf(buf, sizeof(buf), "%" PRId64, (int64_t)value);
+        break;
+    default:
+        snprintf(buf, sizeof(buf), "%" PRIu64, value);
+        break;
+    }
+    return buf;
+}
+
+// Matches the layer's own text output: "t{thread} f{frame} vkName(param = value, ...) = result"
+static void printText(const FormatCall &call) {
+    const FormatFunc &func = funcs[call.header.funcIndex];
+    bool quoted;
+    printf("t{%u} f{%" PRIu64 "} %s(", call.header.thread, call.header.frame, func.name.c_str());
+    for (size_t i = 0; i < call.args.size() && i < func.params.size(); i++) {
+        const FormatParam &param = func.params[i];
+        printf("%s%s = %s", i ? ", " : "", param.name.c_str(),
+               formatValue(call.args[i], param.kind, param.enumIndex, &quoted).c_str());
+    }
+    if (func.returnKind == API_DUMP_ARG_NONE) {
+        printf(")\n");
+    } else {
+        printf(") = %s\n", formatValue(call.header.result, func.returnKind, func.returnEnumIndex, &quoted).c_str());
+    }
+}
+
+static void printJsonValue(const std::string &value, bool quoted) { printf(quoted ? "\"%s\"" : "%s", value.c_str()); }
+
+static void printJson(const FormatCall &call, bool first) {
+    const FormatFunc &func = funcs[call.header.funcIndex];
+    bool quoted;
+    printf("%s\n  {\"sequence\": %" PRIu64 ", \"thread\": %u, \"frame\": %" PRIu64 ", \"function\": \"%s\", \"args\": [",
+           first ? "" : ",", call.header.sequence, call.header.thread, call.header.frame, func.name.c_str());
+    for (size_t i = 0; i < call.args.size() && i < func.params.size(); i++) {
+        const FormatParam &param = func.params[i];
+        printf("%s{\"name\": \"%s\", \"type\": \"%s\", \"value\": ", i ? ", " : "", param.name.c_str(), param.type.c_str());
+        std::string value = formatValue(call.args[i], param.kind, param.enumIndex, &quoted);
+        printJsonValue(value, quoted);
+        printf("}");
+    }
+    printf("]");
+    if (func.returnKind != API_DUMP_ARG_NONE) {
+        printf(", \"result\": ");
+        std::string value = formatValue(call.header.result, func.returnKind, func.returnEnumIndex, &quoted);
+        printJsonValue(value, quoted);
+    }
+    printf("}");
+}
+
+int main(int argc, char **argv) {
+    bool json = false;
+    const char *fileName = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else {
+            fileName = argv[i];
+        }
+    }
+    if (!fileName) {
+        fprintf(stderr, "Usage: %s [--json] <api_dump binary file>\n", argv[0]);
+        return 1;
+    }
+
+    FILE *file = fopen(fileName, "rb");
+    if (!file) {
+        fprintf(stderr, "api_dump_format: cannot open %s\n", fileName);
+        return 1;
+    }
+    if (!readTables(file)) {
+        fclose(file);
+        return 1;
+    }
+
+    // Each thread's records are in order in the file, but threads are interleaved a ring at a time.
+    // Hold records back until every earlier sequence number has been printed.
+    std::priority_queue<FormatCall, std::vector<FormatCall>, LaterSequence> pending;
+    uint64_t nextSequence = 0;
+    bool first = true;
+    bool more = true;
+    if (json) {
+        printf("[");
+    }
+    while (more || !pending.empty()) {
+        FormatCall call;
+        if (more && (more = readCall(file, &call))) {
+            if (call.header.funcIndex >= funcs.size()) {
+                fprintf(stderr, "api_dump_format: bad record at sequence %" PRIu64 "\n", call.header.sequence);
+                more = false;
+            } else {
+                pending.push(call);
+            }
+        }
+        // At the end of the file, print what is left even if calls are missing
+        while (!pending.empty() && (!more || pending.top().header.sequence == nextSequence)) {
+            if (json) {
+                printJson(pending.top(), first);
+            } else {
+                printText(pending.top());
+            }
+            first = false;
+            nextSequence = pending.top().header.sequence + 1;
+            pending.pop();
+        }
+    }
+    if (json) {
+        printf("\n]\n");
+    }
+
+    fclose(file);
+    return 0;
+}
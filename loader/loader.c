@@ -1220,29 +1220,50 @@ void loader_get_icd_loader_instance_extensions(
     debug_report_add_instance_extensions(inst, inst_exts);
 }
 
+/* Bucket of loader.instance_index or loader.device_index for a dispatch
+ * table. The tables are heap allocations, so the low bits carry no
+ * information.
+ */
+static uint32_t loader_index_bucket(const void *disp) {
+    uintptr_t key = (uintptr_t)disp;
+    return (uint32_t)((key >> 4) ^ (key >> 12)) &
+           (LOADER_INDEX_BUCKET_COUNT - 1);
+}
+
 struct loader_icd *loader_get_icd_and_device(const VkDevice device,
                                              struct loader_device **found_dev) {
+    const void *disp = loader_get_dispatch(device);
     *found_dev = NULL;
-    for (struct loader_instance *inst = loader.instances; inst;
-         inst = inst->next) {
-        for (struct loader_icd *icd = inst->icds; icd; icd = icd->next) {
-            for (struct loader_device *dev = icd->logical_device_list; dev;
-                 dev = dev->next)
-                /* Value comparison of device prevents object wrapping by layers
-                 */
-                if (loader_get_dispatch(dev->device) ==
-                    loader_get_dispatch(device)) {
-                    *found_dev = dev;
-                    return icd;
-                }
+    for (struct loader_device *dev =
+             loader.device_index[loader_index_bucket(disp)];
+         dev; dev = dev->index_next) {
+        /* Value comparison of device prevents object wrapping by layers
+         */
+        if ((const void *)&dev->loader_dispatch == disp) {
+            *found_dev = dev;
+            return dev->icd;
         }
     }
     return NULL;
 }
 
+static void loader_remove_device_index(struct loader_device *dev) {
+    struct loader_device **link =
+        &loader.device_index[loader_index_bucket(&dev->loader_dispatch)];
+    while (*link && *link != dev) {
+        link = &(*link)->index_next;
+    }
+    if (*link) {
+        *link = dev->index_next;
+    }
+    dev->index_next = NULL;
+    dev->icd = NULL;
+}
+
 void loader_destroy_logical_device(const struct loader_instance *inst,
                                    struct loader_device *dev,
                                    const VkAllocationCallbacks *pAllocator) {
+    loader_remove_device_index(dev);
     if (pAllocator) {
         dev->alloc_callbacks = *pAllocator;
     }
@@ -1290,6 +1311,12 @@ void loader_add_logical_device(const struct loader_instance *inst,
                                struct loader_device *dev) {
     dev->next = icd->logical_device_list;
     icd->logical_device_list = dev;
+
+    // keyed by the table loader_init_dispatch is about to give the device
+    uint32_t bucket = loader_index_bucket(&dev->loader_dispatch);
+    dev->icd = icd;
+    dev->index_next = loader.device_index[bucket];
+    loader.device_index[bucket] = dev;
 }
 
 void loader_remove_logical_device(const struct loader_instance *inst,
@@ -1815,6 +1842,238 @@ static cJSON *loader_get_json(const struct loader_instance *inst,
     return json;
 }
 
+/*
+ * Process wide cache of manifest files, so that creating instances and
+ * enumerating layers over and over doesn't walk the search directories and
+ * parse every manifest each time.  Directories are keyed on their path and
+ * remember the manifest files found in them; JSON trees are keyed on the
+ * manifest file path.  Each entry records the modification time and size of
+ * the directory or file it was read from and is read again when they change.
+ *
+ * The cache outlives any instance, so it is allocated with malloc rather than
+ * the allocator of the instance that happened to fill it.  It is protected by
+ * loader_json_lock.
+ */
+struct loader_dir_cache_entry {
+    char *dirname;
+    uint64_t mtime;
+    uint64_t size;
+    uint32_t count;
+    char **filename_list;
+};
+
+struct loader_json_cache_entry {
+    char *filename;
+    uint64_t mtime;
+    uint64_t size;
+    cJSON *json;
+};
+
+static struct {
+    uint32_t dir_count;
+    uint32_t dir_capacity;
+    struct loader_dir_cache_entry *dirs;
+    uint32_t json_count;
+    uint32_t json_capacity;
+    struct loader_json_cache_entry *jsons;
+} loader_manifest_cache;
+
+static void *loader_manifest_cache_grow(void *list, uint32_t *capacity,
+                                        size_t entry_size) {
+    uint32_t new_capacity = (*capacity == 0) ? 16 : *capacity * 2;
+    void *new_list = realloc(list, new_capacity * entry_size);
+    if (new_list != NULL) {
+        *capacity = new_capacity;
+    }
+    return new_list;
+}
+
+static void loader_free_dir_cache_files(struct loader_dir_cache_entry *entry) {
+    for (uint32_t i = 0; i < entry->count; i++) {
+        free(entry->filename_list[i]);
+    }
+    free(entry->filename_list);
+    entry->count = 0;
+    entry->filename_list = NULL;
+}
+
+/**
+ * Get the cached list of ".json" files in a directory, reading the directory
+ * again if it changed since it was cached.
+ * Caller must hold loader_json_lock.
+ *
+ * \returns
+ * The cache entry of the directory, or NULL if the directory can't be read.
+ */
+static struct loader_dir_cache_entry *
+loader_get_cached_dir(const struct loader_instance *inst, const char *dirname) {
+    struct loader_dir_cache_entry *entry = NULL;
+    uint64_t mtime, size;
+    char full_path[2048];
+    uint32_t alloced_count = 0;
+    DIR *sysdir;
+    struct dirent *dent;
+
+    if (!loader_platform_file_stamp(dirname, &mtime, &size)) {
+        return NULL;
+    }
+    for (uint32_t i = 0; i < loader_manifest_cache.dir_count; i++) {
+        if (!strcmp(loader_manifest_cache.dirs[i].dirname, dirname)) {
+            entry = &loader_manifest_cache.dirs[i];
+            break;
+        }
+    }
+    if (entry != NULL && entry->mtime == mtime && entry->size == size) {
+        return entry;
+    }
+
+    sysdir = opendir(dirname);
+    if (sysdir == NULL) {
+        return NULL;
+    }
+    if (entry == NULL) {
+        if (loader_manifest_cache.dir_count ==
+            loader_manifest_cache.dir_capacity) {
+            struct loader_dir_cache_entry *dirs = loader_manifest_cache_grow(
+                loader_manifest_cache.dirs, &loader_manifest_cache.dir_capacity,
+                sizeof(struct loader_dir_cache_entry));
+            if (dirs == NULL) {
+                goto out_of_memory;
+            }
+            loader_manifest_cache.dirs = dirs;
+        }
+        entry = &loader_manifest_cache.dirs[loader_manifest_cache.dir_count];
+        memset(entry, 0, sizeof(*entry));
+        entry->dirname = malloc(strlen(dirname) + 1);
+        if (entry->dirname == NULL) {
+            goto out_of_memory;
+        }
+        strcpy(entry->dirname, dirname);
+        loader_manifest_cache.dir_count++;
+    } else {
+        loader_free_dir_cache_files(entry);
+    }
+    // The stamp was taken before reading, so changes made while reading are
+    // picked up by the next lookup.
+    entry->mtime = mtime;
+    entry->size = size;
+
+    while ((dent = readdir(sysdir)) != NULL) {
+        uint32_t nlen = (uint32_t)strlen(dent->d_name);
+        if (nlen <= 5 || strncmp(dent->d_name + nlen - 5, ".json", 5)) {
+            continue;
+        }
+        if (entry->count == alloced_count) {
+            uint32_t new_count = (alloced_count == 0) ? 16 : alloced_count * 2;
+            char **list =
+                realloc(entry->filename_list, new_count * sizeof(char *));
+            if (list == NULL) {
+                goto out_of_memory;
+            }
+            entry->filename_list = list;
+            alloced_count = new_count;
+        }
+        loader_get_fullpath(dent->d_name, dirname, sizeof(full_path),
+                            full_path);
+        entry->filename_list[entry->count] = malloc(strlen(full_path) + 1);
+        if (entry->filename_list[entry->count] == NULL) {
+            goto out_of_memory;
+        }
+        strcpy(entry->filename_list[entry->count], full_path);
+        entry->count++;
+    }
+    closedir(sysdir);
+    return entry;
+
+out_of_memory:
+    loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
+               "Out of memory can't cache manifest files in %s", dirname);
+    if (entry != NULL) {
+        // read the directory again next time
+        loader_free_dir_cache_files(entry);
+        entry->mtime = 0;
+        entry->size = 0;
+    }
+    closedir(sysdir);
+    return NULL;
+}
+
+/**
+ * Get the parse tree of a JSON manifest file, parsing the file again if it
+ * changed since it was cached.
+ * Caller must hold loader_json_lock.
+ *
+ * \returns
+ * A pointer to a cJSON object representing the JSON parse tree.
+ * The tree is owned by the cache and must not be modified or freed by caller.
+ */
+static cJSON *loader_get_cached_json(const struct loader_instance *inst,
+                                     const char *filename) {
+    struct loader_json_cache_entry *entry = NULL;
+    struct loader_instance *saved_tls_instance;
+    uint64_t mtime, size;
+    cJSON *json;
+
+    if (!loader_platform_file_stamp(filename, &mtime, &size)) {
+        loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
+                   "Couldn't open JSON file %s", filename);
+        return NULL;
+    }
+    for (uint32_t i = 0; i < loader_manifest_cache.json_count; i++) {
+        if (!strcmp(loader_manifest_cache.jsons[i].filename, filename)) {
+            entry = &loader_manifest_cache.jsons[i];
+            break;
+        }
+    }
+    if (entry != NULL && entry->mtime == mtime && entry->size == size) {
+        return entry->json;
+    }
+
+    // cJSON allocates through tls_instance; cached trees must not use the
+    // allocator of the current instance since they outlive it
+    saved_tls_instance = tls_instance;
+    tls_instance = NULL;
+    json = loader_get_json(inst, filename);
+    if (json == NULL) {
+        tls_instance = saved_tls_instance;
+        return NULL;
+    }
+    if (entry == NULL) {
+        if (loader_manifest_cache.json_count ==
+            loader_manifest_cache.json_capacity) {
+            struct loader_json_cache_entry *jsons = loader_manifest_cache_grow(
+                loader_manifest_cache.jsons,
+                &loader_manifest_cache.json_capacity,
+                sizeof(struct loader_json_cache_entry));
+            if (jsons == NULL) {
+                goto out_of_memory;
+            }
+            loader_manifest_cache.jsons = jsons;
+        }
+        entry = &loader_manifest_cache.jsons[loader_manifest_cache.json_count];
+        entry->filename = malloc(strlen(filename) + 1);
+        if (entry->filename == NULL) {
+            goto out_of_memory;
+        }
+        strcpy(entry->filename, filename);
+        loader_manifest_cache.json_count++;
+    } else {
+        cJSON_Delete(entry->json);
+    }
+    tls_instance = saved_tls_instance;
+    entry->mtime = mtime;
+    entry->size = size;
+    entry->json = json;
+    return json;
+
+out_of_memory:
+    cJSON_Delete(json);
+    tls_instance = saved_tls_instance;
+    loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
+               "Out of memory can't cache JSON file %s", filename);
+    return NULL;
+}
+
 /**
  * Do a deep copy of the loader_layer_properties structure.
  */
@@ -2483,6 +2742,42 @@ loader_add_layer_properties(const struct loader_instance *inst,
     return;
 }
 
+/**
+ * Append a copy of a manifest file name to a list of manifest files.
+ * alloced_count is the number of names the list has room for.
+ */
+static VkResult
+loader_add_manifest_file(const struct loader_instance *inst,
+                         struct loader_manifest_files *out_files,
+                         size_t *alloced_count, const char *name) {
+    if (out_files->count == 0) {
+        out_files->filename_list = loader_instance_heap_alloc(
+            inst, *alloced_count * sizeof(char *),
+            VK_SYSTEM_ALLOCATION_SCOPE_COMMAND);
+    } else if (out_files->count == *alloced_count) {
+        out_files->filename_list = loader_instance_heap_realloc(
+            inst, out_files->filename_list, *alloced_count * sizeof(char *),
+            *alloced_count * sizeof(char *) * 2,
+            VK_SYSTEM_ALLOCATION_SCOPE_COMMAND);
+        *alloced_count *= 2;
+    }
+    if (out_files->filename_list == NULL) {
+        loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
+                   "Out of memory can't alloc manifest file list");
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    out_files->filename_list[out_files->count] = loader_instance_heap_alloc(
+        inst, strlen(name) + 1, VK_SYSTEM_ALLOCATION_SCOPE_COMMAND);
+    if (out_files->filename_list[out_files->count] == NULL) {
+        loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
+                   "Out of memory can't get manifest files");
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    }
+    strcpy(out_files->filename_list[out_files->count], name);
+    out_files->count++;
+    return VK_SUCCESS;
+}
+
 /**
  * Find the Vulkan library manifest files.
  *
@@ -2519,9 +2814,8 @@ static VkResult loader_get_manifest_files(
     char *file, *next_file, *name;
     size_t alloced_count = 64;
     char full_path[2048];
-    DIR *sysdir = NULL;
+    struct loader_dir_cache_entry *dir_entry;
     bool list_is_dirs = false;
-    struct dirent *dent;
     VkResult res = VK_SUCCESS;
 
     out_files->count = 0;
@@ -2616,15 +2910,19 @@ static VkResult loader_get_manifest_files(
     while (*file) {
         next_file = loader_get_next_path(file);
         if (list_is_dirs) {
-            sysdir = opendir(file);
-            name = NULL;
-            if (sysdir) {
-                dent = readdir(sysdir);
-                if (dent == NULL)
+            loader_platform_thread_lock_mutex(&loader_json_lock);
+            dir_entry = loader_get_cached_dir(inst, file);
+            for (uint32_t i = 0; dir_entry != NULL && i < dir_entry->count;
+                 i++) {
+                res = loader_add_manifest_file(inst, out_files, &alloced_count,
+                                               dir_entry->filename_list[i]);
+                if (VK_SUCCESS != res) {
                     break;
-                name = &(dent->d_name[0]);
-                loader_get_fullpath(name, file, sizeof(full_path), full_path);
-                name = full_path;
+                }
+            }
+            loader_platform_thread_unlock_mutex(&loader_json_lock);
+            if (VK_SUCCESS != res) {
+                goto out;
             }
         } else {
 #if defined(_WIN32)
@@ -2645,63 +2943,21 @@ static VkResult loader_get_manifest_files(
 
             name = full_path;
 #endif
-        }
-        while (name) {
             /* Look for files ending with ".json" suffix */
             uint32_t nlen = (uint32_t)strlen(name);
             const char *suf = name + nlen - 5;
             if ((nlen > 5) && !strncmp(suf, ".json", 5)) {
-                if (out_files->count == 0) {
-                    out_files->filename_list = loader_instance_heap_alloc(
-                        inst, alloced_count * sizeof(char *),
-                        VK_SYSTEM_ALLOCATION_SCOPE_COMMAND);
-                } else if (out_files->count == alloced_count) {
-                    out_files->filename_list = loader_instance_heap_realloc(
-                        inst, out_files->filename_list,
-                        alloced_count * sizeof(char *),
-                        alloced_count * sizeof(char *) * 2,
-                        VK_SYSTEM_ALLOCATION_SCOPE_COMMAND);
-                    alloced_count *= 2;
-                }
-                if (out_files->filename_list == NULL) {
-                    loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
-                               "Out of memory can't alloc manifest file list");
-                    res = VK_ERROR_OUT_OF_HOST_MEMORY;
-                    goto out;
-                }
-                out_files->filename_list[out_files->count] =
-                    loader_instance_heap_alloc(
-                        inst, strlen(name) + 1,
-                        VK_SYSTEM_ALLOCATION_SCOPE_COMMAND);
-                if (out_files->filename_list[out_files->count] == NULL) {
-                    loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
-                               "Out of memory can't get manifest files");
-                    res = VK_ERROR_OUT_OF_HOST_MEMORY;
+                res = loader_add_manifest_file(inst, out_files, &alloced_count,
+                                               name);
+                if (VK_SUCCESS != res) {
                     goto out;
                 }
-                strcpy(out_files->filename_list[out_files->count], name);
-                out_files->count++;
-            } else if (!list_is_dirs) {
+            } else {
                 loader_log(
                     inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,
                     "Skipping manifest file %s, file name must end in .json",
                     name);
             }
-            if (list_is_dirs) {
-                dent = readdir(sysdir);
-                if (dent == NULL) {
-                    break;
-                }
-                name = &(dent->d_name[0]);
-                loader_get_fullpath(name, file, sizeof(full_path), full_path);
-                name = full_path;
-            } else {
-                break;
-            }
-        }
-        if (sysdir) {
-            closedir(sysdir);
-            sysdir = NULL;
         }
         file = next_file;
 #if !defined(_WIN32)
@@ -2750,10 +3006,6 @@ out:
         out_files->filename_list = NULL;
     }
 
-    if (NULL != sysdir) {
-        closedir(sysdir);
-    }
-
     if (NULL != reg && reg != orig_loc) {
         loader_instance_heap_free(inst, reg);
     }
@@ -2785,7 +3037,7 @@ VkResult loader_icd_scan(const struct loader_instance *inst,
     struct loader_manifest_files manifest_files;
     VkResult res = VK_SUCCESS;
     bool lockedMutex = false;
-    cJSON *json = NULL;
+    cJSON *json;
 
     memset(&manifest_files, 0, sizeof(struct loader_manifest_files));
 
@@ -2809,7 +3061,7 @@ VkResult loader_icd_scan(const struct loader_instance *inst,
             continue;
         }
 
-        json = loader_get_json(inst, file_str);
+        json = loader_get_cached_json(inst, file_str);
         if (!json) {
             continue;
         }
@@ -2858,8 +3110,6 @@ VkResult loader_icd_scan(const struct loader_instance *inst,
                                "%s, skipping",
                                file_str);
                     cJSON_Free(temp);
-                    cJSON_Delete(json);
-                    json = NULL;
                     continue;
                 }
                 // strip out extra quotes
@@ -2872,8 +3122,6 @@ VkResult loader_icd_scan(const struct loader_instance *inst,
                                "Can't find \"library_path\" in ICD JSON file "
                                "%s, skipping",
                                file_str);
-                    cJSON_Delete(json);
-                    json = NULL;
                     continue;
                 }
                 char fullpath[MAX_STRING_SIZE];
@@ -2922,15 +3170,9 @@ VkResult loader_icd_scan(const struct loader_instance *inst,
                 "Can't find \"ICD\" object in ICD JSON file %s, skipping",
                 file_str);
         }
-
-        cJSON_Delete(json);
-        json = NULL;
     }
 
 out:
-    if (NULL != json) {
-        cJSON_Delete(json);
-    }
     if (NULL != manifest_files.filename_list) {
         for (uint32_t i = 0; i < manifest_files.count; i++) {
             if (NULL != manifest_files.filename_list[i]) {
@@ -2991,14 +3233,13 @@ void loader_layer_scan(const struct loader_instance *inst,
                 continue;
 
             // parse file into JSON struct
-            json = loader_get_json(inst, file_str);
+            json = loader_get_cached_json(inst, file_str);
             if (!json) {
                 continue;
             }
 
             loader_add_layer_properties(inst, instance_layers, json,
                                         (implicit == 1), file_str);
-            cJSON_Delete(json);
         }
     }
 
@@ -3054,7 +3295,7 @@ void loader_implicit_layer_scan(const struct loader_instance *inst,
         }
 
         // parse file into JSON struct
-        json = loader_get_json(inst, file_str);
+        json = loader_get_cached_json(inst, file_str);
         if (!json) {
             continue;
         }
@@ -3063,7 +3304,6 @@ void loader_implicit_layer_scan(const struct loader_instance *inst,
                                     file_str);
 
         loader_instance_heap_free(inst, file_str);
-        cJSON_Delete(json);
     }
     loader_instance_heap_free(inst, manifest_files.filename_list);
 
@@ -3372,8 +3612,9 @@ struct loader_instance *loader_get_instance(const VkInstance instance) {
     const VkLayerInstanceDispatchTable *disp;
     struct loader_instance *ptr_instance = NULL;
     disp = loader_get_instance_dispatch(instance);
-    for (struct loader_instance *inst = loader.instances; inst;
-         inst = inst->next) {
+    for (struct loader_instance *inst =
+             loader.instance_index[loader_index_bucket(disp)];
+         inst; inst = inst->index_next) {
         if (inst->disp == disp) {
             ptr_instance = inst;
             break;
@@ -3382,6 +3623,27 @@ struct loader_instance *loader_get_instance(const VkInstance instance) {
     return ptr_instance;
 }
 
+/* Makes inst visible to loader_get_instance. inst->disp must be set and
+ * must not change while inst is in the index.
+ */
+void loader_add_instance_index(struct loader_instance *inst) {
+    uint32_t bucket = loader_index_bucket(inst->disp);
+    inst->index_next = loader.instance_index[bucket];
+    loader.instance_index[bucket] = inst;
+}
+
+void loader_remove_instance_index(struct loader_instance *inst) {
+    struct loader_instance **link =
+        &loader.instance_index[loader_index_bucket(inst->disp)];
+    while (*link && *link != inst) {
+        link = &(*link)->index_next;
+    }
+    if (*link) {
+        *link = inst->index_next;
+    }
+    inst->index_next = NULL;
+}
+
 static loader_platform_dl_handle
 loader_open_layer_lib(const struct loader_instance *inst, const char *chain_type,
                      struct loader_layer_properties *prop) {
@@ -4073,6 +4335,7 @@ VKAPI_ATTR void VKAPI_CALL terminator_DestroyInstance(
         prev = next;
         next = next->next;
     }
+    loader_remove_instance_index(ptr_instance);
 
     while (icds) {
         if (icds->instance) {
@@ -176,6 +176,10 @@ struct loader_device {
     VkAllocationCallbacks alloc_callbacks;
 
     struct loader_device *next;
+
+    // set while the device is in loader.device_index
+    struct loader_icd *icd;
+    struct loader_device *index_next;
 };
 
 /* per ICD structure */
@@ -261,6 +265,7 @@ struct loader_instance {
     uint32_t total_icd_count;
     struct loader_icd *icds;
     struct loader_instance *next;
+    struct loader_instance *index_next; // next in the loader.instance_index bucket
     struct loader_extension_list ext_list; // icds and loaders extensions
     struct loader_icd_libs icd_libs;
     struct loader_layer_list instance_layer_list;
@@ -329,8 +334,17 @@ struct loader_physical_device {
     VkPhysicalDevice phys_dev; // object from ICD
 };
 
+// Buckets of the instance and device indexes, a power of two
+#define LOADER_INDEX_BUCKET_COUNT 256
+
 struct loader_struct {
     struct loader_instance *instances;
+
+    // Instances keyed by their dispatch table and logical devices keyed by
+    // their loader dispatch table, so that loader_get_instance and
+    // loader_get_icd_and_device don't have to walk every instance and ICD.
+    struct loader_instance *instance_index[LOADER_INDEX_BUCKET_COUNT];
+    struct loader_device *device_index[LOADER_INDEX_BUCKET_COUNT];
 };
 
 struct loader_scanned_icds {
@@ -344,6 +358,23 @@ struct loader_scanned_icds {
         EnumerateInstanceExtensionProperties;
 };
 
+// Entries of the name lookup tables in gpa_helper.h and table_ops.h. The
+// tables are sorted by name in strcmp order and searched with bsearch.
+struct loader_named_proc {
+    const char *name;
+    void *proc;
+};
+
+struct loader_named_offset {
+    const char *name;
+    size_t offset; // of the function pointer in a dispatch table
+};
+
+static inline int loader_compare_entry_name(const void *key,
+                                            const void *entry) {
+    return strcmp((const char *)key, *(const char *const *)entry);
+}
+
 static inline struct loader_instance *loader_instance(VkInstance instance) {
     return (struct loader_instance *)instance;
 }
@@ -499,6 +530,8 @@ void loader_init_dispatch_dev_ext(struct loader_instance *inst,
 void *loader_dev_ext_gpa(struct loader_instance *inst, const char *funcName);
 void *loader_get_dev_ext_trampoline(uint32_t index);
 struct loader_instance *loader_get_instance(const VkInstance instance);
+void loader_add_instance_index(struct loader_instance *inst);
+void loader_remove_instance_index(struct loader_instance *inst);
 void loader_deactivate_layers(const struct loader_instance *instance,
                               struct loader_device *device,
                               struct loader_layer_list *list);
@@ -25,6 +25,8 @@
 
 #include <vulkan/vulkan.h>
 #include <vulkan/vk_layer.h>
+#include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
 #include "loader.h"
 #include "vk_loader_platform.h"
@@ -272,252 +274,153 @@ static inline void loader_init_device_extension_dispatch_table(
 static inline void *
 loader_lookup_device_dispatch_table(const VkLayerDispatchTable *table,
                                     const char *name) {
+    // Both tables are sorted by name for bsearch. The entries of
+    // loader_commands return the loader's own entrypoint rather than the
+    // dispatch table member.
+    static const struct loader_named_offset device_commands[] = {
+        {"AllocateCommandBuffers", offsetof(VkLayerDispatchTable, AllocateCommandBuffers)},
+        {"AllocateDescriptorSets", offsetof(VkLayerDispatchTable, AllocateDescriptorSets)},
+        {"AllocateMemory", offsetof(VkLayerDispatchTable, AllocateMemory)},
+        {"BeginCommandBuffer", offsetof(VkLayerDispatchTable, BeginCommandBuffer)},
+        {"BindBufferMemory", offsetof(VkLayerDispatchTable, BindBufferMemory)},
+        {"BindImageMemory", offsetof(VkLayerDispatchTable, BindImageMemory)},
+        {"CmdBeginQuery", offsetof(VkLayerDispatchTable, CmdBeginQuery)},
+        {"CmdBeginRenderPass", offsetof(VkLayerDispatchTable, CmdBeginRenderPass)},
+        {"CmdBindDescriptorSets", offsetof(VkLayerDispatchTable, CmdBindDescriptorSets)},
+        {"CmdBindIndexBuffer", offsetof(VkLayerDispatchTable, CmdBindIndexBuffer)},
+        {"CmdBindPipeline", offsetof(VkLayerDispatchTable, CmdBindPipeline)},
+        {"CmdBindVertexBuffers", offsetof(VkLayerDispatchTable, CmdBindVertexBuffers)},
+        {"CmdBlitImage", offsetof(VkLayerDispatchTable, CmdBlitImage)},
+        {"CmdClearAttachments", offsetof(VkLayerDispatchTable, CmdClearAttachments)},
+        {"CmdClearColorImage", offsetof(VkLayerDispatchTable, CmdClearColorImage)},
+        {"CmdClearDepthStencilImage", offsetof(VkLayerDispatchTable, CmdClearDepthStencilImage)},
+        {"CmdCopyBuffer", offsetof(VkLayerDispatchTable, CmdCopyBuffer)},
+        {"CmdCopyBufferToImage", offsetof(VkLayerDispatchTable, CmdCopyBufferToImage)},
+        {"CmdCopyImage", offsetof(VkLayerDispatchTable, CmdCopyImage)},
+        {"CmdCopyImageToBuffer", offsetof(VkLayerDispatchTable, CmdCopyImageToBuffer)},
+        {"CmdCopyQueryPoolResults", offsetof(VkLayerDispatchTable, CmdCopyQueryPoolResults)},
+        {"CmdDispatch", offsetof(VkLayerDispatchTable, CmdDispatch)},
+        {"CmdDispatchIndirect", offsetof(VkLayerDispatchTable, CmdDispatchIndirect)},
+        {"CmdDraw", offsetof(VkLayerDispatchTable, CmdDraw)},
+        {"CmdDrawIndexed", offsetof(VkLayerDispatchTable, CmdDrawIndexed)},
+        {"CmdDrawIndexedIndirect", offsetof(VkLayerDispatchTable, CmdDrawIndexedIndirect)},
+        {"CmdDrawIndirect", offsetof(VkLayerDispatchTable, CmdDrawIndirect)},
+        {"CmdEndQuery", offsetof(VkLayerDispatchTable, CmdEndQuery)},
+        {"CmdEndRenderPass", offsetof(VkLayerDispatchTable, CmdEndRenderPass)},
+        {"CmdExecuteCommands", offsetof(VkLayerDispatchTable, CmdExecuteCommands)},
+        {"CmdFillBuffer", offsetof(VkLayerDispatchTable, CmdFillBuffer)},
+        {"CmdNextSubpass", offsetof(VkLayerDispatchTable, CmdNextSubpass)},
+        {"CmdPipelineBarrier", offsetof(VkLayerDispatchTable, CmdPipelineBarrier)},
+        {"CmdPushConstants", offsetof(VkLayerDispatchTable, CmdPushConstants)},
+        {"CmdResetEvent", offsetof(VkLayerDispatchTable, CmdResetEvent)},
+        {"CmdResetQueryPool", offsetof(VkLayerDispatchTable, CmdResetQueryPool)},
+        {"CmdResolveImage", offsetof(VkLayerDispatchTable, CmdResolveImage)},
+        {"CmdSetBlendConstants", offsetof(VkLayerDispatchTable, CmdSetBlendConstants)},
+        {"CmdSetDepthBias", offsetof(VkLayerDispatchTable, CmdSetDepthBias)},
+        {"CmdSetDepthBounds", offsetof(VkLayerDispatchTable, CmdSetDepthBounds)},
+        {"CmdSetEvent", offsetof(VkLayerDispatchTable, CmdSetEvent)},
+        {"CmdSetLineWidth", offsetof(VkLayerDispatchTable, CmdSetLineWidth)},
+        {"CmdSetScissor", offsetof(VkLayerDispatchTable, CmdSetScissor)},
+        {"CmdSetStencilCompareMask", offsetof(VkLayerDispatchTable, CmdSetStencilCompareMask)},
+        {"CmdSetStencilReference", offsetof(VkLayerDispatchTable, CmdSetStencilReference)},
+        {"CmdSetStencilWriteMask", offsetof(VkLayerDispatchTable, CmdSetStencilWriteMask)},
+        {"CmdSetViewport", offsetof(VkLayerDispatchTable, CmdSetViewport)},
+        {"CmdUpdateBuffer", offsetof(VkLayerDispatchTable, CmdUpdateBuffer)},
+        {"CmdWaitEvents", offsetof(VkLayerDispatchTable, CmdWaitEvents)},
+        {"CmdWriteTimestamp", offsetof(VkLayerDispatchTable, CmdWriteTimestamp)},
+        {"CreateBuffer", offsetof(VkLayerDispatchTable, CreateBuffer)},
+        {"CreateBufferView", offsetof(VkLayerDispatchTable, CreateBufferView)},
+        {"CreateCommandPool", offsetof(VkLayerDispatchTable, CreateCommandPool)},
+        {"CreateDescriptorPool", offsetof(VkLayerDispatchTable, CreateDescriptorPool)},
+        {"CreateDescriptorSetLayout", offsetof(VkLayerDispatchTable, CreateDescriptorSetLayout)},
+        {"CreateEvent", offsetof(VkLayerDispatchTable, CreateEvent)},
+        {"CreateFence", offsetof(VkLayerDispatchTable, CreateFence)},
+        {"CreateFramebuffer", offsetof(VkLayerDispatchTable, CreateFramebuffer)},
+        {"CreateImage", offsetof(VkLayerDispatchTable, CreateImage)},
+        {"CreateImageView", offsetof(VkLayerDispatchTable, CreateImageView)},
+        {"CreatePipelineLayout", offsetof(VkLayerDispatchTable, CreatePipelineLayout)},
+        {"CreateQueryPool", offsetof(VkLayerDispatchTable, CreateQueryPool)},
+        {"CreateRenderPass", offsetof(VkLayerDispatchTable, CreateRenderPass)},
+        {"CreateSampler", offsetof(VkLayerDispatchTable, CreateSampler)},
+        {"CreateSemaphore", offsetof(VkLayerDispatchTable, CreateSemaphore)},
+        {"CreateShaderModule", offsetof(VkLayerDispatchTable, CreateShaderModule)},
+        {"DestroyBuffer", offsetof(VkLayerDispatchTable, DestroyBuffer)},
+        {"DestroyBufferView", offsetof(VkLayerDispatchTable, DestroyBufferView)},
+        {"DestroyCommandPool", offsetof(VkLayerDispatchTable, DestroyCommandPool)},
+        {"DestroyDescriptorPool", offsetof(VkLayerDispatchTable, DestroyDescriptorPool)},
+        {"DestroyDescriptorSetLayout", offsetof(VkLayerDispatchTable, DestroyDescriptorSetLayout)},
+        {"DestroyDevice", offsetof(VkLayerDispatchTable, DestroyDevice)},
+        {"DestroyEvent", offsetof(VkLayerDispatchTable, DestroyEvent)},
+        {"DestroyFence", offsetof(VkLayerDispatchTable, DestroyFence)},
+        {"DestroyFramebuffer", offsetof(VkLayerDispatchTable, DestroyFramebuffer)},
+        {"DestroyImage", offsetof(VkLayerDispatchTable, DestroyImage)},
+        {"DestroyImageView", offsetof(VkLayerDispatchTable, DestroyImageView)},
+        {"DestroyPipeline", offsetof(VkLayerDispatchTable, DestroyPipeline)},
+        {"DestroyPipelineLayout", offsetof(VkLayerDispatchTable, DestroyPipelineLayout)},
+        {"DestroyQueryPool", offsetof(VkLayerDispatchTable, DestroyQueryPool)},
+        {"DestroyRenderPass", offsetof(VkLayerDispatchTable, DestroyRenderPass)},
+        {"DestroySampler", offsetof(VkLayerDispatchTable, DestroySampler)},
+        {"DestroySemaphore", offsetof(VkLayerDispatchTable, DestroySemaphore)},
+        {"DestroyShaderModule", offsetof(VkLayerDispatchTable, DestroyShaderModule)},
+        {"DeviceWaitIdle", offsetof(VkLayerDispatchTable, DeviceWaitIdle)},
+        {"EndCommandBuffer", offsetof(VkLayerDispatchTable, EndCommandBuffer)},
+        {"FlushMappedMemoryRanges", offsetof(VkLayerDispatchTable, FlushMappedMemoryRanges)},
+        {"FreeCommandBuffers", offsetof(VkLayerDispatchTable, FreeCommandBuffers)},
+        {"FreeDescriptorSets", offsetof(VkLayerDispatchTable, FreeDescriptorSets)},
+        {"FreeMemory", offsetof(VkLayerDispatchTable, FreeMemory)},
+        {"GetBufferMemoryRequirements", offsetof(VkLayerDispatchTable, GetBufferMemoryRequirements)},
+        {"GetDeviceMemoryCommitment", offsetof(VkLayerDispatchTable, GetDeviceMemoryCommitment)},
+        {"GetDeviceProcAddr", offsetof(VkLayerDispatchTable, GetDeviceProcAddr)},
+        {"GetDeviceQueue", offsetof(VkLayerDispatchTable, GetDeviceQueue)},
+        {"GetEventStatus", offsetof(VkLayerDispatchTable, GetEventStatus)},
+        {"GetFenceStatus", offsetof(VkLayerDispatchTable, GetFenceStatus)},
+        {"GetImageMemoryRequirements", offsetof(VkLayerDispatchTable, GetImageMemoryRequirements)},
+        {"GetImageSparseMemoryRequirements", offsetof(VkLayerDispatchTable, GetImageSparseMemoryRequirements)},
+        {"GetImageSubresourceLayout", offsetof(VkLayerDispatchTable, GetImageSubresourceLayout)},
+        {"GetQueryPoolResults", offsetof(VkLayerDispatchTable, GetQueryPoolResults)},
+        {"GetRenderAreaGranularity", offsetof(VkLayerDispatchTable, GetRenderAreaGranularity)},
+        {"InvalidateMappedMemoryRanges", offsetof(VkLayerDispatchTable, InvalidateMappedMemoryRanges)},
+        {"MapMemory", offsetof(VkLayerDispatchTable, MapMemory)},
+        {"QueueBindSparse", offsetof(VkLayerDispatchTable, QueueBindSparse)},
+        {"QueueSubmit", offsetof(VkLayerDispatchTable, QueueSubmit)},
+        {"QueueWaitIdle", offsetof(VkLayerDispatchTable, QueueWaitIdle)},
+        {"ResetCommandBuffer", offsetof(VkLayerDispatchTable, ResetCommandBuffer)},
+        {"ResetCommandPool", offsetof(VkLayerDispatchTable, ResetCommandPool)},
+        {"ResetDescriptorPool", offsetof(VkLayerDispatchTable, ResetDescriptorPool)},
+        {"ResetEvent", offsetof(VkLayerDispatchTable, ResetEvent)},
+        {"ResetFences", offsetof(VkLayerDispatchTable, ResetFences)},
+        {"SetEvent", offsetof(VkLayerDispatchTable, SetEvent)},
+        {"UnmapMemory", offsetof(VkLayerDispatchTable, UnmapMemory)},
+        {"UpdateDescriptorSets", offsetof(VkLayerDispatchTable, UpdateDescriptorSets)},
+        {"WaitForFences", offsetof(VkLayerDispatchTable, WaitForFences)},
+    };
+    static const struct loader_named_proc loader_commands[] = {
+        {"CreateComputePipelines", (void *)vkCreateComputePipelines},
+        {"CreateGraphicsPipelines", (void *)vkCreateGraphicsPipelines},
+        {"CreatePipelineCache", (void *)vkCreatePipelineCache},
+        {"DestroyPipelineCache", (void *)vkDestroyPipelineCache},
+        {"GetPipelineCacheData", (void *)vkGetPipelineCacheData},
+        {"MergePipelineCaches", (void *)vkMergePipelineCaches},
+    };
+    const struct loader_named_offset *command;
+    const struct loader_named_proc *loader_command;
+
     if (!name || name[0] != 'v' || name[1] != 'k')
         return NULL;
 
     name += 2;
-    if (!strcmp(name, "GetDeviceProcAddr"))
-        return (void *)table->GetDeviceProcAddr;
-    if (!strcmp(name, "DestroyDevice"))
-        return (void *)table->DestroyDevice;
-    if (!strcmp(name, "GetDeviceQueue"))
-        return (void *)table->GetDeviceQueue;
-    if (!strcmp(name, "QueueSubmit"))
-        return (void *)table->QueueSubmit;
-    if (!strcmp(name, "QueueWaitIdle"))
-        return (void *)table->QueueWaitIdle;
-    if (!strcmp(name, "DeviceWaitIdle"))
-        return (void *)table->DeviceWaitIdle;
-    if (!strcmp(name, "AllocateMemory"))
-        return (void *)table->AllocateMemory;
-    if (!strcmp(name, "FreeMemory"))
-        return (void *)table->FreeMemory;
-    if (!strcmp(name, "MapMemory"))
-        return (void *)table->MapMemory;
-    if (!strcmp(name, "UnmapMemory"))
-        return (void *)table->UnmapMemory;
-    if (!strcmp(name, "FlushMappedMemoryRanges"))
-        return (void *)table->FlushMappedMemoryRanges;
-    if (!strcmp(name, "InvalidateMappedMemoryRanges"))
-        return (void *)table->InvalidateMappedMemoryRanges;
-    if (!strcmp(name, "GetDeviceMemoryCommitment"))
-        return (void *)table->GetDeviceMemoryCommitment;
-    if (!strcmp(name, "GetImageSparseMemoryRequirements"))
-        return (void *)table->GetImageSparseMemoryRequirements;
-    if (!strcmp(name, "GetBufferMemoryRequirements"))
-        return (void *)table->GetBufferMemoryRequirements;
-    if (!strcmp(name, "GetImageMemoryRequirements"))
-        return (void *)table->GetImageMemoryRequirements;
-    if (!strcmp(name, "BindBufferMemory"))
-        return (void *)table->BindBufferMemory;
-    if (!strcmp(name, "BindImageMemory"))
-        return (void *)table->BindImageMemory;
-    if (!strcmp(name, "QueueBindSparse"))
-        return (void *)table->QueueBindSparse;
-    if (!strcmp(name, "CreateFence"))
-        return (void *)table->CreateFence;
-    if (!strcmp(name, "DestroyFence"))
-        return (void *)table->DestroyFence;
-    if (!strcmp(name, "ResetFences"))
-        return (void *)table->ResetFences;
-    if (!strcmp(name, "GetFenceStatus"))
-        return (void *)table->GetFenceStatus;
-    if (!strcmp(name, "WaitForFences"))
-        return (void *)table->WaitForFences;
-    if (!strcmp(name, "CreateSemaphore"))
-        return (void *)table->CreateSemaphore;
-    if (!strcmp(name, "DestroySemaphore"))
-        return (void *)table->DestroySemaphore;
-    if (!strcmp(name, "CreateEvent"))
-        return (void *)table->CreateEvent;
-    if (!strcmp(name, "DestroyEvent"))
-        return (void *)table->DestroyEvent;
-    if (!strcmp(name, "GetEventStatus"))
-        return (void *)table->GetEventStatus;
-    if (!strcmp(name, "SetEvent"))
-        return (void *)table->SetEvent;
-    if (!strcmp(name, "ResetEvent"))
-        return (void *)table->ResetEvent;
-    if (!strcmp(name, "CreateQueryPool"))
-        return (void *)table->CreateQueryPool;
-    if (!strcmp(name, "DestroyQueryPool"))
-        return (void *)table->DestroyQueryPool;
-    if (!strcmp(name, "GetQueryPoolResults"))
-        return (void *)table->GetQueryPoolResults;
-    if (!strcmp(name, "CreateBuffer"))
-        return (void *)table->CreateBuffer;
-    if (!strcmp(name, "DestroyBuffer"))
-        return (void *)table->DestroyBuffer;
-    if (!strcmp(name, "CreateBufferView"))
-        return (void *)table->CreateBufferView;
-    if (!strcmp(name, "DestroyBufferView"))
-        return (void *)table->DestroyBufferView;
-    if (!strcmp(name, "CreateImage"))
-        return (void *)table->CreateImage;
-    if (!strcmp(name, "DestroyImage"))
-        return (void *)table->DestroyImage;
-    if (!strcmp(name, "GetImageSubresourceLayout"))
-        return (void *)table->GetImageSubresourceLayout;
-    if (!strcmp(name, "CreateImageView"))
-        return (void *)table->CreateImageView;
-    if (!strcmp(name, "DestroyImageView"))
-        return (void *)table->DestroyImageView;
-    if (!strcmp(name, "CreateShaderModule"))
-        return (void *)table->CreateShaderModule;
-    if (!strcmp(name, "DestroyShaderModule"))
-        return (void *)table->DestroyShaderModule;
-    if (!strcmp(name, "CreatePipelineCache"))
-        return (void *)vkCreatePipelineCache;
-    if (!strcmp(name, "DestroyPipelineCache"))
-        return (void *)vkDestroyPipelineCache;
-    if (!strcmp(name, "GetPipelineCacheData"))
-        return (void *)vkGetPipelineCacheData;
-    if (!strcmp(name, "MergePipelineCaches"))
-        return (void *)vkMergePipelineCaches;
-    if (!strcmp(name, "CreateGraphicsPipelines"))
-        return (void *)vkCreateGraphicsPipelines;
-    if (!strcmp(name, "CreateComputePipelines"))
-        return (void *)vkCreateComputePipelines;
-    if (!strcmp(name, "DestroyPipeline"))
-        return (void *)table->DestroyPipeline;
-    if (!strcmp(name, "CreatePipelineLayout"))
-        return (void *)table->CreatePipelineLayout;
-    if (!strcmp(name, "DestroyPipelineLayout"))
-        return (void *)table->DestroyPipelineLayout;
-    if (!strcmp(name, "CreateSampler"))
-        return (void *)table->CreateSampler;
-    if (!strcmp(name, "DestroySampler"))
-        return (void *)table->DestroySampler;
-    if (!strcmp(name, "CreateDescriptorSetLayout"))
-        return (void *)table->CreateDescriptorSetLayout;
-    if (!strcmp(name, "DestroyDescriptorSetLayout"))
-        return (void *)table->DestroyDescriptorSetLayout;
-    if (!strcmp(name, "CreateDescriptorPool"))
-        return (void *)table->CreateDescriptorPool;
-    if (!strcmp(name, "DestroyDescriptorPool"))
-        return (void *)table->DestroyDescriptorPool;
-    if (!strcmp(name, "ResetDescriptorPool"))
-        return (void *)table->ResetDescriptorPool;
-    if (!strcmp(name, "AllocateDescriptorSets"))
-        return (void *)table->AllocateDescriptorSets;
-    if (!strcmp(name, "FreeDescriptorSets"))
-        return (void *)table->FreeDescriptorSets;
-    if (!strcmp(name, "UpdateDescriptorSets"))
-        return (void *)table->UpdateDescriptorSets;
-    if (!strcmp(name, "CreateFramebuffer"))
-        return (void *)table->CreateFramebuffer;
-    if (!strcmp(name, "DestroyFramebuffer"))
-        return (void *)table->DestroyFramebuffer;
-    if (!strcmp(name, "CreateRenderPass"))
-        return (void *)table->CreateRenderPass;
-    if (!strcmp(name, "DestroyRenderPass"))
-        return (void *)table->DestroyRenderPass;
-    if (!strcmp(name, "GetRenderAreaGranularity"))
-        return (void *)table->GetRenderAreaGranularity;
-    if (!strcmp(name, "CreateCommandPool"))
-        return (void *)table->CreateCommandPool;
-    if (!strcmp(name, "DestroyCommandPool"))
-        return (void *)table->DestroyCommandPool;
-    if (!strcmp(name, "ResetCommandPool"))
-        return (void *)table->ResetCommandPool;
-    if (!strcmp(name, "AllocateCommandBuffers"))
-        return (void *)table->AllocateCommandBuffers;
-    if (!strcmp(name, "FreeCommandBuffers"))
-        return (void *)table->FreeCommandBuffers;
-    if (!strcmp(name, "BeginCommandBuffer"))
-        return (void *)table->BeginCommandBuffer;
-    if (!strcmp(name, "EndCommandBuffer"))
-        return (void *)table->EndCommandBuffer;
-    if (!strcmp(name, "ResetCommandBuffer"))
-        return (void *)table->ResetCommandBuffer;
-    if (!strcmp(name, "CmdBindPipeline"))
-        return (void *)table->CmdBindPipeline;
-    if (!strcmp(name, "CmdSetViewport"))
-        return (void *)table->CmdSetViewport;
-    if (!strcmp(name, "CmdSetScissor"))
-        return (void *)table->CmdSetScissor;
-    if (!strcmp(name, "CmdSetLineWidth"))
-        return (void *)table->CmdSetLineWidth;
-    if (!strcmp(name, "CmdSetDepthBias"))
-        return (void *)table->CmdSetDepthBias;
-    if (!strcmp(name, "CmdSetBlendConstants"))
-        return (void *)table->CmdSetBlendConstants;
-    if (!strcmp(name, "CmdSetDepthBounds"))
-        return (void *)table->CmdSetDepthBounds;
-    if (!strcmp(name, "CmdSetStencilCompareMask"))
-        return (void *)table->CmdSetStencilCompareMask;
-    if (!strcmp(name, "CmdSetStencilwriteMask"))
-        return (void *)table->CmdSetStencilWriteMask;
-    if (!strcmp(name, "CmdSetStencilReference"))
-        return (void *)table->CmdSetStencilReference;
-    if (!strcmp(name, "CmdBindDescriptorSets"))
-        return (void *)table->CmdBindDescriptorSets;
-    if (!strcmp(name, "CmdBindVertexBuffers"))
-        return (void *)table->CmdBindVertexBuffers;
-    if (!strcmp(name, "CmdBindIndexBuffer"))
-        return (void *)table->CmdBindIndexBuffer;
-    if (!strcmp(name, "CmdDraw"))
-        return (void *)table->CmdDraw;
-    if (!strcmp(name, "CmdDrawIndexed"))
-        return (void *)table->CmdDrawIndexed;
-    if (!strcmp(name, "CmdDrawIndirect"))
-        return (void *)table->CmdDrawIndirect;
-    if (!strcmp(name, "CmdDrawIndexedIndirect"))
-        return (void *)table->CmdDrawIndexedIndirect;
-    if (!strcmp(name, "CmdDispatch"))
-        return (void *)table->CmdDispatch;
-    if (!strcmp(name, "CmdDispatchIndirect"))
-        return (void *)table->CmdDispatchIndirect;
-    if (!strcmp(name, "CmdCopyBuffer"))
-        return (void *)table->CmdCopyBuffer;
-    if (!strcmp(name, "CmdCopyImage"))
-        return (void *)table->CmdCopyImage;
-    if (!strcmp(name, "CmdBlitImage"))
-        return (void *)table->CmdBlitImage;
-    if (!strcmp(name, "CmdCopyBufferToImage"))
-        return (void *)table->CmdCopyBufferToImage;
-    if (!strcmp(name, "CmdCopyImageToBuffer"))
-        return (void *)table->CmdCopyImageToBuffer;
-    if (!strcmp(name, "CmdUpdateBuffer"))
-        return (void *)table->CmdUpdateBuffer;
-    if (!strcmp(name, "CmdFillBuffer"))
-        return (void *)table->CmdFillBuffer;
-    if (!strcmp(name, "CmdClearColorImage"))
-        return (void *)table->CmdClearColorImage;
-    if (!strcmp(name, "CmdClearDepthStencilImage"))
-        return (void *)table->CmdClearDepthStencilImage;
-    if (!strcmp(name, "CmdClearAttachments"))
-        return (void *)table->CmdClearAttachments;
-    if (!strcmp(name, "CmdResolveImage"))
-        return (void *)table->CmdResolveImage;
-    if (!strcmp(name, "CmdSetEvent"))
-        return (void *)table->CmdSetEvent;
-    if (!strcmp(name, "CmdResetEvent"))
-        return (void *)table->CmdResetEvent;
-    if (!strcmp(name, "CmdWaitEvents"))
-        return (void *)table->CmdWaitEvents;
-    if (!strcmp(name, "CmdPipelineBarrier"))
-        return (void *)table->CmdPipelineBarrier;
-    if (!strcmp(name, "CmdBeginQuery"))
-        return (void *)table->CmdBeginQuery;
-    if (!strcmp(name, "CmdEndQuery"))
-        return (void *)table->CmdEndQuery;
-    if (!strcmp(name, "CmdResetQueryPool"))
-        return (void *)table->CmdResetQueryPool;
-    if (!strcmp(name, "CmdWriteTimestamp"))
-        return (void *)table->CmdWriteTimestamp;
-    if (!strcmp(name, "CmdCopyQueryPoolResults"))
-        return (void *)table->CmdCopyQueryPoolResults;
-    if (!strcmp(name, "CmdPushConstants"))
-        return (void *)table->CmdPushConstants;
-    if (!strcmp(name, "CmdBeginRenderPass"))
-        return (void *)table->CmdBeginRenderPass;
-    if (!strcmp(name, "CmdNextSubpass"))
-        return (void *)table->CmdNextSubpass;
-    if (!strcmp(name, "CmdEndRenderPass"))
-        return (void *)table->CmdEndRenderPass;
-    if (!strcmp(name, "CmdExecuteCommands"))
-        return (void *)table->CmdExecuteCommands;
+    command = bsearch(name, device_commands,
+                      sizeof(device_commands) / sizeof(device_commands[0]),
+                      sizeof(device_commands[0]), loader_compare_entry_name);
+    if (command)
+        return *(void **)((const char *)table + command->offset);
+
+    loader_command =
+        bsearch(name, loader_commands,
+                sizeof(loader_commands) / sizeof(loader_commands[0]),
+                sizeof(loader_commands[0]), loader_compare_entry_name);
+    if (loader_command)
+        return loader_command->proc;
 
     return NULL;
 }
@@ -643,98 +546,81 @@ static inline void loader_init_instance_extension_dispatch_table(
 static inline void *
 loader_lookup_instance_dispatch_table(const VkLayerInstanceDispatchTable *table,
                                       const char *name, bool *found_name) {
-    if (!name || name[0] != 'v' || name[1] != 'k') {
-        *found_name = false;
-        return NULL;
-    }
-
-    *found_name = true;
-    name += 2;
-    if (!strcmp(name, "DestroyInstance"))
-        return (void *)table->DestroyInstance;
-    if (!strcmp(name, "EnumeratePhysicalDevices"))
-        return (void *)table->EnumeratePhysicalDevices;
-    if (!strcmp(name, "GetPhysicalDeviceFeatures"))
-        return (void *)table->GetPhysicalDeviceFeatures;
-    if (!strcmp(name, "GetPhysicalDeviceImageFormatProperties"))
-        return (void *)table->GetPhysicalDeviceImageFormatProperties;
-    if (!strcmp(name, "GetPhysicalDeviceFormatProperties"))
-        return (void *)table->GetPhysicalDeviceFormatProperties;
-    if (!strcmp(name, "GetPhysicalDeviceSparseImageFormatProperties"))
-        return (void *)table->GetPhysicalDeviceSparseImageFormatProperties;
-    if (!strcmp(name, "GetPhysicalDeviceProperties"))
-        return (void *)table->GetPhysicalDeviceProperties;
-    if (!strcmp(name, "GetPhysicalDeviceQueueFamilyProperties"))
-        return (void *)table->GetPhysicalDeviceQueueFamilyProperties;
-    if (!strcmp(name, "GetPhysicalDeviceMemoryProperties"))
-        return (void *)table->GetPhysicalDeviceMemoryProperties;
-    if (!strcmp(name, "GetInstanceProcAddr"))
-        return (void *)table->GetInstanceProcAddr;
-    if (!strcmp(name, "EnumerateDeviceExtensionProperties"))
-        return (void *)table->EnumerateDeviceExtensionProperties;
-    if (!strcmp(name, "EnumerateDeviceLayerProperties"))
-        return (void *)table->EnumerateDeviceLayerProperties;
-    if (!strcmp(name, "DestroySurfaceKHR"))
-        return (void *)table->DestroySurfaceKHR;
-    if (!strcmp(name, "GetPhysicalDeviceSurfaceSupportKHR"))
-        return (void *)table->GetPhysicalDeviceSurfaceSupportKHR;
-    if (!strcmp(name, "GetPhysicalDeviceSurfaceCapabilitiesKHR"))
-        return (void *)table->GetPhysicalDeviceSurfaceCapabilitiesKHR;
-    if (!strcmp(name, "GetPhysicalDeviceSurfaceFormatsKHR"))
-        return (void *)table->GetPhysicalDeviceSurfaceFormatsKHR;
-    if (!strcmp(name, "GetPhysicalDeviceSurfacePresentModesKHR"))
-        return (void *)table->GetPhysicalDeviceSurfacePresentModesKHR;
+    // sorted by name for bsearch
+    static const struct loader_named_offset instance_commands[] = {
+        {"CreateDebugReportCallbackEXT", offsetof(VkLayerInstanceDispatchTable, CreateDebugReportCallbackEXT)},
+        {"CreateDisplayModeKHR", offsetof(VkLayerInstanceDispatchTable, CreateDisplayModeKHR)},
+        {"CreateDisplayPlaneSurfaceKHR", offsetof(VkLayerInstanceDispatchTable, CreateDisplayPlaneSurfaceKHR)},
 #ifdef VK_USE_PLATFORM_MIR_KHR
-    if (!strcmp(name, "CreateMirSurfaceKHR"))
-        return (void *)table->CreateMirSurfaceKHR;
-    if (!strcmp(name, "GetPhysicalDeviceMirPresentationSupportKHR"))
-        return (void *)table->GetPhysicalDeviceMirPresentationSupportKHR;
+        {"CreateMirSurfaceKHR", offsetof(VkLayerInstanceDispatchTable, CreateMirSurfaceKHR)},
 #endif
 #ifdef VK_USE_PLATFORM_WAYLAND_KHR
-    if (!strcmp(name, "CreateWaylandSurfaceKHR"))
-        return (void *)table->CreateWaylandSurfaceKHR;
-    if (!strcmp(name, "GetPhysicalDeviceWaylandPresentationSupportKHR"))
-        return (void *)table->GetPhysicalDeviceWaylandPresentationSupportKHR;
+        {"CreateWaylandSurfaceKHR", offsetof(VkLayerInstanceDispatchTable, CreateWaylandSurfaceKHR)},
 #endif
 #ifdef VK_USE_PLATFORM_WIN32_KHR
-    if (!strcmp(name, "CreateWin32SurfaceKHR"))
-        return (void *)table->CreateWin32SurfaceKHR;
-    if (!strcmp(name, "GetPhysicalDeviceWin32PresentationSupportKHR"))
-        return (void *)table->GetPhysicalDeviceWin32PresentationSupportKHR;
+        {"CreateWin32SurfaceKHR", offsetof(VkLayerInstanceDispatchTable, CreateWin32SurfaceKHR)},
 #endif
 #ifdef VK_USE_PLATFORM_XCB_KHR
-    if (!strcmp(name, "CreateXcbSurfaceKHR"))
-        return (void *)table->CreateXcbSurfaceKHR;
-    if (!strcmp(name, "GetPhysicalDeviceXcbPresentationSupportKHR"))
-        return (void *)table->GetPhysicalDeviceXcbPresentationSupportKHR;
+        {"CreateXcbSurfaceKHR", offsetof(VkLayerInstanceDispatchTable, CreateXcbSurfaceKHR)},
 #endif
 #ifdef VK_USE_PLATFORM_XLIB_KHR
-    if (!strcmp(name, "CreateXlibSurfaceKHR"))
-        return (void *)table->CreateXlibSurfaceKHR;
-    if (!strcmp(name, "GetPhysicalDeviceXlibPresentationSupportKHR"))
-        return (void *)table->GetPhysicalDeviceXlibPresentationSupportKHR;
+        {"CreateXlibSurfaceKHR", offsetof(VkLayerInstanceDispatchTable, CreateXlibSurfaceKHR)},
+#endif
+        {"DebugReportMessageEXT", offsetof(VkLayerInstanceDispatchTable, DebugReportMessageEXT)},
+        {"DestroyDebugReportCallbackEXT", offsetof(VkLayerInstanceDispatchTable, DestroyDebugReportCallbackEXT)},
+        {"DestroyInstance", offsetof(VkLayerInstanceDispatchTable, DestroyInstance)},
+        {"DestroySurfaceKHR", offsetof(VkLayerInstanceDispatchTable, DestroySurfaceKHR)},
+        {"EnumerateDeviceExtensionProperties", offsetof(VkLayerInstanceDispatchTable, EnumerateDeviceExtensionProperties)},
+        {"EnumerateDeviceLayerProperties", offsetof(VkLayerInstanceDispatchTable, EnumerateDeviceLayerProperties)},
+        {"EnumeratePhysicalDevices", offsetof(VkLayerInstanceDispatchTable, EnumeratePhysicalDevices)},
+        {"GetDisplayModePropertiesKHR", offsetof(VkLayerInstanceDispatchTable, GetDisplayModePropertiesKHR)},
+        {"GetDisplayPlaneCapabilitiesKHR", offsetof(VkLayerInstanceDispatchTable, GetDisplayPlaneCapabilitiesKHR)},
+        {"GetDisplayPlaneSupportedDisplaysKHR", offsetof(VkLayerInstanceDispatchTable, GetDisplayPlaneSupportedDisplaysKHR)},
+        {"GetInstanceProcAddr", offsetof(VkLayerInstanceDispatchTable, GetInstanceProcAddr)},
+        {"GetPhysicalDeviceDisplayPlanePropertiesKHR", offsetof(VkLayerInstanceDispatchTable, GetPhysicalDeviceDisplayPlanePropertiesKHR)},
+        {"GetPhysicalDeviceDisplayPropertiesKHR", offsetof(VkLayerInstanceDispatchTable, GetPhysicalDeviceDisplayPropertiesKHR)},
+        {"GetPhysicalDeviceFeatures", offsetof(VkLayerInstanceDispatchTable, GetPhysicalDeviceFeatures)},
+        {"GetPhysicalDeviceFormatProperties", offsetof(VkLayerInstanceDispatchTable, GetPhysicalDeviceFormatProperties)},
+        {"GetPhysicalDeviceImageFormatProperties", offsetof(VkLayerInstanceDispatchTable, GetPhysicalDeviceImageFormatProperties)},
+        {"GetPhysicalDeviceMemoryProperties", offsetof(VkLayerInstanceDispatchTable, GetPhysicalDeviceMemoryProperties)},
+#ifdef VK_USE_PLATFORM_MIR_KHR
+        {"GetPhysicalDeviceMirPresentationSupportKHR", offsetof(VkLayerInstanceDispatchTable, GetPhysicalDeviceMirPresentationSupportKHR)},
 #endif
-    if (!strcmp(name, "GetPhysicalDeviceDisplayPropertiesKHR"))
-        return (void *)table->GetPhysicalDeviceDisplayPropertiesKHR;
-    if (!strcmp(name, "GetPhysicalDeviceDisplayPlanePropertiesKHR"))
-        return (void *)table->GetPhysicalDeviceDisplayPlanePropertiesKHR;
-    if (!strcmp(name, "GetDisplayPlaneSupportedDisplaysKHR"))
-        return (void *)table->GetDisplayPlaneSupportedDisplaysKHR;
-    if (!strcmp(name, "GetDisplayModePropertiesKHR"))
-        return (void *)table->GetDisplayModePropertiesKHR;
-    if (!strcmp(name, "CreateDisplayModeKHR"))
-        return (void *)table->CreateDisplayModeKHR;
-    if (!strcmp(name, "GetDisplayPlaneCapabilitiesKHR"))
-        return (void *)table->GetDisplayPlaneCapabilitiesKHR;
-    if (!strcmp(name, "CreateDisplayPlaneSurfaceKHR"))
-        return (void *)table->CreateDisplayPlaneSurfaceKHR;
+        {"GetPhysicalDeviceProperties", offsetof(VkLayerInstanceDispatchTable, GetPhysicalDeviceProperties)},
+        {"GetPhysicalDeviceQueueFamilyProperties", offsetof(VkLayerInstanceDispatchTable, GetPhysicalDeviceQueueFamilyProperties)},
+        {"GetPhysicalDeviceSparseImageFormatProperties", offsetof(VkLayerInstanceDispatchTable, GetPhysicalDeviceSparseImageFormatProperties)},
+        {"GetPhysicalDeviceSurfaceCapabilitiesKHR", offsetof(VkLayerInstanceDispatchTable, GetPhysicalDeviceSurfaceCapabilitiesKHR)},
+        {"GetPhysicalDeviceSurfaceFormatsKHR", offsetof(VkLayerInstanceDispatchTable, GetPhysicalDeviceSurfaceFormatsKHR)},
+        {"GetPhysicalDeviceSurfacePresentModesKHR", offsetof(VkLayerInstanceDispatchTable, GetPhysicalDeviceSurfacePresentModesKHR)},
+        {"GetPhysicalDeviceSurfaceSupportKHR", offsetof(VkLayerInstanceDispatchTable, GetPhysicalDeviceSurfaceSupportKHR)},
+#ifdef VK_USE_PLATFORM_WAYLAND_KHR
+        {"GetPhysicalDeviceWaylandPresentationSupportKHR", offsetof(VkLayerInstanceDispatchTable, GetPhysicalDeviceWaylandPresentationSupportKHR)},
+#endif
+#ifdef VK_USE_PLATFORM_WIN32_KHR
+        {"GetPhysicalDeviceWin32PresentationSupportKHR", offsetof(VkLayerInstanceDispatchTable, GetPhysicalDeviceWin32PresentationSupportKHR)},
+#endif
+#ifdef VK_USE_PLATFORM_XCB_KHR
+        {"GetPhysicalDeviceXcbPresentationSupportKHR", offsetof(VkLayerInstanceDispatchTable, GetPhysicalDeviceXcbPresentationSupportKHR)},
+#endif
+#ifdef VK_USE_PLATFORM_XLIB_KHR
+        {"GetPhysicalDeviceXlibPresentationSupportKHR", offsetof(VkLayerInstanceDispatchTable, GetPhysicalDeviceXlibPresentationSupportKHR)},
+#endif
+    };
+    const struct loader_named_offset *command;
+
+    if (!name || name[0] != 'v' || name[1] != 'k') {
+        *found_name = false;
+        return NULL;
+    }
 
-    if (!strcmp(name, "CreateDebugReportCallbackEXT"))
-        return (void *)table->CreateDebugReportCallbackEXT;
-    if (!strcmp(name, "DestroyDebugReportCallbackEXT"))
-        return (void *)table->DestroyDebugReportCallbackEXT;
-    if (!strcmp(name, "DebugReportMessageEXT"))
-        return (void *)table->DebugReportMessageEXT;
+    name += 2;
+    command = bsearch(name, instance_commands,
+                      sizeof(instance_commands) / sizeof(instance_commands[0]),
+                      sizeof(instance_commands[0]), loader_compare_entry_name);
+    if (command) {
+        *found_name = true;
+        return *(void **)((const char *)table + command->offset);
+    }
 
     *found_name = false;
     return NULL;
@@ -383,6 +383,7 @@ LOADER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkCreateInstance(
     memcpy(ptr_instance->disp, &instance_disp, sizeof(instance_disp));
     ptr_instance->next = loader.instances;
     loader.instances = ptr_instance;
+    loader_add_instance_index(ptr_instance);
 
     /* activate any layers on instance chain */
     res = loader_enable_instance_layers(ptr_instance, &ici,
@@ -420,6 +421,7 @@ out:
                 loader.instances = ptr_instance->next;
             }
             if (NULL != ptr_instance->disp) {
+                loader_remove_instance_index(ptr_instance);
                 loader_instance_heap_free(ptr_instance, ptr_instance->disp);
             }
             if (ptr_instance->num_tmp_callbacks > 0) {
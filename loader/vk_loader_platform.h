@@ -45,6 +45,7 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <libgen.h>
+#include <sys/stat.h>
 
 // VK Library Filenames, Paths, etc.:
 #define PATH_SEPERATOR ':'
@@ -132,6 +133,24 @@ static inline bool loader_platform_is_path_absolute(const char *path) {
         return false;
 }
 
+// Gets the modification time (in nanoseconds) and size of a file or directory
+static inline bool loader_platform_file_stamp(const char *path,
+                                              uint64_t *mtime,
+                                              uint64_t *size) {
+    struct stat st;
+    if (stat(path, &st) != 0)
+        return false;
+#if defined(_GNU_SOURCE) ||                                                   \
+    (defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200809L)
+    *mtime = (uint64_t)st.st_mtim.tv_sec * 1000000000 +
+             (uint64_t)st.st_mtim.tv_nsec;
+#else
+    *mtime = (uint64_t)st.st_mtime * 1000000000;
+#endif
+    *size = (uint64_t)st.st_size;
+    return true;
+}
+
 static inline char *loader_platform_dirname(char *path) {
     return dirname(path);
 }
@@ -271,6 +290,18 @@ static bool loader_platform_is_path_absolute(const char *path) {
     return !PathIsRelative(path);
 }
 
+// Gets the modification time (in 100ns units) and size of a file or directory
+static bool loader_platform_file_stamp(const char *path, uint64_t *mtime,
+                                       uint64_t *size) {
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data))
+        return false;
+    *mtime = ((uint64_t)data.ftLastWriteTime.dwHighDateTime << 32) |
+             data.ftLastWriteTime.dwLowDateTime;
+    *size = ((uint64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+    return true;
+}
+
 // WIN32 runtime doesn't have dirname().
 static inline char *loader_platform_dirname(char *path) {
     char *current, *next;
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2015-2016 The Khronos Group Inc.
+ * Copyright (c) 2015-2016 Valve Corporation
+ * Copyright (c) 2015-2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Tests that bound how often the validation layers allocate. They replace the global operator new and delete,
+// which the layers loaded into this process also end up calling, so they live in their own executable rather
+// than in vk_layer_validation_tests.
+
+#include <vulkan/vulkan.h>
+#include "test_common.h"
+#include "vkrenderframework.h"
+
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+static std::atomic<uint64_t> operator_new_count(0);
+
+static void *counted_alloc(size_t size) {
+    operator_new_count++;
+    return malloc(size ? size : 1);
+}
+
+void *operator new(size_t size) {
+    void *p = counted_alloc(size);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size) {
+    void *p = counted_alloc(size);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return counted_alloc(size); }
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return counted_alloc(size); }
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { free(p); }
+
+static VKAPI_ATTR VkBool32 VKAPI_CALL countErrors(VkFlags msgFlags, VkDebugReportObjectTypeEXT objType, uint64_t srcObject,
+                                                  size_t location, int32_t msgCode, const char *pLayerPrefix,
+                                                  const char *pMsg, void *pUserData) {
+    if (msgFlags & VK_DEBUG_REPORT_ERROR_BIT_EXT) {
+        (*(std::atomic<uint32_t> *)pUserData)++;
+    }
+    return false;
+}
+
+class VkLayerAllocationTest : public VkRenderFramework {
+  protected:
+    std::atomic<uint32_t> m_errorCount;
+
+    virtual void SetUp() {
+        std::vector<const char *> instance_layer_names;
+        std::vector<const char *> device_layer_names;
+        std::vector<const char *> instance_extension_names;
+        std::vector<const char *> device_extension_names;
+
+        instance_extension_names.push_back(VK_EXT_DEBUG_REPORT_EXTENSION_NAME);
+        instance_layer_names.push_back("VK_LAYER_LUNARG_core_validation");
+        device_layer_names.push_back("VK_LAYER_LUNARG_core_validation");
+
+        this->app_info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+        this->app_info.pNext = NULL;
+        this->app_info.pApplicationName = "layer_allocation_tests";
+        this->app_info.applicationVersion = 1;
+        this->app_info.pEngineName = "unittest";
+        this->app_info.engineVersion = 1;
+        this->app_info.apiVersion = VK_API_VERSION_1_0;
+
+        m_errorCount = 0;
+        InitFramework(instance_layer_names, device_layer_names, instance_extension_names, device_extension_names,
+                      countErrors, &m_errorCount);
+    }
+
+    virtual void TearDown() { ShutdownFramework(); }
+};
+
+// core_validation records work for vkQueueSubmit with every transfer and event command. Re-recording a command
+// buffer reuses the storage of its previous recording, so the second pass must not allocate for each command.
+TEST_F(VkLayerAllocationTest, CommandBufferSubmitOpAllocations) {
+    const uint32_t command_count = 1000;
+    ASSERT_NO_FATAL_FAILURE(InitState());
+
+    VkMemoryPropertyFlags reqs = 0;
+    vk_testing::Buffer src_buffer, dst_buffer;
+    src_buffer.init_as_src_and_dst(*m_device, (VkDeviceSize)256, reqs);
+    dst_buffer.init_as_src_and_dst(*m_device, (VkDeviceSize)256, reqs);
+
+    VkEventCreateInfo event_create_info = {};
+    event_create_info.sType = VK_STRUCTURE_TYPE_EVENT_CREATE_INFO;
+    VkEvent event;
+    ASSERT_VK_SUCCESS(vkCreateEvent(m_device->device(), &event_create_info, NULL, &event));
+
+    VkCommandBufferBeginInfo begin_info = {};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    VkBufferCopy region = {0, 0, 256};
+    VkSubmitInfo submit_info = {};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &m_commandBuffer->handle();
+
+    uint64_t allocations[2];
+    for (uint32_t pass = 0; pass < 2; pass++) {
+        uint64_t start_count = operator_new_count;
+        vkBeginCommandBuffer(m_commandBuffer->handle(), &begin_info);
+        // Fill src once so that the copies read valid memory
+        vkCmdFillBuffer(m_commandBuffer->handle(), src_buffer.handle(), 0, 256, 0);
+        for (uint32_t i = 0; i < command_count; i++) {
+            vkCmdCopyBuffer(m_commandBuffer->handle(), src_buffer.handle(), dst_buffer.handle(), 1, &region);
+            vkCmdSetEvent(m_commandBuffer->handle(), event, VK_PIPELINE_STAGE_TRANSFER_BIT);
+            vkCmdResetEvent(m_commandBuffer->handle(), event, VK_PIPELINE_STAGE_TRANSFER_BIT);
+        }
+        vkEndCommandBuffer(m_commandBuffer->handle());
+        vkQueueSubmit(m_device->m_queue, 1, &submit_info, VK_NULL_HANDLE);
+        vkQueueWaitIdle(m_device->m_queue);
+        allocations[pass] = operator_new_count - start_count;
+    }
+
+    EXPECT_EQ(0u, (uint32_t)m_errorCount);
+    // The first recording grows the storage, so it sees at least a few allocations; the second must not
+    // make one per command.
+    EXPECT_GT(allocations[0], 0u);
+    EXPECT_LT(allocations[1], (uint64_t)command_count);
+
+    vkDestroyEvent(m_device->device(), event, NULL);
+}
+
+int main(int argc, char **argv) {
+    int result;
+
+    ::testing::InitGoogleTest(&argc, argv);
+    VkTestFramework::InitArgs(&argc, argv);
+
+    ::testing::AddGlobalTestEnvironment(new TestEnvironment);
+
+    result = RUN_ALL_TESTS();
+
+    VkTestFramework::Finish();
+    return result;
+}
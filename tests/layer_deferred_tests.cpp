@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2015-2016 The Khronos Group Inc.
+ * Copyright (c) 2015-2016 Valve Corporation
+ * Copyright (c) 2015-2016 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Tests of core_validation with lunarg_core_validation.deferred_validation = TRUE. The layers read
+// vk_layer_settings.txt from the working directory once per process, so these tests live in their own executable,
+// whose main() writes that file into a directory of its own and runs from there.
+
+#include <vulkan/vulkan.h>
+#include "test_common.h"
+#include "vkrenderframework.h"
+
+#include <limits.h>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+
+struct DeferredErrors {
+    std::mutex lock;
+    std::vector<std::string> messages;
+};
+
+static VKAPI_ATTR VkBool32 VKAPI_CALL recordErrors(VkFlags msgFlags, VkDebugReportObjectTypeEXT objType, uint64_t srcObject,
+                                                   size_t location, int32_t msgCode, const char *pLayerPrefix,
+                                                   const char *pMsg, void *pUserData) {
+    if (msgFlags & VK_DEBUG_REPORT_ERROR_BIT_EXT) {
+        DeferredErrors *errors = (DeferredErrors *)pUserData;
+        std::lock_guard<std::mutex> lock(errors->lock);
+        errors->messages.push_back(pMsg);
+    }
+    return false;
+}
+
+class VkLayerDeferredTest : public VkRenderFramework {
+  protected:
+    DeferredErrors m_errors;
+
+    virtual void SetUp() {
+        std::vector<const char *> instance_layer_names;
+        std::vector<const char *> device_layer_names;
+        std::vector<const char *> instance_extension_names;
+        std::vector<const char *> device_extension_names;
+
+        instance_extension_names.push_back(VK_EXT_DEBUG_REPORT_EXTENSION_NAME);
+        instance_layer_names.push_back("VK_LAYER_LUNARG_core_validation");
+        device_layer_names.push_back("VK_LAYER_LUNARG_core_validation");
+
+        this->app_info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+        this->app_info.pNext = NULL;
+        this->app_info.pApplicationName = "layer_deferred_tests";
+        this->app_info.applicationVersion = 1;
+        this->app_info.pEngineName = "unittest";
+        this->app_info.engineVersion = 1;
+        this->app_info.apiVersion = VK_API_VERSION_1_0;
+
+        InitFramework(instance_layer_names, device_layer_names, instance_extension_names, device_extension_names,
+                      recordErrors, &m_errors);
+    }
+
+    virtual void TearDown() { ShutdownFramework(); }
+
+    // Number of errors reported so far, and how many of them contain msg
+    size_t ErrorCount() {
+        std::lock_guard<std::mutex> lock(m_errors.lock);
+        return m_errors.messages.size();
+    }
+    size_t ErrorCount(const char *msg) {
+        std::lock_guard<std::mutex> lock(m_errors.lock);
+        size_t count = 0;
+        for (auto &message : m_errors.messages) {
+            if (message.find(msg) != std::string::npos)
+                count++;
+        }
+        return count;
+    }
+};
+
+// A draw is only logged when it is recorded. Its error must show up once the next command that can't be deferred
+// is recorded into the same command buffer, and not before.
+TEST_F(VkLayerDeferredTest, DrawErrorReportedAtNextCommand) {
+    ASSERT_NO_FATAL_FAILURE(InitState());
+    ASSERT_NO_FATAL_FAILURE(InitRenderTarget());
+
+    m_commandBuffer->BeginCommandBuffer();
+    m_commandBuffer->BeginRenderPass(renderPassBeginInfo());
+    // No pipeline is bound
+    vkCmdDraw(m_commandBuffer->handle(), 3, 1, 0, 0);
+    EXPECT_EQ(0u, ErrorCount());
+
+    m_commandBuffer->EndRenderPass();
+    EXPECT_EQ(1u, ErrorCount("At Draw/Dispatch time no valid VkPipeline is bound!"));
+    m_commandBuffer->EndCommandBuffer();
+}
+
+// A dispatch that is the last command of a command buffer must be validated by vkEndCommandBuffer, so that the
+// error is reported before the command buffer is submitted, and exactly once.
+TEST_F(VkLayerDeferredTest, DispatchErrorReportedBeforeSubmit) {
+    ASSERT_NO_FATAL_FAILURE(InitState());
+
+    m_commandBuffer->BeginCommandBuffer();
+    // No pipeline is bound
+    vkCmdDispatch(m_commandBuffer->handle(), 1, 1, 1);
+    EXPECT_EQ(0u, ErrorCount());
+
+    m_commandBuffer->EndCommandBuffer();
+    EXPECT_EQ(1u, ErrorCount("At Draw/Dispatch time no valid VkPipeline is bound!"));
+
+    m_commandBuffer->QueueCommandBuffer(false);
+    EXPECT_EQ(1u, ErrorCount("At Draw/Dispatch time no valid VkPipeline is bound!"));
+}
+
+// Commands that are valid must not report anything, however they are split between the deferred log and inline
+// validation.
+TEST_F(VkLayerDeferredTest, ValidCommandsReportNothing) {
+    ASSERT_NO_FATAL_FAILURE(InitState());
+
+    VkMemoryPropertyFlags reqs = 0;
+    vk_testing::Buffer buffer;
+    buffer.init_as_dst(*m_device, (VkDeviceSize)256, reqs);
+
+    m_commandBuffer->BeginCommandBuffer();
+    for (uint32_t i = 0; i < 16; i++) {
+        vkCmdSetLineWidth(m_commandBuffer->handle(), 1.0f);
+        m_commandBuffer->FillBuffer(buffer.handle(), 0, 256, i);
+    }
+    m_commandBuffer->EndCommandBuffer();
+    m_commandBuffer->QueueCommandBuffer();
+    EXPECT_EQ(0u, ErrorCount());
+}
+
+// Makes each entry of a colon separated list of paths absolute, so that it still works from another directory
+static void make_env_paths_absolute(const char *name) {
+    const char *value = getenv(name);
+    if (value == NULL)
+        return;
+    std::string paths(value), result;
+    size_t start = 0;
+    while (start <= paths.size()) {
+        size_t end = paths.find(':', start);
+        if (end == std::string::npos)
+            end = paths.size();
+        std::string path = paths.substr(start, end - start);
+        char resolved[PATH_MAX];
+        if (!path.empty() && path[0] != '/' && realpath(path.c_str(), resolved))
+            path = resolved;
+        if (!result.empty())
+            result += ':';
+        result += path;
+        start = end + 1;
+    }
+    setenv(name, result.c_str(), 1);
+}
+
+int main(int argc, char **argv) {
+    int result;
+
+    char dir[] = "/tmp/vk_layer_deferred_tests_XXXXXX";
+    if (mkdtemp(dir) == NULL) {
+        perror("mkdtemp");
+        return 1;
+    }
+    make_env_paths_absolute("VK_LAYER_PATH");
+    make_env_paths_absolute("VK_ICD_FILENAMES");
+    std::string settings = std::string(dir) + "/vk_layer_settings.txt";
+    FILE *file = fopen(settings.c_str(), "w");
+    if (file == NULL || chdir(dir) != 0) {
+        perror(settings.c_str());
+        return 1;
+    }
+    fprintf(file, "lunarg_core_validation.report_flags = error\n"
+                  "lunarg_core_validation.debug_action = VK_DBG_LAYER_ACTION_LOG_MSG\n"
+                  "lunarg_core_validation.deferred_validation = TRUE\n");
+    fclose(file);
+
+    ::testing::InitGoogleTest(&argc, argv);
+    VkTestFramework::InitArgs(&argc, argv);
+
+    ::testing::AddGlobalTestEnvironment(new TestEnvironment);
+
+    result = RUN_ALL_TESTS();
+
+    VkTestFramework::Finish();
+    unlink(settings.c_str());
+    rmdir(dir);
+    return result;
+}
@@ -32,6 +32,7 @@
 #define GLM_FORCE_RADIANS
 #include "glm/glm.hpp"
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
 
 #define PARAMETER_VALIDATION_TESTS 1
 #define MEM_TRACKER_TESTS 1
@@ -2095,6 +2096,301 @@ TEST_F(VkLayerTest, InvalidMemoryAliasing) {
     vkFreeMemory(m_device->device(), mem_img, NULL);
 }
 
+// Apps that sub-allocate bind many resources to one memory allocation, so the aliasing checks must tell disjoint
+// ranges from overlapping ones wherever they fall in the allocation.
+TEST_F(VkLayerTest, ManyResourcesInOneAllocation) {
+    TEST_DESCRIPTION("Bind buffers and images to disjoint ranges of one memory allocation, "
+                     "then alias more images with the first and last buffers.");
+    const uint32_t resource_count = 1000;
+    VkResult err;
+    bool pass;
+    ASSERT_NO_FATAL_FAILURE(InitState());
+
+    VkBufferCreateInfo buf_info = {};
+    buf_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buf_info.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    buf_info.size = 256;
+    buf_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VkImageCreateInfo image_create_info = {};
+    image_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_create_info.imageType = VK_IMAGE_TYPE_2D;
+    image_create_info.format = VK_FORMAT_R8G8B8A8_UNORM;
+    image_create_info.extent.width = 4;
+    image_create_info.extent.height = 4;
+    image_create_info.extent.depth = 1;
+    image_create_info.mipLevels = 1;
+    image_create_info.arrayLayers = 1;
+    image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_create_info.tiling = VK_IMAGE_TILING_LINEAR;
+    image_create_info.initialLayout = VK_IMAGE_LAYOUT_PREINITIALIZED;
+    image_create_info.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    image_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    // Even resources are buffers and odd ones images, so that every bind is checked against a growing list
+    std::vector<VkBuffer> buffers(resource_count / 2);
+    std::vector<VkImage> images(resource_count / 2);
+    for (uint32_t i = 0; i < resource_count / 2; i++) {
+        err = vkCreateBuffer(m_device->device(), &buf_info, NULL, &buffers[i]);
+        ASSERT_VK_SUCCESS(err);
+        err = vkCreateImage(m_device->device(), &image_create_info, NULL, &images[i]);
+        ASSERT_VK_SUCCESS(err);
+    }
+
+    VkMemoryRequirements buff_mem_reqs, img_mem_reqs;
+    vkGetBufferMemoryRequirements(m_device->device(), buffers[0], &buff_mem_reqs);
+    vkGetImageMemoryRequirements(m_device->device(), images[0], &img_mem_reqs);
+
+    // Give each resource its own bufferImageGranularity-aligned slot so that none of them alias
+    VkDeviceSize alignment = m_device->phy().properties().limits.bufferImageGranularity;
+    alignment = std::max(alignment, std::max(buff_mem_reqs.alignment, img_mem_reqs.alignment));
+    VkDeviceSize stride = std::max(buff_mem_reqs.size, img_mem_reqs.size);
+    stride = (stride + alignment - 1) / alignment * alignment;
+
+    VkMemoryAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = stride * resource_count;
+    pass = m_device->phy().set_memory_type(buff_mem_reqs.memoryTypeBits & img_mem_reqs.memoryTypeBits, &alloc_info, 0);
+    VkDeviceMemory mem = VK_NULL_HANDLE;
+    if (pass) {
+        err = vkAllocateMemory(m_device->device(), &alloc_info, NULL, &mem);
+    }
+    if (!pass || err != VK_SUCCESS) {
+        printf("             Unable to allocate memory for %u resources, skipping.\n", resource_count);
+        for (uint32_t i = 0; i < resource_count / 2; i++) {
+            vkDestroyBuffer(m_device->device(), buffers[i], NULL);
+            vkDestroyImage(m_device->device(), images[i], NULL);
+        }
+        return;
+    }
+
+    m_errorMonitor->ExpectSuccess();
+    for (uint32_t i = 0; i < resource_count / 2; i++) {
+        err = vkBindBufferMemory(m_device->device(), buffers[i], mem, 2 * i * stride);
+        ASSERT_VK_SUCCESS(err);
+        err = vkBindImageMemory(m_device->device(), images[i], mem, (2 * i + 1) * stride);
+        ASSERT_VK_SUCCESS(err);
+    }
+    m_errorMonitor->VerifyNotFound();
+
+    // The checks must still find real aliasing among all of those ranges, at either end of the allocation
+    VkImage alias_images[2];
+    const VkDeviceSize alias_offsets[2] = {0, (resource_count - 2) * stride};
+    for (uint32_t i = 0; i < 2; i++) {
+        err = vkCreateImage(m_device->device(), &image_create_info, NULL, &alias_images[i]);
+        ASSERT_VK_SUCCESS(err);
+        m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, " is aliased with buffer 0x");
+        vkBindImageMemory(m_device->device(), alias_images[i], mem, alias_offsets[i]);
+        m_errorMonitor->VerifyFound();
+    }
+
+    for (uint32_t i = 0; i < 2; i++) {
+        vkDestroyImage(m_device->device(), alias_images[i], NULL);
+    }
+    for (uint32_t i = 0; i < resource_count / 2; i++) {
+        vkDestroyBuffer(m_device->device(), buffers[i], NULL);
+        vkDestroyImage(m_device->device(), images[i], NULL);
+    }
+    vkFreeMemory(m_device->device(), mem, NULL);
+}
+
+TEST_F(VkLayerTest, LargeImageLayoutTransitions) {
+    TEST_DESCRIPTION("Transition every subresource of an image with many mip levels and array layers, submit the "
+                     "command buffer, then check that a layout mismatch in one layer is still reported.");
+    ASSERT_NO_FATAL_FAILURE(InitState());
+
+    VkImageCreateInfo image_create_info = {};
+    image_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_create_info.imageType = VK_IMAGE_TYPE_2D;
+    image_create_info.format = VK_FORMAT_R8G8B8A8_UNORM;
+    image_create_info.extent.width = 64;
+    image_create_info.extent.height = 64;
+    image_create_info.extent.depth = 1;
+    image_create_info.mipLevels = 7;
+    image_create_info.arrayLayers = std::min(64u, m_device->phy().properties().limits.maxImageArrayLayers);
+    image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    image_create_info.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    image_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    VkImage image;
+    ASSERT_VK_SUCCESS(vkCreateImage(m_device->device(), &image_create_info, NULL, &image));
+
+    VkMemoryRequirements mem_reqs;
+    vkGetImageMemoryRequirements(m_device->device(), image, &mem_reqs);
+    VkMemoryAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = mem_reqs.size;
+    VkDeviceMemory mem = VK_NULL_HANDLE;
+    VkResult err = VK_ERROR_OUT_OF_DEVICE_MEMORY;
+    if (m_device->phy().set_memory_type(mem_reqs.memoryTypeBits, &alloc_info, 0)) {
+        err = vkAllocateMemory(m_device->device(), &alloc_info, NULL, &mem);
+    }
+    if (err != VK_SUCCESS) {
+        printf("             Unable to allocate memory for a %u layer image, skipping.\n", image_create_info.arrayLayers);
+        vkDestroyImage(m_device->device(), image, NULL);
+        return;
+    }
+    ASSERT_VK_SUCCESS(vkBindImageMemory(m_device->device(), image, mem, 0));
+
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+    VkSubmitInfo submit_info = {};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &m_commandBuffer->handle();
+
+    // Whole image transitions, then one layer at a time through GENERAL and back
+    m_errorMonitor->ExpectSuccess();
+    BeginCommandBuffer();
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(m_commandBuffer->handle(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0,
+                         NULL, 0, NULL, 1, &barrier);
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    for (uint32_t layer = 0; layer < image_create_info.arrayLayers; layer++) {
+        barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, layer, 1};
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+        vkCmdPipelineBarrier(m_commandBuffer->handle(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+                             0, NULL, 0, NULL, 1, &barrier);
+        barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        vkCmdPipelineBarrier(m_commandBuffer->handle(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+                             0, NULL, 0, NULL, 1, &barrier);
+    }
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(m_commandBuffer->handle(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0,
+                         NULL, 0, NULL, 1, &barrier);
+    EndCommandBuffer();
+    vkQueueSubmit(m_device->m_queue, 1, &submit_info, VK_NULL_HANDLE);
+    vkQueueWaitIdle(m_device->m_queue);
+    m_errorMonitor->VerifyNotFound();
+
+    // Every subresource is now in TRANSFER_SRC_OPTIMAL, so a command buffer that expects it in a middle layer submits
+    // cleanly
+    m_errorMonitor->ExpectSuccess();
+    BeginCommandBuffer();
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 1, 1, image_create_info.arrayLayers / 2, 1};
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    vkCmdPipelineBarrier(m_commandBuffer->handle(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0,
+                         NULL, 0, NULL, 1, &barrier);
+    EndCommandBuffer();
+    vkQueueSubmit(m_device->m_queue, 1, &submit_info, VK_NULL_HANDLE);
+    vkQueueWaitIdle(m_device->m_queue);
+    m_errorMonitor->VerifyNotFound();
+
+    // The last layer is now in TRANSFER_SRC_OPTIMAL, so a command buffer that expects GENERAL must fail at submit
+    BeginCommandBuffer();
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 1, 1, image_create_info.arrayLayers - 1, 1};
+    barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    vkCmdPipelineBarrier(m_commandBuffer->handle(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0,
+                         NULL, 0, NULL, 1, &barrier);
+    EndCommandBuffer();
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, "with layout VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL when "
+                                                                        "first use is VK_IMAGE_LAYOUT_GENERAL.");
+    vkQueueSubmit(m_device->m_queue, 1, &submit_info, VK_NULL_HANDLE);
+    m_errorMonitor->VerifyFound();
+    vkQueueWaitIdle(m_device->m_queue);
+
+    vkDestroyImage(m_device->device(), image, NULL);
+    vkFreeMemory(m_device->device(), mem, NULL);
+}
+
+TEST_F(VkLayerTest, ImageLayoutsAcrossCommandBuffers) {
+    TEST_DESCRIPTION("Transition an image one layer at a time in one command buffer and as a whole in the next, checking "
+                     "that submitting both reports nothing and that a wrong whole-image old layout is still reported.");
+    ASSERT_NO_FATAL_FAILURE(InitState());
+
+    VkImageCreateInfo image_create_info = {};
+    image_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_create_info.imageType = VK_IMAGE_TYPE_2D;
+    image_create_info.format = VK_FORMAT_R8G8B8A8_UNORM;
+    image_create_info.extent.width = 32;
+    image_create_info.extent.height = 32;
+    image_create_info.extent.depth = 1;
+    image_create_info.mipLevels = 3;
+    image_create_info.arrayLayers = 4;
+    image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    image_create_info.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    image_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    VkImage image;
+    ASSERT_VK_SUCCESS(vkCreateImage(m_device->device(), &image_create_info, NULL, &image));
+
+    VkMemoryRequirements mem_reqs;
+    vkGetImageMemoryRequirements(m_device->device(), image, &mem_reqs);
+    VkMemoryAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = mem_reqs.size;
+    VkDeviceMemory mem;
+    ASSERT_TRUE(m_device->phy().set_memory_type(mem_reqs.memoryTypeBits, &alloc_info, 0));
+    ASSERT_VK_SUCCESS(vkAllocateMemory(m_device->device(), &alloc_info, NULL, &mem));
+    ASSERT_VK_SUCCESS(vkBindImageMemory(m_device->device(), image, mem, 0));
+
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    VkSubmitInfo submit_info = {};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &m_commandBuffer->handle();
+
+    // Each layer on its own, so only the image's real subresources are set
+    m_errorMonitor->ExpectSuccess();
+    BeginCommandBuffer();
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    for (uint32_t layer = 0; layer < image_create_info.arrayLayers; layer++) {
+        barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, layer, 1};
+        vkCmdPipelineBarrier(m_commandBuffer->handle(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+                             0, NULL, 0, NULL, 1, &barrier);
+    }
+    EndCommandBuffer();
+    vkQueueSubmit(m_device->m_queue, 1, &submit_info, VK_NULL_HANDLE);
+    vkQueueWaitIdle(m_device->m_queue);
+
+    // The whole image in a new command buffer, whose first use must match every subresource the first one left
+    VkCommandBufferObj whole_image_cb(m_device, m_commandPool);
+    submit_info.pCommandBuffers = &whole_image_cb.handle();
+    whole_image_cb.BeginCommandBuffer();
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(whole_image_cb.handle(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0,
+                         NULL, 0, NULL, 1, &barrier);
+    whole_image_cb.EndCommandBuffer();
+    vkQueueSubmit(m_device->m_queue, 1, &submit_info, VK_NULL_HANDLE);
+    vkQueueWaitIdle(m_device->m_queue);
+    m_errorMonitor->VerifyNotFound();
+
+    // Submitting it again expects TRANSFER_DST_OPTIMAL where the image is now in TRANSFER_SRC_OPTIMAL
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, "with layout VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL when "
+                                                                        "first use is VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL.");
+    vkQueueSubmit(m_device->m_queue, 1, &submit_info, VK_NULL_HANDLE);
+    m_errorMonitor->VerifyFound();
+    vkQueueWaitIdle(m_device->m_queue);
+
+    vkDestroyImage(m_device->device(), image, NULL);
+    vkFreeMemory(m_device->device(), mem, NULL);
+}
+
 TEST_F(VkLayerTest, InvalidMemoryMapping) {
     TEST_DESCRIPTION("Attempt to map memory in a number of incorrect ways");
     VkResult err;
@@ -11957,6 +12253,252 @@ TEST_F(VkLayerTest, ThreadCommandBufferCollision) {
 
     vkDestroyEvent(device(), event, NULL);
 }
+
+struct object_usage_thread_data_struct {
+    VkDevice device;
+    uint32_t queueFamilyIndex;
+    VkEvent event;
+    bool bailout;
+    VkResult result;
+};
+
+extern "C" void *RecordSetEvent(void *arg) {
+    struct object_usage_thread_data_struct *data = (struct object_usage_thread_data_struct *)arg;
+
+    // The pool and its command buffers are only used from this thread
+    VkCommandPoolCreateInfo pool_create_info = {};
+    pool_create_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_create_info.queueFamilyIndex = data->queueFamilyIndex;
+    VkCommandPool command_pool;
+    data->result = vkCreateCommandPool(data->device, &pool_create_info, NULL, &command_pool);
+    if (data->result != VK_SUCCESS) {
+        return NULL;
+    }
+
+    VkCommandBuffer command_buffers[32];
+    VkCommandBufferAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    alloc_info.commandPool = command_pool;
+    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    alloc_info.commandBufferCount = 32;
+    data->result = vkAllocateCommandBuffers(data->device, &alloc_info, command_buffers);
+
+    VkCommandBufferBeginInfo begin_info = {};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    for (uint32_t i = 0; (data->result == VK_SUCCESS) && (i < 32); i++) {
+        vkBeginCommandBuffer(command_buffers[i], &begin_info);
+        for (uint32_t j = 0; j < 1000; j++) {
+            vkCmdSetEvent(command_buffers[i], data->event, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+        }
+        data->result = vkEndCommandBuffer(command_buffers[i]);
+    }
+
+    vkDestroyCommandPool(data->device, command_pool, NULL);
+    return NULL;
+}
+
+extern "C" void *SetEventFromHost(void *arg) {
+    struct object_usage_thread_data_struct *data = (struct object_usage_thread_data_struct *)arg;
+
+    for (int i = 0; i < 80000; i++) {
+        vkSetEvent(data->device, data->event);
+        if (data->bailout) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+TEST_F(VkLayerTest, ThreadObjectUsage) {
+    TEST_DESCRIPTION("Record from several threads at once into command buffers that each belong to one thread, all "
+                     "of them reading one event, then write that event from two threads at once.");
+    const uint32_t thread_count = 8;
+    test_platform_thread threads[thread_count];
+
+    ASSERT_NO_FATAL_FAILURE(InitState());
+
+    VkEventCreateInfo event_info = {};
+    event_info.sType = VK_STRUCTURE_TYPE_EVENT_CREATE_INFO;
+    VkEvent event;
+    ASSERT_VK_SUCCESS(vkCreateEvent(device(), &event_info, NULL, &event));
+
+    struct object_usage_thread_data_struct data[thread_count];
+    for (uint32_t i = 0; i < thread_count; i++) {
+        data[i].device = device();
+        data[i].queueFamilyIndex = m_device->graphics_queue_node_index_;
+        data[i].event = event;
+        data[i].bailout = false;
+        data[i].result = VK_SUCCESS;
+    }
+
+    // Every command buffer and pool is written from one thread only and the event is only read, so nothing collides
+    m_errorMonitor->ExpectSuccess();
+    for (uint32_t i = 0; i < thread_count; i++) {
+        test_platform_thread_create(&threads[i], RecordSetEvent, (void *)&data[i]);
+    }
+    for (uint32_t i = 0; i < thread_count; i++) {
+        test_platform_thread_join(threads[i], NULL);
+        ASSERT_VK_SUCCESS(data[i].result);
+    }
+    m_errorMonitor->VerifyNotFound();
+
+    // vkSetEvent writes the event, so setting it from two threads at once must still be reported
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, "THREADING ERROR");
+    m_errorMonitor->SetBailout(&data[0].bailout);
+    test_platform_thread_create(&threads[0], SetEventFromHost, (void *)&data[0]);
+    SetEventFromHost(&data[0]);
+    test_platform_thread_join(threads[0], NULL);
+    m_errorMonitor->SetBailout(NULL);
+    m_errorMonitor->VerifyFound();
+
+    vkDestroyEvent(device(), event, NULL);
+}
+
+struct record_thread_data_struct {
+    VkDevice device;
+    uint32_t queueFamilyIndex;
+    uint32_t commandBufferCount;
+    uint32_t commandCount;
+    // Objects shared by every recording thread
+    const VkRenderPassBeginInfo *pRenderPassBegin;
+    VkPipeline pipeline;
+    VkPipelineLayout pipelineLayout;
+    VkDescriptorSet descriptorSet;
+    VkBuffer vertexBuffer;
+    VkResult result;
+};
+
+extern "C" void *RecordCommandBuffers(void *arg) {
+    struct record_thread_data_struct *data = (struct record_thread_data_struct *)arg;
+
+    // Each thread records into command buffers from its own pool, as the app would
+    VkCommandPoolCreateInfo pool_create_info = {};
+    pool_create_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_create_info.queueFamilyIndex = data->queueFamilyIndex;
+    pool_create_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    VkCommandPool command_pool;
+    data->result = vkCreateCommandPool(data->device, &pool_create_info, NULL, &command_pool);
+    if (data->result != VK_SUCCESS) {
+        return NULL;
+    }
+
+    std::vector<VkCommandBuffer> command_buffers(data->commandBufferCount);
+    VkCommandBufferAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    alloc_info.commandPool = command_pool;
+    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    alloc_info.commandBufferCount = data->commandBufferCount;
+    data->result = vkAllocateCommandBuffers(data->device, &alloc_info, command_buffers.data());
+
+    VkCommandBufferBeginInfo begin_info = {};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    VkViewport viewport = {0.0f, 0.0f, 64.0f, 64.0f, 0.0f, 1.0f};
+    VkRect2D scissor = {{0, 0}, {64, 64}};
+    VkDeviceSize vertex_offset = 0;
+    for (uint32_t i = 0; (data->result == VK_SUCCESS) && (i < data->commandBufferCount); i++) {
+        vkBeginCommandBuffer(command_buffers[i], &begin_info);
+        vkCmdBeginRenderPass(command_buffers[i], data->pRenderPassBegin, VK_SUBPASS_CONTENTS_INLINE);
+        for (uint32_t j = 0; j < data->commandCount; j++) {
+            // Binding the shared objects adds this command buffer to their bindings on every thread at once
+            vkCmdBindPipeline(command_buffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, data->pipeline);
+            vkCmdBindDescriptorSets(command_buffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, data->pipelineLayout, 0, 1,
+                                    &data->descriptorSet, 0, NULL);
+            vkCmdBindVertexBuffers(command_buffers[i], 0, 1, &data->vertexBuffer, &vertex_offset);
+            vkCmdSetViewport(command_buffers[i], 0, 1, &viewport);
+            vkCmdSetScissor(command_buffers[i], 0, 1, &scissor);
+            vkCmdSetLineWidth(command_buffers[i], 1.0f);
+            vkCmdSetStencilReference(command_buffers[i], VK_STENCIL_FRONT_AND_BACK, j);
+            vkCmdDraw(command_buffers[i], 3, 1, 0, 0);
+        }
+        vkCmdEndRenderPass(command_buffers[i]);
+        data->result = vkEndCommandBuffer(command_buffers[i]);
+    }
+
+    vkDestroyCommandPool(data->device, command_pool, NULL);
+    return NULL;
+}
+
+// Records draws from several threads at once, all of them binding the same pipeline, descriptor set and vertex
+// buffer, so that the layers update the state of those shared objects concurrently.
+TEST_F(VkLayerTest, ThreadedCommandBufferRecording) {
+    TEST_DESCRIPTION("Record draws that bind one pipeline, descriptor set and vertex buffer from several threads at "
+                     "once, checking that no validation errors are reported.");
+    const uint32_t thread_count = 4;
+    const uint32_t command_buffers_per_thread = 4;
+    const uint32_t commands_per_command_buffer = 50;
+
+    ASSERT_NO_FATAL_FAILURE(InitState());
+    ASSERT_NO_FATAL_FAILURE(InitRenderTarget());
+    m_errorMonitor->ExpectSuccess();
+
+    char const *vsSource =
+        "#version 450\n"
+        "\n"
+        "layout(location=0) in vec4 pos;\n"
+        "layout(set=0, binding=0) uniform block { vec4 offset; } ubo;\n"
+        "out gl_PerVertex {\n"
+        "    vec4 gl_Position;\n"
+        "};\n"
+        "void main(){\n"
+        "   gl_Position = pos + ubo.offset;\n"
+        "}\n";
+    char const *fsSource =
+        "#version 450\n"
+        "\n"
+        "layout(location=0) out vec4 color;\n"
+        "void main(){\n"
+        "   color = vec4(1);\n"
+        "}\n";
+
+    const float ubo_data[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    VkConstantBufferObj ubo(m_device, 4, sizeof(float), ubo_data, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+    const float vbo_data[12] = {-1.0f, -1.0f, 0.0f, 1.0f, 1.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f};
+    VkConstantBufferObj vbo(m_device, 12, sizeof(float), vbo_data, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+
+    VkDescriptorSetObj descriptorSet(m_device);
+    descriptorSet.AppendBuffer(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, ubo);
+    descriptorSet.CreateVKDescriptorSet(m_commandBuffer);
+
+    VkVertexInputBindingDescription vi_binding = {0, 4 * sizeof(float), VK_VERTEX_INPUT_RATE_VERTEX};
+    VkVertexInputAttributeDescription vi_attrib = {0, 0, VK_FORMAT_R32G32B32A32_SFLOAT, 0};
+
+    VkShaderObj vs(m_device, vsSource, VK_SHADER_STAGE_VERTEX_BIT, this);
+    VkShaderObj fs(m_device, fsSource, VK_SHADER_STAGE_FRAGMENT_BIT, this);
+    VkPipelineObj pipe(m_device);
+    pipe.AddColorAttachment();
+    pipe.AddShader(&vs);
+    pipe.AddShader(&fs);
+    pipe.AddVertexInputBindings(&vi_binding, 1);
+    pipe.AddVertexInputAttribs(&vi_attrib, 1);
+    pipe.MakeDynamic(VK_DYNAMIC_STATE_LINE_WIDTH);
+    pipe.MakeDynamic(VK_DYNAMIC_STATE_STENCIL_REFERENCE);
+    ASSERT_VK_SUCCESS(pipe.CreateVKPipeline(descriptorSet.GetPipelineLayout(), renderPass()));
+
+    struct record_thread_data_struct data[thread_count];
+    for (uint32_t i = 0; i < thread_count; i++) {
+        data[i].device = m_device->device();
+        data[i].queueFamilyIndex = m_device->graphics_queue_node_index_;
+        data[i].commandBufferCount = command_buffers_per_thread;
+        data[i].commandCount = commands_per_command_buffer;
+        data[i].pRenderPassBegin = &renderPassBeginInfo();
+        data[i].pipeline = pipe.handle();
+        data[i].pipelineLayout = descriptorSet.GetPipelineLayout();
+        data[i].descriptorSet = descriptorSet.GetDescriptorSetHandle();
+        data[i].vertexBuffer = vbo.handle();
+        data[i].result = VK_SUCCESS;
+    }
+
+    test_platform_thread threads[thread_count];
+    for (uint32_t i = 0; i < thread_count; i++) {
+        test_platform_thread_create(&threads[i], RecordCommandBuffers, (void *)&data[i]);
+    }
+    for (uint32_t i = 0; i < thread_count; i++) {
+        test_platform_thread_join(threads[i], NULL);
+        EXPECT_EQ(VK_SUCCESS, data[i].result);
+    }
+
+    m_errorMonitor->VerifyNotFound();
+}
 #endif // GTEST_IS_THREADSAFE
 #endif // THREADING_TESTS
 
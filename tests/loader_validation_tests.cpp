@@ -26,6 +26,17 @@
  */
 
 #include <memory>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #include <vulkan/vulkan.h>
 #include "test_common.h"
@@ -542,6 +553,208 @@ TEST(WrapObjects, Insert)
     }
 }
 
+// Resolves every core device command through both vkGetInstanceProcAddr and
+// vkGetDeviceProcAddr with all validation layers enabled. The instance level
+// lookup must return the loader's own trampoline for each name, which checks
+// that every entry of the loader's sorted name tables is paired with the right
+// function.
+TEST(GetProcAddr, CoreDeviceCommands)
+{
+    struct Command
+    {
+        char const* name;
+        PFN_vkVoidFunction trampoline;
+    };
+#define COMMAND(name) {#name, reinterpret_cast<PFN_vkVoidFunction>(name)}
+    static Command const commands[] =
+    {
+        COMMAND(vkAllocateCommandBuffers), COMMAND(vkAllocateDescriptorSets),
+        COMMAND(vkAllocateMemory), COMMAND(vkBeginCommandBuffer), COMMAND(vkBindBufferMemory),
+        COMMAND(vkBindImageMemory), COMMAND(vkCmdBeginQuery), COMMAND(vkCmdBeginRenderPass),
+        COMMAND(vkCmdBindDescriptorSets), COMMAND(vkCmdBindIndexBuffer), COMMAND(vkCmdBindPipeline),
+        COMMAND(vkCmdBindVertexBuffers), COMMAND(vkCmdBlitImage), COMMAND(vkCmdClearAttachments),
+        COMMAND(vkCmdClearColorImage), COMMAND(vkCmdClearDepthStencilImage),
+        COMMAND(vkCmdCopyBuffer), COMMAND(vkCmdCopyBufferToImage), COMMAND(vkCmdCopyImage),
+        COMMAND(vkCmdCopyImageToBuffer), COMMAND(vkCmdCopyQueryPoolResults), COMMAND(vkCmdDispatch),
+        COMMAND(vkCmdDispatchIndirect), COMMAND(vkCmdDraw), COMMAND(vkCmdDrawIndexed),
+        COMMAND(vkCmdDrawIndexedIndirect), COMMAND(vkCmdDrawIndirect), COMMAND(vkCmdEndQuery),
+        COMMAND(vkCmdEndRenderPass), COMMAND(vkCmdExecuteCommands), COMMAND(vkCmdFillBuffer),
+        COMMAND(vkCmdNextSubpass), COMMAND(vkCmdPipelineBarrier), COMMAND(vkCmdPushConstants),
+        COMMAND(vkCmdResetEvent), COMMAND(vkCmdResetQueryPool), COMMAND(vkCmdResolveImage),
+        COMMAND(vkCmdSetBlendConstants), COMMAND(vkCmdSetDepthBias), COMMAND(vkCmdSetDepthBounds),
+        COMMAND(vkCmdSetEvent), COMMAND(vkCmdSetLineWidth), COMMAND(vkCmdSetScissor),
+        COMMAND(vkCmdSetStencilCompareMask), COMMAND(vkCmdSetStencilReference),
+        COMMAND(vkCmdSetStencilWriteMask), COMMAND(vkCmdSetViewport), COMMAND(vkCmdUpdateBuffer),
+        COMMAND(vkCmdWaitEvents), COMMAND(vkCmdWriteTimestamp), COMMAND(vkCreateBuffer),
+        COMMAND(vkCreateBufferView), COMMAND(vkCreateCommandPool),
+        COMMAND(vkCreateComputePipelines), COMMAND(vkCreateDescriptorPool),
+        COMMAND(vkCreateDescriptorSetLayout), COMMAND(vkCreateEvent), COMMAND(vkCreateFence),
+        COMMAND(vkCreateFramebuffer), COMMAND(vkCreateGraphicsPipelines), COMMAND(vkCreateImage),
+        COMMAND(vkCreateImageView), COMMAND(vkCreatePipelineCache), COMMAND(vkCreatePipelineLayout),
+        COMMAND(vkCreateQueryPool), COMMAND(vkCreateRenderPass), COMMAND(vkCreateSampler),
+        COMMAND(vkCreateSemaphore), COMMAND(vkCreateShaderModule), COMMAND(vkDestroyBuffer),
+        COMMAND(vkDestroyBufferView), COMMAND(vkDestroyCommandPool),
+        COMMAND(vkDestroyDescriptorPool), COMMAND(vkDestroyDescriptorSetLayout),
+        COMMAND(vkDestroyDevice), COMMAND(vkDestroyEvent), COMMAND(vkDestroyFence),
+        COMMAND(vkDestroyFramebuffer), COMMAND(vkDestroyImage), COMMAND(vkDestroyImageView),
+        COMMAND(vkDestroyPipeline), COMMAND(vkDestroyPipelineCache),
+        COMMAND(vkDestroyPipelineLayout), COMMAND(vkDestroyQueryPool), COMMAND(vkDestroyRenderPass),
+        COMMAND(vkDestroySampler), COMMAND(vkDestroySemaphore), COMMAND(vkDestroyShaderModule),
+        COMMAND(vkDeviceWaitIdle), COMMAND(vkEndCommandBuffer), COMMAND(vkFlushMappedMemoryRanges),
+        COMMAND(vkFreeCommandBuffers), COMMAND(vkFreeDescriptorSets), COMMAND(vkFreeMemory),
+        COMMAND(vkGetBufferMemoryRequirements), COMMAND(vkGetDeviceMemoryCommitment),
+        COMMAND(vkGetDeviceProcAddr), COMMAND(vkGetDeviceQueue), COMMAND(vkGetEventStatus),
+        COMMAND(vkGetFenceStatus), COMMAND(vkGetImageMemoryRequirements),
+        COMMAND(vkGetImageSparseMemoryRequirements), COMMAND(vkGetImageSubresourceLayout),
+        COMMAND(vkGetPipelineCacheData), COMMAND(vkGetQueryPoolResults),
+        COMMAND(vkGetRenderAreaGranularity), COMMAND(vkInvalidateMappedMemoryRanges),
+        COMMAND(vkMapMemory), COMMAND(vkMergePipelineCaches), COMMAND(vkQueueBindSparse),
+        COMMAND(vkQueueSubmit), COMMAND(vkQueueWaitIdle), COMMAND(vkResetCommandBuffer),
+        COMMAND(vkResetCommandPool), COMMAND(vkResetDescriptorPool), COMMAND(vkResetEvent),
+        COMMAND(vkResetFences), COMMAND(vkSetEvent), COMMAND(vkUnmapMemory),
+        COMMAND(vkUpdateDescriptorSets), COMMAND(vkWaitForFences),
+    };
+#undef COMMAND
+
+    char const*const layers[] = {"VK_LAYER_LUNARG_standard_validation"}; // Temporary required due to MSVC bug.
+    auto const info = VK::InstanceCreateInfo().
+        enabledLayerCount(1).
+        ppEnabledLayerNames(layers);
+
+    VkInstance instance = VK_NULL_HANDLE;
+    VkResult result = vkCreateInstance(info, VK_NULL_HANDLE, &instance);
+    ASSERT_EQ(result, VK_SUCCESS);
+
+    uint32_t physicalCount = 1;
+    VkPhysicalDevice physical = VK_NULL_HANDLE;
+    result = vkEnumeratePhysicalDevices(instance, &physicalCount, &physical);
+    ASSERT_TRUE(result == VK_SUCCESS || result == VK_INCOMPLETE);
+    ASSERT_EQ(physicalCount, 1u);
+
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physical, &familyCount, nullptr);
+    ASSERT_GT(familyCount, 0u);
+
+    float const priorities[] = {0.0f}; // Temporary required due to MSVC bug.
+    VkDeviceQueueCreateInfo const queueInfo[1]
+    {
+        VK::DeviceQueueCreateInfo().
+            queueFamilyIndex(0).
+            queueCount(1).
+            pQueuePriorities(priorities)
+    };
+
+    auto const deviceInfo = VK::DeviceCreateInfo().
+        queueCreateInfoCount(1).
+        pQueueCreateInfos(queueInfo);
+
+    VkDevice device = VK_NULL_HANDLE;
+    result = vkCreateDevice(physical, deviceInfo, nullptr, &device);
+    ASSERT_EQ(result, VK_SUCCESS);
+
+    for(auto const& command : commands)
+    {
+        EXPECT_EQ(vkGetInstanceProcAddr(instance, command.name), command.trampoline) << command.name;
+        EXPECT_NE(vkGetDeviceProcAddr(device, command.name), nullptr) << command.name;
+        // Device commands are not global
+        EXPECT_EQ(vkGetInstanceProcAddr(VK_NULL_HANDLE, command.name), nullptr) << command.name;
+    }
+
+    vkDestroyDevice(device, nullptr);
+    vkDestroyInstance(instance, nullptr);
+}
+
+#if defined(__linux__)
+// Writes a layer manifest for a layer named name, replacing any file at path.
+static void WriteLayerManifest(std::string const& path, char const* name)
+{
+    FILE* file = fopen(path.c_str(), "r+");
+    if(!file)
+    {
+        file = fopen(path.c_str(), "w");
+    }
+    ASSERT_NE(file, nullptr);
+    fprintf(file,
+        "{\n"
+        "    \"file_format_version\" : \"1.0.0\",\n"
+        "    \"layer\" : {\n"
+        "        \"name\": \"%s\",\n"
+        "        \"type\": \"GLOBAL\",\n"
+        "        \"library_path\": \"./libVkLayer_cache_test.so\",\n"
+        "        \"api_version\": \"1.0.21\",\n"
+        "        \"implementation_version\": \"1\",\n"
+        "        \"description\": \"Manifest cache test layer\"\n"
+        "    }\n"
+        "}\n", name);
+    fclose(file);
+}
+
+static bool HasLayer(char const* name)
+{
+    uint32_t count = 0;
+    EXPECT_EQ(vkEnumerateInstanceLayerProperties(&count, nullptr), VK_SUCCESS);
+    std::vector<VkLayerProperties> properties(count);
+    EXPECT_EQ(vkEnumerateInstanceLayerProperties(&count, properties.data()), VK_SUCCESS);
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        if(!strcmp(properties[i].layerName, name))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Manifests are cached after the first scan and only read again when their
+// modification time or size changes. Rewriting a manifest in place with the
+// same size and modification time must therefore go unseen, and touching it
+// must make the next enumeration read it again.
+TEST(EnumerateInstanceLayerProperties, ManifestCache)
+{
+    char dir[] = "/tmp/vk_manifest_cache_XXXXXX";
+    ASSERT_NE(mkdtemp(dir), nullptr);
+    std::string const manifest = std::string(dir) + "/VkLayer_cache_test.json";
+    WriteLayerManifest(manifest, "VK_LAYER_TEST_cache_a");
+
+    char const* const oldPath = getenv("VK_LAYER_PATH");
+    std::string const savedPath = oldPath ? oldPath : "";
+    setenv("VK_LAYER_PATH", dir, 1);
+
+    EXPECT_TRUE(HasLayer("VK_LAYER_TEST_cache_a"));
+
+    // Instance creation must not disturb the cached manifests
+    VkInstance instance = VK_NULL_HANDLE;
+    EXPECT_EQ(vkCreateInstance(VK::InstanceCreateInfo(), VK_NULL_HANDLE, &instance), VK_SUCCESS);
+    vkDestroyInstance(instance, nullptr);
+
+    struct stat before;
+    ASSERT_EQ(stat(manifest.c_str(), &before), 0);
+    WriteLayerManifest(manifest, "VK_LAYER_TEST_cache_b");
+    struct timespec const times[2] = {before.st_atim, before.st_mtim};
+    ASSERT_EQ(utimensat(AT_FDCWD, manifest.c_str(), times, 0), 0);
+
+    EXPECT_TRUE(HasLayer("VK_LAYER_TEST_cache_a"));
+    EXPECT_FALSE(HasLayer("VK_LAYER_TEST_cache_b"));
+
+    struct timespec const later[2] = {before.st_atim, {before.st_mtim.tv_sec + 1, before.st_mtim.tv_nsec}};
+    ASSERT_EQ(utimensat(AT_FDCWD, manifest.c_str(), later, 0), 0);
+
+    EXPECT_FALSE(HasLayer("VK_LAYER_TEST_cache_a"));
+    EXPECT_TRUE(HasLayer("VK_LAYER_TEST_cache_b"));
+
+    if(oldPath)
+    {
+        setenv("VK_LAYER_PATH", savedPath.c_str(), 1);
+    }
+    else
+    {
+        unsetenv("VK_LAYER_PATH");
+    }
+    unlink(manifest.c_str());
+    rmdir(dir);
+}
+#endif // __linux__
+
 int main(int argc, char **argv)
 {
     int result;
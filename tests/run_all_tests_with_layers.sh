@@ -52,3 +52,11 @@ unset VK_DEVICE_LAYERS
 # catch the errors that they are supposed to by intentionally doing things
 # that are wrong
 ./vk_layer_validation_tests
+
+# vk_layer_allocation_tests check that the validation layers do not
+# allocate for every command recorded into a reused command buffer
+./vk_layer_allocation_tests
+
+# vk_layer_deferred_tests check that core_validation still reports errors,
+# and when it should, with deferred validation enabled
+./vk_layer_deferred_tests
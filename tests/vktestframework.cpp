@@ -217,6 +217,7 @@ bool VkTestFramework::m_use_glsl          = false;
 bool VkTestFramework::m_canonicalize_spv  = false;
 bool VkTestFramework::m_strip_spv         = false;
 bool VkTestFramework::m_do_everything_spv = false;
+bool VkTestFramework::m_save_spv          = false;
 int VkTestFramework::m_width = 0;
 int VkTestFramework::m_height = 0;
 std::list<VkTestImageRecord> VkTestFramework::m_images;
@@ -244,6 +245,8 @@ void VkTestFramework::InitArgs(int *argc, char *argv[]) {
              m_strip_spv = true;
         else if (optionMatch("--canonicalize-SPV", argv[i]))
             m_canonicalize_spv = true;
+        else if (optionMatch("--save-SPV", argv[i]))
+            m_save_spv = true;
         else if (optionMatch("--compare-images", argv[i]))
             m_compare_images = true;
 
@@ -275,6 +278,10 @@ void VkTestFramework::InitArgs(int *argc, char *argv[]) {
             printf(
                 "\t--canonicalize-SPV\n"
                 "\t\tRemap SPIR-V ids before submission to aid compression.\n");
+            printf("\t--save-SPV\n"
+                   "\t\tSave the SPIR-V of each shader as a .spv file in the "
+                   "current\n"
+                   "\t\tworking directory.\n");
             exit(0);
         } else {
             printf("\nUnrecognized option: %s\n", argv[i]);
@@ -1831,6 +1838,51 @@ VkTestFramework::FindLanguage(const VkShaderStageFlagBits shader_type) {
     }
 }
 
+//
+// Write SPV to <n>.<stage>.spv in the current directory, numbering the
+// shaders in the order they were compiled
+//
+void VkTestFramework::SaveSPV(const VkShaderStageFlagBits shader_type,
+                              const std::vector<unsigned int> &spirv) {
+    static unsigned int spv_count = 0;
+    const char *suffix;
+    char filename[32];
+
+    switch (shader_type) {
+    case VK_SHADER_STAGE_VERTEX_BIT:
+        suffix = "vert";
+        break;
+    case VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT:
+        suffix = "tesc";
+        break;
+    case VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT:
+        suffix = "tese";
+        break;
+    case VK_SHADER_STAGE_GEOMETRY_BIT:
+        suffix = "geom";
+        break;
+    case VK_SHADER_STAGE_FRAGMENT_BIT:
+        suffix = "frag";
+        break;
+    case VK_SHADER_STAGE_COMPUTE_BIT:
+        suffix = "comp";
+        break;
+    default:
+        return;
+    }
+
+    snprintf(filename, sizeof(filename), "%u.%s.spv", spv_count++, suffix);
+
+    FILE *fp = fopen(filename, "wb");
+    if (!fp) {
+        printf("Unable to write %s\n", filename);
+        return;
+    }
+
+    fwrite(spirv.data(), sizeof(unsigned int), spirv.size(), fp);
+    fclose(fp);
+}
+
 //
 // Compile a given string containing GLSL into SPV for use by VK
 // Return value of false means an error was encountered.
@@ -1908,6 +1960,10 @@ bool VkTestFramework::GLSLtoSPV(const VkShaderStageFlagBits shader_type,
         spv::spirvbin_t(0).remap(spirv, spv::spirvbin_t::DO_EVERYTHING);
     }
 
+    if (this->m_save_spv) {
+        SaveSPV(shader_type, spirv);
+    }
+
     delete shader;
 
     return true;
@@ -111,12 +111,15 @@ public:
     void ProcessConfigFile();
     EShLanguage FindLanguage(const std::string &name);
     EShLanguage FindLanguage(const VkShaderStageFlagBits shader_type);
+    void SaveSPV(const VkShaderStageFlagBits shader_type,
+                 const std::vector<unsigned int> &spirv);
     std::string ConfigFile;
     bool SetConfigFile(const std::string& name);
 
     static bool                             m_show_images;
     static bool                             m_save_images;
     static bool                             m_compare_images;
+    static bool                             m_save_spv;
 
     static std::list<VkTestImageRecord>     m_images;
     static std::list<VkTestImageRecord>::iterator m_display_image;
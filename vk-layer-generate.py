@@ -1526,7 +1526,7 @@ class UniqueObjectsSubcommand(Subcommand):
                         name = '%s[%s]' % (name, idx)
                     if name not in vector_name_set:
                         vector_name_set.add(name)
-                    pre_code += '%slocal_%s%s = (%s)my_map_data->unique_id_mapping[reinterpret_cast<const uint64_t &>(%s%s)];\n' % (indent, prefix, name, struct_uses[obj], prefix, name)
+                    pre_code += '%slocal_%s%s = Unwrap(%s%s);\n' % (indent, prefix, name, prefix, name)
                     if array != '':
                         indent = indent[4:]
                         pre_code += '%s}\n' % (indent)
@@ -1535,9 +1535,9 @@ class UniqueObjectsSubcommand(Subcommand):
                 else:
                     pre_code += '%s\n' % (self.lineinfo.get())
                     if '->' in prefix: # need to update local struct
-                        pre_code += '%slocal_%s%s = (%s)my_map_data->unique_id_mapping[reinterpret_cast<const uint64_t &>(%s%s)];\n' % (indent, prefix, name, struct_uses[obj], prefix, name)
+                        pre_code += '%slocal_%s%s = Unwrap(%s%s);\n' % (indent, prefix, name, prefix, name)
                     else:
-                        pre_code += '%s%s = (%s)my_map_data->unique_id_mapping[reinterpret_cast<uint64_t &>(%s)];\n' % (indent, name, struct_uses[obj], name)
+                        pre_code += '%s%s = Unwrap(%s);\n' % (indent, name, name)
         return decls, pre_code, post_code
 
     def generate_intercept(self, proto, qual):
@@ -1560,7 +1560,16 @@ class UniqueObjectsSubcommand(Subcommand):
                                              'AllocateMemory',
                                              'CreateComputePipelines',
                                              'CreateGraphicsPipelines',
+                                             'UpdateDescriptorSets',
+                                             'CreateDescriptorSetLayout',
+                                             'DestroyDescriptorSetLayout',
+                                             'AllocateDescriptorSets',
+                                             'FreeDescriptorSets',
+                                             'ResetDescriptorPool',
+                                             'DestroyDescriptorPool',
+                                             'BeginCommandBuffer',
                                              'GetPhysicalDeviceDisplayPropertiesKHR',
+                                             'GetPhysicalDeviceDisplayPlanePropertiesKHR',
                                              'GetDisplayPlaneSupportedDisplaysKHR',
                                              'GetDisplayModePropertiesKHR'
                                              ]
@@ -1595,7 +1604,9 @@ class UniqueObjectsSubcommand(Subcommand):
         dispatch_param = proto.params[0].name
         if 'CreateInstance' in proto.name:
            dispatch_param = '*' + proto.params[1].name
-        pre_call_txt += '%slayer_data *my_map_data = get_my_data_ptr(get_dispatch_key(%s), layer_data_map);\n' % (indent, dispatch_param)
+        # Unwrapping a handle needs no layer data, only wrapping new handles and destroying them do
+        if (create_func and proto.params[-1].ty.strip('*') in vulkan.object_non_dispatch_list) or destroy_func:
+            pre_call_txt += '%slayer_data *my_map_data = get_my_data_ptr(get_dispatch_key(%s), layer_data_map);\n' % (indent, dispatch_param)
         if len(struct_uses) > 0:
             pre_call_txt += '// STRUCT USES:%s\n' % sorted(struct_uses)
             if len(local_decls) > 0:
@@ -1603,9 +1614,10 @@ class UniqueObjectsSubcommand(Subcommand):
             if destroy_func: # only one object
                 pre_call_txt += '%sstd::unique_lock<std::mutex> lock(global_lock);\n' % (indent)
                 for del_obj in sorted(struct_uses):
-                    pre_call_txt += '%suint64_t local_%s = reinterpret_cast<uint64_t &>(%s);\n' % (indent, del_obj, del_obj)
-                    pre_call_txt += '%s%s = (%s)my_map_data->unique_id_mapping[local_%s];\n' % (indent, del_obj, struct_uses[del_obj], del_obj)
-                pre_call_txt += '%smy_map_data->unique_id_mapping.erase(local_%s);\n' % (indent, proto.params[-2].name)
+                    if del_obj == proto.params[-2].name:
+                        pre_call_txt += '%s%s = UnwrapAndRelease(my_map_data, %s);\n' % (indent, del_obj, del_obj)
+                    else:
+                        pre_call_txt += '%s%s = Unwrap(%s);\n' % (indent, del_obj, del_obj)
                 pre_call_txt += '%slock.unlock();\n' % (indent)
                 (pre_decl, pre_code, post_code) = ('', '', '')
             else:
@@ -1617,8 +1629,6 @@ class UniqueObjectsSubcommand(Subcommand):
                     init_null_txt = '{}';
                 if local_decls[ld].strip('*') not in vulkan.object_non_dispatch_list:
                     pre_decl += '    safe_%s local_%s = %s;\n' % (local_decls[ld], ld, init_null_txt)
-            if pre_code != '': # lock around map uses
-                pre_code = '%s{\n%sstd::lock_guard<std::mutex> lock(global_lock);\n%s%s}\n' % (indent, indent, pre_code, indent)
             pre_call_txt += '%s%s' % (pre_decl, pre_code)
             post_call_txt += '%s' % (post_code)
         elif create_func:
@@ -1646,16 +1656,12 @@ class UniqueObjectsSubcommand(Subcommand):
                     local_name = '%ss' % (local_name) # add 's' to end for vector of many
                     post_call_txt += '%sfor (uint32_t i=0; i<%s; ++i) {\n' % (indent, custom_create_dict[obj_name])
                     indent += '    '
-                    post_call_txt += '%suint64_t unique_id = global_unique_id++;\n' % (indent)
-                    post_call_txt += '%smy_map_data->unique_id_mapping[unique_id] = reinterpret_cast<uint64_t &>(%s[i]);\n' % (indent, obj_name)
-                    post_call_txt += '%s%s[i] = reinterpret_cast<%s&>(unique_id);\n' % (indent, obj_name, obj_type)
+                    post_call_txt += '%s%s[i] = WrapNew(my_map_data, %s[i]);\n' % (indent, obj_name, obj_name)
                     indent = indent[4:]
                     post_call_txt += '%s}\n' % (indent)
                 else:
                     post_call_txt += '%s\n' % (self.lineinfo.get())
-                    post_call_txt += '%suint64_t unique_id = global_unique_id++;\n' % (indent)
-                    post_call_txt += '%smy_map_data->unique_id_mapping[unique_id] = reinterpret_cast<uint64_t &>(*%s);\n' % (indent, obj_name)
-                    post_call_txt += '%s*%s = reinterpret_cast<%s&>(unique_id);\n' % (indent, obj_name, obj_type)
+                    post_call_txt += '%s*%s = WrapNew(my_map_data, *%s);\n' % (indent, obj_name, obj_name)
                 indent = indent[4:]
                 post_call_txt += '%s}\n' % (indent)
 
@@ -866,6 +866,7 @@ class ApiDumpSubcommand(Subcommand):
         header_txt.append('#include "vk_layer_utils.h"')
         header_txt.append('#include <unordered_map>')
         header_txt.append('#include "api_dump.h"')
+        header_txt.append('#include "api_dump_binary.h"')
         header_txt.append('')
         header_txt.append('static std::ofstream fileStream;')
         header_txt.append('static std::string fileName = "vk_apidump.txt";')
@@ -906,7 +907,11 @@ class ApiDumpSubcommand(Subcommand):
         header_txt.append('')
         header_txt.append('%s' % self.lineinfo.get())
         header_txt.append('static bool g_ApiDumpDetailed = true;')
-        header_txt.append('static uint64_t g_frameCounter = 0;')
+        header_txt.append('static std::atomic<uint64_t> g_frameCounter(0);')
+        header_txt.append('')
+        header_txt.append('static bool g_ApiDumpBinary = false;')
+        header_txt.append('static ApiDumpBinaryWriter g_ApiDumpBinaryWriter;')
+        header_txt.append('static bool openBinaryDump(const char *binaryFileName);')
         header_txt.append('')
         header_txt.append('static LOADER_PLATFORM_THREAD_ONCE_DECLARATION(initOnce);')
         header_txt.append('')
@@ -1008,8 +1013,35 @@ class ApiDumpSubcommand(Subcommand):
         func_body.append('        }')
         func_body.append('    }')
         func_body.append('')
+        func_body.append('    char const*const binaryStr = getLayerOption("lunarg_api_dump.binary");')
+        func_body.append('    if(binaryStr != NULL)')
+        func_body.append('    {')
+        func_body.append('        if(strcmp(binaryStr, "TRUE") == 0)')
+        func_body.append('        {')
+        func_body.append('            g_ApiDumpBinary = true;')
+        func_body.append('        }')
+        func_body.append('        else if(strcmp(binaryStr, "FALSE") == 0)')
+        func_body.append('        {')
+        func_body.append('            g_ApiDumpBinary = false;')
+        func_body.append('        }')
+        func_body.append('    }')
+        func_body.append('')
         func_body.append('%s' % self.lineinfo.get())
-        func_body.append('    ConfigureOutputStream(writeToFile, flushAfterWrite);')
+        func_body.append('    if(g_ApiDumpBinary)')
+        func_body.append('    {')
+        func_body.append('        // Text output is only used to report problems in binary mode')
+        func_body.append('        ConfigureOutputStream(false, flushAfterWrite);')
+        func_body.append('        const char *binaryFileName = (logName != NULL && fileName != "stdout") ? fileName.c_str() : "vk_apidump.bin";')
+        func_body.append('        if(!openBinaryDump(binaryFileName))')
+        func_body.append('        {')
+        func_body.append('            (*outputStream) << endl << "api_dump ERROR: Bad binary output filename specified: " << binaryFileName << ". Writing text to STDOUT instead" << endl << endl;')
+        func_body.append('            g_ApiDumpBinary = false;')
+        func_body.append('        }')
+        func_body.append('    }')
+        func_body.append('    else')
+        func_body.append('    {')
+        func_body.append('        ConfigureOutputStream(writeToFile, flushAfterWrite);')
+        func_body.append('    }')
         func_body.append('')
         func_body.append('    if (!printLockInitialized)')
         func_body.append('    {')
@@ -1021,6 +1053,102 @@ class ApiDumpSubcommand(Subcommand):
         func_body.append('')
         return "\n".join(func_body)
 
+    # Returns the ApiDumpArgKind and enum table index used to render a value of type ty in binary mode
+    def _get_binary_kind(self, ty):
+        base_type = ty.replace('const ', '').strip()
+        if '*' in base_type or '[' in base_type:
+            return ('API_DUMP_ARG_HEX', -1)
+        if base_type in vulkan.object_dispatch_list or base_type in vulkan.object_non_dispatch_list:
+            return ('API_DUMP_ARG_HEX', -1)
+        if re.search('Flags(EXT|KHR)?$', base_type):
+            return ('API_DUMP_ARG_HEX', -1)
+        if base_type == 'float':
+            return ('API_DUMP_ARG_FLOAT', -1)
+        if base_type == 'int32_t':
+            return ('API_DUMP_ARG_SIGNED', -1)
+        if '%s {' % base_type in vk_helper_api_dump.enum_type_dict:
+            if base_type not in self.binary_enums:
+                self.binary_enums.append(base_type)
+            return ('API_DUMP_ARG_ENUM', self.binary_enums.index(base_type))
+        return ('API_DUMP_ARG_UNSIGNED', -1)
+
+    # Records the call in self.binary_funcs and returns the code that dumps it in binary mode.  The
+    # text dump that follows it is the else clause.
+    def _gen_binary_dump(self, proto, create_params):
+        params = []
+        args = []
+        for p in proto.params:
+            (kind, enum_index) = self._get_binary_kind(p.ty)
+            params.append((p.name, p.ty, kind, enum_index))
+            args.append('apiDumpArg(%s)' % p.name)
+        # Single objects returned by Create/Allocate/Map calls are recorded as an extra argument
+        out_type = proto.params[-1].ty.replace('const ', '').strip()
+        if create_params != 0 and proto.ret == 'VkResult' and not proto.name.endswith('s') and out_type.endswith('*'):
+            pointee = out_type[:-1].strip()
+            if pointee in vulkan.object_dispatch_list or pointee in vulkan.object_non_dispatch_list or pointee == 'void*':
+                out_name = proto.params[-1].name
+                params.append(('*%s' % out_name, pointee, 'API_DUMP_ARG_HEX', -1))
+                args.append('(result == VK_SUCCESS && %s) ? apiDumpArg(*%s) : 0' % (out_name, out_name))
+        if proto.ret == 'void':
+            ret_kind = ('API_DUMP_ARG_NONE', -1)
+            result = '0'
+        else:
+            ret_kind = self._get_binary_kind(proto.ret)
+            result = 'apiDumpArg(result)'
+        func_index = len(self.binary_funcs)
+        self.binary_funcs.append((proto.name, ret_kind, params))
+
+        code = '%s\n' % self.lineinfo.get()
+        code += '    if (g_ApiDumpBinary) {\n'
+        code += '        uint64_t args[] = {%s};\n' % ', '.join(args)
+        code += '        g_ApiDumpBinaryWriter.record(%d, %s, g_frameCounter, args, %d);\n' % (func_index, result, len(args))
+        if proto.name == 'DestroyInstance':
+            code += '        g_ApiDumpBinaryWriter.endInstance();\n'
+        code += '    } else {\n    '
+        return code
+
+    # Tables written at the start of a binary dump, and openBinaryDump() which writes them
+    def _gen_binary_tables(self):
+        tables = []
+        tables.append('%s' % self.lineinfo.get())
+        for (func_index, (name, ret_kind, params)) in enumerate(self.binary_funcs):
+            tables.append('static const ApiDumpParamDesc apiDumpParams%d[] = {' % func_index)
+            for (p_name, p_type, kind, enum_index) in params:
+                tables.append('    {"%s", "%s", %s, %d},' % (p_name, p_type, kind, enum_index))
+            tables.append('};')
+        tables.append('')
+        tables.append('static const ApiDumpFuncDesc apiDumpFuncs[] = {')
+        for (func_index, (name, ret_kind, params)) in enumerate(self.binary_funcs):
+            tables.append('    {"vk%s", %s, %d, %d, apiDumpParams%d},' % (name, ret_kind[0], ret_kind[1], len(params), func_index))
+        tables.append('};')
+        tables.append('')
+        for (enum_index, enum_name) in enumerate(self.binary_enums):
+            tables.append('static const ApiDumpEnumValueDesc apiDumpEnumValues%d[] = {' % enum_index)
+            value_count = 0
+            for value_name in vk_helper_api_dump.enum_type_dict['%s {' % enum_name]:
+                value = vk_helper_api_dump.enum_val_dict[value_name]
+                if not value['unique']:
+                    continue
+                try:
+                    int(value['val'], 0)
+                except ValueError:
+                    continue
+                tables.append('    {%s, "%s"},' % (value_name, value_name))
+                value_count += 1
+            tables.append('};')
+            self.binary_enum_counts.append(value_count)
+        tables.append('')
+        tables.append('static const ApiDumpEnumDesc apiDumpEnums[] = {')
+        for (enum_index, enum_name) in enumerate(self.binary_enums):
+            tables.append('    {"%s", %d, apiDumpEnumValues%d},' % (enum_name, self.binary_enum_counts[enum_index], enum_index))
+        tables.append('};')
+        tables.append('')
+        tables.append('static bool openBinaryDump(const char *binaryFileName)')
+        tables.append('{')
+        tables.append('    return g_ApiDumpBinaryWriter.open(binaryFileName, apiDumpFuncs, %d, apiDumpEnums, %d);' % (len(self.binary_funcs), len(self.binary_enums)))
+        tables.append('}')
+        return "\n".join(tables)
+
     def generate_intercept(self, proto, qual):
         if proto.name in [ 'EnumerateInstanceLayerProperties','EnumerateInstanceExtensionProperties','EnumerateDeviceLayerProperties','EnumerateDeviceExtensionProperties']:
             return None
@@ -1037,12 +1165,12 @@ class ApiDumpSubcommand(Subcommand):
         if proto.ret != "void":
             ret_val = "%s result = " % proto.ret
             stmt = "    return result;\n"
-        f_open = 'loader_platform_thread_lock_mutex(&printLock);\n    '
+        f_open = '%sloader_platform_thread_lock_mutex(&printLock);\n    ' % self._gen_binary_dump(proto, create_params)
         log_func = '%s\n' % self.lineinfo.get()
         log_func += '    if (StreamControl::writeAddress == true) {'
         log_func += '\n        (*outputStream) << "t{" << getTIDIndex() << "} f{" << g_frameCounter << "} vk%s(' % proto.name
         log_func_no_addr = '\n        (*outputStream) << "t{" << getTIDIndex() << "} f{" << g_frameCounter << "} vk%s(' % proto.name
-        f_close = '\n    loader_platform_thread_unlock_mutex(&printLock);'
+        f_close = '\n    loader_platform_thread_unlock_mutex(&printLock);\n    }'
         pindex = 0
         prev_count_name = ''
         for p in proto.params:
@@ -1186,6 +1314,9 @@ class ApiDumpSubcommand(Subcommand):
                      '    if (result == VK_SUCCESS) {\n'
                      '        initInstanceTable(*pInstance, fpGetInstanceProcAddr);\n'
                      '        createInstanceRegisterExtensions(pCreateInfo, *pInstance);\n'
+                     '        if (g_ApiDumpBinary) {\n'
+                     '            g_ApiDumpBinaryWriter.beginInstance();\n'
+                     '        }\n'
                      '    }\n'
                      '    %s%s%s\n'
                      '%s'
@@ -1256,6 +1387,9 @@ class ApiDumpSubcommand(Subcommand):
 
     def generate_body(self):
         self.layer_name = "api_dump"
+        self.binary_funcs = []
+        self.binary_enums = []
+        self.binary_enum_counts = []
         if self.wsi == 'Win32':
             instance_extensions=[('wsi_enabled',
                                   ['vkDestroySurfaceKHR',
@@ -1318,6 +1452,7 @@ class ApiDumpSubcommand(Subcommand):
                       'vkAcquireNextImageKHR', 'vkQueuePresentKHR'])]
         body = [self.generate_init(),
                 self._generate_dispatch_entrypoints("VK_LAYER_EXPORT"),
+                self._gen_binary_tables(),
                 self._generate_layer_gpa_function(extensions, instance_extensions)]
         return "\n\n".join(body)
 
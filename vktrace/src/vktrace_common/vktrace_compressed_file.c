@@ -0,0 +1,687 @@
+/**************************************************************************
+ *
+ * Copyright 2016 Valve Corporation
+ * Copyright (C) 2016 LunarG, Inc.
+ * All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **************************************************************************/
+#include "vktrace_compressed_file.h"
+#include "vktrace_tracelog.h"
+#include <assert.h>
+
+//=============================================================================
+// LZ4 block format codec
+// Greedy single-probe compressor; the output can be read by any LZ4 block
+// decoder and vice versa.
+
+#define LZ4_HASH_LOG        16
+#define LZ4_MIN_MATCH       4
+#define LZ4_MFLIMIT         12  // no match may start in the last 12 bytes
+#define LZ4_LAST_LITERALS   5   // the last 5 bytes are always literals
+#define LZ4_MAX_OFFSET      65535
+
+static uint32_t lz4_read32(const uint8_t* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint32_t lz4_hash(uint32_t sequence)
+{
+    return (sequence * 2654435761U) >> (32 - LZ4_HASH_LOG);
+}
+
+static uint8_t* lz4_write_length(uint8_t* op, size_t length)
+{
+    while (length >= 255)
+    {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = (uint8_t)length;
+    return op;
+}
+
+// Writes literals followed by a match (or no match when matchLength is 0).
+// Returns NULL if the sequence does not fit.
+static uint8_t* lz4_write_sequence(uint8_t* op, const uint8_t* oend, const uint8_t* pLiterals, size_t literalLength, size_t offset, size_t matchLength)
+{
+    uint8_t* pToken = op++;
+    size_t needed = 1 + literalLength / 255 + 1 + literalLength + 2 + matchLength / 255 + 1;
+    if (needed > (size_t)(oend - pToken))
+        return NULL;
+
+    if (literalLength >= 15)
+    {
+        *pToken = 15 << 4;
+        op = lz4_write_length(op, literalLength - 15);
+    }
+    else
+    {
+        *pToken = (uint8_t)(literalLength << 4);
+    }
+    memcpy(op, pLiterals, literalLength);
+    op += literalLength;
+
+    if (matchLength == 0)
+        return op;
+
+    *op++ = (uint8_t)(offset & 0xff);
+    *op++ = (uint8_t)(offset >> 8);
+    matchLength -= LZ4_MIN_MATCH;
+    if (matchLength >= 15)
+    {
+        *pToken |= 15;
+        op = lz4_write_length(op, matchLength - 15);
+    }
+    else
+    {
+        *pToken |= (uint8_t)matchLength;
+    }
+    return op;
+}
+
+size_t vktrace_lz4_compress_bound(size_t srcSize)
+{
+    return srcSize + srcSize / 255 + 16;
+}
+
+size_t vktrace_lz4_compress(const uint8_t* pSrc, size_t srcSize, uint8_t* pDst, size_t dstCapacity)
+{
+    const uint8_t* ip = pSrc;
+    const uint8_t* anchor = pSrc;
+    const uint8_t* const iend = pSrc + srcSize;
+    uint8_t* op = pDst;
+    const uint8_t* const oend = pDst + dstCapacity;
+    uint32_t* pHashTable;
+    unsigned int misses = 0;
+
+    if (srcSize >= LZ4_MFLIMIT + 1)
+    {
+        const uint8_t* const mflimit = iend - LZ4_MFLIMIT;
+        const uint8_t* const matchlimit = iend - LZ4_LAST_LITERALS;
+
+        // offsets are stored as 32 bits, chunks are far smaller than that
+        assert(srcSize <= 0xffffffff);
+        pHashTable = (uint32_t*)vktrace_malloc(sizeof(uint32_t) << LZ4_HASH_LOG);
+        if (pHashTable == NULL)
+            return 0;
+        memset(pHashTable, 0, sizeof(uint32_t) << LZ4_HASH_LOG);
+
+        while (ip < mflimit)
+        {
+            uint32_t sequence = lz4_read32(ip);
+            uint32_t hash = lz4_hash(sequence);
+            const uint8_t* ref = pSrc + pHashTable[hash];
+            const uint8_t* matchEnd;
+            pHashTable[hash] = (uint32_t)(ip - pSrc);
+
+            if (ref >= ip || (size_t)(ip - ref) > LZ4_MAX_OFFSET || lz4_read32(ref) != sequence)
+            {
+                // skip ahead faster through data that does not compress
+                ip += 1 + (misses++ >> 6);
+                continue;
+            }
+            misses = 0;
+
+            // extend the match backwards over pending literals, then forwards
+            while (ip > anchor && ref > pSrc && ip[-1] == ref[-1])
+            {
+                ip--;
+                ref--;
+            }
+            matchEnd = ip + LZ4_MIN_MATCH;
+            ref += LZ4_MIN_MATCH;
+            while (matchEnd < matchlimit && *matchEnd == *ref)
+            {
+                matchEnd++;
+                ref++;
+            }
+
+            op = lz4_write_sequence(op, oend, anchor, (size_t)(ip - anchor), (size_t)(matchEnd - ref), (size_t)(matchEnd - ip));
+            if (op == NULL)
+            {
+                vktrace_free(pHashTable);
+                return 0;
+            }
+            ip = matchEnd;
+            anchor = ip;
+        }
+        vktrace_free(pHashTable);
+    }
+
+    op = lz4_write_sequence(op, oend, anchor, (size_t)(iend - anchor), 0, 0);
+    if (op == NULL)
+        return 0;
+    return (size_t)(op - pDst);
+}
+
+// reads the extra bytes of a 4 bit length that was 15; returns FALSE on truncated input
+static BOOL lz4_read_length(const uint8_t** pIp, const uint8_t* iend, size_t* pLength)
+{
+    const uint8_t* ip = *pIp;
+    uint8_t byte;
+    do
+    {
+        if (ip >= iend)
+            return FALSE;
+        byte = *ip++;
+        *pLength += byte;
+    } while (byte == 255);
+    *pIp = ip;
+    return TRUE;
+}
+
+size_t vktrace_lz4_decompress(const uint8_t* pSrc, size_t srcSize, uint8_t* pDst, size_t dstCapacity)
+{
+    const uint8_t* ip = pSrc;
+    const uint8_t* const iend = pSrc + srcSize;
+    uint8_t* op = pDst;
+    uint8_t* const oend = pDst + dstCapacity;
+
+    while (ip < iend)
+    {
+        uint8_t token = *ip++;
+        size_t length = token >> 4;
+        size_t offset;
+        const uint8_t* match;
+
+        if (length == 15 && !lz4_read_length(&ip, iend, &length))
+            return 0;
+        if (length > (size_t)(iend - ip) || length > (size_t)(oend - op))
+            return 0;
+        memcpy(op, ip, length);
+        ip += length;
+        op += length;
+
+        // the last sequence has no match
+        if (ip == iend)
+            break;
+
+        if (iend - ip < 2)
+            return 0;
+        offset = ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - pDst))
+            return 0;
+
+        length = token & 15;
+        if (length == 15 && !lz4_read_length(&ip, iend, &length))
+            return 0;
+        length += LZ4_MIN_MATCH;
+        if (length > (size_t)(oend - op))
+            return 0;
+
+        match = op - offset;
+        if (offset >= length)
+        {
+            memcpy(op, match, length);
+            op += length;
+        }
+        else
+        {
+            // overlapping copy repeats the last offset bytes
+            while (length-- > 0)
+                *op++ = *match++;
+        }
+    }
+    return (size_t)(op - pDst);
+}
+
+//=============================================================================
+// Chunked trace file
+
+struct vktrace_compressed_file
+{
+    FILE* pFile;
+    BOOL writing;
+    uint64_t firstChunkOffset;
+
+    // uncompressed data of the current chunk
+    uint8_t* pChunk;
+    size_t chunkUsed;               // bytes of pChunk holding data
+    size_t chunkPos;                // read position in pChunk
+    uint64_t chunkStart;            // uncompressed offset of pChunk[0]
+    uint64_t currentChunk;          // index of the chunk in pChunk when reading, chunkCount if none
+
+    uint8_t* pCompressed;
+    size_t compressedCapacity;
+
+    vktrace_compressed_chunk_entry* pChunks;
+    uint64_t chunkCount;
+    uint64_t chunkCapacity;
+
+    vktrace_compressed_frame_entry* pFrames;
+    uint64_t frameCount;
+    uint64_t frameCapacity;
+};
+
+static BOOL compressed_file_seek_file(FILE* pFile, uint64_t offset)
+{
+#if defined(WIN32)
+    return _fseeki64(pFile, (__int64)offset, SEEK_SET) == 0;
+#else
+    return fseeko(pFile, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+static uint64_t compressed_file_tell_file(FILE* pFile)
+{
+#if defined(WIN32)
+    return (uint64_t)_ftelli64(pFile);
+#else
+    return (uint64_t)ftello(pFile);
+#endif
+}
+
+// grows an array of elementSize elements so that it has room for one more
+static BOOL compressed_file_reserve(void** ppArray, uint64_t count, uint64_t* pCapacity, size_t elementSize)
+{
+    void* pNewArray;
+    uint64_t newCapacity;
+    if (count < *pCapacity)
+        return TRUE;
+
+    newCapacity = (*pCapacity == 0) ? 64 : *pCapacity * 2;
+    pNewArray = vktrace_realloc(*ppArray, (size_t)(newCapacity * elementSize));
+    if (pNewArray == NULL)
+        return FALSE;
+    *ppArray = pNewArray;
+    *pCapacity = newCapacity;
+    return TRUE;
+}
+
+static BOOL compressed_file_add_chunk_entry(vktrace_compressed_file* pFile, uint64_t fileOffset, uint64_t uncompressedOffset)
+{
+    if (!compressed_file_reserve((void**)&pFile->pChunks, pFile->chunkCount, &pFile->chunkCapacity, sizeof(vktrace_compressed_chunk_entry)))
+        return FALSE;
+    pFile->pChunks[pFile->chunkCount].file_offset = fileOffset;
+    pFile->pChunks[pFile->chunkCount].uncompressed_offset = uncompressedOffset;
+    pFile->chunkCount++;
+    return TRUE;
+}
+
+static void compressed_file_delete(vktrace_compressed_file* pFile)
+{
+    vktrace_free(pFile->pChunk);
+    vktrace_free(pFile->pCompressed);
+    vktrace_free(pFile->pChunks);
+    vktrace_free(pFile->pFrames);
+    vktrace_free(pFile);
+}
+
+static vktrace_compressed_file* compressed_file_new(FILE* pFile, BOOL writing)
+{
+    vktrace_compressed_file* pCompressedFile = VKTRACE_NEW(vktrace_compressed_file);
+    if (pCompressedFile == NULL)
+        return NULL;
+    memset(pCompressedFile, 0, sizeof(vktrace_compressed_file));
+    pCompressedFile->pFile = pFile;
+    pCompressedFile->writing = writing;
+    pCompressedFile->compressedCapacity = vktrace_lz4_compress_bound(VKTRACE_COMPRESSED_CHUNK_SIZE);
+    pCompressedFile->pChunk = (uint8_t*)vktrace_malloc(VKTRACE_COMPRESSED_CHUNK_SIZE);
+    pCompressedFile->pCompressed = (uint8_t*)vktrace_malloc(pCompressedFile->compressedCapacity);
+    if (pCompressedFile->pChunk == NULL || pCompressedFile->pCompressed == NULL)
+    {
+        compressed_file_delete(pCompressedFile);
+        return NULL;
+    }
+    return pCompressedFile;
+}
+
+// compresses and writes out the data in pChunk
+static BOOL compressed_file_flush_chunk(vktrace_compressed_file* pFile)
+{
+    vktrace_compressed_chunk_header header;
+    const uint8_t* pData = pFile->pCompressed;
+    uint64_t fileOffset = compressed_file_tell_file(pFile->pFile);
+    size_t compressedSize;
+
+    if (pFile->chunkUsed == 0)
+        return TRUE;
+
+    compressedSize = vktrace_lz4_compress(pFile->pChunk, pFile->chunkUsed, pFile->pCompressed, pFile->compressedCapacity);
+    header.magic = VKTRACE_COMPRESSED_CHUNK_MAGIC;
+    header.compression = VKTRACE_COMPRESSION_LZ4;
+    header.uncompressed_size = pFile->chunkUsed;
+    if (compressedSize == 0 || compressedSize >= pFile->chunkUsed)
+    {
+        // store data that does not compress as is
+        header.compression = VKTRACE_COMPRESSION_NONE;
+        compressedSize = pFile->chunkUsed;
+        pData = pFile->pChunk;
+    }
+    header.compressed_size = compressedSize;
+
+    if (fwrite(&header, sizeof(header), 1, pFile->pFile) != 1 ||
+        fwrite(pData, compressedSize, 1, pFile->pFile) != 1)
+    {
+        vktrace_LogError("Failed to write compressed trace chunk.");
+        return FALSE;
+    }
+    if (!compressed_file_add_chunk_entry(pFile, fileOffset, pFile->chunkStart))
+    {
+        vktrace_LogError("Out of memory while indexing compressed trace chunks.");
+        return FALSE;
+    }
+
+    pFile->chunkStart += pFile->chunkUsed;
+    pFile->chunkUsed = 0;
+    return TRUE;
+}
+
+vktrace_compressed_file* vktrace_compressed_file_create(FILE* pFile)
+{
+    vktrace_compressed_file* pCompressedFile = compressed_file_new(pFile, TRUE);
+    if (pCompressedFile != NULL)
+    {
+        pCompressedFile->firstChunkOffset = compressed_file_tell_file(pFile);
+    }
+    return pCompressedFile;
+}
+
+BOOL vktrace_compressed_file_write(vktrace_compressed_file* pFile, const void* pBytes, size_t size)
+{
+    const uint8_t* pSrc = (const uint8_t*)pBytes;
+    assert(pFile->writing);
+    while (size > 0)
+    {
+        size_t copySize = VKTRACE_COMPRESSED_CHUNK_SIZE - pFile->chunkUsed;
+        if (copySize > size)
+            copySize = size;
+        memcpy(pFile->pChunk + pFile->chunkUsed, pSrc, copySize);
+        pFile->chunkUsed += copySize;
+        pSrc += copySize;
+        size -= copySize;
+
+        if (pFile->chunkUsed == VKTRACE_COMPRESSED_CHUNK_SIZE && !compressed_file_flush_chunk(pFile))
+            return FALSE;
+    }
+    return TRUE;
+}
+
+void vktrace_compressed_file_mark_frame_end(vktrace_compressed_file* pFile, uint64_t globalPacketIndex)
+{
+    assert(pFile->writing);
+    if (!compressed_file_reserve((void**)&pFile->pFrames, pFile->frameCount, &pFile->frameCapacity, sizeof(vktrace_compressed_frame_entry)))
+    {
+        vktrace_LogWarning("Out of memory while indexing frames, frame %llu will not be in the index.", (unsigned long long)pFile->frameCount);
+        return;
+    }
+    pFile->pFrames[pFile->frameCount].uncompressed_offset = pFile->chunkStart + pFile->chunkUsed;
+    pFile->pFrames[pFile->frameCount].global_packet_index = globalPacketIndex;
+    pFile->frameCount++;
+}
+
+static BOOL compressed_file_write_index(vktrace_compressed_file* pFile)
+{
+    vktrace_compressed_file_footer footer;
+    footer.chunk_count = pFile->chunkCount;
+    footer.frame_count = pFile->frameCount;
+    footer.index_offset = compressed_file_tell_file(pFile->pFile);
+    footer.magic = VKTRACE_COMPRESSED_FOOTER_MAGIC;
+    footer.reserved = 0;
+
+    if ((pFile->chunkCount > 0 && fwrite(pFile->pChunks, sizeof(vktrace_compressed_chunk_entry), (size_t)pFile->chunkCount, pFile->pFile) != pFile->chunkCount) ||
+        (pFile->frameCount > 0 && fwrite(pFile->pFrames, sizeof(vktrace_compressed_frame_entry), (size_t)pFile->frameCount, pFile->pFile) != pFile->frameCount) ||
+        fwrite(&footer, sizeof(footer), 1, pFile->pFile) != 1)
+    {
+        vktrace_LogError("Failed to write the index of the compressed trace file.");
+        return FALSE;
+    }
+    fflush(pFile->pFile);
+    return TRUE;
+}
+
+BOOL vktrace_compressed_file_close(vktrace_compressed_file** ppFile)
+{
+    BOOL result = TRUE;
+    if (ppFile == NULL || *ppFile == NULL)
+        return FALSE;
+
+    if ((*ppFile)->writing)
+    {
+        result = compressed_file_flush_chunk(*ppFile) && compressed_file_write_index(*ppFile);
+    }
+    compressed_file_delete(*ppFile);
+    *ppFile = NULL;
+    return result;
+}
+
+// reads the index written by vktrace_compressed_file_close, if the file has one
+static BOOL compressed_file_read_index(vktrace_compressed_file* pFile)
+{
+    vktrace_compressed_file_footer footer;
+    uint64_t fileSize;
+
+#if defined(WIN32)
+    if (_fseeki64(pFile->pFile, 0, SEEK_END) != 0)
+        return FALSE;
+#else
+    if (fseeko(pFile->pFile, 0, SEEK_END) != 0)
+        return FALSE;
+#endif
+    fileSize = compressed_file_tell_file(pFile->pFile);
+    if (fileSize < pFile->firstChunkOffset + sizeof(footer) ||
+        !compressed_file_seek_file(pFile->pFile, fileSize - sizeof(footer)) ||
+        fread(&footer, sizeof(footer), 1, pFile->pFile) != 1 ||
+        footer.magic != VKTRACE_COMPRESSED_FOOTER_MAGIC ||
+        footer.index_offset < pFile->firstChunkOffset ||
+        footer.index_offset + footer.chunk_count * sizeof(vktrace_compressed_chunk_entry) + footer.frame_count * sizeof(vktrace_compressed_frame_entry) + sizeof(footer) != fileSize)
+    {
+        return FALSE;
+    }
+
+    pFile->pChunks = (vktrace_compressed_chunk_entry*)vktrace_malloc((size_t)(footer.chunk_count * sizeof(vktrace_compressed_chunk_entry)) + 1);
+    pFile->pFrames = (vktrace_compressed_frame_entry*)vktrace_malloc((size_t)(footer.frame_count * sizeof(vktrace_compressed_frame_entry)) + 1);
+    if (pFile->pChunks == NULL || pFile->pFrames == NULL ||
+        !compressed_file_seek_file(pFile->pFile, footer.index_offset) ||
+        fread(pFile->pChunks, sizeof(vktrace_compressed_chunk_entry), (size_t)footer.chunk_count, pFile->pFile) != footer.chunk_count ||
+        fread(pFile->pFrames, sizeof(vktrace_compressed_frame_entry), (size_t)footer.frame_count, pFile->pFile) != footer.frame_count)
+    {
+        vktrace_free(pFile->pChunks);
+        vktrace_free(pFile->pFrames);
+        pFile->pChunks = NULL;
+        pFile->pFrames = NULL;
+        return FALSE;
+    }
+    pFile->chunkCount = pFile->chunkCapacity = footer.chunk_count;
+    pFile->frameCount = pFile->frameCapacity = footer.frame_count;
+    return TRUE;
+}
+
+// rebuilds the chunk index of a trace that has no footer by walking the chunk headers
+static BOOL compressed_file_scan_chunks(vktrace_compressed_file* pFile)
+{
+    vktrace_compressed_chunk_header header;
+    uint64_t fileOffset = pFile->firstChunkOffset;
+    uint64_t uncompressedOffset = 0;
+
+    while (compressed_file_seek_file(pFile->pFile, fileOffset) &&
+           fread(&header, sizeof(header), 1, pFile->pFile) == 1 &&
+           header.magic == VKTRACE_COMPRESSED_CHUNK_MAGIC)
+    {
+        if (!compressed_file_add_chunk_entry(pFile, fileOffset, uncompressedOffset))
+            return FALSE;
+        fileOffset += sizeof(header) + header.compressed_size;
+        uncompressedOffset += header.uncompressed_size;
+    }
+    return TRUE;
+}
+
+// reads chunk into pChunk and makes it the current chunk
+static BOOL compressed_file_load_chunk(vktrace_compressed_file* pFile, uint64_t chunk)
+{
+    vktrace_compressed_chunk_header header;
+    BOOL result = FALSE;
+
+    if (chunk >= pFile->chunkCount)
+        return FALSE;
+    if (chunk == pFile->currentChunk)
+    {
+        pFile->chunkPos = 0;
+        return TRUE;
+    }
+
+    if (compressed_file_seek_file(pFile->pFile, pFile->pChunks[chunk].file_offset) &&
+        fread(&header, sizeof(header), 1, pFile->pFile) == 1 &&
+        header.magic == VKTRACE_COMPRESSED_CHUNK_MAGIC &&
+        header.uncompressed_size <= VKTRACE_COMPRESSED_CHUNK_SIZE)
+    {
+        if (header.compression == VKTRACE_COMPRESSION_NONE && header.compressed_size == header.uncompressed_size)
+        {
+            result = fread(pFile->pChunk, (size_t)header.compressed_size, 1, pFile->pFile) == 1;
+        }
+        else if (header.compression == VKTRACE_COMPRESSION_LZ4 && header.compressed_size <= pFile->compressedCapacity)
+        {
+            result = fread(pFile->pCompressed, (size_t)header.compressed_size, 1, pFile->pFile) == 1 &&
+                     vktrace_lz4_decompress(pFile->pCompressed, (size_t)header.compressed_size, pFile->pChunk, (size_t)header.uncompressed_size) == header.uncompressed_size;
+        }
+    }
+
+    if (!result)
+    {
+        vktrace_LogError("Compressed trace chunk %llu is corrupt.", (unsigned long long)chunk);
+        pFile->currentChunk = pFile->chunkCount;
+        pFile->chunkUsed = pFile->chunkPos = 0;
+        return FALSE;
+    }
+
+    pFile->currentChunk = chunk;
+    pFile->chunkStart = pFile->pChunks[chunk].uncompressed_offset;
+    pFile->chunkUsed = (size_t)header.uncompressed_size;
+    pFile->chunkPos = 0;
+    return TRUE;
+}
+
+vktrace_compressed_file* vktrace_compressed_file_open(FILE* pFile, uint64_t firstChunkOffset)
+{
+    vktrace_compressed_file* pCompressedFile = compressed_file_new(pFile, FALSE);
+    if (pCompressedFile == NULL)
+        return NULL;
+    pCompressedFile->firstChunkOffset = firstChunkOffset;
+
+    if (!compressed_file_read_index(pCompressedFile))
+    {
+        vktrace_LogWarning("Compressed trace file has no index, it may have been cut short. Frames cannot be located.");
+        if (!compressed_file_scan_chunks(pCompressedFile))
+        {
+            compressed_file_delete(pCompressedFile);
+            return NULL;
+        }
+    }
+
+    pCompressedFile->currentChunk = pCompressedFile->chunkCount;
+    if (pCompressedFile->chunkCount > 0)
+    {
+        compressed_file_load_chunk(pCompressedFile, 0);
+    }
+    return pCompressedFile;
+}
+
+BOOL vktrace_compressed_file_read(vktrace_compressed_file* pFile, void* pBytes, size_t size)
+{
+    uint8_t* pDst = (uint8_t*)pBytes;
+    assert(!pFile->writing);
+    while (size > 0)
+    {
+        size_t copySize;
+        if (pFile->chunkPos == pFile->chunkUsed)
+        {
+            if (pFile->currentChunk + 1 >= pFile->chunkCount)
+            {
+                vktrace_LogVerbose("Reached end of file.");
+                return FALSE;
+            }
+            if (!compressed_file_load_chunk(pFile, pFile->currentChunk + 1))
+                return FALSE;
+        }
+
+        copySize = pFile->chunkUsed - pFile->chunkPos;
+        if (copySize > size)
+            copySize = size;
+        memcpy(pDst, pFile->pChunk + pFile->chunkPos, copySize);
+        pFile->chunkPos += copySize;
+        pDst += copySize;
+        size -= copySize;
+    }
+    return TRUE;
+}
+
+uint64_t vktrace_compressed_file_tell(vktrace_compressed_file* pFile)
+{
+    if (pFile->writing)
+        return pFile->chunkStart + pFile->chunkUsed;
+    return pFile->chunkStart + pFile->chunkPos;
+}
+
+BOOL vktrace_compressed_file_seek(vktrace_compressed_file* pFile, uint64_t uncompressedOffset)
+{
+    uint64_t low = 0;
+    uint64_t high = pFile->chunkCount;
+    assert(!pFile->writing);
+    if (pFile->chunkCount == 0)
+        return uncompressedOffset == 0;
+
+    // find the last chunk that starts at or before uncompressedOffset
+    while (high - low > 1)
+    {
+        uint64_t middle = low + (high - low) / 2;
+        if (pFile->pChunks[middle].uncompressed_offset <= uncompressedOffset)
+            low = middle;
+        else
+            high = middle;
+    }
+
+    if (!compressed_file_load_chunk(pFile, low))
+        return FALSE;
+    if (uncompressedOffset - pFile->chunkStart > pFile->chunkUsed)
+        return FALSE;
+    pFile->chunkPos = (size_t)(uncompressedOffset - pFile->chunkStart);
+    return TRUE;
+}
+
+uint64_t vktrace_compressed_file_get_size(vktrace_compressed_file* pFile)
+{
+    vktrace_compressed_chunk_header header;
+    const vktrace_compressed_chunk_entry* pLastChunk;
+    assert(!pFile->writing);
+    if (pFile->chunkCount == 0)
+        return 0;
+
+    // only the header of the last chunk is read; the current chunk stays loaded
+    pLastChunk = &pFile->pChunks[pFile->chunkCount - 1];
+    if (!compressed_file_seek_file(pFile->pFile, pLastChunk->file_offset) ||
+        fread(&header, sizeof(header), 1, pFile->pFile) != 1 ||
+        header.magic != VKTRACE_COMPRESSED_CHUNK_MAGIC)
+    {
+        return 0;
+    }
+    return pLastChunk->uncompressed_offset + header.uncompressed_size;
+}
+
+uint64_t vktrace_compressed_file_get_frame_count(vktrace_compressed_file* pFile)
+{
+    return pFile->frameCount;
+}
+
+BOOL vktrace_compressed_file_get_frame_offset(vktrace_compressed_file* pFile, uint64_t frame, uint64_t* pUncompressedOffset)
+{
+    if (frame > pFile->frameCount)
+        return FALSE;
+    // frame 0 starts with the first packet, every other frame where the previous one ended
+    *pUncompressedOffset = (frame == 0) ? 0 : pFile->pFrames[frame - 1].uncompressed_offset;
+    return TRUE;
+}
@@ -0,0 +1,128 @@
+/**************************************************************************
+ *
+ * Copyright 2016 Valve Corporation
+ * Copyright (C) 2016 LunarG, Inc.
+ * All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **************************************************************************/
+#pragma once
+
+#include "vktrace_common.h"
+
+// Compressed trace files (VKTRACE_TRACE_FILE_VERSION_4)
+//
+// After the vktrace_trace_file_header, the packet stream is cut into chunks of
+// at most VKTRACE_COMPRESSED_CHUNK_SIZE bytes. Each chunk is stored as a
+// vktrace_compressed_chunk_header followed by the chunk data, compressed in the
+// LZ4 block format (or stored as is when it does not compress). Packets may
+// span chunks.
+//
+// Closing a file that is being written appends an index: one
+// vktrace_compressed_chunk_entry per chunk, one vktrace_compressed_frame_entry
+// per frame boundary, then a vktrace_compressed_file_footer that ends the file.
+// Offsets in the "uncompressed" space count bytes of the packet stream, so
+// they can be used to seek straight to a chunk or to the first packet of a
+// frame, which only decompresses the chunk holding it. If a trace was cut
+// short and has no footer, the chunk index is rebuilt by walking the chunk
+// headers and there is no frame index.
+
+#define VKTRACE_COMPRESSED_CHUNK_MAGIC  0x4b484356  // "VCHK"
+#define VKTRACE_COMPRESSED_FOOTER_MAGIC 0x58444956  // "VIDX"
+#define VKTRACE_COMPRESSED_CHUNK_SIZE   (4 * 1024 * 1024)
+
+typedef enum VKTRACE_COMPRESSION
+{
+    VKTRACE_COMPRESSION_NONE = 0,
+    VKTRACE_COMPRESSION_LZ4 = 1
+} VKTRACE_COMPRESSION;
+
+typedef struct {
+    uint32_t magic;                 // VKTRACE_COMPRESSED_CHUNK_MAGIC
+    uint32_t compression;           // VKTRACE_COMPRESSION
+    uint64_t compressed_size;       // size of the data following this header
+    uint64_t uncompressed_size;
+} vktrace_compressed_chunk_header;
+
+typedef struct {
+    uint64_t file_offset;           // of the chunk header
+    uint64_t uncompressed_offset;   // of the first byte of the chunk
+} vktrace_compressed_chunk_entry;
+
+typedef struct {
+    uint64_t uncompressed_offset;   // of the first packet after the end of the frame
+    uint64_t global_packet_index;   // of the packet that ended the frame
+} vktrace_compressed_frame_entry;
+
+typedef struct {
+    uint64_t chunk_count;
+    uint64_t frame_count;
+    uint64_t index_offset;          // file offset of the first vktrace_compressed_chunk_entry
+    uint32_t magic;                 // VKTRACE_COMPRESSED_FOOTER_MAGIC
+    uint32_t reserved;
+} vktrace_compressed_file_footer;
+
+typedef struct vktrace_compressed_file vktrace_compressed_file;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//=============================================================================
+// LZ4 block format codec
+
+// largest size vktrace_lz4_compress can produce for srcSize bytes
+size_t vktrace_lz4_compress_bound(size_t srcSize);
+
+// Returns the compressed size, or 0 if the result does not fit in dstCapacity.
+size_t vktrace_lz4_compress(const uint8_t* pSrc, size_t srcSize, uint8_t* pDst, size_t dstCapacity);
+
+// Returns the decompressed size, or 0 if the input is malformed or does not fit in dstCapacity.
+size_t vktrace_lz4_decompress(const uint8_t* pSrc, size_t srcSize, uint8_t* pDst, size_t dstCapacity);
+
+//=============================================================================
+// Chunked trace file
+// The FILE is owned by the caller and is not closed by vktrace_compressed_file_close.
+
+// starts writing chunks at the current position of pFile
+vktrace_compressed_file* vktrace_compressed_file_create(FILE* pFile);
+
+// opens a trace whose first chunk is at firstChunkOffset for reading
+vktrace_compressed_file* vktrace_compressed_file_open(FILE* pFile, uint64_t firstChunkOffset);
+
+// writes out buffered data and, for files being written, the index and footer
+BOOL vktrace_compressed_file_close(vktrace_compressed_file** ppFile);
+
+BOOL vktrace_compressed_file_write(vktrace_compressed_file* pFile, const void* pBytes, size_t size);
+
+// records that the data written so far ends a frame
+void vktrace_compressed_file_mark_frame_end(vktrace_compressed_file* pFile, uint64_t globalPacketIndex);
+
+BOOL vktrace_compressed_file_read(vktrace_compressed_file* pFile, void* pBytes, size_t size);
+
+// position in the uncompressed packet stream
+uint64_t vktrace_compressed_file_tell(vktrace_compressed_file* pFile);
+BOOL vktrace_compressed_file_seek(vktrace_compressed_file* pFile, uint64_t uncompressedOffset);
+
+// length of the uncompressed packet stream, or 0 if it cannot be determined
+uint64_t vktrace_compressed_file_get_size(vktrace_compressed_file* pFile);
+
+// number of complete frames in the frame index
+uint64_t vktrace_compressed_file_get_frame_count(vktrace_compressed_file* pFile);
+
+// gets the position of the first packet of frame (0 based), for vktrace_compressed_file_seek
+BOOL vktrace_compressed_file_get_frame_offset(vktrace_compressed_file* pFile, uint64_t frame, uint64_t* pUncompressedOffset);
+
+#ifdef __cplusplus
+}
+#endif
@@ -22,6 +22,7 @@
 #include "vktrace_filelike.h"
 #include "vktrace_common.h"
 #include "vktrace_interconnect.h"
+#include "vktrace_compressed_file.h"
 #include <assert.h>
 #include <stdlib.h>
 
@@ -75,6 +76,7 @@ FileLike* vktrace_FileLike_create_file(FILE* fp)
         pFile->mMode = File;
         pFile->mFile = fp;
         pFile->mMessageStream = NULL;
+        pFile->mCompressedFile = NULL;
     }
     return pFile;
 }
@@ -89,6 +91,22 @@ FileLike* vktrace_FileLike_create_msg(MessageStream* _msgStream)
         pFile->mMode = Socket;
         pFile->mFile = NULL;
         pFile->mMessageStream = _msgStream;
+        pFile->mCompressedFile = NULL;
+    }
+    return pFile;
+}
+
+// ------------------------------------------------------------------------------------------------
+FileLike* vktrace_FileLike_create_compressed_file(vktrace_compressed_file* pCompressedFile)
+{
+    FileLike* pFile = NULL;
+    if (pCompressedFile != NULL)
+    {
+        pFile = VKTRACE_NEW(FileLike);
+        pFile->mMode = CompressedFile;
+        pFile->mFile = NULL;
+        pFile->mMessageStream = NULL;
+        pFile->mCompressedFile = pCompressedFile;
     }
     return pFile;
 }
@@ -115,7 +133,7 @@ size_t vktrace_FileLike_Read(FileLike* pFileLike, void* _bytes, size_t _len)
 BOOL vktrace_FileLike_ReadRaw(FileLike* pFileLike, void* _bytes, size_t _len)
 {
     BOOL result = TRUE;
-    assert((pFileLike->mFile != 0) ^ (pFileLike->mMessageStream != 0));
+    assert((pFileLike->mFile != 0) + (pFileLike->mMessageStream != 0) + (pFileLike->mCompressedFile != 0) == 1);
 
     switch(pFileLike->mMode) {
     case File:
@@ -139,6 +157,11 @@ BOOL vktrace_FileLike_ReadRaw(FileLike* pFileLike, void* _bytes, size_t _len)
             result = vktrace_MessageStream_BlockingRecv(pFileLike->mMessageStream, _bytes, _len);
             break;
         }
+    case CompressedFile:
+        {
+            result = vktrace_compressed_file_read(pFileLike->mCompressedFile, _bytes, _len);
+            break;
+        }
 
         default: 
             assert(!"Invalid mode in FileLike_ReadRaw");
@@ -159,7 +182,7 @@ void vktrace_FileLike_Write(FileLike* pFileLike, const void* _bytes, size_t _len
 BOOL vktrace_FileLike_WriteRaw(FileLike* pFile, const void* _bytes, size_t _len)
 {
     BOOL result = TRUE;
-    assert((pFile->mFile != 0) ^ (pFile->mMessageStream != 0));
+    assert((pFile->mFile != 0) + (pFile->mMessageStream != 0) + (pFile->mCompressedFile != 0) == 1);
     switch (pFile->mMode)
     {
         case File:
@@ -171,6 +194,9 @@ BOOL vktrace_FileLike_WriteRaw(FileLike* pFile, const void* _bytes, size_t _len)
         case Socket:
             result = vktrace_MessageStream_Send(pFile->mMessageStream, _bytes, _len);
             break;
+        case CompressedFile:
+            result = vktrace_compressed_file_write(pFile->mCompressedFile, _bytes, _len);
+            break;
         default:
             assert(!"Invalid mode in FileLike_WriteRaw");
             result = FALSE;
@@ -178,3 +204,41 @@ BOOL vktrace_FileLike_WriteRaw(FileLike* pFile, const void* _bytes, size_t _len)
     }
     return result;
 }
+
+// ------------------------------------------------------------------------------------------------
+uint64_t vktrace_FileLike_Tell(FileLike* pFileLike)
+{
+    switch (pFileLike->mMode)
+    {
+        case File:
+#if defined(WIN32)
+            return (uint64_t)_ftelli64(pFileLike->mFile);
+#else
+            return (uint64_t)ftello(pFileLike->mFile);
+#endif
+        case CompressedFile:
+            return vktrace_compressed_file_tell(pFileLike->mCompressedFile);
+        default:
+            assert(!"Invalid mode in FileLike_Tell");
+            return 0;
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+BOOL vktrace_FileLike_Seek(FileLike* pFileLike, uint64_t _offset)
+{
+    switch (pFileLike->mMode)
+    {
+        case File:
+#if defined(WIN32)
+            return _fseeki64(pFileLike->mFile, (__int64)_offset, SEEK_SET) == 0;
+#else
+            return fseeko(pFileLike->mFile, (off_t)_offset, SEEK_SET) == 0;
+#endif
+        case CompressedFile:
+            return vktrace_compressed_file_seek(pFileLike->mCompressedFile, _offset);
+        default:
+            assert(!"Invalid mode in FileLike_Seek");
+            return FALSE;
+    }
+}
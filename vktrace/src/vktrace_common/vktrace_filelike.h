@@ -31,14 +31,16 @@
 #include "vktrace_interconnect.h"
 
 typedef struct MessageStream MessageStream;
+typedef struct vktrace_compressed_file vktrace_compressed_file;
 
 struct FileLike;
 typedef struct FileLike FileLike;
 typedef struct FileLike
 {
-    enum { File, Socket } mMode;
+    enum { File, Socket, CompressedFile } mMode;
     FILE* mFile;
     MessageStream* mMessageStream;
+    vktrace_compressed_file* mCompressedFile;
 } FileLike;
 
 // For creating checkpoints (consistency checks) in the various streams we're interacting with.
@@ -57,8 +59,8 @@ void vktrace_Checkpoint_write(Checkpoint* pCheckpoint, FileLike* _out);
 BOOL vktrace_Checkpoint_read(Checkpoint* pCheckpoint, FileLike* _in);
 
 // An interface for interacting with sockets, files, and memory streams with a file-like interface.
-// This is a simple file-like interface--it doesn't support rewinding or anything fancy, just fifo 
-// reads and writes.
+// This is a simple file-like interface--it doesn't support anything fancy, just fifo reads and
+// writes, plus Tell and Seek for files.
 
 // create a filelike interface for file streaming
 FileLike* vktrace_FileLike_create_file(FILE* fp);
@@ -66,6 +68,9 @@ FileLike* vktrace_FileLike_create_file(FILE* fp);
 // create a filelike interface for network streaming
 FileLike* vktrace_FileLike_create_msg(MessageStream* _msgStream);
 
+// create a filelike interface for the packet stream of a compressed trace file
+FileLike* vktrace_FileLike_create_compressed_file(vktrace_compressed_file* pCompressedFile);
+
 // read a size and then a buffer of that size
 size_t vktrace_FileLike_Read(FileLike* pFileLike, void* _bytes, size_t _len);
 
@@ -80,6 +85,10 @@ void vktrace_FileLike_Write(FileLike* pFileLike, const void* _bytes, size_t _len
 // no size parameter first.
 BOOL vktrace_FileLike_WriteRaw(FileLike* pFile, const void* _bytes, size_t _len);
 
+// Position in the stream, for returning to it later with Seek. Not supported for sockets.
+uint64_t vktrace_FileLike_Tell(FileLike* pFileLike);
+BOOL vktrace_FileLike_Seek(FileLike* pFileLike, uint64_t _offset);
+
 #ifdef __cplusplus
 }
 #endif
@@ -130,6 +130,11 @@ void vktrace_process_info_delete(vktrace_process_info* pInfo)
     VKTRACE_DELETE(pInfo->fullProcessCmdLine);
     VKTRACE_DELETE(pInfo->exeName);
 
+    if (pInfo->pCompressedTraceFile != NULL)
+    {
+        vktrace_compressed_file_close(&pInfo->pCompressedTraceFile);
+    }
+
     if (pInfo->pTraceFile != NULL)
     {
         fclose(pInfo->pTraceFile);
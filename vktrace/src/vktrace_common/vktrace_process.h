@@ -23,6 +23,7 @@
 
 #include "vktrace_platform.h"
 #include "vktrace_trace_packet_identifiers.h"
+#include "vktrace_compressed_file.h"
 
 typedef struct vktrace_process_capture_trace_thread_info vktrace_process_capture_trace_thread_info;
 
@@ -35,6 +36,10 @@ typedef struct vktrace_process_info
     char* traceFilename;
     FILE* pTraceFile;
 
+    // packets are written through pCompressedTraceFile when compressTrace is set
+    BOOL compressTrace;
+    vktrace_compressed_file* pCompressedTraceFile;
+
     // vktrace's thread id
     vktrace_thread_id parentThreadId;
 
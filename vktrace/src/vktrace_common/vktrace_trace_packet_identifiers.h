@@ -25,6 +25,7 @@
 
 #define VKTRACE_TRACE_FILE_VERSION_2 0x0002
 #define VKTRACE_TRACE_FILE_VERSION_3 0x0003
+#define VKTRACE_TRACE_FILE_VERSION_4 0x0004 // version 3 packets stored in compressed chunks, see vktrace_compressed_file.h
 #define VKTRACE_TRACE_FILE_VERSION VKTRACE_TRACE_FILE_VERSION_3
 #define VKTRACE_TRACE_FILE_VERSION_MINIMUM_COMPATIBLE VKTRACE_TRACE_FILE_VERSION_3
 
@@ -68,7 +69,7 @@ typedef enum _VKTRACE_TRACE_PACKET_ID
 {
     VKTRACE_TPI_MESSAGE,
     VKTRACE_TPI_MARKER_CHECKPOINT,
-    VKTRACE_TPI_MARKER_API_BOUNDARY,
+    VKTRACE_TPI_MARKER_API_BOUNDARY, // written by the Vulkan tracer after each vkQueuePresentKHR to end a frame
     VKTRACE_TPI_MARKER_API_GROUP_BEGIN,
     VKTRACE_TPI_MARKER_API_GROUP_END,
     VKTRACE_TPI_MARKER_TERMINATE_PROCESS,
@@ -201,10 +201,242 @@ void vktrace_finalize_trace_packet(vktrace_trace_packet_header* pHeader)
     pHeader->vktrace_end_time = vktrace_get_time();
 }
 
+//=============================================================================
+// Asynchronous packet writer
+
+typedef struct AsyncTraceWriter
+{
+    FileLike* pFile;
+    VKTRACE_CRITICAL_SECTION lock;
+    vktrace_thread thread;
+    uint8_t* pBuffers[2];
+    size_t bufferUsed[2];
+    size_t bufferSize;
+    uint32_t fillIndex;         // buffer that packets are appended into
+    BOOL writing;               // the other buffer is owned by the writer thread
+    BOOL quit;
+    BOOL stopped;               // writer thread has flushed and exited; packets are written directly
+    BOOL failed;                // a write failed; all further packets are dropped
+} AsyncTraceWriter;
+
+static AsyncTraceWriter* g_pAsyncWriter = NULL;
+
+// Hands the fill buffer to the writer thread. Must be called with the lock held and the writer idle.
+static void async_writer_swap_buffers(AsyncTraceWriter* pWriter)
+{
+    assert(!pWriter->writing);
+    pWriter->fillIndex ^= 1;
+    pWriter->writing = TRUE;
+}
+
+// Latches the failed state and discards anything still queued. Must be called with the lock held.
+// Returns TRUE for the first failure only, so the caller reports it once. The error message is itself
+// a trace packet, and it is dropped like every other packet from here on, so it cannot re-enter the writer.
+static BOOL async_writer_fail(AsyncTraceWriter* pWriter)
+{
+    BOOL first = !pWriter->failed;
+    pWriter->failed = TRUE;
+    pWriter->bufferUsed[0] = 0;
+    pWriter->bufferUsed[1] = 0;
+    pWriter->writing = FALSE;
+    return first;
+}
+
+// Writes out the in-flight buffer and then the fill buffer. Must be called with the lock held.
+static BOOL async_writer_flush_locked(AsyncTraceWriter* pWriter)
+{
+    BOOL res = TRUE;
+    uint32_t writeIndex = pWriter->fillIndex ^ 1;
+    if (pWriter->writing && pWriter->bufferUsed[writeIndex] > 0)
+    {
+        res = vktrace_FileLike_WriteRaw(pWriter->pFile, pWriter->pBuffers[writeIndex], pWriter->bufferUsed[writeIndex]);
+    }
+    if (res && pWriter->bufferUsed[pWriter->fillIndex] > 0)
+    {
+        res = vktrace_FileLike_WriteRaw(pWriter->pFile, pWriter->pBuffers[pWriter->fillIndex], pWriter->bufferUsed[pWriter->fillIndex]);
+    }
+    pWriter->bufferUsed[0] = 0;
+    pWriter->bufferUsed[1] = 0;
+    pWriter->writing = FALSE;
+    return res;
+}
+
+static VKTRACE_THREAD_ROUTINE_RETURN_TYPE async_writer_thread(LPVOID args)
+{
+    AsyncTraceWriter* pWriter = (AsyncTraceWriter*)args;
+    uint32_t writeIndex;
+    size_t writeSize;
+    BOOL haveWork;
+    BOOL res;
+    BOOL report;
+    for (;;)
+    {
+        vktrace_enter_critical_section(&pWriter->lock);
+        if (pWriter->failed)
+        {
+            vktrace_leave_critical_section(&pWriter->lock);
+            break;
+        }
+        if (pWriter->quit)
+        {
+            // Flush whatever is queued right now and stop, even if other threads keep appending;
+            // from here on they write their packets directly.
+            res = async_writer_flush_locked(pWriter);
+            pWriter->stopped = TRUE;
+            report = !res && async_writer_fail(pWriter);
+            vktrace_leave_critical_section(&pWriter->lock);
+            if (report)
+            {
+                vktrace_LogError("Failed to write buffered trace packets; dropping further packets.");
+            }
+            break;
+        }
+        if (!pWriter->writing && pWriter->bufferUsed[pWriter->fillIndex] > 0)
+        {
+            async_writer_swap_buffers(pWriter);
+        }
+        haveWork = pWriter->writing;
+        writeIndex = pWriter->fillIndex ^ 1;
+        writeSize = pWriter->bufferUsed[writeIndex];
+        vktrace_leave_critical_section(&pWriter->lock);
+
+        if (!haveWork)
+        {
+            Sleep(1);
+            continue;
+        }
+
+        res = vktrace_FileLike_WriteRaw(pWriter->pFile, pWriter->pBuffers[writeIndex], writeSize);
+
+        vktrace_enter_critical_section(&pWriter->lock);
+        pWriter->bufferUsed[writeIndex] = 0;
+        pWriter->writing = FALSE;
+        report = !res && async_writer_fail(pWriter);
+        vktrace_leave_critical_section(&pWriter->lock);
+
+        // Logging queues a message packet, so only do it once the lock has been released.
+        if (report)
+        {
+            vktrace_LogError("Failed to write %u bytes of buffered trace packets; dropping further packets.", writeSize);
+        }
+    }
+    return 0;
+}
+
+static void async_writer_append(AsyncTraceWriter* pWriter, const vktrace_trace_packet_header* pHeader)
+{
+    size_t size = (size_t)pHeader->size;
+    BOOL res = TRUE;
+    BOOL report = FALSE;
+    vktrace_enter_critical_section(&pWriter->lock);
+    while (!pWriter->failed && !pWriter->stopped &&
+           pWriter->bufferUsed[pWriter->fillIndex] + size > pWriter->bufferSize &&
+           (pWriter->writing || pWriter->bufferUsed[pWriter->fillIndex] > 0))
+    {
+        if (!pWriter->writing)
+        {
+            async_writer_swap_buffers(pWriter);
+        }
+        else
+        {
+            // Both buffers are busy; wait for the writer thread to catch up.
+            vktrace_leave_critical_section(&pWriter->lock);
+            Sleep(0);
+            vktrace_enter_critical_section(&pWriter->lock);
+        }
+    }
+
+    if (pWriter->failed)
+    {
+        // Already reported; drop the packet.
+    }
+    else if (pWriter->stopped || size > pWriter->bufferSize)
+    {
+        // Everything queued before this packet has been written, so it can go
+        // straight out while holding the lock without breaking the packet order.
+        res = vktrace_FileLike_WriteRaw(pWriter->pFile, pHeader, size);
+        report = !res && pHeader->packet_id != VKTRACE_TPI_MARKER_TERMINATE_PROCESS && async_writer_fail(pWriter);
+    }
+    else
+    {
+        memcpy(pWriter->pBuffers[pWriter->fillIndex] + pWriter->bufferUsed[pWriter->fillIndex], pHeader, size);
+        pWriter->bufferUsed[pWriter->fillIndex] += size;
+    }
+    vktrace_leave_critical_section(&pWriter->lock);
+
+    if (report)
+    {
+        vktrace_LogError("Failed to send trace packet index %u packetId %u size %u; dropping further packets.", pHeader->global_packet_index, pHeader->packet_id, pHeader->size);
+    }
+}
+
+BOOL vktrace_enable_async_trace_writer(FileLike* pFile, size_t bufferSize)
+{
+    AsyncTraceWriter* pWriter;
+    assert(g_pAsyncWriter == NULL);
+    if (pFile == NULL || bufferSize == 0)
+        return FALSE;
+
+    pWriter = VKTRACE_NEW(AsyncTraceWriter);
+    memset(pWriter, 0, sizeof(AsyncTraceWriter));
+    pWriter->pFile = pFile;
+    pWriter->bufferSize = bufferSize;
+    pWriter->pBuffers[0] = (uint8_t*)vktrace_malloc(bufferSize);
+    pWriter->pBuffers[1] = (uint8_t*)vktrace_malloc(bufferSize);
+    if (pWriter->pBuffers[0] == NULL || pWriter->pBuffers[1] == NULL)
+    {
+        vktrace_LogError("Failed to allocate %u bytes for asynchronous trace writer.", bufferSize);
+        vktrace_free(pWriter->pBuffers[0]);
+        vktrace_free(pWriter->pBuffers[1]);
+        VKTRACE_DELETE(pWriter);
+        return FALSE;
+    }
+    vktrace_create_critical_section(&pWriter->lock);
+
+    pWriter->thread = vktrace_platform_create_thread(async_writer_thread, pWriter);
+    if (pWriter->thread == VKTRACE_NULL_THREAD)
+    {
+        vktrace_delete_critical_section(&pWriter->lock);
+        vktrace_free(pWriter->pBuffers[0]);
+        vktrace_free(pWriter->pBuffers[1]);
+        VKTRACE_DELETE(pWriter);
+        return FALSE;
+    }
+
+    g_pAsyncWriter = pWriter;
+    return TRUE;
+}
+
+void vktrace_disable_async_trace_writer()
+{
+    AsyncTraceWriter* pWriter = g_pAsyncWriter;
+    if (pWriter == NULL)
+        return;
+
+    // The writer thread flushes both buffers once it sees the quit flag and then exits.
+    vktrace_enter_critical_section(&pWriter->lock);
+    pWriter->quit = TRUE;
+    vktrace_leave_critical_section(&pWriter->lock);
+    vktrace_platform_sync_wait_for_thread(&pWriter->thread);
+    vktrace_platform_delete_thread(&pWriter->thread);
+    g_pAsyncWriter = NULL;
+
+    vktrace_delete_critical_section(&pWriter->lock);
+    vktrace_free(pWriter->pBuffers[0]);
+    vktrace_free(pWriter->pBuffers[1]);
+    VKTRACE_DELETE(pWriter);
+}
+
 void vktrace_write_trace_packet(const vktrace_trace_packet_header* pHeader, FileLike* pFile)
 {
     static int errorCount = 0;
-    BOOL res = vktrace_FileLike_WriteRaw(pFile, pHeader, (size_t)pHeader->size);
+    BOOL res;
+    if (g_pAsyncWriter != NULL && g_pAsyncWriter->pFile == pFile)
+    {
+        async_writer_append(g_pAsyncWriter, pHeader);
+        return;
+    }
+    res = vktrace_FileLike_WriteRaw(pFile, pHeader, (size_t)pHeader->size);
     if (!res && pHeader->packet_id != VKTRACE_TPI_MARKER_TERMINATE_PROCESS && errorCount < 10)
     {
         errorCount++;
@@ -63,6 +63,10 @@ static FILE* vktrace_write_trace_file_header(vktrace_process_info* pProcInfo)
     pHeader = vktrace_create_trace_file_header();
     pHeader->first_packet_offset = sizeof(vktrace_trace_file_header);
     pHeader->tracer_count = 1;
+    if (pProcInfo->compressTrace)
+    {
+        pHeader->trace_file_version = VKTRACE_TRACE_FILE_VERSION_4;
+    }
 
 
     pHeader->tracer_id_array[0].id = pProcInfo->pCaptureThreads[0].tracerId;
@@ -122,6 +126,19 @@ void vktrace_finalize_trace_packet(vktrace_trace_packet_header* pHeader);
 // This has no knowledge of the details of the packet other than its size.
 void vktrace_write_trace_packet(const vktrace_trace_packet_header* pHeader, FileLike* pFile);
 
+//=============================================================================
+// Asynchronous packet writer
+// While enabled, packets written to pFile are copied into one of two large
+// buffers instead of being written immediately. A background thread writes
+// the other buffer out, so the calling thread only pays for a memcpy.
+// Packets leave in the same order they were handed to vktrace_write_trace_packet.
+
+// starts the writer thread for pFile; bufferSize is the size of each of the two buffers
+BOOL vktrace_enable_async_trace_writer(FileLike* pFile, size_t bufferSize);
+
+// writes out any buffered packets and stops the writer thread
+void vktrace_disable_async_trace_writer();
+
 //=============================================================================
 // Methods for Reading and interpretting trace packets
 
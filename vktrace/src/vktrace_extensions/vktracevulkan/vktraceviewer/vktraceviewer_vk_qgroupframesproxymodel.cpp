@@ -47,8 +47,8 @@ void vktraceviewer_vk_QGroupFramesProxyModel::buildGroups()
                 // If source data is a frame boundary make a new frame
                 QModelIndex tmpIndex = sourceModel()->index(srcRow, 0);
                 assert(tmpIndex.isValid());
-                vktrace_trace_packet_header* pHeader = (vktrace_trace_packet_header*)tmpIndex.internalPointer();
-                if (pHeader != NULL && pHeader->tracer_id == VKTRACE_TID_VULKAN && pHeader->packet_id == VKTRACE_TPI_VK_vkQueuePresentKHR)
+                vktraceviewer_trace_file_packet_offsets* pEntry = (vktraceviewer_trace_file_packet_offsets*)tmpIndex.internalPointer();
+                if (pEntry != NULL && pEntry->tracer_id == VKTRACE_TID_VULKAN && pEntry->packet_id == VKTRACE_TPI_VK_vkQueuePresentKHR)
                 {
                     pCurFrame = addNewFrame();
                 }
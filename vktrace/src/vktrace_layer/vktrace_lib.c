@@ -170,6 +170,7 @@ VKTRACER_LEAVE _Unload(void)
             vktrace_finalize_trace_packet(pHeader);
             vktrace_write_trace_packet(pHeader, vktrace_trace_get_trace_file());
             vktrace_delete_trace_packet(&pHeader);
+            vktrace_disable_async_trace_writer();
             vktrace_free(vktrace_trace_get_trace_file());
             vktrace_trace_set_trace_file(NULL);
         }
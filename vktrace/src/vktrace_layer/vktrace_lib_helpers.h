@@ -35,6 +35,7 @@ typedef struct _VKAllocInfo {
     VkDeviceSize   rangeSize;
     VkDeviceSize   rangeOffset;
     BOOL           didFlush;
+    VkDevice       device;
     VkDeviceMemory handle;
     uint8_t        *pData;
     BOOL           valid;
@@ -68,6 +69,11 @@ extern VKTRACE_CRITICAL_SECTION g_memInfoLock;
 extern std::unordered_map<void *, layer_device_data *> g_deviceDataMap;
 extern std::unordered_map<void *, layer_instance_data *> g_instanceDataMap;
 
+// records the whole of memory in the trace, mapping it for the time of the call
+void trace_memory_contents(VkDevice device, VkDeviceMemory memory);
+// the caller sets the result and end time, then finishes the packet
+vktrace_trace_packet_header* create_queue_submit_packet(VkQueue queue, uint32_t submitCount, const VkSubmitInfo* pSubmits, VkFence fence);
+
 typedef void *dispatch_key;
 inline dispatch_key get_dispatch_key(const void* object)
 {
@@ -88,6 +94,7 @@ static void init_mem_info_entrys(VKAllocInfo *ptr, const unsigned int num)
         entry->rangeSize = 0;
         entry->rangeOffset = 0;
         entry->didFlush = FALSE;
+        entry->device = VK_NULL_HANDLE;
         memset(&entry->handle, 0, sizeof(VkDeviceMemory));
         entry->valid = FALSE;
     }
@@ -183,7 +190,7 @@ static VKAllocInfo * find_mem_info_entry_lock(const VkDeviceMemory handle)
     return res;
 }
 
-static void add_new_handle_to_mem_info(const VkDeviceMemory handle, VkDeviceSize size, void *pData)
+static void add_new_handle_to_mem_info(VkDevice device, const VkDeviceMemory handle, VkDeviceSize size, void *pData)
 {
     VKAllocInfo *entry;
 
@@ -195,6 +202,7 @@ static void add_new_handle_to_mem_info(const VkDeviceMemory handle, VkDeviceSize
     if (entry)
     {
         entry->valid = TRUE;
+        entry->device = device;
         entry->handle = handle;
         entry->totalSize = size;
         entry->rangeSize = 0;
@@ -239,6 +247,7 @@ static void rm_handle_from_mem_info(const VkDeviceMemory handle)
         entry->rangeSize = 0;
         entry->rangeOffset = 0;
         entry->didFlush = FALSE;
+        entry->device = VK_NULL_HANDLE;
         memset(&entry->handle, 0, sizeof(VkDeviceMemory));
 
         if (entry == g_memInfo.pLastMapped)
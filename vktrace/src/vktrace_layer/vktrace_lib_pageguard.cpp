@@ -0,0 +1,351 @@
+/*
+ *
+ * Copyright (C) 2016 Valve Corporation
+ * Copyright (C) 2016 LunarG, Inc.
+ * All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "vktrace_lib_pageguard.h"
+#include "vktrace_platform.h"
+#include "vktrace_common.h"
+#include "vktrace_tracelog.h"
+
+#if defined(PLATFORM_LINUX)
+#include <atomic>
+#include <new>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+// The fault handler runs in signal context, where it must not take locks or allocate. It only reads
+// these slots and sets bits in their dirty bitmaps, so both must be lock-free atomics.
+static_assert(ATOMIC_POINTER_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2, "page guards need lock-free atomics");
+
+#define PAGEGUARD_MAX_MAPPINGS 1024
+
+// What the fault handler sees of a guarded mapping. A slot is in use while pGuardStart is not NULL.
+typedef struct _PageGuardSlot {
+    std::atomic<uint8_t *>               pGuardStart;    // first whole page of the mapping
+    std::atomic<size_t>                  guardPageCount;
+    std::atomic<std::atomic<uint32_t> *> pDirty;         // one bit per guarded page, set by the fault handler
+    std::atomic<uint32_t>                handlerCount;   // fault handlers reading the slot
+} PageGuardSlot;
+
+typedef struct _PageGuardMapping {
+    VkDevice       device;
+    VkDeviceMemory memory;
+    VkDeviceSize   offset;          // offset of pData in the VkDeviceMemory
+    VkDeviceSize   size;
+    uint8_t        *pData;
+    uint8_t        *pGuardStart;    // first whole page of the mapping
+    size_t         guardPageCount;
+    PageGuardSlot  *pSlot;
+} PageGuardMapping;
+
+// Bookkeeping outside signal context, including claiming and releasing slots, is done under g_pageGuardLock
+static std::vector<PageGuardMapping> g_pageGuardMappings;
+static PageGuardSlot g_pageGuardSlots[PAGEGUARD_MAX_MAPPINGS];
+static VKTRACE_CRITICAL_SECTION g_pageGuardLock;
+static pthread_once_t g_pageGuardInitOnce = PTHREAD_ONCE_INIT;
+static struct sigaction g_prevSigsegvAction;
+static size_t g_pageSize = 0;
+static bool g_pageGuardEnabled = false;
+
+static void pageguard_sigsegv_handler(int signum, siginfo_t *info, void *context)
+{
+    uint8_t *pAddr = (uint8_t *) info->si_addr;
+    bool handled = false;
+
+    // Only atomics and mprotect() are used here, both of which are safe in a signal handler. The
+    // handler count keeps pageguard_remove_mapping() from freeing the bitmap while it is read.
+    for (size_t i = 0; i < PAGEGUARD_MAX_MAPPINGS && !handled; i++)
+    {
+        PageGuardSlot &slot = g_pageGuardSlots[i];
+        uint8_t *pGuardStart = slot.pGuardStart.load(std::memory_order_relaxed);
+        if (pGuardStart == NULL || pAddr < pGuardStart)
+            continue;
+        slot.handlerCount.fetch_add(1, std::memory_order_seq_cst);
+        pGuardStart = slot.pGuardStart.load(std::memory_order_seq_cst);
+        size_t guardPageCount = slot.guardPageCount.load(std::memory_order_relaxed);
+        if (pGuardStart != NULL && pAddr >= pGuardStart && pAddr < pGuardStart + guardPageCount * g_pageSize)
+        {
+            size_t page = (size_t)(pAddr - pGuardStart) / g_pageSize;
+            slot.pDirty.load(std::memory_order_relaxed)[page / 32].fetch_or(1u << (page % 32), std::memory_order_relaxed);
+            mprotect(pGuardStart + page * g_pageSize, g_pageSize, PROT_READ | PROT_WRITE);
+            handled = true;
+        }
+        slot.handlerCount.fetch_sub(1, std::memory_order_release);
+    }
+
+    if (handled)
+        return;
+
+    // Not a guarded page, give the fault to whoever was handling it before us.
+    if (g_prevSigsegvAction.sa_flags & SA_SIGINFO)
+    {
+        g_prevSigsegvAction.sa_sigaction(signum, info, context);
+    }
+    else if (g_prevSigsegvAction.sa_handler == SIG_DFL || g_prevSigsegvAction.sa_handler == SIG_IGN)
+    {
+        // the faulting instruction runs again and now gets the default action
+        sigaction(SIGSEGV, &g_prevSigsegvAction, NULL);
+    }
+    else
+    {
+        g_prevSigsegvAction.sa_handler(signum);
+    }
+}
+
+static void pageguard_init()
+{
+    struct sigaction act;
+    const char *env = vktrace_get_global_var("VKTRACE_PAGEGUARD");
+    if (env == NULL || atoi(env) == 0)
+        return;
+
+    g_pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    vktrace_create_critical_section(&g_pageGuardLock);
+
+    memset(&act, 0, sizeof(act));
+    act.sa_sigaction = pageguard_sigsegv_handler;
+    act.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&act.sa_mask);
+    if (sigaction(SIGSEGV, &act, &g_prevSigsegvAction) != 0)
+    {
+        vktrace_LogError("Failed to install SIGSEGV handler, page guard capture of mapped memory is disabled.");
+        vktrace_delete_critical_section(&g_pageGuardLock);
+        return;
+    }
+    g_pageGuardEnabled = true;
+    vktrace_LogVerbose("Page guard capture of mapped memory enabled.");
+}
+
+// caller must hold the g_pageGuardLock
+static PageGuardMapping *find_mapping(VkDeviceMemory memory)
+{
+    for (size_t i = 0; i < g_pageGuardMappings.size(); i++)
+    {
+        if (g_pageGuardMappings[i].memory == memory)
+            return &g_pageGuardMappings[i];
+    }
+    return NULL;
+}
+
+// Appends [pStart, pEnd) of the mapping, merging it into the previous range when they touch.
+static void append_range(std::vector<PageGuardRange> &ranges, const PageGuardMapping &mapping, const uint8_t *pStart, const uint8_t *pEnd)
+{
+    if (pStart >= pEnd)
+        return;
+    if (!ranges.empty())
+    {
+        PageGuardRange &last = ranges.back();
+        if (last.memory == mapping.memory && last.pData + last.size == pStart)
+        {
+            last.size += (VkDeviceSize)(pEnd - pStart);
+            return;
+        }
+    }
+    PageGuardRange range;
+    range.device = mapping.device;
+    range.memory = mapping.memory;
+    range.offset = mapping.offset + (VkDeviceSize)(pStart - mapping.pData);
+    range.size = (VkDeviceSize)(pEnd - pStart);
+    range.pData = pStart;
+    ranges.push_back(range);
+}
+
+// caller must hold the g_pageGuardLock
+static void collect_dirty_ranges(PageGuardMapping &mapping, VkDeviceSize offset, VkDeviceSize size, std::vector<PageGuardRange> &ranges)
+{
+    VkDeviceSize start = (offset > mapping.offset) ? offset : mapping.offset;
+    VkDeviceSize end = (size == VK_WHOLE_SIZE || offset + size > mapping.offset + mapping.size) ? mapping.offset + mapping.size : offset + size;
+    if (start >= end)
+        return;
+
+    const uint8_t *pLo = mapping.pData + (start - mapping.offset);
+    const uint8_t *pHi = mapping.pData + (end - mapping.offset);
+    const uint8_t *pGuardEnd = mapping.pGuardStart + mapping.guardPageCount * g_pageSize;
+
+    // partial page at the start of the mapping
+    append_range(ranges, mapping, pLo, (pHi < mapping.pGuardStart) ? pHi : mapping.pGuardStart);
+
+    for (size_t page = 0; page < mapping.guardPageCount; page++)
+    {
+        uint8_t *pPage = mapping.pGuardStart + page * g_pageSize;
+        const uint8_t *pPageEnd = pPage + g_pageSize;
+        std::atomic<uint32_t> &dirtyWord = mapping.pSlot->pDirty.load(std::memory_order_relaxed)[page / 32];
+        uint32_t dirtyBit = 1u << (page % 32);
+        if (!(dirtyWord.load(std::memory_order_relaxed) & dirtyBit) || pPageEnd <= pLo || pPage >= pHi)
+            continue;
+
+        append_range(ranges, mapping, (pPage > pLo) ? pPage : pLo, (pPageEnd < pHi) ? pPageEnd : pHi);
+
+        // Only pages that are entirely recorded can be protected again; writes
+        // to the rest of a partly recorded page have not been captured yet.
+        if (pPage >= pLo && pPageEnd <= pHi)
+        {
+            dirtyWord.fetch_and(~dirtyBit, std::memory_order_relaxed);
+            mprotect(pPage, g_pageSize, PROT_READ);
+        }
+    }
+
+    // partial page at the end of the mapping
+    append_range(ranges, mapping, (pLo > pGuardEnd) ? pLo : pGuardEnd, pHi);
+}
+
+bool pageguard_enabled()
+{
+    vktrace_platform_thread_once(&g_pageGuardInitOnce, pageguard_init);
+    return g_pageGuardEnabled;
+}
+
+void pageguard_add_mapping(VkDevice device, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size, void *pData)
+{
+    PageGuardMapping mapping;
+    if (!g_pageGuardEnabled || pData == NULL)
+        return;
+    if (size == VK_WHOLE_SIZE || (uintptr_t)pData + (size_t)size < (uintptr_t)pData)
+    {
+        // end would wrap around and the mapping would never be guarded
+        vktrace_LogError("pageguard_add_mapping() called with unresolved size, capturing the whole mapped range instead.");
+        return;
+    }
+    uintptr_t start = ((uintptr_t)pData + g_pageSize - 1) & ~(uintptr_t)(g_pageSize - 1);
+    uintptr_t end = ((uintptr_t)pData + (size_t)size) & ~(uintptr_t)(g_pageSize - 1);
+    if (end <= start)
+        return;
+
+    mapping.device = device;
+    mapping.memory = memory;
+    mapping.offset = offset;
+    mapping.size = size;
+    mapping.pData = (uint8_t *) pData;
+    mapping.pGuardStart = (uint8_t *) start;
+    mapping.guardPageCount = (end - start) / g_pageSize;
+    std::atomic<uint32_t> *pDirty = new (std::nothrow) std::atomic<uint32_t>[(mapping.guardPageCount + 31) / 32]();
+    if (pDirty == NULL)
+        return;
+
+    vktrace_enter_critical_section(&g_pageGuardLock);
+    mapping.pSlot = NULL;
+    for (size_t i = 0; i < PAGEGUARD_MAX_MAPPINGS; i++)
+    {
+        if (g_pageGuardSlots[i].pGuardStart.load(std::memory_order_relaxed) == NULL)
+        {
+            mapping.pSlot = &g_pageGuardSlots[i];
+            break;
+        }
+    }
+    if (mapping.pSlot == NULL)
+    {
+        vktrace_leave_critical_section(&g_pageGuardLock);
+        vktrace_LogWarning("Too many guarded mappings, capturing the whole mapped range instead.");
+        delete[] pDirty;
+        return;
+    }
+    // Publish the slot before protecting the pages, so that the handler finds it on the first fault
+    mapping.pSlot->pDirty.store(pDirty, std::memory_order_relaxed);
+    mapping.pSlot->guardPageCount.store(mapping.guardPageCount, std::memory_order_relaxed);
+    mapping.pSlot->pGuardStart.store(mapping.pGuardStart, std::memory_order_seq_cst);
+    if (mprotect(mapping.pGuardStart, mapping.guardPageCount * g_pageSize, PROT_READ) != 0)
+    {
+        // leave the mapping untracked; its whole range is captured the usual way
+        mapping.pSlot->pGuardStart.store(NULL, std::memory_order_seq_cst);
+        vktrace_leave_critical_section(&g_pageGuardLock);
+        vktrace_LogWarning("Unable to write protect mapped memory, capturing the whole mapped range instead.");
+        delete[] pDirty;
+        return;
+    }
+    g_pageGuardMappings.push_back(mapping);
+    vktrace_leave_critical_section(&g_pageGuardLock);
+}
+
+void pageguard_remove_mapping(VkDeviceMemory memory)
+{
+    if (!g_pageGuardEnabled)
+        return;
+
+    vktrace_enter_critical_section(&g_pageGuardLock);
+    for (size_t i = 0; i < g_pageGuardMappings.size(); i++)
+    {
+        PageGuardMapping &mapping = g_pageGuardMappings[i];
+        if (mapping.memory == memory)
+        {
+            mprotect(mapping.pGuardStart, mapping.guardPageCount * g_pageSize, PROT_READ | PROT_WRITE);
+            // Retire the slot, then wait for handlers on other threads that may still read its bitmap
+            mapping.pSlot->pGuardStart.store(NULL, std::memory_order_seq_cst);
+            while (mapping.pSlot->handlerCount.load(std::memory_order_seq_cst) != 0)
+                sched_yield();
+            delete[] mapping.pSlot->pDirty.load(std::memory_order_relaxed);
+            mapping.pSlot->pDirty.store(NULL, std::memory_order_relaxed);
+            g_pageGuardMappings.erase(g_pageGuardMappings.begin() + i);
+            break;
+        }
+    }
+    vktrace_leave_critical_section(&g_pageGuardLock);
+}
+
+bool pageguard_collect_dirty_ranges(VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size, std::vector<PageGuardRange> &ranges)
+{
+    PageGuardMapping *pMapping;
+    if (!g_pageGuardEnabled)
+        return false;
+
+    vktrace_enter_critical_section(&g_pageGuardLock);
+    pMapping = find_mapping(memory);
+    if (pMapping != NULL)
+        collect_dirty_ranges(*pMapping, offset, size, ranges);
+    vktrace_leave_critical_section(&g_pageGuardLock);
+    return pMapping != NULL;
+}
+
+void pageguard_collect_all_dirty_ranges(std::vector<PageGuardRange> &ranges)
+{
+    if (!g_pageGuardEnabled)
+        return;
+
+    vktrace_enter_critical_section(&g_pageGuardLock);
+    for (size_t i = 0; i < g_pageGuardMappings.size(); i++)
+    {
+        collect_dirty_ranges(g_pageGuardMappings[i], 0, VK_WHOLE_SIZE, ranges);
+    }
+    vktrace_leave_critical_section(&g_pageGuardLock);
+}
+
+#else // PLATFORM_LINUX
+
+// page guards are only implemented on Linux; elsewhere no mapping is tracked
+bool pageguard_enabled()
+{
+    return false;
+}
+
+void pageguard_add_mapping(VkDevice device, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size, void *pData)
+{
+}
+
+void pageguard_remove_mapping(VkDeviceMemory memory)
+{
+}
+
+bool pageguard_collect_dirty_ranges(VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size, std::vector<PageGuardRange> &ranges)
+{
+    return false;
+}
+
+void pageguard_collect_all_dirty_ranges(std::vector<PageGuardRange> &ranges)
+{
+}
+
+#endif // PLATFORM_LINUX
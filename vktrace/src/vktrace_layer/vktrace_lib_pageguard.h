@@ -0,0 +1,54 @@
+/*
+ *
+ * Copyright (C) 2016 Valve Corporation
+ * Copyright (C) 2016 LunarG, Inc.
+ * All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <vector>
+#include "vulkan/vulkan.h"
+
+// Page guard tracking of CPU mapped memory, enabled by setting VKTRACE_PAGEGUARD=1.
+// While memory is mapped, the whole pages of the mapping are write protected. The
+// first write to a page faults; the fault handler marks the page dirty and makes it
+// writable again. Flush, submit and unmap then only need to copy dirty pages into
+// the trace instead of the whole mapped range.
+// Partial pages at either end of a mapping are never protected and are always
+// treated as dirty.
+
+typedef struct _PageGuardRange {
+    VkDevice       device;
+    VkDeviceMemory memory;
+    VkDeviceSize   offset;      // from the start of the VkDeviceMemory
+    VkDeviceSize   size;
+    const uint8_t  *pData;      // CPU address of the data at offset
+} PageGuardRange;
+
+// true if VKTRACE_PAGEGUARD is set and page guards are supported on this platform
+bool pageguard_enabled();
+
+// starts tracking writes to a new mapping of memory; size must not be VK_WHOLE_SIZE
+void pageguard_add_mapping(VkDevice device, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size, void *pData);
+
+// stops tracking memory and removes the write protection; must be called before the memory is unmapped
+void pageguard_remove_mapping(VkDeviceMemory memory);
+
+// Appends the dirty parts of [offset, offset + size) of memory to ranges and write protects those pages again.
+// Returns false if memory is not tracked, in which case nothing is appended.
+bool pageguard_collect_dirty_ranges(VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size, std::vector<PageGuardRange> &ranges);
+
+// same as pageguard_collect_dirty_ranges, for every tracked mapping
+void pageguard_collect_all_dirty_ranges(std::vector<PageGuardRange> &ranges);
@@ -29,6 +29,8 @@
 #include "vk_dispatch_table_helper.h"
 #include "vktrace_common.h"
 #include "vktrace_lib_helpers.h"
+#include "vktrace_lib_pageguard.h"
+#include "vktrace_lib_trigger.h"
 
 #include "vktrace_interconnect.h"
 #include "vktrace_filelike.h"
@@ -129,6 +131,144 @@ void *strip_create_extensions(const void *pNext)
     return create_info;
 }
 
+// Creates a vkFlushMappedMemoryRanges packet that records the given ranges and the mapped data in them.
+// The caller fills in the result and finishes the packet.
+// caller must hold the g_memInfoLock
+static vktrace_trace_packet_header* create_flush_mapped_memory_ranges_packet(VkDevice device, const PageGuardRange* pRanges, uint32_t rangeCount)
+{
+    vktrace_trace_packet_header* pHeader;
+    packet_vkFlushMappedMemoryRanges* pPacket;
+    VkMappedMemoryRange* pPacketRanges;
+    size_t dataSize = 0;
+    uint32_t iter;
+
+    for (iter = 0; iter < rangeCount; iter++)
+    {
+        dataSize += (size_t)pRanges[iter].size;
+    }
+
+    CREATE_TRACE_PACKET(vkFlushMappedMemoryRanges, (sizeof(VkMappedMemoryRange) + sizeof(void*)) * rangeCount + dataSize);
+    pPacket = interpret_body_as_vkFlushMappedMemoryRanges(pHeader);
+    pPacket->device = device;
+    pPacket->memoryRangeCount = rangeCount;
+    if (rangeCount == 0)
+        return pHeader;
+
+    pPacketRanges = (VkMappedMemoryRange*) vktrace_trace_packet_get_new_buffer_address(pHeader, sizeof(VkMappedMemoryRange) * rangeCount);
+    pPacket->ppData = (void**) vktrace_trace_packet_get_new_buffer_address(pHeader, sizeof(void*) * rangeCount);
+    for (iter = 0; iter < rangeCount; iter++)
+    {
+        pPacketRanges[iter].sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+        pPacketRanges[iter].pNext = NULL;
+        pPacketRanges[iter].memory = pRanges[iter].memory;
+        pPacketRanges[iter].offset = pRanges[iter].offset;
+        pPacketRanges[iter].size = pRanges[iter].size;
+        vktrace_add_buffer_to_trace_packet(pHeader, (void**) &(pPacket->ppData[iter]), pRanges[iter].size, pRanges[iter].pData);
+        vktrace_finalize_buffer_address(pHeader, (void**) &(pPacket->ppData[iter]));
+    }
+    pPacket->pMemoryRanges = pPacketRanges;
+    vktrace_finalize_buffer_address(pHeader, (void**) &(pPacket->pMemoryRanges));
+    vktrace_finalize_buffer_address(pHeader, (void**) &(pPacket->ppData));
+    return pHeader;
+}
+
+// Records the data the app wrote into page guarded memory as vkFlushMappedMemoryRanges
+// packets, one per device, so replay sees it before the calls that may read it.
+// caller must hold the g_memInfoLock
+static void trace_pageguard_dirty_ranges(std::vector<PageGuardRange> &ranges)
+{
+    size_t first = 0;
+    while (first < ranges.size())
+    {
+        size_t last = first + 1;
+        while (last < ranges.size() && ranges[last].device == ranges[first].device)
+            last++;
+
+        vktrace_trace_packet_header* pHeader = create_flush_mapped_memory_ranges_packet(ranges[first].device, &ranges[first], (uint32_t)(last - first));
+        vktrace_set_packet_entrypoint_end_time(pHeader);
+        interpret_body_as_vkFlushMappedMemoryRanges(pHeader)->result = VK_SUCCESS;
+        FINISH_TRACE_PACKET();
+        first = last;
+    }
+}
+
+// Records the current contents of all mapped memory, so that replay of a trigger capture
+// starts from what the app and the GPU have written so far. Page guards only see the app's
+// writes, so the whole mapped range is recorded and the dirty pages are reset.
+static void trace_mapped_memory_snapshot()
+{
+    std::vector<PageGuardRange> ranges;
+    std::vector<PageGuardRange> dirtyRanges;
+    vktrace_enter_critical_section(&g_memInfoLock);
+    for (unsigned int i = 0; i < g_memInfo.numEntrys; i++)
+    {
+        VKAllocInfo *entry = g_memInfo.pEntrys + i;
+        if (!entry->valid || entry->pData == NULL || entry->rangeSize == 0)
+            continue;
+        PageGuardRange range = { entry->device, entry->handle, entry->rangeOffset, entry->rangeSize, entry->pData };
+        ranges.push_back(range);
+        pageguard_collect_dirty_ranges(entry->handle, entry->rangeOffset, entry->rangeSize, dirtyRanges);
+    }
+    trace_pageguard_dirty_ranges(ranges);
+    vktrace_leave_critical_section(&g_memInfoLock);
+}
+
+void trace_memory_contents(VkDevice device, VkDeviceMemory memory)
+{
+    VKAllocInfo *entry;
+    void *pData = NULL;
+    BOOL didFlush = FALSE;
+    if (__HOOKED_vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &pData) != VK_SUCCESS)
+    {
+        vktrace_LogWarning("Failed to map device memory, its contents are not in the trace.");
+        return;
+    }
+
+    vktrace_enter_critical_section(&g_memInfoLock);
+    entry = find_mem_info_entry(memory);
+    if (entry != NULL)
+    {
+        std::vector<PageGuardRange> ranges(1);
+        PageGuardRange range = { device, memory, 0, entry->totalSize, (const uint8_t *)pData };
+        ranges[0] = range;
+        trace_pageguard_dirty_ranges(ranges);
+        // the data is in the trace already; keep vkUnmapMemory from recording it again
+        didFlush = entry->didFlush;
+        entry->didFlush = TRUE;
+    }
+    vktrace_leave_critical_section(&g_memInfoLock);
+
+    __HOOKED_vkUnmapMemory(device, memory);
+
+    vktrace_enter_critical_section(&g_memInfoLock);
+    entry = find_mem_info_entry(memory);
+    if (entry != NULL)
+        entry->didFlush = didFlush;
+    vktrace_leave_critical_section(&g_memInfoLock);
+}
+
+// The trace server sets _VK_TRACE_FRAME_MARKERS when it compresses the trace and needs
+// vkQueuePresentKHR to be followed by a marker packet to build its frame index.
+static bool frame_markers_enabled()
+{
+    static const bool enabled = [] {
+        const char* env = vktrace_get_global_var("_VK_TRACE_FRAME_MARKERS");
+        return env != NULL && atoi(env) != 0;
+    }();
+    return enabled;
+}
+
+// called at the end of every frame, on the thread that presented on queue
+static void trigger_check_end_frame(VkQueue queue)
+{
+    if (trigger_end_frame())
+    {
+        trigger_open_capture_window();
+        trace_mapped_memory_snapshot();
+        trigger_trace_device_state(queue);
+    }
+}
+
 VKTRACER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL __HOOKED_vkAllocateMemory(
     VkDevice device,
     const VkMemoryAllocateInfo* pAllocateInfo,
@@ -153,7 +293,9 @@ VKTRACER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL __HOOKED_vkAllocateMemory(
     vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pMemory));
     FINISH_TRACE_PACKET();
     // begin custom code
-    add_new_handle_to_mem_info(*pMemory, pAllocateInfo->allocationSize, NULL);
+    add_new_handle_to_mem_info(device, *pMemory, pAllocateInfo->allocationSize, NULL);
+    if (result == VK_SUCCESS)
+        trigger_memory_allocated(device, pAllocateInfo, *pMemory);
     // end custom code
     return result;
 }
@@ -176,7 +318,7 @@ VKTRACER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL __HOOKED_vkMapMemory(
     entry = find_mem_info_entry(memory);
 
     // For vktrace usage, clamp the memory size to the total size less offset if VK_WHOLE_SIZE is specified.
-    if (size == VK_WHOLE_SIZE) {
+    if (size == VK_WHOLE_SIZE && entry != NULL) {
         size = entry->totalSize - offset;
     }
     pPacket = interpret_body_as_vkMapMemory(pHeader);
@@ -190,6 +332,9 @@ VKTRACER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL __HOOKED_vkMapMemory(
         vktrace_add_buffer_to_trace_packet(pHeader, (void**)&(pPacket->ppData), sizeof(void*), *ppData);
         vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->ppData));
         add_data_to_mem_info(memory, size, offset, *ppData);
+        // entry->rangeSize is the mapped size with VK_WHOLE_SIZE resolved
+        if (result == VK_SUCCESS && entry != NULL && pageguard_enabled())
+            pageguard_add_mapping(device, memory, offset, entry->rangeSize, *ppData);
     }
     pPacket->result = result;
     FINISH_TRACE_PACKET();
@@ -208,11 +353,23 @@ VKTRACER_EXPORT VKAPI_ATTR void VKAPI_CALL __HOOKED_vkUnmapMemory(
 
     // insert into packet the data that was written by CPU between the vkMapMemory call and here
     // Note must do this prior to the real vkUnMap() or else may get a FAULT
+    // Outside the trigger capture window the data is left for the snapshot taken when it opens.
     vktrace_enter_critical_section(&g_memInfoLock);
     entry = find_mem_info_entry(memory);
-    if (entry && entry->pData != NULL)
+    if (entry && entry->pData != NULL && !trigger_in_capture_window())
+    {
+        pageguard_remove_mapping(memory);
+    }
+    else if (entry && entry->pData != NULL)
     {
-        if (!entry->didFlush)
+        std::vector<PageGuardRange> dirtyRanges;
+        if (pageguard_collect_dirty_ranges(memory, 0, VK_WHOLE_SIZE, dirtyRanges))
+        {
+            // only the pages written since the last flush or submit are recorded
+            trace_pageguard_dirty_ranges(dirtyRanges);
+            pageguard_remove_mapping(memory);
+        }
+        else if (!entry->didFlush)
         {
             // no FlushMapped Memory
             siz = (size_t)entry->rangeSize;
@@ -226,8 +383,9 @@ VKTRACER_EXPORT VKAPI_ATTR void VKAPI_CALL __HOOKED_vkUnmapMemory(
         assert(entry->handle == memory);
         vktrace_add_buffer_to_trace_packet(pHeader, (void**) &(pPacket->pData), siz, entry->pData);
         vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pData));
-        entry->pData = NULL;
     }
+    if (entry)
+        entry->pData = NULL;
     vktrace_leave_critical_section(&g_memInfoLock);
     pHeader->entrypoint_begin_time = vktrace_get_time();
     mdd(device)->devTable.UnmapMemory(device, memory);
@@ -245,6 +403,7 @@ VKTRACER_EXPORT VKAPI_ATTR void VKAPI_CALL __HOOKED_vkFreeMemory(
     vktrace_trace_packet_header* pHeader;
     packet_vkFreeMemory* pPacket = NULL;
     CREATE_TRACE_PACKET(vkFreeMemory, sizeof(VkAllocationCallbacks));
+    pageguard_remove_mapping(memory);
     mdd(device)->devTable.FreeMemory(device, memory, pAllocator);
     vktrace_set_packet_entrypoint_end_time(pHeader);
     pPacket = interpret_body_as_vkFreeMemory(pHeader);
@@ -255,6 +414,7 @@ VKTRACER_EXPORT VKAPI_ATTR void VKAPI_CALL __HOOKED_vkFreeMemory(
     FINISH_TRACE_PACKET();
     // begin custom code
     rm_handle_from_mem_info(memory);
+    trigger_memory_freed(memory);
     // end custom code
 }
 
@@ -265,65 +425,50 @@ VKTRACER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL __HOOKED_vkFlushMappedMemoryRange
 {
     vktrace_trace_packet_header* pHeader;
     VkResult result;
-    size_t rangesSize = 0;
-    size_t dataSize = 0;
     uint32_t iter;
     packet_vkFlushMappedMemoryRanges* pPacket = NULL;
+    std::vector<PageGuardRange> ranges;
     uint64_t trace_begin_time = vktrace_get_time();
 
-    // find out how much memory is in the ranges
-    for (iter = 0; iter < memoryRangeCount; iter++)
-    {
-        VkMappedMemoryRange* pRange = (VkMappedMemoryRange*)&pMemoryRanges[iter];
-        rangesSize += vk_size_vkmappedmemoryrange(pRange);
-        dataSize += (size_t)pRange->size;
-    }
-
-    CREATE_TRACE_PACKET(vkFlushMappedMemoryRanges, rangesSize + sizeof(void*)*memoryRangeCount + dataSize);
-    pHeader->vktrace_begin_time = trace_begin_time;
-    pPacket = interpret_body_as_vkFlushMappedMemoryRanges(pHeader);
-
-    vktrace_add_buffer_to_trace_packet(pHeader, (void**) &(pPacket->pMemoryRanges), rangesSize, pMemoryRanges);
-    vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pMemoryRanges));
+    // the snapshot taken when the trigger capture window opens holds all mapped data
+    if (!trigger_in_capture_window())
+        return mdd(device)->devTable.FlushMappedMemoryRanges(device, memoryRangeCount, pMemoryRanges);
 
     // insert into packet the data that was written by CPU between the vkMapMemory call and here
-    // create a temporary local ppData array and add it to the packet (to reserve the space for the array)
-    void** ppTmpData = (void **) malloc(memoryRangeCount * sizeof(void*));
-    vktrace_add_buffer_to_trace_packet(pHeader, (void**) &(pPacket->ppData), sizeof(void*)*memoryRangeCount, ppTmpData);
-    free(ppTmpData);
-
-    // now the actual memory
     vktrace_enter_critical_section(&g_memInfoLock);
     for (iter = 0; iter < memoryRangeCount; iter++)
     {
-        VkMappedMemoryRange* pRange = (VkMappedMemoryRange*)&pMemoryRanges[iter];
+        const VkMappedMemoryRange* pRange = &pMemoryRanges[iter];
         VKAllocInfo* pEntry = find_mem_info_entry(pRange->memory);
 
         if (pEntry != NULL)
         {
+            VkDeviceSize size = (pRange->size == VK_WHOLE_SIZE) ? pEntry->rangeOffset + pEntry->rangeSize - pRange->offset : pRange->size;
             assert(pEntry->handle == pRange->memory);
-            assert(pEntry->totalSize >= (pRange->size + pRange->offset));
-            assert(pEntry->totalSize >= pRange->size);
-            assert(pRange->offset >= pEntry->rangeOffset && (pRange->offset + pRange->size) <= (pEntry->rangeOffset + pEntry->rangeSize));
-            vktrace_add_buffer_to_trace_packet(pHeader, (void**) &(pPacket->ppData[iter]), pRange->size, pEntry->pData + pRange->offset);
-            vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->ppData[iter]));
+            assert(pEntry->totalSize >= (size + pRange->offset));
+            assert(pRange->offset >= pEntry->rangeOffset && (pRange->offset + size) <= (pEntry->rangeOffset + pEntry->rangeSize));
+
+            // with page guards only the pages written since the last capture are recorded
+            if (!pageguard_collect_dirty_ranges(pRange->memory, pRange->offset, size, ranges))
+            {
+                PageGuardRange range = { device, pRange->memory, pRange->offset, size, pEntry->pData + pRange->offset };
+                ranges.push_back(range);
+            }
             pEntry->didFlush = TRUE;
         }
         else
         {
-             vktrace_LogError("Failed to copy app memory into trace packet (idx = %u) on vkFlushedMappedMemoryRanges", pHeader->global_packet_index);
+             vktrace_LogError("Failed to copy app memory into trace packet (range %u) on vkFlushedMappedMemoryRanges", iter);
         }
     }
+    pHeader = create_flush_mapped_memory_ranges_packet(device, ranges.data(), (uint32_t)ranges.size());
     vktrace_leave_critical_section(&g_memInfoLock);
-
-    // now finalize the ppData array since it is done being updated
-    vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->ppData));
+    pHeader->vktrace_begin_time = trace_begin_time;
+    pPacket = interpret_body_as_vkFlushMappedMemoryRanges(pHeader);
 
     pHeader->entrypoint_begin_time = vktrace_get_time();
     result = mdd(device)->devTable.FlushMappedMemoryRanges(device, memoryRangeCount, pMemoryRanges);
     vktrace_set_packet_entrypoint_end_time(pHeader);
-    pPacket->device = device;
-    pPacket->memoryRangeCount = memoryRangeCount;
     pPacket->result = result;
     FINISH_TRACE_PACKET();
     return result;
@@ -348,6 +493,8 @@ VKTRACER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL __HOOKED_vkAllocateCommandBuffers
     vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pAllocateInfo));
     vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pCommandBuffers));
     FINISH_TRACE_PACKET();
+    if (result == VK_SUCCESS)
+        trigger_command_buffers_allocated(pAllocateInfo, pCommandBuffers);
     return result;
 }
 
@@ -368,7 +515,7 @@ VKTRACER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL __HOOKED_vkBeginCommandBuffer(
     pPacket->result = result;
     vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pBeginInfo->pInheritanceInfo));
     vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pBeginInfo));
-    FINISH_TRACE_PACKET();
+    trigger_finish_recording_packet(commandBuffer, &pHeader);
     return result;
 }
 
@@ -446,6 +593,7 @@ VKTRACER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL __HOOKED_vkCreateDevice(
     initDeviceData(*pDevice, fpGetDeviceProcAddr, g_deviceDataMap);
     // Setup device dispatch table for extensions
     ext_init_create_device(mdd(*pDevice), *pDevice, fpGetDeviceProcAddr, pCreateInfo->enabledExtensionCount, pCreateInfo->ppEnabledExtensionNames);
+    trigger_device_created(physicalDevice, *pDevice);
 
     // remove the loader extended createInfo structure
     VkDeviceCreateInfo localCreateInfo;
@@ -501,6 +649,8 @@ VKTRACER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL __HOOKED_vkCreateFramebuffer(
     vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pAllocator));
     vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pFramebuffer));
     FINISH_TRACE_PACKET();
+    if (result == VK_SUCCESS)
+        trigger_framebuffer_created(pCreateInfo, *pFramebuffer);
     return result;
 }
 
@@ -631,6 +781,8 @@ VKTRACER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL __HOOKED_vkCreateRenderPass(
     vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pAllocator));
     vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pRenderPass));
     FINISH_TRACE_PACKET();
+    if (result == VK_SUCCESS)
+        trigger_render_pass_created(pCreateInfo, *pRenderPass);
     return result;
 }
 
@@ -775,6 +927,8 @@ VKTRACER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL __HOOKED_vkGetQueryPoolResults(
     packet_vkGetQueryPoolResults* pPacket = NULL;
     uint64_t startTime;
     uint64_t endTime;
+    if (!trigger_in_capture_window())
+        return mdd(device)->devTable.GetQueryPoolResults(device, queryPool, firstQuery, queryCount, dataSize, pData, stride, flags);
     uint64_t vktraceStartTime = vktrace_get_time();
     startTime = vktrace_get_time();
     result = mdd(device)->devTable.GetQueryPoolResults(device, queryPool, firstQuery, queryCount, dataSize, pData, stride, flags);
@@ -918,28 +1072,27 @@ VKTRACER_EXPORT VKAPI_ATTR void VKAPI_CALL __HOOKED_vkUpdateDescriptorSets(
     FINISH_TRACE_PACKET();
 }
 
-VKTRACER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL __HOOKED_vkQueueSubmit(
+vktrace_trace_packet_header* create_queue_submit_packet(
     VkQueue queue,
     uint32_t submitCount,
     const VkSubmitInfo* pSubmits,
     VkFence fence)
 {
     vktrace_trace_packet_header* pHeader;
-    VkResult result;
     packet_vkQueueSubmit* pPacket = NULL;
     size_t arrayByteCount = 0;
     uint32_t i = 0;
     for (i=0; i<submitCount; ++i) {
-        arrayByteCount += vk_size_vksubmitinfo(&pSubmits[i]);
+        arrayByteCount += sizeof(VkSubmitInfo);
+        arrayByteCount += pSubmits[i].waitSemaphoreCount * (sizeof(VkSemaphore) + sizeof(VkPipelineStageFlags));
+        arrayByteCount += pSubmits[i].commandBufferCount * sizeof(VkCommandBuffer);
+        arrayByteCount += pSubmits[i].signalSemaphoreCount * sizeof(VkSemaphore);
     }
     CREATE_TRACE_PACKET(vkQueueSubmit, arrayByteCount);
-    result = mdd(queue)->devTable.QueueSubmit(queue, submitCount, pSubmits, fence);
-    vktrace_set_packet_entrypoint_end_time(pHeader);
     pPacket = interpret_body_as_vkQueueSubmit(pHeader);
     pPacket->queue = queue;
     pPacket->submitCount = submitCount;
     pPacket->fence = fence;
-    pPacket->result = result;
     vktrace_add_buffer_to_trace_packet(pHeader, (void**)&(pPacket->pSubmits), submitCount*sizeof(VkSubmitInfo), pSubmits);
     for (i=0; i<submitCount; ++i) {
         vktrace_add_buffer_to_trace_packet(pHeader, (void**)&(pPacket->pSubmits[i].pCommandBuffers), pPacket->pSubmits[i].commandBufferCount * sizeof(VkCommandBuffer), pSubmits[i].pCommandBuffers);
@@ -948,10 +1101,44 @@ VKTRACER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL __HOOKED_vkQueueSubmit(
         vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pSubmits[i].pWaitSemaphores));
         vktrace_add_buffer_to_trace_packet(pHeader, (void**)&(pPacket->pSubmits[i].pSignalSemaphores), pPacket->pSubmits[i].signalSemaphoreCount * sizeof(VkSemaphore), pSubmits[i].pSignalSemaphores);
         vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pSubmits[i].pSignalSemaphores));
-        vktrace_add_buffer_to_trace_packet(pHeader, (void**)&(pPacket->pSubmits[i].pWaitDstStageMask), sizeof(VkPipelineStageFlags), pSubmits[i].pWaitDstStageMask);
+        vktrace_add_buffer_to_trace_packet(pHeader, (void**)&(pPacket->pSubmits[i].pWaitDstStageMask), pPacket->pSubmits[i].waitSemaphoreCount * sizeof(VkPipelineStageFlags), pSubmits[i].pWaitDstStageMask);
         vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pSubmits[i].pWaitDstStageMask));
     }
     vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pSubmits));
+    return pHeader;
+}
+
+VKTRACER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL __HOOKED_vkQueueSubmit(
+    VkQueue queue,
+    uint32_t submitCount,
+    const VkSubmitInfo* pSubmits,
+    VkFence fence)
+{
+    vktrace_trace_packet_header* pHeader;
+    VkResult result;
+    if (!trigger_in_capture_window())
+    {
+        // dirty pages are left for the snapshot taken when the capture window opens
+        result = mdd(queue)->devTable.QueueSubmit(queue, submitCount, pSubmits, fence);
+        trigger_fence_signaled(fence, false);
+        trigger_queue_submitted(submitCount, pSubmits, false);
+        return result;
+    }
+    if (pageguard_enabled())
+    {
+        // memory that stays mapped may have been written without a flush; record it before the GPU can read it
+        std::vector<PageGuardRange> dirtyRanges;
+        vktrace_enter_critical_section(&g_memInfoLock);
+        pageguard_collect_all_dirty_ranges(dirtyRanges);
+        trace_pageguard_dirty_ranges(dirtyRanges);
+        vktrace_leave_critical_section(&g_memInfoLock);
+    }
+    pHeader = create_queue_submit_packet(queue, submitCount, pSubmits, fence);
+    result = mdd(queue)->devTable.QueueSubmit(queue, submitCount, pSubmits, fence);
+    vktrace_set_packet_entrypoint_end_time(pHeader);
+    trigger_fence_signaled(fence, true);
+    trigger_queue_submitted(submitCount, pSubmits, true);
+    interpret_body_as_vkQueueSubmit(pHeader)->result = result;
     FINISH_TRACE_PACKET();
     return result;
 }
@@ -981,6 +1168,7 @@ VKTRACER_EXPORT VKAPI_ATTR void VKAPI_CALL __HOOKED_vkCmdWaitEvents(
                                     bufferMemoryBarrierCount, pBufferMemoryBarriers,
                                     imageMemoryBarrierCount, pImageMemoryBarriers);
     vktrace_set_packet_entrypoint_end_time(pHeader);
+    trigger_image_barriers_recorded(commandBuffer, imageMemoryBarrierCount, pImageMemoryBarriers);
     pPacket = interpret_body_as_vkCmdWaitEvents(pHeader);
     pPacket->commandBuffer = commandBuffer;
     pPacket->eventCount = eventCount;
@@ -998,7 +1186,7 @@ VKTRACER_EXPORT VKAPI_ATTR void VKAPI_CALL __HOOKED_vkCmdWaitEvents(
     vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pMemoryBarriers));
     vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pBufferMemoryBarriers));
     vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pImageMemoryBarriers));
-    FINISH_TRACE_PACKET();
+    trigger_finish_recording_packet(commandBuffer, &pHeader);
 }
 
 VKTRACER_EXPORT VKAPI_ATTR void VKAPI_CALL __HOOKED_vkCmdPipelineBarrier(
@@ -1022,6 +1210,7 @@ VKTRACER_EXPORT VKAPI_ATTR void VKAPI_CALL __HOOKED_vkCmdPipelineBarrier(
     CREATE_TRACE_PACKET(vkCmdPipelineBarrier, customSize);
     mdd(commandBuffer)->devTable.CmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, dependencyFlags, memoryBarrierCount, pMemoryBarriers, bufferMemoryBarrierCount, pBufferMemoryBarriers, imageMemoryBarrierCount, pImageMemoryBarriers);
     vktrace_set_packet_entrypoint_end_time(pHeader);
+    trigger_image_barriers_recorded(commandBuffer, imageMemoryBarrierCount, pImageMemoryBarriers);
     pPacket = interpret_body_as_vkCmdPipelineBarrier(pHeader);
     pPacket->commandBuffer = commandBuffer;
     pPacket->srcStageMask = srcStageMask;
@@ -1037,7 +1226,7 @@ VKTRACER_EXPORT VKAPI_ATTR void VKAPI_CALL __HOOKED_vkCmdPipelineBarrier(
     vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pMemoryBarriers));
     vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pBufferMemoryBarriers));
     vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pImageMemoryBarriers));
-    FINISH_TRACE_PACKET();
+    trigger_finish_recording_packet(commandBuffer, &pHeader);
 }
 
 VKTRACER_EXPORT VKAPI_ATTR void VKAPI_CALL __HOOKED_vkCmdPushConstants(
@@ -1061,7 +1250,7 @@ VKTRACER_EXPORT VKAPI_ATTR void VKAPI_CALL __HOOKED_vkCmdPushConstants(
     pPacket->size = size;
     vktrace_add_buffer_to_trace_packet(pHeader, (void**)&(pPacket->pValues), size, pValues);
     vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pValues));
-    FINISH_TRACE_PACKET();
+    trigger_finish_recording_packet(commandBuffer, &pHeader);
 }
 
 VKTRACER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL __HOOKED_vkGetPipelineCacheData(
@@ -1214,6 +1403,7 @@ VKTRACER_EXPORT VKAPI_ATTR void VKAPI_CALL __HOOKED_vkCmdBeginRenderPass(
     CREATE_TRACE_PACKET(vkCmdBeginRenderPass, sizeof(VkRenderPassBeginInfo) + clearValueSize);
     mdd(commandBuffer)->devTable.CmdBeginRenderPass(commandBuffer, pRenderPassBegin, contents);
     vktrace_set_packet_entrypoint_end_time(pHeader);
+    trigger_render_pass_recorded(commandBuffer, pRenderPassBegin);
     pPacket = interpret_body_as_vkCmdBeginRenderPass(pHeader);
     pPacket->commandBuffer = commandBuffer;
     pPacket->contents = contents;
@@ -1221,7 +1411,7 @@ VKTRACER_EXPORT VKAPI_ATTR void VKAPI_CALL __HOOKED_vkCmdBeginRenderPass(
     vktrace_add_buffer_to_trace_packet(pHeader, (void**)&(pPacket->pRenderPassBegin->pClearValues), clearValueSize, pRenderPassBegin->pClearValues);
     vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pRenderPassBegin->pClearValues));
     vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pRenderPassBegin));
-    FINISH_TRACE_PACKET();
+    trigger_finish_recording_packet(commandBuffer, &pHeader);
 }
 
 VKTRACER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL __HOOKED_vkFreeDescriptorSets(
@@ -1404,12 +1594,20 @@ VKTRACER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL __HOOKED_vkQueuePresentKHR(
     size_t semaSize = pPresentInfo->waitSemaphoreCount * sizeof(VkSemaphore);
     size_t resultsSize = pPresentInfo->swapchainCount * sizeof(VkResult);
     size_t totalSize = sizeof(VkPresentInfoKHR) + swapchainSize + indexSize + semaSize;
+    if (!trigger_in_capture_window())
+    {
+        result = mdd(queue)->devTable.QueuePresentKHR(queue, pPresentInfo);
+        trigger_semaphores_waited(pPresentInfo->waitSemaphoreCount, pPresentInfo->pWaitSemaphores, false);
+        trigger_check_end_frame(queue);
+        return result;
+    }
     if (pPresentInfo->pResults != NULL) {
         totalSize += resultsSize;
     }
     CREATE_TRACE_PACKET(vkQueuePresentKHR, totalSize);
     result = mdd(queue)->devTable.QueuePresentKHR(queue, pPresentInfo);
     vktrace_set_packet_entrypoint_end_time(pHeader);
+    trigger_semaphores_waited(pPresentInfo->waitSemaphoreCount, pPresentInfo->pWaitSemaphores, true);
     pPacket = interpret_body_as_vkQueuePresentKHR(pHeader);
     pPacket->queue = queue;
     vktrace_add_buffer_to_trace_packet(pHeader, (void**)&(pPacket->pPresentInfo), sizeof(VkPresentInfoKHR), pPresentInfo);
@@ -1428,6 +1626,18 @@ VKTRACER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL __HOOKED_vkQueuePresentKHR(
     }
     vktrace_finalize_buffer_address(pHeader, (void**)&(pPacket->pPresentInfo));
     FINISH_TRACE_PACKET();
+
+    // end of frame marker, used by the trace server to index the frames of compressed traces
+    if (frame_markers_enabled())
+    {
+        vktrace_trace_packet_marker_api_boundary* pMarker;
+        pHeader = vktrace_create_trace_packet(VKTRACE_TID_VULKAN, VKTRACE_TPI_MARKER_API_BOUNDARY, sizeof(vktrace_trace_packet_marker_api_boundary), 0);
+        pMarker = (vktrace_trace_packet_marker_api_boundary*)pHeader->pBody;
+        memset(pMarker, 0, sizeof(*pMarker));
+        pMarker->pHeader = pHeader;
+        FINISH_TRACE_PACKET();
+    }
+    trigger_check_end_frame(queue);
     return result;
 }
 
@@ -0,0 +1,1330 @@
+/*
+ *
+ * Copyright (C) 2016 Valve Corporation
+ * Copyright (C) 2016 LunarG, Inc.
+ * All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <atomic>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "vktrace_lib_trigger.h"
+#include "vktrace_lib_helpers.h"
+#include "vktrace_platform.h"
+#include "vktrace_common.h"
+#include "vktrace_tracelog.h"
+#include "vktrace_trace_packet_utils.h"
+#include "vktrace_vk_vk.h"
+
+#if defined(PLATFORM_LINUX)
+#include <pthread.h>
+
+static pthread_once_t g_triggerInitOnce = PTHREAD_ONCE_INIT;
+#elif defined(WIN32)
+static INIT_ONCE g_triggerInitOnce = INIT_ONCE_STATIC_INIT;
+#endif
+
+static VKTRACE_CRITICAL_SECTION g_triggerLock;
+static bool g_triggerEnabled = false;
+static uint64_t g_triggerFrame = UINT64_MAX;    // frame that opens the window, UINT64_MAX if none
+static uint32_t g_windowFrameCount = 1;
+static std::atomic<bool> g_windowOpen(true);
+static std::atomic<bool> g_signalPending(false);
+
+struct TriggerDevice
+{
+    VkPhysicalDevice physicalDevice;
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    std::vector<VkQueueFamilyProperties> queueFamilies;
+};
+
+struct TriggerQueue
+{
+    VkDevice device;
+    uint32_t family;
+};
+
+struct TriggerMemory
+{
+    VkDevice device;
+    uint32_t memoryTypeIndex;
+};
+
+struct TriggerBuffer
+{
+    VkDevice device;
+    VkDeviceSize size;
+    bool copyable;
+    VkDeviceMemory memory;
+};
+
+struct TriggerImage
+{
+    VkDevice device;
+    VkFormat format;
+    VkExtent3D extent;
+    uint32_t mipLevels;
+    uint32_t arrayLayers;
+    bool copyable;
+    VkDeviceMemory memory;
+    VkImageLayout layout;       // layout after the last submit, for the whole image
+};
+
+struct TriggerCommandBuffer
+{
+    VkCommandPool commandPool;
+    VkCommandBufferLevel level;
+    std::vector<vktrace_trace_packet_header *> packets;                 // recording kept outside the window
+    std::vector<std::pair<VkImage, VkImageLayout> > layouts;           // layouts that a submit leaves images in
+};
+
+struct TriggerSemaphore
+{
+    VkDevice device;
+    bool signaled;
+    bool signaledInTrace;
+};
+
+// only touched with g_triggerLock held
+static uint64_t g_frame = 0;
+static uint32_t g_windowFramesCaptured = 0;
+static std::unordered_set<VkFence> g_tracedFences;
+static std::unordered_map<VkDevice, TriggerDevice> g_devices;
+static std::unordered_map<VkQueue, TriggerQueue> g_queues;
+static std::unordered_map<VkDeviceMemory, TriggerMemory> g_memories;
+static std::unordered_map<VkBuffer, TriggerBuffer> g_buffers;
+static std::unordered_map<VkImage, TriggerImage> g_images;
+static std::unordered_map<VkImageView, VkImage> g_imageViews;
+static std::unordered_map<VkFramebuffer, std::vector<VkImage> > g_framebuffers;
+static std::unordered_map<VkRenderPass, std::vector<VkImageLayout> > g_renderPasses;
+static std::unordered_map<VkCommandBuffer, TriggerCommandBuffer> g_commandBuffers;
+static std::unordered_map<VkEvent, VkDevice> g_events;
+static std::unordered_map<VkSemaphore, TriggerSemaphore> g_semaphores;
+#if defined(WIN32)
+static bool g_triggerHotkey = false;
+static bool g_hotkeyWasDown = false;
+#endif
+
+#if defined(PLATFORM_LINUX)
+static void trigger_sigusr1_handler(int signum)
+{
+    g_signalPending = true;
+}
+#endif
+
+static void trigger_init()
+{
+    const char *env = vktrace_get_global_var("VKTRACE_TRIGGER_FRAMES");
+    if (env != NULL && atoi(env) > 0)
+        g_windowFrameCount = (uint32_t) atoi(env);
+
+    env = vktrace_get_global_var("VKTRACE_TRIGGER_FRAME");
+    if (env != NULL)
+    {
+        g_triggerFrame = strtoull(env, NULL, 10);
+        g_triggerEnabled = true;
+    }
+
+#if defined(PLATFORM_LINUX)
+    env = vktrace_get_global_var("VKTRACE_TRIGGER_SIGNAL");
+    if (env != NULL && atoi(env) != 0)
+    {
+        struct sigaction act;
+        memset(&act, 0, sizeof(act));
+        act.sa_handler = trigger_sigusr1_handler;
+        act.sa_flags = SA_RESTART;
+        sigemptyset(&act.sa_mask);
+        if (sigaction(SIGUSR1, &act, NULL) == 0)
+            g_triggerEnabled = true;
+        else
+            vktrace_LogError("Failed to install SIGUSR1 handler, VKTRACE_TRIGGER_SIGNAL is ignored.");
+    }
+#elif defined(WIN32)
+    env = vktrace_get_global_var("VKTRACE_TRIGGER_HOTKEY");
+    if (env != NULL && atoi(env) != 0)
+    {
+        g_triggerHotkey = true;
+        g_triggerEnabled = true;
+    }
+#endif
+
+    if (!g_triggerEnabled)
+        return;
+
+    vktrace_create_critical_section(&g_triggerLock);
+    g_windowOpen = (g_triggerFrame == 0);
+    vktrace_LogVerbose("Trigger capture enabled, capturing %u frames per trigger.", g_windowFrameCount);
+}
+
+bool trigger_in_capture_window()
+{
+    vktrace_platform_thread_once(&g_triggerInitOnce, trigger_init);
+    return g_windowOpen.load(std::memory_order_relaxed);
+}
+
+static bool trigger_enabled()
+{
+    vktrace_platform_thread_once(&g_triggerInitOnce, trigger_init);
+    return g_triggerEnabled;
+}
+
+bool trigger_end_frame()
+{
+    bool open = false;
+    vktrace_platform_thread_once(&g_triggerInitOnce, trigger_init);
+    if (!g_triggerEnabled)
+        return false;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    g_frame++;
+    if (g_windowOpen)
+    {
+        if (++g_windowFramesCaptured >= g_windowFrameCount)
+        {
+            g_windowOpen = false;
+            vktrace_LogVerbose("Trigger capture window closed after frame %llu.", (unsigned long long) (g_frame - 1));
+        }
+        // triggers that fire while capturing are dropped
+        g_signalPending = false;
+    }
+    else
+    {
+        open = (g_frame == g_triggerFrame) || g_signalPending.exchange(false);
+#if defined(WIN32)
+        if (g_triggerHotkey)
+        {
+            bool down = (GetAsyncKeyState(VK_F12) & 0x8000) != 0;
+            open = open || (down && !g_hotkeyWasDown);
+            g_hotkeyWasDown = down;
+        }
+#endif
+    }
+    vktrace_leave_critical_section(&g_triggerLock);
+    return open;
+}
+
+static void trigger_write_packets(std::vector<vktrace_trace_packet_header *> &packets)
+{
+    for (size_t i = 0; i < packets.size(); i++)
+    {
+        vktrace_write_trace_packet(packets[i], vktrace_trace_get_trace_file());
+        vktrace_delete_trace_packet(&packets[i]);
+    }
+    packets.clear();
+}
+
+static void trigger_delete_packets(std::vector<vktrace_trace_packet_header *> &packets)
+{
+    for (size_t i = 0; i < packets.size(); i++)
+    {
+        vktrace_delete_trace_packet(&packets[i]);
+    }
+    packets.clear();
+}
+
+void trigger_open_capture_window()
+{
+    vktrace_enter_critical_section(&g_triggerLock);
+    // secondary command buffers must be recorded before the primaries that execute them
+    for (auto it = g_commandBuffers.begin(); it != g_commandBuffers.end(); ++it)
+    {
+        if (it->second.level == VK_COMMAND_BUFFER_LEVEL_SECONDARY)
+            trigger_write_packets(it->second.packets);
+    }
+    for (auto it = g_commandBuffers.begin(); it != g_commandBuffers.end(); ++it)
+    {
+        trigger_write_packets(it->second.packets);
+    }
+    g_windowFramesCaptured = 0;
+    g_windowOpen = true;
+    vktrace_LogVerbose("Trigger capture window opened at frame %llu.", (unsigned long long) g_frame);
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_fence_signaled(VkFence fence, bool traced)
+{
+    vktrace_platform_thread_once(&g_triggerInitOnce, trigger_init);
+    if (!g_triggerEnabled || fence == VK_NULL_HANDLE)
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    if (traced)
+        g_tracedFences.insert(fence);
+    else
+        g_tracedFences.erase(fence);
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+bool trigger_fences_signaled_in_trace(uint32_t fenceCount, const VkFence *pFences)
+{
+    bool traced = true;
+    vktrace_platform_thread_once(&g_triggerInitOnce, trigger_init);
+    if (!g_triggerEnabled)
+        return true;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    for (uint32_t i = 0; i < fenceCount && traced; i++)
+    {
+        traced = g_tracedFences.count(pFences[i]) != 0;
+    }
+    vktrace_leave_critical_section(&g_triggerLock);
+    return traced;
+}
+
+void trigger_finish_recording_packet(VkCommandBuffer commandBuffer, vktrace_trace_packet_header **ppHeader)
+{
+    vktrace_trace_packet_header *pHeader = *ppHeader;
+    vktrace_finalize_trace_packet(pHeader);
+    bool restart = pHeader->packet_id == VKTRACE_TPI_VK_vkBeginCommandBuffer ||
+                   pHeader->packet_id == VKTRACE_TPI_VK_vkResetCommandBuffer;
+    if (trigger_enabled() && (restart || !g_windowOpen))
+    {
+        vktrace_enter_critical_section(&g_triggerLock);
+        auto it = g_commandBuffers.find(commandBuffer);
+        if (it != g_commandBuffers.end())
+        {
+            if (restart)
+            {
+                trigger_delete_packets(it->second.packets);
+                it->second.layouts.clear();
+            }
+            if (!g_windowOpen)
+            {
+                it->second.packets.push_back(pHeader);
+                pHeader = NULL;
+            }
+        }
+        vktrace_leave_critical_section(&g_triggerLock);
+    }
+    if (pHeader != NULL)
+    {
+        vktrace_write_trace_packet(pHeader, vktrace_trace_get_trace_file());
+        vktrace_delete_trace_packet(&pHeader);
+    }
+    *ppHeader = NULL;
+}
+
+// Size of a texel block of one aspect of format, false for formats the preamble does not copy.
+static bool trigger_format_block(VkFormat format, VkImageAspectFlagBits aspect, uint32_t *pBytes, uint32_t *pWidth, uint32_t *pHeight)
+{
+    static const uint32_t astcBlocks[][2] = {{4, 4}, {5, 4}, {5, 5}, {6, 5}, {6, 6}, {8, 5}, {8, 6},
+                                             {8, 8}, {10, 5}, {10, 6}, {10, 8}, {10, 10}, {12, 10}, {12, 12}};
+    uint32_t bytes = 0;
+    *pWidth = 1;
+    *pHeight = 1;
+    switch (format)
+    {
+    case VK_FORMAT_D16_UNORM:
+        bytes = 2;
+        break;
+    case VK_FORMAT_X8_D24_UNORM_PACK32:
+    case VK_FORMAT_D32_SFLOAT:
+        bytes = 4;
+        break;
+    case VK_FORMAT_S8_UINT:
+        bytes = 1;
+        break;
+    case VK_FORMAT_D16_UNORM_S8_UINT:
+        bytes = (aspect == VK_IMAGE_ASPECT_STENCIL_BIT) ? 1 : 2;
+        break;
+    case VK_FORMAT_D24_UNORM_S8_UINT:
+    case VK_FORMAT_D32_SFLOAT_S8_UINT:
+        bytes = (aspect == VK_IMAGE_ASPECT_STENCIL_BIT) ? 1 : 4;
+        break;
+    default:
+        if (format == VK_FORMAT_R4G4_UNORM_PACK8)
+            bytes = 1;
+        else if (format <= VK_FORMAT_A1R5G5B5_UNORM_PACK16)
+            bytes = 2;
+        else if (format <= VK_FORMAT_R8_SRGB)
+            bytes = 1;
+        else if (format <= VK_FORMAT_R8G8_SRGB)
+            bytes = 2;
+        else if (format <= VK_FORMAT_B8G8R8_SRGB)
+            bytes = 3;
+        else if (format <= VK_FORMAT_A2B10G10R10_SINT_PACK32)
+            bytes = 4;
+        else if (format <= VK_FORMAT_R16_SFLOAT)
+            bytes = 2;
+        else if (format <= VK_FORMAT_R16G16_SFLOAT)
+            bytes = 4;
+        else if (format <= VK_FORMAT_R16G16B16_SFLOAT)
+            bytes = 6;
+        else if (format <= VK_FORMAT_R16G16B16A16_SFLOAT)
+            bytes = 8;
+        else if (format <= VK_FORMAT_R32_SFLOAT)
+            bytes = 4;
+        else if (format <= VK_FORMAT_R32G32_SFLOAT)
+            bytes = 8;
+        else if (format <= VK_FORMAT_R32G32B32_SFLOAT)
+            bytes = 12;
+        else if (format <= VK_FORMAT_R32G32B32A32_SFLOAT)
+            bytes = 16;
+        else if (format <= VK_FORMAT_R64_SFLOAT)
+            bytes = 8;
+        else if (format <= VK_FORMAT_R64G64_SFLOAT)
+            bytes = 16;
+        else if (format <= VK_FORMAT_R64G64B64_SFLOAT)
+            bytes = 24;
+        else if (format <= VK_FORMAT_R64G64B64A64_SFLOAT)
+            bytes = 32;
+        else if (format <= VK_FORMAT_E5B9G9R9_UFLOAT_PACK32)
+            bytes = 4;
+        else if (format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_EAC_R11G11_SNORM_BLOCK)
+        {
+            *pWidth = 4;
+            *pHeight = 4;
+            if (format <= VK_FORMAT_BC1_RGBA_SRGB_BLOCK || (format >= VK_FORMAT_BC4_UNORM_BLOCK && format <= VK_FORMAT_BC4_SNORM_BLOCK) ||
+                (format >= VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK && format <= VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK) ||
+                (format >= VK_FORMAT_EAC_R11_UNORM_BLOCK && format <= VK_FORMAT_EAC_R11_SNORM_BLOCK))
+                bytes = 8;
+            else
+                bytes = 16;
+        }
+        else if (format >= VK_FORMAT_ASTC_4x4_UNORM_BLOCK && format <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK)
+        {
+            uint32_t block = (format - VK_FORMAT_ASTC_4x4_UNORM_BLOCK) / 2;
+            *pWidth = astcBlocks[block][0];
+            *pHeight = astcBlocks[block][1];
+            bytes = 16;
+        }
+        break;
+    }
+    *pBytes = bytes;
+    return bytes != 0;
+}
+
+static VkImageAspectFlags trigger_format_aspects(VkFormat format)
+{
+    switch (format)
+    {
+    case VK_FORMAT_D16_UNORM:
+    case VK_FORMAT_X8_D24_UNORM_PACK32:
+    case VK_FORMAT_D32_SFLOAT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT;
+    case VK_FORMAT_S8_UINT:
+        return VK_IMAGE_ASPECT_STENCIL_BIT;
+    case VK_FORMAT_D16_UNORM_S8_UINT:
+    case VK_FORMAT_D24_UNORM_S8_UINT:
+    case VK_FORMAT_D32_SFLOAT_S8_UINT:
+        return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+    default:
+        return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
+}
+
+static bool trigger_format_copyable(VkFormat format)
+{
+    uint32_t bytes, width, height;
+    VkImageAspectFlags aspects = trigger_format_aspects(format);
+    if ((aspects & VK_IMAGE_ASPECT_DEPTH_BIT) && !trigger_format_block(format, VK_IMAGE_ASPECT_DEPTH_BIT, &bytes, &width, &height))
+        return false;
+    if ((aspects & VK_IMAGE_ASPECT_STENCIL_BIT) && !trigger_format_block(format, VK_IMAGE_ASPECT_STENCIL_BIT, &bytes, &width, &height))
+        return false;
+    if ((aspects & VK_IMAGE_ASPECT_COLOR_BIT) && !trigger_format_block(format, VK_IMAGE_ASPECT_COLOR_BIT, &bytes, &width, &height))
+        return false;
+    return true;
+}
+
+const VkBufferCreateInfo *trigger_buffer_create_info(const VkBufferCreateInfo *pCreateInfo, VkBufferCreateInfo *pLocal)
+{
+    if (!trigger_enabled() || (pCreateInfo->flags & VK_BUFFER_CREATE_SPARSE_BINDING_BIT))
+        return pCreateInfo;
+
+    *pLocal = *pCreateInfo;
+    pLocal->usage |= VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    return pLocal;
+}
+
+const VkImageCreateInfo *trigger_image_create_info(VkDevice device, const VkImageCreateInfo *pCreateInfo, VkImageCreateInfo *pLocal)
+{
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkImageFormatProperties properties;
+    if (!trigger_enabled() || pCreateInfo->samples != VK_SAMPLE_COUNT_1_BIT ||
+        (pCreateInfo->flags & VK_IMAGE_CREATE_SPARSE_BINDING_BIT) ||
+        (pCreateInfo->usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) || !trigger_format_copyable(pCreateInfo->format))
+        return pCreateInfo;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    auto it = g_devices.find(device);
+    if (it != g_devices.end())
+        physicalDevice = it->second.physicalDevice;
+    vktrace_leave_critical_section(&g_triggerLock);
+    if (physicalDevice == VK_NULL_HANDLE)
+        return pCreateInfo;
+
+    *pLocal = *pCreateInfo;
+    pLocal->usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    if (mid(physicalDevice)->instTable.GetPhysicalDeviceImageFormatProperties(physicalDevice, pLocal->format, pLocal->imageType, pLocal->tiling,
+                                                                              pLocal->usage, pLocal->flags, &properties) != VK_SUCCESS)
+        return pCreateInfo;
+    return pLocal;
+}
+
+void trigger_device_created(VkPhysicalDevice physicalDevice, VkDevice device)
+{
+    TriggerDevice info;
+    uint32_t count = 0;
+    if (!trigger_enabled())
+        return;
+
+    VkLayerInstanceDispatchTable *pTable = &mid(physicalDevice)->instTable;
+    info.physicalDevice = physicalDevice;
+    pTable->GetPhysicalDeviceMemoryProperties(physicalDevice, &info.memoryProperties);
+    pTable->GetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, NULL);
+    info.queueFamilies.resize(count);
+    pTable->GetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, info.queueFamilies.data());
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    g_devices[device] = info;
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+template <typename Map>
+static void trigger_erase_device_objects(Map &objects, VkDevice device)
+{
+    for (auto it = objects.begin(); it != objects.end();)
+    {
+        if (it->second.device == device)
+            it = objects.erase(it);
+        else
+            ++it;
+    }
+}
+
+void trigger_device_destroyed(VkDevice device)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    g_devices.erase(device);
+    trigger_erase_device_objects(g_queues, device);
+    trigger_erase_device_objects(g_memories, device);
+    trigger_erase_device_objects(g_buffers, device);
+    trigger_erase_device_objects(g_images, device);
+    trigger_erase_device_objects(g_semaphores, device);
+    for (auto it = g_events.begin(); it != g_events.end();)
+    {
+        if (it->second == device)
+            it = g_events.erase(it);
+        else
+            ++it;
+    }
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_queue_created(VkDevice device, uint32_t queueFamilyIndex, VkQueue queue)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    TriggerQueue &info = g_queues[queue];
+    info.device = device;
+    info.family = queueFamilyIndex;
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_memory_allocated(VkDevice device, const VkMemoryAllocateInfo *pAllocateInfo, VkDeviceMemory memory)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    TriggerMemory &info = g_memories[memory];
+    info.device = device;
+    info.memoryTypeIndex = pAllocateInfo->memoryTypeIndex;
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_memory_freed(VkDeviceMemory memory)
+{
+    if (!trigger_enabled() || memory == VK_NULL_HANDLE)
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    g_memories.erase(memory);
+    // resources left bound to freed memory can no longer be used, so they are not copied
+    for (auto it = g_buffers.begin(); it != g_buffers.end(); ++it)
+    {
+        if (it->second.memory == memory)
+            it->second.memory = VK_NULL_HANDLE;
+    }
+    for (auto it = g_images.begin(); it != g_images.end(); ++it)
+    {
+        if (it->second.memory == memory)
+            it->second.memory = VK_NULL_HANDLE;
+    }
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_buffer_created(VkDevice device, const VkBufferCreateInfo *pCreateInfo, VkBuffer buffer)
+{
+    const VkBufferUsageFlags transfer = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    TriggerBuffer &info = g_buffers[buffer];
+    info.device = device;
+    info.size = pCreateInfo->size;
+    info.copyable = (pCreateInfo->usage & transfer) == transfer && !(pCreateInfo->flags & VK_BUFFER_CREATE_SPARSE_BINDING_BIT);
+    info.memory = VK_NULL_HANDLE;
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_buffer_bound(VkBuffer buffer, VkDeviceMemory memory, VkDeviceSize offset)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    auto it = g_buffers.find(buffer);
+    if (it != g_buffers.end())
+        it->second.memory = memory;
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_buffer_destroyed(VkBuffer buffer)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    g_buffers.erase(buffer);
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_image_created(VkDevice device, const VkImageCreateInfo *pCreateInfo, VkImage image)
+{
+    const VkImageUsageFlags transfer = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    TriggerImage &info = g_images[image];
+    info.device = device;
+    info.format = pCreateInfo->format;
+    info.extent = pCreateInfo->extent;
+    info.mipLevels = pCreateInfo->mipLevels;
+    info.arrayLayers = pCreateInfo->arrayLayers;
+    info.copyable = (pCreateInfo->usage & transfer) == transfer && pCreateInfo->samples == VK_SAMPLE_COUNT_1_BIT &&
+                    !(pCreateInfo->flags & VK_IMAGE_CREATE_SPARSE_BINDING_BIT) && trigger_format_copyable(pCreateInfo->format);
+    info.memory = VK_NULL_HANDLE;
+    info.layout = pCreateInfo->initialLayout;
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_image_bound(VkImage image, VkDeviceMemory memory, VkDeviceSize offset)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    auto it = g_images.find(image);
+    if (it != g_images.end())
+        it->second.memory = memory;
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_image_destroyed(VkImage image)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    g_images.erase(image);
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_image_view_created(const VkImageViewCreateInfo *pCreateInfo, VkImageView view)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    g_imageViews[view] = pCreateInfo->image;
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_image_view_destroyed(VkImageView view)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    g_imageViews.erase(view);
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_framebuffer_created(const VkFramebufferCreateInfo *pCreateInfo, VkFramebuffer framebuffer)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    std::vector<VkImage> &images = g_framebuffers[framebuffer];
+    images.clear();
+    for (uint32_t i = 0; i < pCreateInfo->attachmentCount; i++)
+    {
+        auto it = g_imageViews.find(pCreateInfo->pAttachments[i]);
+        images.push_back(it != g_imageViews.end() ? it->second : VK_NULL_HANDLE);
+    }
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_framebuffer_destroyed(VkFramebuffer framebuffer)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    g_framebuffers.erase(framebuffer);
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_render_pass_created(const VkRenderPassCreateInfo *pCreateInfo, VkRenderPass renderPass)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    std::vector<VkImageLayout> &layouts = g_renderPasses[renderPass];
+    layouts.clear();
+    for (uint32_t i = 0; i < pCreateInfo->attachmentCount; i++)
+    {
+        layouts.push_back(pCreateInfo->pAttachments[i].finalLayout);
+    }
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_render_pass_destroyed(VkRenderPass renderPass)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    g_renderPasses.erase(renderPass);
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_event_created(VkDevice device, VkEvent event)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    g_events[event] = device;
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_event_destroyed(VkEvent event)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    g_events.erase(event);
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_semaphore_created(VkDevice device, VkSemaphore semaphore)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    TriggerSemaphore &info = g_semaphores[semaphore];
+    info.device = device;
+    info.signaled = false;
+    info.signaledInTrace = false;
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_semaphore_destroyed(VkSemaphore semaphore)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    g_semaphores.erase(semaphore);
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_command_buffers_allocated(const VkCommandBufferAllocateInfo *pAllocateInfo, const VkCommandBuffer *pCommandBuffers)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    for (uint32_t i = 0; i < pAllocateInfo->commandBufferCount; i++)
+    {
+        TriggerCommandBuffer &info = g_commandBuffers[pCommandBuffers[i]];
+        info.commandPool = pAllocateInfo->commandPool;
+        info.level = pAllocateInfo->level;
+        trigger_delete_packets(info.packets);
+        info.layouts.clear();
+    }
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_command_buffers_freed(uint32_t commandBufferCount, const VkCommandBuffer *pCommandBuffers)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    for (uint32_t i = 0; i < commandBufferCount; i++)
+    {
+        auto it = g_commandBuffers.find(pCommandBuffers[i]);
+        if (it != g_commandBuffers.end())
+        {
+            trigger_delete_packets(it->second.packets);
+            g_commandBuffers.erase(it);
+        }
+    }
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_command_pool_reset(VkCommandPool commandPool, bool destroyed)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    for (auto it = g_commandBuffers.begin(); it != g_commandBuffers.end();)
+    {
+        if (it->second.commandPool != commandPool)
+        {
+            ++it;
+            continue;
+        }
+        trigger_delete_packets(it->second.packets);
+        it->second.layouts.clear();
+        if (destroyed)
+            it = g_commandBuffers.erase(it);
+        else
+            ++it;
+    }
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_image_barriers_recorded(VkCommandBuffer commandBuffer, uint32_t barrierCount, const VkImageMemoryBarrier *pBarriers)
+{
+    if (!trigger_enabled() || barrierCount == 0)
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    auto it = g_commandBuffers.find(commandBuffer);
+    for (uint32_t i = 0; i < barrierCount && it != g_commandBuffers.end(); i++)
+    {
+        if (g_images.count(pBarriers[i].image) != 0)
+            it->second.layouts.push_back(std::make_pair(pBarriers[i].image, pBarriers[i].newLayout));
+    }
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_render_pass_recorded(VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo *pRenderPassBegin)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    auto cb = g_commandBuffers.find(commandBuffer);
+    auto framebuffer = g_framebuffers.find(pRenderPassBegin->framebuffer);
+    auto renderPass = g_renderPasses.find(pRenderPassBegin->renderPass);
+    if (cb != g_commandBuffers.end() && framebuffer != g_framebuffers.end() && renderPass != g_renderPasses.end())
+    {
+        const std::vector<VkImage> &images = framebuffer->second;
+        const std::vector<VkImageLayout> &layouts = renderPass->second;
+        for (size_t i = 0; i < images.size() && i < layouts.size(); i++)
+        {
+            if (g_images.count(images[i]) != 0)
+                cb->second.layouts.push_back(std::make_pair(images[i], layouts[i]));
+        }
+    }
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_commands_executed(VkCommandBuffer commandBuffer, uint32_t commandBufferCount, const VkCommandBuffer *pCommandBuffers)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    auto primary = g_commandBuffers.find(commandBuffer);
+    for (uint32_t i = 0; i < commandBufferCount && primary != g_commandBuffers.end(); i++)
+    {
+        auto secondary = g_commandBuffers.find(pCommandBuffers[i]);
+        if (secondary != g_commandBuffers.end())
+            primary->second.layouts.insert(primary->second.layouts.end(), secondary->second.layouts.begin(), secondary->second.layouts.end());
+    }
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+// caller must hold g_triggerLock
+static void trigger_set_semaphores(uint32_t semaphoreCount, const VkSemaphore *pSemaphores, bool signaled, bool traced)
+{
+    for (uint32_t i = 0; i < semaphoreCount; i++)
+    {
+        auto it = g_semaphores.find(pSemaphores[i]);
+        if (it == g_semaphores.end())
+            continue;
+        it->second.signaled = signaled;
+        if (traced)
+            it->second.signaledInTrace = signaled;
+    }
+}
+
+void trigger_queue_submitted(uint32_t submitCount, const VkSubmitInfo *pSubmits, bool traced)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    for (uint32_t i = 0; i < submitCount; i++)
+    {
+        trigger_set_semaphores(pSubmits[i].waitSemaphoreCount, pSubmits[i].pWaitSemaphores, false, traced);
+        for (uint32_t j = 0; j < pSubmits[i].commandBufferCount; j++)
+        {
+            auto cb = g_commandBuffers.find(pSubmits[i].pCommandBuffers[j]);
+            if (cb == g_commandBuffers.end())
+                continue;
+            for (size_t k = 0; k < cb->second.layouts.size(); k++)
+            {
+                auto image = g_images.find(cb->second.layouts[k].first);
+                if (image != g_images.end())
+                    image->second.layout = cb->second.layouts[k].second;
+            }
+        }
+        trigger_set_semaphores(pSubmits[i].signalSemaphoreCount, pSubmits[i].pSignalSemaphores, true, traced);
+    }
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_sparse_bound(uint32_t bindInfoCount, const VkBindSparseInfo *pBindInfo)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    for (uint32_t i = 0; i < bindInfoCount; i++)
+    {
+        trigger_set_semaphores(pBindInfo[i].waitSemaphoreCount, pBindInfo[i].pWaitSemaphores, false, true);
+        trigger_set_semaphores(pBindInfo[i].signalSemaphoreCount, pBindInfo[i].pSignalSemaphores, true, true);
+    }
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_semaphore_signaled(VkSemaphore semaphore, bool traced)
+{
+    if (!trigger_enabled() || semaphore == VK_NULL_HANDLE)
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    trigger_set_semaphores(1, &semaphore, true, traced);
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+void trigger_semaphores_waited(uint32_t semaphoreCount, const VkSemaphore *pSemaphores, bool traced)
+{
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    trigger_set_semaphores(semaphoreCount, pSemaphores, false, traced);
+    vktrace_leave_critical_section(&g_triggerLock);
+}
+
+// A buffer or image whose contents the preamble copies through a staging buffer.
+struct TriggerCopy
+{
+    VkBuffer buffer;
+    VkImage image;
+    VkImageLayout layout;
+    VkImageAspectFlags aspects;
+    VkDeviceSize size;
+    std::vector<VkBufferImageCopy> regions;
+};
+
+static void trigger_image_regions(const TriggerImage &image, TriggerCopy *pCopy)
+{
+    VkImageAspectFlagBits aspects[] = {VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_ASPECT_DEPTH_BIT, VK_IMAGE_ASPECT_STENCIL_BIT};
+    uint32_t bytes, blockWidth, blockHeight;
+    pCopy->size = 0;
+    pCopy->aspects = trigger_format_aspects(image.format);
+    for (uint32_t a = 0; a < sizeof(aspects) / sizeof(aspects[0]); a++)
+    {
+        if (!(pCopy->aspects & aspects[a]) || !trigger_format_block(image.format, aspects[a], &bytes, &blockWidth, &blockHeight))
+            continue;
+        for (uint32_t mip = 0; mip < image.mipLevels; mip++)
+        {
+            VkBufferImageCopy region;
+            VkDeviceSize alignment = bytes * 4;
+            memset(&region, 0, sizeof(region));
+            region.bufferOffset = (pCopy->size + alignment - 1) / alignment * alignment;
+            region.imageSubresource.aspectMask = aspects[a];
+            region.imageSubresource.mipLevel = mip;
+            region.imageSubresource.layerCount = image.arrayLayers;
+            region.imageExtent.width = image.extent.width >> mip ? image.extent.width >> mip : 1;
+            region.imageExtent.height = image.extent.height >> mip ? image.extent.height >> mip : 1;
+            region.imageExtent.depth = image.extent.depth >> mip ? image.extent.depth >> mip : 1;
+            pCopy->size = region.bufferOffset + (VkDeviceSize) bytes * image.arrayLayers * region.imageExtent.depth *
+                          ((region.imageExtent.width + blockWidth - 1) / blockWidth) *
+                          ((region.imageExtent.height + blockHeight - 1) / blockHeight);
+            pCopy->regions.push_back(region);
+        }
+    }
+}
+
+static VkImageMemoryBarrier trigger_image_barrier(VkImage image, VkImageAspectFlags aspects, VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+                                                  VkImageLayout oldLayout, VkImageLayout newLayout)
+{
+    VkImageMemoryBarrier barrier;
+    memset(&barrier, 0, sizeof(barrier));
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = aspects;
+    barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+    barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+    return barrier;
+}
+
+static VkMemoryBarrier trigger_memory_barrier(VkAccessFlags srcAccess, VkAccessFlags dstAccess)
+{
+    VkMemoryBarrier barrier;
+    memset(&barrier, 0, sizeof(barrier));
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+    return barrier;
+}
+
+// Creates a host visible buffer for copy in the trace.
+static bool trigger_create_staging(VkDevice device, const TriggerDevice &deviceInfo, const TriggerCopy &copy, VkBuffer *pBuffer, VkDeviceMemory *pMemory)
+{
+    const VkMemoryPropertyFlags hostFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    VkBufferCreateInfo createInfo;
+    VkMemoryAllocateInfo allocateInfo;
+    VkMemoryRequirements requirements;
+    memset(&createInfo, 0, sizeof(createInfo));
+    createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    createInfo.size = copy.size;
+    createInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (__HOOKED_vkCreateBuffer(device, &createInfo, NULL, pBuffer) != VK_SUCCESS)
+        return false;
+
+    __HOOKED_vkGetBufferMemoryRequirements(device, *pBuffer, &requirements);
+    memset(&allocateInfo, 0, sizeof(allocateInfo));
+    allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocateInfo.allocationSize = requirements.size;
+    allocateInfo.memoryTypeIndex = UINT32_MAX;
+    for (uint32_t i = 0; i < deviceInfo.memoryProperties.memoryTypeCount; i++)
+    {
+        if ((requirements.memoryTypeBits & (1 << i)) && (deviceInfo.memoryProperties.memoryTypes[i].propertyFlags & hostFlags) == hostFlags)
+        {
+            allocateInfo.memoryTypeIndex = i;
+            break;
+        }
+    }
+    if (allocateInfo.memoryTypeIndex == UINT32_MAX || __HOOKED_vkAllocateMemory(device, &allocateInfo, NULL, pMemory) != VK_SUCCESS)
+    {
+        __HOOKED_vkDestroyBuffer(device, *pBuffer, NULL);
+        return false;
+    }
+    if (__HOOKED_vkBindBufferMemory(device, *pBuffer, *pMemory, 0) != VK_SUCCESS)
+    {
+        __HOOKED_vkDestroyBuffer(device, *pBuffer, NULL);
+        __HOOKED_vkFreeMemory(device, *pMemory, NULL);
+        return false;
+    }
+    return true;
+}
+
+// Copies the contents of copy into staging without tracing it.
+static VkResult trigger_read_back(VkQueue queue, VkCommandBuffer commandBuffer, const TriggerCopy &copy, VkBuffer staging)
+{
+    VkLayerDispatchTable *pTable = &mdd(queue)->devTable;
+    VkCommandBufferBeginInfo beginInfo;
+    VkSubmitInfo submitInfo;
+    VkMemoryBarrier hostBarrier = trigger_memory_barrier(VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_HOST_READ_BIT);
+    VkResult result;
+    memset(&beginInfo, 0, sizeof(beginInfo));
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    result = pTable->BeginCommandBuffer(commandBuffer, &beginInfo);
+    if (result != VK_SUCCESS)
+        return result;
+
+    if (copy.image != VK_NULL_HANDLE)
+    {
+        VkImageMemoryBarrier toTransfer = trigger_image_barrier(copy.image, copy.aspects, VK_ACCESS_MEMORY_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                                                                copy.layout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+        VkImageMemoryBarrier fromTransfer = trigger_image_barrier(copy.image, copy.aspects, VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT,
+                                                                  VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, copy.layout);
+        pTable->CmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1, &toTransfer);
+        pTable->CmdCopyImageToBuffer(commandBuffer, copy.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, staging, (uint32_t) copy.regions.size(), copy.regions.data());
+        pTable->CmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, NULL, 0, NULL, 1, &fromTransfer);
+    }
+    else
+    {
+        VkMemoryBarrier toTransfer = trigger_memory_barrier(VK_ACCESS_MEMORY_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+        VkBufferCopy region = {0, 0, copy.size};
+        pTable->CmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &toTransfer, 0, NULL, 0, NULL);
+        pTable->CmdCopyBuffer(commandBuffer, copy.buffer, staging, 1, &region);
+    }
+    pTable->CmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &hostBarrier, 0, NULL, 0, NULL);
+    result = pTable->EndCommandBuffer(commandBuffer);
+    if (result != VK_SUCCESS)
+        return result;
+
+    memset(&submitInfo, 0, sizeof(submitInfo));
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    result = pTable->QueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+    if (result != VK_SUCCESS)
+        return result;
+    return pTable->QueueWaitIdle(queue);
+}
+
+// Copies staging back into copy in the trace. Replay finds the image in the layout it was created in, the
+// contents are replaced entirely so it starts from VK_IMAGE_LAYOUT_UNDEFINED.
+static void trigger_restore(VkQueue queue, VkCommandBuffer commandBuffer, const TriggerCopy &copy, VkBuffer staging)
+{
+    VkCommandBufferBeginInfo beginInfo;
+    VkSubmitInfo submitInfo;
+    memset(&beginInfo, 0, sizeof(beginInfo));
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    __HOOKED_vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    if (copy.image != VK_NULL_HANDLE)
+    {
+        VkImageMemoryBarrier toTransfer = trigger_image_barrier(copy.image, copy.aspects, 0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                                                VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        VkImageMemoryBarrier fromTransfer = trigger_image_barrier(copy.image, copy.aspects, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT,
+                                                                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, copy.layout);
+        __HOOKED_vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1, &toTransfer);
+        __HOOKED_vkCmdCopyBufferToImage(commandBuffer, staging, copy.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t) copy.regions.size(), copy.regions.data());
+        __HOOKED_vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, NULL, 0, NULL, 1, &fromTransfer);
+    }
+    else
+    {
+        VkMemoryBarrier fromTransfer = trigger_memory_barrier(VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT);
+        VkBufferCopy region = {0, 0, copy.size};
+        __HOOKED_vkCmdCopyBuffer(commandBuffer, staging, copy.buffer, 1, &region);
+        __HOOKED_vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &fromTransfer, 0, NULL, 0, NULL);
+    }
+    __HOOKED_vkEndCommandBuffer(commandBuffer);
+
+    memset(&submitInfo, 0, sizeof(submitInfo));
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    __HOOKED_vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+    __HOOKED_vkQueueWaitIdle(queue);
+}
+
+static void trigger_trace_copies(VkQueue queue, uint32_t family, VkDevice device, const TriggerDevice &deviceInfo, const std::vector<TriggerCopy> &copies)
+{
+    VkCommandPoolCreateInfo poolInfo;
+    VkCommandBufferAllocateInfo allocateInfo;
+    VkCommandPool commandPool;
+    VkCommandBuffer commandBuffer;
+    memset(&poolInfo, 0, sizeof(poolInfo));
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = family;
+    if (__HOOKED_vkCreateCommandPool(device, &poolInfo, NULL, &commandPool) != VK_SUCCESS)
+    {
+        vktrace_LogWarning("Failed to create a command pool, buffer and image contents are not in the trace.");
+        return;
+    }
+    memset(&allocateInfo, 0, sizeof(allocateInfo));
+    allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocateInfo.commandPool = commandPool;
+    allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocateInfo.commandBufferCount = 1;
+    if (__HOOKED_vkAllocateCommandBuffers(device, &allocateInfo, &commandBuffer) != VK_SUCCESS)
+    {
+        vktrace_LogWarning("Failed to allocate a command buffer, buffer and image contents are not in the trace.");
+        __HOOKED_vkDestroyCommandPool(device, commandPool, NULL);
+        return;
+    }
+    // the loader is not in the way to set up the dispatch of a command buffer allocated by a layer
+    *(void **) commandBuffer = *(void **) device;
+
+    for (size_t i = 0; i < copies.size(); i++)
+    {
+        VkBuffer staging;
+        VkDeviceMemory stagingMemory;
+        if (!trigger_create_staging(device, deviceInfo, copies[i], &staging, &stagingMemory))
+        {
+            vktrace_LogWarning("Failed to create a staging buffer, the contents of a buffer or image are not in the trace.");
+            continue;
+        }
+        if (trigger_read_back(queue, commandBuffer, copies[i], staging) == VK_SUCCESS)
+        {
+            trace_memory_contents(device, stagingMemory);
+            trigger_restore(queue, commandBuffer, copies[i], staging);
+        }
+        else
+        {
+            vktrace_LogWarning("Failed to read back the contents of a buffer or image, they are not in the trace.");
+        }
+        __HOOKED_vkDestroyBuffer(device, staging, NULL);
+        __HOOKED_vkFreeMemory(device, stagingMemory, NULL);
+    }
+    __HOOKED_vkDestroyCommandPool(device, commandPool, NULL);
+}
+
+void trigger_trace_device_state(VkQueue queue)
+{
+    const VkQueueFlags copyQueueFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;
+    VkDevice device = VK_NULL_HANDLE;
+    uint32_t family = 0;
+    TriggerDevice deviceInfo;
+    bool canCopy = false;
+    bool canCopyDepthStencil = false;
+    std::vector<VkDeviceMemory> hostMemories;
+    std::vector<TriggerCopy> copies;
+    std::vector<VkEvent> events;
+    std::vector<VkSemaphore> waitSemaphores;
+    std::vector<VkSemaphore> signalSemaphores;
+    if (!trigger_enabled())
+        return;
+
+    vktrace_enter_critical_section(&g_triggerLock);
+    auto queueInfo = g_queues.find(queue);
+    if (queueInfo != g_queues.end() && g_devices.count(queueInfo->second.device) != 0)
+    {
+        device = queueInfo->second.device;
+        family = queueInfo->second.family;
+        deviceInfo = g_devices[device];
+        if (family < deviceInfo.queueFamilies.size())
+        {
+            VkQueueFlags flags = deviceInfo.queueFamilies[family].queueFlags;
+            canCopy = (flags & copyQueueFlags) != 0;
+            canCopyDepthStencil = (flags & VK_QUEUE_GRAPHICS_BIT) != 0;
+        }
+    }
+    if (device == VK_NULL_HANDLE)
+    {
+        vktrace_leave_critical_section(&g_triggerLock);
+        vktrace_LogWarning("The device of the presenting queue is unknown, its state is not in the trace.");
+        return;
+    }
+    for (auto it = g_memories.begin(); it != g_memories.end(); ++it)
+    {
+        if (it->second.device == device &&
+            (deviceInfo.memoryProperties.memoryTypes[it->second.memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+            hostMemories.push_back(it->first);
+    }
+    for (auto it = g_buffers.begin(); it != g_buffers.end() && canCopy; ++it)
+    {
+        // buffers in host visible memory are in the trace with their memory
+        auto memory = g_memories.find(it->second.memory);
+        if (it->second.device != device || !it->second.copyable || memory == g_memories.end() ||
+            (deviceInfo.memoryProperties.memoryTypes[memory->second.memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+            continue;
+        TriggerCopy copy;
+        copy.buffer = it->first;
+        copy.image = VK_NULL_HANDLE;
+        copy.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        copy.aspects = 0;
+        copy.size = it->second.size;
+        copies.push_back(copy);
+    }
+    for (auto it = g_images.begin(); it != g_images.end() && canCopy; ++it)
+    {
+        // images in a layout that has no defined contents are left out, and so are images that replay leaves
+        // in the layout they were created in
+        const TriggerImage &image = it->second;
+        if (image.device != device || !image.copyable || g_memories.count(image.memory) == 0 ||
+            image.layout == VK_IMAGE_LAYOUT_UNDEFINED || image.layout == VK_IMAGE_LAYOUT_PREINITIALIZED ||
+            (!canCopyDepthStencil && trigger_format_aspects(image.format) != VK_IMAGE_ASPECT_COLOR_BIT))
+            continue;
+        TriggerCopy copy;
+        copy.buffer = VK_NULL_HANDLE;
+        copy.image = it->first;
+        copy.layout = image.layout;
+        trigger_image_regions(image, &copy);
+        copies.push_back(copy);
+    }
+    for (auto it = g_events.begin(); it != g_events.end(); ++it)
+    {
+        if (it->second == device)
+            events.push_back(it->first);
+    }
+    for (auto it = g_semaphores.begin(); it != g_semaphores.end(); ++it)
+    {
+        if (it->second.device != device || it->second.signaled == it->second.signaledInTrace)
+            continue;
+        if (it->second.signaledInTrace)
+            waitSemaphores.push_back(it->first);
+        else
+            signalSemaphores.push_back(it->first);
+        it->second.signaledInTrace = it->second.signaled;
+    }
+    vktrace_leave_critical_section(&g_triggerLock);
+
+    // the preamble reads what the GPU wrote, and replaces it with the same contents in the trace
+    mdd(device)->devTable.DeviceWaitIdle(device);
+    for (size_t i = 0; i < hostMemories.size(); i++)
+    {
+        // memory that the app has mapped is in the trace already
+        VKAllocInfo *entry = find_mem_info_entry_lock(hostMemories[i]);
+        if (entry != NULL && entry->pData == NULL)
+            trace_memory_contents(device, hostMemories[i]);
+    }
+    if (!copies.empty())
+        trigger_trace_copies(queue, family, device, deviceInfo, copies);
+
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        VkResult status = mdd(device)->devTable.GetEventStatus(device, events[i]);
+        if (status == VK_EVENT_SET)
+            __HOOKED_vkSetEvent(device, events[i]);
+        else if (status == VK_EVENT_RESET)
+            __HOOKED_vkResetEvent(device, events[i]);
+    }
+
+    if (!waitSemaphores.empty() || !signalSemaphores.empty())
+    {
+        // only replay executes this submit, the semaphores are already in this state
+        std::vector<VkPipelineStageFlags> waitStages(waitSemaphores.size(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+        vktrace_trace_packet_header *pHeader;
+        VkSubmitInfo submitInfo;
+        memset(&submitInfo, 0, sizeof(submitInfo));
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.waitSemaphoreCount = (uint32_t) waitSemaphores.size();
+        submitInfo.pWaitSemaphores = waitSemaphores.data();
+        submitInfo.pWaitDstStageMask = waitStages.data();
+        submitInfo.signalSemaphoreCount = (uint32_t) signalSemaphores.size();
+        submitInfo.pSignalSemaphores = signalSemaphores.data();
+        pHeader = create_queue_submit_packet(queue, 1, &submitInfo, VK_NULL_HANDLE);
+        vktrace_set_packet_entrypoint_end_time(pHeader);
+        interpret_body_as_vkQueueSubmit(pHeader)->result = VK_SUCCESS;
+        FINISH_TRACE_PACKET();
+    }
+}
@@ -0,0 +1,104 @@
+/*
+ *
+ * Copyright (C) 2016 Valve Corporation
+ * Copyright (C) 2016 LunarG, Inc.
+ * All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "vulkan/vulkan.h"
+#include "vktrace_trace_packet_identifiers.h"
+
+// Trigger capture, enabled by setting VKTRACE_TRIGGER_FRAME=<frame>, VKTRACE_TRIGGER_SIGNAL=1 (Linux,
+// SIGUSR1) or VKTRACE_TRIGGER_HOTKEY=1 (Windows, F12).
+// The capture window opens at the first frame boundary after the trigger and stays open for
+// VKTRACE_TRIGGER_FRAMES frames (1 by default). Outside the window only the calls that create, destroy,
+// bind and update objects are traced, so that the trace can rebuild everything that is alive when the
+// window opens. Submits, presents, waits, status queries and flushes go straight down the chain, and
+// command buffer recording is kept in memory with its command buffer instead of being written.
+// When the window opens the trace gets a preamble that brings replay to the app's current state:
+// the kept recording of every live command buffer, the contents of host visible memory, the contents
+// of device local buffers and images (read back through staging buffers and written again with traced
+// copies), the state of events, and a submit that signals or waits the semaphores whose state changed
+// in untraced calls.
+
+// false while trigger capture is enabled and the capture window is closed
+bool trigger_in_capture_window();
+
+// Counts a presented frame and closes the window when it has captured enough frames. Returns true
+// when the window should open for the next frame; the caller then calls trigger_open_capture_window()
+// and writes the preamble.
+bool trigger_end_frame();
+
+// Opens the window and writes the recording kept for every live command buffer.
+void trigger_open_capture_window();
+
+// Writes the rest of the preamble for the device of queue, which the calling thread owns.
+void trigger_trace_device_state(VkQueue queue);
+
+// Replay waits for a fence only if the trace holds the call that last signals it. fence was just
+// signaled (or destroyed, with traced false) by a call that is, or is not, in the trace.
+void trigger_fence_signaled(VkFence fence, bool traced);
+
+// true if replay will see all of pFences signaled; waits on other fences are left out of the trace
+bool trigger_fences_signaled_in_trace(uint32_t fenceCount, const VkFence *pFences);
+
+// Finishes the packet of a command buffer recording call in place of FINISH_TRACE_PACKET(). Outside the
+// window the packet is kept with commandBuffer until the window opens; *ppHeader is NULL afterwards.
+void trigger_finish_recording_packet(VkCommandBuffer commandBuffer, vktrace_trace_packet_header **ppHeader);
+
+// Buffers and images get the transfer usages that the preamble needs to copy their contents. The
+// returned create info is pCreateInfo or *pLocal.
+const VkBufferCreateInfo *trigger_buffer_create_info(const VkBufferCreateInfo *pCreateInfo, VkBufferCreateInfo *pLocal);
+const VkImageCreateInfo *trigger_image_create_info(VkDevice device, const VkImageCreateInfo *pCreateInfo, VkImageCreateInfo *pLocal);
+
+// Object tracking for the preamble.
+void trigger_device_created(VkPhysicalDevice physicalDevice, VkDevice device);
+void trigger_device_destroyed(VkDevice device);
+void trigger_queue_created(VkDevice device, uint32_t queueFamilyIndex, VkQueue queue);
+void trigger_memory_allocated(VkDevice device, const VkMemoryAllocateInfo *pAllocateInfo, VkDeviceMemory memory);
+void trigger_memory_freed(VkDeviceMemory memory);
+void trigger_buffer_created(VkDevice device, const VkBufferCreateInfo *pCreateInfo, VkBuffer buffer);
+void trigger_buffer_bound(VkBuffer buffer, VkDeviceMemory memory, VkDeviceSize offset);
+void trigger_buffer_destroyed(VkBuffer buffer);
+void trigger_image_created(VkDevice device, const VkImageCreateInfo *pCreateInfo, VkImage image);
+void trigger_image_bound(VkImage image, VkDeviceMemory memory, VkDeviceSize offset);
+void trigger_image_destroyed(VkImage image);
+void trigger_image_view_created(const VkImageViewCreateInfo *pCreateInfo, VkImageView view);
+void trigger_image_view_destroyed(VkImageView view);
+void trigger_framebuffer_created(const VkFramebufferCreateInfo *pCreateInfo, VkFramebuffer framebuffer);
+void trigger_framebuffer_destroyed(VkFramebuffer framebuffer);
+void trigger_render_pass_created(const VkRenderPassCreateInfo *pCreateInfo, VkRenderPass renderPass);
+void trigger_render_pass_destroyed(VkRenderPass renderPass);
+void trigger_event_created(VkDevice device, VkEvent event);
+void trigger_event_destroyed(VkEvent event);
+void trigger_semaphore_created(VkDevice device, VkSemaphore semaphore);
+void trigger_semaphore_destroyed(VkSemaphore semaphore);
+void trigger_command_buffers_allocated(const VkCommandBufferAllocateInfo *pAllocateInfo, const VkCommandBuffer *pCommandBuffers);
+void trigger_command_buffers_freed(uint32_t commandBufferCount, const VkCommandBuffer *pCommandBuffers);
+// drops the command buffers of commandPool, or only their recording if the pool is reset
+void trigger_command_pool_reset(VkCommandPool commandPool, bool destroyed);
+
+// Image layouts are followed through the barriers and render passes recorded in command buffers, and
+// take effect when the command buffers are submitted.
+void trigger_image_barriers_recorded(VkCommandBuffer commandBuffer, uint32_t barrierCount, const VkImageMemoryBarrier *pBarriers);
+void trigger_render_pass_recorded(VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo *pRenderPassBegin);
+void trigger_commands_executed(VkCommandBuffer commandBuffer, uint32_t commandBufferCount, const VkCommandBuffer *pCommandBuffers);
+
+// Submits, binds, acquires and presents, traced or not.
+void trigger_queue_submitted(uint32_t submitCount, const VkSubmitInfo *pSubmits, bool traced);
+void trigger_sparse_bound(uint32_t bindInfoCount, const VkBindSparseInfo *pBindInfo);
+void trigger_semaphore_signaled(VkSemaphore semaphore, bool traced);
+void trigger_semaphores_waited(uint32_t semaphoreCount, const VkSemaphore *pSemaphores, bool traced);
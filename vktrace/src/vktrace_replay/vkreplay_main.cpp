@@ -27,6 +27,7 @@
 #include "vktrace_tracelog.h"
 #include "vktrace_filelike.h"
 #include "vktrace_trace_packet_utils.h"
+#include "vktrace_compressed_file.h"
 #include "vkreplay_main.h"
 #include "vkreplay_factory.h"
 #include "vkreplay_seq.h"
@@ -56,7 +57,8 @@ vktrace_SettingGroup g_replaySettingGroup =
 };
 
 namespace vktrace_replay {
-int main_loop(Sequencer &seq, vktrace_trace_packet_replay_library *replayerArray[], vkreplayer_settings settings)
+// pLoopStart, if not NULL, is where the trace's frame index says the loop start frame begins
+int main_loop(AbstractSequencer &seq, vktrace_trace_packet_replay_library *replayerArray[], vkreplayer_settings settings, const seqBookmark* pLoopStart)
 {
     int err = 0;
     vktrace_trace_packet_header *packet;
@@ -71,6 +73,10 @@ int main_loop(Sequencer &seq, vktrace_trace_packet_replay_library *replayerArray
     // record the location of looping start packet
     seq.record_bookmark();
     seq.get_bookmark(startingPacket);
+    if (pLoopStart != NULL)
+    {
+        startingPacket = *pLoopStart;
+    }
     while (settings.numLoops > 0)
     {
         while ((packet = seq.get_next_packet()) != NULL && trace_running)
@@ -118,7 +124,7 @@ int main_loop(Sequencer &seq, vktrace_trace_packet_replay_library *replayerArray
                         {
                             prevFrameNumber = frameNumber;
 
-                            if (frameNumber == settings.loopStartFrame)
+                            if (frameNumber == settings.loopStartFrame && pLoopStart == NULL)
                             {
                                 // record the location of looping start packet
                                 seq.record_bookmark();
@@ -274,6 +280,26 @@ int main(int argc, char **argv)
         vktrace_LogError("Trace file version %u is older than minimum compatible version (%u).\nYou'll need to make a new trace file, or use an older replayer.", fileHeader.trace_file_version, VKTRACE_TRACE_FILE_VERSION_MINIMUM_COMPATIBLE);
     }
 
+    // Packets of compressed trace files are read through the chunk decompressor
+    vktrace_compressed_file* pCompressedFile = NULL;
+    FileLike* compressedTraceFile = NULL;
+    if (fileHeader.trace_file_version == VKTRACE_TRACE_FILE_VERSION_4)
+    {
+        pCompressedFile = vktrace_compressed_file_open(tracefp, fileHeader.first_packet_offset);
+        compressedTraceFile = vktrace_FileLike_create_compressed_file(pCompressedFile);
+        if (compressedTraceFile == NULL)
+        {
+            vktrace_LogError("Unable to read compressed trace file.");
+            if (pAllSettings != NULL)
+            {
+                vktrace_SettingGroup_Delete_Loaded(&pAllSettings, &numAllSettings);
+            }
+            VKTRACE_DELETE(traceFile);
+            return 1;
+        }
+        vktrace_LogVerbose("Compressed trace file indexes %llu frames.", (unsigned long long)vktrace_compressed_file_get_frame_count(pCompressedFile));
+    }
+
     // load any API specific driver libraries and init replayer objects
     uint8_t tidApi = VKTRACE_TID_RESERVED;
     vktrace_trace_packet_replay_library* replayer[VKTRACE_MAX_TRACER_ID_ARRAY_SIZE];
@@ -344,8 +370,32 @@ int main(int argc, char **argv)
     }
  
     // main loop
-    Sequencer sequencer(traceFile);
-    err = vktrace_replay::main_loop(sequencer, replayer, replaySettings);
+    // Packets are handed out straight from a mapping of the trace file when
+    // possible; otherwise they are read one at a time.
+    MappedSequencer* pMappedSequencer = NULL;
+    if (pCompressedFile == NULL)
+    {
+        pMappedSequencer = new MappedSequencer(tracefp, sizeof(fileHeader));
+        if (!pMappedSequencer->is_mapped())
+        {
+            delete pMappedSequencer;
+            pMappedSequencer = NULL;
+        }
+    }
+    Sequencer streamSequencer((compressedTraceFile != NULL) ? compressedTraceFile : traceFile);
+    AbstractSequencer &sequencer = (pMappedSequencer != NULL) ? (AbstractSequencer &) *pMappedSequencer : (AbstractSequencer &) streamSequencer;
+    // compressed traces know where each frame starts, so looping goes straight back to the chunk holding it
+    seqBookmark loopStart;
+    uint64_t loopStartOffset;
+    bool haveLoopStart = pCompressedFile != NULL && replaySettings.loopStartFrame > 0 &&
+                         vktrace_compressed_file_get_frame_offset(pCompressedFile, (uint64_t)replaySettings.loopStartFrame, &loopStartOffset);
+    if (haveLoopStart)
+    {
+        loopStart.file_offset = loopStartOffset;
+        vktrace_LogVerbose("Loop start frame %d begins at offset %llu of the compressed trace.", replaySettings.loopStartFrame, (unsigned long long)loopStartOffset);
+    }
+    err = vktrace_replay::main_loop(sequencer, replayer, replaySettings, haveLoopStart ? &loopStart : NULL);
+    delete pMappedSequencer;
 
     for (int i = 0; i < VKTRACE_MAX_TRACER_ID_ARRAY_SIZE; i++)
     {
@@ -356,6 +406,12 @@ int main(int argc, char **argv)
         }
     }
 
+    if (pCompressedFile != NULL)
+    {
+        VKTRACE_DELETE(compressedTraceFile);
+        vktrace_compressed_file_close(&pCompressedFile);
+    }
+
     if (pAllSettings != NULL)
     {
         vktrace_SettingGroup_Delete_Loaded(&pAllSettings, &numAllSettings);
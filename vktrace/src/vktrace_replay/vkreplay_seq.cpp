@@ -24,6 +24,13 @@ extern "C" {
 #include "vktrace_trace_packet_utils.h"
 }
 
+#if defined(PLATFORM_LINUX)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#elif defined(WIN32)
+#include <io.h>
+#endif
+
 namespace vktrace_replay {
 
 vktrace_trace_packet_header * Sequencer::get_next_packet()
@@ -41,12 +48,149 @@ void Sequencer::get_bookmark(seqBookmark &bookmark) {
 
 
 void Sequencer::set_bookmark(const seqBookmark &bookmark) {
-    fseek(m_pFile->mFile, m_bookmark.file_offset, SEEK_SET);
+    vktrace_FileLike_Seek(m_pFile, bookmark.file_offset);
 }
 
 void Sequencer::record_bookmark()
 {
-    m_bookmark.file_offset = ftell(m_pFile->mFile);
+    m_bookmark.file_offset = vktrace_FileLike_Tell(m_pFile);
+}
+
+// consumed packets are given back to the kernel in steps of this many bytes
+static const uint64_t kReleaseStep = 16 * 1024 * 1024;
+
+MappedSequencer::MappedSequencer(FILE* pFile, uint64_t firstPacketOffset)
+    : m_pFile(pFile), m_pData(NULL), m_fileSize(0), m_offset(firstPacketOffset), m_releasedOffset(0)
+{
+#if defined(WIN32)
+    m_mapping = NULL;
+#endif
+    m_bookmark.file_offset = firstPacketOffset;
+    if (!map_file())
+        vktrace_LogVerbose("Unable to map trace file, falling back to reading it.");
+}
+
+MappedSequencer::~MappedSequencer()
+{
+    unmap_file();
+}
+
+bool MappedSequencer::map_file()
+{
+#if defined(PLATFORM_LINUX)
+    struct stat fileStat;
+    int fd = fileno(m_pFile);
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+        return false;
+    if ((uint64_t)fileStat.st_size > (uint64_t)SIZE_MAX)
+        return false;
+    m_fileSize = (uint64_t)fileStat.st_size;
+
+    void* pData = mmap(NULL, (size_t)m_fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (pData == MAP_FAILED)
+        return false;
+    madvise(pData, (size_t)m_fileSize, MADV_SEQUENTIAL);
+    m_pData = (uint8_t*)pData;
+    return true;
+#elif defined(WIN32)
+    LARGE_INTEGER size;
+    HANDLE hFile = (HANDLE)_get_osfhandle(_fileno(m_pFile));
+    if (hFile == INVALID_HANDLE_VALUE || !GetFileSizeEx(hFile, &size) || size.QuadPart == 0)
+        return false;
+    if ((uint64_t)size.QuadPart > (uint64_t)SIZE_MAX)
+        return false;
+    m_fileSize = (uint64_t)size.QuadPart;
+
+    m_mapping = CreateFileMapping(hFile, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if (m_mapping == NULL)
+        return false;
+    m_pData = (uint8_t*)MapViewOfFile(m_mapping, FILE_MAP_COPY, 0, 0, 0);
+    if (m_pData == NULL)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = NULL;
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void MappedSequencer::unmap_file()
+{
+    if (m_pData == NULL)
+        return;
+#if defined(PLATFORM_LINUX)
+    munmap(m_pData, (size_t)m_fileSize);
+#elif defined(WIN32)
+    UnmapViewOfFile(m_pData);
+    CloseHandle(m_mapping);
+    m_mapping = NULL;
+#endif
+    m_pData = NULL;
+}
+
+vktrace_trace_packet_header * MappedSequencer::get_next_packet()
+{
+    if (m_pData == NULL)
+        return NULL;
+    if (m_offset + sizeof(vktrace_trace_packet_header) > m_fileSize)
+        return NULL;
+
+    release_consumed();
+    vktrace_trace_packet_header* pHeader = (vktrace_trace_packet_header*)(m_pData + m_offset);
+    if (pHeader->size < sizeof(vktrace_trace_packet_header) || pHeader->size > m_fileSize - m_offset)
+    {
+        vktrace_LogError("Failed to read trace packet with size of %u.", pHeader->size);
+        return NULL;
+    }
+    m_offset += pHeader->size;
+
+    pHeader->pBody = (uintptr_t)pHeader + sizeof(vktrace_trace_packet_header);
+    return pHeader;
+}
+
+// Replay writes into the packets, so every page it has seen becomes a private copy and
+// the whole trace would end up resident. The packets before the next one are no longer
+// used, and a bookmark reads them from the file again, so their pages are dropped.
+void MappedSequencer::release_consumed()
+{
+#if defined(PLATFORM_LINUX)
+    uint64_t pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t end = m_offset & ~(pageSize - 1);
+    if (end < m_releasedOffset + kReleaseStep)
+        return;
+    madvise(m_pData + m_releasedOffset, (size_t)(end - m_releasedOffset), MADV_DONTNEED);
+    m_releasedOffset = end;
+#endif
+}
+
+void MappedSequencer::get_bookmark(seqBookmark &bookmark) {
+    bookmark.file_offset = m_bookmark.file_offset;
+}
+
+void MappedSequencer::set_bookmark(const seqBookmark &bookmark) {
+    // Packets past the bookmark were modified in place while they were replayed,
+    // so drop the private copies of those pages and get the file contents back.
+#if defined(PLATFORM_LINUX)
+    uint64_t pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t start = bookmark.file_offset & ~(pageSize - 1);
+    if (m_pData != NULL && start < m_fileSize)
+    {
+        madvise(m_pData + start, (size_t)(m_fileSize - start), MADV_DONTNEED);
+    }
+#else
+    unmap_file();
+    map_file();
+#endif
+    m_offset = bookmark.file_offset;
+    m_releasedOffset = 0;
+}
+
+void MappedSequencer::record_bookmark()
+{
+    m_bookmark.file_offset = m_offset;
 }
 
 } /* namespace vktrace_replay */
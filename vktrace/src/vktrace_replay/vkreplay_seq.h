@@ -33,7 +33,7 @@ namespace vktrace_replay {
 
 struct seqBookmark
 {
-    unsigned int file_offset;
+    uint64_t file_offset;
 };
 
 
@@ -45,6 +45,7 @@ struct seqBookmark
     virtual vktrace_trace_packet_header *get_next_packet() = 0;
     virtual void get_bookmark(seqBookmark &bookmark) = 0;
     virtual void set_bookmark(const seqBookmark &bookmark) = 0;
+    virtual void record_bookmark() = 0;
  };
 
 class Sequencer: public AbstractSequencer
@@ -66,6 +67,43 @@ private:
     
 };
 
+/* Sequencer that maps the whole trace file into memory and hands out packets
+ * in place, so no per-packet allocation or copy is needed. The mapping is
+ * copy-on-write because replay fixes up pointers inside the packets; going
+ * back to a bookmark throws those private pages away so the packets are
+ * read from the file again. Pages of packets that have been replayed are
+ * dropped as replay moves on, so memory use does not grow with the trace. */
+class MappedSequencer: public AbstractSequencer
+{
+
+public:
+    MappedSequencer(FILE* pFile, uint64_t firstPacketOffset);
+    ~MappedSequencer();
+
+    // false if the file could not be mapped; use Sequencer instead
+    bool is_mapped() const { return m_pData != NULL; }
+
+    vktrace_trace_packet_header *get_next_packet();
+    void get_bookmark(seqBookmark &bookmark);
+    void set_bookmark(const seqBookmark &bookmark);
+    void record_bookmark();
+
+private:
+    bool map_file();
+    void unmap_file();
+    void release_consumed();
+
+    FILE *m_pFile;
+    uint8_t *m_pData;
+    uint64_t m_fileSize;
+    uint64_t m_offset;
+    uint64_t m_releasedOffset;  // pages before this offset have been dropped
+    seqBookmark m_bookmark;
+#if defined(WIN32)
+    HANDLE m_mapping;
+#endif
+};
+
 } /* namespace vktrace_replay */
 
 
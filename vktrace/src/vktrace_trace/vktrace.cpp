@@ -45,6 +45,7 @@ vktrace_SettingInfo g_settings_info[] =
     { "w", "WorkingDir", VKTRACE_SETTING_STRING, &g_settings.working_dir, &g_default_settings.working_dir, TRUE, "The program's working directory."},
     { "o", "OutputTrace", VKTRACE_SETTING_STRING, &g_settings.output_trace, &g_default_settings.output_trace, TRUE, "Path to the generated output trace file."},
     { "s", "ScreenShot", VKTRACE_SETTING_STRING, &g_settings.screenshotList, &g_default_settings.screenshotList, TRUE, "Comma separated list of frames to take a snapshot of."},
+    { "c", "CompressTrace", VKTRACE_SETTING_BOOL, &g_settings.compress_trace, &g_default_settings.compress_trace, TRUE, "Compress the trace file and index its frames."},
     { "ptm", "PrintTraceMessages", VKTRACE_SETTING_BOOL, &g_settings.print_trace_messages, &g_default_settings.print_trace_messages, TRUE, "Print trace messages to vktrace console."},
 #if _DEBUG
     { "v", "Verbosity", VKTRACE_SETTING_STRING, &g_settings.verbosity, &g_default_settings.verbosity, TRUE, "Verbosity mode. Modes are \"quiet\", \"errors\", \"warnings\", \"full\", \"debug\"."},
@@ -273,6 +274,10 @@ int main(int argc, char* argv[])
          }
 
         procInfo.parentThreadId = vktrace_platform_get_thread_id();
+        procInfo.compressTrace = g_settings.compress_trace;
+        // the tracer only writes the frame markers the frame index is built from when asked to
+        if (g_settings.compress_trace)
+            vktrace_set_global_var("_VK_TRACE_FRAME_MARKERS", "1");
 
         // setup tracer, only Vulkan tracer suppported
         PrepareTracers(&procInfo.pCaptureThreads);
@@ -39,6 +39,7 @@ typedef struct vktrace_settings
     const char* working_dir;
     char* output_trace;
     BOOL print_trace_messages;
+    BOOL compress_trace;
     const char* screenshotList;
     const char *verbosity;
 } vktrace_settings;
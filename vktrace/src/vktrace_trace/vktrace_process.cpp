@@ -116,6 +116,17 @@ VKTRACE_THREAD_ROUTINE_RETURN_TYPE Process_RunRecordTraceThread(LPVOID _threadIn
         return 1;
     }
 
+    if (pInfo->pProcessInfo->compressTrace)
+    {
+        pInfo->pProcessInfo->pCompressedTraceFile = vktrace_compressed_file_create(pInfo->pProcessInfo->pTraceFile);
+        if (pInfo->pProcessInfo->pCompressedTraceFile == NULL)
+        {
+            vktrace_LogError("Error cannot allocate buffers for compressing the trace file.");
+            vktrace_process_info_delete(pInfo->pProcessInfo);
+            return 1;
+        }
+    }
+
     FileLike* fileLikeSocket = vktrace_FileLike_create_msg(pMessageStream);
     unsigned int total_packet_count = 0;
     vktrace_trace_packet_header* pHeader = NULL;
@@ -169,7 +180,21 @@ VKTRACE_THREAD_ROUTINE_RETURN_TYPE Process_RunRecordTraceThread(LPVOID _threadIn
                 break;
             }
 
-            if (pInfo->pProcessInfo->pTraceFile != NULL)
+            if (pInfo->pProcessInfo->pCompressedTraceFile != NULL)
+            {
+                vktrace_enter_critical_section(&pInfo->pProcessInfo->traceFileCriticalSection);
+                bytes_written = vktrace_compressed_file_write(pInfo->pProcessInfo->pCompressedTraceFile, pHeader, (size_t)pHeader->size) ? (size_t)pHeader->size : 0;
+                if (pHeader->packet_id == VKTRACE_TPI_MARKER_API_BOUNDARY)
+                {
+                    vktrace_compressed_file_mark_frame_end(pInfo->pProcessInfo->pCompressedTraceFile, pHeader->global_packet_index);
+                }
+                vktrace_leave_critical_section(&pInfo->pProcessInfo->traceFileCriticalSection);
+                if (bytes_written != pHeader->size)
+                {
+                    vktrace_LogError("Failed to write the packet for packet_id = %hu", pHeader->packet_id);
+                }
+            }
+            else if (pInfo->pProcessInfo->pTraceFile != NULL)
             {
                 vktrace_enter_critical_section(&pInfo->pProcessInfo->traceFileCriticalSection);
                 bytes_written = fwrite(pHeader, 1, (size_t)pHeader->size, pInfo->pProcessInfo->pTraceFile);
@@ -186,6 +211,14 @@ VKTRACE_THREAD_ROUTINE_RETURN_TYPE Process_RunRecordTraceThread(LPVOID _threadIn
         vktrace_delete_trace_packet(&pHeader);
     }
 
+    if (pInfo->pProcessInfo->pCompressedTraceFile != NULL)
+    {
+        // write out the last chunk and the frame index
+        vktrace_enter_critical_section(&pInfo->pProcessInfo->traceFileCriticalSection);
+        vktrace_compressed_file_close(&pInfo->pProcessInfo->pCompressedTraceFile);
+        vktrace_leave_critical_section(&pInfo->pProcessInfo->traceFileCriticalSection);
+    }
+
     VKTRACE_DELETE(fileLikeSocket);
     vktrace_MessageStream_destroy(&pMessageStream);
 
@@ -20,8 +20,10 @@
  **************************************************************************/
 
 #include <assert.h>
+#include <limits.h>
 #include <QDebug>
 #include <QFileDialog>
+#include <QInputDialog>
 #include <QMoveEvent>
 #include <QPalette>
 #include <QProcess>
@@ -401,11 +403,11 @@ unsigned long long vktraceviewer::get_current_packet_index()
     unsigned long long packetIndex = 0;
     if (index.isValid())
     {
-        vktrace_trace_packet_header* pHeader = (vktrace_trace_packet_header*)index.internalPointer();
-        if (pHeader != NULL)
+        vktraceviewer_trace_file_packet_offsets* pEntry = (vktraceviewer_trace_file_packet_offsets*)index.internalPointer();
+        if (pEntry != NULL)
         {
-            assert(pHeader != NULL);
-            packetIndex = pHeader->global_packet_index;
+            assert(pEntry != NULL);
+            packetIndex = pEntry->global_packet_index;
         }
     }
     return packetIndex;
@@ -517,31 +519,31 @@ void vktraceviewer::GenerateTraceFileStats()
 
     if (m_traceFileInfo.packetCount > 0)
     {
-        uint64_t start = m_traceFileInfo.pPacketOffsets[0].pHeader->entrypoint_begin_time;
-        uint64_t end = m_traceFileInfo.pPacketOffsets[m_traceFileInfo.packetCount-1].pHeader->entrypoint_end_time;
+        uint64_t start = m_traceFileInfo.pPacketOffsets[0].entrypoint_begin_time;
+        uint64_t end = m_traceFileInfo.pPacketOffsets[m_traceFileInfo.packetCount-1].entrypoint_end_time;
         totalTraceTime = end-start;
     }
 
     QMap<uint16_t, vtvApiUsageStats> statMap;
     for (uint64_t i = 0; i < m_traceFileInfo.packetCount; i++)
     {
-        vktrace_trace_packet_header* pHeader = m_traceFileInfo.pPacketOffsets[i].pHeader;
-        if (pHeader->packet_id >= VKTRACE_TPI_BEGIN_API_HERE)
+        const vktraceviewer_trace_file_packet_offsets* pEntry = &m_traceFileInfo.pPacketOffsets[i];
+        if (pEntry->packet_id >= VKTRACE_TPI_BEGIN_API_HERE)
         {
             totalStats.totalCallCount++;
-            totalStats.totalCpuExecutionTime += (pHeader->entrypoint_end_time - pHeader->entrypoint_begin_time);
-            totalStats.totalTraceOverhead += ((pHeader->vktrace_end_time - pHeader->vktrace_begin_time) - (pHeader->entrypoint_end_time - pHeader->entrypoint_begin_time));
-            if (statMap.contains(pHeader->packet_id))
+            totalStats.totalCpuExecutionTime += (pEntry->entrypoint_end_time - pEntry->entrypoint_begin_time);
+            totalStats.totalTraceOverhead += pEntry->trace_overhead;
+            if (statMap.contains(pEntry->packet_id))
             {
-                statMap[pHeader->packet_id].totalCpuExecutionTime += (pHeader->entrypoint_end_time - pHeader->entrypoint_begin_time);
-                statMap[pHeader->packet_id].totalTraceOverhead += ((pHeader->vktrace_end_time - pHeader->vktrace_begin_time) - (pHeader->entrypoint_end_time - pHeader->entrypoint_begin_time));
-                statMap[pHeader->packet_id].totalCallCount++;
+                statMap[pEntry->packet_id].totalCpuExecutionTime += (pEntry->entrypoint_end_time - pEntry->entrypoint_begin_time);
+                statMap[pEntry->packet_id].totalTraceOverhead += pEntry->trace_overhead;
+                statMap[pEntry->packet_id].totalCallCount++;
             }
             else
             {
-                tmpNewStat.totalCpuExecutionTime = (pHeader->entrypoint_end_time - pHeader->entrypoint_begin_time);
-                tmpNewStat.totalTraceOverhead = ((pHeader->vktrace_end_time - pHeader->vktrace_begin_time) - (pHeader->entrypoint_end_time - pHeader->entrypoint_begin_time));
-                statMap.insert(pHeader->packet_id, tmpNewStat);
+                tmpNewStat.totalCpuExecutionTime = (pEntry->entrypoint_end_time - pEntry->entrypoint_begin_time);
+                tmpNewStat.totalTraceOverhead = pEntry->trace_overhead;
+                statMap.insert(pEntry->packet_id, tmpNewStat);
             }
         }
     }
@@ -588,6 +590,11 @@ void vktraceviewer::GenerateTraceFileStats()
     m_pTraceStatsTabText->setHtml(statText);
 }
 
+static vktrace_trace_packet_header* interpret_trace_packet(void* pUserData, vktrace_trace_packet_header* pHeader)
+{
+    return ((vktraceviewer_QController*)pUserData)->InterpretTracePacket(pHeader);
+}
+
 void vktraceviewer::onTraceFileLoaded(bool bSuccess, vktraceviewer_trace_file_info fileInfo, const QString& controllerFilename)
 {
     QApplication::restoreOverrideCursor();
@@ -650,6 +657,10 @@ void vktraceviewer::onTraceFileLoaded(bool bSuccess, vktraceviewer_trace_file_in
             //    vktraceviewer_output_error("VkTraceViewer was unable to create a session folder to save viewing information. Functionality may be limited.");
             //}
 
+            // packets are interpreted by the controller as they are paged in
+            m_traceFileInfo.pfnInterpretPacket = interpret_trace_packet;
+            m_traceFileInfo.pInterpretUserData = m_pController;
+
             // Update the UI with the controller
             m_pController->LoadTraceFile(&m_traceFileInfo, this);
         }
@@ -661,6 +672,9 @@ void vktraceviewer::onTraceFileLoaded(bool bSuccess, vktraceviewer_trace_file_in
 
         ui->action_Close->setEnabled(true);
         ui->actionExport_API_Calls->setEnabled(true);
+        // only compressed traces have a frame index to go to a frame with
+        ui->actionGo_To_Frame->setEnabled(m_traceFileInfo.pCompressedFile != NULL &&
+                                          vktrace_compressed_file_get_frame_count(m_traceFileInfo.pCompressedFile) > 0);
 
         ui->prevDrawcallButton->setEnabled(true);
         ui->nextDrawcallButton->setEnabled(true);
@@ -692,21 +706,9 @@ void vktraceviewer::close_trace_file()
         m_pTimeline->repaint();
     }
 
-    if (m_traceFileInfo.packetCount > 0)
-    {
-        for (unsigned int i = 0; i < m_traceFileInfo.packetCount; i++)
-        {
-            if (m_traceFileInfo.pPacketOffsets[i].pHeader != NULL)
-            {
-                vktrace_free(m_traceFileInfo.pPacketOffsets[i].pHeader);
-                m_traceFileInfo.pPacketOffsets[i].pHeader = NULL;
-            }
-        }
-
-        VKTRACE_DELETE(m_traceFileInfo.pPacketOffsets);
-        m_traceFileInfo.pPacketOffsets = NULL;
-        m_traceFileInfo.packetCount = 0;
-    }
+    m_traceFileInfo.pfnInterpretPacket = NULL;
+    m_traceFileInfo.pInterpretUserData = NULL;
+    vktraceviewer_release_trace_file_info(&m_traceFileInfo);
 
     if (m_traceFileInfo.pFile != NULL)
     {
@@ -736,6 +738,31 @@ void vktraceviewer::close_trace_file()
     reset_tracefile_ui();
 }
 
+void vktraceviewer::on_actionGo_To_Frame_triggered()
+{
+    if (m_traceFileInfo.pCompressedFile == NULL)
+    {
+        return;
+    }
+
+    uint64_t frameCount = vktrace_compressed_file_get_frame_count(m_traceFileInfo.pCompressedFile);
+    int maxFrame = (frameCount > INT_MAX) ? INT_MAX : (int)frameCount;
+    bool ok = false;
+    int frame = QInputDialog::getInt(this, tr("Go to Frame"), tr("Frame (0 - %1):").arg(maxFrame), 0, 0, maxFrame, 1, &ok);
+    if (!ok)
+    {
+        return;
+    }
+
+    uint64_t packetIndex = 0;
+    if (vktraceviewer_get_frame_packet_index(&m_traceFileInfo, (uint64_t)frame, &packetIndex) == FALSE)
+    {
+        vktraceviewer_output_warning(QString("Frame %1 has no packets in the trace file.").arg(frame));
+        return;
+    }
+    select_call_at_packet_index(m_traceFileInfo.pPacketOffsets[packetIndex].global_packet_index);
+}
+
 void vktraceviewer::on_actionExport_API_Calls_triggered()
 {
     QString suggestedName(m_traceFileInfo.filename);
@@ -761,9 +788,12 @@ void vktraceviewer::on_actionExport_API_Calls_triggered()
         // iterate through every packet
         for (unsigned int i = 0; i < m_traceFileInfo.packetCount; i++)
         {
-            vktraceviewer_trace_file_packet_offsets* pOffsets = &m_traceFileInfo.pPacketOffsets[i];
-            vktrace_trace_packet_header* pHeader = pOffsets->pHeader;
-            assert(pHeader != NULL);
+            vktrace_trace_packet_header* pHeader = vktraceviewer_get_trace_packet(&m_traceFileInfo, i);
+            if (pHeader == NULL)
+            {
+                LogError(QString("Unable to read packet %1, it was not exported.").arg(i));
+                continue;
+            }
             QString string = m_pTraceFileModel->get_packet_string(pHeader);
 
             // output packet string
@@ -853,6 +883,7 @@ void vktraceviewer::reset_tracefile_ui()
 {
     ui->action_Close->setEnabled(false);
     ui->actionExport_API_Calls->setEnabled(false);
+    ui->actionGo_To_Frame->setEnabled(false);
 
     ui->prevDrawcallButton->setEnabled(false);
     ui->nextDrawcallButton->setEnabled(false);
@@ -1073,8 +1104,8 @@ void vktraceviewer::on_prevDrawcallButton_clicked()
         QModelIndex indexAbove= index.sibling(index.row()-1, vktraceviewer_QTraceFileModel::Column_EntrypointName);
         while (indexAbove.isValid())
         {
-            vktrace_trace_packet_header* pHeader = (vktrace_trace_packet_header*)indexAbove.internalPointer();
-            if (pHeader != NULL && m_pTraceFileModel->isDrawCall((VKTRACE_TRACE_PACKET_ID)pHeader->packet_id))
+            vktraceviewer_trace_file_packet_offsets* pEntry = (vktraceviewer_trace_file_packet_offsets*)indexAbove.internalPointer();
+            if (pEntry != NULL && m_pTraceFileModel->isDrawCall((VKTRACE_TRACE_PACKET_ID)pEntry->packet_id))
             {
                 selectApicallModelIndex(indexAbove, true, true);
                 ui->treeView->setFocus();
@@ -1118,8 +1149,8 @@ void vktraceviewer::on_nextDrawcallButton_clicked()
         QModelIndex indexBelow = index.sibling(index.row()+1, vktraceviewer_QTraceFileModel::Column_EntrypointName);
         while (indexBelow.isValid())
         {
-            vktrace_trace_packet_header* pHeader = (vktrace_trace_packet_header*)indexBelow.internalPointer();
-            if (pHeader != NULL && m_pTraceFileModel->isDrawCall((VKTRACE_TRACE_PACKET_ID)pHeader->packet_id))
+            vktraceviewer_trace_file_packet_offsets* pEntry = (vktraceviewer_trace_file_packet_offsets*)indexBelow.internalPointer();
+            if (pEntry != NULL && m_pTraceFileModel->isDrawCall((VKTRACE_TRACE_PACKET_ID)pEntry->packet_id))
             {
                 selectApicallModelIndex(indexBelow, true, true);
                 ui->treeView->setFocus();
@@ -108,6 +108,7 @@ private slots:
     void on_action_Close_triggered();
     void on_actionE_xit_triggered();
     void on_actionExport_API_Calls_triggered();
+    void on_actionGo_To_Frame_triggered();
     void on_actionEdit_triggered();
 
     void on_settingsDialogResized(unsigned int width, unsigned int height);
@@ -282,12 +282,21 @@ void vktraceviewer_QReplayWorker::playCurrentTraceFile(uint64_t startPacketIndex
         emit ReplayProgressUpdate(m_currentReplayPacketIndex);
 
         pCurPacket = &pTraceFileInfo->pPacketOffsets[i];
-        s_currentReplayPacket = pCurPacket->pHeader->global_packet_index;
-        switch (pCurPacket->pHeader->packet_id) {
+        s_currentReplayPacket = pCurPacket->global_packet_index;
+
+        // page the packet in from the trace file
+        vktrace_trace_packet_header* pHeader = vktraceviewer_get_trace_packet(pTraceFileInfo, i);
+        if (pHeader == NULL)
+        {
+            replayWorkerLoggingCallback(VKTRACE_LOG_ERROR, QString("Unable to read packet %1 from the trace file.").arg(pCurPacket->global_packet_index).toStdString().c_str());
+            break;
+        }
+
+        switch (pHeader->packet_id) {
             case VKTRACE_TPI_MESSAGE:
             {
                 vktrace_trace_packet_message* msgPacket;
-                msgPacket = (vktrace_trace_packet_message*)pCurPacket->pHeader;
+                msgPacket = (vktrace_trace_packet_message*)pHeader->pBody;
                 replayWorkerLoggingCallback(msgPacket->type, msgPacket->message);
                 break;
             }
@@ -304,26 +313,26 @@ void vktraceviewer_QReplayWorker::playCurrentTraceFile(uint64_t startPacketIndex
             //TODO processing code for all the above cases
             default:
             {
-                if (pCurPacket->pHeader->tracer_id >= VKTRACE_MAX_TRACER_ID_ARRAY_SIZE  || pCurPacket->pHeader->tracer_id == VKTRACE_TID_RESERVED)
+                if (pCurPacket->tracer_id >= VKTRACE_MAX_TRACER_ID_ARRAY_SIZE  || pCurPacket->tracer_id == VKTRACE_TID_RESERVED)
                 {
-                    replayWorkerLoggingCallback(VKTRACE_LOG_WARNING, QString("Tracer_id from packet num packet %1 invalid.").arg(pCurPacket->pHeader->packet_id).toStdString().c_str());
+                    replayWorkerLoggingCallback(VKTRACE_LOG_WARNING, QString("Tracer_id from packet num packet %1 invalid.").arg(pCurPacket->packet_id).toStdString().c_str());
                     continue;
                 }
-                replayer = m_pReplayers[pCurPacket->pHeader->tracer_id];
+                replayer = m_pReplayers[pCurPacket->tracer_id];
                 if (replayer == NULL) {
-                    replayWorkerLoggingCallback(VKTRACE_LOG_WARNING, QString("Tracer_id %1 has no valid replayer.").arg(pCurPacket->pHeader->tracer_id).toStdString().c_str());
+                    replayWorkerLoggingCallback(VKTRACE_LOG_WARNING, QString("Tracer_id %1 has no valid replayer.").arg(pCurPacket->tracer_id).toStdString().c_str());
                     continue;
                 }
-                if (pCurPacket->pHeader->packet_id >= VKTRACE_TPI_BEGIN_API_HERE)
+                if (pCurPacket->packet_id >= VKTRACE_TPI_BEGIN_API_HERE)
                 {
                     // replay the API packet
                     try
                     {
-                        res = replayer->Replay(pCurPacket->pHeader);
+                        res = replayer->Replay(pHeader);
                     }
                     catch (std::exception& e)
                     {
-                        replayWorkerLoggingCallback(VKTRACE_LOG_ERROR, QString("Caught std::exception while replaying packet %1: %2").arg(pCurPacket->pHeader->global_packet_index).arg(e.what()).toStdString().c_str());
+                        replayWorkerLoggingCallback(VKTRACE_LOG_ERROR, QString("Caught std::exception while replaying packet %1: %2").arg(pCurPacket->global_packet_index).arg(e.what()).toStdString().c_str());
                     }
                     catch (int i)
                     {
@@ -338,11 +347,11 @@ void vktraceviewer_QReplayWorker::playCurrentTraceFile(uint64_t startPacketIndex
                         res == vktrace_replay::VKTRACE_REPLAY_INVALID_ID ||
                         res == vktrace_replay::VKTRACE_REPLAY_CALL_ERROR)
                     {
-                        replayWorkerLoggingCallback(VKTRACE_LOG_ERROR, QString("Failed to replay packet %1.").arg(pCurPacket->pHeader->global_packet_index).toStdString().c_str());
+                        replayWorkerLoggingCallback(VKTRACE_LOG_ERROR, QString("Failed to replay packet %1.").arg(pCurPacket->global_packet_index).toStdString().c_str());
                     }
                     else if (res == vktrace_replay::VKTRACE_REPLAY_BAD_RETURN)
                     {
-                        replayWorkerLoggingCallback(VKTRACE_LOG_WARNING, QString("Replay of packet %1 has diverged from trace due to a different return value.").arg(pCurPacket->pHeader->global_packet_index).toStdString().c_str());
+                        replayWorkerLoggingCallback(VKTRACE_LOG_WARNING, QString("Replay of packet %1 has diverged from trace due to a different return value.").arg(pCurPacket->global_packet_index).toStdString().c_str());
                     }
                     else if (res == vktrace_replay::VKTRACE_REPLAY_INVALID_PARAMS ||
                              res == vktrace_replay::VKTRACE_REPLAY_VALIDATION_ERROR)
@@ -351,40 +360,40 @@ void vktraceviewer_QReplayWorker::playCurrentTraceFile(uint64_t startPacketIndex
                     }
                     else if (res != vktrace_replay::VKTRACE_REPLAY_SUCCESS)
                     {
-                        replayWorkerLoggingCallback(VKTRACE_LOG_ERROR, QString("Unknown error caused by packet %1.").arg(pCurPacket->pHeader->global_packet_index).toStdString().c_str());
+                        replayWorkerLoggingCallback(VKTRACE_LOG_ERROR, QString("Unknown error caused by packet %1.").arg(pCurPacket->global_packet_index).toStdString().c_str());
                     }
                 }
                 else
                 {
-                    replayWorkerLoggingCallback(VKTRACE_LOG_ERROR, QString("Bad packet type id=%1, index=%2.").arg(pCurPacket->pHeader->packet_id).arg(pCurPacket->pHeader->global_packet_index).toStdString().c_str());
+                    replayWorkerLoggingCallback(VKTRACE_LOG_ERROR, QString("Bad packet type id=%1, index=%2.").arg(pCurPacket->packet_id).arg(pCurPacket->global_packet_index).toStdString().c_str());
                 }
             }
         }
 
         // Process events and pause or stop if needed
-        if (m_bPauseReplay || m_pauseAtPacketIndex == pCurPacket->pHeader->global_packet_index)
+        if (m_bPauseReplay || m_pauseAtPacketIndex == pCurPacket->global_packet_index)
         {
-            if (m_pauseAtPacketIndex == pCurPacket->pHeader->global_packet_index)
+            if (m_pauseAtPacketIndex == pCurPacket->global_packet_index)
             {
                 // reset
                 m_pauseAtPacketIndex = -1;
             }
 
             m_bReplayInProgress = false;
-            doReplayPaused(pCurPacket->pHeader->global_packet_index);
+            doReplayPaused(pCurPacket->global_packet_index);
             return;
         }
 
         if (m_bStopReplay)
         {
             m_bReplayInProgress = false;
-            doReplayStopped(pCurPacket->pHeader->global_packet_index);
+            doReplayStopped(pCurPacket->global_packet_index);
             return;
         }
     }
 
     m_bReplayInProgress = false;
-    doReplayFinished(pCurPacket->pHeader->global_packet_index);
+    doReplayFinished(pCurPacket->global_packet_index);
 }
 
 void vktraceviewer_QReplayWorker::onPlayToHere()
@@ -461,7 +470,7 @@ void vktraceviewer_QReplayWorker::StopReplay()
         // Replay is not in progress means:
         // 1) replay wasn't started (in which case stop button should be disabled and we can't get to this point),
         // 2) replay is currently paused, so do same actions as if the replay detected that it should stop.
-        uint64_t packetIndex = this->m_pTraceFileInfo->pPacketOffsets[m_currentReplayPacketIndex].pHeader->global_packet_index;
+        uint64_t packetIndex = this->m_pTraceFileInfo->pPacketOffsets[m_currentReplayPacketIndex].global_packet_index;
         doReplayStopped(packetIndex);
     }
 }
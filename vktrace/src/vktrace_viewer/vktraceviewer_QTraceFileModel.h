@@ -121,8 +121,8 @@ public:
 
         if (role == Qt::FontRole)
         {
-            vktrace_trace_packet_header* pHeader = (vktrace_trace_packet_header*)this->index(index.row(), Column_EntrypointName, index.parent()).internalPointer();
-            if (isDrawCall((VKTRACE_TRACE_PACKET_ID)pHeader->packet_id))
+            vktraceviewer_trace_file_packet_offsets* pEntry = (vktraceviewer_trace_file_packet_offsets*)this->index(index.row(), Column_EntrypointName, index.parent()).internalPointer();
+            if (isDrawCall((VKTRACE_TRACE_PACKET_ID)pEntry->packet_id))
             {
                 QFont font;
                 font.setBold(true);
@@ -151,23 +151,28 @@ public:
             {
                 case Column_EntrypointName:
                 {
-                    vktrace_trace_packet_header* pHeader = (vktrace_trace_packet_header*)index.internalPointer();
+                    // the index only holds what is needed to list the packet, the packet itself is paged in to describe it
+                    vktrace_trace_packet_header* pHeader = vktraceviewer_get_trace_packet(m_pTraceFileInfo, index.row());
+                    if (pHeader == NULL)
+                    {
+                        return QString("Unreadable packet (id %1)").arg(((vktraceviewer_trace_file_packet_offsets*)index.internalPointer())->packet_id);
+                    }
                     QString apiStr = this->get_packet_string(pHeader);
                     return apiStr;
                 }
                 case Column_TracerId:
                     return QVariant(*(uint8_t*)index.internalPointer());
-                case Column_PacketIndex:
                 case Column_ThreadId:
                     return QVariant(*(uint32_t*)index.internalPointer());
+                case Column_PacketIndex:
                 case Column_BeginTime:
                 case Column_EndTime:
                 case Column_PacketSize:
                     return QVariant(*(unsigned long long*)index.internalPointer());
                 case Column_CpuDuration:
                 {
-                    vktrace_trace_packet_header* pHeader = (vktrace_trace_packet_header*)index.internalPointer();
-                    uint64_t duration = pHeader->entrypoint_end_time - pHeader->entrypoint_begin_time;
+                    vktraceviewer_trace_file_packet_offsets* pEntry = (vktraceviewer_trace_file_packet_offsets*)index.internalPointer();
+                    uint64_t duration = pEntry->entrypoint_end_time - pEntry->entrypoint_begin_time;
                     return QVariant((unsigned int)duration);
                 }
             }
@@ -175,26 +180,30 @@ public:
 
         if (role == Qt::ToolTipRole && index.column() == Column_EntrypointName)
         {
-            vktrace_trace_packet_header* pHeader = (vktrace_trace_packet_header*)index.internalPointer();
             QString tip;
             tip += "<html><table>";
+            vktrace_trace_packet_header* pPacket = vktraceviewer_get_trace_packet(m_pTraceFileInfo, index.row());
+            if (pPacket == NULL)
+            {
+                return QVariant();
+            }
 #if defined(_DEBUG)
             tip += "<tr><td><b>Packet header:</b></td><td/></tr>";
-            tip += QString("<tr><td>pHeader->size</td><td>= %1 bytes</td></tr>").arg(pHeader->size);
-            tip += QString("<tr><td>pHeader->global_packet_index</td><td>= %1</td></tr>").arg(pHeader->global_packet_index);
-            tip += QString("<tr><td>pHeader->tracer_id</td><td>= %1</td></tr>").arg(pHeader->tracer_id);
-            tip += QString("<tr><td>pHeader->packet_id</td><td>= %1</td></tr>").arg(pHeader->packet_id);
-            tip += QString("<tr><td>pHeader->thread_id</td><td>= %1</td></tr>").arg(pHeader->thread_id);
-            tip += QString("<tr><td>pHeader->vktrace_begin_time</td><td>= %1</td></tr>").arg(pHeader->vktrace_begin_time);
-            tip += QString("<tr><td>pHeader->entrypoint_begin_time</td><td>= %1</td></tr>").arg(pHeader->entrypoint_begin_time);
-            tip += QString("<tr><td>pHeader->entrypoint_end_time</td><td>= %1 (%2)</td></tr>").arg(pHeader->entrypoint_end_time).arg(pHeader->entrypoint_end_time - pHeader->entrypoint_begin_time);
-            tip += QString("<tr><td>pHeader->vktrace_end_time</td><td>= %1 (%2)</td></tr>").arg(pHeader->vktrace_end_time).arg(pHeader->vktrace_end_time - pHeader->vktrace_begin_time);
-            tip += QString("<tr><td>pHeader->next_buffers_offset</td><td>= %1</td></tr>").arg(pHeader->next_buffers_offset);
-            tip += QString("<tr><td>pHeader->pBody</td><td>= %1</td></tr>").arg(pHeader->pBody);
+            tip += QString("<tr><td>pHeader->size</td><td>= %1 bytes</td></tr>").arg(pPacket->size);
+            tip += QString("<tr><td>pHeader->global_packet_index</td><td>= %1</td></tr>").arg(pPacket->global_packet_index);
+            tip += QString("<tr><td>pHeader->tracer_id</td><td>= %1</td></tr>").arg(pPacket->tracer_id);
+            tip += QString("<tr><td>pHeader->packet_id</td><td>= %1</td></tr>").arg(pPacket->packet_id);
+            tip += QString("<tr><td>pHeader->thread_id</td><td>= %1</td></tr>").arg(pPacket->thread_id);
+            tip += QString("<tr><td>pHeader->vktrace_begin_time</td><td>= %1</td></tr>").arg(pPacket->vktrace_begin_time);
+            tip += QString("<tr><td>pHeader->entrypoint_begin_time</td><td>= %1</td></tr>").arg(pPacket->entrypoint_begin_time);
+            tip += QString("<tr><td>pHeader->entrypoint_end_time</td><td>= %1 (%2)</td></tr>").arg(pPacket->entrypoint_end_time).arg(pPacket->entrypoint_end_time - pPacket->entrypoint_begin_time);
+            tip += QString("<tr><td>pHeader->vktrace_end_time</td><td>= %1 (%2)</td></tr>").arg(pPacket->vktrace_end_time).arg(pPacket->vktrace_end_time - pPacket->vktrace_begin_time);
+            tip += QString("<tr><td>pHeader->next_buffers_offset</td><td>= %1</td></tr>").arg(pPacket->next_buffers_offset);
+            tip += QString("<tr><td>pHeader->pBody</td><td>= %1</td></tr>").arg(pPacket->pBody);
             tip += "<br>";
 #endif
             tip += "<tr><td><b>";
-            QString multiline = this->get_packet_string_multiline(pHeader);
+            QString multiline = this->get_packet_string_multiline(pPacket);
             multiline.replace("(\n", "</b>(</td><td/></tr><tr><td>");
             multiline.replace(" = ", "</td><td>= ");
             multiline.replace("\n", "</td></tr><tr><td>");
@@ -220,33 +229,33 @@ public:
             return QModelIndex();
         }
 
-        vktrace_trace_packet_header* pHeader = m_pTraceFileInfo->pPacketOffsets[row].pHeader;
+        vktraceviewer_trace_file_packet_offsets* pEntry = &m_pTraceFileInfo->pPacketOffsets[row];
         void* pData = NULL;
         switch (column)
         {
         case Column_EntrypointName:
-            pData = pHeader;
+            pData = pEntry;
             break;
         case Column_TracerId:
-            pData = &pHeader->tracer_id;
+            pData = &pEntry->tracer_id;
             break;
         case Column_PacketIndex:
-            pData = &pHeader->global_packet_index;
+            pData = &pEntry->global_packet_index;
             break;
         case Column_ThreadId:
-            pData = &pHeader->thread_id;
+            pData = &pEntry->thread_id;
             break;
         case Column_BeginTime:
-            pData = &pHeader->entrypoint_begin_time;
+            pData = &pEntry->entrypoint_begin_time;
             break;
         case Column_EndTime:
-            pData = &pHeader->entrypoint_end_time;
+            pData = &pEntry->entrypoint_end_time;
             break;
         case Column_PacketSize:
-            pData = &pHeader->size;
+            pData = &pEntry->size;
             break;
         case Column_CpuDuration:
-            pData = pHeader;
+            pData = pEntry;
             break;
         }
 
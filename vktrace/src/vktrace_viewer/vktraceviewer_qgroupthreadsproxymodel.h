@@ -216,16 +216,16 @@ private:
             // Determine how many additional columns are needed by counting the number if different thread Ids being used.
             for (int i = 0; i < pTFM->rowCount(); i++)
             {
-                vktrace_trace_packet_header* pHeader = (vktrace_trace_packet_header*)pTFM->index(i, 0).internalPointer();
-                if (pHeader != NULL)
+                vktraceviewer_trace_file_packet_offsets* pEntry = (vktraceviewer_trace_file_packet_offsets*)pTFM->index(i, 0).internalPointer();
+                if (pEntry != NULL)
                 {
-                    if (!m_uniqueThreadIdMapToColumn.contains(pHeader->thread_id))
+                    if (!m_uniqueThreadIdMapToColumn.contains(pEntry->thread_id))
                     {
                         int columnIndex = m_uniqueThreadIdMapToColumn.count();
-                        m_uniqueThreadIdMapToColumn.insert(pHeader->thread_id, columnIndex);
+                        m_uniqueThreadIdMapToColumn.insert(pEntry->thread_id, columnIndex);
                     }
 
-                    m_packetIndexToColumn.append(m_uniqueThreadIdMapToColumn[pHeader->thread_id]);
+                    m_packetIndexToColumn.append(m_uniqueThreadIdMapToColumn[pEntry->thread_id]);
                 }
             }
         }
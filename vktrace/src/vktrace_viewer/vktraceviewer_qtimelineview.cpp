@@ -88,9 +88,9 @@ vktraceviewer_QTimelineItemDelegate::~vktraceviewer_QTimelineItemDelegate()
 
 void vktraceviewer_QTimelineItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
 {
-    vktrace_trace_packet_header* pHeader = (vktrace_trace_packet_header*)index.internalPointer();
+    vktraceviewer_trace_file_packet_offsets* pEntry = (vktraceviewer_trace_file_packet_offsets*)index.internalPointer();
 
-    if (pHeader->entrypoint_end_time <= pHeader->entrypoint_begin_time)
+    if (pEntry->entrypoint_end_time <= pEntry->entrypoint_begin_time)
     {
         return;
     }
@@ -107,7 +107,7 @@ void vktraceviewer_QTimelineItemDelegate::paint(QPainter *painter, const QStyleO
                 rect.setWidth(1);
             }
 
-            float duration = u64ToFloat(pHeader->entrypoint_end_time - pHeader->entrypoint_begin_time);
+            float duration = u64ToFloat(pEntry->entrypoint_end_time - pEntry->entrypoint_begin_time);
             float durationRatio = duration / pTimeline->getMaxItemDuration();
             int intensity = std::min(255, (int)(durationRatio * 255.0f));
             QColor color(intensity, 255-intensity, 0);
@@ -294,17 +294,17 @@ void vktraceviewer_QTimelineView::calculateRectsIfNecessary()
         QRectF rect;
         QModelIndex item = model()->index(row, vktraceviewer_QTraceFileModel::Column_EntrypointName);
 
-        vktrace_trace_packet_header* pHeader = (vktrace_trace_packet_header*)item.internalPointer();
+        vktraceviewer_trace_file_packet_offsets* pEntry = (vktraceviewer_trace_file_packet_offsets*)item.internalPointer();
 
         // make sure item is valid size
-        if (pHeader->entrypoint_end_time > pHeader->entrypoint_begin_time)
+        if (pEntry->entrypoint_end_time > pEntry->entrypoint_begin_time)
         {
-            int threadIndex = m_threadIdList.indexOf(pHeader->thread_id);
+            int threadIndex = m_threadIdList.indexOf(pEntry->thread_id);
             int topOffset = (m_threadHeight * threadIndex) + (m_threadHeight * 0.5);
 
-            uint64_t duration = pHeader->entrypoint_end_time - pHeader->entrypoint_begin_time;
+            uint64_t duration = pEntry->entrypoint_end_time - pEntry->entrypoint_begin_time;
 
-            float leftOffset = u64ToFloat(pHeader->entrypoint_begin_time - m_rawStartTime);
+            float leftOffset = u64ToFloat(pEntry->entrypoint_begin_time - m_rawStartTime);
             float Width = u64ToFloat(duration);
 
             // create the rect that represents this item
@@ -341,8 +341,8 @@ bool vktraceviewer_QTimelineView::event(QEvent * e)
         QModelIndex index = indexAt(pHelp->pos());
         if (index.isValid())
         {
-            vktrace_trace_packet_header* pHeader = (vktrace_trace_packet_header*)index.internalPointer();
-            QToolTip::showText(pHelp->globalPos(), QString("Call %1:\n%2").arg(pHeader->global_packet_index).arg(index.data().toString()));
+            vktraceviewer_trace_file_packet_offsets* pEntry = (vktraceviewer_trace_file_packet_offsets*)index.internalPointer();
+            QToolTip::showText(pHelp->globalPos(), QString("Call %1:\n%2").arg(pEntry->global_packet_index).arg(index.data().toString()));
             return true;
         }
         else
@@ -740,8 +740,8 @@ void vktraceviewer_QTimelineView::drawTimelineItem(QPainter* painter, const QMod
         option.state |= QStyle::State_HasFocus;
 
     // check mask to determine if this item should be drawn, or if something has already covered it's pixels
-    vktrace_trace_packet_header* pHeader = (vktrace_trace_packet_header*)index.internalPointer();
-    QVector<int>& mask = m_threadMask[pHeader->thread_id];
+    vktraceviewer_trace_file_packet_offsets* pEntry = (vktraceviewer_trace_file_packet_offsets*)index.internalPointer();
+    QVector<int>& mask = m_threadMask[pEntry->thread_id];
     bool drawItem = false;
     int x = option.rect.x();
     int right = qMin( qMax(x, option.rect.right()), viewport()->width()-1);
@@ -36,6 +36,12 @@ vktraceviewer_QTraceFileLoader::~vktraceviewer_QTraceFileLoader()
 {
 }
 
+//-----------------------------------------------------------------------------
+vktrace_trace_packet_header* vktraceviewer_QTraceFileLoader::interpret_trace_packet(void* pUserData, vktrace_trace_packet_header* pHeader)
+{
+    return ((vktraceviewer_QController*)pUserData)->InterpretTracePacket(pHeader);
+}
+
 //-----------------------------------------------------------------------------
 void vktraceviewer_QTraceFileLoader::loadTraceFile(const QString& filename)
 {
@@ -75,56 +81,38 @@ void vktraceviewer_QTraceFileLoader::loadTraceFile(const QString& filename)
                 connect(m_pController, SIGNAL(OutputMessage(VktraceLogLevel, const QString&)), this, SIGNAL(OutputMessage(VktraceLogLevel, const QString&)));
                 connect(m_pController, SIGNAL(OutputMessage(VktraceLogLevel, uint64_t, const QString&)), this, SIGNAL(OutputMessage(VktraceLogLevel, uint64_t, const QString&)));
 
-                // interpret the trace file packets
+                // Packets are interpreted as they are paged in, so only interpret the first API packet here
+                // to make sure the controller understands this trace file.
+                m_traceFileInfo.pfnInterpretPacket = interpret_trace_packet;
+                m_traceFileInfo.pInterpretUserData = m_pController;
                 for (uint64_t i = 0; i < m_traceFileInfo.packetCount; i++)
                 {
-                    vktraceviewer_trace_file_packet_offsets* pOffsets = &m_traceFileInfo.pPacketOffsets[i];
-                    switch (pOffsets->pHeader->packet_id) {
-                        case VKTRACE_TPI_MESSAGE:
-                            m_traceFileInfo.pPacketOffsets[i].pHeader = vktrace_interpret_body_as_trace_packet_message(pOffsets->pHeader)->pHeader;
-                            break;
-                        case VKTRACE_TPI_MARKER_CHECKPOINT:
-                            break;
-                        case VKTRACE_TPI_MARKER_API_BOUNDARY:
-                            break;
-                        case VKTRACE_TPI_MARKER_API_GROUP_BEGIN:
-                            break;
-                        case VKTRACE_TPI_MARKER_API_GROUP_END:
-                            break;
-                        case VKTRACE_TPI_MARKER_TERMINATE_PROCESS:
-                            break;
-                        //TODO processing code for all the above cases
-                        default:
-                        {
-                            vktrace_trace_packet_header* pHeader = m_pController->InterpretTracePacket(pOffsets->pHeader);
-                            if (pHeader == NULL)
-                            {
-                                bOpened = false;
-                                emit OutputMessage(VKTRACE_LOG_ERROR, QString("Unrecognized packet type: %1").arg(pOffsets->pHeader->packet_id));
-                                m_traceFileInfo.pPacketOffsets[i].pHeader = NULL;
-                                break;
-                            }
-                            m_traceFileInfo.pPacketOffsets[i].pHeader = pHeader;
-                        }
+                    if (m_traceFileInfo.pPacketOffsets[i].packet_id < VKTRACE_TPI_BEGIN_API_HERE)
+                    {
+                        continue;
                     }
 
-                    // break from loop if there is an error
-                    if (bOpened == false)
+                    if (vktraceviewer_get_trace_packet(&m_traceFileInfo, i) == NULL)
                     {
-                        break;
+                        bOpened = false;
+                        emit OutputMessage(VKTRACE_LOG_ERROR, QString("Unrecognized packet type: %1").arg(m_traceFileInfo.pPacketOffsets[i].packet_id));
                     }
+                    break;
                 }
+                m_traceFileInfo.pfnInterpretPacket = NULL;
+                m_traceFileInfo.pInterpretUserData = NULL;
 
                 m_controllerFactory.Unload(&m_pController);
             }
         }
 
-        // TODO: We don't really want to close the trace file yet.
-        // I think we want to keep it open so that we can dynamically read from it.
-        // BUT we definitely don't want it to get locked open, so we need a smart
-        // way to open / close from it when reading.
-        fclose(m_traceFileInfo.pFile);
-        m_traceFileInfo.pFile = NULL;
+        // The trace file stays open while it is viewed so that packets can be paged in from it.
+        if (!bOpened)
+        {
+            vktraceviewer_release_trace_file_info(&m_traceFileInfo);
+            fclose(m_traceFileInfo.pFile);
+            m_traceFileInfo.pFile = NULL;
+        }
     }
 
     // populate the UI based on trace file info
@@ -190,86 +178,45 @@ bool vktraceviewer_QTraceFileLoader::populate_trace_file_info(vktraceviewer_trac
         return false;
     }
 
-    // Find out how many trace packets there are.
-
-    // Seek to first packet
-    long first_offset = pTraceFileInfo->header.first_packet_offset;
-    int seekResult = fseek(pTraceFileInfo->pFile, first_offset, SEEK_SET);
-    if (seekResult != 0)
+    if (pTraceFileInfo->header.trace_file_version == VKTRACE_TRACE_FILE_VERSION_4)
     {
-        emit OutputMessage(VKTRACE_LOG_WARNING, "Failed to seek to the first packet offset in the trace file.");
+        if (!vktraceviewer_open_compressed_trace_file(pTraceFileInfo))
+        {
+            emit OutputMessage(VKTRACE_LOG_ERROR, "Unable to read compressed trace file.");
+            return false;
+        }
+        emit OutputMessage(VKTRACE_LOG_VERBOSE, QString("Compressed trace file indexes %1 frames.").arg(vktrace_compressed_file_get_frame_count(pTraceFileInfo->pCompressedFile)));
     }
-
-    uint64_t fileOffset = pTraceFileInfo->header.first_packet_offset;
-    uint64_t packetSize = 0;
-    while(1 == fread(&packetSize, sizeof(uint64_t), 1, pTraceFileInfo->pFile))
+    else if (!vktraceviewer_map_trace_file(pTraceFileInfo))
     {
-        // success!
-        pTraceFileInfo->packetCount++;
-        fileOffset += packetSize;
-
-        fseek(pTraceFileInfo->pFile, fileOffset, SEEK_SET);
+        emit OutputMessage(VKTRACE_LOG_WARNING, "Unable to map the trace file, packets will be read from it as they are needed.");
     }
 
-    if (pTraceFileInfo->packetCount == 0)
+    if (vktraceviewer_read_packet_index(pTraceFileInfo))
     {
-        if (ferror(pTraceFileInfo->pFile) != 0)
-        {
-            perror("File Read error:");
-            emit OutputMessage(VKTRACE_LOG_ERROR, "There was an error reading the trace file.");
-            return false;
-        }
-        else if (feof(pTraceFileInfo->pFile) != 0)
-        {
-            emit OutputMessage(VKTRACE_LOG_WARNING, "Reached the end of the file.");
-        }
-        emit OutputMessage(VKTRACE_LOG_WARNING, "There are no trace packets in this trace file.");
-        pTraceFileInfo->pPacketOffsets = NULL;
+        emit OutputMessage(VKTRACE_LOG_VERBOSE, "Loaded the packet index saved next to the trace file.");
     }
     else
     {
-        pTraceFileInfo->pPacketOffsets = VKTRACE_NEW_ARRAY(vktraceviewer_trace_file_packet_offsets, pTraceFileInfo->packetCount);
-
-        // rewind to first packet and this time, populate the packet offsets
-        if (fseek(pTraceFileInfo->pFile, first_offset, SEEK_SET) != 0)
+        if (!vktraceviewer_build_packet_index(pTraceFileInfo))
         {
-            emit OutputMessage(VKTRACE_LOG_ERROR, "Unable to rewind trace file to gather packet offsets.");
+            emit OutputMessage(VKTRACE_LOG_ERROR, "Unable to read in a trace packet.");
             return false;
         }
 
-        unsigned int packetIndex = 0;
-        fileOffset = first_offset;
-        while(1 == fread(&packetSize, sizeof(uint64_t), 1, pTraceFileInfo->pFile))
+        if (!vktraceviewer_write_packet_index(pTraceFileInfo))
         {
-            // the fread confirms that this packet exists
-            // NOTE: We do not actually read the entire packet into memory right now.
-            pTraceFileInfo->pPacketOffsets[packetIndex].fileOffset = fileOffset;
-
-            // rewind slightly
-            fseek(pTraceFileInfo->pFile, -1*(long)sizeof(uint64_t), SEEK_CUR);
-
-            // allocate space for the packet and read it in
-            pTraceFileInfo->pPacketOffsets[packetIndex].pHeader = (vktrace_trace_packet_header*)vktrace_malloc(packetSize);
-            if (1 != fread(pTraceFileInfo->pPacketOffsets[packetIndex].pHeader, packetSize, 1, pTraceFileInfo->pFile))
-            {
-                emit OutputMessage(VKTRACE_LOG_ERROR, "Unable to read in a trace packet.");
-                return false;
-            }
-
-            // adjust pointer to body of the packet
-            pTraceFileInfo->pPacketOffsets[packetIndex].pHeader->pBody = (uintptr_t)pTraceFileInfo->pPacketOffsets[packetIndex].pHeader + sizeof(vktrace_trace_packet_header);
-
-            // now seek to what should be the next packet
-            fileOffset += packetSize;
-            packetIndex++;
+            emit OutputMessage(VKTRACE_LOG_VERBOSE, "Unable to save the packet index next to the trace file.");
         }
+    }
 
-        if (fseek(pTraceFileInfo->pFile, first_offset, SEEK_SET) != 0)
-        {
-            emit OutputMessage(VKTRACE_LOG_ERROR, "Unable to rewind trace file to restore position.");
-            return false;
-        }
+    if (pTraceFileInfo->packetCount == 0)
+    {
+        emit OutputMessage(VKTRACE_LOG_WARNING, "There are no trace packets in this trace file.");
     }
 
+    pTraceFileInfo->pPacketLock = VKTRACE_NEW(VKTRACE_CRITICAL_SECTION);
+    vktrace_create_critical_section(pTraceFileInfo->pPacketLock);
+
     return true;
 }
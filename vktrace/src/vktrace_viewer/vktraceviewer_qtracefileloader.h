@@ -53,6 +53,8 @@ private:
 
     bool populate_trace_file_info(vktraceviewer_trace_file_info* pTraceFileInfo);
 
+    static vktrace_trace_packet_header* interpret_trace_packet(void* pUserData, vktrace_trace_packet_header* pHeader);
+
 };
 
 #endif // VKTRACEVIEWER_QTRACEFILELOADER_H
@@ -21,6 +21,117 @@
 #include "vktraceviewer_trace_file_utils.h"
 #include "vktrace_memory.h"
 
+extern "C" {
+#include "vktrace_trace_packet_utils.h"
+}
+
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+#include <sys/stat.h>
+#if defined(PLATFORM_LINUX)
+#include <sys/mman.h>
+#elif defined(WIN32)
+#include <io.h>
+#endif
+
+// The packet index is saved next to the trace file as <trace file>.vtidx:
+// a vktraceviewer_packet_index_header followed by packetCount vktraceviewer_trace_file_packet_offsets.
+#define VKTRACEVIEWER_PACKET_INDEX_MAGIC 0x58444954 // "TIDX"
+#define VKTRACEVIEWER_PACKET_INDEX_VERSION 2
+
+struct vktraceviewer_packet_index_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entrySize;
+    uint32_t reserved;
+    uint64_t traceFileSize;
+    int64_t traceFileModified;
+    uint64_t packetCount;
+};
+
+struct vktraceviewer_packet_cache
+{
+    struct cached_packet
+    {
+        vktrace_trace_packet_header* pHeader;
+        std::list<uint64_t>::iterator lruPosition;
+    };
+
+    // packet indices, most recently used first
+    std::list<uint64_t> lru;
+    std::unordered_map<uint64_t, cached_packet> packets;
+    uint64_t bytes = 0;
+};
+
+static bool get_trace_file_stats(FILE* pFile, uint64_t* pSize, int64_t* pModified)
+{
+#if defined(WIN32)
+    struct _stat64 fileStat;
+    if (_fstat64(_fileno(pFile), &fileStat) != 0)
+        return false;
+#else
+    struct stat fileStat;
+    if (fstat(fileno(pFile), &fileStat) != 0)
+        return false;
+#endif
+    *pSize = (uint64_t)fileStat.st_size;
+    *pModified = (int64_t)fileStat.st_mtime;
+    return true;
+}
+
+static bool seek_trace_file(FILE* pFile, uint64_t offset)
+{
+#if defined(WIN32)
+    return _fseeki64(pFile, (__int64)offset, SEEK_SET) == 0;
+#else
+    return fseeko(pFile, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+// Packets are found at offsets in [begin, end) of the packet stream,
+// which for compressed trace files is the uncompressed stream rather than the file.
+static void get_packet_stream_range(vktraceviewer_trace_file_info* pTraceFileInfo, uint64_t traceFileSize, uint64_t* pBegin, uint64_t* pEnd)
+{
+    if (pTraceFileInfo->pCompressedFile != NULL)
+    {
+        *pBegin = 0;
+        *pEnd = vktrace_compressed_file_get_size(pTraceFileInfo->pCompressedFile);
+    }
+    else
+    {
+        *pBegin = pTraceFileInfo->header.first_packet_offset;
+        *pEnd = traceFileSize;
+    }
+}
+
+static bool read_packet_stream(vktraceviewer_trace_file_info* pTraceFileInfo, uint64_t offset, void* pData, size_t size)
+{
+    if (pTraceFileInfo->pCompressedFile != NULL)
+    {
+        return vktrace_compressed_file_seek(pTraceFileInfo->pCompressedFile, offset) &&
+               vktrace_compressed_file_read(pTraceFileInfo->pCompressedFile, pData, size);
+    }
+    if (pTraceFileInfo->pMappedData != NULL)
+    {
+        memcpy(pData, pTraceFileInfo->pMappedData + offset, size);
+        return true;
+    }
+    return pTraceFileInfo->pFile != NULL &&
+           seek_trace_file(pTraceFileInfo->pFile, offset) &&
+           1 == fread(pData, size, 1, pTraceFileInfo->pFile);
+}
+
+static char* get_packet_index_filename(const char* pTraceFilename)
+{
+    size_t length = strlen(pTraceFilename);
+    char* pIndexFilename = VKTRACE_NEW_ARRAY(char, length + sizeof(".vtidx"));
+    memcpy(pIndexFilename, pTraceFilename, length);
+    memcpy(pIndexFilename + length, ".vtidx", sizeof(".vtidx"));
+    return pIndexFilename;
+}
+
 BOOL vktraceviewer_populate_trace_file_info(vktraceviewer_trace_file_info* pTraceFileInfo)
 {
     assert(pTraceFileInfo != NULL);
@@ -33,86 +144,408 @@ BOOL vktraceviewer_populate_trace_file_info(vktraceviewer_trace_file_info* pTrac
         return FALSE;
     }
 
-    // Find out how many trace packets there are.
+    if (pTraceFileInfo->header.trace_file_version == VKTRACE_TRACE_FILE_VERSION_4)
+    {
+        if (!vktraceviewer_open_compressed_trace_file(pTraceFileInfo))
+        {
+            vktraceviewer_output_error("Unable to read compressed trace file.");
+            return FALSE;
+        }
+    }
+    else if (!vktraceviewer_map_trace_file(pTraceFileInfo))
+    {
+        vktraceviewer_output_warning("Unable to map the trace file, packets will be read from it as they are needed.");
+    }
+
+    if (!vktraceviewer_read_packet_index(pTraceFileInfo))
+    {
+        if (!vktraceviewer_build_packet_index(pTraceFileInfo))
+        {
+            vktraceviewer_output_error("Unable to read in a trace packet.");
+            return FALSE;
+        }
+        vktraceviewer_write_packet_index(pTraceFileInfo);
+    }
+
+    if (pTraceFileInfo->packetCount == 0)
+    {
+        vktraceviewer_output_warning("There are no trace packets in this trace file.");
+    }
+
+    pTraceFileInfo->pPacketLock = VKTRACE_NEW(VKTRACE_CRITICAL_SECTION);
+    vktrace_create_critical_section(pTraceFileInfo->pPacketLock);
+
+    return TRUE;
+}
+
+BOOL vktraceviewer_map_trace_file(vktraceviewer_trace_file_info* pTraceFileInfo)
+{
+    assert(pTraceFileInfo->pFile != NULL);
+    assert(pTraceFileInfo->pMappedData == NULL);
+
+    int64_t modified = 0;
+    if (!get_trace_file_stats(pTraceFileInfo->pFile, &pTraceFileInfo->fileSize, &modified))
+        return FALSE;
+    if (pTraceFileInfo->fileSize == 0 || pTraceFileInfo->fileSize > (uint64_t)SIZE_MAX)
+        return FALSE;
+
+    // Packets are copied out of the view when they are paged in, so it is only read and its pages stay
+    // in the page cache, where the kernel can drop them again.
+#if defined(PLATFORM_LINUX)
+    void* pData = mmap(NULL, (size_t)pTraceFileInfo->fileSize, PROT_READ, MAP_SHARED, fileno(pTraceFileInfo->pFile), 0);
+    if (pData == MAP_FAILED)
+        return FALSE;
+    madvise(pData, (size_t)pTraceFileInfo->fileSize, MADV_RANDOM);
+    pTraceFileInfo->pMappedData = (uint8_t*)pData;
+    return TRUE;
+#elif defined(WIN32)
+    HANDLE hFile = (HANDLE)_get_osfhandle(_fileno(pTraceFileInfo->pFile));
+    if (hFile == INVALID_HANDLE_VALUE)
+        return FALSE;
+    pTraceFileInfo->hMapping = CreateFileMapping(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (pTraceFileInfo->hMapping == NULL)
+        return FALSE;
+    pTraceFileInfo->pMappedData = (uint8_t*)MapViewOfFile(pTraceFileInfo->hMapping, FILE_MAP_READ, 0, 0, 0);
+    if (pTraceFileInfo->pMappedData == NULL)
+    {
+        CloseHandle(pTraceFileInfo->hMapping);
+        pTraceFileInfo->hMapping = NULL;
+        return FALSE;
+    }
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
+BOOL vktraceviewer_open_compressed_trace_file(vktraceviewer_trace_file_info* pTraceFileInfo)
+{
+    assert(pTraceFileInfo->pFile != NULL);
+    assert(pTraceFileInfo->pCompressedFile == NULL);
+
+    pTraceFileInfo->pCompressedFile = vktrace_compressed_file_open(pTraceFileInfo->pFile, pTraceFileInfo->header.first_packet_offset);
+    return (pTraceFileInfo->pCompressedFile != NULL) ? TRUE : FALSE;
+}
+
+BOOL vktraceviewer_read_packet_index(vktraceviewer_trace_file_info* pTraceFileInfo)
+{
+    assert(pTraceFileInfo->pPacketOffsets == NULL);
 
-    // Seek to first packet
-    long first_offset = pTraceFileInfo->header.first_packet_offset;
-    int seekResult = fseek(pTraceFileInfo->pFile, first_offset, SEEK_SET);
-    if (seekResult != 0)
+    uint64_t traceFileSize = 0;
+    int64_t traceFileModified = 0;
+    if (pTraceFileInfo->filename == NULL ||
+        !get_trace_file_stats(pTraceFileInfo->pFile, &traceFileSize, &traceFileModified))
     {
-        vktraceviewer_output_warning("Failed to seek to the first packet offset in the trace file.");
+        return FALSE;
     }
 
-    uint64_t fileOffset = pTraceFileInfo->header.first_packet_offset;
-    uint64_t packetSize = 0;
-    while(1 == fread(&packetSize, sizeof(uint64_t), 1, pTraceFileInfo->pFile))
+    char* pIndexFilename = get_packet_index_filename(pTraceFileInfo->filename);
+    FILE* pIndexFile = fopen(pIndexFilename, "rb");
+    VKTRACE_DELETE(pIndexFilename);
+    if (pIndexFile == NULL)
     {
-        // success!
-        pTraceFileInfo->packetCount++;
-        fileOffset += packetSize;
+        return FALSE;
+    }
+
+    uint64_t streamBegin = 0;
+    uint64_t streamEnd = 0;
+    get_packet_stream_range(pTraceFileInfo, traceFileSize, &streamBegin, &streamEnd);
 
-        fseek(pTraceFileInfo->pFile, fileOffset, SEEK_SET);
+    vktraceviewer_packet_index_header indexHeader;
+    if (1 != fread(&indexHeader, sizeof(indexHeader), 1, pIndexFile) ||
+        indexHeader.magic != VKTRACEVIEWER_PACKET_INDEX_MAGIC ||
+        indexHeader.version != VKTRACEVIEWER_PACKET_INDEX_VERSION ||
+        indexHeader.entrySize != sizeof(vktraceviewer_trace_file_packet_offsets) ||
+        indexHeader.traceFileSize != traceFileSize ||
+        indexHeader.traceFileModified != traceFileModified ||
+        indexHeader.packetCount > streamEnd / sizeof(vktrace_trace_packet_header) ||
+        indexHeader.packetCount > SIZE_MAX / sizeof(vktraceviewer_trace_file_packet_offsets))
+    {
+        fclose(pIndexFile);
+        return FALSE;
     }
 
-    if (pTraceFileInfo->packetCount == 0)
+    vktraceviewer_trace_file_packet_offsets* pPacketOffsets = NULL;
+    if (indexHeader.packetCount > 0)
     {
-        if (ferror(pTraceFileInfo->pFile) != 0)
+        pPacketOffsets = VKTRACE_NEW_ARRAY(vktraceviewer_trace_file_packet_offsets, indexHeader.packetCount);
+        bool bValid = (indexHeader.packetCount == fread(pPacketOffsets, sizeof(vktraceviewer_trace_file_packet_offsets), (size_t)indexHeader.packetCount, pIndexFile));
+        for (uint64_t i = 0; bValid && i < indexHeader.packetCount; i++)
         {
-            perror("File Read error:");
-            vktraceviewer_output_warning("There was an error reading the trace file.");
-            return FALSE;
+            bValid = pPacketOffsets[i].size >= sizeof(vktrace_trace_packet_header) &&
+                     pPacketOffsets[i].fileOffset >= streamBegin &&
+                     pPacketOffsets[i].fileOffset <= streamEnd &&
+                     pPacketOffsets[i].size <= streamEnd - pPacketOffsets[i].fileOffset;
         }
-        else if (feof(pTraceFileInfo->pFile) != 0)
+        if (!bValid)
         {
-            vktraceviewer_output_warning("Reached the end of the file.");
+            VKTRACE_DELETE(pPacketOffsets);
+            fclose(pIndexFile);
+            return FALSE;
         }
-        vktraceviewer_output_warning("There are no trace packets in this trace file.");
-        pTraceFileInfo->pPacketOffsets = NULL;
     }
-    else
+    fclose(pIndexFile);
+
+    pTraceFileInfo->fileSize = traceFileSize;
+    pTraceFileInfo->packetCount = indexHeader.packetCount;
+    pTraceFileInfo->pPacketOffsets = pPacketOffsets;
+    return TRUE;
+}
+
+BOOL vktraceviewer_build_packet_index(vktraceviewer_trace_file_info* pTraceFileInfo)
+{
+    assert(pTraceFileInfo->pPacketOffsets == NULL);
+
+    uint64_t traceFileSize = 0;
+    int64_t traceFileModified = 0;
+    if (!get_trace_file_stats(pTraceFileInfo->pFile, &traceFileSize, &traceFileModified))
     {
-        pTraceFileInfo->pPacketOffsets = VKTRACE_NEW_ARRAY(vktraceviewer_trace_file_packet_offsets, pTraceFileInfo->packetCount);
+        return FALSE;
+    }
+    pTraceFileInfo->fileSize = traceFileSize;
 
-        // rewind to first packet and this time, populate the packet offsets
-        if (fseek(pTraceFileInfo->pFile, first_offset, SEEK_SET) != 0)
+    // Only the packet headers are read; bodies are paged in by vktraceviewer_get_trace_packet().
+    uint64_t capacity = 0;
+    uint64_t packetCount = 0;
+    vktraceviewer_trace_file_packet_offsets* pPacketOffsets = NULL;
+    uint64_t fileOffset = 0;
+    uint64_t streamEnd = 0;
+    get_packet_stream_range(pTraceFileInfo, traceFileSize, &fileOffset, &streamEnd);
+    while (fileOffset < streamEnd && streamEnd - fileOffset >= sizeof(uint64_t))
+    {
+        vktrace_trace_packet_header header;
+        if (streamEnd - fileOffset < sizeof(vktrace_trace_packet_header) ||
+            !read_packet_stream(pTraceFileInfo, fileOffset, &header, sizeof(header)))
         {
-            vktraceviewer_output_error("Unable to rewind trace file to gather packet offsets.");
+            VKTRACE_DELETE(pPacketOffsets);
             return FALSE;
         }
 
-        unsigned int packetIndex = 0;
-        fileOffset = first_offset;
-        while(1 == fread(&packetSize, sizeof(uint64_t), 1, pTraceFileInfo->pFile))
+        if (header.size < sizeof(vktrace_trace_packet_header) || header.size > streamEnd - fileOffset)
         {
-            // the fread confirms that this packet exists
-            // NOTE: We do not actually read the entire packet into memory right now.
-            pTraceFileInfo->pPacketOffsets[packetIndex].fileOffset = fileOffset;
+            VKTRACE_DELETE(pPacketOffsets);
+            return FALSE;
+        }
 
-            // rewind slightly
-            fseek(pTraceFileInfo->pFile, -1*(long)sizeof(uint64_t), SEEK_CUR);
+        if (packetCount == capacity)
+        {
+            capacity = (capacity == 0) ? 4096 : capacity * 2;
+            pPacketOffsets = (vktraceviewer_trace_file_packet_offsets*)vktrace_realloc(pPacketOffsets, sizeof(vktraceviewer_trace_file_packet_offsets) * capacity);
+        }
 
-            // allocate space for the packet and read it in
-            pTraceFileInfo->pPacketOffsets[packetIndex].pHeader = (vktrace_trace_packet_header*)vktrace_malloc(packetSize);
-            if (1 != fread(pTraceFileInfo->pPacketOffsets[packetIndex].pHeader, packetSize, 1, pTraceFileInfo->pFile))
-            {
-                vktraceviewer_output_error("Unable to read in a trace packet.");
-                return FALSE;
-            }
+        vktraceviewer_trace_file_packet_offsets* pEntry = &pPacketOffsets[packetCount++];
+        memset(pEntry, 0, sizeof(*pEntry));
+        pEntry->fileOffset = fileOffset;
+        pEntry->size = header.size;
+        pEntry->global_packet_index = header.global_packet_index;
+        pEntry->entrypoint_begin_time = header.entrypoint_begin_time;
+        pEntry->entrypoint_end_time = header.entrypoint_end_time;
+        pEntry->thread_id = header.thread_id;
+        uint64_t overhead = (header.vktrace_end_time - header.vktrace_begin_time) - (header.entrypoint_end_time - header.entrypoint_begin_time);
+        pEntry->trace_overhead = (overhead > UINT32_MAX) ? UINT32_MAX : (uint32_t)overhead;
+        pEntry->packet_id = header.packet_id;
+        pEntry->tracer_id = header.tracer_id;
+
+        // now move to what should be the next packet
+        fileOffset += header.size;
+    }
+
+    pTraceFileInfo->packetCount = packetCount;
+    pTraceFileInfo->pPacketOffsets = pPacketOffsets;
+    return TRUE;
+}
+
+BOOL vktraceviewer_write_packet_index(const vktraceviewer_trace_file_info* pTraceFileInfo)
+{
+    vktraceviewer_packet_index_header indexHeader;
+    memset(&indexHeader, 0, sizeof(indexHeader));
+    indexHeader.magic = VKTRACEVIEWER_PACKET_INDEX_MAGIC;
+    indexHeader.version = VKTRACEVIEWER_PACKET_INDEX_VERSION;
+    indexHeader.entrySize = sizeof(vktraceviewer_trace_file_packet_offsets);
+    indexHeader.packetCount = pTraceFileInfo->packetCount;
+    if (pTraceFileInfo->filename == NULL ||
+        !get_trace_file_stats(pTraceFileInfo->pFile, &indexHeader.traceFileSize, &indexHeader.traceFileModified))
+    {
+        return FALSE;
+    }
+
+    // The index is only a cache, so it is fine if it cannot be written (e.g. the trace is on a read-only share).
+    // A partly written index is rejected when it is read because it is too short.
+    char* pIndexFilename = get_packet_index_filename(pTraceFileInfo->filename);
+    FILE* pIndexFile = fopen(pIndexFilename, "wb");
+    if (pIndexFile == NULL)
+    {
+        VKTRACE_DELETE(pIndexFilename);
+        return FALSE;
+    }
+
+    bool bWritten = (1 == fwrite(&indexHeader, sizeof(indexHeader), 1, pIndexFile)) &&
+                    (pTraceFileInfo->packetCount == fwrite(pTraceFileInfo->pPacketOffsets, sizeof(vktraceviewer_trace_file_packet_offsets), (size_t)pTraceFileInfo->packetCount, pIndexFile));
+    bWritten = (fclose(pIndexFile) == 0) && bWritten;
+
+    if (!bWritten)
+    {
+        remove(pIndexFilename);
+    }
+    VKTRACE_DELETE(pIndexFilename);
+    return bWritten ? TRUE : FALSE;
+}
+
+BOOL vktraceviewer_get_frame_packet_index(const vktraceviewer_trace_file_info* pTraceFileInfo, uint64_t frame, uint64_t* pPacketIndex)
+{
+    uint64_t frameOffset = 0;
+    if (pTraceFileInfo->pCompressedFile == NULL ||
+        !vktrace_compressed_file_get_frame_offset(pTraceFileInfo->pCompressedFile, frame, &frameOffset))
+    {
+        return FALSE;
+    }
+
+    // packets are indexed in stream order, so the first one at or past the frame offset starts the frame
+    const vktraceviewer_trace_file_packet_offsets* pBegin = pTraceFileInfo->pPacketOffsets;
+    const vktraceviewer_trace_file_packet_offsets* pEnd = pBegin + pTraceFileInfo->packetCount;
+    const vktraceviewer_trace_file_packet_offsets* pFound = std::lower_bound(pBegin, pEnd, frameOffset,
+        [](const vktraceviewer_trace_file_packet_offsets& entry, uint64_t offset) { return entry.fileOffset < offset; });
+    if (pFound == pEnd)
+    {
+        return FALSE;
+    }
+    *pPacketIndex = (uint64_t)(pFound - pBegin);
+    return TRUE;
+}
+
+// Adds a packet that was just paged in to the front of the cache, then frees the least recently used packets
+// while the cache holds more than VKTRACEVIEWER_PACKET_CACHE_BYTES, always keeping VKTRACEVIEWER_MIN_CACHED_PACKETS.
+static void packet_cache_insert(vktraceviewer_trace_file_info* pTraceFileInfo, uint64_t packetIndex, vktrace_trace_packet_header* pHeader)
+{
+    vktraceviewer_packet_cache* pCache = pTraceFileInfo->pPacketCache;
+    pCache->lru.push_front(packetIndex);
+    vktraceviewer_packet_cache::cached_packet& cached = pCache->packets[packetIndex];
+    cached.pHeader = pHeader;
+    cached.lruPosition = pCache->lru.begin();
+    pCache->bytes += pTraceFileInfo->pPacketOffsets[packetIndex].size;
 
+    while (pCache->lru.size() > VKTRACEVIEWER_MIN_CACHED_PACKETS && pCache->bytes > VKTRACEVIEWER_PACKET_CACHE_BYTES)
+    {
+        uint64_t evictIndex = pCache->lru.back();
+        pCache->lru.pop_back();
+        auto evicted = pCache->packets.find(evictIndex);
+        vktrace_free(evicted->second.pHeader);
+        pCache->packets.erase(evicted);
+        pCache->bytes -= pTraceFileInfo->pPacketOffsets[evictIndex].size;
+    }
+}
+
+vktrace_trace_packet_header* vktraceviewer_get_trace_packet(vktraceviewer_trace_file_info* pTraceFileInfo, uint64_t packetIndex)
+{
+    assert(packetIndex < pTraceFileInfo->packetCount);
+    const vktraceviewer_trace_file_packet_offsets* pOffsets = &pTraceFileInfo->pPacketOffsets[packetIndex];
+
+    if (pTraceFileInfo->pPacketLock != NULL)
+    {
+        vktrace_enter_critical_section(pTraceFileInfo->pPacketLock);
+    }
+    if (pTraceFileInfo->pPacketCache == NULL)
+    {
+        pTraceFileInfo->pPacketCache = new vktraceviewer_packet_cache();
+    }
+
+    vktrace_trace_packet_header* pHeader = NULL;
+    vktraceviewer_packet_cache* pCache = pTraceFileInfo->pPacketCache;
+    auto cached = pCache->packets.find(packetIndex);
+    if (cached != pCache->packets.end())
+    {
+        pHeader = cached->second.pHeader;
+        pCache->lru.splice(pCache->lru.begin(), pCache->lru, cached->second.lruPosition);
+    }
+    else
+    {
+        pHeader = (vktrace_trace_packet_header*)vktrace_malloc((size_t)pOffsets->size);
+        vktrace_trace_packet_header* pInterpreted = NULL;
+        if (read_packet_stream(pTraceFileInfo, pOffsets->fileOffset, pHeader, (size_t)pOffsets->size))
+        {
             // adjust pointer to body of the packet
-            pTraceFileInfo->pPacketOffsets[packetIndex].pHeader->pBody = (uintptr_t)pTraceFileInfo->pPacketOffsets[packetIndex].pHeader + sizeof(vktrace_trace_packet_header);
+            pHeader->pBody = (uintptr_t)pHeader + sizeof(vktrace_trace_packet_header);
 
-            // now seek to what should be the next packet
-            fileOffset += packetSize;
-            packetIndex++;
+            switch (pHeader->packet_id)
+            {
+                case VKTRACE_TPI_MESSAGE:
+                    pInterpreted = vktrace_interpret_body_as_trace_packet_message(pHeader)->pHeader;
+                    break;
+                case VKTRACE_TPI_MARKER_CHECKPOINT:
+                case VKTRACE_TPI_MARKER_API_BOUNDARY:
+                case VKTRACE_TPI_MARKER_API_GROUP_BEGIN:
+                case VKTRACE_TPI_MARKER_API_GROUP_END:
+                case VKTRACE_TPI_MARKER_TERMINATE_PROCESS:
+                    pInterpreted = pHeader;
+                    break;
+                default:
+                    if (pTraceFileInfo->pfnInterpretPacket != NULL)
+                    {
+                        pInterpreted = pTraceFileInfo->pfnInterpretPacket(pTraceFileInfo->pInterpretUserData, pHeader);
+                    }
+                    break;
+            }
         }
 
-        if (fseek(pTraceFileInfo->pFile, first_offset, SEEK_SET) != 0)
+        if (pInterpreted == NULL)
         {
-            vktraceviewer_output_error("Unable to rewind trace file to restore position.");
-            return FALSE;
+            vktrace_free(pHeader);
+        }
+        else
+        {
+            packet_cache_insert(pTraceFileInfo, packetIndex, pInterpreted);
         }
+        pHeader = pInterpreted;
     }
 
-    return TRUE;
+    if (pTraceFileInfo->pPacketLock != NULL)
+    {
+        vktrace_leave_critical_section(pTraceFileInfo->pPacketLock);
+    }
+
+    return pHeader;
+}
+
+void vktraceviewer_release_trace_file_info(vktraceviewer_trace_file_info* pTraceFileInfo)
+{
+    if (pTraceFileInfo->pPacketCache != NULL)
+    {
+        for (auto& cached : pTraceFileInfo->pPacketCache->packets)
+        {
+            vktrace_free(cached.second.pHeader);
+        }
+        delete pTraceFileInfo->pPacketCache;
+        pTraceFileInfo->pPacketCache = NULL;
+    }
+
+    if (pTraceFileInfo->pPacketOffsets != NULL)
+    {
+        VKTRACE_DELETE(pTraceFileInfo->pPacketOffsets);
+        pTraceFileInfo->pPacketOffsets = NULL;
+    }
+    pTraceFileInfo->packetCount = 0;
+
+    if (pTraceFileInfo->pMappedData != NULL)
+    {
+#if defined(PLATFORM_LINUX)
+        munmap(pTraceFileInfo->pMappedData, (size_t)pTraceFileInfo->fileSize);
+#elif defined(WIN32)
+        UnmapViewOfFile(pTraceFileInfo->pMappedData);
+        CloseHandle(pTraceFileInfo->hMapping);
+        pTraceFileInfo->hMapping = NULL;
+#endif
+        pTraceFileInfo->pMappedData = NULL;
+    }
+
+    if (pTraceFileInfo->pCompressedFile != NULL)
+    {
+        vktrace_compressed_file_close(&pTraceFileInfo->pCompressedFile);
+    }
+
+    if (pTraceFileInfo->pPacketLock != NULL)
+    {
+        vktrace_delete_critical_section(pTraceFileInfo->pPacketLock);
+        VKTRACE_DELETE(pTraceFileInfo->pPacketLock);
+        pTraceFileInfo->pPacketLock = NULL;
+    }
 }
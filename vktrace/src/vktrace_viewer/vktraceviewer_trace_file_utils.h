@@ -26,18 +26,41 @@
 
 extern "C" {
 #include "vktrace_trace_packet_identifiers.h"
+#include "vktrace_compressed_file.h"
 }
 #include "vktraceviewer_output.h"
 
+// What the packet index keeps of each packet, which is enough to list it without paging it in.
+// Fields other than fileOffset are named after the vktrace_trace_packet_header fields they come from.
+// Use vktraceviewer_get_trace_packet() to look at the packet itself.
 struct vktraceviewer_trace_file_packet_offsets
 {
-    // the file offset to this particular packet
-    unsigned int fileOffset;
+    // the file offset to this particular packet, or its offset in the packet stream of a compressed trace file
+    uint64_t fileOffset;
 
-    // Pointer to the packet header if it's been read from disk
-    vktrace_trace_packet_header* pHeader;
+    uint64_t size;
+    uint64_t global_packet_index;
+    uint64_t entrypoint_begin_time;
+    uint64_t entrypoint_end_time;
+    uint32_t thread_id;
+
+    // time spent tracing the call on top of the call itself, saturated at UINT32_MAX
+    uint32_t trace_overhead;
+
+    uint16_t packet_id;
+    uint8_t tracer_id;
 };
 
+// Packets that have been paged in, most recently used first. Defined in vktraceviewer_trace_file_utils.cpp.
+struct vktraceviewer_packet_cache;
+
+// The packet cache keeps at least this many packets, and more while they fit in VKTRACEVIEWER_PACKET_CACHE_BYTES.
+#define VKTRACEVIEWER_MIN_CACHED_PACKETS 256
+#define VKTRACEVIEWER_PACKET_CACHE_BYTES (64 * 1024 * 1024)
+
+// Interprets a packet that has just been paged in. Returns the interpreted packet, or NULL if it is not recognized.
+typedef vktrace_trace_packet_header* (*vktraceviewer_interpret_packet_func)(void* pUserData, vktrace_trace_packet_header* pHeader);
+
 struct vktraceviewer_trace_file_info
 {
     // the trace file name & path
@@ -46,6 +69,9 @@ struct vktraceviewer_trace_file_info
     // the trace file
     FILE* pFile;
 
+    // size of the trace file in bytes
+    uint64_t fileSize;
+
     // copy of the trace file header
     vktrace_trace_file_header header;
 
@@ -54,8 +80,59 @@ struct vktraceviewer_trace_file_info
 
     // array of packet offsets
     vktraceviewer_trace_file_packet_offsets* pPacketOffsets;
+
+    // read-only view of the whole trace file that packets are copied from when they are paged in,
+    // or NULL if the file could not be mapped and packets are read from pFile instead
+    uint8_t* pMappedData;
+#if defined(WIN32)
+    HANDLE hMapping;
+#endif
+
+    // packets of compressed trace files are read through this instead of pFile, which is then never mapped
+    vktrace_compressed_file* pCompressedFile;
+
+    // interprets packets as they are paged in, NULL until a controller has been loaded
+    vktraceviewer_interpret_packet_func pfnInterpretPacket;
+    void* pInterpretUserData;
+
+    // packets that have been paged in; the least recently used are freed once it holds too many bytes
+    vktraceviewer_packet_cache* pPacketCache;
+
+    // serializes paging packets in, which both the UI and the replay worker do
+    VKTRACE_CRITICAL_SECTION* pPacketLock;
 };
 
 BOOL vktraceviewer_populate_trace_file_info(vktraceviewer_trace_file_info* pTraceFileInfo);
 
+// Maps the trace file so that packets can be paged in from it. Returns FALSE if it could not be mapped,
+// in which case packets are read from pFile instead.
+BOOL vktraceviewer_map_trace_file(vktraceviewer_trace_file_info* pTraceFileInfo);
+
+// Opens the packet stream of a compressed trace file. Returns FALSE if its chunks cannot be read.
+BOOL vktraceviewer_open_compressed_trace_file(vktraceviewer_trace_file_info* pTraceFileInfo);
+
+// Loads the packet index from the file next to the trace that vktraceviewer_write_packet_index() wrote.
+// Returns FALSE if there is no index file or if it does not match the trace file.
+BOOL vktraceviewer_read_packet_index(vktraceviewer_trace_file_info* pTraceFileInfo);
+
+// Builds the packet index by walking the packet headers of the trace file.
+BOOL vktraceviewer_build_packet_index(vktraceviewer_trace_file_info* pTraceFileInfo);
+
+// Saves the packet index next to the trace file so that the next open does not need to build it.
+BOOL vktraceviewer_write_packet_index(const vktraceviewer_trace_file_info* pTraceFileInfo);
+
+// Finds the first packet of frame (0 based) through the frame index of a compressed trace file, so that
+// only the chunk holding it needs to be decompressed when it is looked at. Returns FALSE if the trace
+// has no frame index or has no packets in that frame.
+BOOL vktraceviewer_get_frame_packet_index(const vktraceviewer_trace_file_info* pTraceFileInfo, uint64_t frame, uint64_t* pPacketIndex);
+
+// Returns the interpreted packet at packetIndex, paging it in if it is not in the packet cache,
+// or NULL if it could not be read or interpreted. The packet stays valid until at least
+// VKTRACEVIEWER_MIN_CACHED_PACKETS other packets have been paged in after it.
+vktrace_trace_packet_header* vktraceviewer_get_trace_packet(vktraceviewer_trace_file_info* pTraceFileInfo, uint64_t packetIndex);
+
+// Frees the packet index and the packet cache, and unmaps or closes the packet stream.
+// The trace file itself and the filename are left to the caller.
+void vktraceviewer_release_trace_file_info(vktraceviewer_trace_file_info* pTraceFileInfo);
+
 #endif //VKTRACEVIEWER_TRACE_FILE_UTILS_H_
@@ -43,6 +43,52 @@ proto_exclusions = [ 'CreateAndroidSurfaceKHR', 'CreateWaylandSurfaceKHR', 'Crea
                      'GetDisplayPlaneSupportedDisplaysKHR', 'GetDisplayModePropertiesKHR',
                      'CreateDisplayModeKHR', 'GetDisplayPlaneCapabilitiesKHR', 'CreateDisplayPlaneSurfaceKHR']
 
+# Calls that are only traced inside the trigger capture window (see vktrace_lib_trigger.h). Calls that create,
+# destroy, bind or update objects are always traced so that replay can rebuild the objects that are alive when the
+# window opens; command buffer recording is kept by the trigger until then, and the state that the skipped calls
+# leave behind is written in the preamble.
+capture_window_only_funcs = ['QueueSubmit', 'QueueWaitIdle', 'DeviceWaitIdle', 'QueuePresentKHR', 'AcquireNextImageKHR',
+                             'WaitForFences', 'GetFenceStatus', 'GetEventStatus', 'SetEvent', 'ResetEvent',
+                             'GetQueryPoolResults']
+
+# Calls that tell the trigger about objects and queue state, '%s' is whether the call is traced
+trigger_tracking_txt = {'AcquireNextImageKHR': '    trigger_fence_signaled(fence, %s);\n    trigger_semaphore_signaled(semaphore, %s);',
+                        'QueueBindSparse': '    trigger_fence_signaled(fence, true);\n    trigger_sparse_bound(bindInfoCount, pBindInfo);',
+                        'CreateFence': '    if (result == VK_SUCCESS && (pCreateInfo->flags & VK_FENCE_CREATE_SIGNALED_BIT))\n        trigger_fence_signaled(*pFence, true);',
+                        'DestroyFence': '    trigger_fence_signaled(fence, false);',
+                        'CreateBuffer': '    if (result == VK_SUCCESS)\n        trigger_buffer_created(device, pCreateInfo, *pBuffer);',
+                        'CreateImage': '    if (result == VK_SUCCESS)\n        trigger_image_created(device, pCreateInfo, *pImage);',
+                        'CreateImageView': '    if (result == VK_SUCCESS)\n        trigger_image_view_created(pCreateInfo, *pView);',
+                        'CreateEvent': '    if (result == VK_SUCCESS)\n        trigger_event_created(device, *pEvent);',
+                        'CreateSemaphore': '    if (result == VK_SUCCESS)\n        trigger_semaphore_created(device, *pSemaphore);',
+                        'DestroyBuffer': '    trigger_buffer_destroyed(buffer);',
+                        'DestroyImage': '    trigger_image_destroyed(image);',
+                        'DestroyImageView': '    trigger_image_view_destroyed(imageView);',
+                        'DestroyFramebuffer': '    trigger_framebuffer_destroyed(framebuffer);',
+                        'DestroyRenderPass': '    trigger_render_pass_destroyed(renderPass);',
+                        'DestroyEvent': '    trigger_event_destroyed(event);',
+                        'DestroySemaphore': '    trigger_semaphore_destroyed(semaphore);',
+                        'BindBufferMemory': '    if (result == VK_SUCCESS)\n        trigger_buffer_bound(buffer, memory, memoryOffset);',
+                        'BindImageMemory': '    if (result == VK_SUCCESS)\n        trigger_image_bound(image, memory, memoryOffset);',
+                        'GetDeviceQueue': '    trigger_queue_created(device, queueFamilyIndex, *pQueue);',
+                        'DestroyDevice': '    trigger_device_destroyed(device);',
+                        'FreeCommandBuffers': '    trigger_command_buffers_freed(commandBufferCount, pCommandBuffers);',
+                        'ResetCommandPool': '    if (result == VK_SUCCESS)\n        trigger_command_pool_reset(commandPool, false);',
+                        'DestroyCommandPool': '    trigger_command_pool_reset(commandPool, true);',
+                        'CmdExecuteCommands': '    trigger_commands_executed(commandBuffer, commandBufferCount, pCommandBuffers);',
+                        }
+
+# Create infos that the trigger changes before the call goes down the chain
+trigger_create_info_txt = {'CreateBuffer': '    VkBufferCreateInfo triggerCreateInfo;\n    pCreateInfo = trigger_buffer_create_info(pCreateInfo, &triggerCreateInfo);',
+                           'CreateImage': '    VkImageCreateInfo triggerCreateInfo;\n    pCreateInfo = trigger_image_create_info(device, pCreateInfo, &triggerCreateInfo);',
+                           }
+
+def is_recording_func(func_name):
+    return func_name.startswith('Cmd') or func_name in ['BeginCommandBuffer', 'EndCommandBuffer', 'ResetCommandBuffer']
+
+def is_capture_window_only(func_name):
+    return func_name in capture_window_only_funcs
+
 for ext in vulkan.extensions_all:
     headers.extend(ext.headers)
     objects.extend(ext.objects)
@@ -203,6 +249,9 @@ class Subcommand(object):
         init_tracer.append('        ipAddr = "127.0.0.1";')
         init_tracer.append('    gMessageStream = vktrace_MessageStream_create(FALSE, ipAddr, VKTRACE_BASE_PORT + VKTRACE_TID_VULKAN);')
         init_tracer.append('    vktrace_trace_set_trace_file(vktrace_FileLike_create_msg(gMessageStream));')
+        init_tracer.append('    const char *asyncWrite = vktrace_get_global_var("VKTRACE_ASYNC_WRITE");')
+        init_tracer.append('    if (gMessageStream != NULL && asyncWrite != NULL && atoi(asyncWrite) > 0)')
+        init_tracer.append('        vktrace_enable_async_trace_writer(vktrace_trace_get_trace_file(), (size_t)atoi(asyncWrite) * 1024 * 1024);')
         init_tracer.append('    vktrace_tracelog_set_tracer_id(VKTRACE_TID_VULKAN);')
         init_tracer.append('    vktrace_create_critical_section(&g_memInfoLock);')
         init_tracer.append('    if (gMessageStream != NULL)')
@@ -493,11 +542,6 @@ class Subcommand(object):
                         if proto.name == "DestroyInstance" or proto.name == "DestroyDevice":
                             func_body.append('    dispatch_key key = get_dispatch_key(%s);' % proto.params[0].name)
 
-                        if (0 == len(packet_size)):
-                            func_body.append('    CREATE_TRACE_PACKET(vk%s, 0);' % (proto.name))
-                        else:
-                            func_body.append('    CREATE_TRACE_PACKET(vk%s, %s);' % (proto.name, ' + '.join(packet_size)))
-
                         # call down the layer chain and get return value (if there is one)
                         # Note: this logic doesn't work for CreateInstance or CreateDevice but those are handwritten
                         if extensionName == 'vk_lunarg_debug_marker':
@@ -506,8 +550,36 @@ class Subcommand(object):
                            table_txt = 'mid(%s)->instTable' % proto.params[0].name
                         else:
                            table_txt = 'mdd(%s)->devTable' % proto.params[0].name
+
+                        tracking_txt = trigger_tracking_txt.get(proto.name, '')
+                        if proto.name in trigger_create_info_txt:
+                            func_body.append(trigger_create_info_txt[proto.name])
+
+                        if is_capture_window_only(proto.name):
+                            skip_cond = '!trigger_in_capture_window()'
+                            if proto.name == 'WaitForFences':
+                                skip_cond += ' || !trigger_fences_signaled_in_trace(fenceCount, pFences)'
+                            elif proto.name == 'GetFenceStatus':
+                                skip_cond += ' || !trigger_fences_signaled_in_trace(1, &fence)'
+                            func_body.append('    if (%s)\n    {' % skip_cond)
+                            func_body.append('        %s%s.%s;' % (return_txt, table_txt, proto.c_call()))
+                            if tracking_txt:
+                                func_body.append('    ' + tracking_txt.replace('\n', '\n    ').replace('%s', 'false'))
+                            if 'void' not in proto.ret or '*' in proto.ret:
+                                func_body.append('        return result;')
+                            else:
+                                func_body.append('        return;')
+                            func_body.append('    }')
+
+                        if (0 == len(packet_size)):
+                            func_body.append('    CREATE_TRACE_PACKET(vk%s, 0);' % (proto.name))
+                        else:
+                            func_body.append('    CREATE_TRACE_PACKET(vk%s, %s);' % (proto.name, ' + '.join(packet_size)))
+
                         func_body.append('    %s%s.%s;' % (return_txt, table_txt, proto.c_call()))
                         func_body.append('    vktrace_set_packet_entrypoint_end_time(pHeader);')
+                        if tracking_txt:
+                            func_body.append(tracking_txt.replace('%s', 'true'))
 
                         if in_data_size:
                             func_body.append('    _dataSize = (pDataSize == NULL || pData == NULL) ? 0 : *pDataSize;')
@@ -521,7 +593,10 @@ class Subcommand(object):
                             if ('DeviceCreateInfo' not in proto.params[pp_dict['index']].ty):
                                 func_body.append('    %s;' % (pp_dict['finalize_txt']))
                         # All buffers should be finalized by now, and the trace packet can be finished (which sends it over the socket)
-                        func_body.append('    FINISH_TRACE_PACKET();')
+                        if is_recording_func(proto.name):
+                            func_body.append('    trigger_finish_recording_packet(commandBuffer, &pHeader);')
+                        else:
+                            func_body.append('    FINISH_TRACE_PACKET();')
                         if proto.name == "DestroyInstance":
                             func_body.append('    g_instanceDataMap.erase(key);')
                         elif proto.name == "DestroyDevice":
@@ -1131,7 +1206,7 @@ class Subcommand(object):
         return "\n".join(xf_body)
 
     def _map_decl(self, type1, type2, name):
-        return '    std::map<%s, %s> %s;' % (type1, type2, name)
+        return '    std::unordered_map<%s, %s> %s;' % (type1, type2, name)
 
     def _add_to_map_decl(self, type1, type2, name):
         txt = '    void add_to_%s_map(%s pTraceVal, %s pReplayVal)\n    {\n' % (name[2:], type1, type2)
@@ -1149,7 +1224,7 @@ class Subcommand(object):
     def _remap_decl(self, ty, name):
         txt = '    %s remap_%s(const %s& value)\n    {\n' % (ty, name[2:], ty)
         txt += '        if (value == 0) { return 0; }\n'
-        txt += '        std::map<%s, %s>::const_iterator q = %s.find(value);\n' % (ty, ty, name)
+        txt += '        std::unordered_map<%s, %s>::const_iterator q = %s.find(value);\n' % (ty, ty, name)
         txt += '        if (q == %s.end()) { vktrace_LogError("Failed to remap %s."); return value; }\n' % (name, ty)
         txt += '        return q->second;\n    }\n'
         return txt
@@ -1326,7 +1401,7 @@ class Subcommand(object):
         rc_body.append('    switch (objectType) {')
         rc_body.append('        case VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT:')
         rc_body.append('        {')
-        rc_body.append('            std::map<VkBuffer, bufferObj>::iterator it = m_buffers.find((VkBuffer) handle);')
+        rc_body.append('            std::unordered_map<VkBuffer, bufferObj>::iterator it = m_buffers.find((VkBuffer) handle);')
         rc_body.append('            if (it != m_buffers.end()) {')
         rc_body.append('                objMemory obj = it->second.bufferMem;')
         rc_body.append('                obj.setCount(num);')
@@ -1336,7 +1411,7 @@ class Subcommand(object):
         rc_body.append('        }')
         rc_body.append('        case VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT:')
         rc_body.append('        {')
-        rc_body.append('            std::map<VkImage, imageObj>::iterator it = m_images.find((VkImage) handle);')
+        rc_body.append('            std::unordered_map<VkImage, imageObj>::iterator it = m_images.find((VkImage) handle);')
         rc_body.append('            if (it != m_images.end()) {')
         rc_body.append('                objMemory obj = it->second.imageMem;')
         rc_body.append('                obj.setCount(num);')
@@ -1353,7 +1428,7 @@ class Subcommand(object):
         rc_body.append('    switch (objectType) {')
         rc_body.append('        case VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT:')
         rc_body.append('        {')
-        rc_body.append('            std::map<VkBuffer, bufferObj>::iterator it = m_buffers.find((VkBuffer) handle);')
+        rc_body.append('            std::unordered_map<VkBuffer, bufferObj>::iterator it = m_buffers.find((VkBuffer) handle);')
         rc_body.append('            if (it != m_buffers.end()) {')
         rc_body.append('                objMemory obj = it->second.bufferMem;')
         rc_body.append('                obj.setReqs(pMemReqs, num);')
@@ -1363,7 +1438,7 @@ class Subcommand(object):
         rc_body.append('        }')
         rc_body.append('        case VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT:')
         rc_body.append('        {')
-        rc_body.append('            std::map<VkImage, imageObj>::iterator it = m_images.find((VkImage) handle);')
+        rc_body.append('            std::unordered_map<VkImage, imageObj>::iterator it = m_images.find((VkImage) handle);')
         rc_body.append('            if (it != m_images.end()) {')
         rc_body.append('                objMemory obj = it->second.imageMem;')
         rc_body.append('                obj.setReqs(pMemReqs, num);')
@@ -1391,7 +1466,7 @@ class Subcommand(object):
                 rc_body.append('    {')
                 rc_body.append('        if (value == 0) { return 0; }')
                 rc_body.append('')
-                rc_body.append('        std::map<VkImage, imageObj>::const_iterator q = m_images.find(value);')
+                rc_body.append('        std::unordered_map<VkImage, imageObj>::const_iterator q = m_images.find(value);')
                 rc_body.append('        if (q == m_images.end()) { vktrace_LogError("Failed to remap VkImage."); return value; }\n')
                 rc_body.append('        return q->second.replayImage;')
                 rc_body.append('    }\n')
@@ -1403,7 +1478,7 @@ class Subcommand(object):
                 rc_body.append('    {')
                 rc_body.append('        if (value == 0) { return 0; }')
                 rc_body.append('')
-                rc_body.append('        std::map<VkBuffer, bufferObj>::const_iterator q = m_buffers.find(value);')
+                rc_body.append('        std::unordered_map<VkBuffer, bufferObj>::const_iterator q = m_buffers.find(value);')
                 rc_body.append('        if (q == m_buffers.end()) { vktrace_LogError("Failed to remap VkBuffer."); return value; }\n')
                 rc_body.append('        return q->second.replayBuffer;')
                 rc_body.append('    }\n')
@@ -1415,7 +1490,7 @@ class Subcommand(object):
                 rc_body.append('    {')
                 rc_body.append('        if (value == 0) { return 0; }')
                 rc_body.append('')
-                rc_body.append('        std::map<VkDeviceMemory, gpuMemObj>::const_iterator q = m_devicememorys.find(value);')
+                rc_body.append('        std::unordered_map<VkDeviceMemory, gpuMemObj>::const_iterator q = m_devicememorys.find(value);')
                 rc_body.append('        if (q == m_devicememorys.end()) { vktrace_LogError("Failed to remap VkDeviceMemory."); return value; }')
                 rc_body.append('        return q->second.replayGpuMem;')
                 rc_body.append('    }\n')
@@ -1946,6 +2021,7 @@ class VktraceTraceC(Subcommand):
         header_txt.append('#include "vktrace_platform.h"')
         header_txt.append('#include "vktrace_common.h"')
         header_txt.append('#include "vktrace_lib_helpers.h"')
+        header_txt.append('#include "vktrace_lib_trigger.h"')
         header_txt.append('#include "vktrace_vk_vk.h"')
         #header_txt.append('#include "vktrace_vk_vk_lunarg_debug_marker.h"')
         header_txt.append('#include "vktrace_interconnect.h"')
@@ -2096,6 +2172,7 @@ class VktraceReplayObjMapperHeader(Subcommand):
         header_txt.append('#pragma once\n')
         header_txt.append('#include <set>')
         header_txt.append('#include <map>')
+        header_txt.append('#include <unordered_map>')
         header_txt.append('#include <vector>')
         header_txt.append('#include <string>')
         header_txt.append('#include "vulkan/vulkan.h"')